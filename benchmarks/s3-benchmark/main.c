@@ -0,0 +1,1049 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+/**
+ * Benchmark runner driving aws_s3_client directly. Sweeps every combination of meta request type, object size, part
+ * size and connection count given on the command line, and prints one record per iteration, as JSON lines or CSV, with
+ * the throughput, the latency of the parts, the CPU time spent per GB and the peak RSS of the process.
+ *
+ * Objects are written under the key prefix of the bucket, and left there, so that later runs don't have to upload the
+ * source objects of GETs and COPYs again.
+ */
+
+#include <aws/auth/credentials.h>
+#include <aws/common/array_list.h>
+#include <aws/common/clock.h>
+#include <aws/common/command_line_parser.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+#include <aws/common/zero.h>
+#include <aws/http/request_response.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/logging.h>
+#include <aws/s3/private/s3_mock_transport.h>
+#include <aws/s3/s3.h>
+#include <aws/s3/s3_client.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#    include <windows.h>
+
+#    include <psapi.h>
+#else
+#    include <sys/resource.h>
+#endif
+
+enum benchmark_type {
+    BENCHMARK_TYPE_GET,
+    BENCHMARK_TYPE_PUT,
+    BENCHMARK_TYPE_COPY,
+    BENCHMARK_TYPE_SMALL_GET,
+    BENCHMARK_TYPE_SMALL_PUT,
+    BENCHMARK_TYPE_MAX,
+};
+
+static const char *s_benchmark_type_names[BENCHMARK_TYPE_MAX] = {
+    [BENCHMARK_TYPE_GET] = "get",
+    [BENCHMARK_TYPE_PUT] = "put",
+    [BENCHMARK_TYPE_COPY] = "copy",
+    [BENCHMARK_TYPE_SMALL_GET] = "small-get",
+    [BENCHMARK_TYPE_SMALL_PUT] = "small-put",
+};
+
+enum benchmark_format {
+    BENCHMARK_FORMAT_JSON,
+    BENCHMARK_FORMAT_CSV,
+};
+
+struct benchmark_ctx {
+    struct aws_allocator *allocator;
+    struct aws_client_bootstrap *client_bootstrap;
+    struct aws_credentials_provider *credentials_provider;
+    struct aws_signing_config_aws signing_config;
+    struct aws_logger logger;
+    enum aws_log_level log_level;
+
+    const char *region;
+    const char *bucket;
+    const char *key_prefix;
+    struct aws_string *host_name;
+
+    /* Values to sweep. */
+    struct aws_array_list types;        /* enum benchmark_type */
+    struct aws_array_list object_sizes; /* uint64_t */
+    struct aws_array_list part_sizes;   /* uint64_t */
+    struct aws_array_list connections;  /* uint64_t */
+
+    uint32_t num_iterations;
+    uint32_t num_small_objects;
+    enum benchmark_format format;
+
+    /* Serve the requests with an in-process mock transport rather than S3, to measure the client on its own. The
+     * object size of the transport is set per case. */
+    bool mock;
+    struct aws_s3_mock_transport_options mock_options;
+
+    /* Source objects uploaded so far, so that they are only uploaded once per run (uint64_t object size, with the high
+     * bit set for the small objects). */
+    struct aws_array_list uploaded_objects;
+
+    struct aws_mutex mutex;
+    struct aws_condition_variable c_var;
+    bool client_shutdown;
+};
+
+/* One meta request type, object size, part size and connection count. */
+struct benchmark_case {
+    enum benchmark_type type;
+    uint64_t object_size;
+    uint64_t part_size;
+    uint32_t num_connections;
+};
+
+/* The meta requests of one iteration of a case, or of its setup. */
+struct benchmark_run {
+    struct benchmark_ctx *ctx;
+
+    /* Protected by the mutex of the context. */
+    uint32_t num_meta_requests_pending;
+    int error_code;
+    struct aws_array_list part_latencies_ns; /* uint64_t */
+};
+
+static const uint64_t s_small_object_flag = 1ULL << 63;
+
+static void s_usage(int exit_code) {
+    FILE *output = exit_code == 0 ? stdout : stderr;
+    fprintf(output, "usage: s3-benchmark [options]\n");
+    fprintf(output, " -r, --region REGION: region of the bucket (required).\n");
+    fprintf(output, " -b, --bucket BUCKET: bucket to run against (required).\n");
+    fprintf(output, " -k, --key-prefix PREFIX: prefix of the keys written to, default \"s3-benchmark/\".\n");
+    fprintf(output, " -t, --types LIST: among get, put, copy, small-get and small-put, default get,put.\n");
+    fprintf(output, " -s, --object-sizes LIST: sizes of the objects, default 1G.\n");
+    fprintf(output, " -p, --part-sizes LIST: part sizes of the client, default 8M.\n");
+    fprintf(output, " -c, --connections LIST: max active connections of the client, 0 for its default, default 0.\n");
+    fprintf(output, " -n, --iterations N: iterations of each case, default 3.\n");
+    fprintf(output, " -m, --small-objects N: objects per small-get and small-put iteration, default 100.\n");
+    fprintf(output, " -f, --format FORMAT: json (one object per line) or csv, default json.\n");
+    fprintf(output, " -x, --mock: serve requests in-process rather than with S3, region and bucket are optional.\n");
+    fprintf(output, " -l, --mock-latency MS: latency of each mocked request, default 20.\n");
+    fprintf(output, " -w, --mock-bandwidth SIZE: bytes per second of the mocked link, 0 for no limit, default 0.\n");
+    fprintf(output, " -e, --mock-slow-down-rate RATE: fraction of mocked requests that get a 503, default 0.\n");
+    fprintf(output, " -v, --verbose LEVEL: ERROR, INFO, DEBUG or TRACE.\n");
+    fprintf(output, " -h, --help: display this message and quit.\n");
+    fprintf(output, " Sizes take a K, M or G suffix (powers of 1024), and lists are separated by commas.\n");
+    fflush(output);
+    exit(exit_code);
+}
+
+static struct aws_cli_option s_long_options[] = {
+    {"region", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'r'},
+    {"bucket", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'b'},
+    {"key-prefix", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'k'},
+    {"types", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 't'},
+    {"object-sizes", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 's'},
+    {"part-sizes", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'p'},
+    {"connections", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'c'},
+    {"iterations", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'n'},
+    {"small-objects", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'm'},
+    {"format", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'f'},
+    {"mock", AWS_CLI_OPTIONS_NO_ARGUMENT, NULL, 'x'},
+    {"mock-latency", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'l'},
+    {"mock-bandwidth", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'w'},
+    {"mock-slow-down-rate", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'e'},
+    {"verbose", AWS_CLI_OPTIONS_REQUIRED_ARGUMENT, NULL, 'v'},
+    {"help", AWS_CLI_OPTIONS_NO_ARGUMENT, NULL, 'h'},
+    /* Per getopt(3) the last element of the array has to be filled with all zeros */
+    {NULL, AWS_CLI_OPTIONS_NO_ARGUMENT, NULL, 0},
+};
+
+/* Parse a size such as 512, 64K, 8M or 1G. */
+static int s_parse_size(struct aws_byte_cursor text, uint64_t *out_size) {
+    uint64_t multiplier = 1;
+
+    if (text.len > 0) {
+        switch (text.ptr[text.len - 1]) {
+            case 'k':
+            case 'K':
+                multiplier = 1024ULL;
+                break;
+            case 'm':
+            case 'M':
+                multiplier = 1024ULL * 1024;
+                break;
+            case 'g':
+            case 'G':
+                multiplier = 1024ULL * 1024 * 1024;
+                break;
+            default:
+                break;
+        }
+
+        if (multiplier > 1) {
+            --text.len;
+        }
+    }
+
+    uint64_t value = 0;
+    if (aws_byte_cursor_utf8_parse_u64(text, &value)) {
+        return AWS_OP_ERR;
+    }
+
+    return aws_mul_u64_checked(value, multiplier, out_size);
+}
+
+static void s_parse_size_list(const char *arg, struct aws_array_list *out_list, const char *option_name) {
+    aws_array_list_clear(out_list);
+
+    struct aws_byte_cursor list = aws_byte_cursor_from_c_str(arg);
+    struct aws_byte_cursor item;
+    AWS_ZERO_STRUCT(item);
+
+    while (aws_byte_cursor_next_split(&list, ',', &item)) {
+        uint64_t size = 0;
+
+        if (s_parse_size(item, &size)) {
+            fprintf(stderr, "invalid value \"" PRInSTR "\" for %s.\n", AWS_BYTE_CURSOR_PRI(item), option_name);
+            s_usage(1);
+        }
+
+        aws_array_list_push_back(out_list, &size);
+    }
+}
+
+static void s_parse_type_list(const char *arg, struct aws_array_list *out_list) {
+    aws_array_list_clear(out_list);
+
+    struct aws_byte_cursor list = aws_byte_cursor_from_c_str(arg);
+    struct aws_byte_cursor item;
+    AWS_ZERO_STRUCT(item);
+
+    while (aws_byte_cursor_next_split(&list, ',', &item)) {
+        enum benchmark_type type = BENCHMARK_TYPE_MAX;
+
+        for (int i = 0; i < BENCHMARK_TYPE_MAX; ++i) {
+            if (aws_byte_cursor_eq_c_str(&item, s_benchmark_type_names[i])) {
+                type = (enum benchmark_type)i;
+            }
+        }
+
+        if (type == BENCHMARK_TYPE_MAX) {
+            fprintf(stderr, "unsupported type \"" PRInSTR "\".\n", AWS_BYTE_CURSOR_PRI(item));
+            s_usage(1);
+        }
+
+        aws_array_list_push_back(out_list, &type);
+    }
+}
+
+static uint32_t s_parse_count(const char *arg, const char *option_name) {
+    uint64_t value = 0;
+
+    if (aws_byte_cursor_utf8_parse_u64(aws_byte_cursor_from_c_str(arg), &value) || value == 0 || value > UINT32_MAX) {
+        fprintf(stderr, "invalid value \"%s\" for %s.\n", arg, option_name);
+        s_usage(1);
+    }
+
+    return (uint32_t)value;
+}
+
+static void s_parse_options(int argc, char *argv[], struct benchmark_ctx *ctx) {
+    s_parse_type_list("get,put", &ctx->types);
+    s_parse_size_list("1G", &ctx->object_sizes, "--object-sizes");
+    s_parse_size_list("8M", &ctx->part_sizes, "--part-sizes");
+    s_parse_size_list("0", &ctx->connections, "--connections");
+    ctx->key_prefix = "s3-benchmark/";
+    ctx->num_iterations = 3;
+    ctx->num_small_objects = 100;
+    ctx->mock_options.latency_ns = 20 * (AWS_TIMESTAMP_NANOS / AWS_TIMESTAMP_MILLIS);
+    ctx->mock_options.num_host_addresses = 8;
+    ctx->mock_options.seed = 1;
+
+    while (true) {
+        int option_index = 0;
+        int c = aws_cli_getopt_long(argc, argv, "r:b:k:t:s:p:c:n:m:f:xl:w:e:v:h", s_long_options, &option_index);
+        if (c == -1) {
+            break;
+        }
+
+        switch (c) {
+            case 0:
+                /* getopt_long() returns 0 if an option.flag is non-null */
+                break;
+            case 'r':
+                ctx->region = aws_cli_optarg;
+                break;
+            case 'b':
+                ctx->bucket = aws_cli_optarg;
+                break;
+            case 'k':
+                ctx->key_prefix = aws_cli_optarg;
+                break;
+            case 't':
+                s_parse_type_list(aws_cli_optarg, &ctx->types);
+                break;
+            case 's':
+                s_parse_size_list(aws_cli_optarg, &ctx->object_sizes, "--object-sizes");
+                break;
+            case 'p':
+                s_parse_size_list(aws_cli_optarg, &ctx->part_sizes, "--part-sizes");
+                break;
+            case 'c':
+                s_parse_size_list(aws_cli_optarg, &ctx->connections, "--connections");
+                break;
+            case 'n':
+                ctx->num_iterations = s_parse_count(aws_cli_optarg, "--iterations");
+                break;
+            case 'm':
+                ctx->num_small_objects = s_parse_count(aws_cli_optarg, "--small-objects");
+                break;
+            case 'f':
+                if (!strcmp(aws_cli_optarg, "json")) {
+                    ctx->format = BENCHMARK_FORMAT_JSON;
+                } else if (!strcmp(aws_cli_optarg, "csv")) {
+                    ctx->format = BENCHMARK_FORMAT_CSV;
+                } else {
+                    fprintf(stderr, "unsupported format %s.\n", aws_cli_optarg);
+                    s_usage(1);
+                }
+                break;
+            case 'x':
+                ctx->mock = true;
+                break;
+            case 'l': {
+                uint64_t latency_ms = 0;
+
+                if (aws_byte_cursor_utf8_parse_u64(aws_byte_cursor_from_c_str(aws_cli_optarg), &latency_ms) ||
+                    aws_mul_u64_checked(
+                        latency_ms, AWS_TIMESTAMP_NANOS / AWS_TIMESTAMP_MILLIS, &ctx->mock_options.latency_ns)) {
+                    fprintf(stderr, "invalid value \"%s\" for --mock-latency.\n", aws_cli_optarg);
+                    s_usage(1);
+                }
+                break;
+            }
+            case 'w':
+                if (s_parse_size(aws_byte_cursor_from_c_str(aws_cli_optarg), &ctx->mock_options.bytes_per_second)) {
+                    fprintf(stderr, "invalid value \"%s\" for --mock-bandwidth.\n", aws_cli_optarg);
+                    s_usage(1);
+                }
+                break;
+            case 'e': {
+                char *end = NULL;
+                ctx->mock_options.slow_down_rate = strtod(aws_cli_optarg, &end);
+
+                if (end == aws_cli_optarg || *end != '\0' || ctx->mock_options.slow_down_rate < 0.0 ||
+                    ctx->mock_options.slow_down_rate > 1.0) {
+                    fprintf(stderr, "invalid value \"%s\" for --mock-slow-down-rate.\n", aws_cli_optarg);
+                    s_usage(1);
+                }
+                break;
+            }
+            case 'v':
+                if (!strcmp(aws_cli_optarg, "TRACE")) {
+                    ctx->log_level = AWS_LL_TRACE;
+                } else if (!strcmp(aws_cli_optarg, "INFO")) {
+                    ctx->log_level = AWS_LL_INFO;
+                } else if (!strcmp(aws_cli_optarg, "DEBUG")) {
+                    ctx->log_level = AWS_LL_DEBUG;
+                } else if (!strcmp(aws_cli_optarg, "ERROR")) {
+                    ctx->log_level = AWS_LL_ERROR;
+                } else {
+                    fprintf(stderr, "unsupported log level %s.\n", aws_cli_optarg);
+                    s_usage(1);
+                }
+                break;
+            case 'h':
+                s_usage(0);
+                break;
+            default:
+                s_usage(1);
+                break;
+        }
+    }
+
+    if (ctx->mock) {
+        ctx->region = ctx->region ? ctx->region : "us-east-1";
+        ctx->bucket = ctx->bucket ? ctx->bucket : "s3-benchmark-mock";
+    }
+
+    if (!ctx->region || !ctx->bucket) {
+        fprintf(stderr, "region and bucket are required arguments\n");
+        s_usage(1);
+    }
+
+    for (size_t i = 0; i < aws_array_list_length(&ctx->connections); ++i) {
+        uint64_t num_connections = 0;
+        aws_array_list_get_at(&ctx->connections, &num_connections, i);
+
+        if (num_connections > UINT32_MAX) {
+            fprintf(stderr, "invalid value for --connections.\n");
+            s_usage(1);
+        }
+    }
+}
+
+/* CPU time of the process so far (user and system), and its peak RSS. */
+static void s_get_process_usage(double *out_cpu_seconds, uint64_t *out_peak_rss_bytes) {
+#ifdef _WIN32
+    FILETIME creation_time;
+    FILETIME exit_time;
+    FILETIME kernel_time;
+    FILETIME user_time;
+    *out_cpu_seconds = 0.0;
+
+    if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        /* FILETIMEs count 100ns intervals. */
+        uint64_t kernel = ((uint64_t)kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime;
+        uint64_t user = ((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+        *out_cpu_seconds = (double)(kernel + user) / 1e7;
+    }
+
+    PROCESS_MEMORY_COUNTERS memory_counters;
+    *out_peak_rss_bytes = 0;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &memory_counters, sizeof(memory_counters))) {
+        *out_peak_rss_bytes = memory_counters.PeakWorkingSetSize;
+    }
+#else
+    struct rusage usage;
+    AWS_ZERO_STRUCT(usage);
+    getrusage(RUSAGE_SELF, &usage);
+
+    *out_cpu_seconds = (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6 +
+                       (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+
+#    ifdef __APPLE__
+    /* ru_maxrss is in bytes on Apple platforms, and in kilobytes everywhere else. */
+    *out_peak_rss_bytes = (uint64_t)usage.ru_maxrss;
+#    else
+    *out_peak_rss_bytes = (uint64_t)usage.ru_maxrss * 1024;
+#    endif
+#endif
+}
+
+static void s_client_shutdown_callback(void *user_data) {
+    struct benchmark_ctx *ctx = user_data;
+
+    aws_mutex_lock(&ctx->mutex);
+    ctx->client_shutdown = true;
+    aws_condition_variable_notify_all(&ctx->c_var);
+    aws_mutex_unlock(&ctx->mutex);
+}
+
+static bool s_is_client_shutdown(void *arg) {
+    struct benchmark_ctx *ctx = arg;
+    return ctx->client_shutdown;
+}
+
+static struct aws_s3_client *s_client_new(struct benchmark_ctx *ctx, const struct benchmark_case *benchmark_case) {
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.client_bootstrap = ctx->client_bootstrap;
+    client_config.region = aws_byte_cursor_from_c_str(ctx->region);
+    client_config.signing_config = &ctx->signing_config;
+    client_config.part_size = (size_t)benchmark_case->part_size;
+    client_config.max_active_connections_override = benchmark_case->num_connections;
+    client_config.shutdown_callback = s_client_shutdown_callback;
+    client_config.shutdown_callback_user_data = ctx;
+
+    ctx->client_shutdown = false;
+    return aws_s3_client_new(ctx->allocator, &client_config);
+}
+
+/* Release the client and wait for it to shut down, so that its connections and threads don't carry over to the next
+ * case. */
+static void s_client_release(struct benchmark_ctx *ctx, struct aws_s3_client *client) {
+    aws_s3_client_release(client);
+
+    aws_mutex_lock(&ctx->mutex);
+    aws_condition_variable_wait_pred(&ctx->c_var, &ctx->mutex, s_is_client_shutdown, ctx);
+    aws_mutex_unlock(&ctx->mutex);
+}
+
+static void s_format_key(
+    const struct benchmark_ctx *ctx,
+    const char *name,
+    uint64_t object_size,
+    uint32_t index,
+    char *key,
+    size_t key_size) {
+    snprintf(key, key_size, "/%s%s-%" PRIu64 "-%" PRIu32, ctx->key_prefix, name, object_size, index);
+}
+
+static struct aws_http_message *s_message_new(
+    struct benchmark_ctx *ctx,
+    struct aws_byte_cursor method,
+    const char *key,
+    uint64_t content_length,
+    const char *copy_source_key) {
+
+    struct aws_http_message *message = aws_http_message_new_request(ctx->allocator);
+
+    struct aws_http_header host_header = {
+        .name = aws_byte_cursor_from_c_str("Host"),
+        .value = aws_byte_cursor_from_string(ctx->host_name),
+    };
+    aws_http_message_add_header(message, host_header);
+
+    char value[512];
+
+    if (aws_byte_cursor_eq(&method, &aws_http_method_put) && copy_source_key == NULL) {
+        snprintf(value, sizeof(value), "%" PRIu64, content_length);
+
+        struct aws_http_header content_length_header = {
+            .name = aws_byte_cursor_from_c_str("Content-Length"),
+            .value = aws_byte_cursor_from_c_str(value),
+        };
+        aws_http_message_add_header(message, content_length_header);
+    }
+
+    if (copy_source_key != NULL) {
+        snprintf(value, sizeof(value), "%s%s", ctx->bucket, copy_source_key);
+
+        struct aws_http_header copy_source_header = {
+            .name = aws_byte_cursor_from_c_str("x-amz-copy-source"),
+            .value = aws_byte_cursor_from_c_str(value),
+        };
+        aws_http_message_add_header(message, copy_source_header);
+    }
+
+    aws_http_message_set_request_method(message, method);
+    aws_http_message_set_request_path(message, aws_byte_cursor_from_c_str(key));
+    return message;
+}
+
+/* Bodies of PUTs are generated as they are read, so that big objects don't have to be held in memory (and don't show
+ * up in the peak RSS). */
+static int s_read_body_at(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *dest,
+    void *user_data) {
+    (void)meta_request;
+    (void)user_data;
+
+    memset(dest->buffer + dest->len, 'a' + (int)(offset % 26), dest->capacity - dest->len);
+    dest->len = dest->capacity;
+    return AWS_OP_SUCCESS;
+}
+
+/* Bodies of GETs are dropped. */
+static int s_body_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_byte_cursor *body,
+    uint64_t range_start,
+    void *user_data) {
+    (void)meta_request;
+    (void)body;
+    (void)range_start;
+    (void)user_data;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_telemetry_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_request_metrics *metrics,
+    void *user_data) {
+    (void)meta_request;
+
+    struct benchmark_run *run = user_data;
+
+    /* Only parts count, not the requests that create or complete multipart uploads, or find out object sizes. */
+    if (metrics->part_number == 0 || metrics->error_code != AWS_ERROR_SUCCESS ||
+        metrics->send_start_timestamp_ns == 0) {
+        return;
+    }
+
+    uint64_t latency_ns = metrics->finish_timestamp_ns - metrics->send_start_timestamp_ns;
+
+    aws_mutex_lock(&run->ctx->mutex);
+    aws_array_list_push_back(&run->part_latencies_ns, &latency_ns);
+    aws_mutex_unlock(&run->ctx->mutex);
+}
+
+static void s_finish_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_meta_request_result *meta_request_result,
+    void *user_data) {
+    (void)meta_request;
+
+    struct benchmark_run *run = user_data;
+
+    aws_mutex_lock(&run->ctx->mutex);
+
+    if (meta_request_result->error_code != AWS_ERROR_SUCCESS && run->error_code == AWS_ERROR_SUCCESS) {
+        run->error_code = meta_request_result->error_code;
+    }
+
+    --run->num_meta_requests_pending;
+    aws_condition_variable_notify_all(&run->ctx->c_var);
+    aws_mutex_unlock(&run->ctx->mutex);
+}
+
+static bool s_is_run_done(void *arg) {
+    struct benchmark_run *run = arg;
+    return run->num_meta_requests_pending == 0;
+}
+
+/* Make one meta request of a run. Its reference is released right away, as the run only waits for it to finish. */
+static void s_run_meta_request(
+    struct benchmark_run *run,
+    struct aws_s3_client *client,
+    enum aws_s3_meta_request_type type,
+    struct aws_http_message *message) {
+
+    struct aws_s3_meta_request_options options = {
+        .type = type,
+        .message = message,
+        .user_data = run,
+        .body_callback = s_body_callback,
+        .finish_callback = s_finish_callback,
+        .telemetry_callback = s_telemetry_callback,
+    };
+
+    if (type == AWS_S3_META_REQUEST_TYPE_PUT_OBJECT) {
+        options.read_body_at_callback = s_read_body_at;
+    }
+
+    aws_mutex_lock(&run->ctx->mutex);
+    ++run->num_meta_requests_pending;
+    aws_mutex_unlock(&run->ctx->mutex);
+
+    struct aws_s3_meta_request *meta_request = aws_s3_client_make_meta_request(client, &options);
+
+    if (meta_request == NULL) {
+        struct aws_s3_meta_request_result result = {.error_code = aws_last_error_or_unknown()};
+        s_finish_callback(NULL, &result, run);
+        return;
+    }
+
+    aws_s3_meta_request_release(meta_request);
+}
+
+static void s_wait_for_run(struct benchmark_run *run) {
+    aws_mutex_lock(&run->ctx->mutex);
+    aws_condition_variable_wait_pred(&run->ctx->c_var, &run->ctx->mutex, s_is_run_done, run);
+    aws_mutex_unlock(&run->ctx->mutex);
+}
+
+/* Upload the objects that GETs and COPYs of a case read, unless an earlier case already did. */
+static int s_set_up_case(
+    struct benchmark_ctx *ctx,
+    struct aws_s3_client *client,
+    const struct benchmark_case *benchmark_case) {
+
+    bool small = benchmark_case->type == BENCHMARK_TYPE_SMALL_GET;
+
+    if (!small && benchmark_case->type != BENCHMARK_TYPE_GET && benchmark_case->type != BENCHMARK_TYPE_COPY) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint64_t uploaded_object = benchmark_case->object_size | (small ? s_small_object_flag : 0);
+
+    for (size_t i = 0; i < aws_array_list_length(&ctx->uploaded_objects); ++i) {
+        uint64_t other_uploaded_object = 0;
+        aws_array_list_get_at(&ctx->uploaded_objects, &other_uploaded_object, i);
+
+        if (other_uploaded_object == uploaded_object) {
+            return AWS_OP_SUCCESS;
+        }
+    }
+
+    struct benchmark_run run = {.ctx = ctx};
+    aws_array_list_init_dynamic(&run.part_latencies_ns, ctx->allocator, 0, sizeof(uint64_t));
+
+    uint32_t num_objects = small ? ctx->num_small_objects : 1;
+
+    for (uint32_t i = 0; i < num_objects; ++i) {
+        char key[1024];
+        s_format_key(ctx, small ? "small" : "object", benchmark_case->object_size, i, key, sizeof(key));
+
+        struct aws_http_message *message =
+            s_message_new(ctx, aws_http_method_put, key, benchmark_case->object_size, NULL);
+        s_run_meta_request(&run, client, AWS_S3_META_REQUEST_TYPE_PUT_OBJECT, message);
+        aws_http_message_release(message);
+    }
+
+    s_wait_for_run(&run);
+    aws_array_list_clean_up(&run.part_latencies_ns);
+
+    if (run.error_code != AWS_ERROR_SUCCESS) {
+        fprintf(
+            stderr,
+            "could not upload the objects of %s of %" PRIu64 " bytes: %s\n",
+            s_benchmark_type_names[benchmark_case->type],
+            benchmark_case->object_size,
+            aws_error_name(run.error_code));
+        return aws_raise_error(run.error_code);
+    }
+
+    aws_array_list_push_back(&ctx->uploaded_objects, &uploaded_object);
+    return AWS_OP_SUCCESS;
+}
+
+/* Run the meta requests of one iteration of a case, and wait for all of them. Returns the number of objects. */
+static uint32_t s_run_iteration(
+    struct benchmark_run *run,
+    struct aws_s3_client *client,
+    const struct benchmark_case *benchmark_case) {
+
+    struct benchmark_ctx *ctx = run->ctx;
+    uint32_t num_objects = 1;
+
+    switch (benchmark_case->type) {
+        case BENCHMARK_TYPE_SMALL_GET:
+        case BENCHMARK_TYPE_SMALL_PUT:
+            num_objects = ctx->num_small_objects;
+            break;
+        default:
+            break;
+    }
+
+    for (uint32_t i = 0; i < num_objects; ++i) {
+        char key[1024];
+        char source_key[1024];
+        struct aws_http_message *message = NULL;
+        enum aws_s3_meta_request_type type = AWS_S3_META_REQUEST_TYPE_DEFAULT;
+
+        switch (benchmark_case->type) {
+            case BENCHMARK_TYPE_GET:
+                s_format_key(ctx, "object", benchmark_case->object_size, i, key, sizeof(key));
+                message = s_message_new(ctx, aws_http_method_get, key, 0, NULL);
+                type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+                break;
+            case BENCHMARK_TYPE_PUT:
+                s_format_key(ctx, "put", benchmark_case->object_size, i, key, sizeof(key));
+                message = s_message_new(ctx, aws_http_method_put, key, benchmark_case->object_size, NULL);
+                type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT;
+                break;
+            case BENCHMARK_TYPE_COPY:
+                s_format_key(ctx, "object", benchmark_case->object_size, i, source_key, sizeof(source_key));
+                s_format_key(ctx, "copy", benchmark_case->object_size, i, key, sizeof(key));
+                message = s_message_new(ctx, aws_http_method_put, key, 0, source_key);
+                type = AWS_S3_META_REQUEST_TYPE_COPY_OBJECT;
+                break;
+            case BENCHMARK_TYPE_SMALL_GET:
+                s_format_key(ctx, "small", benchmark_case->object_size, i, key, sizeof(key));
+                message = s_message_new(ctx, aws_http_method_get, key, 0, NULL);
+                type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+                break;
+            case BENCHMARK_TYPE_SMALL_PUT:
+                s_format_key(ctx, "small-put", benchmark_case->object_size, i, key, sizeof(key));
+                message = s_message_new(ctx, aws_http_method_put, key, benchmark_case->object_size, NULL);
+                type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT;
+                break;
+            default:
+                AWS_FATAL_ASSERT(false);
+        }
+
+        s_run_meta_request(run, client, type, message);
+        aws_http_message_release(message);
+    }
+
+    s_wait_for_run(run);
+    return num_objects;
+}
+
+static int s_compare_u64(const void *a, const void *b) {
+    uint64_t value_a = *(const uint64_t *)a;
+    uint64_t value_b = *(const uint64_t *)b;
+    return value_a < value_b ? -1 : (value_a > value_b ? 1 : 0);
+}
+
+/* Nearest rank percentile of sorted values, in milliseconds. */
+static double s_percentile_ms(const struct aws_array_list *sorted_values, uint32_t percentile) {
+    size_t num_values = aws_array_list_length(sorted_values);
+
+    if (num_values == 0) {
+        return 0.0;
+    }
+
+    size_t rank = (num_values * percentile + 99) / 100;
+    uint64_t value = 0;
+    aws_array_list_get_at(sorted_values, &value, rank > 0 ? rank - 1 : 0);
+    return (double)value / 1e6;
+}
+
+static void s_print_header(const struct benchmark_ctx *ctx) {
+    if (ctx->format == BENCHMARK_FORMAT_CSV) {
+        printf("type,object_size,part_size,connections,iteration,num_objects,bytes,seconds,gbps,num_parts,"
+               "p50_part_latency_ms,p99_part_latency_ms,cpu_seconds,cpu_seconds_per_gb,peak_rss_bytes,error\n");
+    }
+}
+
+static void s_print_record(
+    const struct benchmark_ctx *ctx,
+    const struct benchmark_case *benchmark_case,
+    uint32_t iteration,
+    uint32_t num_objects,
+    struct benchmark_run *run,
+    uint64_t elapsed_ns,
+    double cpu_seconds,
+    uint64_t peak_rss_bytes) {
+
+    uint64_t num_bytes = benchmark_case->object_size * num_objects;
+    double seconds = (double)elapsed_ns / 1e9;
+    double gbps = seconds > 0.0 ? (double)num_bytes * 8.0 / seconds / 1e9 : 0.0;
+    double cpu_seconds_per_gb = num_bytes > 0 ? cpu_seconds / ((double)num_bytes / 1e9) : 0.0;
+
+    aws_array_list_sort(&run->part_latencies_ns, s_compare_u64);
+    size_t num_parts = aws_array_list_length(&run->part_latencies_ns);
+    double p50_ms = s_percentile_ms(&run->part_latencies_ns, 50);
+    double p99_ms = s_percentile_ms(&run->part_latencies_ns, 99);
+
+    const char *type_name = s_benchmark_type_names[benchmark_case->type];
+    const char *error_name = run->error_code != AWS_ERROR_SUCCESS ? aws_error_name(run->error_code) : "";
+
+    if (ctx->format == BENCHMARK_FORMAT_CSV) {
+        printf(
+            "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu64 ",%.3f,%.3f,%zu,%.3f,%.3f,%.3f,"
+            "%.3f,%" PRIu64 ",%s\n",
+            type_name,
+            benchmark_case->object_size,
+            benchmark_case->part_size,
+            benchmark_case->num_connections,
+            iteration,
+            num_objects,
+            num_bytes,
+            seconds,
+            gbps,
+            num_parts,
+            p50_ms,
+            p99_ms,
+            cpu_seconds,
+            cpu_seconds_per_gb,
+            peak_rss_bytes,
+            error_name);
+    } else {
+        printf(
+            "{\"type\": \"%s\", \"object_size\": %" PRIu64 ", \"part_size\": %" PRIu64 ", \"connections\": %" PRIu32
+            ", \"iteration\": %" PRIu32 ", \"num_objects\": %" PRIu32 ", \"bytes\": %" PRIu64
+            ", \"seconds\": %.3f, \"gbps\": %.3f, \"num_parts\": %zu, \"p50_part_latency_ms\": %.3f"
+            ", \"p99_part_latency_ms\": %.3f, \"cpu_seconds\": %.3f, \"cpu_seconds_per_gb\": %.3f"
+            ", \"peak_rss_bytes\": %" PRIu64 ", \"error\": \"%s\"}\n",
+            type_name,
+            benchmark_case->object_size,
+            benchmark_case->part_size,
+            benchmark_case->num_connections,
+            iteration,
+            num_objects,
+            num_bytes,
+            seconds,
+            gbps,
+            num_parts,
+            p50_ms,
+            p99_ms,
+            cpu_seconds,
+            cpu_seconds_per_gb,
+            peak_rss_bytes,
+            error_name);
+    }
+
+    fflush(stdout);
+}
+
+/* Run every iteration of a case on a client of its own. Returns AWS_OP_ERR if any meta request failed. */
+static int s_run_case(struct benchmark_ctx *ctx, const struct benchmark_case *benchmark_case) {
+    struct aws_s3_mock_transport *transport = NULL;
+
+    if (ctx->mock) {
+        struct aws_s3_mock_transport_options mock_options = ctx->mock_options;
+        mock_options.object_size = benchmark_case->object_size;
+
+        transport = aws_s3_mock_transport_new(ctx->allocator, &mock_options);
+
+        if (transport == NULL) {
+            fprintf(stderr, "could not create the mock transport: %s\n", aws_error_name(aws_last_error()));
+            return AWS_OP_ERR;
+        }
+    }
+
+    struct aws_s3_client *client = s_client_new(ctx, benchmark_case);
+
+    if (client == NULL) {
+        fprintf(stderr, "could not create the client: %s\n", aws_error_name(aws_last_error()));
+        aws_s3_mock_transport_destroy(transport);
+        return AWS_OP_ERR;
+    }
+
+    if (transport != NULL) {
+        aws_s3_mock_transport_install(transport, client);
+    }
+
+    int result = AWS_OP_SUCCESS;
+
+    /* The mock transport serves GETs and COPYs of any key, so there is nothing to upload for it. */
+    if (transport == NULL && s_set_up_case(ctx, client, benchmark_case)) {
+        result = AWS_OP_ERR;
+        goto clean_up;
+    }
+
+    for (uint32_t iteration = 0; iteration < ctx->num_iterations; ++iteration) {
+        struct benchmark_run run = {.ctx = ctx};
+        aws_array_list_init_dynamic(&run.part_latencies_ns, ctx->allocator, 0, sizeof(uint64_t));
+
+        double cpu_seconds_start = 0.0;
+        double cpu_seconds_end = 0.0;
+        uint64_t peak_rss_bytes = 0;
+        uint64_t start_ns = 0;
+        uint64_t end_ns = 0;
+
+        s_get_process_usage(&cpu_seconds_start, &peak_rss_bytes);
+        aws_high_res_clock_get_ticks(&start_ns);
+
+        uint32_t num_objects = s_run_iteration(&run, client, benchmark_case);
+
+        aws_high_res_clock_get_ticks(&end_ns);
+        s_get_process_usage(&cpu_seconds_end, &peak_rss_bytes);
+
+        s_print_record(
+            ctx,
+            benchmark_case,
+            iteration,
+            num_objects,
+            &run,
+            end_ns - start_ns,
+            cpu_seconds_end - cpu_seconds_start,
+            peak_rss_bytes);
+
+        if (run.error_code != AWS_ERROR_SUCCESS) {
+            result = AWS_OP_ERR;
+        }
+
+        aws_array_list_clean_up(&run.part_latencies_ns);
+    }
+
+clean_up:
+    s_client_release(ctx, client);
+    aws_s3_mock_transport_destroy(transport);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_s3_library_init(allocator);
+
+    struct benchmark_ctx ctx;
+    AWS_ZERO_STRUCT(ctx);
+    ctx.allocator = allocator;
+    ctx.c_var = (struct aws_condition_variable)AWS_CONDITION_VARIABLE_INIT;
+    aws_mutex_init(&ctx.mutex);
+    aws_array_list_init_dynamic(&ctx.types, allocator, 4, sizeof(enum benchmark_type));
+    aws_array_list_init_dynamic(&ctx.object_sizes, allocator, 4, sizeof(uint64_t));
+    aws_array_list_init_dynamic(&ctx.part_sizes, allocator, 4, sizeof(uint64_t));
+    aws_array_list_init_dynamic(&ctx.connections, allocator, 4, sizeof(uint64_t));
+    aws_array_list_init_dynamic(&ctx.uploaded_objects, allocator, 4, sizeof(uint64_t));
+
+    s_parse_options(argc, argv, &ctx);
+
+    if (ctx.log_level != AWS_LOG_LEVEL_NONE) {
+        struct aws_logger_standard_options logger_options = {
+            .level = ctx.log_level,
+            .file = stderr,
+        };
+
+        aws_logger_init_standard(&ctx.logger, allocator, &logger_options);
+        aws_logger_set(&ctx.logger);
+    }
+
+    char host_name[512];
+    snprintf(host_name, sizeof(host_name), "%s.s3.%s.amazonaws.com", ctx.bucket, ctx.region);
+    ctx.host_name = aws_string_new_from_c_str(allocator, host_name);
+
+    /* event loop */
+    struct aws_event_loop_group *event_loop_group = aws_event_loop_group_new_default(allocator, 0, NULL);
+
+    /* resolver */
+    struct aws_host_resolver_default_options resolver_options = {
+        .el_group = event_loop_group,
+        .max_entries = 8,
+    };
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, &resolver_options);
+
+    /* client bootstrap */
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = event_loop_group,
+        .host_resolver = resolver,
+    };
+    ctx.client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    if (ctx.client_bootstrap == NULL) {
+        printf("ERROR initializing client bootstrap\n");
+        return -1;
+    }
+
+    /* credentials, made up for the mock transport, which still has every request signed */
+    if (ctx.mock) {
+        struct aws_credentials_provider_static_options credentials_provider_options = {
+            .access_key_id = aws_byte_cursor_from_c_str("AKIDMOCKAKIDMOCKAKID"),
+            .secret_access_key = aws_byte_cursor_from_c_str("s3-benchmark-mock-secret-access-key"),
+        };
+        ctx.credentials_provider = aws_credentials_provider_new_static(allocator, &credentials_provider_options);
+    } else {
+        struct aws_credentials_provider_chain_default_options credentials_provider_options;
+        AWS_ZERO_STRUCT(credentials_provider_options);
+        credentials_provider_options.bootstrap = ctx.client_bootstrap;
+        ctx.credentials_provider =
+            aws_credentials_provider_new_chain_default(allocator, &credentials_provider_options);
+    }
+
+    /* signing config */
+    aws_s3_init_default_signing_config(
+        &ctx.signing_config, aws_byte_cursor_from_c_str(ctx.region), ctx.credentials_provider);
+    ctx.signing_config.flags.use_double_uri_encode = false;
+
+    s_print_header(&ctx);
+
+    int result = 0;
+
+    for (size_t type_index = 0; type_index < aws_array_list_length(&ctx.types); ++type_index) {
+        for (size_t size_index = 0; size_index < aws_array_list_length(&ctx.object_sizes); ++size_index) {
+            for (size_t part_index = 0; part_index < aws_array_list_length(&ctx.part_sizes); ++part_index) {
+                for (size_t conn_index = 0; conn_index < aws_array_list_length(&ctx.connections); ++conn_index) {
+                    struct benchmark_case benchmark_case;
+                    AWS_ZERO_STRUCT(benchmark_case);
+                    uint64_t num_connections = 0;
+
+                    aws_array_list_get_at(&ctx.types, &benchmark_case.type, type_index);
+                    aws_array_list_get_at(&ctx.object_sizes, &benchmark_case.object_size, size_index);
+                    aws_array_list_get_at(&ctx.part_sizes, &benchmark_case.part_size, part_index);
+                    aws_array_list_get_at(&ctx.connections, &num_connections, conn_index);
+                    benchmark_case.num_connections = (uint32_t)num_connections;
+
+                    if (s_run_case(&ctx, &benchmark_case)) {
+                        result = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    /* release resources */
+    aws_credentials_provider_release(ctx.credentials_provider);
+    aws_client_bootstrap_release(ctx.client_bootstrap);
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(event_loop_group);
+    aws_string_destroy(ctx.host_name);
+    aws_array_list_clean_up(&ctx.uploaded_objects);
+    aws_array_list_clean_up(&ctx.connections);
+    aws_array_list_clean_up(&ctx.part_sizes);
+    aws_array_list_clean_up(&ctx.object_sizes);
+    aws_array_list_clean_up(&ctx.types);
+    aws_mutex_clean_up(&ctx.mutex);
+
+    if (ctx.log_level != AWS_LOG_LEVEL_NONE) {
+        aws_logger_clean_up(&ctx.logger);
+    }
+
+    aws_s3_library_clean_up();
+    return result;
+}
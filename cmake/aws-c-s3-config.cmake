@@ -1,6 +1,7 @@
 include(CMakeFindDependencyMacro)
 
 find_dependency(aws-c-auth)
+find_dependency(aws-checksums)
 find_dependency(aws-c-http)
 
 if (BUILD_SHARED_LIBS)
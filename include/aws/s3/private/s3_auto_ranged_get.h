@@ -7,6 +7,12 @@
  */
 
 #include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_util.h"
+
+#include <aws/common/array_list.h>
+
+/* Number of recent part latencies that the median part latency used for hedging is computed over. */
+#define AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES 16
 
 enum aws_s3_auto_ranged_get_request_type {
     AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_HEAD_OBJECT,
@@ -14,6 +20,30 @@ enum aws_s3_auto_ranged_get_request_type {
     AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_INITIAL_MESSAGE,
 };
 
+/* Tracks the requests that are in flight for one part when part hedging is enabled. */
+struct aws_s3_auto_ranged_get_part_in_flight {
+    /* First request sent for the part. NULL once it has finished. */
+    struct aws_s3_request *request;
+
+    /* Duplicate request sent for the part if the first one was straggling. NULL if there is none, or once it has
+     * finished. */
+    struct aws_s3_request *hedge_request;
+
+    /* Time at which the first request was put on a connection. 0 until then, and the part can't be hedged before. */
+    uint64_t start_timestamp_ns;
+
+    uint32_t part_number;
+
+    /* True once one of the part's requests has been delivered to the caller. */
+    bool delivered;
+
+    /* True if a hedge was ever created for this part. A part is only ever hedged once. */
+    bool hedged;
+
+    /* False for requests that also discover the object size, as the outcome of those can't be raced. */
+    bool can_hedge;
+};
+
 struct aws_s3_auto_ranged_get {
     struct aws_s3_meta_request base;
 
@@ -25,6 +55,9 @@ struct aws_s3_auto_ranged_get {
         /* The last byte of the data that will be retrieved from the object.*/
         uint64_t object_range_end;
 
+        /* Size of the whole object. Only known once object_range_known is. */
+        uint64_t object_size;
+
         /* The total number of parts that are being used in downloading the object range. Note that "part" here
          * currently refers to a range-get, and does not require a "part" on the service side. */
         uint32_t total_num_parts;
@@ -39,16 +72,83 @@ struct aws_s3_auto_ranged_get {
         uint32_t head_object_completed : 1;
         uint32_t get_without_range_sent : 1;
         uint32_t get_without_range_completed : 1;
+
+        /* Parts (aws_s3_auto_ranged_get_part_in_flight) that still have requests in flight. Only used when part
+         * hedging is enabled. */
+        struct aws_array_list parts_in_flight;
+
+        /* Ring buffer with the latencies of the most recently delivered parts. */
+        uint64_t part_latency_samples_ns[AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES];
+        uint32_t num_part_latency_samples;
+        uint32_t next_part_latency_sample;
+
+        /* Number of hedge requests that have not finished yet. */
+        uint32_t num_hedges_in_flight;
+
+        /* Part that is holding up delivery of parts that already arrived, and since when. 0 if no part is. */
+        uint32_t head_of_line_part_number;
+        uint64_t head_of_line_timestamp_ns;
+
+        /* Sizes of the parts when variable part sizes are enabled. Only the size of the first part is known until the
+         * object range is. */
+        struct aws_s3_part_size_schedule part_size_schedule;
+
+        /* ETag that requests are pinned to with an If-Match header. Comes from the checkpoint, or else from the
+         * response that discovered the object range. NULL if there is neither. */
+        struct aws_string *etag;
+
+        /* ETag of the first speculative part that finished before the object range was known, which has to be the
+         * ETag the object range is then discovered with. NULL if there is none. */
+        struct aws_string *speculative_etag;
+
+        /* Number of parts of the object range that are not requested because the checkpoint already covers them, and
+         * how many of those have been skipped so far. Parts are numbered in the order they are requested, so part
+         * number n covers the range of part n + num_parts_skipped of the object range. */
+        uint32_t num_parts_covered;
+        uint32_t num_parts_skipped;
     } synced_data;
 
+    /* Completed ranges of the checkpoint (struct aws_s3_byte_range), sorted and merged so that none of them touch.
+     * Empty if there is no checkpoint. Doesn't change once the meta request is created. */
+    struct aws_array_list completed_ranges;
+
+    /* Identifies the object in the client's block cache (see s3_block_cache.h): the host and path of the initial
+     * message. Empty if the block cache isn't used. */
+    struct aws_byte_buf cache_object_id;
+
+    /* Byte range asked for by the initial message's Range header, when it could be parsed. The end is UINT64_MAX if
+     * the range is open ended. Not used for suffix ranges. */
+    uint64_t initial_range_start;
+    uint64_t initial_range_end;
+
+    /* Number of parts requested, along with the first one, before the object range is known (see
+     * num_speculative_parts in aws_s3_meta_request_options). 1 if parts aren't requested speculatively. Doesn't change
+     * once the meta request is created. */
+    uint32_t num_parts_before_object_range;
+
     uint32_t initial_message_has_range_header : 1;
+
+    /* True if the range of the initial message's Range header could be parsed, so that the first part can be requested
+     * right away (and the object range learnt from its Content-Range) instead of sending a HEAD request first. */
+    uint32_t initial_range_parsed : 1;
+
+    /* True if that range is a suffix ("bytes=-n") of at most a part, which is then requested as is, in one part. */
+    uint32_t initial_range_is_suffix : 1;
+    uint32_t enable_part_hedging : 1;
+    uint32_t enable_direct_body_streaming : 1;
+    uint32_t enable_variable_part_size : 1;
 };
 
+AWS_EXTERN_C_BEGIN
+
 /* Creates a new auto-ranged get meta request.  This will do multiple parallel ranged-gets when appropriate. */
+AWS_S3_API
 struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_get_new(
     struct aws_allocator *allocator,
     struct aws_s3_client *client,
     size_t part_size,
     const struct aws_s3_meta_request_options *options);
 
+AWS_EXTERN_C_END
+
 #endif
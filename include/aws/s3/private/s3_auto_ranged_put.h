@@ -8,6 +8,9 @@
 
 #include "aws/s3/private/s3_meta_request_impl.h"
 
+/* Passed as the content length of a body whose length is only known once its stream ends. */
+#define AWS_S3_AUTO_RANGED_PUT_UNKNOWN_CONTENT_LENGTH UINT64_MAX
+
 enum aws_s3_auto_ranged_put_request_tag {
     AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_CREATE_MULTIPART_UPLOAD,
     AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_PART,
@@ -23,23 +26,53 @@ struct aws_s3_auto_ranged_put {
     /* Useable after the Create Multipart Upload request succeeds. */
     struct aws_string *upload_id;
 
+    /* The initial request message without the headers that don't apply to parts, which the message of every part is
+     * copied from. */
+    struct aws_http_message *part_message_template;
+
     uint64_t content_length;
 
+    /* False if the body is uploaded without knowing its length up front. Parts are then read one after the other until
+     * the body stream ends, and the number of parts is only known once the last one has been read. */
+    bool content_length_known;
+
+    /* True if the meta request carries on with the multipart upload of a paused one. */
+    bool resumed;
+
     /* Only meant for use in the update function, which is never called concurrently. */
     struct {
         uint32_t next_part_number;
     } threaded_update_data;
 
+    /* Only meant for use in the prepare function when the content length isn't known, in which case parts are only ever
+     * prepared one at a time. */
+    struct {
+        /* Byte read past the end of the last part read, to find out whether that part was the last one. */
+        uint8_t next_byte;
+        bool has_next_byte;
+    } threaded_prepare_data;
+
     /* Members to only be used when the mutex in the base type is locked. */
     struct {
         struct aws_array_list etag_list;
 
+        /* Base64 encoded checksums (struct aws_string *) of the parts, indexed like etag_list, when the meta request
+         * has a checksum algorithm. */
+        struct aws_array_list checksum_list;
+
         uint32_t total_num_parts;
         uint32_t num_parts_sent;
         uint32_t num_parts_completed;
         uint32_t num_parts_successful;
         uint32_t num_parts_failed;
 
+        /* Number of parts whose body has been read, when the content length isn't known. */
+        uint32_t num_parts_read;
+
+        /* Parts whose body was read while the create-multipart-upload request was in flight, waiting for the upload id
+         * to finish being prepared (struct aws_s3_auto_ranged_put_early_part). */
+        struct aws_linked_list early_parts;
+
         struct aws_http_headers *needed_response_headers;
 
         int create_multipart_upload_error_code;
@@ -53,10 +86,52 @@ struct aws_s3_auto_ranged_put {
         uint32_t abort_multipart_upload_sent : 1;
         uint32_t abort_multipart_upload_completed : 1;
 
+        /* When the content length isn't known, set once the part at the end of the body has been read, along with
+         * total_num_parts. */
+        uint32_t last_part_read : 1;
+
+        /* Set once the meta request has been paused. The multipart upload is then left for a later meta request to
+         * resume, instead of being aborted. */
+        uint32_t paused : 1;
+
     } synced_data;
 };
 
-/* Creates a new auto-ranged put meta request.  This will do a multipart upload in parallel when appropriate. */
+/* Contents of a resume token, as appended by aws_s3_meta_request_pause for a multipart upload. */
+struct aws_s3_auto_ranged_put_resume_token {
+    struct aws_string *upload_id;
+    size_t part_size;
+    uint32_t total_num_parts;
+
+    /* ETags (struct aws_string *) of the parts that had been uploaded, indexed by part number minus one. NULL for parts
+     * that hadn't been. */
+    struct aws_array_list etag_list;
+
+    /* Checksum algorithm the multipart upload was created with, and the base64 encoded checksums (struct aws_string *)
+     * of the uploaded parts, indexed like etag_list. */
+    enum aws_s3_checksum_algorithm checksum_algorithm;
+    struct aws_array_list checksum_list;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/* Parse a resume token. On success, out_resume_token has to be cleaned up with
+ * aws_s3_auto_ranged_put_resume_token_clean_up. Raises AWS_ERROR_S3_INVALID_RESUME_TOKEN if the token can't be parsed.
+ */
+AWS_S3_API
+int aws_s3_auto_ranged_put_resume_token_parse(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor resume_token,
+    struct aws_s3_auto_ranged_put_resume_token *out_resume_token);
+
+AWS_S3_API
+void aws_s3_auto_ranged_put_resume_token_clean_up(struct aws_s3_auto_ranged_put_resume_token *resume_token);
+
+AWS_EXTERN_C_END
+
+/* Creates a new auto-ranged put meta request.  This will do a multipart upload in parallel when appropriate. If the
+ * length of the body isn't known, content_length is AWS_S3_AUTO_RANGED_PUT_UNKNOWN_CONTENT_LENGTH and num_parts is 0.
+ */
 struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_put_new(
     struct aws_allocator *allocator,
     struct aws_s3_client *client,
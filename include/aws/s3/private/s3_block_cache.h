@@ -0,0 +1,108 @@
+#ifndef AWS_S3_BLOCK_CACHE_H
+#define AWS_S3_BLOCK_CACHE_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
+#include <aws/s3/s3.h>
+
+/**
+ * Client wide cache of the bytes of objects that were downloaded, so that reading the same ranges of an object again
+ * (the footers and hot row groups of columnar files, for instance) doesn't go back to S3 for them.
+ *
+ * Objects are cut into blocks of block_size bytes, aligned to the start of the object, and only whole blocks are kept:
+ * every block but the last block of an object is block_size long. Blocks are kept per object, which is identified by
+ * the caller (by host and path, for instance), and per ETag. An object is recorded along with the ETag and size that
+ * its blocks were put in the cache with, and putting a block of another ETag drops the blocks of the old one.
+ *
+ * Once the blocks take up more than max_bytes, the least recently used ones are evicted. An object whose blocks have
+ * all been evicted is forgotten.
+ *
+ * All functions are thread safe.
+ */
+struct aws_s3_block_cache {
+    struct aws_allocator *allocator;
+
+    const uint64_t block_size;
+    const uint64_t max_bytes;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Objects (struct aws_s3_block_cache_object), by the aws_byte_cursor of their id. */
+        struct aws_hash_table objects;
+
+        /* Blocks (struct aws_s3_block_cache_block), by their struct aws_s3_block_cache_block_key. */
+        struct aws_hash_table blocks;
+
+        /* Every block, from the most to the least recently used. */
+        struct aws_linked_list lru_blocks;
+
+        /* Number of bytes held by the blocks. */
+        uint64_t num_bytes;
+    } synced_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/* Returns NULL if block_size or max_bytes is 0, or out of memory. */
+AWS_S3_API
+struct aws_s3_block_cache *aws_s3_block_cache_new(
+    struct aws_allocator *allocator,
+    uint64_t block_size,
+    uint64_t max_bytes);
+
+AWS_S3_API
+void aws_s3_block_cache_destroy(struct aws_s3_block_cache *block_cache);
+
+/* Number of blocks an object of the given size is cut into. */
+AWS_S3_API
+uint64_t aws_s3_block_cache_num_blocks(const struct aws_s3_block_cache *block_cache, uint64_t object_size);
+
+/* Appends the ETag recorded for an object to out_etag, and returns its size in out_object_size. Returns false if the
+ * object isn't known. */
+AWS_S3_API
+bool aws_s3_block_cache_get_object(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_buf *out_etag,
+    uint64_t *out_object_size);
+
+/* Forget an object and every block of it. */
+AWS_S3_API
+void aws_s3_block_cache_invalidate_object(struct aws_s3_block_cache *block_cache, struct aws_byte_cursor object_id);
+
+/* Put a block of an object in the cache, from the bytes of the whole block, recording the object with this ETag and
+ * size. Does nothing if the size of the block isn't what the size of the object says it is, or if the block is
+ * already in the cache, apart from making it the most recently used. */
+AWS_S3_API
+int aws_s3_block_cache_put_block(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t object_size,
+    uint64_t block_index,
+    struct aws_byte_cursor block);
+
+/* Appends len bytes of a block, starting offset bytes into it, to dest, growing dest if needed, and makes the block the
+ * most recently used. Returns false, leaving dest as is, if the block isn't in the cache for this ETag, or doesn't have
+ * that many bytes. */
+AWS_S3_API
+bool aws_s3_block_cache_read_block(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t block_index,
+    uint64_t offset,
+    uint64_t len,
+    struct aws_byte_buf *dest);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_BLOCK_CACHE_H */
@@ -0,0 +1,102 @@
+#ifndef AWS_S3_BUFFER_POOL_H
+#define AWS_S3_BUFFER_POOL_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/array_list.h>
+#include <aws/common/mutex.h>
+#include <aws/s3/s3.h>
+
+struct aws_allocator;
+struct aws_byte_buf;
+
+/* Alignment of the memory of every buffer handed out by a pool, which is enough for them to be written to files opened
+ * for direct I/O. */
+#define AWS_S3_BUFFER_POOL_ALIGNMENT 4096
+
+/**
+ * Client wide pool of part sized buffers.
+ *
+ * The pool does two things:
+ *  - Keeps track of how many bytes of part buffers the client has committed to (reservations), so that the client can
+ *    stop handing out new requests once a configurable memory limit is reached.
+ *  - Recycles buffers of exactly slab_size bytes, so that steady state transfers don't go back to the allocator (and
+ *    fault in fresh pages) for every part.
+ *
+ * All functions are thread safe.
+ */
+struct aws_s3_buffer_pool {
+    struct aws_allocator *allocator;
+
+    /* Wraps allocator to align buffers. Buffers handed out by the pool, and what they grow into, are allocated through
+     * it, so are accounted to allocator. */
+    struct aws_allocator *aligned_allocator;
+
+    /* Size of the buffers that are recycled. Buffers of any other size are allocated and freed as usual. */
+    const size_t slab_size;
+
+    /* Max number of bytes that can be reserved at once. 0 means there is no limit. */
+    const uint64_t memory_limit;
+
+    /* Max number of unused slabs kept around for re-use. */
+    const size_t max_free_slabs;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Slabs (uint8_t *) that are not in use and can be handed out again. */
+        struct aws_array_list free_slabs;
+
+        /* Number of bytes currently reserved. */
+        uint64_t reserved;
+    } synced_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_S3_API
+struct aws_s3_buffer_pool *aws_s3_buffer_pool_new(
+    struct aws_allocator *allocator,
+    size_t slab_size,
+    uint64_t memory_limit,
+    size_t max_free_slabs);
+
+AWS_S3_API
+void aws_s3_buffer_pool_destroy(struct aws_s3_buffer_pool *buffer_pool);
+
+/* Reserve size bytes of buffers if that doesn't go over the memory limit, returning false (and reserving nothing)
+ * otherwise. Always succeeds when nothing is reserved, so that a limit smaller than one part can never stall the client
+ * completely. The check and the reservation are made under one lock, so callers on different threads can't both get
+ * the last of the capacity. */
+AWS_S3_API
+bool aws_s3_buffer_pool_try_reserve(struct aws_s3_buffer_pool *buffer_pool, size_t size);
+
+/* Give back a reservation previously made with aws_s3_buffer_pool_try_reserve. */
+AWS_S3_API
+void aws_s3_buffer_pool_release_reservation(struct aws_s3_buffer_pool *buffer_pool, size_t size);
+
+/* Returns the number of bytes currently reserved. */
+AWS_S3_API
+uint64_t aws_s3_buffer_pool_get_reserved(struct aws_s3_buffer_pool *buffer_pool);
+
+/* Initialize out_buf with the given capacity, re-using a free slab when capacity is equal to the slab size. The memory
+ * of the buffer is aligned to AWS_S3_BUFFER_POOL_ALIGNMENT, and comes from the pool's allocator, but the buffer has an
+ * allocator of its own, so it can still be grown or cleaned up like any other aws_byte_buf, even after the pool is
+ * gone. */
+AWS_S3_API
+int aws_s3_buffer_pool_acquire_buffer(
+    struct aws_s3_buffer_pool *buffer_pool,
+    size_t capacity,
+    struct aws_byte_buf *out_buf);
+
+/* Return a buffer to the pool. Slab sized buffers are kept for re-use (up to max_free_slabs), anything else is cleaned
+ * up. buf is zeroed afterwards. */
+AWS_S3_API
+void aws_s3_buffer_pool_release_buffer(struct aws_s3_buffer_pool *buffer_pool, struct aws_byte_buf *buf);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_BUFFER_POOL_H */
@@ -0,0 +1,102 @@
+#ifndef AWS_S3_CHECKSUMS_H
+#define AWS_S3_CHECKSUMS_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/s3/s3_client.h>
+
+struct aws_allocator;
+struct aws_s3_checksum;
+
+struct aws_s3_checksum_vtable {
+    void (*destroy)(struct aws_s3_checksum *checksum);
+    int (*update)(struct aws_s3_checksum *checksum, const struct aws_byte_cursor *input);
+    int (*finalize)(struct aws_s3_checksum *checksum, struct aws_byte_buf *output);
+};
+
+/**
+ * Running checksum of data passed to it in pieces. CRC32C and CRC32 are computed with the hardware instructions of the
+ * CPU where there are any, SHA1 and SHA256 with the platform's crypto library.
+ *
+ * Not thread safe.
+ */
+struct aws_s3_checksum {
+    struct aws_allocator *allocator;
+    struct aws_s3_checksum_vtable *vtable;
+    void *impl;
+    enum aws_s3_checksum_algorithm algorithm;
+    size_t digest_size;
+
+    /* False once the checksum has been finalized, after which it can't be updated anymore. */
+    bool good;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/* Returns the size in bytes of the checksums of the algorithm, or 0 for AWS_SCA_NONE. */
+AWS_S3_API
+size_t aws_s3_checksum_get_digest_size(enum aws_s3_checksum_algorithm algorithm);
+
+/* Returns the name of the algorithm as S3 spells it (for example "CRC32C"), which is also the value of the
+ * x-amz-checksum-algorithm header. Empty for AWS_SCA_NONE. */
+AWS_S3_API
+struct aws_byte_cursor aws_s3_checksum_get_algorithm_name(enum aws_s3_checksum_algorithm algorithm);
+
+/* Returns the name of the header carrying a checksum of the algorithm (for example "x-amz-checksum-crc32c"). Empty for
+ * AWS_SCA_NONE. */
+AWS_S3_API
+struct aws_byte_cursor aws_s3_checksum_get_header_name(enum aws_s3_checksum_algorithm algorithm);
+
+/* Returns the name of the element carrying a checksum of the algorithm in the XML of S3 requests and responses (for
+ * example "ChecksumCRC32C"). Empty for AWS_SCA_NONE. */
+AWS_S3_API
+struct aws_byte_cursor aws_s3_checksum_get_xml_element_name(enum aws_s3_checksum_algorithm algorithm);
+
+/* Create a running checksum. Raises AWS_ERROR_INVALID_ARGUMENT for AWS_SCA_NONE. */
+AWS_S3_API
+struct aws_s3_checksum *aws_s3_checksum_new(struct aws_allocator *allocator, enum aws_s3_checksum_algorithm algorithm);
+
+AWS_S3_API
+void aws_s3_checksum_destroy(struct aws_s3_checksum *checksum);
+
+AWS_S3_API
+int aws_s3_checksum_update(struct aws_s3_checksum *checksum, const struct aws_byte_cursor *input);
+
+/* Append the checksum of everything passed to aws_s3_checksum_update to output, which needs room for digest_size
+ * bytes. CRCs are written in big endian order, as S3 expects them. */
+AWS_S3_API
+int aws_s3_checksum_finalize(struct aws_s3_checksum *checksum, struct aws_byte_buf *output);
+
+/* Compute the checksum of input in one go, and append it to output. */
+AWS_S3_API
+int aws_s3_checksum_compute(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *input,
+    struct aws_byte_buf *output);
+
+/* Compute the checksum of input, and append it base64 encoded (as it goes in headers and XML) to the dynamic buffer
+ * output. */
+AWS_S3_API
+int aws_s3_checksum_compute_base64(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *input,
+    struct aws_byte_buf *output);
+
+/* Like aws_s3_checksum_compute_base64, for an input made of several buffers one after the other. */
+AWS_S3_API
+int aws_s3_checksum_compute_base64_gathered(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_byte_buf *output);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_CHECKSUMS_H */
@@ -0,0 +1,41 @@
+#ifndef AWS_S3_CHUNK_STREAM_H
+#define AWS_S3_CHUNK_STREAM_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/s3/s3_client.h>
+
+struct aws_allocator;
+struct aws_input_stream;
+
+AWS_EXTERN_C_BEGIN
+
+/* Returns the length of body once aws-chunked encoded by a chunk stream of checksum_algorithm. */
+AWS_S3_API
+uint64_t aws_s3_chunk_stream_compute_length(size_t body_length, enum aws_s3_checksum_algorithm checksum_algorithm);
+
+/**
+ * Create a stream reading body encoded as a single aws-chunked chunk, followed by a trailer with the checksum of the
+ * body (the x-amz-checksum-<algorithm> header). The checksum is computed as the body is read, so the body can be sent
+ * before its checksum is known, and is only read once. Only seeking back to the start is supported.
+ *
+ * body is not copied, and has to outlive the stream.
+ */
+AWS_S3_API
+struct aws_input_stream *aws_s3_chunk_stream_new(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor body,
+    enum aws_s3_checksum_algorithm checksum_algorithm);
+
+/* Append the base64 encoded checksum sent in the trailer of a chunk stream to the dynamic buffer
+ * out_encoded_checksum. Raises AWS_ERROR_INVALID_STATE if the stream hasn't been read up to its trailer yet. */
+AWS_S3_API
+int aws_s3_chunk_stream_get_checksum(struct aws_input_stream *stream, struct aws_byte_buf *out_encoded_checksum);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_CHUNK_STREAM_H */
@@ -0,0 +1,66 @@
+#ifndef AWS_S3_CLIENT_CONTEXT_H
+#define AWS_S3_CLIENT_CONTEXT_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/atomics.h>
+#include <aws/common/mutex.h>
+#include <aws/common/ref_count.h>
+#include <aws/s3/s3_client.h>
+
+struct aws_event_loop_group;
+
+/* See aws_s3_client_context_new. */
+struct aws_s3_client_context {
+    struct aws_allocator *allocator;
+
+    struct aws_ref_count ref_count;
+
+    struct aws_event_loop_group *body_streaming_elg;
+
+    /* Budget of active connections, or 0 for no limit. Fixed once the context is created, so read without locking. */
+    const uint32_t max_active_connections;
+
+    const double throughput_target_gbps;
+
+    /* Number of attached clients that have requests in flight, ie, whose is_busy_in_client_context is set. Only
+     * changed under synced_data.lock, but read without it, so that working out a client's share doesn't contend with
+     * the other clients' scheduling. */
+    struct aws_atomic_var num_busy_clients;
+
+    struct {
+        /* Serializes clients being counted in and out of num_busy_clients. */
+        struct aws_mutex lock;
+    } synced_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Count client in or out of the busy clients, depending on whether it has requests in flight as of now. Called by an
+ * attached client whenever its number of requests in flight goes from 0 to 1, or from 1 to 0. Those transitions happen
+ * on different threads, so their calls can come in the other order, but as the number of requests in flight is read
+ * again under the context's lock, whichever call comes last leaves the client counted right. Until then (the time it
+ * takes a thread to make the call), the client's share of the budget, and that of the others, can be off by one
+ * client's worth.
+ */
+AWS_S3_API
+void aws_s3_client_context_update_busy_client(struct aws_s3_client_context *context, struct aws_s3_client *client);
+
+/**
+ * Returns the number of active connections that client gets of the budget, which is split evenly between the busy
+ * clients, and at least 1. A client that isn't busy yet gets the share it will have once it is. Returns UINT32_MAX
+ * when there is no budget. Doesn't take any locks: called for every request scheduled, it can be off by a client
+ * being counted in or out concurrently.
+ */
+AWS_S3_API
+uint32_t aws_s3_client_context_get_connection_share(
+    struct aws_s3_client_context *context,
+    struct aws_s3_client *client);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_CLIENT_CONTEXT_H */
@@ -8,6 +8,7 @@
 
 #include "aws/s3/s3_client.h"
 
+#include <aws/common/array_list.h>
 #include <aws/common/atomics.h>
 #include <aws/common/byte_buf.h>
 #include <aws/common/hash_table.h>
@@ -23,7 +24,14 @@
 struct aws_http_connection;
 struct aws_http_connection_manager;
 struct aws_host_resolver;
+struct aws_s3_buffer_pool;
+struct aws_s3_request_pool;
+struct aws_s3_block_cache;
+struct aws_s3_client_cpu_group;
 struct aws_s3_endpoint;
+struct aws_s3_slow_down_throttle;
+struct aws_s3_vip_balancer;
+struct aws_s3_balanced_vip;
 
 enum aws_s3_connection_finish_code {
     AWS_S3_CONNECTION_FINISH_CODE_SUCCESS,
@@ -54,6 +62,11 @@ struct aws_s3_endpoint_options {
     /* Bootstrap of the client to be used for spawning a connection manager. */
     struct aws_client_bootstrap *client_bootstrap;
 
+    /* CPU groups of the client, if the client pins connections to CPU groups. When set, one connection manager is
+     * spawned per CPU group, using that group's bootstrap, instead of a single one using client_bootstrap. */
+    const struct aws_s3_client_cpu_group *cpu_groups;
+    uint32_t num_cpu_groups;
+
     /* TLS connection options to be used for the connection manager. */
     const struct aws_tls_connection_options *tls_connection_options;
 
@@ -80,9 +93,49 @@ struct aws_s3_endpoint {
     /* URL of the host that this endpoint refers to. */
     struct aws_string *host_name;
 
-    /* Connection manager that manages all connections to this endpoint. */
+    /* Connection manager that manages all connections to this endpoint. When connections are pinned to CPU groups,
+     * this is the connection manager of the first CPU group. */
     struct aws_http_connection_manager *http_connection_manager;
 
+    /* One connection manager per CPU group, indexed the same as the client's cpu_groups array. NULL if connections are
+     * not pinned to CPU groups. */
+    struct aws_http_connection_manager **cpu_group_http_connection_managers;
+    uint32_t num_cpu_group_http_connection_managers;
+
+    /* Number of connection managers that have not finished shutting down yet, plus one while a host resolve is in
+     * progress. The endpoint is freed once this drops to zero. */
+    struct aws_atomic_var num_http_connection_managers_allocated;
+
+    /* Limits the rate at which requests are sent to this endpoint once it responds with SlowDown. */
+    struct aws_s3_slow_down_throttle *slow_down_throttle;
+
+    /* Spreads connections over the VIPs resolved for host_name, and keeps track of which of them are slow. Each VIP's
+     * user data is its struct aws_s3_endpoint_vip. */
+    struct aws_s3_vip_balancer *vip_balancer;
+
+    /* What connection managers of newly resolved VIPs are set up with. There is one bootstrap per CPU group, or only
+     * one if connections are not pinned to CPU groups. */
+    struct aws_client_bootstrap **client_bootstraps;
+    uint32_t num_client_bootstraps;
+    struct aws_tls_connection_options *tls_connection_options;
+    const uint32_t max_connections;
+    const int port;
+    const size_t dns_host_address_ttl_seconds;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* All VIPs (struct aws_s3_endpoint_vip *) that connection managers were created for. */
+        struct aws_array_list vips;
+
+        /* When addresses were last asked for from the host resolver, and whether that is still in progress. */
+        uint64_t last_resolve_timestamp_ns;
+        uint32_t resolve_in_progress : 1;
+
+        /* Set once the endpoint's connection managers are being released. No VIPs are added after that. */
+        uint32_t shutting_down : 1;
+    } synced_data;
+
     /* Callback for the owner of the endpoint when the endpoint's refcount hits zero. (More details in the typedef of
      * this callback.)*/
     aws_s3_endpoint_ref_zero_fn *ref_count_zero_callback;
@@ -93,6 +146,15 @@ struct aws_s3_endpoint {
     void *user_data;
 };
 
+/* One resolved address of an endpoint. Connections to it are made by IP address, with the endpoint's host name used for
+ * TLS. */
+struct aws_s3_endpoint_vip {
+    /* One connection manager per CPU group, indexed the same as the client's cpu_groups array, or a single one if
+     * connections are not pinned to CPU groups. */
+    struct aws_http_connection_manager **http_connection_managers;
+    uint32_t num_http_connection_managers;
+};
+
 /* Represents one connection on a particular VIP. */
 struct aws_s3_connection {
     /* Endpoint that this connection is connected to. */
@@ -101,6 +163,11 @@ struct aws_s3_connection {
     /* The underlying, currently in-use HTTP connection. */
     struct aws_http_connection *http_connection;
 
+    /* Connection manager that the current attempt's HTTP connection is acquired from and released to, and the VIP it
+     * was picked for (NULL when going through the host name's connection manager). */
+    struct aws_http_connection_manager *http_connection_manager;
+    struct aws_s3_balanced_vip *vip;
+
     /* Request currently being processed on this connection. */
     struct aws_s3_request *request;
 
@@ -108,6 +175,100 @@ struct aws_s3_connection {
     struct aws_retry_token *retry_token;
 };
 
+/* Resources of the client pinned to one CPU group (usually a NUMA node). A meta request assigned to a CPU group has its
+ * connections, part buffers and body streaming all on that group, so that the memory holding a part is only ever
+ * touched by threads of the node it was allocated on. */
+struct aws_s3_client_cpu_group {
+    /* Index of this entry in the client's cpu_groups array. */
+    const uint32_t index;
+
+    /* CPU group, as passed to aws_event_loop_group_new_default_pinned_to_cpu_group, that this entry is pinned to. */
+    const uint16_t cpu_group;
+
+    /* Event loop group pinned to the CPU group, used for connection I/O. */
+    struct aws_event_loop_group *event_loop_group;
+
+    /* Bootstrap on top of event_loop_group, sharing the host resolver of the client's bootstrap. Used for spawning this
+     * group's connection managers. */
+    struct aws_client_bootstrap *client_bootstrap;
+
+    /* Event loop group pinned to the CPU group, for streaming request bodies back to the user. */
+    struct aws_event_loop_group *body_streaming_elg;
+
+    /* Pool that part buffers of this group's meta requests are recycled through, so that a recycled buffer stays on
+     * the node it was first touched on. Reservations against the memory limit still go through the client's pool. */
+    struct aws_s3_buffer_pool *buffer_pool;
+};
+
+/* A slice of the client's scheduling work. Each work shard processes its work on its own event loop and owns a subset
+ * of the client's meta requests, along with the queue of requests prepared for them. Limits that apply to the client as
+ * a whole (requests in flight, active connections, memory) are tracked with the client's atomic stats, so shards never
+ * need to take each other's locks to hand out work. When both are needed, the client's lock is taken before a work
+ * shard's lock. */
+struct aws_s3_client_work_shard {
+    struct aws_s3_client *client;
+
+    /* Event loop on the client bootstrap ELG that this shard's work is processed on. */
+    struct aws_event_loop *event_loop;
+
+    /* Index of this shard in the client's work_shards array. Shard 0 also handles client wide work, such as the
+     * adaptive connection controller, stats logging and shutdown. */
+    const uint32_t index;
+
+    /* Set when this shard stopped handing out work because a client wide limit was reached, so that whichever shard
+     * frees up capacity knows to schedule it again. */
+    struct aws_atomic_var waiting_for_capacity;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* How many requests were done being prepared without being queued, because they failed to be prepared, or
+         * were served from the block cache. */
+        uint32_t num_unsent_prepare_requests;
+
+        /* Meta requests that need added in the work event loop. */
+        struct aws_linked_list pending_meta_request_work;
+
+        /* Requests that are prepared and ready to be put in the threaded_data request queue. */
+        struct aws_linked_list prepared_requests;
+
+        /* Task for processing requests from meta requests on connections. */
+        struct aws_task process_work_task;
+
+        /* Whether or not work processing is currently scheduled. */
+        uint32_t process_work_task_scheduled : 1;
+
+        /* Whether or not work process is currently in progress. */
+        uint32_t process_work_task_in_progress : 1;
+
+    } synced_data;
+
+    struct {
+        /* Queues of prepared requests that are waiting to be assigned to connections, one per meta request priority,
+         * each in FIFO order. Handing out the next request only looks at the front of the highest non-empty one. */
+        struct aws_linked_list request_queues[AWS_S3_META_REQUEST_PRIORITY_MAX];
+
+        /* List of on going meta requests assigned to this shard. */
+        struct aws_linked_list meta_requests;
+
+        /* Number of requests in the request_queues linked lists. */
+        uint32_t request_queue_size;
+
+        /* Number of requests in each of the request_queues linked lists. */
+        uint32_t request_queue_size_by_priority[AWS_S3_META_REQUEST_PRIORITY_MAX];
+
+        /* Number of requests currently being prepared. */
+        uint32_t num_requests_being_prepared;
+
+        /* Task that schedules work processing again once a SlowDown throttle will admit more requests. */
+        struct aws_task throttle_task;
+
+        /* Whether or not the throttle task is currently scheduled. */
+        bool throttle_task_scheduled;
+
+    } threaded_data;
+};
+
 struct aws_s3_client_vtable {
 
     struct aws_s3_meta_request *(
@@ -125,9 +286,9 @@ struct aws_s3_client_vtable {
         const struct aws_string *host_name,
         uint32_t flags);
 
-    void (*schedule_process_work_synced)(struct aws_s3_client *client);
+    void (*schedule_process_work_synced)(struct aws_s3_client_work_shard *work_shard);
 
-    void (*process_work)(struct aws_s3_client *client);
+    void (*process_work)(struct aws_s3_client_work_shard *work_shard);
 
     bool (*endpoint_ref_count_zero)(struct aws_s3_endpoint *endpoint);
 
@@ -147,12 +308,36 @@ struct aws_s3_client {
     /* Client bootstrap for setting up connection managers. */
     struct aws_client_bootstrap *client_bootstrap;
 
-    /* Event loop on the client bootstrap ELG for processing work/dispatching requests. */
-    struct aws_event_loop *process_work_event_loop;
+    /* Work shards for processing work/dispatching requests, each on its own event loop of the client bootstrap ELG. */
+    struct aws_s3_client_work_shard *work_shards;
+    const uint32_t num_work_shards;
+
+    /* Used to assign new meta requests to work shards round robin. */
+    struct aws_atomic_var next_work_shard_index;
+
+    /* Incremented every time a request gives back client wide capacity. Lets a work shard that is about to wait for
+     * capacity tell whether it already missed a release. */
+    struct aws_atomic_var capacity_release_count;
 
-    /* Event loop group for streaming request bodies back to the user. */
+    /* Event loop group for streaming request bodies back to the user. When the client pins work to CPU groups, this is
+     * a reference to the body streaming ELG of the first CPU group, or else to that of the client context, if any. */
     struct aws_event_loop_group *body_streaming_elg;
 
+    /* Client context the client is attached to, or NULL. */
+    struct aws_s3_client_context *client_context;
+
+    /* Whether the client is counted as one of client_context's busy clients. Only changed under the lock of
+     * client_context, but read without it. */
+    struct aws_atomic_var is_busy_in_client_context;
+
+    /* CPU groups that meta requests are pinned to. NULL (and num_cpu_groups is 0) unless enable_cpu_group_affinity was
+     * set and there is more than one CPU group to choose from. */
+    struct aws_s3_client_cpu_group *cpu_groups;
+    const uint32_t num_cpu_groups;
+
+    /* Used to assign new meta requests to CPU groups round robin. */
+    struct aws_atomic_var next_cpu_group_index;
+
     /* Region of the S3 bucket. */
     struct aws_string *region;
 
@@ -170,6 +355,10 @@ struct aws_s3_client {
     /* Cached signing config. Can be NULL if no signing config was specified. */
     struct aws_cached_signing_config_aws *cached_signing_config;
 
+    /* What is known of the instance type that the client runs on, as given by instance_type in the client config or
+     * detected. NULL if it isn't known. Points into the library's table, which outlives the client. */
+    const struct aws_s3_compute_platform_info *platform_info;
+
     /* Throughput target in Gbps that we are trying to reach. */
     const double throughput_target_gbps;
 
@@ -183,14 +372,48 @@ struct aws_s3_client {
      *     specified, and this is set to AWS_MR_CONTENT_MD5_ENABLED, it will be calculated. */
     const enum aws_s3_meta_request_compute_content_md5 compute_content_md5;
 
+    /* Checksum that uploads are sent with, unless their meta request asks for another one. */
+    const enum aws_s3_checksum_algorithm checksum_algorithm;
+
+    /* How payloads are signed, unless their meta request asks for something else. */
+    const enum aws_s3_payload_signing_mode payload_signing_mode;
+
     /* Hard limit on max connections set through the client config. */
     const uint32_t max_active_connections_override;
 
+    /* True if the number of active connections is adjusted at runtime based on measured throughput. */
+    const bool enable_adaptive_connections;
+
+    /* True if GET meta requests only request parts within their read window. */
+    const bool enable_read_backpressure;
+
+    /* Read window that each meta request starts out with, when enable_read_backpressure is true. */
+    const size_t initial_read_window;
+
+    /* Current limit on active connections picked by the adaptive connection controller. Only used when
+     * enable_adaptive_connections is true. */
     struct aws_atomic_var max_allowed_connections;
 
+    /* Most connections that the adaptive connection controller can allow. Can be above the static limit derived from
+     * the throughput target. */
+    const uint32_t max_adaptive_connections;
+
+    /* 1 while the adaptive connection controller's task is scheduled on work shard 0's event loop. It runs once per
+     * sample interval for as long as the client has requests in flight. */
+    struct aws_atomic_var connection_controller_task_scheduled;
+
     /* Retry strategy used for scheduling request retries. */
     struct aws_retry_strategy *retry_strategy;
 
+    /* Pool of part sized buffers shared by all meta requests, which also tracks the memory limit. */
+    struct aws_s3_buffer_pool *buffer_pool;
+
+    /* Free list that the request structures of all meta requests are recycled through. */
+    struct aws_s3_request_pool *request_pool;
+
+    /* Cache of the blocks of downloaded objects, shared by all meta requests. NULL if the block cache is disabled. */
+    struct aws_s3_block_cache *block_cache;
+
     /* Shutdown callbacks to notify when the client is completely cleaned up. */
     aws_s3_client_shutdown_complete_callback_fn *shutdown_callback;
     void *shutdown_callback_user_data;
@@ -207,6 +430,12 @@ struct aws_s3_client {
 
         /* Number of requests currently scheduled to be streamed or are actively being streamed. */
         struct aws_atomic_var num_requests_streaming;
+
+        /* Number of request and response body bytes of successfully finished requests. */
+        struct aws_atomic_var num_bytes_transferred;
+
+        /* Number of SlowDown responses received. */
+        struct aws_atomic_var num_slow_down_errors;
     } stats;
 
     struct {
@@ -215,55 +444,50 @@ struct aws_s3_client {
         /* Hash table of endpoints that are in-use by the client.*/
         struct aws_hash_table endpoints;
 
-        /* How many requests failed to be prepared. */
-        uint32_t num_failed_prepare_requests;
-
-        /* Meta requests that need added in the work event loop. */
-        struct aws_linked_list pending_meta_request_work;
-
-        /* Requests that are prepared and ready to be put in the threaded_data request queue. */
-        struct aws_linked_list prepared_requests;
-
-        /* Task for processing requests from meta requests on connections. */
-        struct aws_task process_work_task;
-
         /* Number of endpoints currently allocated. Used during clean up to know how many endpoints are still in
          * memory.*/
         uint32_t num_endpoints_allocated;
 
+        /* References (aws_s3_endpoint *) to endpoints set up by aws_s3_client_prewarm_endpoint, held until the
+         * client starts shutting down so that their connections are still around for the first meta requests. */
+        struct aws_array_list prewarmed_endpoints;
+
         /* Whether or not the client has started cleaning up all of its resources */
         uint32_t active : 1;
 
         /* True if the start_destroy function is still executing, which blocks shutdown from completing. */
         uint32_t start_destroy_executing : 1;
 
-        /* Whether or not work processing is currently scheduled. */
-        uint32_t process_work_task_scheduled : 1;
-
-        /* Whether or not work process is currently in progress. */
-        uint32_t process_work_task_in_progress : 1;
-
         /* Whether or not the body streaming ELG is allocated. If the body streaming ELG is NULL, but this is true, the
          * shutdown callback has not yet been called.*/
         uint32_t body_streaming_elg_allocated : 1;
 
+        /* Number of CPU group event loop groups that have not finished shutting down yet. */
+        uint32_t num_cpu_group_elgs_allocated;
+
         /* True if client has been flagged to finish destroying itself. Used to catch double-destroy bugs.*/
         uint32_t finish_destroy : 1;
 
     } synced_data;
 
+    /* Data only accessed from the event loop of work shard 0. */
     struct {
-        /* Queue of prepared requests that are waiting to be assigned to connections. */
-        struct aws_linked_list request_queue;
+        /* State of the adaptive connection controller, sampled once per interval. */
+        struct {
+            /* Time of the last sample. Zero if no sample has been taken yet. */
+            uint64_t last_sample_timestamp_ns;
 
-        /* Client list of on going meta requests. */
-        struct aws_linked_list meta_requests;
+            /* Values of the matching stats counters at the time of the last sample. */
+            size_t last_num_bytes_transferred;
+            size_t last_num_slow_down_errors;
 
-        /* Number of requests in the request_queue linked_list. */
-        uint32_t request_queue_size;
+            /* Throughput measured over the last sample interval, overall and per active connection. */
+            double last_throughput_bytes_per_sec;
+            double last_throughput_bytes_per_sec_per_connection;
 
-        /* Number of requests currently being prepared. */
-        uint32_t num_requests_being_prepared;
+            /* Task that runs the controller once per sample interval. See connection_controller_task_scheduled. */
+            struct aws_task task;
+        } connection_controller;
 
     } threaded_data;
 };
@@ -289,26 +513,40 @@ uint32_t aws_s3_client_get_max_active_connections(
     struct aws_s3_client *client,
     struct aws_s3_meta_request *meta_request);
 
+AWS_S3_API
+uint32_t aws_s3_client_get_max_connections_budget(struct aws_s3_client *client);
+
 AWS_S3_API
 uint32_t aws_s3_client_get_max_requests_in_flight(struct aws_s3_client *client);
 
 AWS_S3_API
 uint32_t aws_s3_client_queue_requests_threaded(
-    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard,
     struct aws_linked_list *request_list,
     bool queue_front);
 
 AWS_S3_API
-struct aws_s3_request *aws_s3_client_dequeue_request_threaded(struct aws_s3_client *client);
+struct aws_s3_request *aws_s3_client_dequeue_request_threaded(struct aws_s3_client_work_shard *work_shard);
 
+/* Schedule work processing on every work shard of the client. */
 AWS_S3_API
 void aws_s3_client_schedule_process_work(struct aws_s3_client *client);
 
+/* Schedule work processing on the work shard that the meta request is assigned to. */
+AWS_S3_API
+void aws_s3_client_schedule_meta_request_work(struct aws_s3_client *client, struct aws_s3_meta_request *meta_request);
+
+AWS_S3_API
+void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client_work_shard *work_shard);
+
 AWS_S3_API
-void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client *client);
+void aws_s3_client_update_connections_threaded(struct aws_s3_client_work_shard *work_shard);
 
+/* Samples throughput and SlowDown counters and, if a full sample interval has passed, adjusts the client's
+ * max_allowed_connections. Does nothing unless enable_adaptive_connections is set. Called by the connection controller
+ * task, on work shard 0's event loop. */
 AWS_S3_API
-void aws_s3_client_update_connections_threaded(struct aws_s3_client *client);
+void aws_s3_client_update_max_allowed_connections_threaded(struct aws_s3_client *client, uint64_t now_ns);
 
 AWS_S3_API
 struct aws_s3_endpoint *aws_s3_endpoint_new(
@@ -320,12 +558,64 @@ AWS_S3_API void aws_s3_client_lock_synced_data(struct aws_s3_client *client);
 AWS_S3_API
 void aws_s3_client_unlock_synced_data(struct aws_s3_client *client);
 
+AWS_S3_API
+void aws_s3_client_work_shard_lock_synced_data(struct aws_s3_client_work_shard *work_shard);
+
+AWS_S3_API
+void aws_s3_client_work_shard_unlock_synced_data(struct aws_s3_client_work_shard *work_shard);
+
 AWS_S3_API
 struct aws_s3_endpoint *aws_s3_endpoint_acquire(struct aws_s3_endpoint *endpoint);
 
+/* Returns the connection manager to use for connections of the given CPU group. Falls back to the endpoint's only
+ * connection manager if connections are not pinned to CPU groups. */
+AWS_S3_API
+struct aws_http_connection_manager *aws_s3_endpoint_get_http_connection_manager(
+    struct aws_s3_endpoint *endpoint,
+    const struct aws_s3_client_cpu_group *cpu_group);
+
+/* Picks the connection manager a new connection for a meta request on cpu_group should come from: the one of the
+ * endpoint's least loaded VIP that isn't being avoided for being slow. Falls back to
+ * aws_s3_endpoint_get_http_connection_manager while no VIP is known yet. out_vip is set to the VIP picked, or NULL, and
+ * has to be given back with aws_s3_endpoint_release_vip. */
+AWS_S3_API
+struct aws_http_connection_manager *aws_s3_endpoint_acquire_vip_connection_manager(
+    struct aws_s3_endpoint *endpoint,
+    const struct aws_s3_client_cpu_group *cpu_group,
+    struct aws_s3_balanced_vip **out_vip);
+
+/* Give back a VIP picked by aws_s3_endpoint_acquire_vip_connection_manager, recording how the request sent over it
+ * went. Does nothing if vip is NULL. */
+AWS_S3_API
+void aws_s3_endpoint_release_vip(
+    struct aws_s3_endpoint *endpoint,
+    struct aws_s3_balanced_vip *vip,
+    bool failed,
+    uint64_t num_bytes,
+    uint64_t duration_ns);
+
+/* Returns the buffer pool that part buffers of the meta request should be acquired from and released to. */
+AWS_S3_API
+struct aws_s3_buffer_pool *aws_s3_client_get_part_buffer_pool(
+    struct aws_s3_client *client,
+    struct aws_s3_meta_request *meta_request);
+
 AWS_S3_API
 void aws_s3_endpoint_release(struct aws_s3_endpoint *endpoint);
 
+/* Open num_connections idle connections to the endpoint, spread over its connection managers. The connections are
+ * acquired all at once and only released back to their connection manager after all of them are open, so that the
+ * connection manager can't hand the same connection out twice. callback is optional. */
+AWS_S3_API
+int aws_s3_endpoint_prewarm(
+    struct aws_s3_endpoint *endpoint,
+    uint32_t num_connections,
+    aws_s3_client_prewarm_endpoint_callback_fn *callback,
+    void *user_data);
+
+AWS_S3_API
+extern const double g_throughput_per_vip_gbps;
+
 AWS_S3_API
 extern const uint32_t g_max_num_connections_per_vip;
 
@@ -25,6 +25,10 @@ struct aws_s3_copy_object {
     /* Useable after the Create Multipart Upload request succeeds. */
     struct aws_string *upload_id;
 
+    /* The initial request message without the headers that don't apply to parts, which the message of every part is
+     * copied from. */
+    struct aws_http_message *part_message_template;
+
     /* Only meant for use in the update function, which is never called concurrently. */
     struct {
         uint32_t next_part_number;
@@ -15,6 +15,13 @@ struct aws_s3_meta_request_default {
 
     size_t content_length;
 
+    /* The response body is passed to the body callback from the thread of the connection, as soon as the response is
+     * complete. Set for meta requests created with small_object_hint. */
+    uint32_t deliver_body_inline : 1;
+
+    /* The response body is passed to the body callback as it arrives. See enable_direct_body_streaming. */
+    uint32_t stream_body_directly : 1;
+
     /* Members to only be used when the mutex in the base type is locked. */
     struct {
         int cached_response_status;
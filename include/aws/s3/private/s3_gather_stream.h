@@ -0,0 +1,29 @@
+#ifndef AWS_S3_GATHER_STREAM_H
+#define AWS_S3_GATHER_STREAM_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/s3/s3.h>
+
+struct aws_allocator;
+struct aws_input_stream;
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Create a stream reading a list of buffers one after the other, as if they were one. The list is copied, but the
+ * bytes of the buffers aren't, and have to outlive the stream.
+ */
+AWS_S3_API
+struct aws_input_stream *aws_s3_gather_stream_new(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_GATHER_STREAM_H */
@@ -53,6 +53,16 @@ typedef bool(aws_s3_on_object_fn)(const struct aws_s3_object_info *info, void *u
  */
 typedef void(aws_s3_on_object_list_finished)(struct aws_s3_paginator *paginator, int error_code, void *user_data);
 
+/**
+ * Invoked as soon as the continuation token for the next page has been parsed, which is usually well before the current
+ * page is done. The token can be used to start listing the next page with another paginator right away. Only valid for
+ * the duration of the call.
+ */
+typedef void(aws_s3_on_continuation_token_fn)(
+    struct aws_s3_paginator *paginator,
+    struct aws_byte_cursor continuation_token,
+    void *user_data);
+
 /**
  * Parameters for calling aws_s3_initiate_list_objects(). All values are copied out or re-seated and reference counted.
  */
@@ -79,6 +89,10 @@ struct aws_s3_list_objects_params {
      * unless you have a special use case.
      */
     struct aws_byte_cursor continuation_token;
+    /**
+     * Optional. Only keys that come after this one, in the order S3 lists keys in, are listed.
+     */
+    struct aws_byte_cursor start_after;
     /**
      * Must not be empty. The endpoint for the S3 bucket to hit. Can be virtual or path style.
      */
@@ -91,6 +105,10 @@ struct aws_s3_list_objects_params {
      * Callback to invoke when each page of the bucket listing completes.
      */
     aws_s3_on_object_list_finished *on_list_finished;
+    /**
+     * Optional. Callback to invoke when the continuation token of the next page has been parsed.
+     */
+    aws_s3_on_continuation_token_fn *on_continuation_token;
     void *user_data;
 };
 
@@ -131,6 +149,13 @@ AWS_S3_API int aws_s3_paginator_continue(
  */
 AWS_S3_API bool aws_s3_paginator_has_more_results(const struct aws_s3_paginator *paginator);
 
+/**
+ * Feed the next bytes of a ListObjectsV2 response body to the paginator. Objects and prefixes are passed to on_object,
+ * and the continuation token to on_continuation_token, as soon as their element is complete, so only the element that
+ * is still arriving is ever held in memory. This is what the requests of the paginator have their body passed to.
+ */
+AWS_S3_API int aws_s3_paginator_parse_page_body(struct aws_s3_paginator *paginator, struct aws_byte_cursor body);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_S3_FILE_SYSTEM_SUPPORT_H */
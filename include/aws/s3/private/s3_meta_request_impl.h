@@ -7,6 +7,7 @@
  */
 
 #include <aws/auth/signing.h>
+#include <aws/common/array_list.h>
 #include <aws/common/atomics.h>
 #include <aws/common/linked_list.h>
 #include <aws/common/mutex.h>
@@ -18,8 +19,11 @@
 #include "aws/s3/private/s3_request.h"
 
 struct aws_s3_client;
+struct aws_s3_client_cpu_group;
+struct aws_s3_client_work_shard;
 struct aws_s3_connection;
 struct aws_s3_meta_request;
+struct aws_s3_recv_file;
 struct aws_s3_request;
 struct aws_s3_request_options;
 struct aws_http_headers;
@@ -75,6 +79,9 @@ struct aws_s3_meta_request_vtable {
         aws_signing_complete_fn *on_signing_complete,
         void *user_data);
 
+    /* Called the first time the request is put on a connection (not for retries). Optional. */
+    void (*request_sent)(struct aws_s3_meta_request *meta_request, struct aws_s3_request *request);
+
     /* Called when any sending of the request is finished, including for each retry. */
     void (*send_request_finish)(struct aws_s3_connection *connection, struct aws_http_stream *stream, int error_code);
 
@@ -84,10 +91,20 @@ struct aws_s3_meta_request_vtable {
     /* Called by the derived meta request when the meta request is completely finished. */
     void (*finish)(struct aws_s3_meta_request *meta_request);
 
+    /* Pause the meta request, appending a token to resume it with to out_resume_token. NULL if the meta request can't
+     * be paused. */
+    int (*pause)(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *out_resume_token);
+
     /* Handle de-allocation of the meta request. */
     void (*destroy)(struct aws_s3_meta_request *);
 };
 
+/* A send buffer of the caller, and where it starts in the body. */
+struct aws_s3_send_buffer {
+    struct aws_byte_cursor data;
+    uint64_t offset;
+};
+
 /**
  * This represents one meta request, ie, one accelerated file transfer.  One S3 meta request can represent multiple S3
  * requests.
@@ -128,15 +145,43 @@ struct aws_s3_meta_request {
     aws_s3_meta_request_finish_fn *finish_callback;
     aws_s3_meta_request_shutdown_fn *shutdown_callback;
     aws_s3_meta_request_progress_fn *progress_callback;
+    aws_s3_meta_request_telemetry_fn *telemetry_callback;
+
+    /* Source that the body can be read from at any offset, so that parts can be read concurrently. Both are NULL if
+     * the body is read from the body stream of the initial message. */
+    struct aws_string *send_filepath;
+    aws_s3_meta_request_read_body_at_fn *read_body_at_callback;
+
+    /* Buffers of the caller that the body is made of (struct aws_s3_send_buffer), in order, if the body is read from
+     * neither of the above nor the body stream. Borrowed until send_buffers_release_callback is invoked. */
+    struct aws_array_list send_buffers;
+    aws_s3_meta_request_send_buffers_release_fn *send_buffers_release_callback;
+
+    /* File the response body is written to, or NULL. Closed when the meta request finishes. The body callback of the
+     * caller is then only invoked once each part has been written, and is kept here instead. */
+    struct aws_s3_recv_file *recv_file;
+    aws_s3_meta_request_receive_body_callback_fn *recv_file_body_callback;
 
     enum aws_s3_meta_request_type type;
 
     struct {
         struct aws_mutex lock;
 
-        /* Priority queue for pending streaming requests.  We use a priority queue to keep parts in order so that we
-         * can stream them to the caller in order. */
-        struct aws_priority_queue pending_body_streaming_requests;
+        /* Requests whose body is waiting on the parts before it to be streamed to the caller. Part numbers are
+         * dense and never far past next_streaming_part, so the requests are kept in a ring buffer indexed by how far
+         * past next_streaming_part their part number is: storing a part, and taking out the run of parts it unblocks,
+         * needs no searching. The buffer has a power of two number of slots, and grows when a part arrives further
+         * ahead than it can hold. */
+        struct {
+            struct aws_s3_request **requests;
+            uint32_t capacity;
+
+            /* Slot of next_streaming_part. */
+            uint32_t start;
+
+            /* Number of requests in the buffer. */
+            uint32_t size;
+        } pending_body_streaming_requests;
 
         /* Current state of the meta request. */
         enum aws_s3_meta_request_state state;
@@ -158,6 +203,10 @@ struct aws_s3_meta_request {
         /* Number of parts that have failed while trying to be delivered to the caller. */
         uint32_t num_parts_delivery_failed;
 
+        /* Running total of the bytes the caller has opened the read window by, including the initial window. Only
+         * used when the client has read backpressure enabled. */
+        uint64_t read_window_running_total;
+
         /* The end finish result of the meta request. */
         struct aws_s3_meta_request_result finish_result;
 
@@ -176,9 +225,70 @@ struct aws_s3_meta_request {
         /* True if this meta request is currently in the client's list. */
         bool scheduled;
 
+        /* Number of requests this meta request can still have prepared before yielding to the next meta request of
+         * the same priority. Replenished with the meta request's weight. */
+        uint32_t deficit;
+
+        /* Request that was handed out by update, but whose part buffer didn't fit under the client's memory limit. It
+         * is sent before any new request is asked for. */
+        struct aws_s3_request *pending_request;
+
     } client_process_work_threaded_data;
 
+    /* Counters reported by aws_s3_meta_request_get_metrics. Updated by the client as this meta request's requests make
+     * progress. */
+    struct {
+        /* Number of requests of this meta request being tracked by the client. */
+        struct aws_atomic_var num_requests_in_flight;
+
+        /* Number of requests of this meta request being sent/received over the network. */
+        struct aws_atomic_var num_requests_network_io;
+
+        /* Number of request and response body bytes of successfully finished requests. */
+        struct aws_atomic_var num_bytes_transferred;
+
+        /* Number of requests that finished successfully. */
+        struct aws_atomic_var num_requests_succeeded;
+
+        /* Number of requests that finished unsuccessfully. */
+        struct aws_atomic_var num_requests_failed;
+
+        /* Number of request retries scheduled. */
+        struct aws_atomic_var num_retries;
+
+        /* Sum of the latencies of all successfully finished requests. */
+        struct aws_atomic_var total_request_latency_ns;
+    } stats;
+
+    /* Work shard of the client that schedules this meta request. Assigned by the client before the meta request is
+     * handed to any of its work shards, and never changed afterwards. NULL if the meta request was not made through a
+     * client. */
+    struct aws_s3_client_work_shard *work_shard;
+
+    /* CPU group of the client that this meta request's connections, part buffers and body streaming are pinned to.
+     * Assigned along with work_shard. NULL if the client does not pin work to CPU groups. */
+    struct aws_s3_client_cpu_group *cpu_group;
+
     const bool should_compute_content_md5;
+
+    /* Checksum that the body of this meta request is uploaded with. Always AWS_SCA_NONE for meta requests that don't
+     * upload a body. */
+    const enum aws_s3_checksum_algorithm checksum_algorithm;
+
+    /* True if response bodies are checked against the checksums S3 sends with them. */
+    const bool validate_response_checksum;
+
+    /* How the payloads of requests are signed. AWS_S3_PAYLOAD_SIGNING_MODE_DEFAULT leaves it to the signing config. */
+    const enum aws_s3_payload_signing_mode payload_signing_mode;
+
+    /* Scheduling priority of this meta request. Never AWS_S3_META_REQUEST_PRIORITY_DEFAULT after initialization. */
+    const enum aws_s3_meta_request_priority priority;
+
+    /* Number of requests this meta request can have prepared per scheduling turn. Always at least 1. */
+    const uint32_t weight;
+
+    /* Order in which response bodies are delivered to the body callback. */
+    const enum aws_s3_meta_request_delivery delivery;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -229,9 +339,46 @@ void aws_s3_meta_request_prepare_request(
     aws_s3_meta_request_prepare_request_callback_fn *callback,
     void *user_data);
 
+/* Default implementation of schedule_prepare_request: prepares the request and signs it on the event loop returned by
+ * aws_s3_meta_request_get_prepare_event_loop, then calls callback. */
+AWS_S3_API
+void aws_s3_meta_request_schedule_prepare_request_default(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    aws_s3_meta_request_prepare_request_callback_fn *callback,
+    void *user_data);
+
+/* Event loop to prepare the next request of the meta request on. Reading the body of a meta request in order takes its
+ * requests to be prepared one after the other, on the meta request's own event loop. */
+AWS_S3_API
+struct aws_event_loop *aws_s3_meta_request_get_prepare_event_loop(struct aws_s3_meta_request *meta_request);
+
 AWS_S3_API
 void aws_s3_meta_request_send_request(struct aws_s3_meta_request *meta_request, struct aws_s3_connection *connection);
 
+/* Record that request is being put on a connection, telling the meta request the first time it is. Called by
+ * aws_s3_meta_request_send_request, and by transports that serve requests without it. */
+AWS_S3_API
+void aws_s3_meta_request_on_request_sent(struct aws_s3_meta_request *meta_request, struct aws_s3_request *request);
+
+/* Pass the response to the request of a connection to the meta request, as it arrives. These are what the callbacks of
+ * the HTTP stream made by aws_s3_meta_request_send_request call, and are there for transports that serve requests
+ * without an HTTP stream (see s3_mock_transport.h). aws_s3_meta_request_on_response_complete is called once, after
+ * the headers and the body, and takes the place of the stream's on_complete callback. */
+AWS_S3_API
+int aws_s3_meta_request_on_response_headers(
+    struct aws_s3_connection *connection,
+    int response_status,
+    enum aws_http_header_block header_block,
+    const struct aws_http_header *headers,
+    size_t headers_count);
+
+AWS_S3_API
+int aws_s3_meta_request_on_response_body(struct aws_s3_connection *connection, const struct aws_byte_cursor *data);
+
+AWS_S3_API
+void aws_s3_meta_request_on_response_complete(struct aws_s3_connection *connection, int error_code);
+
 AWS_S3_API
 void aws_s3_meta_request_init_signing_date_time_default(
     struct aws_s3_meta_request *meta_request,
@@ -267,10 +414,40 @@ void aws_s3_meta_request_stream_response_body_synced(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request);
 
-/* Read from the meta request's input stream. Should always be done outside of any mutex, as reading from the stream
- * could cause user code to call back into aws-c-s3.*/
+/* Read the part of the body starting at offset. Should always be done outside of any mutex, as reading from the body
+ * could cause user code to call back into aws-c-s3. If the body is read from the input stream of the initial message,
+ * the stream is just read from where the last read left off, so parts have to be read in order, one at a time. */
+AWS_S3_API
+int aws_s3_meta_request_read_body(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *buffer);
+
+/* Returns true if the body can be read at any offset, rather than only in order from the initial message's body stream.
+ */
+AWS_S3_API
+bool aws_s3_meta_request_has_positional_body(const struct aws_s3_meta_request *meta_request);
+
+/* Returns true if the body is made of send buffers of the caller. */
+AWS_S3_API
+bool aws_s3_meta_request_has_send_buffers(const struct aws_s3_meta_request *meta_request);
+
+/* Push the pieces of the send buffers that len bytes of the body starting at offset are made of onto segments (a list
+ * of struct aws_byte_cursor), without copying any bytes. Raises AWS_ERROR_S3_INCORRECT_CONTENT_LENGTH if the buffers
+ * end before that. */
 AWS_S3_API
-int aws_s3_meta_request_read_body(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *buffer);
+int aws_s3_meta_request_get_send_buffer_segments(
+    const struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    uint64_t len,
+    struct aws_array_list *segments);
+
+/* Initialize a buffer to hold the body of a part, taking it from the client's buffer pool when possible. */
+AWS_S3_API
+int aws_s3_meta_request_init_part_buffer(
+    struct aws_s3_meta_request *meta_request,
+    size_t capacity,
+    struct aws_byte_buf *out_buf);
 
 /* Set the meta request finish result as failed. This is meant to be called sometime before aws_s3_meta_request_finish.
  * Subsequent calls to this function or to aws_s3_meta_request_set_success_synced will not overwrite the end result of
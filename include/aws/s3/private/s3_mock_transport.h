@@ -0,0 +1,90 @@
+#ifndef AWS_S3_MOCK_TRANSPORT_H
+#define AWS_S3_MOCK_TRANSPORT_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/s3.h>
+
+struct aws_s3_client;
+struct aws_s3_mock_transport;
+
+struct aws_s3_mock_transport_options {
+    /* Time between a request being sent and its response starting to arrive. */
+    uint64_t latency_ns;
+
+    /* Bandwidth of the link that all requests share, request and response bodies together. 0 for no limit, in which
+     * case requests are only held up by latency_ns. */
+    uint64_t bytes_per_second;
+
+    /* Fractions (between 0 and 1) of requests that get a 503 SlowDown, and a 500 InternalError, instead of their
+     * response. */
+    double slow_down_rate;
+    double internal_error_rate;
+
+    /* Fraction (between 0 and 1) of the GETs that would have gotten their body that only get the first half of it, as
+     * if the connection had dropped. */
+    double truncation_rate;
+
+    /* Size of every object, as returned to GETs and HEADs, and as copied by copies. */
+    uint64_t object_size;
+
+    /* Number of addresses that every host is reported to have, which the client sizes its connection count by. 0
+     * behaves as if the host hadn't been resolved yet. */
+    uint32_t num_host_addresses;
+
+    /* Seed of the choice of the requests that fail, so that runs can be repeated. */
+    uint64_t seed;
+};
+
+/* Counters of a mock transport, as returned by aws_s3_mock_transport_get_stats. */
+struct aws_s3_mock_transport_stats {
+    uint64_t num_requests;
+    uint64_t num_slow_downs;
+    uint64_t num_internal_errors;
+    uint64_t num_truncated_responses;
+    uint64_t num_request_body_bytes;
+    uint64_t num_response_body_bytes;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * In-process stand-in for S3 and the network, for profiling the client (its work loop, the preparing and signing of
+ * requests, and the streaming of bodies) on its own. Once installed on a client, requests are never sent: each one
+ * gets a synthetic response, made up from its method, query and headers, after the configured latency and bandwidth:
+ *  - GETs (ranged or not) and HEADs of an object of object_size bytes
+ *  - PUTs, copies, and every step of multipart uploads and copies
+ *  - ListObjectsV2, with no objects
+ * Responses go through the same retries, body handling and telemetry as those of HTTP streams.
+ *
+ * Returns NULL on failure. Check aws_last_error() for details on the error that occurred.
+ */
+AWS_S3_API
+struct aws_s3_mock_transport *aws_s3_mock_transport_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_mock_transport_options *options);
+
+/* Must not be called before the client the transport is installed on has finished shutting down. */
+AWS_S3_API
+void aws_s3_mock_transport_destroy(struct aws_s3_mock_transport *transport);
+
+/**
+ * Serve the requests of client with the transport, by replacing the acquire_http_connection and get_host_address_count
+ * functions of its vtable. Must be called right after the client is created, before it is used. A transport can only
+ * be installed on one client at a time, and the number of host addresses is process wide, as get_host_address_count
+ * has no way of telling which client it is called for.
+ */
+AWS_S3_API
+void aws_s3_mock_transport_install(struct aws_s3_mock_transport *transport, struct aws_s3_client *client);
+
+AWS_S3_API
+void aws_s3_mock_transport_get_stats(
+    struct aws_s3_mock_transport *transport,
+    struct aws_s3_mock_transport_stats *out_stats);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_MOCK_TRANSPORT_H */
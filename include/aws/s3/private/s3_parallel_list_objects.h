@@ -0,0 +1,95 @@
+#ifndef AWS_S3_PARALLEL_LIST_OBJECTS_H
+#define AWS_S3_PARALLEL_LIST_OBJECTS_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/private/s3_list_objects.h>
+
+struct aws_s3_parallel_list_objects;
+
+/**
+ * Invoked once the whole listing is done, or has stopped because of an error, or because on_object returned false.
+ * No on_object callback is invoked after this.
+ */
+typedef void(aws_s3_on_parallel_list_finished_fn)(
+    struct aws_s3_parallel_list_objects *list,
+    int error_code,
+    void *user_data);
+
+/**
+ * Parameters for calling aws_s3_initiate_parallel_list_objects(). All values are copied out or re-seated and reference
+ * counted.
+ */
+struct aws_s3_parallel_list_objects_params {
+    /**
+     * Must not be NULL. The internal call will increment the reference count on client.
+     */
+    struct aws_s3_client *client;
+    /**
+     * Must not be empty. Name of the bucket to list.
+     */
+    struct aws_byte_cursor bucket_name;
+    /**
+     * Must not be empty. The endpoint for the S3 bucket to hit.
+     */
+    struct aws_byte_cursor endpoint;
+    /**
+     * Optional. Only keys starting with this prefix are listed.
+     */
+    struct aws_byte_cursor prefix;
+    /**
+     * Optional. Used to find out how to split the listing, when there are no split points: the prefix is listed once
+     * with this delimiter, and every common prefix found is then listed in full, concurrently. Common prefixes are
+     * not passed to on_object themselves, the objects under them are.
+     */
+    struct aws_byte_cursor delimiter;
+    /**
+     * Optional. Keys splitting the key space into ranges that are listed concurrently, in ascending order (the order S3
+     * lists keys in). Each range ends with its split point included. Takes precedence over delimiter.
+     */
+    const struct aws_byte_cursor *split_points;
+    size_t num_split_points;
+    /**
+     * Optional. Max number of listings running at the same time. Defaults to 16.
+     */
+    uint32_t max_concurrent_listings;
+    /**
+     * Must not be NULL. Signing config for every request of the listing. Copied.
+     */
+    const struct aws_signing_config_aws *signing_config;
+    /**
+     * Callback to invoke on each object that's listed. Invocations never overlap, but they come from different
+     * threads, and objects of different ranges or prefixes are interleaved. Return false to stop the listing.
+     */
+    aws_s3_on_object_fn *on_object;
+    /**
+     * Callback to invoke once the whole listing is done.
+     */
+    aws_s3_on_parallel_list_finished_fn *on_list_finished;
+    void *user_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Starts listing a bucket with many paginators at once, each one for a part of the key space, over the connections of
+ * the client. Objects of all of them are passed to the same on_object callback.
+ *
+ * Returns NULL on failure. Check aws_last_error() for details on the error that occurred.
+ *
+ * This is a reference counted object, returned with a reference count of 1. You must call
+ * aws_s3_parallel_list_objects_release() on it when you are finished with it. The listing keeps going until
+ * on_list_finished is invoked whether or not it is released before then.
+ */
+AWS_S3_API struct aws_s3_parallel_list_objects *aws_s3_initiate_parallel_list_objects(
+    struct aws_allocator *allocator,
+    const struct aws_s3_parallel_list_objects_params *params);
+AWS_S3_API void aws_s3_parallel_list_objects_acquire(struct aws_s3_parallel_list_objects *list);
+AWS_S3_API void aws_s3_parallel_list_objects_release(struct aws_s3_parallel_list_objects *list);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_PARALLEL_LIST_OBJECTS_H */
@@ -0,0 +1,52 @@
+#ifndef AWS_S3_RECV_FILE_H
+#define AWS_S3_RECV_FILE_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/s3/s3.h>
+
+/**
+ * File that the body of a GET is written to, each part at its own offset, with positional writes that don't share a
+ * file position, so that parts can be written from any number of threads at once, in any order.
+ *
+ * Offsets are those of the object. The file starts at the origin, the offset of the object that the first byte of the
+ * file comes from (the start of the range of a ranged GET, for instance).
+ *
+ * With direct I/O, writes whose memory, offset in the file and length are all aligned to AWS_S3_BUFFER_POOL_ALIGNMENT
+ * (parts held in buffers of the buffer pool, for instance) bypass the page cache. Other writes, such as the tail of the
+ * last part, go through the page cache as usual. If the platform or the file system doesn't support direct I/O, every
+ * write goes through the page cache.
+ */
+struct aws_s3_recv_file;
+
+AWS_EXTERN_C_BEGIN
+
+/* Create (or truncate) the file at path. Returns NULL, raising AWS_ERROR_S3_RECV_FILE_FAILED, if it can't be opened. */
+AWS_S3_API
+struct aws_s3_recv_file *aws_s3_recv_file_open(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor path,
+    bool preallocate,
+    bool direct_io);
+
+/* Set the origin of the file, and the number of bytes it will hold, which space is allocated for up front if the file
+ * was opened to be preallocated. Must not be called while writes are going on. */
+AWS_S3_API
+int aws_s3_recv_file_set_origin(struct aws_s3_recv_file *recv_file, uint64_t origin, uint64_t size);
+
+/* Write data at the given offset of the object. Safe to call from several threads at once. */
+AWS_S3_API
+int aws_s3_recv_file_write(struct aws_s3_recv_file *recv_file, uint64_t object_offset, struct aws_byte_cursor data);
+
+/* Close and destroy the file. Returns AWS_OP_ERR if the data could not be flushed to the file, but destroys it either
+ * way. */
+AWS_S3_API
+int aws_s3_recv_file_close(struct aws_s3_recv_file *recv_file);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_RECV_FILE_H */
@@ -6,19 +6,25 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
+#include <aws/common/atomics.h>
 #include <aws/common/byte_buf.h>
 #include <aws/common/linked_list.h>
 #include <aws/common/ref_count.h>
 #include <aws/s3/s3.h>
+#include <aws/s3/s3_client.h>
 
 struct aws_http_message;
 struct aws_signable;
+struct aws_s3_checksum;
+struct aws_string;
 struct aws_s3_meta_request;
 
 enum aws_s3_request_flags {
     AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS = 0x00000001,
     AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY = 0x00000002,
     AWS_S3_REQUEST_FLAG_ALWAYS_SEND = 0x00000004,
+    AWS_S3_REQUEST_FLAG_PART_SIZE_REQUEST_BODY = 0x00000008,
+    AWS_S3_REQUEST_FLAG_STREAM_RESPONSE_BODY_DIRECTLY = 0x00000010,
 };
 
 /* Represents a single request made to S3. */
@@ -40,6 +46,10 @@ struct aws_s3_request {
      * retried.*/
     struct aws_byte_buf request_body;
 
+    /* Size of the request body, for a part gathered from several send buffers of the caller as it is sent (see
+     * send_buffers in aws_s3_meta_request_options). request_body is empty then. */
+    size_t num_gathered_request_body_bytes;
+
     /* Beginning range of this part. */
     /* TODO currently only used by auto_range_get, could be hooked up to auto_range_put as well. */
     uint64_t part_range_start;
@@ -48,6 +58,26 @@ struct aws_s3_request {
     /* TODO currently only used by auto_range_get, could be hooked up to auto_range_put as well. */
     uint64_t part_range_end;
 
+    /* Number of bytes reserved in the client's buffer pool on behalf of this request. Released when the request is
+     * destroyed. */
+    size_t buffer_pool_reservation;
+
+    /* Time at which the client first started sending this request. Zero until then. Not reset on retries, so that the
+     * latency of a request includes the time spent retrying it. */
+    uint64_t network_io_start_timestamp_ns;
+
+    /* Timing of this request as it goes through each stage, reported to the meta request's telemetry callback once the
+     * request has finished. */
+    struct aws_s3_request_metrics metrics;
+
+    /* Set by aws_s3_request_cancel when this request's result is no longer needed, ie, because another request for the
+     * same data already finished. Read from the connection's event loop, so this can be set from any thread. */
+    struct aws_atomic_var cancelled;
+
+    /* Number of bytes of the response body that were passed straight to the meta request's body callback as they
+     * arrived. Not reset on retries, so that a retried request doesn't deliver the same bytes twice. */
+    uint64_t num_response_body_bytes_streamed;
+
     /* Part number that this request refers to.  If this is not a part, this can be 0.  (S3 Part Numbers start at 1.)
      * However, must currently be a valid part number (ie: greater than 0) if the response body is to be streamed to the
      * caller.
@@ -58,6 +88,9 @@ struct aws_s3_request {
      * prepare function, this will be 0.*/
     uint32_t num_times_prepared;
 
+    /* Number of times the request has been put on a connection, including retries. */
+    uint32_t num_times_sent;
+
     /* Tag that defines what the built request will actually consist of.  This is meant to be space for an enum defined
      * by the derived type.  Request tags do not necessarily map 1:1 with actual S3 API requests.  For example, they can
      * be more contextual, like "first part" instead of just "part".) */
@@ -82,9 +115,35 @@ struct aws_s3_request {
         /* Recorded response body of the request. */
         struct aws_byte_buf response_body;
 
+        /* Number of response body bytes received by this attempt, whether or not they were recorded in response_body.
+         */
+        uint64_t num_response_body_bytes;
+
         /* Returned response status of this request. */
         int response_status;
 
+        /* Running checksum of the response body, and the base64 encoded checksum S3 sent for it, when the meta
+         * request validates response checksums and S3 sent one. */
+        struct aws_s3_checksum *response_checksum;
+        struct aws_string *expected_response_checksum;
+
+        /* Bytes of the response body that were read from the client's block cache. When only the start and the end of
+         * the response body were found there, they are at their place in the buffer, and the bytes between them are
+         * requested. */
+        struct aws_byte_buf cached_response_body;
+        uint64_t num_cached_prefix_bytes;
+        uint64_t num_cached_suffix_bytes;
+
+        /* Size of the object, when the request is revalidating the cached blocks of it. */
+        uint64_t cached_object_size;
+
+        /* When true, the whole response body was read from the block cache, and the request is not sent. */
+        uint32_t served_from_cache : 1;
+
+        /* When true, the whole response body was read from the block cache, and the request only checks with an
+         * If-None-Match header that the object wasn't changed since. */
+        uint32_t revalidating_cache : 1;
+
     } send_data;
 
     /* When true, response headers from the request will be stored in the request's response_headers variable. */
@@ -93,6 +152,13 @@ struct aws_s3_request {
     /* When true, the response body buffer will be allocated in the size of a part. */
     uint32_t part_size_response_body : 1;
 
+    /* When true, the request body buffer will be allocated in the size of a part. */
+    uint32_t part_size_request_body : 1;
+
+    /* When true, the request body has been read (and its checksum computed), and is kept as it is whenever the request
+     * is prepared again. This is currently only used by auto_range_put. */
+    uint32_t request_body_prepared : 1;
+
     /* When true, this request is being tracked by the client for limiting the amount of in-flight-requests/stats. */
     uint32_t tracked_by_client : 1;
 
@@ -102,6 +168,18 @@ struct aws_s3_request {
     /* When true, this request is intended to find out the object size. This is currently only used by auto_range_get.
      */
     uint32_t discovers_object_size : 1;
+
+    /* When true, this request is for a part that was requested before the object size was known, and that may turn out
+     * to be past the end of the object. This is currently only used by auto_range_get. */
+    uint32_t speculative : 1;
+
+    /* When true, and this request's part is the next one to be delivered to the caller, its response body is passed to
+     * the body callback as it arrives instead of being recorded in response_body first. */
+    uint32_t stream_response_body_directly : 1;
+
+    /* Set once this request started passing its response body straight to the body callback. From then on, every
+     * chunk of the response body is streamed directly, including after retries. */
+    uint32_t streaming_response_body_directly : 1;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -123,6 +201,25 @@ void aws_s3_request_setup_send_data(struct aws_s3_request *request, struct aws_h
 AWS_S3_API
 void aws_s3_request_clean_up_send_data(struct aws_s3_request *request);
 
+/* Flag the request as no longer needed. A request that is not yet being sent is finished with AWS_ERROR_S3_CANCELED
+ * instead of being sent, and a request that is receiving its response stops doing so. Cancelled requests are never
+ * retried. Safe to call from any thread. */
+AWS_S3_API
+void aws_s3_request_cancel(struct aws_s3_request *request);
+
+AWS_S3_API
+bool aws_s3_request_is_cancelled(struct aws_s3_request *request);
+
+/* Size of the part buffer for a request flagged with AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY or
+ * AWS_S3_REQUEST_FLAG_PART_SIZE_REQUEST_BODY: the meta request's part size, or the size of the request's part range if
+ * that is bigger, as parts of a GET can grow beyond the part size. */
+AWS_S3_API
+size_t aws_s3_request_get_part_buffer_size(const struct aws_s3_request *request);
+
+/* Number of bytes of the body of the request, wherever they are sent from. */
+AWS_S3_API
+size_t aws_s3_request_get_body_size(const struct aws_s3_request *request);
+
 AWS_S3_API
 void aws_s3_request_acquire(struct aws_s3_request *request);
 
@@ -5,7 +5,7 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
-#include "aws/s3/s3.h"
+#include "aws/s3/s3_client.h"
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -32,6 +32,25 @@ struct aws_input_stream *aws_s3_message_util_assign_body(
     struct aws_byte_buf *byte_buf,
     struct aws_http_message *out_message);
 
+/* Like aws_s3_message_util_assign_body, for a body made of several buffers, which are read one after the other as they
+ * are, without being copied, and have to outlive the message. */
+AWS_S3_API
+struct aws_input_stream *aws_s3_message_util_assign_gathered_body(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_http_message *out_message);
+
+/* Assign byte_buf as the body of the message, aws-chunked encoded and followed by a trailer with its checksum of
+ * checksum_algorithm (see aws_s3_chunk_stream_new), and set the headers that go along with it. A Content-Encoding the
+ * message already has is kept after aws-chunked. */
+AWS_S3_API
+struct aws_input_stream *aws_s3_message_util_assign_chunked_body(
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *byte_buf,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_http_message *out_message);
+
 /* Create an HTTP request for an S3 Ranged Get Object Request, using the given request as a basis */
 AWS_S3_API
 struct aws_http_message *aws_s3_ranged_get_object_message_new(
@@ -48,31 +67,59 @@ int aws_s3_message_util_set_multipart_request_path(
     bool append_uploads_suffix,
     struct aws_http_message *message);
 
-/* Create an HTTP request for an S3 Create-Multipart-Upload request. */
+/* Create an HTTP request for an S3 Create-Multipart-Upload request. Unless checksum_algorithm is AWS_SCA_NONE, the
+ * upload is created for parts with checksums of that algorithm. */
 AWS_S3_API
 struct aws_http_message *aws_s3_create_multipart_upload_message_new(
+    struct aws_allocator *allocator,
+    struct aws_http_message *base_message,
+    enum aws_s3_checksum_algorithm checksum_algorithm);
+
+/* Create the message that the UploadPart and UploadPartCopy requests of a meta request are made from: a copy of
+ * base_message without the headers that don't apply to parts. Made once per meta request, so that the headers of the
+ * original request are only filtered once rather than for every part. */
+AWS_S3_API
+struct aws_http_message *aws_s3_upload_part_message_template_new(
     struct aws_allocator *allocator,
     struct aws_http_message *base_message);
 
-/* Create an HTTP request for an S3 Put Object request, using the original request as a basis.  Creates and assigns a
- * body stream using the passed in buffer.  If multipart is not needed, part number and upload_id can be 0 and NULL,
- * respectively. */
+/* Create an HTTP request for an S3 Put Object request, using a template made by aws_s3_upload_part_message_template_new
+ * as a basis.  Creates and assigns a body stream using the passed in buffer.  If multipart is not needed, part number
+ * and upload_id can be 0 and NULL, respectively. Unless checksum_algorithm is AWS_SCA_NONE, a checksum of the buffer is
+ * added as a header, and if out_encoded_checksum is not NULL, also appended to it (base64 encoded). */
 AWS_S3_API
 struct aws_http_message *aws_s3_upload_part_message_new(
     struct aws_allocator *allocator,
-    struct aws_http_message *base_message,
+    struct aws_http_message *part_message_template,
     struct aws_byte_buf *buffer,
     uint32_t part_number,
     const struct aws_string *upload_id,
-    bool should_compute_content_md5);
+    bool should_compute_content_md5,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_byte_buf *out_encoded_checksum);
 
-/* Create an HTTP request for an S3 UploadPartCopy request, using the original request as a basis.
+/* Like aws_s3_upload_part_message_new, for a part whose body is made of several buffers, which are sent one after the
+ * other as they are (see aws_s3_message_util_assign_gathered_body). */
+AWS_S3_API
+struct aws_http_message *aws_s3_upload_part_message_new_gathered(
+    struct aws_allocator *allocator,
+    struct aws_http_message *part_message_template,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    uint32_t part_number,
+    const struct aws_string *upload_id,
+    bool should_compute_content_md5,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_byte_buf *out_encoded_checksum);
+
+/* Create an HTTP request for an S3 UploadPartCopy request, using a template made by
+ * aws_s3_upload_part_message_template_new from the original request as a basis.
  * If multipart is not needed, part number and upload_id can be 0 and NULL,
  * respectively. */
 AWS_S3_API
 struct aws_http_message *aws_s3_upload_part_copy_message_new(
     struct aws_allocator *allocator,
-    struct aws_http_message *base_message,
+    struct aws_http_message *part_message_template,
     struct aws_byte_buf *buffer,
     uint32_t part_number,
     uint64_t range_start,
@@ -82,14 +129,17 @@ struct aws_http_message *aws_s3_upload_part_copy_message_new(
 
 /* Create an HTTP request for an S3 Complete-Multipart-Upload request. Creates the necessary XML payload using the
  * passed in array list of ETags.  (Each ETag is assumed to be an aws_string*)  Buffer passed in will be used to store
- * said XML payload, which will be used as the body. */
+ * said XML payload, which will be used as the body. If checksums is not NULL, it holds the base64 encoded checksum
+ * (as an aws_string*) of each part, of checksum_algorithm, which are added to the parts of the payload. */
 AWS_S3_API
 struct aws_http_message *aws_s3_complete_multipart_message_new(
     struct aws_allocator *allocator,
     struct aws_http_message *base_message,
     struct aws_byte_buf *body_buffer,
     const struct aws_string *upload_id,
-    const struct aws_array_list *etags);
+    const struct aws_array_list *etags,
+    const struct aws_array_list *checksums,
+    enum aws_s3_checksum_algorithm checksum_algorithm);
 
 AWS_S3_API
 struct aws_http_message *aws_s3_abort_multipart_upload_message_new(
@@ -118,6 +168,34 @@ int aws_s3_message_util_add_content_md5_header(
     struct aws_byte_buf *input_buf,
     struct aws_http_message *message);
 
+/* Like aws_s3_message_util_add_content_md5_header, computing the MD5 of several buffers one after the other. */
+AWS_S3_API
+int aws_s3_message_util_add_gathered_content_md5_header(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_http_message *message);
+
+/* Add a checksum header of checksum_algorithm to the http message passed in. The checksum will be computed from the
+ * input_buf. If out_encoded_checksum is not NULL, the base64 encoded checksum is also appended to it. */
+AWS_S3_API
+int aws_s3_message_util_add_checksum_header(
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *input_buf,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_http_message *message,
+    struct aws_byte_buf *out_encoded_checksum);
+
+/* Like aws_s3_message_util_add_checksum_header, computing the checksum of several buffers one after the other. */
+AWS_S3_API
+int aws_s3_message_util_add_gathered_checksum_header(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_http_message *message,
+    struct aws_byte_buf *out_encoded_checksum);
+
 AWS_S3_API
 extern const struct aws_byte_cursor g_s3_create_multipart_upload_excluded_headers[];
 
@@ -0,0 +1,58 @@
+#ifndef AWS_S3_REQUEST_POOL_H
+#define AWS_S3_REQUEST_POOL_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/array_list.h>
+#include <aws/common/mutex.h>
+#include <aws/s3/s3.h>
+
+struct aws_allocator;
+struct aws_s3_request;
+
+/**
+ * Client wide free list of aws_s3_request structures, so that workloads made of many small requests don't go back to
+ * the allocator for every request they make.
+ *
+ * Every structure handed out is allocated with the pool's allocator on its own, so one can also be freed with it like
+ * any other allocation, and one that wasn't handed out by the pool can still be given to it.
+ *
+ * All functions are thread safe.
+ */
+struct aws_s3_request_pool {
+    struct aws_allocator *allocator;
+
+    /* Max number of unused requests kept around for re-use. */
+    const size_t max_free_requests;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Requests (struct aws_s3_request *) that are not in use and can be handed out again. */
+        struct aws_array_list free_requests;
+    } synced_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_S3_API
+struct aws_s3_request_pool *aws_s3_request_pool_new(struct aws_allocator *allocator, size_t max_free_requests);
+
+AWS_S3_API
+void aws_s3_request_pool_destroy(struct aws_s3_request_pool *request_pool);
+
+/* Returns a zeroed request structure, re-using a free one if there is any. Returns NULL if out of memory. */
+AWS_S3_API
+struct aws_s3_request *aws_s3_request_pool_acquire(struct aws_s3_request_pool *request_pool);
+
+/* Give back a request structure that is no longer used. Kept for re-use (up to max_free_requests), freed
+ * otherwise. */
+AWS_S3_API
+void aws_s3_request_pool_release(struct aws_s3_request_pool *request_pool, struct aws_s3_request *request);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_REQUEST_POOL_H */
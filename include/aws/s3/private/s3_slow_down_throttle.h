@@ -0,0 +1,80 @@
+#ifndef AWS_S3_SLOW_DOWN_THROTTLE_H
+#define AWS_S3_SLOW_DOWN_THROTTLE_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/mutex.h>
+#include <aws/s3/s3.h>
+
+struct aws_allocator;
+
+/**
+ * Token bucket that limits the rate at which requests to one endpoint are sent once S3 starts responding with
+ * SlowDown (503).
+ *
+ * While no SlowDown has been seen, the throttle admits everything, and only keeps track of the rate at which requests
+ * are being admitted. On the first SlowDown, the admission rate is cut to half of that, and is halved again on every
+ * further SlowDown. Once no SlowDown has been seen for a while, the rate ramps back up, and the throttle admits
+ * everything again once the rate is back to where it was before throttling started.
+ *
+ * Every request retried by the retry strategy heads back to the same endpoint, so without this, each connection keeps
+ * sending (and retrying) at full speed, and a burst of SlowDowns turns into a retry storm.
+ *
+ * All functions are thread safe.
+ */
+struct aws_s3_slow_down_throttle {
+    struct aws_allocator *allocator;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Requests per second currently admitted. 0 while not throttled. */
+        double rate;
+
+        /* Admission rate measured right before throttling started. Throttling ends once rate is back to this. */
+        double unthrottled_rate;
+
+        /* Number of requests that can currently be admitted. */
+        double tokens;
+
+        uint64_t last_refill_timestamp_ns;
+        uint64_t last_slow_down_timestamp_ns;
+        uint64_t last_rate_change_timestamp_ns;
+
+        /* Requests admitted in the current measurement window, and the admission rate of the last full window. */
+        uint64_t window_start_timestamp_ns;
+        uint32_t num_window_admissions;
+        double last_window_rate;
+    } synced_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_S3_API
+struct aws_s3_slow_down_throttle *aws_s3_slow_down_throttle_new(struct aws_allocator *allocator);
+
+AWS_S3_API
+void aws_s3_slow_down_throttle_destroy(struct aws_s3_slow_down_throttle *throttle);
+
+/* Try to admit one request at now_ns. Returns true if the request can be sent. Otherwise returns false, and sets
+ * out_retry_after_ns (if not NULL) to how long from now until the next request can be admitted. */
+AWS_S3_API
+bool aws_s3_slow_down_throttle_try_admit(
+    struct aws_s3_slow_down_throttle *throttle,
+    uint64_t now_ns,
+    uint64_t *out_retry_after_ns);
+
+/* Record that a request was answered with a SlowDown at now_ns. */
+AWS_S3_API
+void aws_s3_slow_down_throttle_on_slow_down(struct aws_s3_slow_down_throttle *throttle, uint64_t now_ns);
+
+/* Returns the current admission rate in requests per second, or 0 if the throttle is not limiting anything. */
+AWS_S3_API
+double aws_s3_slow_down_throttle_get_rate(struct aws_s3_slow_down_throttle *throttle);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_SLOW_DOWN_THROTTLE_H */
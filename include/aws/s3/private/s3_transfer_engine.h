@@ -0,0 +1,161 @@
+#ifndef AWS_S3_TRANSFER_ENGINE_H
+#define AWS_S3_TRANSFER_ENGINE_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/s3_client.h>
+
+struct aws_s3_transfer_engine;
+
+/**
+ * A transfer to queue on a transfer engine. A meta request is made from it once the transfer gets its turn.
+ */
+struct aws_s3_transfer_options {
+    /**
+     * AWS_S3_META_REQUEST_TYPE_GET_OBJECT, AWS_S3_META_REQUEST_TYPE_PUT_OBJECT or AWS_S3_META_REQUEST_TYPE_COPY_OBJECT.
+     */
+    enum aws_s3_meta_request_type type;
+
+    /**
+     * Must not be NULL. Message of the meta request. The internal call will increment the reference count on it.
+     */
+    struct aws_http_message *message;
+
+    /**
+     * Optional. Local file that a PUT is uploaded from (as send_filepath), or that a GET is downloaded to (as
+     * recv_filepath). Copied.
+     */
+    struct aws_byte_cursor filepath;
+
+    /**
+     * Optional. Size of the object, if known, or 0. Transfers of objects that fit in a single part are made as small
+     * objects (see small_object_hint).
+     */
+    uint64_t size;
+
+    /* Passed back to transfer_finish_callback. */
+    void *user_data;
+};
+
+/**
+ * Invoked once a transfer is done, whether it succeeded or not, with the user_data of the transfer. Can be invoked from
+ * any thread, at the same time as for other transfers.
+ */
+typedef void(aws_s3_transfer_engine_transfer_finish_fn)(
+    struct aws_s3_transfer_engine *engine,
+    void *transfer_user_data,
+    const struct aws_s3_meta_request_result *result,
+    void *user_data);
+
+/**
+ * Invoked once aws_s3_transfer_engine_end_input has been called and every transfer is done. error_code is that of the
+ * first transfer that failed, if one did.
+ */
+typedef void(aws_s3_transfer_engine_finish_fn)(struct aws_s3_transfer_engine *engine, int error_code, void *user_data);
+
+/* Invoked once there is room to queue transfers. See aws_s3_transfer_engine_on_room. */
+typedef void(aws_s3_transfer_engine_room_fn)(struct aws_s3_transfer_engine *engine, void *user_data);
+
+struct aws_s3_transfer_engine_options {
+    /**
+     * Must not be NULL. The internal call will increment the reference count on client.
+     */
+    struct aws_s3_client *client;
+
+    /**
+     * Optional. If NULL, the signing config of the client is used. Must outlive the engine.
+     */
+    struct aws_signing_config_aws *signing_config;
+
+    /**
+     * Optional. Max number of meta requests running at the same time. If 0, the max number of active connections of
+     * the client is used.
+     */
+    uint32_t max_active_transfers;
+
+    /**
+     * Optional. Number of transfers that can be waiting for their turn before the engine has no room for more. If 0,
+     * four times max_active_transfers is used.
+     */
+    size_t max_queued_transfers;
+
+    aws_s3_transfer_engine_transfer_finish_fn *transfer_finish_callback;
+    aws_s3_transfer_engine_finish_fn *finish_callback;
+    void *user_data;
+};
+
+/* Aggregate progress of a transfer engine. */
+struct aws_s3_transfer_engine_stats {
+    size_t num_transfers_queued;
+    size_t num_transfers_active;
+    uint64_t num_transfers_succeeded;
+    uint64_t num_transfers_failed;
+
+    /* Bytes of the body sent or received so far, by transfers that are done and transfers that are running. */
+    uint64_t num_bytes_transferred;
+
+    /* Time since the engine was created, and the throughput over that time. */
+    uint64_t elapsed_ns;
+    uint64_t bytes_per_second;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Run any number of transfers (the objects of a listing, or the files of a directory, for instance) with no more than
+ * max_active_transfers meta requests at once, and no more than max_queued_transfers waiting for their turn, so that
+ * memory stays flat no matter how many transfers go through. Producers add transfers as there is room for them, either
+ * by waiting for it (aws_s3_transfer_engine_wait_for_room) or by being called back once there is
+ * (aws_s3_transfer_engine_on_room), and call aws_s3_transfer_engine_end_input once they are done. A transfer that
+ * fails doesn't stop the others.
+ *
+ * Returns NULL on failure. Check aws_last_error() for details on the error that occurred.
+ *
+ * This is a reference counted object, returned with a reference count of 1. You must call
+ * aws_s3_transfer_engine_release() on it when you are finished with it. The engine keeps going until finish_callback
+ * is invoked whether or not it is released before then.
+ */
+AWS_S3_API struct aws_s3_transfer_engine *aws_s3_transfer_engine_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_transfer_engine_options *options);
+
+AWS_S3_API void aws_s3_transfer_engine_acquire(struct aws_s3_transfer_engine *engine);
+AWS_S3_API void aws_s3_transfer_engine_release(struct aws_s3_transfer_engine *engine);
+
+/**
+ * Queue a transfer, even if there is no room for it: the limit is up to the producer to respect. Fails if
+ * aws_s3_transfer_engine_end_input has been called. Thread safe.
+ */
+AWS_S3_API int aws_s3_transfer_engine_add(
+    struct aws_s3_transfer_engine *engine,
+    const struct aws_s3_transfer_options *transfer);
+
+/**
+ * Block until there is room to queue a transfer. Must not be called from a thread of the client's event loops, which
+ * are the ones that make room.
+ */
+AWS_S3_API void aws_s3_transfer_engine_wait_for_room(struct aws_s3_transfer_engine *engine);
+
+/**
+ * Invoke room_callback once there is room to queue a transfer: right away, from this thread, if there already is, or
+ * else from the thread of the transfer that makes room. Only one callback can be waiting at a time. For producers that
+ * can't block, such as paginators, which continue from room_callback.
+ */
+AWS_S3_API int aws_s3_transfer_engine_on_room(
+    struct aws_s3_transfer_engine *engine,
+    aws_s3_transfer_engine_room_fn *room_callback,
+    void *user_data);
+
+/* No more transfers are going to be added. finish_callback is invoked once the ones added so far are done. */
+AWS_S3_API void aws_s3_transfer_engine_end_input(struct aws_s3_transfer_engine *engine);
+
+AWS_S3_API void aws_s3_transfer_engine_get_stats(
+    struct aws_s3_transfer_engine *engine,
+    struct aws_s3_transfer_engine_stats *out_stats);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_TRANSFER_ENGINE_H */
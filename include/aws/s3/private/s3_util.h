@@ -30,11 +30,15 @@ struct aws_http_stream;
 struct aws_http_headers;
 struct aws_http_message;
 struct aws_event_loop;
+struct aws_array_list;
 
 enum aws_s3_response_status {
     AWS_S3_RESPONSE_STATUS_SUCCESS = 200,
     AWS_S3_RESPONSE_STATUS_NO_CONTENT_SUCCESS = 204,
     AWS_S3_RESPONSE_STATUS_RANGE_SUCCESS = 206,
+    AWS_S3_RESPONSE_STATUS_NOT_MODIFIED = 304,
+    AWS_S3_RESPONSE_STATUS_PRECONDITION_FAILED = 412,
+    AWS_S3_RESPONSE_STATUS_RANGE_NOT_SATISFIABLE = 416,
     AWS_S3_RESPONSE_STATUS_INTERNAL_ERROR = 500,
     AWS_S3_RESPONSE_STATUS_SLOW_DOWN = 503,
 };
@@ -48,6 +52,16 @@ struct aws_cached_signing_config_aws {
     struct aws_signing_config_aws config;
 };
 
+/* Schedule of part sizes for a ranged download where parts don't all have the same size: a first part of
+ * first_part_size, then parts of part_size, doubling in size every num_parts_per_step parts until they reach
+ * max_part_size. Parts are laid out from the start of the object range, and are not aligned on any boundary. */
+struct aws_s3_part_size_schedule {
+    uint64_t first_part_size;
+    uint64_t part_size;
+    uint64_t max_part_size;
+    uint32_t num_parts_per_step;
+};
+
 AWS_EXTERN_C_BEGIN
 
 AWS_S3_API
@@ -86,6 +100,34 @@ extern const struct aws_byte_cursor g_s3_service_name;
 AWS_S3_API
 extern const struct aws_byte_cursor g_range_header_name;
 
+AWS_S3_API
+extern const struct aws_byte_cursor g_if_match_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_if_none_match_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_checksum_algorithm_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_checksum_mode_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_content_encoding_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_decoded_content_length_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_trailer_header_name;
+
+AWS_S3_API
+extern const struct aws_byte_cursor g_aws_chunked_content_encoding;
+
+/* Signed body value of aws-chunked payloads whose chunks aren't signed, followed by a trailer. */
+AWS_S3_API
+extern const struct aws_byte_cursor g_s3_signed_body_value_streaming_unsigned_payload_trailer;
+
 AWS_S3_API
 extern const struct aws_byte_cursor g_content_range_header_name;
 
@@ -104,6 +146,9 @@ extern const struct aws_byte_cursor g_delete_method;
 AWS_S3_API
 extern const uint32_t g_s3_max_num_upload_parts;
 
+AWS_S3_API
+extern const uint64_t g_s3_max_upload_part_size;
+
 struct aws_cached_signing_config_aws *aws_cached_signing_config_new(
     struct aws_allocator *allocator,
     const struct aws_signing_config_aws *signing_config);
@@ -147,6 +192,19 @@ int aws_s3_parse_content_length_response_header(
     struct aws_http_headers *response_headers,
     uint64_t *out_content_length);
 
+/* Given the request headers list, finds the Range header and parses the single byte range it asks for. For
+ * "bytes=a-b", both a start and an end are returned. For "bytes=a-", only a start is. For "bytes=-n" (the last n bytes
+ * of the object), only an end is, which is then the number of bytes rather than an offset. Fails with
+ * AWS_ERROR_S3_MULTIRANGE_HEADER_UNSUPPORTED for multiple ranges, and AWS_ERROR_S3_INVALID_RANGE_HEADER for anything
+ * else that can't be parsed, or that can never be satisfied. */
+AWS_S3_API
+int aws_s3_parse_request_range_header(
+    struct aws_http_headers *request_headers,
+    bool *out_has_start_range,
+    bool *out_has_end_range,
+    uint64_t *out_start_range,
+    uint64_t *out_end_range);
+
 /* Calculate the number of parts based on overall object-range and part_size. This takes into account aligning
  * part-ranges on part_size. (ie: if object_range_start is not evenly divisible by part_size, it is considered in the
  * middle of a contiguous part, and that first part will be smaller than part_size.) */
@@ -165,6 +223,49 @@ void aws_s3_get_part_range(
     uint64_t *out_part_range_start,
     uint64_t *out_part_range_end);
 
+/* Calculates the number of parts needed to cover the given object range (both ends inclusive) following the schedule.
+ */
+AWS_S3_API
+uint32_t aws_s3_get_num_parts_for_schedule(
+    const struct aws_s3_part_size_schedule *schedule,
+    uint64_t object_range_start,
+    uint64_t object_range_end);
+
+/* Calculates the range of a part following the schedule. Like aws_s3_get_part_range, part numbers begin at one, and the
+ * last part is cut short by the end of the object range. part_number should be less than or equal to the result of
+ * aws_s3_get_num_parts_for_schedule. */
+AWS_S3_API
+void aws_s3_get_part_range_for_schedule(
+    const struct aws_s3_part_size_schedule *schedule,
+    uint64_t object_range_start,
+    uint64_t object_range_end,
+    uint32_t part_number,
+    uint64_t *out_part_range_start,
+    uint64_t *out_part_range_end);
+
+/* Plans the part size of a multipart copy of an object of object_size bytes. UploadPartCopy doesn't move any bytes
+ * through the client, so rather than the client's part size, parts are made big enough for the object to be copied in
+ * about target_num_parts parts, all of which can be in flight at once. Parts are never smaller than min_part_size
+ * though, nor so small that more than g_s3_max_num_upload_parts of them are needed, and never larger than
+ * g_s3_max_upload_part_size. The part size is rounded up to a whole number of MB. */
+AWS_S3_API
+uint64_t aws_s3_calculate_copy_part_size(uint64_t object_size, uint64_t min_part_size, uint32_t target_num_parts);
+
+/* Sorts a list of byte ranges (struct aws_s3_byte_range) by where they start, and merges the ones that overlap or
+ * touch. */
+AWS_S3_API
+void aws_s3_merge_byte_ranges(struct aws_array_list *byte_ranges);
+
+/* Like aws_s3_merge_byte_ranges, but also merges ranges that are no more than max_gap bytes apart, the bytes between
+ * them becoming part of the merged range. */
+AWS_S3_API
+void aws_s3_coalesce_byte_ranges(struct aws_array_list *byte_ranges, uint64_t max_gap);
+
+/* Returns true if the range (both ends inclusive) is entirely covered by a list of byte ranges that was merged with
+ * aws_s3_merge_byte_ranges. */
+AWS_S3_API
+bool aws_s3_byte_ranges_cover(const struct aws_array_list *byte_ranges, uint64_t range_start, uint64_t range_end);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_S3_UTIL_H */
@@ -0,0 +1,95 @@
+#ifndef AWS_S3_VECTORED_GET_H
+#define AWS_S3_VECTORED_GET_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/s3_client.h>
+
+struct aws_s3_vectored_get;
+
+/**
+ * Invoked with the next bytes of one of the ranges of a vectored get. range_index is the index of the range in the
+ * ranges the vectored get was created with, and offset is where the bytes are in the object. The bytes of a range are
+ * passed on in order, and never by two invocations at once, but different ranges can be passed on at the same time,
+ * from different threads. Return AWS_OP_ERR (after raising an error) to fail the vectored get.
+ */
+typedef int(aws_s3_vectored_get_range_body_fn)(
+    struct aws_s3_vectored_get *vectored_get,
+    size_t range_index,
+    const struct aws_byte_cursor *body,
+    uint64_t offset,
+    void *user_data);
+
+/**
+ * Invoked once every range has been received, or the vectored get has failed. response_status is that of the failed
+ * request, if a request failed.
+ */
+typedef void(aws_s3_vectored_get_finish_fn)(
+    struct aws_s3_vectored_get *vectored_get,
+    int error_code,
+    int response_status,
+    void *user_data);
+
+struct aws_s3_vectored_get_options {
+    /**
+     * Must not be NULL. The internal call will increment the reference count on client.
+     */
+    struct aws_s3_client *client;
+
+    /**
+     * Must not be NULL. GetObject message for the object, without a Range header. Every request is made from a copy of
+     * it.
+     */
+    struct aws_http_message *message;
+
+    /**
+     * Optional. If NULL, the signing config of the client is used.
+     */
+    struct aws_signing_config_aws *signing_config;
+
+    /**
+     * Must not be empty. Ranges of the object to get. Can be in any order, and overlap. Copied.
+     */
+    const struct aws_s3_byte_range *ranges;
+    size_t num_ranges;
+
+    /**
+     * Optional. Ranges less than this many bytes apart are fetched together, along with the bytes between them, which
+     * are thrown away. Ranges that overlap or touch are always fetched together.
+     */
+    uint64_t max_coalesce_gap;
+
+    aws_s3_vectored_get_range_body_fn *range_body_callback;
+    aws_s3_vectored_get_finish_fn *finish_callback;
+    void *user_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Get many ranges of an object at once. The ranges are coalesced into as few spans as the gap allows, each span is
+ * fetched by a GetObject meta request of its own, which splits it into requests of the client's part size, and the
+ * bytes of every span are handed back per range.
+ *
+ * Returns NULL on failure. Check aws_last_error() for details on the error that occurred.
+ *
+ * This is a reference counted object, returned with a reference count of 1. You must call
+ * aws_s3_vectored_get_release() on it when you are finished with it. The vectored get keeps going until
+ * finish_callback is invoked whether or not it is released before then.
+ */
+AWS_S3_API struct aws_s3_vectored_get *aws_s3_vectored_get_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_vectored_get_options *options);
+
+AWS_S3_API void aws_s3_vectored_get_acquire(struct aws_s3_vectored_get *vectored_get);
+AWS_S3_API void aws_s3_vectored_get_release(struct aws_s3_vectored_get *vectored_get);
+
+/* Cancel the meta requests of the vectored get, which then finishes with AWS_ERROR_S3_CANCELED. */
+AWS_S3_API void aws_s3_vectored_get_cancel(struct aws_s3_vectored_get *vectored_get);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_VECTORED_GET_H */
@@ -0,0 +1,107 @@
+#ifndef AWS_S3_VIP_BALANCER_H
+#define AWS_S3_VIP_BALANCER_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/array_list.h>
+#include <aws/common/byte_buf.h>
+#include <aws/common/mutex.h>
+#include <aws/s3/s3.h>
+
+struct aws_allocator;
+struct aws_string;
+
+/* One address (VIP) known to a balancer. Stays valid until the balancer is destroyed. */
+struct aws_s3_balanced_vip {
+    struct aws_string *address;
+
+    /* Owner's data for this VIP, as passed to aws_s3_vip_balancer_add_vip. */
+    void *user_data;
+
+    /* Everything below is protected by the balancer's lock. */
+
+    /* Number of connections currently handed out for this VIP. */
+    uint32_t num_active_connections;
+
+    /* Number of requests sampled since the VIP was added or re-admitted, and how many of them were big enough to say
+     * something about throughput. */
+    uint32_t num_samples;
+    uint32_t num_throughput_samples;
+
+    /* Moving averages of the throughput (in bytes per second) of big requests, and of the fraction of requests that
+     * failed. */
+    double throughput;
+    double error_rate;
+
+    /* While non-zero, the VIP was evicted for being slow or failing, and no connections are handed out for it until
+     * then. */
+    uint64_t evicted_until_ns;
+};
+
+/**
+ * Spreads connections evenly over the VIPs resolved for one endpoint, and keeps track of how each VIP performs, so that
+ * VIPs which are consistently slower than their peers, or keep failing, stop getting new connections for a while.
+ *
+ * S3 hands out a different VIP on every DNS query, and how fast a single VIP is varies considerably, so the client's
+ * throughput-per-VIP assumption only holds if connections are actually spread over many VIPs and the bad ones are
+ * avoided.
+ *
+ * All functions are thread safe.
+ */
+struct aws_s3_vip_balancer {
+    struct aws_allocator *allocator;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* All VIPs (struct aws_s3_balanced_vip *) in the order they were added. */
+        struct aws_array_list vips;
+
+        /* Where the search for the next VIP starts, so that ties are broken round robin. */
+        size_t next_vip_index;
+    } synced_data;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_S3_API
+struct aws_s3_vip_balancer *aws_s3_vip_balancer_new(struct aws_allocator *allocator);
+
+AWS_S3_API
+void aws_s3_vip_balancer_destroy(struct aws_s3_vip_balancer *balancer);
+
+/* Returns true if a VIP with this address has been added already. */
+AWS_S3_API
+bool aws_s3_vip_balancer_has_vip(struct aws_s3_vip_balancer *balancer, struct aws_byte_cursor address);
+
+/* Add a VIP. Does nothing (and returns AWS_OP_SUCCESS) if a VIP with this address was added already. */
+AWS_S3_API
+int aws_s3_vip_balancer_add_vip(struct aws_s3_vip_balancer *balancer, struct aws_byte_cursor address, void *user_data);
+
+/* Returns the number of VIPs that connections can currently be handed out for. */
+AWS_S3_API
+size_t aws_s3_vip_balancer_get_num_usable_vips(struct aws_s3_vip_balancer *balancer, uint64_t now_ns);
+
+/* Pick the VIP a new connection should go to: the usable VIP with the fewest active connections. Returns NULL if there
+ * is no usable VIP. Every VIP returned has to be given back with aws_s3_vip_balancer_release_vip. */
+AWS_S3_API
+struct aws_s3_balanced_vip *aws_s3_vip_balancer_acquire_vip(struct aws_s3_vip_balancer *balancer, uint64_t now_ns);
+
+/* Give back a VIP returned by aws_s3_vip_balancer_acquire_vip, once the request sent over it is done. failed is true if
+ * the request failed in a way attributable to the VIP (connection errors, timeouts, 5xx). num_bytes and duration_ns
+ * are the amount of data transferred and how long that took, and are only used for requests that succeeded. */
+AWS_S3_API
+void aws_s3_vip_balancer_release_vip(
+    struct aws_s3_vip_balancer *balancer,
+    struct aws_s3_balanced_vip *vip,
+    bool failed,
+    uint64_t num_bytes,
+    uint64_t duration_ns,
+    uint64_t now_ns);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_S3_VIP_BALANCER_H */
@@ -27,6 +27,13 @@ enum aws_s3_errors {
     AWS_ERROR_S3_CANCELED,
     AWS_ERROR_S3_INVALID_RANGE_HEADER,
     AWS_ERROR_S3_MULTIRANGE_HEADER_UNSUPPORTED,
+    AWS_ERROR_S3_INCORRECT_CONTENT_LENGTH,
+    AWS_ERROR_S3_MAX_NUM_PARTS_EXCEEDED,
+    AWS_ERROR_S3_PAUSED,
+    AWS_ERROR_S3_INVALID_RESUME_TOKEN,
+    AWS_ERROR_S3_RESPONSE_CHECKSUM_MISMATCH,
+    AWS_ERROR_S3_RECV_FILE_FAILED,
+    AWS_ERROR_S3_OBJECT_MODIFIED,
 
     AWS_ERROR_S3_END_RANGE = AWS_ERROR_ENUM_END_RANGE(AWS_C_S3_PACKAGE_ID)
 };
@@ -41,6 +48,8 @@ enum aws_s3_subject {
     AWS_LS_S3_LAST = AWS_LOG_SUBJECT_END_RANGE(AWS_C_S3_PACKAGE_ID)
 };
 
+struct aws_string;
+
 struct aws_s3_cpu_group_info {
     /* group index, this usually refers to a particular numa node */
     uint16_t cpu_group;
@@ -77,6 +86,14 @@ AWS_S3_API
 struct aws_s3_compute_platform_info *aws_s3_get_compute_platform_info_for_instance_type(
     const struct aws_byte_cursor instance_type_name);
 
+/**
+ * Detects the EC2 instance type of the machine from its DMI attributes (system vendor and product name), which Nitro
+ * instances fill in, so no network request is made. Returns a new string to destroy with aws_string_destroy, or NULL
+ * if the machine is not an EC2 Nitro instance or the attributes can't be read (only Linux exposes them).
+ */
+AWS_S3_API
+struct aws_string *aws_s3_detect_instance_type(struct aws_allocator *allocator);
+
 /**
  * Shuts down the internal datastructures used by aws-c-s3.
  */
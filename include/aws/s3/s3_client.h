@@ -20,9 +20,11 @@ struct aws_tls_connection_options;
 struct aws_input_stream;
 
 struct aws_s3_client;
+struct aws_s3_client_context;
 struct aws_s3_request;
 struct aws_s3_meta_request;
 struct aws_s3_meta_request_result;
+struct aws_s3_request_metrics;
 
 /**
  * A Meta Request represents a group of generated requests that are being done on behalf of the
@@ -103,10 +105,44 @@ typedef void(aws_s3_meta_request_finish_fn)(
     const struct aws_s3_meta_request_result *meta_request_result,
     void *user_data);
 
+/**
+ * Invoked each time a request made on behalf of the meta request has finished (successfully or not, after any retries),
+ * with the timing of that request. Called from the request's connection thread, so it should return quickly.
+ */
+typedef void(aws_s3_meta_request_telemetry_fn)(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_request_metrics *metrics,
+    void *user_data);
+
+/**
+ * Invoked to read the body of a meta request at a given offset, for bodies that can be read out of order. dest has to
+ * be filled up to its capacity with the bytes of the body starting at offset. Different parts of the body are read
+ * concurrently, from different threads, so the callback has to be thread safe. Return AWS_OP_ERR after raising an
+ * error to fail the meta request.
+ */
+typedef int(aws_s3_meta_request_read_body_at_fn)(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *dest,
+    void *user_data);
+
+/**
+ * Invoked once a meta request is done with the send buffers of its body, which then belong to the caller again. See
+ * send_buffers in `aws_s3_meta_request_options`.
+ */
+typedef void(aws_s3_meta_request_send_buffers_release_fn)(struct aws_s3_meta_request *meta_request, void *user_data);
+
 typedef void(aws_s3_meta_request_shutdown_fn)(void *user_data);
 
 typedef void(aws_s3_client_shutdown_complete_callback_fn)(void *user_data);
 
+/**
+ * Invoked once aws_s3_client_prewarm_endpoint is done opening connections. num_connections is the number of
+ * connections that were opened. If any connection could not be opened, error_code is the error of the first one that
+ * failed.
+ */
+typedef void(aws_s3_client_prewarm_endpoint_callback_fn)(int error_code, uint32_t num_connections, void *user_data);
+
 enum aws_s3_meta_request_tls_mode {
     AWS_MR_TLS_ENABLED,
     AWS_MR_TLS_DISABLED,
@@ -117,6 +153,74 @@ enum aws_s3_meta_request_compute_content_md5 {
     AWS_MR_CONTENT_MD5_ENABLED,
 };
 
+/**
+ * Flexible checksum that uploads are sent with. Each part (or the whole object, when it's uploaded in one request) gets
+ * an x-amz-checksum-<algorithm> header that S3 checks the data against, and for multipart uploads the checksums of the
+ * parts are repeated in the CompleteMultipartUpload request. CRC32C and CRC32 are computed with the CPU's CRC
+ * instructions where there are any, and are much cheaper than MD5 or the SHAs.
+ */
+enum aws_s3_checksum_algorithm {
+    AWS_SCA_NONE = 0,
+    AWS_SCA_CRC32C,
+    AWS_SCA_CRC32,
+    AWS_SCA_SHA1,
+    AWS_SCA_SHA256,
+};
+
+/**
+ * How the payload of requests is covered by their SigV4 signature.
+ */
+enum aws_s3_payload_signing_mode {
+    /* Sign payloads the way the signing config says to (its signed_body_value). For meta requests, use the mode of the
+     * client. */
+    AWS_S3_PAYLOAD_SIGNING_MODE_DEFAULT = 0,
+
+    /* Sign requests with UNSIGNED-PAYLOAD, so that bodies are never hashed for signing. Only meant for connections
+     * using TLS, which already protects the payload in transit. */
+    AWS_S3_PAYLOAD_SIGNING_MODE_UNSIGNED,
+
+    /* Send upload bodies aws-chunked encoded, signed with STREAMING-UNSIGNED-PAYLOAD-TRAILER, with their checksum in a
+     * trailer after the body. The body goes on the wire while its checksum is still being computed, instead of being
+     * read once up front to compute it. The checksum is of the checksum_algorithm of the upload, or CRC32C if it has
+     * none. Requests without an upload body are signed like AWS_S3_PAYLOAD_SIGNING_MODE_UNSIGNED. */
+    AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER,
+};
+
+/**
+ * Scheduling priority of a meta request relative to the other meta requests of the same client. Requests belonging to
+ * higher priority meta requests are prepared and handed connections before those of lower priority meta requests.
+ */
+enum aws_s3_meta_request_priority {
+
+    /* Same as AWS_S3_META_REQUEST_PRIORITY_NORMAL. */
+    AWS_S3_META_REQUEST_PRIORITY_DEFAULT,
+
+    /* Bulk transfers that should only use bandwidth not needed by higher priority meta requests. */
+    AWS_S3_META_REQUEST_PRIORITY_LOW,
+
+    AWS_S3_META_REQUEST_PRIORITY_NORMAL,
+
+    /* Latency sensitive transfers, such as small interactive reads. */
+    AWS_S3_META_REQUEST_PRIORITY_HIGH,
+
+    AWS_S3_META_REQUEST_PRIORITY_MAX,
+};
+
+/**
+ * Order in which the response body of a meta request is passed to its body callback.
+ */
+enum aws_s3_meta_request_delivery {
+
+    /* Parts are delivered one at a time, in order of their position in the object. Parts that arrive early are held in
+     * memory until every part before them has been delivered. */
+    AWS_S3_META_REQUEST_DELIVERY_ORDERED,
+
+    /* Each part is delivered as soon as it has arrived, possibly before parts that come before it in the object, and
+     * possibly at the same time as other parts from other threads. The body callback has to rely on its range_start
+     * argument to place the data, and has to be safe to call concurrently. */
+    AWS_S3_META_REQUEST_DELIVERY_UNORDERED,
+};
+
 /* Options for a new client. */
 struct aws_s3_client_config {
 
@@ -152,23 +256,126 @@ struct aws_s3_client_config {
     /* If the part size needs to be adjusted for service limits, this is the maximum size it will be adjusted to.. */
     size_t max_part_size;
 
-    /* Throughput target in Gbps that we are trying to reach. */
+    /* Throughput target in Gbps that we are trying to reach. If 0, the max throughput of the instance type (see
+     * instance_type and enable_instance_type_detection) is used when it is known, or else a default of 10 Gbps. */
     double throughput_target_gbps;
 
+    /* Upper bound, in bytes, on the part buffers the client commits to at once (for both downloaded and uploaded
+     * parts). Once reached, no new part requests are started until earlier parts are released. If 0, memory is only
+     * bounded by the number of requests in flight. */
+    uint64_t memory_limit_in_bytes;
+
+    /* When true, GET meta requests only request parts as far into the object as the caller has opened their read
+     * window (see aws_s3_meta_request_increment_read_window), so that memory use follows how fast the caller consumes
+     * the body rather than how fast the network delivers it. */
+    bool enable_read_backpressure;
+
+    /* Size in bytes of the read window that each meta request starts out with when enable_read_backpressure is set.
+     * Every part that starts within the window is requested in full, and the first part is always requested. */
+    size_t initial_read_window;
+
     /* Retry strategy to use. If NULL, a default retry strategy will be used. */
     struct aws_retry_strategy *retry_strategy;
 
+    /* Number of bytes of downloaded objects that the client keeps in memory, so that GET meta requests reading ranges
+     * that were read before are served from memory instead of S3. Objects are kept per ETag, in aligned blocks of
+     * block_cache_block_size bytes, and the least recently used blocks are evicted first. If 0, nothing is kept. */
+    uint64_t block_cache_size_in_bytes;
+
+    /* Size of the blocks of the block cache. If 0, a default of 1MB is used. */
+    size_t block_cache_block_size;
+
+    /* When true, the client periodically samples the bytes transferred per connection and the rate of SlowDown
+     * responses, and adjusts the number of active connections at runtime: backing off when throttled and growing while
+     * more connections keep paying off. It starts from the value derived from throughput_target_gbps, and can grow past
+     * it, up to max_adaptive_connections. It never exceeds max_active_connections_override, or the budget of the
+     * client's client_context. */
+    bool enable_adaptive_connections;
+
+    /* Most connections that enable_adaptive_connections can grow to. If 0, it can grow to 4 times the value derived
+     * from throughput_target_gbps, but not past as many connections as memory_limit_in_bytes has part buffers for.
+     * Ignored unless enable_adaptive_connections is true. */
+    uint32_t max_adaptive_connections;
+
+    /* Number of event loops that scheduling work (handing requests out to meta requests and queueing them up on
+     * connections) is spread across. Each meta request is assigned to one of them. 0 or 1 means all scheduling happens
+     * on a single event loop. Clamped to the number of event loops in the client bootstrap's event loop group. */
+    uint32_t num_work_event_loops;
+
+    /* When true, and the machine has more than one CPU group (NUMA node), the client creates an event loop group,
+     * connection managers, body streaming threads and a part buffer pool pinned to each CPU group, and assigns each
+     * meta request to one of them. A meta request's connection I/O, part buffers and body streaming callbacks then
+     * all stay on the same node. The client bootstrap's host resolver is shared by all CPU groups. */
+    bool enable_cpu_group_affinity;
+
+    /* Optional EC2 instance type (for example "c5n.18xlarge"). When the instance type is known to
+     * aws_s3_get_compute_platform_info_for_instance_type, its max throughput is the default throughput_target_gbps
+     * (and so sizes the number of connections), and when enable_cpu_group_affinity is set only the CPU groups that
+     * have a network device attached are used. Otherwise all CPU groups are used. */
+    struct aws_byte_cursor instance_type;
+
+    /* When true and instance_type is not set, the instance type is detected with aws_s3_detect_instance_type when the
+     * client is created, and used as if it had been passed as instance_type. */
+    bool enable_instance_type_detection;
+
+    /* Optional client context (see aws_s3_client_context_new) to attach to, shared with other clients. Its threads
+     * are used to stream response bodies, unless the client pins work to CPU groups, and the client's active
+     * connections are limited to its share of the context's budget. Its throughput target is the default
+     * throughput_target_gbps. The client holds a reference to the context until it has shut down. */
+    struct aws_s3_client_context *client_context;
+
     /**
      * For multi-part upload, content-md5 will be calculated if the AWS_MR_CONTENT_MD5_ENABLED is specified
      *     or initial request has content-md5 header.
      * For single-part upload, keep the content-md5 in the initial request unchanged. */
     enum aws_s3_meta_request_compute_content_md5 compute_content_md5;
 
+    /* Checksum that uploads are sent with, unless their meta request asks for another one. AWS_SCA_NONE to send none.
+     */
+    enum aws_s3_checksum_algorithm checksum_algorithm;
+
+    /* How payloads are signed, unless their meta request asks for something else. */
+    enum aws_s3_payload_signing_mode payload_signing_mode;
+
     /* Callback and associated user data for when the client has completed its shutdown process. */
     aws_s3_client_shutdown_complete_callback_fn *shutdown_callback;
     void *shutdown_callback_user_data;
 };
 
+/* Options of aws_s3_client_context_new. */
+struct aws_s3_client_context_options {
+    /* Number of threads that the attached clients stream response bodies to their callers on. If 0, one per
+     * processor. */
+    uint16_t num_body_streaming_threads;
+
+    /* Max number of active connections of all the attached clients together. If 0, it is derived from
+     * throughput_target_gbps the way a client derives its own, and if both are 0 there is no limit. */
+    uint32_t max_active_connections;
+
+    /* Throughput target in Gbps of all the attached clients together. Also the throughput target of each attached
+     * client that doesn't have one of its own, so that a client running on its own can use the whole budget. */
+    double throughput_target_gbps;
+};
+
+/* Range of bytes of an object. Both ends are included. */
+struct aws_s3_byte_range {
+    uint64_t start;
+    uint64_t end;
+};
+
+/**
+ * How far an earlier download of an object got, so that a new GET meta request only fetches what is still missing.
+ */
+struct aws_s3_get_object_checkpoint {
+    /* ETag of the object, as passed in the ETag header to the headers callback of the earlier meta request. */
+    struct aws_byte_cursor etag;
+
+    /* Ranges of the object that have been received already, as passed to the body callback of the earlier meta
+     * request (which passes the offset and length of each chunk of the body). Can be in any order, and overlap. */
+    const struct aws_s3_byte_range *completed_ranges;
+    size_t num_completed_ranges;
+};
+
 /* Options for a new meta request, ie, file transfer that will be handled by the high performance client. */
 struct aws_s3_meta_request_options {
 
@@ -207,6 +414,13 @@ struct aws_s3_meta_request_options {
     /* Callback for when the meta request has completely cleaned up. */
     aws_s3_meta_request_shutdown_fn *shutdown_callback;
 
+    /**
+     * Optional.
+     * Invoked with the timing of each request once it has finished.
+     * See `aws_s3_meta_request_telemetry_fn`.
+     */
+    aws_s3_meta_request_telemetry_fn *telemetry_callback;
+
     /**
      * If true, use https - either with a CRT-generated TLS context - or with an
      * explicit context provided by the CRT caller. If false, use http.
@@ -215,6 +429,197 @@ struct aws_s3_meta_request_options {
 
     /* HTTP port override. If -1, determine port based on TLS context */
     int port;
+
+    /**
+     * Optional.
+     * Scheduling priority of this meta request. See `aws_s3_meta_request_priority`.
+     */
+    enum aws_s3_meta_request_priority priority;
+
+    /**
+     * Optional.
+     * Share of request slots this meta request receives relative to other meta requests of the same priority. For
+     * example, a meta request with a weight of 4 has up to 4 requests prepared for every 1 request of a meta request
+     * with a weight of 1. If 0, a weight of 1 is used.
+     */
+    uint32_t weight;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT.
+     * If true, a part that has been in flight much longer than is typical for this meta request, or that has been
+     * holding up delivery of parts that arrived after it for too long, is requested a second time. Whichever of the
+     * two requests finishes first is delivered, and the other one is canceled.
+     */
+    bool enable_part_hedging;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT and AWS_S3_META_REQUEST_TYPE_DEFAULT.
+     * If true, the body of the part that is next in line to be delivered is passed to the body callback as it arrives
+     * from the network, instead of being buffered until the whole part has been received. Only parts that arrive out of
+     * order are buffered. While a part is streamed this way, the body callback is invoked from the thread of the
+     * connection receiving it. Cannot be combined with enable_part_hedging.
+     * With AWS_S3_META_REQUEST_DELIVERY_UNORDERED, every part is streamed this way, not just the next one in line.
+     * A default meta request only has the one part, and only streams it this way if there is no headers callback,
+     * since its headers are only passed on once the response is complete.
+     */
+    bool enable_direct_body_streaming;
+
+    /**
+     * Optional.
+     * Order in which the response body is delivered to the body callback. See `aws_s3_meta_request_delivery`. Defaults
+     * to AWS_S3_META_REQUEST_DELIVERY_ORDERED.
+     */
+    enum aws_s3_meta_request_delivery delivery;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT and AWS_S3_META_REQUEST_TYPE_PUT_OBJECT.
+     * Hint that the object is small (well under the client's part size), for workloads made of many small GETs and PUTs
+     * where the cost of each request matters more than bandwidth. A GET is then sent as a single request for the whole
+     * object, without first learning its size and splitting it in parts, and the response body is passed to the body
+     * callback as soon as the response is complete, from the thread of the connection it arrived on, instead of going
+     * through the body streaming queue. Ignored for a GET that has a get_checkpoint.
+     *
+     * The size of a GET's object isn't known until its response arrives, so the hint is trusted even for objects bigger
+     * than the client's part size: such a GET still succeeds, but with one request, and with its whole body held in
+     * memory before it is delivered. Only set the hint when the object is known to be small. A PUT is sent as a single
+     * request when its Content-Length is under the upload part size (the client's part size, but at least 5 MiB), with
+     * or without the hint; the hint only has its response delivered inline. Above that, the hint is ignored and the
+     * object is uploaded in parts as usual.
+     */
+    bool small_object_hint;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT.
+     * If true, parts don't all have the client's part size. The first part is small, so that the first bytes of the
+     * object (and its size) come back quickly, and the parts after it grow geometrically, so that big objects are
+     * downloaded with fewer, larger requests. Parts stop growing once there are just enough of them left to keep all
+     * connections busy, and never grow beyond a few times the part size.
+     */
+    bool enable_variable_part_size;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT without a Range header.
+     * Number of parts to request at once while the size of the object isn't known yet, instead of only requesting the
+     * first part, and the others once its response has told the size of the object. This saves a round trip before
+     * the download goes parallel, at the cost of a wasted request for every part that turns out to be past the end of
+     * the object (which S3 answers with a 416, and which is then dropped). 0 or 1 to only request the first part.
+     * Ignored with enable_variable_part_size, a get_checkpoint, AWS_S3_META_REQUEST_DELIVERY_UNORDERED, read
+     * backpressure, or the client's block cache.
+     */
+    uint32_t num_speculative_parts;
+
+    /**
+     * Optional. Only used along with num_speculative_parts, or in its place.
+     * Size the object is expected to have. No more parts are requested before the size of the object is known than it
+     * takes to cover this size, and no more than num_speculative_parts if that is set. 0 if unknown.
+     */
+    uint64_t object_size_hint;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_PUT_OBJECT.
+     * Path of a file to upload. Parts are then read straight from the file at their offsets, concurrently, instead of
+     * one after the other from the body stream of the message, which doesn't need to have one. The message still needs
+     * a Content-Length header.
+     */
+    struct aws_byte_cursor send_filepath;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_PUT_OBJECT, and ignored if send_filepath is set.
+     * Reads the body at a given offset. Like with send_filepath, parts are then read concurrently, and the message
+     * doesn't need a body stream.
+     * See `aws_s3_meta_request_read_body_at_fn`.
+     */
+    aws_s3_meta_request_read_body_at_fn *read_body_at_callback;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_PUT_OBJECT, and ignored if send_filepath or read_body_at_callback
+     * is set.
+     * Body as a list of buffers owned by the caller (the encoded pages of a file, for instance), one after the other.
+     * The list is copied, but the bytes aren't: parts are sent straight from the buffers, concurrently, instead of
+     * being read into part buffers first. A part that spans several buffers is gathered from them as it is sent,
+     * unless its checksum goes in a trailer, which needs it in one piece. The message doesn't need a body stream, but
+     * needs a Content-Length header, which has to be the size of all the buffers together.
+     * The buffers must stay valid, and must not change, until send_buffers_release_callback is invoked.
+     */
+    const struct aws_byte_cursor *send_buffers;
+    size_t num_send_buffers;
+
+    /**
+     * Optional. Invoked once, right before finish_callback, once no request reads send_buffers any longer. Not invoked
+     * if the meta request could not be made.
+     * See `aws_s3_meta_request_send_buffers_release_fn`.
+     */
+    aws_s3_meta_request_send_buffers_release_fn *send_buffers_release_callback;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT.
+     * Path of a file to download the object to. It is created, or truncated if it exists, and every part is written
+     * straight to it at its own offset, as soon as it has arrived, from whichever thread it arrived on, so delivery is
+     * always AWS_S3_META_REQUEST_DELIVERY_UNORDERED. body_callback, if set, is still invoked with every part once it
+     * has been written (to report progress, for instance), with the same concurrency. The file is closed before
+     * finish_callback is invoked. It is left as is if the meta request fails.
+     */
+    struct aws_byte_cursor recv_filepath;
+
+    /**
+     * Optional. Only used with recv_filepath.
+     * If true, space is allocated for the whole file as soon as the size of the object is known, so that the file
+     * doesn't fragment as parts are written to it out of order.
+     */
+    bool recv_file_preallocate;
+
+    /**
+     * Optional. Only used with recv_filepath.
+     * If true, parts are written to the file bypassing the page cache (O_DIRECT, or FILE_FLAG_NO_BUFFERING on Windows)
+     * wherever they are aligned to the page size, which is the case for whole parts held in buffers of the buffer pool.
+     * Writes that aren't aligned, and all writes on platforms or file systems without direct I/O, go through the page
+     * cache as usual.
+     */
+    bool recv_file_direct_io;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_PUT_OBJECT.
+     * Token returned by aws_s3_meta_request_pause for an earlier meta request uploading the same body to the same
+     * object. The multipart upload of that meta request is then carried on, and only the parts that it hadn't uploaded
+     * yet are sent. The body has to be seekable, unless it is read through send_filepath or read_body_at_callback.
+     */
+    struct aws_byte_cursor resume_token;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT.
+     * Resume an earlier download of the object. Parts entirely made of completed ranges of the checkpoint are not
+     * requested, and so aren't passed to the body callback again. The first part is always requested, as it is used to
+     * learn the size of the object. Every request is sent with an If-Match header for the ETag of the checkpoint, so
+     * that if the object has changed since, the meta request fails with a 412 response status, instead of mixing data
+     * of two versions of the object. Copied, so it doesn't have to outlive the call.
+     *
+     * Without a checkpoint, requests after the first one are pinned to the ETag of the first response the same way.
+     */
+    const struct aws_s3_get_object_checkpoint *get_checkpoint;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_PUT_OBJECT.
+     * Checksum to send the upload with. If AWS_SCA_NONE, the checksum_algorithm of the client is used. Ignored for
+     * single-part uploads whose message already has an x-amz-checksum-<algorithm> header.
+     */
+    enum aws_s3_checksum_algorithm checksum_algorithm;
+
+    /**
+     * Optional. Only used by AWS_S3_META_REQUEST_TYPE_GET_OBJECT.
+     * When true, the checksums stored with the object are asked for, and the body of every response that S3 sends a
+     * checksum with is checked against it as it arrives. A response that doesn't match is retried like a failed
+     * request. Responses are then held until they have been checked, rather than passed on to the body callback as
+     * they arrive. S3 only sends checksums for ranges it has one for (the whole object, or a whole part of it as it was
+     * uploaded), so parts that don't line up with the parts of the upload are not checked.
+     */
+    bool validate_response_checksum;
+
+    /**
+     * Optional.
+     * How the payloads of the requests of this meta request are signed. If AWS_S3_PAYLOAD_SIGNING_MODE_DEFAULT, the
+     * payload_signing_mode of the client is used.
+     */
+    enum aws_s3_payload_signing_mode payload_signing_mode;
 };
 
 /* Result details of a meta request.
@@ -242,6 +647,115 @@ struct aws_s3_meta_request_result {
     int error_code;
 };
 
+/* Snapshot of a client's counters, as returned by aws_s3_client_get_metrics. Every counter is read atomically, but the
+ * counters are read one after the other without a lock, so they are not guaranteed to be consistent with each other. */
+struct aws_s3_client_metrics {
+    /* Number of requests that have been prepared (or are being prepared) and have not been cleaned up yet. */
+    uint32_t num_requests_in_flight;
+
+    /* Number of requests currently being sent/received over the network, per meta request type. */
+    uint32_t num_requests_network_io[AWS_S3_META_REQUEST_TYPE_MAX];
+
+    /* Number of connections currently in use, which is the sum of num_requests_network_io. */
+    uint32_t num_active_connections;
+
+    /* Number of connections that the client currently allows to be in use at once. When enable_adaptive_connections is
+     * set, this changes over time. */
+    uint32_t max_active_connections;
+
+    /* Number of requests waiting for their turn to be streamed back to the caller. */
+    uint32_t num_requests_stream_queued_waiting;
+
+    /* Number of requests currently being streamed back to the caller. */
+    uint32_t num_requests_streaming;
+
+    /* Number of request and response body bytes of successfully finished requests. */
+    uint64_t num_bytes_transferred;
+
+    /* Number of SlowDown responses received. */
+    uint64_t num_slow_down_errors;
+};
+
+/* Snapshot of a meta request's counters, as returned by aws_s3_meta_request_get_metrics. As with aws_s3_client_metrics,
+ * the counters are read without a lock. */
+struct aws_s3_meta_request_metrics {
+    /* Number of request and response body bytes of successfully finished requests. */
+    uint64_t num_bytes_transferred;
+
+    /* Number of requests (usually parts) that have been prepared and have not been cleaned up yet. */
+    uint32_t num_requests_in_flight;
+
+    /* Number of connections currently in use by this meta request. */
+    uint32_t num_active_connections;
+
+    /* Number of requests that finished successfully. */
+    uint64_t num_requests_succeeded;
+
+    /* Number of requests that finished unsuccessfully, after any retries. */
+    uint64_t num_requests_failed;
+
+    /* Number of times a request was retried. */
+    uint64_t num_retries;
+
+    /* Average time between a request first being sent and it finishing successfully, retries included. 0 if no request
+     * has succeeded yet. */
+    uint64_t average_request_latency_ns;
+};
+
+/* Timing of a single request made on behalf of a meta request, as passed to the meta request's telemetry_callback.
+ *
+ * Timestamps are in nanoseconds from aws_high_res_clock_get_ticks, and are 0 for stages the request never reached. A
+ * request that is retried is prepared, signed and sent again, in which case those timestamps are of its last attempt.
+ * Roughly, a request spends:
+ *  - prepare_start to sign_start building its message (and reading its body, for uploads)
+ *  - sign_start to sign_end being signed
+ *  - queue_start to queue_end waiting in the client's queue for a connection slot
+ *  - connection_acquire_start to connection_acquire_end waiting for a connection from the connection manager
+ *  - send_start to first_byte waiting for the response headers (time to first byte)
+ *  - first_byte to finish receiving the response body and finishing up */
+struct aws_s3_request_metrics {
+    /* Part number of the request, or 0 if the request is not for a part. */
+    uint32_t part_number;
+
+    /* Number of times the request was retried. */
+    uint32_t num_retries;
+
+    /* Response status of the last attempt, or 0 if no response was received. */
+    int response_status;
+
+    /* Error code that the request finished with. */
+    int error_code;
+
+    uint64_t prepare_start_timestamp_ns;
+    uint64_t sign_start_timestamp_ns;
+    uint64_t sign_end_timestamp_ns;
+    uint64_t queue_start_timestamp_ns;
+    uint64_t queue_end_timestamp_ns;
+    uint64_t connection_acquire_start_timestamp_ns;
+    uint64_t connection_acquire_end_timestamp_ns;
+    uint64_t send_start_timestamp_ns;
+    uint64_t first_byte_timestamp_ns;
+    uint64_t finish_timestamp_ns;
+};
+
+/* Options for aws_s3_client_prewarm_endpoint. */
+struct aws_s3_client_prewarm_endpoint_options {
+    /* Host name of the endpoint, ie, the value of the Host header of the meta requests that will be made to it. */
+    struct aws_byte_cursor host_name;
+
+    /* Number of idle connections to open ahead of time. Capped at the client's max number of active connections. */
+    uint32_t num_connections;
+
+    /* Must match the use_tls and port of the meta requests that will be made to the endpoint, as connections are
+     * shared by all meta requests to the same host. See aws_s3_meta_request_options. */
+    bool use_tls;
+    int port;
+
+    /* Optional. Invoked once all connections have been opened, or have failed to. */
+    aws_s3_client_prewarm_endpoint_callback_fn *callback;
+    void *user_data;
+};
+
 AWS_EXTERN_C_BEGIN
 
 AWS_S3_API
@@ -255,6 +769,30 @@ void aws_s3_client_acquire(struct aws_s3_client *client);
 AWS_S3_API
 void aws_s3_client_release(struct aws_s3_client *client);
 
+/**
+ * Create resources that several clients (for example, one per region or signing config) attach to, through the
+ * client_context of their aws_s3_client_config, instead of each setting up its own:
+ *  - the threads that response bodies are streamed to callers on
+ *  - one budget of active connections for all of them, split evenly between the clients that have requests in flight,
+ *    so that together they don't oversubscribe the network, and a client that is on its own gets all of it
+ *
+ * Returns NULL on failure. Check aws_last_error() for details on the error that occurred.
+ *
+ * This is a reference counted object, returned with a reference count of 1. You must call
+ * aws_s3_client_context_release() on it when you are finished with it. Every attached client holds a reference to it
+ * until it has finished shutting down.
+ */
+AWS_S3_API
+struct aws_s3_client_context *aws_s3_client_context_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_client_context_options *options);
+
+AWS_S3_API
+void aws_s3_client_context_acquire(struct aws_s3_client_context *context);
+
+AWS_S3_API
+void aws_s3_client_context_release(struct aws_s3_client_context *context);
+
 AWS_S3_API
 struct aws_s3_meta_request *aws_s3_client_make_meta_request(
     struct aws_s3_client *client,
@@ -263,6 +801,54 @@ struct aws_s3_meta_request *aws_s3_client_make_meta_request(
 AWS_S3_API
 void aws_s3_meta_request_cancel(struct aws_s3_meta_request *meta_request);
 
+/**
+ * Pause a meta request, so that it can be resumed later by a new meta request. Only supported by
+ * AWS_S3_META_REQUEST_TYPE_PUT_OBJECT meta requests doing a multipart upload of a body of known length, once the
+ * multipart upload has been created, and until it is being completed. The meta request then finishes with
+ * AWS_ERROR_S3_PAUSED, without aborting the multipart upload, and a token describing it (its upload id, part size,
+ * and the parts uploaded so far) is appended to out_resume_token. Pass that token as resume_token of the new meta
+ * request. Parts still in flight when the meta request is paused are uploaded again when it is resumed.
+ */
+AWS_S3_API
+int aws_s3_meta_request_pause(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *out_resume_token);
+
+/**
+ * Open the read window of a meta request by the given number of bytes, letting the client request that much more of
+ * the object. Only has an effect if the client was created with enable_read_backpressure set. Typically called once
+ * the caller has consumed data passed to the body callback. Safe to call from any thread, including from within the
+ * body callback, and after the meta request has finished.
+ */
+AWS_S3_API
+void aws_s3_meta_request_increment_read_window(struct aws_s3_meta_request *meta_request, uint64_t bytes);
+
+/**
+ * Set up the endpoint for the given host ahead of any meta requests to it: start resolving its addresses, and open
+ * idle connections to it, so that the first meta request doesn't pay for DNS resolution and connection setup. The
+ * endpoint is kept until the client shuts down. Returns AWS_OP_ERR if the endpoint could not be set up; failures to
+ * open connections are reported through the callback.
+ */
+AWS_S3_API
+int aws_s3_client_prewarm_endpoint(
+    struct aws_s3_client *client,
+    const struct aws_s3_client_prewarm_endpoint_options *options);
+
+/**
+ * Fills out_metrics with a snapshot of the client's counters. Does not take any locks, not even that of the client's
+ * client_context, so it is cheap enough to be polled frequently, from any thread, without slowing down scheduling. The
+ * counters are read one at a time, so they may not all be from the same instant.
+ */
+AWS_S3_API
+void aws_s3_client_get_metrics(struct aws_s3_client *client, struct aws_s3_client_metrics *out_metrics);
+
+/**
+ * Fills out_metrics with a snapshot of the meta request's counters. Does not take any locks, so it is cheap enough to
+ * be polled frequently, from any thread, including after the meta request has finished.
+ */
+AWS_S3_API
+void aws_s3_meta_request_get_metrics(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_meta_request_metrics *out_metrics);
+
 AWS_S3_API
 void aws_s3_meta_request_acquire(struct aws_s3_meta_request *meta_request);
 
@@ -6,6 +6,7 @@
 
 #include <aws/common/array_list.h>
 #include <aws/common/clock.h>
+#include <aws/common/math.h>
 #include <aws/common/mutex.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/common/thread.h>
@@ -208,7 +209,11 @@ void progress_listener_render(struct progress_listener *listener) {
     fprintf(group->render_sink, "%.100s\n", aws_string_c_str(listener->label));
     fprintf(group->render_sink, "\33[2K");
 
-    size_t completion = (size_t)(((double)listener->current / (double)listener->max) * 100);
+    /* the max can be unknown (0), or grow slower than the progress, while transfers are still being discovered. */
+    size_t completion = 0;
+    if (listener->max > 0) {
+        completion = (size_t)(((double)aws_min_u64(listener->current, listener->max) / (double)listener->max) * 100);
+    }
 
     size_t ticks = 50;
     size_t completed_ticks = completion / (100 / ticks);
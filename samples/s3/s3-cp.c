@@ -3,13 +3,14 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
+#include <aws/common/clock.h>
 #include <aws/common/command_line_parser.h>
 #include <aws/common/file.h>
-#include <aws/io/stream.h>
 #include <aws/io/uri.h>
 #include <aws/s3/private/s3_auto_ranged_put.h>
 #include <aws/s3/private/s3_copy_object.h>
 #include <aws/s3/private/s3_list_objects.h>
+#include <aws/s3/private/s3_transfer_engine.h>
 
 #include "app_ctx.h"
 #include "cli_progress_bar.h"
@@ -26,13 +27,17 @@ struct cp_app_ctx {
     struct aws_uri source_uri;
     struct aws_uri destination_uri;
     struct progress_listener_group *listener_group;
+    struct progress_listener *listener;
+    struct aws_s3_transfer_engine *engine;
+    struct aws_s3_paginator *paginator;
     struct aws_mutex mutex;
     struct aws_condition_variable c_var;
     const char *source_endpoint;
     const char *dest_endpoint;
-    size_t expected_transfers;
-    size_t completed_transfers;
-    bool list_objects_completed;
+    uint64_t total_bytes;
+    uint64_t reported_bytes;
+    bool transfers_done;
+    int error_code;
     bool source_s3;
     bool source_file_system;
     bool dest_s3;
@@ -40,13 +45,6 @@ struct cp_app_ctx {
     bool source_is_directory_or_prefix;
 };
 
-struct single_transfer_ctx {
-    struct cp_app_ctx *cp_app_ctx;
-    struct progress_listener *listener;
-    struct aws_s3_meta_request *meta_request;
-    FILE *output_sink;
-};
-
 static void s_usage(int exit_code) {
     FILE *sink = exit_code == 0 ? stdout : stderr;
 
@@ -215,63 +213,6 @@ int s3_cp_main(int argc, char *argv[], const char *command_name, void *user_data
     return 0;
 }
 
-/* this stream wrapper is purely for updating progress bars on upload */
-struct progress_update_stream {
-    struct aws_input_stream input_stream;
-    struct single_transfer_ctx *transfer;
-    struct aws_input_stream *wrapped_stream;
-};
-
-int s_input_seek(struct aws_input_stream *stream, int64_t offset, enum aws_stream_seek_basis basis) {
-    struct progress_update_stream *update_stream = stream->impl;
-
-    if (basis == AWS_SSB_BEGIN && offset == 0) {
-        progress_listener_reset_progress(update_stream->transfer->listener);
-        struct aws_string *state =
-            aws_string_new_from_c_str(update_stream->transfer->cp_app_ctx->app_ctx->allocator, "In Progress");
-        progress_listener_update_state(update_stream->transfer->listener, state);
-        aws_string_destroy(state);
-    }
-
-    return update_stream->wrapped_stream->vtable->seek(stream, offset, basis);
-}
-
-int s_input_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
-    struct progress_update_stream *update_stream = stream->impl;
-
-    size_t current_len = dest->len;
-    int val = update_stream->wrapped_stream->vtable->read(update_stream->wrapped_stream, dest);
-    size_t progress = dest->len - current_len;
-    progress_listener_update_progress(update_stream->transfer->listener, progress);
-    return val;
-}
-
-static int s_input_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
-    struct progress_update_stream *update_stream = stream->impl;
-
-    return update_stream->wrapped_stream->vtable->get_status(update_stream->wrapped_stream, status);
-}
-
-static int s_input_get_length(struct aws_input_stream *stream, int64_t *out_length) {
-    struct progress_update_stream *update_stream = stream->impl;
-    return update_stream->wrapped_stream->vtable->get_length(update_stream->wrapped_stream, out_length);
-}
-
-static void s_input_destroy(struct aws_input_stream *stream) {
-    struct progress_update_stream *update_stream = stream->impl;
-    update_stream->wrapped_stream->vtable->destroy(update_stream->wrapped_stream);
-    aws_mem_release(stream->allocator, update_stream);
-}
-
-static struct aws_input_stream_vtable s_update_input_stream_vtable = {
-    .get_length = s_input_get_length,
-    .seek = s_input_seek,
-    .read = s_input_read,
-    .get_status = s_input_get_status,
-    .destroy = s_input_destroy,
-};
-/* end of stream for the progress bar */
-
 static const struct aws_byte_cursor g_host_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Host");
 static const struct aws_byte_cursor g_x_amz_copy_source_name =
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-copy-source");
@@ -335,145 +276,126 @@ error_clean_up_message:
     return NULL;
 }
 
-/* upon copy object progress, update the progress bar. */
-static void s_copy_object_progress(
-    struct aws_s3_meta_request *meta_request,
-    const struct aws_s3_meta_request_progress *progress,
-    void *user_data) {
-    (void)meta_request;
+/* report the bytes transferred since the last update, and how the transfers are going, on the progress bar. */
+static void s_update_progress(struct cp_app_ctx *cp_app_ctx) {
+    struct aws_s3_transfer_engine_stats stats;
+    aws_s3_transfer_engine_get_stats(cp_app_ctx->engine, &stats);
+
+    aws_mutex_lock(&cp_app_ctx->mutex);
+    uint64_t progress = 0;
+    if (stats.num_bytes_transferred > cp_app_ctx->reported_bytes) {
+        progress = stats.num_bytes_transferred - cp_app_ctx->reported_bytes;
+        cp_app_ctx->reported_bytes = stats.num_bytes_transferred;
+    }
+    aws_mutex_unlock(&cp_app_ctx->mutex);
 
-    struct single_transfer_ctx *transfer_ctx = user_data;
+    progress_listener_update_progress(cp_app_ctx->listener, progress);
 
-    progress_listener_update_max_value(transfer_ctx->listener, progress->content_length);
-    progress_listener_update_progress(transfer_ctx->listener, progress->bytes_transferred);
+    char label_buffer[256];
+    snprintf(
+        label_buffer,
+        sizeof(label_buffer),
+        "transfers: %" PRIu64 " done, %" PRIu64 " failed, %zu running, %" PRIu64 " MB/s",
+        stats.num_transfers_succeeded,
+        stats.num_transfers_failed,
+        stats.num_transfers_active,
+        stats.bytes_per_second / (1024 * 1024));
+
+    struct aws_string *label = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, label_buffer);
+    progress_listener_update_label(cp_app_ctx->listener, label);
+    aws_string_destroy(label);
 }
 
-/* invoked upon the completion of a copy object request. */
-static void s_copy_object_request_finish(
-    struct aws_s3_meta_request *meta_request,
-    const struct aws_s3_meta_request_result *meta_request_result,
+/* invoked upon the completion of each transfer. */
+static void s_on_transfer_finished(
+    struct aws_s3_transfer_engine *engine,
+    void *transfer_user_data,
+    const struct aws_s3_meta_request_result *result,
     void *user_data) {
-    (void)meta_request;
-    struct single_transfer_ctx *transfer_ctx = user_data;
+    (void)engine;
+    (void)transfer_user_data;
+    (void)result;
 
-    struct aws_string *new_state = NULL;
-    if (meta_request_result->error_code == AWS_ERROR_SUCCESS) {
-        new_state = aws_string_new_from_c_str(transfer_ctx->cp_app_ctx->app_ctx->allocator, "Completed");
-        progress_listener_update_progress(transfer_ctx->listener, 100);
-    } else {
-        new_state = aws_string_new_from_c_str(transfer_ctx->cp_app_ctx->app_ctx->allocator, "Error");
-    }
+    s_update_progress(user_data);
+}
 
-    progress_listener_update_state(transfer_ctx->listener, new_state);
-    aws_s3_meta_request_release(transfer_ctx->meta_request);
+/* invoked once every transfer is done. */
+static void s_on_transfers_finished(struct aws_s3_transfer_engine *engine, int error_code, void *user_data) {
+    (void)engine;
 
-    aws_mutex_lock(&transfer_ctx->cp_app_ctx->mutex);
-    transfer_ctx->cp_app_ctx->completed_transfers++;
-    aws_mutex_unlock(&transfer_ctx->cp_app_ctx->mutex);
-    aws_condition_variable_notify_one(&transfer_ctx->cp_app_ctx->c_var);
+    struct cp_app_ctx *cp_app_ctx = user_data;
 
-    aws_mem_release(transfer_ctx->cp_app_ctx->app_ctx->allocator, transfer_ctx);
-}
+    s_update_progress(cp_app_ctx);
 
-/* create a copy object request and send it based on the source bucket/key and destination bucket/key. */
-static int s_kick_off_copy_object_request(
-    struct cp_app_ctx *cp_app_ctx,
-    const struct aws_byte_cursor *source_bucket,
-    const struct aws_byte_cursor *source_key,
-    const struct aws_byte_cursor *destination_key) {
-    struct aws_http_message *message =
-        s_copy_object_request_new(cp_app_ctx, source_bucket, source_key, destination_key);
+    struct aws_string *state = aws_string_new_from_c_str(
+        cp_app_ctx->app_ctx->allocator, error_code == AWS_ERROR_SUCCESS ? "Completed" : "Failed");
+    progress_listener_update_state(cp_app_ctx->listener, state);
+    aws_string_destroy(state);
 
-    struct single_transfer_ctx *transfer_ctx =
-        aws_mem_calloc(cp_app_ctx->app_ctx->allocator, 1, sizeof(struct single_transfer_ctx));
-    transfer_ctx->cp_app_ctx = cp_app_ctx;
-
-    struct aws_byte_buf label_buf;
-    struct aws_byte_cursor label_start_cur = aws_byte_cursor_from_c_str("copy: s3://");
-    aws_byte_buf_init_copy_from_cursor(&label_buf, cp_app_ctx->app_ctx->allocator, label_start_cur);
-    aws_byte_buf_append_dynamic(&label_buf, source_bucket);
-    aws_byte_buf_append_byte_dynamic(&label_buf, '/');
-    aws_byte_buf_append_dynamic(&label_buf, source_key);
-    struct aws_byte_cursor to_cur = aws_byte_cursor_from_c_str(" to s3://");
-    aws_byte_buf_append_dynamic(&label_buf, &to_cur);
-    aws_byte_buf_append_dynamic(&label_buf, &cp_app_ctx->destination_uri.host_name);
-    aws_byte_buf_append_dynamic(&label_buf, destination_key);
-
-    struct aws_string *label = aws_string_new_from_buf(cp_app_ctx->app_ctx->allocator, &label_buf);
-    aws_byte_buf_clean_up(&label_buf);
-    struct aws_string *state = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, "In Progress");
+    aws_mutex_lock(&cp_app_ctx->mutex);
+    cp_app_ctx->transfers_done = true;
+    cp_app_ctx->error_code = error_code;
+    aws_mutex_unlock(&cp_app_ctx->mutex);
+    aws_condition_variable_notify_one(&cp_app_ctx->c_var);
+}
 
-    transfer_ctx->listener = progress_listener_new(cp_app_ctx->listener_group, label, state, 100);
+static bool s_are_all_transfers_done(void *arg) {
+    struct cp_app_ctx *cp_app_ctx = arg;
+    return cp_app_ctx->transfers_done;
+}
 
-    struct aws_s3_meta_request_options meta_request_options = {
-        .user_data = transfer_ctx,
-        .body_callback = NULL,
-        .signing_config = &cp_app_ctx->app_ctx->signing_config,
-        .finish_callback = s_copy_object_request_finish,
-        .headers_callback = NULL,
-        .message = message,
-        .shutdown_callback = NULL,
-        .progress_callback = s_copy_object_progress,
-        .type = AWS_S3_META_REQUEST_TYPE_COPY_OBJECT,
-    };
+/* hand a transfer over to the engine, which runs it once it gets its turn. */
+static int s_queue_transfer(
+    struct cp_app_ctx *cp_app_ctx,
+    enum aws_s3_meta_request_type type,
+    struct aws_http_message *message,
+    struct aws_byte_cursor filepath,
+    uint64_t size) {
 
-    transfer_ctx->meta_request = aws_s3_client_make_meta_request(cp_app_ctx->app_ctx->client, &meta_request_options);
-    if (transfer_ctx->meta_request == NULL) {
-        fprintf(
-            stderr,
-            "Failure when initiating copy object request with error %s\n",
-            aws_error_debug_str(aws_last_error()));
-        exit(1);
+    if (message == NULL) {
+        return AWS_OP_ERR;
     }
 
-    aws_mutex_lock(&transfer_ctx->cp_app_ctx->mutex);
-    transfer_ctx->cp_app_ctx->expected_transfers++;
-    aws_mutex_unlock(&transfer_ctx->cp_app_ctx->mutex);
+    aws_mutex_lock(&cp_app_ctx->mutex);
+    cp_app_ctx->total_bytes += size;
+    uint64_t total_bytes = cp_app_ctx->total_bytes;
+    aws_mutex_unlock(&cp_app_ctx->mutex);
 
-    return AWS_OP_SUCCESS;
-}
-
-/* invoked upon an upload completion. */
-void s_put_request_finished(
-    struct aws_s3_meta_request *meta_request,
-    const struct aws_s3_meta_request_result *meta_request_result,
-    void *user_data) {
-    (void)meta_request;
+    progress_listener_update_max_value(cp_app_ctx->listener, total_bytes);
 
-    struct single_transfer_ctx *transfer_ctx = user_data;
+    struct aws_s3_transfer_options transfer = {
+        .type = type,
+        .message = message,
+        .filepath = filepath,
+        .size = size,
+    };
 
-    struct aws_string *state = NULL;
-    if (meta_request_result->error_code == AWS_ERROR_SUCCESS) {
-        state = aws_string_new_from_c_str(transfer_ctx->cp_app_ctx->app_ctx->allocator, "Completed");
-    } else {
-        state = aws_string_new_from_c_str(transfer_ctx->cp_app_ctx->app_ctx->allocator, "Failed");
-    }
+    int result = aws_s3_transfer_engine_add(cp_app_ctx->engine, &transfer);
+    aws_http_message_release(message);
+    return result;
+}
 
-    progress_listener_update_state(transfer_ctx->listener, state);
-    aws_string_destroy(state);
+/* create a copy object request based on the source bucket/key and destination bucket/key. */
+static int s_kick_off_copy_object_request(
+    struct cp_app_ctx *cp_app_ctx,
+    const struct aws_byte_cursor *source_bucket,
+    const struct aws_byte_cursor *source_key,
+    const struct aws_byte_cursor *destination_key) {
+    struct aws_http_message *message =
+        s_copy_object_request_new(cp_app_ctx, source_bucket, source_key, destination_key);
 
-    aws_mutex_lock(&transfer_ctx->cp_app_ctx->mutex);
-    transfer_ctx->cp_app_ctx->completed_transfers++;
-    aws_mutex_unlock(&transfer_ctx->cp_app_ctx->mutex);
-    aws_condition_variable_notify_one(&transfer_ctx->cp_app_ctx->c_var);
-    aws_s3_meta_request_release(transfer_ctx->meta_request);
-    aws_mem_release(transfer_ctx->cp_app_ctx->app_ctx->allocator, transfer_ctx);
-}
+    struct aws_byte_cursor no_file;
+    AWS_ZERO_STRUCT(no_file);
 
-static bool s_are_all_transfers_done(void *arg) {
-    struct cp_app_ctx *cp_app_ctx = arg;
-    return cp_app_ctx->expected_transfers == cp_app_ctx->completed_transfers;
+    return s_queue_transfer(cp_app_ctx, AWS_S3_META_REQUEST_TYPE_COPY_OBJECT, message, no_file, 0);
 }
 
-/* kick off a PUT request for an object from a file on disk */
+/* set up a PUT request for an object from a file on disk. The file is read at the offsets of the parts. */
 static int s_kickoff_put_object(
     struct cp_app_ctx *cp_app_ctx,
     const struct aws_byte_cursor *src_path,
     const struct aws_byte_cursor *dest_path,
     uint64_t file_size) {
-    struct single_transfer_ctx *transfer_ctx =
-        aws_mem_calloc(cp_app_ctx->app_ctx->allocator, 1, sizeof(struct single_transfer_ctx));
-    transfer_ctx->cp_app_ctx = cp_app_ctx;
 
     struct aws_byte_buf uri_path;
     struct aws_byte_cursor destination_path = *dest_path;
@@ -493,32 +415,6 @@ static int s_kickoff_put_object(
         aws_byte_cursor_advance(&full_path, 1);
     }
 
-    struct aws_byte_buf label_buf;
-    struct aws_byte_cursor operation_name_cur = aws_byte_cursor_from_c_str("upload: ");
-    aws_byte_buf_init_copy_from_cursor(&label_buf, cp_app_ctx->app_ctx->allocator, operation_name_cur);
-    aws_byte_buf_append_dynamic(&label_buf, dest_path);
-    struct aws_byte_cursor to_cur = aws_byte_cursor_from_c_str(" to s3://");
-    aws_byte_buf_append_dynamic(&label_buf, &to_cur);
-    aws_byte_buf_append_dynamic(&label_buf, &cp_app_ctx->destination_uri.authority);
-    aws_byte_buf_append_dynamic(&label_buf, &full_path);
-
-    struct aws_string *label = aws_string_new_from_buf(cp_app_ctx->app_ctx->allocator, &label_buf);
-    aws_byte_buf_clean_up(&label_buf);
-
-    struct aws_string *state = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, "In Progress");
-
-    transfer_ctx->listener = progress_listener_new(cp_app_ctx->listener_group, label, state, file_size);
-    aws_string_destroy(state);
-    aws_string_destroy(label);
-    aws_byte_buf_clean_up(&label_buf);
-
-    struct aws_s3_meta_request_options request_options = {
-        .user_data = transfer_ctx,
-        .signing_config = &cp_app_ctx->app_ctx->signing_config,
-        .type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT,
-        .finish_callback = s_put_request_finished,
-    };
-
     struct aws_http_header host_header = {
         .name = g_host_header_name,
         .value = aws_byte_cursor_from_c_str(cp_app_ctx->dest_endpoint),
@@ -533,150 +429,22 @@ static int s_kickoff_put_object(
         .value = aws_byte_cursor_from_c_str(content_length),
     };
 
-    request_options.message = aws_http_message_new_request(cp_app_ctx->app_ctx->allocator);
-    aws_http_message_add_header(request_options.message, host_header);
-    aws_http_message_add_header(request_options.message, content_length_header);
-    aws_http_message_set_request_method(request_options.message, aws_http_method_put);
-    aws_http_message_set_request_path(request_options.message, full_path);
-
-    struct aws_input_stream *body_input =
-        aws_input_stream_new_from_file(cp_app_ctx->app_ctx->allocator, (const char *)src_path->ptr);
-
-    if (!body_input) {
-        aws_mem_release(cp_app_ctx->app_ctx->allocator, transfer_ctx);
-        return AWS_OP_ERR;
-    }
-
-    struct progress_update_stream *update_stream =
-        aws_mem_calloc(cp_app_ctx->app_ctx->allocator, 1, sizeof(struct progress_update_stream));
-    update_stream->transfer = transfer_ctx;
-    update_stream->wrapped_stream = body_input;
-    update_stream->input_stream.vtable = &s_update_input_stream_vtable;
-    update_stream->input_stream.impl = update_stream;
-    update_stream->input_stream.allocator = cp_app_ctx->app_ctx->allocator;
-    aws_http_message_set_body_stream(request_options.message, &update_stream->input_stream);
-
-    transfer_ctx->meta_request = aws_s3_client_make_meta_request(cp_app_ctx->app_ctx->client, &request_options);
-
-    if (!transfer_ctx->meta_request) {
-        aws_mem_release(cp_app_ctx->app_ctx->allocator, transfer_ctx);
-        return AWS_OP_ERR;
-    }
-
-    aws_mutex_lock(&transfer_ctx->cp_app_ctx->mutex);
-    transfer_ctx->cp_app_ctx->expected_transfers++;
-    aws_mutex_unlock(&transfer_ctx->cp_app_ctx->mutex);
-
-    return AWS_OP_SUCCESS;
-}
-
-/* invoked upon walking a directory. it's invoked for each entry found in the directory. */
-static bool s_on_directory_entry(const struct aws_directory_entry *entry, void *user_data) {
-    struct cp_app_ctx *cp_app_ctx = user_data;
-
-    if (entry->file_type & AWS_FILE_TYPE_FILE) {
-        struct aws_byte_cursor escaped_dest_path = entry->relative_path;
-        aws_byte_cursor_advance(&escaped_dest_path, cp_app_ctx->source_uri.uri_str.len);
-        int ret_val = s_kickoff_put_object(cp_app_ctx, &entry->relative_path, &escaped_dest_path, entry->file_size);
-        return ret_val == AWS_OP_SUCCESS;
-    }
-
-    return true;
-}
-
-/* upon each byte downloaded, update the progress bar, and write to disk. */
-int s_get_body_callback(
-    struct aws_s3_meta_request *meta_request,
-    const struct aws_byte_cursor *body,
-    uint64_t range_start,
-    void *user_data) {
-    (void)meta_request;
-    (void)range_start;
-
-    struct single_transfer_ctx *transfer_ctx = user_data;
-
-    fwrite(body->ptr, sizeof(uint8_t), body->len, transfer_ctx->output_sink);
-    progress_listener_update_progress(transfer_ctx->listener, body->len);
-
-    return AWS_OP_SUCCESS;
-}
-
-/* Invoked when the get object request completes. */
-void s_get_request_finished(
-    struct aws_s3_meta_request *meta_request,
-    const struct aws_s3_meta_request_result *meta_request_result,
-    void *user_data) {
-    (void)meta_request;
-
-    struct single_transfer_ctx *transfer_ctx = user_data;
-
-    struct aws_string *state = NULL;
-    if (meta_request_result->error_code == AWS_ERROR_SUCCESS) {
-        state = aws_string_new_from_c_str(transfer_ctx->cp_app_ctx->app_ctx->allocator, "Completed");
-    } else {
-        state = aws_string_new_from_c_str(transfer_ctx->cp_app_ctx->app_ctx->allocator, "Failed");
-    }
-
-    progress_listener_update_state(transfer_ctx->listener, state);
-    aws_string_destroy(state);
+    struct aws_http_message *message = aws_http_message_new_request(cp_app_ctx->app_ctx->allocator);
+    aws_http_message_add_header(message, host_header);
+    aws_http_message_add_header(message, content_length_header);
+    aws_http_message_set_request_method(message, aws_http_method_put);
+    aws_http_message_set_request_path(message, full_path);
+    aws_byte_buf_clean_up(&uri_path);
 
-    fclose(transfer_ctx->output_sink);
-    aws_mutex_lock(&transfer_ctx->cp_app_ctx->mutex);
-    transfer_ctx->cp_app_ctx->completed_transfers++;
-    aws_mutex_unlock(&transfer_ctx->cp_app_ctx->mutex);
-    aws_condition_variable_notify_one(&transfer_ctx->cp_app_ctx->c_var);
-    aws_s3_meta_request_release(transfer_ctx->meta_request);
-    aws_mem_release(transfer_ctx->cp_app_ctx->app_ctx->allocator, transfer_ctx);
+    return s_queue_transfer(cp_app_ctx, AWS_S3_META_REQUEST_TYPE_PUT_OBJECT, message, *src_path, file_size);
 }
 
-/* Setup a get object request and write the file to disk as it's downloaded. */
+/* set up a get object request that writes the object to disk, each part at its offset, as it's downloaded. */
 static int s_kickoff_get_object(
     struct cp_app_ctx *cp_app_ctx,
     const struct aws_byte_cursor *key,
     const struct aws_byte_cursor *destination,
     uint64_t size) {
-    struct single_transfer_ctx *transfer_ctx =
-        aws_mem_calloc(cp_app_ctx->app_ctx->allocator, 1, sizeof(struct single_transfer_ctx));
-    transfer_ctx->cp_app_ctx = cp_app_ctx;
-
-    struct aws_byte_buf label_buf;
-    struct aws_byte_cursor operation_name_cur = aws_byte_cursor_from_c_str("download: s3://");
-    aws_byte_buf_init_copy_from_cursor(&label_buf, cp_app_ctx->app_ctx->allocator, operation_name_cur);
-    aws_byte_buf_append_dynamic(&label_buf, &cp_app_ctx->source_uri.host_name);
-    struct aws_byte_cursor slash_cur = aws_byte_cursor_from_c_str("/");
-    aws_byte_buf_append_dynamic(&label_buf, &slash_cur);
-    aws_byte_buf_append_dynamic(&label_buf, key);
-    struct aws_byte_cursor to_cur = aws_byte_cursor_from_c_str(" to ");
-    aws_byte_buf_append_dynamic(&label_buf, &to_cur);
-    aws_byte_buf_append_dynamic(&label_buf, destination);
-
-    struct aws_string *label = aws_string_new_from_buf(cp_app_ctx->app_ctx->allocator, &label_buf);
-    aws_byte_buf_clean_up(&label_buf);
-
-    struct aws_string *state = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, "In Progress");
-
-    transfer_ctx->listener = progress_listener_new(cp_app_ctx->listener_group, label, state, size);
-    aws_string_destroy(state);
-    aws_string_destroy(label);
-    aws_byte_buf_clean_up(&label_buf);
-
-    struct aws_string *file_path = aws_string_new_from_cursor(cp_app_ctx->app_ctx->allocator, destination);
-    struct aws_string *mode = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, "wb");
-    transfer_ctx->output_sink = aws_fopen_safe(file_path, mode);
-    aws_string_destroy(mode);
-    aws_string_destroy(file_path);
-
-    if (!transfer_ctx->output_sink) {
-        return AWS_OP_ERR;
-    }
-
-    struct aws_s3_meta_request_options request_options = {
-        .user_data = transfer_ctx,
-        .signing_config = &cp_app_ctx->app_ctx->signing_config,
-        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
-        .finish_callback = s_get_request_finished,
-        .body_callback = s_get_body_callback,
-    };
 
     struct aws_http_header host_header = {
         .name = g_host_header_name,
@@ -693,31 +461,39 @@ static int s_kickoff_get_object(
         .value = aws_byte_cursor_from_c_str("AWS common runtime command-line client"),
     };
 
-    request_options.message = aws_http_message_new_request(cp_app_ctx->app_ctx->allocator);
-    aws_http_message_add_header(request_options.message, host_header);
-    aws_http_message_add_header(request_options.message, accept_header);
-    aws_http_message_add_header(request_options.message, user_agent_header);
-    aws_http_message_set_request_method(request_options.message, aws_http_method_get);
+    struct aws_http_message *message = aws_http_message_new_request(cp_app_ctx->app_ctx->allocator);
+    aws_http_message_add_header(message, host_header);
+    aws_http_message_add_header(message, accept_header);
+    aws_http_message_add_header(message, user_agent_header);
+    aws_http_message_set_request_method(message, aws_http_method_get);
 
+    struct aws_byte_cursor slash_cur = aws_byte_cursor_from_c_str("/");
     struct aws_byte_buf path_buf;
     aws_byte_buf_init(&path_buf, cp_app_ctx->app_ctx->allocator, key->len + 1);
     aws_byte_buf_append_dynamic(&path_buf, &slash_cur);
     aws_byte_buf_append_dynamic(&path_buf, key);
     struct aws_byte_cursor path_cur = aws_byte_cursor_from_buf(&path_buf);
-    aws_http_message_set_request_path(request_options.message, path_cur);
+    aws_http_message_set_request_path(message, path_cur);
     aws_byte_buf_clean_up(&path_buf);
 
-    transfer_ctx->meta_request = aws_s3_client_make_meta_request(cp_app_ctx->app_ctx->client, &request_options);
+    return s_queue_transfer(cp_app_ctx, AWS_S3_META_REQUEST_TYPE_GET_OBJECT, message, *destination, size);
+}
 
-    if (!transfer_ctx->meta_request) {
-        return AWS_OP_ERR;
-    }
+/* invoked upon walking a directory. it's invoked for each entry found in the directory. The walk waits for the engine
+ * to have room, so that no more than a bounded number of files are queued at once. */
+static bool s_on_directory_entry(const struct aws_directory_entry *entry, void *user_data) {
+    struct cp_app_ctx *cp_app_ctx = user_data;
+
+    if (entry->file_type & AWS_FILE_TYPE_FILE) {
+        aws_s3_transfer_engine_wait_for_room(cp_app_ctx->engine);
 
-    aws_mutex_lock(&transfer_ctx->cp_app_ctx->mutex);
-    transfer_ctx->cp_app_ctx->expected_transfers++;
-    aws_mutex_unlock(&transfer_ctx->cp_app_ctx->mutex);
+        struct aws_byte_cursor escaped_dest_path = entry->relative_path;
+        aws_byte_cursor_advance(&escaped_dest_path, cp_app_ctx->source_uri.uri_str.len);
+        int ret_val = s_kickoff_put_object(cp_app_ctx, &entry->relative_path, &escaped_dest_path, entry->file_size);
+        return ret_val == AWS_OP_SUCCESS;
+    }
 
-    return AWS_OP_SUCCESS;
+    return true;
 }
 
 /* upon listing the objects in a bucket, this is invoked for each object encountered. */
@@ -800,28 +576,54 @@ static bool s_on_list_object(const struct aws_s3_object_info *info, void *user_d
     return true;
 }
 
-static bool s_are_all_transfers_and_listings_done(void *arg) {
-    struct cp_app_ctx *cp_app_ctx = arg;
-    return cp_app_ctx->expected_transfers == cp_app_ctx->completed_transfers && cp_app_ctx->list_objects_completed;
+/* invoked once the engine has room for the next page of the listing. */
+static void s_on_room_for_listing(struct aws_s3_transfer_engine *engine, void *user_data) {
+    struct cp_app_ctx *cp_app_ctx = user_data;
+
+    if (aws_s3_paginator_continue(cp_app_ctx->paginator, &cp_app_ctx->app_ctx->signing_config)) {
+        fprintf(stderr, "List objects failed with error %s\n", aws_error_debug_str(aws_last_error()));
+        aws_s3_transfer_engine_end_input(engine);
+    }
 }
 
+/* each page of the listing is only asked for once the engine has room for it, so that transfers don't pile up in
+ * memory when listing is faster than transferring. */
 void s_on_object_list_finished(struct aws_s3_paginator *paginator, int error_code, void *user_data) {
-    (void)error_code;
-
     struct cp_app_ctx *cp_app_ctx = user_data;
 
-    if (aws_s3_paginator_has_more_results(paginator)) {
-        aws_s3_paginator_continue(paginator, &cp_app_ctx->app_ctx->signing_config);
+    if (error_code == AWS_ERROR_SUCCESS && aws_s3_paginator_has_more_results(paginator)) {
+        aws_s3_transfer_engine_on_room(cp_app_ctx->engine, s_on_room_for_listing, cp_app_ctx);
     } else {
-        aws_mutex_lock(&cp_app_ctx->mutex);
-        cp_app_ctx->list_objects_completed = true;
-        aws_mutex_unlock(&cp_app_ctx->mutex);
+        if (error_code != AWS_ERROR_SUCCESS) {
+            fprintf(stderr, "List objects failed with error %s\n", aws_error_debug_str(error_code));
+        }
+
+        aws_s3_transfer_engine_end_input(cp_app_ctx->engine);
     }
 }
 
-void s_dispatch_and_run_transfers(struct cp_app_ctx *cp_app_ctx) {
+static void s_dispatch_and_run_transfers(struct cp_app_ctx *cp_app_ctx) {
+
+    struct aws_s3_transfer_engine_options engine_options = {
+        .client = cp_app_ctx->app_ctx->client,
+        .signing_config = &cp_app_ctx->app_ctx->signing_config,
+        .transfer_finish_callback = s_on_transfer_finished,
+        .finish_callback = s_on_transfers_finished,
+        .user_data = cp_app_ctx,
+    };
+
+    cp_app_ctx->engine = aws_s3_transfer_engine_new(cp_app_ctx->app_ctx->allocator, &engine_options);
 
-    struct aws_s3_paginator *paginator = NULL;
+    if (!cp_app_ctx->engine) {
+        fprintf(stderr, "Transfer engine failed with error %s\n", aws_error_debug_str(aws_last_error()));
+        exit(1);
+    }
+
+    struct aws_string *label = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, "transfers");
+    struct aws_string *state = aws_string_new_from_c_str(cp_app_ctx->app_ctx->allocator, "In Progress");
+    cp_app_ctx->listener = progress_listener_new(cp_app_ctx->listener_group, label, state, 0);
+    aws_string_destroy(state);
+    aws_string_destroy(label);
 
     /* the source argument is either a directory on disk or s3 (it's not actually possible to tell a prefix from an
      * object) */
@@ -838,10 +640,7 @@ void s_dispatch_and_run_transfers(struct cp_app_ctx *cp_app_ctx) {
             }
 
             aws_string_destroy(path);
-            aws_mutex_lock(&cp_app_ctx->mutex);
-            aws_condition_variable_wait_pred(
-                &cp_app_ctx->c_var, &cp_app_ctx->mutex, s_are_all_transfers_done, cp_app_ctx);
-            aws_mutex_unlock(&cp_app_ctx->mutex);
+            aws_s3_transfer_engine_end_input(cp_app_ctx->engine);
 
             /* due to trickery in list_objects, this handles the source is s3 key instead of just a prefix, so we
              * don't need to handle that later.*/
@@ -863,20 +662,13 @@ void s_dispatch_and_run_transfers(struct cp_app_ctx *cp_app_ctx) {
                 .on_list_finished = s_on_object_list_finished,
             };
 
-            paginator = aws_s3_initiate_list_objects(cp_app_ctx->app_ctx->allocator, &list_objects_params);
+            cp_app_ctx->paginator = aws_s3_initiate_list_objects(cp_app_ctx->app_ctx->allocator, &list_objects_params);
 
-            if (!paginator) {
+            if (!cp_app_ctx->paginator) {
                 fprintf(stderr, "List objects failed with error %s\n", aws_error_debug_str(aws_last_error()));
                 s_usage(1);
             }
-            aws_s3_paginator_continue(paginator, &cp_app_ctx->app_ctx->signing_config);
-
-            aws_mutex_lock(&cp_app_ctx->mutex);
-            aws_condition_variable_wait_pred(
-                &cp_app_ctx->c_var, &cp_app_ctx->mutex, s_are_all_transfers_and_listings_done, cp_app_ctx);
-            aws_mutex_unlock(&cp_app_ctx->mutex);
-
-            aws_s3_paginator_release(paginator);
+            aws_s3_paginator_continue(cp_app_ctx->paginator, &cp_app_ctx->app_ctx->signing_config);
         }
     } else {
         /* only handles a single file from disk being uploaded to s3. */
@@ -912,11 +704,32 @@ void s_dispatch_and_run_transfers(struct cp_app_ctx *cp_app_ctx) {
                 fprintf(stderr, "File transfer failed with error %s\n", aws_error_debug_str(aws_last_error()));
                 s_usage(1);
             }
-
-            aws_mutex_lock(&cp_app_ctx->mutex);
-            aws_condition_variable_wait_pred(
-                &cp_app_ctx->c_var, &cp_app_ctx->mutex, s_are_all_transfers_done, cp_app_ctx);
-            aws_mutex_unlock(&cp_app_ctx->mutex);
         }
+
+        aws_s3_transfer_engine_end_input(cp_app_ctx->engine);
     }
+
+    aws_mutex_lock(&cp_app_ctx->mutex);
+    aws_condition_variable_wait_pred(&cp_app_ctx->c_var, &cp_app_ctx->mutex, s_are_all_transfers_done, cp_app_ctx);
+    aws_mutex_unlock(&cp_app_ctx->mutex);
+
+    struct aws_s3_transfer_engine_stats stats;
+    aws_s3_transfer_engine_get_stats(cp_app_ctx->engine, &stats);
+
+    fprintf(
+        stdout,
+        "%" PRIu64 " transfers succeeded, %" PRIu64 " failed, %" PRIu64 " bytes in %" PRIu64 " ms (%" PRIu64
+        " MB/s)\n",
+        stats.num_transfers_succeeded,
+        stats.num_transfers_failed,
+        stats.num_bytes_transferred,
+        aws_timestamp_convert(stats.elapsed_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL),
+        stats.bytes_per_second / (1024 * 1024));
+
+    if (cp_app_ctx->error_code != AWS_ERROR_SUCCESS) {
+        fprintf(stderr, "First failure: %s\n", aws_error_debug_str(cp_app_ctx->error_code));
+    }
+
+    aws_s3_paginator_release(cp_app_ctx->paginator);
+    aws_s3_transfer_engine_release(cp_app_ctx->engine);
 }
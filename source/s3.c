@@ -8,6 +8,7 @@
 #include <aws/auth/auth.h>
 #include <aws/common/error.h>
 #include <aws/common/hash_table.h>
+#include <aws/common/string.h>
 #include <aws/http/http.h>
 
 #define AWS_DEFINE_ERROR_INFO_S3(CODE, STR) AWS_DEFINE_ERROR_INFO(CODE, STR, "aws-c-s3")
@@ -28,6 +29,13 @@ static struct aws_error_info s_errors[] = {
     AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_CANCELED, "Request successfully cancelled"),
     AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_INVALID_RANGE_HEADER, "Range header has invalid syntax"),
     AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_MULTIRANGE_HEADER_UNSUPPORTED, "Range header specifies multiple ranges which is unsupported"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_INCORRECT_CONTENT_LENGTH, "Request body is shorter than its Content-Length header says"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_MAX_NUM_PARTS_EXCEEDED, "Request body needs more parts than a multipart upload can have"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_PAUSED, "Request successfully paused"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_INVALID_RESUME_TOKEN, "Resume token is invalid, or does not match the request"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_RESPONSE_CHECKSUM_MISMATCH, "Response body does not match the checksum S3 sent with it"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_RECV_FILE_FAILED, "Response body could not be written to the file it is received into"),
+    AWS_DEFINE_ERROR_INFO_S3(AWS_ERROR_S3_OBJECT_MODIFIED, "Object was modified while it was being downloaded"),
 };
 /* clang-format on */
 
@@ -56,14 +64,25 @@ static struct aws_log_subject_info_list s_s3_log_subject_list = {
     .count = AWS_ARRAY_SIZE(s_s3_log_subject_infos),
 };
 
-/**** Configuration info for the c5n.18xlarge *****/
-static struct aws_byte_cursor s_c5n_18xlarge_nic_array[] = {AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("eth0")};
+/**** Configuration info of known instance types *****/
+static struct aws_byte_cursor s_eth0_nic_array[] = {AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("eth0")};
+static struct aws_byte_cursor s_eth1_nic_array[] = {AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("eth1")};
 
-static struct aws_s3_cpu_group_info s_c5n_18xlarge_cpu_group_info_array[] = {
+/* A single CPU group, with the network device. */
+static struct aws_s3_cpu_group_info s_one_cpu_group_info_array[] = {
     {
         .cpu_group = 0u,
-        .nic_name_array = s_c5n_18xlarge_nic_array,
-        .nic_name_array_length = AWS_ARRAY_SIZE(s_c5n_18xlarge_nic_array),
+        .nic_name_array = s_eth0_nic_array,
+        .nic_name_array_length = AWS_ARRAY_SIZE(s_eth0_nic_array),
+    },
+};
+
+/* Two CPU groups, with the network device attached to the first one. */
+static struct aws_s3_cpu_group_info s_two_cpu_groups_nic_on_first_info_array[] = {
+    {
+        .cpu_group = 0u,
+        .nic_name_array = s_eth0_nic_array,
+        .nic_name_array_length = AWS_ARRAY_SIZE(s_eth0_nic_array),
     },
     {
         .cpu_group = 1u,
@@ -72,16 +91,77 @@ static struct aws_s3_cpu_group_info s_c5n_18xlarge_cpu_group_info_array[] = {
     },
 };
 
-static struct aws_s3_compute_platform_info s_c5n_18xlarge_platform_info = {
-    .instance_type = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("c5n.18xlarge"),
-    .max_throughput_gbps = 100u,
-    .cpu_group_info_array = s_c5n_18xlarge_cpu_group_info_array,
-    .cpu_group_info_array_length = AWS_ARRAY_SIZE(s_c5n_18xlarge_cpu_group_info_array),
+/* Two CPU groups, each with a network card of its own. */
+static struct aws_s3_cpu_group_info s_two_cpu_groups_nic_on_each_info_array[] = {
+    {
+        .cpu_group = 0u,
+        .nic_name_array = s_eth0_nic_array,
+        .nic_name_array_length = AWS_ARRAY_SIZE(s_eth0_nic_array),
+    },
+    {
+        .cpu_group = 1u,
+        .nic_name_array = s_eth1_nic_array,
+        .nic_name_array_length = AWS_ARRAY_SIZE(s_eth1_nic_array),
+    },
+};
+
+#define AWS_S3_PLATFORM_INFO(INSTANCE_TYPE, MAX_THROUGHPUT_GBPS, CPU_GROUP_INFO_ARRAY)                                 \
+    {                                                                                                                  \
+        .instance_type = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL(INSTANCE_TYPE),                                         \
+        .max_throughput_gbps = (MAX_THROUGHPUT_GBPS),                                                                  \
+        .cpu_group_info_array = (CPU_GROUP_INFO_ARRAY),                                                                \
+        .cpu_group_info_array_length = AWS_ARRAY_SIZE(CPU_GROUP_INFO_ARRAY),                                           \
+    }
+
+/* Network bandwidth (as advertised for the instance type) and NUMA layout of the instance types that are worth tuning
+ * the client for. Instance types with 25 Gbps or less do fine with the defaults. */
+static struct aws_s3_compute_platform_info s_compute_platform_info_array[] = {
+    /* Compute optimized */
+    AWS_S3_PLATFORM_INFO("c5n.9xlarge", 50u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c5n.18xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("c5n.metal", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("c6gn.8xlarge", 50u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c6gn.16xlarge", 100u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c6gn.metal", 100u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c6i.32xlarge", 50u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("c6in.16xlarge", 100u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c6in.32xlarge", 200u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("c6in.metal", 200u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("c7gn.8xlarge", 100u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c7gn.16xlarge", 200u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c7gn.metal", 200u, s_one_cpu_group_info_array),
+    AWS_S3_PLATFORM_INFO("c7i.48xlarge", 50u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("hpc6a.48xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+
+    /* General purpose and memory optimized */
+    AWS_S3_PLATFORM_INFO("m5n.24xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("m5dn.24xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("m6in.32xlarge", 200u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("m6idn.32xlarge", 200u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("r5n.24xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("r5dn.24xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("r6in.32xlarge", 200u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("r6idn.32xlarge", 200u, s_two_cpu_groups_nic_on_each_info_array),
+
+    /* Accelerated computing */
+    AWS_S3_PLATFORM_INFO("p3dn.24xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("p4d.24xlarge", 400u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("p4de.24xlarge", 400u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("g4dn.metal", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("g5.48xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("dl1.24xlarge", 400u, s_two_cpu_groups_nic_on_each_info_array),
+    AWS_S3_PLATFORM_INFO("inf2.48xlarge", 100u, s_two_cpu_groups_nic_on_first_info_array),
+    AWS_S3_PLATFORM_INFO("trn1.32xlarge", 800u, s_two_cpu_groups_nic_on_each_info_array),
 };
-/****** End c5n.18xlarge *****/
+/****** End of known instance types *****/
 
 static struct aws_hash_table s_compute_platform_info_table;
 
+/* Nitro instances report Amazon EC2 as their system vendor, and their instance type as their product name. */
+static const char *s_dmi_sys_vendor_path = "/sys/devices/virtual/dmi/id/sys_vendor";
+static const char *s_dmi_product_name_path = "/sys/devices/virtual/dmi/id/product_name";
+static const struct aws_byte_cursor s_ec2_sys_vendor = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Amazon EC2");
+
 static bool s_library_initialized = false;
 static struct aws_allocator *s_library_allocator = NULL;
 
@@ -106,20 +186,20 @@ void aws_s3_library_init(struct aws_allocator *allocator) {
         !aws_hash_table_init(
             &s_compute_platform_info_table,
             allocator,
-            32,
+            AWS_ARRAY_SIZE(s_compute_platform_info_array),
             aws_hash_byte_cursor_ptr_ignore_case,
             (bool (*)(const void *, const void *))aws_byte_cursor_eq_ignore_case,
             NULL,
             NULL) &&
         "Hash table init failed!");
 
-    AWS_FATAL_ASSERT(
-        !aws_hash_table_put(
-            &s_compute_platform_info_table,
-            &s_c5n_18xlarge_platform_info.instance_type,
-            &s_c5n_18xlarge_platform_info,
-            NULL) &&
-        "hash table put failed!");
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_compute_platform_info_array); ++i) {
+        struct aws_s3_compute_platform_info *platform_info = &s_compute_platform_info_array[i];
+
+        AWS_FATAL_ASSERT(
+            !aws_hash_table_put(&s_compute_platform_info_table, &platform_info->instance_type, platform_info, NULL) &&
+            "hash table put failed!");
+    }
 
     s_library_initialized = true;
 }
@@ -164,3 +244,64 @@ struct aws_s3_compute_platform_info *aws_s3_get_compute_platform_info_for_instan
         AWS_BYTE_CURSOR_PRI(instance_type_name));
     return NULL;
 }
+
+static bool s_is_dmi_whitespace(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/* Reads a DMI attribute, without the trailing new line. */
+static int s_read_dmi_attribute(struct aws_allocator *allocator, const char *path, struct aws_byte_buf *out_value) {
+    if (aws_byte_buf_init_from_file(out_value, allocator, path)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor value = aws_byte_cursor_from_buf(out_value);
+    value = aws_byte_cursor_trim_pred(&value, s_is_dmi_whitespace);
+
+    /* Move what is left to the start of the buffer, so that the caller can use the buffer as is. */
+    memmove(out_value->buffer, value.ptr, value.len);
+    out_value->len = value.len;
+    return AWS_OP_SUCCESS;
+}
+
+struct aws_string *aws_s3_detect_instance_type(struct aws_allocator *allocator) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_string *instance_type = NULL;
+    struct aws_byte_buf sys_vendor;
+    struct aws_byte_buf product_name;
+    AWS_ZERO_STRUCT(sys_vendor);
+    AWS_ZERO_STRUCT(product_name);
+
+    if (s_read_dmi_attribute(allocator, s_dmi_sys_vendor_path, &sys_vendor) ||
+        s_read_dmi_attribute(allocator, s_dmi_product_name_path, &product_name)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_GENERAL, "static: could not read the DMI attributes of the machine to detect its instance type");
+        aws_reset_error();
+        aws_raise_error(AWS_ERROR_PLATFORM_NOT_SUPPORTED);
+        goto clean_up;
+    }
+
+    struct aws_byte_cursor sys_vendor_cursor = aws_byte_cursor_from_buf(&sys_vendor);
+    struct aws_byte_cursor product_name_cursor = aws_byte_cursor_from_buf(&product_name);
+
+    if (!aws_byte_cursor_eq(&sys_vendor_cursor, &s_ec2_sys_vendor) || product_name_cursor.len == 0) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_GENERAL,
+            "static: machine is not an EC2 Nitro instance (system vendor " PRInSTR ", product name " PRInSTR ")",
+            AWS_BYTE_CURSOR_PRI(sys_vendor_cursor),
+            AWS_BYTE_CURSOR_PRI(product_name_cursor));
+        aws_raise_error(AWS_ERROR_PLATFORM_NOT_SUPPORTED);
+        goto clean_up;
+    }
+
+    instance_type = aws_string_new_from_cursor(allocator, &product_name_cursor);
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_GENERAL, "static: detected instance type " PRInSTR, AWS_BYTE_CURSOR_PRI(product_name_cursor));
+
+clean_up:
+    aws_byte_buf_clean_up(&sys_vendor);
+    aws_byte_buf_clean_up(&product_name);
+    return instance_type;
+}
@@ -4,10 +4,14 @@
  */
 
 #include "aws/s3/private/s3_auto_ranged_get.h"
+#include "aws/s3/private/s3_block_cache.h"
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_recv_file.h"
 #include "aws/s3/private/s3_request_messages.h"
 #include "aws/s3/private/s3_util.h"
+#include <aws/common/clock.h>
+#include <aws/common/math.h>
 #include <aws/common/string.h>
 #include <inttypes.h>
 
@@ -17,6 +21,34 @@
 #endif
 
 const uint32_t s_conservative_max_requests_in_flight = 8;
+
+/* When part hedging is enabled, a part is requested a second time once it has been on a connection this many times
+ * longer than the median part latency... */
+static const uint64_t s_hedge_latency_multiplier = 3;
+
+/* ...or once it has held up delivery of parts that arrived after it for this many times the median part latency (but
+ * never less than s_hedge_min_head_of_line_ns)... */
+static const uint64_t s_hedge_head_of_line_latency_multiplier = 2;
+static const uint64_t s_hedge_min_head_of_line_ns = 100000000ULL;
+
+/* ...with the median only being trusted once it is based on this many parts. */
+static const uint32_t s_hedge_min_latency_samples = 4;
+
+/* Max number of hedge requests that a meta request can have in flight at once. */
+static const uint32_t s_hedge_max_in_flight = 4;
+
+/* When variable part sizes are enabled, the first part is at most this big, so that the first bytes come back fast... */
+static const uint64_t s_variable_first_part_size = 1024 * 1024;
+
+/* ...parts after it double in size every this many parts... */
+static const uint32_t s_variable_num_parts_per_step = 8;
+
+/* ...and never grow beyond this multiple of the part size, which bounds the memory tied up in a single part. */
+static const uint64_t s_variable_max_part_size_multiplier = 8;
+
+/* Most parts requested before the object size is known, when that is only asked for with an object size hint. */
+static const uint32_t s_max_speculative_parts_for_size_hint = 8;
+
 const struct aws_byte_cursor g_application_xml_value = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("application/xml");
 const struct aws_byte_cursor g_object_size_value = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ActualObjectSize");
 
@@ -31,6 +63,8 @@ static int s_s3_auto_ranged_get_prepare_request(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request);
 
+static void s_s3_auto_ranged_get_request_sent(struct aws_s3_meta_request *meta_request, struct aws_s3_request *request);
+
 static void s_s3_auto_ranged_get_request_finished(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request,
@@ -42,6 +76,7 @@ static struct aws_s3_meta_request_vtable s_s3_auto_ranged_get_vtable = {
     .prepare_request = s_s3_auto_ranged_get_prepare_request,
     .init_signing_date_time = aws_s3_meta_request_init_signing_date_time_default,
     .sign_request = aws_s3_meta_request_sign_request_default,
+    .request_sent = s_s3_auto_ranged_get_request_sent,
     .finished_request = s_s3_auto_ranged_get_request_finished,
     .destroy = s_s3_meta_request_auto_ranged_get_destroy,
     .finish = aws_s3_meta_request_finish_default,
@@ -60,6 +95,76 @@ static int s_s3_auto_ranged_get_success_status(struct aws_s3_meta_request *meta_
     return AWS_S3_RESPONSE_STATUS_SUCCESS;
 }
 
+/* Work out whether the range of the initial message's Range header can be resolved without knowing the size of the
+ * object. Ranges that can't be, such as suffixes longer than a part, or ranges that don't parse, are left to a HEAD
+ * request to turn into a Content-Range. */
+static void s_s3_auto_ranged_get_parse_initial_range(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    struct aws_http_headers *headers) {
+
+    bool has_start_range = false;
+    bool has_end_range = false;
+    uint64_t start_range = 0;
+    uint64_t end_range = 0;
+
+    if (aws_s3_parse_request_range_header(headers, &has_start_range, &has_end_range, &start_range, &end_range)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Could not parse Range header (error %d), using a HEAD request to resolve it.",
+            (void *)&auto_ranged_get->base,
+            aws_last_error());
+        return;
+    }
+
+    if (!has_start_range) {
+        if (end_range > auto_ranged_get->base.part_size) {
+            return;
+        }
+
+        auto_ranged_get->initial_range_is_suffix = true;
+    } else {
+        auto_ranged_get->initial_range_start = start_range;
+        auto_ranged_get->initial_range_end = has_end_range ? end_range : UINT64_MAX;
+    }
+
+    auto_ranged_get->initial_range_parsed = true;
+}
+
+/* Copy the checkpoint of an earlier download. */
+static int s_s3_auto_ranged_get_init_checkpoint(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    const struct aws_s3_get_object_checkpoint *checkpoint) {
+
+    struct aws_allocator *allocator = auto_ranged_get->base.allocator;
+    struct aws_array_list *completed_ranges = &auto_ranged_get->completed_ranges;
+
+    for (size_t i = 0; i < checkpoint->num_completed_ranges; ++i) {
+        const struct aws_s3_byte_range *range = &checkpoint->completed_ranges[i];
+
+        if (range->start > range->end) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p Completed range %" PRIu64 "-%" PRIu64 " of checkpoint is invalid.",
+                (void *)&auto_ranged_get->base,
+                range->start,
+                range->end);
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (aws_array_list_push_back(completed_ranges, range)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    aws_s3_merge_byte_ranges(completed_ranges);
+
+    if (checkpoint->etag.len > 0) {
+        auto_ranged_get->synced_data.etag = aws_string_new_from_cursor(allocator, &checkpoint->etag);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 /* Allocate a new auto-ranged-get meta request. */
 struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_get_new(
     struct aws_allocator *allocator,
@@ -71,6 +176,16 @@ struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_get_new(
     AWS_PRECONDITION(options);
     AWS_PRECONDITION(options->message);
 
+    /* A part that is streamed to the caller as it arrives can't be taken over by a hedge request half way through. */
+    if (options->enable_part_hedging && options->enable_direct_body_streaming) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "Could not create Auto-Ranged-Get Meta Request; part hedging cannot be combined with direct body "
+            "streaming.");
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
     struct aws_s3_auto_ranged_get *auto_ranged_get =
         aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_auto_ranged_get));
 
@@ -97,6 +212,90 @@ struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_get_new(
 
     auto_ranged_get->initial_message_has_range_header = aws_http_headers_has(headers, g_range_header_name);
 
+    if (auto_ranged_get->initial_message_has_range_header) {
+        s_s3_auto_ranged_get_parse_initial_range(auto_ranged_get, headers);
+    }
+
+    if (options->enable_part_hedging) {
+        if (aws_array_list_init_dynamic(
+                &auto_ranged_get->synced_data.parts_in_flight,
+                allocator,
+                16,
+                sizeof(struct aws_s3_auto_ranged_get_part_in_flight))) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p Could not allocate part tracking for Auto-Ranged-Get Meta Request.",
+                (void *)auto_ranged_get);
+            goto error_clean_up;
+        }
+
+        auto_ranged_get->enable_part_hedging = true;
+    }
+
+    auto_ranged_get->enable_direct_body_streaming = options->enable_direct_body_streaming;
+
+    /* Bytes of the first part can be written to the file as they arrive, which is before the range of the object is
+     * known, so the start of the range has to be known up front. Only a suffix doesn't tell where it starts. */
+    if (auto_ranged_get->base.recv_file != NULL) {
+        if (auto_ranged_get->initial_range_is_suffix) {
+            auto_ranged_get->enable_direct_body_streaming = false;
+        } else if (auto_ranged_get->initial_range_parsed) {
+            aws_s3_recv_file_set_origin(auto_ranged_get->base.recv_file, auto_ranged_get->initial_range_start, 0);
+        }
+    }
+
+    /* The range of a suffix is only known once it was received, so it can't be looked up in the block cache. */
+    if (client->block_cache != NULL && !auto_ranged_get->initial_range_is_suffix) {
+        struct aws_byte_cursor host;
+        struct aws_byte_cursor path;
+
+        if (!aws_http_headers_get(headers, g_host_header_name, &host) &&
+            !aws_http_message_get_request_path(auto_ranged_get->base.initial_request_message, &path)) {
+            aws_byte_buf_init(&auto_ranged_get->cache_object_id, allocator, host.len + path.len);
+            aws_byte_buf_append(&auto_ranged_get->cache_object_id, &host);
+            aws_byte_buf_append(&auto_ranged_get->cache_object_id, &path);
+        }
+    }
+
+    if (aws_array_list_init_dynamic(
+            &auto_ranged_get->completed_ranges, allocator, 0, sizeof(struct aws_s3_byte_range))) {
+        goto error_clean_up;
+    }
+
+    if (options->get_checkpoint != NULL &&
+        s_s3_auto_ranged_get_init_checkpoint(auto_ranged_get, options->get_checkpoint)) {
+        goto error_clean_up;
+    }
+
+    if (options->enable_variable_part_size) {
+        struct aws_s3_part_size_schedule *schedule = &auto_ranged_get->synced_data.part_size_schedule;
+        schedule->first_part_size = aws_min_u64(s_variable_first_part_size, part_size);
+        schedule->part_size = part_size;
+        schedule->max_part_size = part_size;
+        schedule->num_parts_per_step = s_variable_num_parts_per_step;
+
+        auto_ranged_get->enable_variable_part_size = true;
+    }
+
+    /* Parts can only be requested before the object size is known if their ranges don't depend on it, if none of them
+     * would be held back or skipped once it is, and if they are only delivered after the first part, whose ETag they
+     * are checked against. */
+    auto_ranged_get->num_parts_before_object_range = 1;
+
+    if (!auto_ranged_get->initial_message_has_range_header && !auto_ranged_get->enable_variable_part_size &&
+        options->get_checkpoint == NULL && !client->enable_read_backpressure &&
+        auto_ranged_get->cache_object_id.len == 0 && options->delivery != AWS_S3_META_REQUEST_DELIVERY_UNORDERED) {
+        uint32_t num_parts = options->num_speculative_parts;
+
+        if (options->object_size_hint > 0) {
+            uint32_t num_hint_parts = aws_s3_get_num_parts(part_size, 0, options->object_size_hint - 1);
+
+            num_parts = aws_min_u32(num_hint_parts, num_parts > 0 ? num_parts : s_max_speculative_parts_for_size_hint);
+        }
+
+        auto_ranged_get->num_parts_before_object_range = aws_max_u32(num_parts, 1);
+    }
+
     AWS_LOGF_DEBUG(
         AWS_LS_S3_META_REQUEST, "id=%p Created new Auto-Ranged Get Meta Request.", (void *)&auto_ranged_get->base);
 
@@ -115,9 +314,314 @@ static void s_s3_meta_request_auto_ranged_get_destroy(struct aws_s3_meta_request
     AWS_PRECONDITION(meta_request->impl);
 
     struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    if (auto_ranged_get->enable_part_hedging) {
+        AWS_ASSERT(aws_array_list_length(&auto_ranged_get->synced_data.parts_in_flight) == 0);
+        aws_array_list_clean_up(&auto_ranged_get->synced_data.parts_in_flight);
+    }
+
+    aws_array_list_clean_up(&auto_ranged_get->completed_ranges);
+    aws_byte_buf_clean_up(&auto_ranged_get->cache_object_id);
+    aws_string_destroy(auto_ranged_get->synced_data.etag);
+    aws_string_destroy(auto_ranged_get->synced_data.speculative_etag);
     aws_mem_release(meta_request->allocator, auto_ranged_get);
 }
 
+/* Start keeping track of a part request, so that it can be hedged if it ends up straggling. */
+static void s_s3_auto_ranged_get_track_part_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    struct aws_s3_request *request) {
+    AWS_PRECONDITION(auto_ranged_get);
+    AWS_PRECONDITION(request);
+
+    if (!auto_ranged_get->enable_part_hedging) {
+        return;
+    }
+
+    struct aws_s3_auto_ranged_get_part_in_flight part_in_flight;
+    AWS_ZERO_STRUCT(part_in_flight);
+
+    part_in_flight.request = request;
+    part_in_flight.part_number = request->part_number;
+    part_in_flight.can_hedge = !request->discovers_object_size;
+
+    /* If this fails, the part just won't be hedged. */
+    if (aws_array_list_push_back(&auto_ranged_get->synced_data.parts_in_flight, &part_in_flight)) {
+        AWS_LOGF_WARN(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Could not track part %d for hedging.",
+            (void *)&auto_ranged_get->base,
+            request->part_number);
+    }
+}
+
+/* Start the latency clock of a tracked part once its first request is on a connection. Retries keep the time of the
+ * first send. */
+static void s_s3_auto_ranged_get_request_sent(struct aws_s3_meta_request *meta_request, struct aws_s3_request *request) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    if (!auto_ranged_get->enable_part_hedging || request->request_tag != AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART) {
+        return;
+    }
+
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    for (size_t i = 0; i < aws_array_list_length(&auto_ranged_get->synced_data.parts_in_flight); ++i) {
+        struct aws_s3_auto_ranged_get_part_in_flight *part_in_flight = NULL;
+        aws_array_list_get_at_ptr(&auto_ranged_get->synced_data.parts_in_flight, (void **)&part_in_flight, i);
+
+        if (part_in_flight->request == request) {
+            if (part_in_flight->start_timestamp_ns == 0) {
+                part_in_flight->start_timestamp_ns = now_ns;
+            }
+            break;
+        }
+    }
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+}
+
+/* Returns the median latency of recently delivered parts, or 0 if too few parts have been delivered to tell. */
+static uint64_t s_s3_auto_ranged_get_median_part_latency_synced(struct aws_s3_auto_ranged_get *auto_ranged_get) {
+    AWS_PRECONDITION(auto_ranged_get);
+
+    const uint32_t num_samples = auto_ranged_get->synced_data.num_part_latency_samples;
+
+    if (num_samples < s_hedge_min_latency_samples) {
+        return 0;
+    }
+
+    uint64_t sorted_samples_ns[AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES];
+
+    for (uint32_t i = 0; i < num_samples; ++i) {
+        uint64_t sample_ns = auto_ranged_get->synced_data.part_latency_samples_ns[i];
+        uint32_t j = i;
+
+        for (; j > 0 && sorted_samples_ns[j - 1] > sample_ns; --j) {
+            sorted_samples_ns[j] = sorted_samples_ns[j - 1];
+        }
+
+        sorted_samples_ns[j] = sample_ns;
+    }
+
+    return sorted_samples_ns[num_samples / 2];
+}
+
+static void s_s3_auto_ranged_get_record_part_latency_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    uint64_t latency_ns) {
+    AWS_PRECONDITION(auto_ranged_get);
+
+    auto_ranged_get->synced_data.part_latency_samples_ns[auto_ranged_get->synced_data.next_part_latency_sample] =
+        latency_ns;
+
+    auto_ranged_get->synced_data.next_part_latency_sample =
+        (auto_ranged_get->synced_data.next_part_latency_sample + 1) % AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES;
+
+    if (auto_ranged_get->synced_data.num_part_latency_samples < AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES) {
+        ++auto_ranged_get->synced_data.num_part_latency_samples;
+    }
+}
+
+/* If a part is straggling, create a duplicate request for it. Returns NULL if no part needs to be hedged. */
+static struct aws_s3_request *s_s3_auto_ranged_get_hedge_straggler_synced(struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(meta_request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    if (!auto_ranged_get->enable_part_hedging ||
+        auto_ranged_get->synced_data.num_hedges_in_flight >= s_hedge_max_in_flight) {
+        return NULL;
+    }
+
+    const size_t num_parts_in_flight = aws_array_list_length(&auto_ranged_get->synced_data.parts_in_flight);
+
+    if (num_parts_in_flight == 0) {
+        return NULL;
+    }
+
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    /* Without a median, there is no telling how long a part should take, so nothing is hedged yet. */
+    const uint64_t median_latency_ns = s_s3_auto_ranged_get_median_part_latency_synced(auto_ranged_get);
+
+    if (median_latency_ns == 0) {
+        return NULL;
+    }
+
+    uint64_t max_head_of_line_ns = median_latency_ns * s_hedge_head_of_line_latency_multiplier;
+
+    if (max_head_of_line_ns < s_hedge_min_head_of_line_ns) {
+        max_head_of_line_ns = s_hedge_min_head_of_line_ns;
+    }
+
+    for (size_t i = 0; i < num_parts_in_flight; ++i) {
+        struct aws_s3_auto_ranged_get_part_in_flight *part_in_flight = NULL;
+        aws_array_list_get_at_ptr(&auto_ranged_get->synced_data.parts_in_flight, (void **)&part_in_flight, i);
+
+        /* A part that is still waiting to be prepared or for a connection isn't slow, the client is busy, and a hedge
+         * of it would only wait behind it. */
+        if (!part_in_flight->can_hedge || part_in_flight->hedged || part_in_flight->delivered ||
+            part_in_flight->request == NULL || part_in_flight->start_timestamp_ns == 0) {
+            continue;
+        }
+
+        const uint64_t age_ns =
+            now_ns > part_in_flight->start_timestamp_ns ? now_ns - part_in_flight->start_timestamp_ns : 0;
+
+        const bool straggling = age_ns > median_latency_ns * s_hedge_latency_multiplier;
+
+        const bool holding_up_delivery =
+            part_in_flight->part_number == auto_ranged_get->synced_data.head_of_line_part_number &&
+            now_ns > auto_ranged_get->synced_data.head_of_line_timestamp_ns &&
+            now_ns - auto_ranged_get->synced_data.head_of_line_timestamp_ns > max_head_of_line_ns;
+
+        if (!straggling && !holding_up_delivery) {
+            continue;
+        }
+
+        struct aws_s3_request *request = aws_s3_request_new(
+            meta_request,
+            AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART,
+            part_in_flight->part_number,
+            AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY);
+
+        request->part_range_start = part_in_flight->request->part_range_start;
+        request->part_range_end = part_in_flight->request->part_range_end;
+
+        part_in_flight->hedge_request = request;
+        part_in_flight->hedged = true;
+        ++auto_ranged_get->synced_data.num_hedges_in_flight;
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Hedging part %d, which has been in flight for %" PRIu64 " ns (median part latency is %" PRIu64
+            " ns).",
+            (void *)meta_request,
+            part_in_flight->part_number,
+            age_ns,
+            median_latency_ns);
+
+        return request;
+    }
+
+    return NULL;
+}
+
+/* Update the hedging state of a part when one of its requests finishes. Returns true if the response of this request
+ * should be delivered to the caller. *out_part_completed is set to true once none of the part's requests are in
+ * flight anymore, and *out_part_successful to whether one of them was delivered. */
+static bool s_s3_auto_ranged_get_part_request_finished_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    struct aws_s3_request *request,
+    bool request_failed,
+    bool *out_part_completed,
+    bool *out_part_successful) {
+    AWS_PRECONDITION(auto_ranged_get);
+    AWS_PRECONDITION(request);
+    AWS_PRECONDITION(out_part_completed);
+    AWS_PRECONDITION(out_part_successful);
+
+    *out_part_completed = true;
+    *out_part_successful = !request_failed;
+
+    if (!auto_ranged_get->enable_part_hedging) {
+        return !request_failed;
+    }
+
+    struct aws_array_list *parts_in_flight = &auto_ranged_get->synced_data.parts_in_flight;
+    struct aws_s3_auto_ranged_get_part_in_flight *part_in_flight = NULL;
+    size_t part_index = 0;
+
+    for (; part_index < aws_array_list_length(parts_in_flight); ++part_index) {
+        aws_array_list_get_at_ptr(parts_in_flight, (void **)&part_in_flight, part_index);
+
+        if (part_in_flight->request == request || part_in_flight->hedge_request == request) {
+            break;
+        }
+
+        part_in_flight = NULL;
+    }
+
+    /* The part was never tracked, so there is nothing to race against. */
+    if (part_in_flight == NULL) {
+        return !request_failed;
+    }
+
+    const bool is_hedge = part_in_flight->hedge_request == request;
+    struct aws_s3_request *other_request = is_hedge ? part_in_flight->request : part_in_flight->hedge_request;
+    const bool deliver = !request_failed && !part_in_flight->delivered;
+
+    if (deliver) {
+        part_in_flight->delivered = true;
+
+        if (other_request != NULL) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p: %s request for part %d finished first, cancelling request %p.",
+                (void *)&auto_ranged_get->base,
+                is_hedge ? "Hedge" : "Original",
+                part_in_flight->part_number,
+                (void *)other_request);
+
+            aws_s3_request_cancel(other_request);
+        }
+
+        /* Only the latency of original requests is representative of how long a part takes. */
+        uint64_t now_ns = 0;
+
+        if (!is_hedge && part_in_flight->start_timestamp_ns > 0 && !aws_high_res_clock_get_ticks(&now_ns) &&
+            now_ns > part_in_flight->start_timestamp_ns) {
+            s_s3_auto_ranged_get_record_part_latency_synced(
+                auto_ranged_get, now_ns - part_in_flight->start_timestamp_ns);
+        }
+    }
+
+    if (is_hedge) {
+        part_in_flight->hedge_request = NULL;
+
+        AWS_ASSERT(auto_ranged_get->synced_data.num_hedges_in_flight > 0);
+        --auto_ranged_get->synced_data.num_hedges_in_flight;
+    } else {
+        part_in_flight->request = NULL;
+    }
+
+    *out_part_completed = other_request == NULL;
+    *out_part_successful = part_in_flight->delivered;
+
+    if (other_request == NULL) {
+        const size_t last_index = aws_array_list_length(parts_in_flight) - 1;
+        aws_array_list_swap(parts_in_flight, part_index, last_index);
+        aws_array_list_pop_back(parts_in_flight);
+    }
+
+    return deliver;
+}
+
+/* Keep track of which part, if any, is holding up delivery of parts that already arrived. */
+static void s_s3_auto_ranged_get_update_head_of_line_synced(struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(meta_request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    if (meta_request->synced_data.pending_body_streaming_requests.size == 0) {
+        auto_ranged_get->synced_data.head_of_line_part_number = 0;
+        return;
+    }
+
+    if (auto_ranged_get->synced_data.head_of_line_part_number != meta_request->synced_data.next_streaming_part) {
+        auto_ranged_get->synced_data.head_of_line_part_number = meta_request->synced_data.next_streaming_part;
+        aws_high_res_clock_get_ticks(&auto_ranged_get->synced_data.head_of_line_timestamp_ns);
+    }
+}
+
 /* Check the finish result of meta request, in case of the request failed because of downloading an empty file */
 static bool s_check_empty_file_download_error(struct aws_s3_request *failed_request) {
     struct aws_http_headers *failed_headers = failed_request->send_data.response_headers;
@@ -143,6 +647,83 @@ static bool s_check_empty_file_download_error(struct aws_s3_request *failed_requ
     return false;
 }
 
+/* Number of parts needed for the object range, following the part size schedule if there is one. */
+static uint32_t s_s3_auto_ranged_get_num_parts_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    uint64_t object_range_start,
+    uint64_t object_range_end) {
+
+    if (auto_ranged_get->enable_variable_part_size) {
+        return aws_s3_get_num_parts_for_schedule(
+            &auto_ranged_get->synced_data.part_size_schedule, object_range_start, object_range_end);
+    }
+
+    return aws_s3_get_num_parts(auto_ranged_get->base.part_size, object_range_start, object_range_end);
+}
+
+/* Range of a part, following the part size schedule if there is one. */
+static void s_s3_auto_ranged_get_part_range_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    uint64_t object_range_start,
+    uint64_t object_range_end,
+    uint32_t part_number,
+    uint64_t *out_part_range_start,
+    uint64_t *out_part_range_end) {
+
+    if (auto_ranged_get->enable_variable_part_size) {
+        aws_s3_get_part_range_for_schedule(
+            &auto_ranged_get->synced_data.part_size_schedule,
+            object_range_start,
+            object_range_end,
+            part_number,
+            out_part_range_start,
+            out_part_range_end);
+    } else {
+        aws_s3_get_part_range(
+            object_range_start,
+            object_range_end,
+            auto_ranged_get->base.part_size,
+            part_number,
+            out_part_range_start,
+            out_part_range_end);
+    }
+}
+
+/* Once the object range is known, work out how big parts get. Growing parts cut down on the number of requests, but
+ * parts that are too big leave connections idle towards the end of the download, so parts only grow until there are
+ * just about enough of them to keep every connection the client currently allows busy. */
+static void s_s3_auto_ranged_get_plan_part_sizes_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    uint64_t object_range_start,
+    uint64_t object_range_end) {
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_get->base;
+    struct aws_s3_part_size_schedule *schedule = &auto_ranged_get->synced_data.part_size_schedule;
+    uint64_t part_size = (uint64_t)meta_request->part_size;
+    uint64_t max_part_size = part_size * s_variable_max_part_size_multiplier;
+    uint32_t num_connections = 1;
+
+    if (meta_request->client != NULL) {
+        max_part_size = aws_min_u64(max_part_size, (uint64_t)meta_request->client->max_part_size);
+        num_connections = aws_s3_client_get_max_active_connections(meta_request->client, meta_request);
+    }
+
+    if (num_connections > 0) {
+        uint64_t range_size = object_range_end - object_range_start + 1;
+        max_part_size = aws_min_u64(max_part_size, range_size / num_connections);
+    }
+
+    schedule->max_part_size = aws_max_u64(max_part_size, part_size);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_META_REQUEST,
+        "id=%p Parts grow from %" PRIu64 " to %" PRIu64 " bytes, doubling every %" PRIu32 " parts.",
+        (void *)meta_request,
+        schedule->part_size,
+        schedule->max_part_size,
+        schedule->num_parts_per_step);
+}
+
 static bool s_s3_auto_ranged_get_update(
     struct aws_s3_meta_request *meta_request,
     uint32_t flags,
@@ -160,10 +741,18 @@ static bool s_s3_auto_ranged_get_update(
      * send additional requests. */
     if (!aws_s3_meta_request_has_finish_result_synced(meta_request)) {
 
+        /* A straggling part may be holding up delivery of every part after it, so hedging it takes priority over (and
+         * isn't subject to the same limit as) requesting new parts. */
+        request = s_s3_auto_ranged_get_hedge_straggler_synced(meta_request);
+
+        if (request != NULL) {
+            goto has_work_remaining;
+        }
+
         if ((flags & AWS_S3_META_REQUEST_UPDATE_FLAG_CONSERVATIVE) != 0) {
             uint32_t num_requests_in_flight =
                 (auto_ranged_get->synced_data.num_parts_requested - auto_ranged_get->synced_data.num_parts_completed) +
-                (uint32_t)aws_priority_queue_size(&meta_request->synced_data.pending_body_streaming_requests);
+                meta_request->synced_data.pending_body_streaming_requests.size;
 
             /* auto-ranged-gets make use of body streaming, which will hold onto response bodies if parts earlier in
              * the file haven't arrived yet. This can potentially create a lot of backed up requests, causing us to
@@ -178,12 +767,12 @@ static bool s_s3_auto_ranged_get_update(
          * request to figure that out. */
         if (!auto_ranged_get->synced_data.object_range_known) {
 
-            /* If there exists a range header, we currently always do a head request first. While the range header value
-             * could be parsed client-side, doing so presents a number of complications. For example, the given range
-             * could be an unsatisfiable range, and might not even specify a complete range. To keep things simple, we
-             * are currently relying on the service to handle turning the Range header into a Content-Range response
-             * header.*/
-            bool head_object_required = auto_ranged_get->initial_message_has_range_header != 0;
+            /* If there exists a range header that couldn't be resolved client-side, then we do a head request first,
+             * relying on the service to turn the Range header into a Content-Range response header. Otherwise, the
+             * first part is requested right away, and the object range is learnt from its Content-Range. A range that
+             * turns out to be unsatisfiable fails that part the same way it would have failed the head request. */
+            bool head_object_required =
+                auto_ranged_get->initial_message_has_range_header && !auto_ranged_get->initial_range_parsed;
 
             if (head_object_required) {
                 /* If the head object request hasn't been sent yet, then send it now. */
@@ -208,10 +797,46 @@ static bool s_s3_auto_ranged_get_update(
                     1,
                     AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS | AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY);
 
-                request->part_range_start = 0;
-                request->part_range_end = meta_request->part_size - 1;
+                /* A suffix range is requested as is, and the range of the part only becomes known with the response. */
+                if (!auto_ranged_get->initial_message_has_range_header) {
+                    request->part_range_start = 0;
+                    request->part_range_end = auto_ranged_get->enable_variable_part_size
+                                                  ? auto_ranged_get->synced_data.part_size_schedule.first_part_size - 1
+                                                  : meta_request->part_size - 1;
+                } else if (!auto_ranged_get->initial_range_is_suffix) {
+                    s_s3_auto_ranged_get_part_range_synced(
+                        auto_ranged_get,
+                        auto_ranged_get->initial_range_start,
+                        auto_ranged_get->initial_range_end,
+                        1,
+                        &request->part_range_start,
+                        &request->part_range_end);
+                }
+
                 request->discovers_object_size = true;
 
+                s_s3_auto_ranged_get_track_part_synced(auto_ranged_get, request);
+
+                ++auto_ranged_get->synced_data.num_parts_requested;
+
+            } else if (
+                auto_ranged_get->synced_data.num_parts_requested < auto_ranged_get->num_parts_before_object_range) {
+                /* Request the parts after the first one as if the object was big enough to have them. The ones past
+                 * its end are dropped once S3 says so. Their responses can't be pinned to the ETag of the object yet,
+                 * so their ETag is checked instead, and they are not hedged. */
+                uint64_t part_range_start =
+                    (uint64_t)auto_ranged_get->synced_data.num_parts_requested * (uint64_t)meta_request->part_size;
+
+                request = aws_s3_request_new(
+                    meta_request,
+                    AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART,
+                    auto_ranged_get->synced_data.num_parts_requested + 1,
+                    AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS | AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY);
+
+                request->part_range_start = part_range_start;
+                request->part_range_end = part_range_start + meta_request->part_size - 1;
+                request->speculative = true;
+
                 ++auto_ranged_get->synced_data.num_parts_requested;
             }
 
@@ -222,7 +847,10 @@ static bool s_s3_auto_ranged_get_update(
         if (auto_ranged_get->synced_data.object_range_start == 0 &&
             auto_ranged_get->synced_data.object_range_end == 0) {
             if (auto_ranged_get->synced_data.get_without_range_sent) {
-                if (auto_ranged_get->synced_data.get_without_range_completed) {
+                /* Parts requested speculatively are all past the end of an empty object, but may still be in flight. */
+                if (auto_ranged_get->synced_data.get_without_range_completed &&
+                    auto_ranged_get->synced_data.num_parts_completed ==
+                        auto_ranged_get->synced_data.num_parts_requested) {
                     goto no_work_remaining;
                 } else {
                     goto has_work_remaining;
@@ -239,19 +867,54 @@ static bool s_s3_auto_ranged_get_update(
         }
 
         if (auto_ranged_get->synced_data.num_parts_requested < auto_ranged_get->synced_data.total_num_parts) {
+            uint64_t part_range_start = 0;
+            uint64_t part_range_end = 0;
+
+            /* Skip the parts that the checkpoint already covers. As total_num_parts excludes those, there is always an
+             * uncovered part after them. */
+            while (true) {
+                s_s3_auto_ranged_get_part_range_synced(
+                    auto_ranged_get,
+                    auto_ranged_get->synced_data.object_range_start,
+                    auto_ranged_get->synced_data.object_range_end,
+                    auto_ranged_get->synced_data.num_parts_requested + auto_ranged_get->synced_data.num_parts_skipped +
+                        1,
+                    &part_range_start,
+                    &part_range_end);
+
+                if (auto_ranged_get->synced_data.num_parts_skipped == auto_ranged_get->synced_data.num_parts_covered ||
+                    !aws_s3_byte_ranges_cover(&auto_ranged_get->completed_ranges, part_range_start, part_range_end)) {
+                    break;
+                }
+
+                ++auto_ranged_get->synced_data.num_parts_skipped;
+            }
+
+            /* Hold the part back until the caller has opened the read window up to it. The first part always goes
+             * out, so that there is something for the caller to consume. */
+            if (meta_request->client != NULL && meta_request->client->enable_read_backpressure &&
+                auto_ranged_get->synced_data.num_parts_requested > 0 &&
+                part_range_start - auto_ranged_get->synced_data.object_range_start >=
+                    meta_request->synced_data.read_window_running_total) {
+                goto has_work_remaining;
+            }
+
+            uint32_t request_flags = AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY;
+
+            if (auto_ranged_get->enable_direct_body_streaming) {
+                request_flags |= AWS_S3_REQUEST_FLAG_STREAM_RESPONSE_BODY_DIRECTLY;
+            }
+
             request = aws_s3_request_new(
                 meta_request,
                 AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART,
                 auto_ranged_get->synced_data.num_parts_requested + 1,
-                AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY);
+                request_flags);
 
-            aws_s3_get_part_range(
-                auto_ranged_get->synced_data.object_range_start,
-                auto_ranged_get->synced_data.object_range_end,
-                meta_request->part_size,
-                request->part_number,
-                &request->part_range_start,
-                &request->part_range_end);
+            request->part_range_start = part_range_start;
+            request->part_range_end = part_range_end;
+
+            s_s3_auto_ranged_get_track_part_synced(auto_ranged_get, request);
 
             ++auto_ranged_get->synced_data.num_parts_requested;
             goto has_work_remaining;
@@ -263,6 +926,11 @@ static bool s_s3_auto_ranged_get_update(
             goto has_work_remaining;
         }
 
+        /* Every part can have been delivered while the losing request of a hedged part is still winding down. */
+        if (auto_ranged_get->synced_data.num_parts_completed < auto_ranged_get->synced_data.num_parts_requested) {
+            goto has_work_remaining;
+        }
+
     } else {
         /* Else, if there is a finish result set, make sure that all work-in-progress winds down before the meta request
          * completely exits. */
@@ -321,6 +989,333 @@ no_work_remaining:
     return work_remaining;
 }
 
+/* Read the bytes of [range_start, range_end] that are in the block cache into out_body, which has room for all of them:
+ * the blocks in the cache from the start of the range up to the first one that isn't, and then, at their place in
+ * out_body, the blocks from the end of the range down to the last one that isn't. Only the former count towards the
+ * length of out_body. */
+static void s_s3_auto_ranged_get_read_cached_blocks(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t range_start,
+    uint64_t range_end,
+    struct aws_byte_buf *out_body,
+    uint64_t *out_num_prefix_bytes,
+    uint64_t *out_num_suffix_bytes) {
+
+    const uint64_t block_size = block_cache->block_size;
+    const uint64_t first_block_index = range_start / block_size;
+    const uint64_t last_block_index = range_end / block_size;
+
+    uint64_t block_index = first_block_index;
+
+    for (; block_index <= last_block_index; ++block_index) {
+        const uint64_t block_start = block_index * block_size;
+        const uint64_t slice_start = aws_max_u64(range_start, block_start);
+        const uint64_t slice_end = aws_min_u64(range_end, block_start + block_size - 1);
+
+        if (!aws_s3_block_cache_read_block(
+                block_cache,
+                object_id,
+                etag,
+                block_index,
+                slice_start - block_start,
+                slice_end - slice_start + 1,
+                out_body)) {
+            break;
+        }
+    }
+
+    *out_num_prefix_bytes = out_body->len;
+    *out_num_suffix_bytes = 0;
+
+    for (uint64_t suffix_block_index = last_block_index; suffix_block_index > block_index; --suffix_block_index) {
+        const uint64_t block_start = suffix_block_index * block_size;
+        const uint64_t slice_start = aws_max_u64(range_start, block_start);
+        const uint64_t slice_end = aws_min_u64(range_end, block_start + block_size - 1);
+
+        struct aws_byte_buf slice = aws_byte_buf_from_empty_array(
+            out_body->buffer + (slice_start - range_start), (size_t)(slice_end - slice_start + 1));
+
+        if (!aws_s3_block_cache_read_block(
+                block_cache, object_id, etag, suffix_block_index, slice_start - block_start, slice.capacity, &slice)) {
+            break;
+        }
+
+        *out_num_suffix_bytes += slice.len;
+    }
+}
+
+/* Look up the part of a request in the block cache. A part that is all there is served from it, without sending the
+ * request. If the request also discovers the object size, the part can't be served before knowing whether the object
+ * changed, so the request is sent with an If-None-Match header with the ETag of the cached blocks instead, to which S3
+ * answers with a 304 and no body if it didn't. (The 304 finishes the request successfully, see
+ * s_s3_meta_request_send_request_finish.) When there are only blocks at the start or the end of the part, only the
+ * bytes between them are requested. */
+static void s_s3_auto_ranged_get_read_part_from_cache(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    struct aws_byte_cursor pinned_etag) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+    struct aws_s3_block_cache *block_cache = meta_request->client->block_cache;
+    struct aws_byte_cursor object_id = aws_byte_cursor_from_buf(&auto_ranged_get->cache_object_id);
+    struct aws_http_headers *headers = aws_http_message_get_headers(request->send_data.message);
+
+    uint64_t range_start = request->part_range_start;
+    uint64_t range_end = request->part_range_end;
+    uint64_t object_size = 0;
+
+    struct aws_byte_buf cached_etag_buf;
+    aws_byte_buf_init(&cached_etag_buf, meta_request->allocator, 0);
+
+    struct aws_byte_cursor etag = pinned_etag;
+
+    if (request->discovers_object_size) {
+        /* The headers of a 304 aren't those of the object, so a caller that wants the headers always gets them from a
+         * response with the object. */
+        if (meta_request->headers_callback != NULL || aws_http_headers_has(headers, g_if_none_match_header_name) ||
+            !aws_s3_block_cache_get_object(block_cache, object_id, &cached_etag_buf, &object_size)) {
+            goto clean_up;
+        }
+
+        struct aws_byte_cursor cached_etag = aws_byte_cursor_from_buf(&cached_etag_buf);
+
+        /* Blocks of another version than the one the download is already pinned to are of no use. */
+        if ((etag.len > 0 && !aws_byte_cursor_eq(&etag, &cached_etag)) || range_start >= object_size) {
+            goto clean_up;
+        }
+
+        etag = cached_etag;
+        range_end = aws_min_u64(range_end, object_size - 1);
+    } else if (etag.len == 0) {
+        goto clean_up;
+    }
+
+    const uint64_t range_size = range_end - range_start + 1;
+
+    if (range_size > SIZE_MAX) {
+        goto clean_up;
+    }
+
+    struct aws_byte_buf *cached_body = &request->send_data.cached_response_body;
+    aws_byte_buf_init(cached_body, meta_request->allocator, (size_t)range_size);
+
+    uint64_t num_prefix_bytes = 0;
+    uint64_t num_suffix_bytes = 0;
+
+    s_s3_auto_ranged_get_read_cached_blocks(
+        block_cache, object_id, etag, range_start, range_end, cached_body, &num_prefix_bytes, &num_suffix_bytes);
+
+    if (num_prefix_bytes == range_size) {
+        if (request->discovers_object_size) {
+            aws_http_headers_set(headers, g_if_none_match_header_name, etag);
+            request->send_data.revalidating_cache = true;
+            request->send_data.cached_object_size = object_size;
+        } else {
+            request->send_data.served_from_cache = true;
+            request->send_data.response_status = AWS_S3_RESPONSE_STATUS_RANGE_SUCCESS;
+        }
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Part %d of request %p is in the block cache%s.",
+            (void *)meta_request,
+            request->part_number,
+            (void *)request,
+            request->discovers_object_size ? ", revalidating it" : "");
+
+    } else if (
+        num_prefix_bytes + num_suffix_bytes > 0 && !request->discovers_object_size &&
+        !request->stream_response_body_directly) {
+        /* ((2^64)-1 = 20 characters;  2*20 + length-of("bytes=-") < 128) */
+        char range_value_buffer[128] = "";
+        snprintf(
+            range_value_buffer,
+            sizeof(range_value_buffer),
+            "bytes=%" PRIu64 "-%" PRIu64,
+            range_start + num_prefix_bytes,
+            range_end - num_suffix_bytes);
+        aws_http_headers_set(headers, g_range_header_name, aws_byte_cursor_from_c_str(range_value_buffer));
+
+        request->send_data.num_cached_prefix_bytes = num_prefix_bytes;
+        request->send_data.num_cached_suffix_bytes = num_suffix_bytes;
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: %" PRIu64 " bytes of part %d of request %p are in the block cache, requesting %s.",
+            (void *)meta_request,
+            num_prefix_bytes + num_suffix_bytes,
+            request->part_number,
+            (void *)request,
+            range_value_buffer);
+
+    } else {
+        aws_byte_buf_clean_up(cached_body);
+    }
+
+clean_up:
+
+    aws_byte_buf_clean_up(&cached_etag_buf);
+}
+
+/* Put the bytes of a part that were read from the block cache together with the ones that were received, in the
+ * response body of the request. Returns the error code the request is to be taken as having finished with. */
+static int s_s3_auto_ranged_get_finish_cached_part(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    int error_code) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(request);
+
+    struct aws_byte_buf *cached_body = &request->send_data.cached_response_body;
+    struct aws_byte_buf *response_body = &request->send_data.response_body;
+
+    if (cached_body->capacity == 0) {
+        return error_code;
+    }
+
+    if (request->send_data.revalidating_cache) {
+        /* Anything but a 304 means the object changed, and the response has the new one, or the request failed. */
+        if (error_code != AWS_ERROR_SUCCESS ||
+            request->send_data.response_status != AWS_S3_RESPONSE_STATUS_NOT_MODIFIED) {
+            return error_code;
+        }
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Object hasn't changed, serving part %d of request %p from the block cache.",
+            (void *)meta_request,
+            request->part_number,
+            (void *)request);
+
+        request->send_data.served_from_cache = true;
+        request->send_data.response_status = AWS_S3_RESPONSE_STATUS_RANGE_SUCCESS;
+        error_code = AWS_ERROR_SUCCESS;
+
+    } else if (!request->send_data.served_from_cache) {
+        if (error_code != AWS_ERROR_SUCCESS) {
+            return error_code;
+        }
+
+        const uint64_t num_cached_bytes =
+            request->send_data.num_cached_prefix_bytes + request->send_data.num_cached_suffix_bytes;
+
+        if ((uint64_t)response_body->len + num_cached_bytes != (uint64_t)cached_body->capacity) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p: Request %p received %zu bytes of the %" PRIu64 " bytes of its part that weren't in the block "
+                "cache.",
+                (void *)meta_request,
+                (void *)request,
+                response_body->len,
+                (uint64_t)cached_body->capacity - num_cached_bytes);
+            return AWS_ERROR_S3_INCORRECT_CONTENT_LENGTH;
+        }
+
+        if (response_body->len > 0) {
+            memcpy(
+                cached_body->buffer + request->send_data.num_cached_prefix_bytes,
+                response_body->buffer,
+                response_body->len);
+        }
+
+        cached_body->len = cached_body->capacity;
+    }
+
+    struct aws_byte_buf received_body = *response_body;
+    *response_body = *cached_body;
+    *cached_body = received_body;
+
+    return error_code;
+}
+
+/* Put the blocks that the part of a request covers in whole in the block cache. */
+static void s_s3_auto_ranged_get_put_part_in_cache_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    struct aws_s3_request *request) {
+    AWS_PRECONDITION(auto_ranged_get);
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_block_cache *block_cache = auto_ranged_get->base.client->block_cache;
+    struct aws_byte_cursor object_id = aws_byte_cursor_from_buf(&auto_ranged_get->cache_object_id);
+    struct aws_byte_cursor etag = aws_byte_cursor_from_string(auto_ranged_get->synced_data.etag);
+    struct aws_byte_cursor body = aws_byte_cursor_from_buf(&request->send_data.response_body);
+
+    const uint64_t block_size = block_cache->block_size;
+    const uint64_t object_size = auto_ranged_get->synced_data.object_size;
+
+    if ((uint64_t)body.len != request->part_range_end - request->part_range_start + 1) {
+        return;
+    }
+
+    uint64_t block_index = request->part_range_start / block_size;
+
+    if (request->part_range_start % block_size != 0) {
+        ++block_index;
+    }
+
+    for (; block_index * block_size <= request->part_range_end; ++block_index) {
+        const uint64_t block_start = block_index * block_size;
+        const uint64_t block_end = aws_min_u64(block_start + block_size, object_size) - 1;
+
+        if (block_end > request->part_range_end) {
+            break;
+        }
+
+        struct aws_byte_cursor block = {
+            .ptr = body.ptr + (block_start - request->part_range_start),
+            .len = (size_t)(block_end - block_start + 1),
+        };
+
+        if (aws_s3_block_cache_put_block(block_cache, object_id, etag, object_size, block_index, block)) {
+            AWS_LOGF_WARN(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p: Could not put block %" PRIu64 " of part %d in the block cache, error %d (%s).",
+                (void *)&auto_ranged_get->base,
+                block_index,
+                request->part_number,
+                aws_last_error_or_unknown(),
+                aws_error_str(aws_last_error_or_unknown()));
+            break;
+        }
+    }
+}
+
+/* Returns true if the retry of a part can pick up where the last attempt stopped receiving its body, rather than
+ * download the part again from its start. The bytes received have to be of the part (a 206 response) and of the
+ * version of the object that the download is pinned to. Parts that find out the object size, that stream their body
+ * directly, that are checked against a checksum, or that go through the block cache all rely on the body coming from
+ * a single response, and are downloaded again in full. */
+static bool s_s3_auto_ranged_get_can_resume_part(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+    const struct aws_byte_buf *received_body = &request->send_data.response_body;
+
+    if (request->num_times_prepared == 0 || received_body->len == 0 ||
+        request->send_data.response_status != AWS_S3_RESPONSE_STATUS_RANGE_SUCCESS ||
+        request->discovers_object_size || request->stream_response_body_directly ||
+        meta_request->validate_response_checksum || auto_ranged_get->cache_object_id.len > 0) {
+        return false;
+    }
+
+    if ((uint64_t)received_body->len >= request->part_range_end - request->part_range_start + 1) {
+        return false;
+    }
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    bool pinned_to_etag = auto_ranged_get->synced_data.etag != NULL;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    return pinned_to_etag;
+}
+
 /* Given a request, prepare it for sending based on its description. */
 static int s_s3_auto_ranged_get_prepare_request(
     struct aws_s3_meta_request *meta_request,
@@ -331,6 +1326,12 @@ static int s_s3_auto_ranged_get_prepare_request(
     /* Generate a new ranged get request based on the original message. */
     struct aws_http_message *message = NULL;
 
+    /* Body that the last attempt of the request received before failing, when the retry only asks for the rest. */
+    struct aws_byte_buf resumed_body;
+    AWS_ZERO_STRUCT(resumed_body);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
     switch (request->request_tag) {
         case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_HEAD_OBJECT:
             /* A head object will be a copy of the original headers but with a HEAD request method. */
@@ -338,13 +1339,33 @@ static int s_s3_auto_ranged_get_prepare_request(
                 meta_request->allocator, meta_request->initial_request_message, NULL, 0);
             aws_http_message_set_request_method(message, g_head_method);
             break;
-        case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART:
+        case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART: {
+            if (request->discovers_object_size && auto_ranged_get->initial_range_is_suffix) {
+                message = aws_s3_message_util_copy_http_message(
+                    meta_request->allocator, meta_request->initial_request_message, NULL, 0);
+                break;
+            }
+
+            if (s_s3_auto_ranged_get_can_resume_part(meta_request, request)) {
+                resumed_body = request->send_data.response_body;
+                AWS_ZERO_STRUCT(request->send_data.response_body);
+
+                AWS_LOGF_DEBUG(
+                    AWS_LS_S3_META_REQUEST,
+                    "id=%p: Resuming part %d of request %p after the %zu bytes received by its last attempt.",
+                    (void *)meta_request,
+                    request->part_number,
+                    (void *)request,
+                    resumed_body.len);
+            }
+
             message = aws_s3_ranged_get_object_message_new(
                 meta_request->allocator,
                 meta_request->initial_request_message,
-                request->part_range_start,
+                request->part_range_start + resumed_body.len,
                 request->part_range_end);
             break;
+        }
         case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_INITIAL_MESSAGE:
             message = aws_s3_message_util_copy_http_message(
                 meta_request->allocator, meta_request->initial_request_message, NULL, 0);
@@ -360,9 +1381,49 @@ static int s_s3_auto_ranged_get_prepare_request(
         goto message_alloc_failed;
     }
 
+    struct aws_http_headers *headers = aws_http_message_get_headers(message);
+
+    /* Ask for the stored checksums, which S3 then sends with the responses whose body they cover. */
+    if (meta_request->validate_response_checksum) {
+        aws_http_headers_set(headers, g_checksum_mode_header_name, aws_byte_cursor_from_c_str("ENABLED"));
+    }
+
+    /* Pin the request to the ETag, so that parts of another version of the object can't be mixed in. An If-Match of
+     * the caller's own is left as is. */
+    struct aws_byte_buf etag_buf;
+    aws_byte_buf_init(&etag_buf, meta_request->allocator, 0);
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    if (auto_ranged_get->synced_data.etag != NULL) {
+        struct aws_byte_cursor etag = aws_byte_cursor_from_string(auto_ranged_get->synced_data.etag);
+
+        if (!aws_http_headers_has(headers, g_if_match_header_name)) {
+            aws_http_headers_set(headers, g_if_match_header_name, etag);
+        }
+
+        if (auto_ranged_get->cache_object_id.len > 0) {
+            aws_byte_buf_append_dynamic(&etag_buf, &etag);
+        }
+    }
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
     aws_s3_request_setup_send_data(request, message);
     aws_http_message_release(message);
 
+    /* The rest of the body is appended to what was already received, so that the response body ends up being that of
+     * the whole part. */
+    if (resumed_body.capacity > 0) {
+        request->send_data.response_body = resumed_body;
+    }
+
+    if (request->request_tag == AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART && auto_ranged_get->cache_object_id.len > 0) {
+        s_s3_auto_ranged_get_read_part_from_cache(meta_request, request, aws_byte_cursor_from_buf(&etag_buf));
+    }
+
+    aws_byte_buf_clean_up(&etag_buf);
+
     AWS_LOGF_DEBUG(
         AWS_LS_S3_META_REQUEST,
         "id=%p: Created request %p for part %d",
@@ -374,6 +1435,11 @@ static int s_s3_auto_ranged_get_prepare_request(
 
 message_alloc_failed:
 
+    /* Left for the next attempt, or for the request's clean up. */
+    if (resumed_body.capacity > 0) {
+        request->send_data.response_body = resumed_body;
+    }
+
     return AWS_OP_ERR;
 }
 
@@ -440,13 +1506,15 @@ static int s_discover_object_range_and_content_length(
 
             result = AWS_OP_SUCCESS;
             break;
-        case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART:
+        case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART: {
             AWS_ASSERT(request->part_number == 1);
 
+            struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
             if (error_code != AWS_ERROR_SUCCESS) {
                 /* If we hit an empty file while trying to discover the object-size via part, then this request failure
-                 * is as designed. */
-                if (s_check_empty_file_download_error(request)) {
+                 * is as designed. A range asked for by the caller can't be satisfied by an empty file though. */
+                if (!auto_ranged_get->initial_message_has_range_header && s_check_empty_file_download_error(request)) {
                     AWS_LOGF_DEBUG(
                         AWS_LS_S3_META_REQUEST,
                         "id=%p Detected empty file with request %p. Sending new request without range header.",
@@ -466,9 +1534,19 @@ static int s_discover_object_range_and_content_length(
 
             AWS_ASSERT(request->send_data.response_headers != NULL);
 
-            /* Parse the object size from the part response. */
-            if (aws_s3_parse_content_range_response_header(
-                    meta_request->allocator, request->send_data.response_headers, NULL, NULL, &total_object_size)) {
+            uint64_t part_range_start = 0;
+            uint64_t part_range_end = 0;
+
+            /* Parse the object size from the part response, unless the part was revalidated against the block cache,
+             * which knows the object size. */
+            if (request->send_data.served_from_cache) {
+                total_object_size = request->send_data.cached_object_size;
+            } else if (aws_s3_parse_content_range_response_header(
+                    meta_request->allocator,
+                    request->send_data.response_headers,
+                    &part_range_start,
+                    &part_range_end,
+                    &total_object_size)) {
 
                 AWS_LOGF_ERROR(
                     AWS_LS_S3_META_REQUEST,
@@ -479,13 +1557,25 @@ static int s_discover_object_range_and_content_length(
                 break;
             }
 
-            /* When discovering the object size via first-part, the object range is the entire object. */
-            object_range_start = 0;
-            object_range_end = total_object_size - 1;
-            total_content_length = total_object_size;
+            if (!auto_ranged_get->initial_message_has_range_header) {
+                /* When discovering the object size via first-part, the object range is the entire object. */
+                object_range_start = 0;
+                object_range_end = total_object_size - 1;
+            } else if (auto_ranged_get->initial_range_is_suffix) {
+                /* A suffix range was requested in one go, so the part's range is the whole object range. */
+                object_range_start = part_range_start;
+                object_range_end = part_range_end;
+            } else {
+                /* The requested range may reach past the end of the object. */
+                object_range_start = auto_ranged_get->initial_range_start;
+                object_range_end = aws_min_u64(auto_ranged_get->initial_range_end, total_object_size - 1);
+            }
+
+            total_content_length = object_range_end - object_range_start + 1;
 
             result = AWS_OP_SUCCESS;
             break;
+        }
         default:
             AWS_ASSERT(false);
             break;
@@ -501,6 +1591,67 @@ static int s_discover_object_range_and_content_length(
     return result;
 }
 
+/* Check the outcome of a part requested before the object size was known. Returns true if the part turned out to be
+ * past the end of the object, in which case it is dropped, without failing the meta request. Otherwise, the part has
+ * to come from the same version of the object as the first part, as it couldn't be pinned to its ETag, and
+ * *inout_error_code is set to AWS_ERROR_S3_OBJECT_MODIFIED if it doesn't. */
+static bool s_s3_auto_ranged_get_check_speculative_part_synced(
+    struct aws_s3_auto_ranged_get *auto_ranged_get,
+    struct aws_s3_request *request,
+    int *inout_error_code) {
+    AWS_PRECONDITION(auto_ranged_get);
+    AWS_PRECONDITION(request);
+    AWS_PRECONDITION(inout_error_code);
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_get->base;
+
+    if (*inout_error_code != AWS_ERROR_SUCCESS) {
+        if (request->send_data.response_status != AWS_S3_RESPONSE_STATUS_RANGE_NOT_SATISFIABLE) {
+            return false;
+        }
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Dropping speculative part %d, which is past the end of the object.",
+            (void *)meta_request,
+            request->part_number);
+
+        *inout_error_code = AWS_ERROR_SUCCESS;
+        return true;
+    }
+
+    if (auto_ranged_get->synced_data.object_range_known &&
+        request->part_number > auto_ranged_get->synced_data.total_num_parts) {
+        return true;
+    }
+
+    struct aws_byte_cursor etag;
+
+    if (request->send_data.response_headers == NULL ||
+        aws_http_headers_get(request->send_data.response_headers, g_etag_header_name, &etag)) {
+        return false;
+    }
+
+    const struct aws_string *expected_etag = auto_ranged_get->synced_data.etag != NULL
+                                                 ? auto_ranged_get->synced_data.etag
+                                                 : auto_ranged_get->synced_data.speculative_etag;
+
+    if (expected_etag == NULL) {
+        auto_ranged_get->synced_data.speculative_etag = aws_string_new_from_cursor(meta_request->allocator, &etag);
+    } else if (!aws_string_eq_byte_cursor(expected_etag, &etag)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Speculative part %d did not match the ETag of the object, which has changed since the download "
+            "started.",
+            (void *)meta_request,
+            request->part_number);
+
+        *inout_error_code = AWS_ERROR_S3_OBJECT_MODIFIED;
+    }
+
+    return false;
+}
+
 static void s_s3_auto_ranged_get_request_finished(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request,
@@ -518,8 +1669,28 @@ static void s_s3_auto_ranged_get_request_finished(
     uint64_t object_range_end = 0ULL;
 
     bool found_object_size = false;
+
+    if (request->request_tag == AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART) {
+        error_code = s_s3_auto_ranged_get_finish_cached_part(meta_request, request, error_code);
+    }
+
     bool request_failed = error_code != AWS_ERROR_SUCCESS;
 
+    if (error_code == AWS_ERROR_S3_INVALID_RESPONSE_STATUS &&
+        request->send_data.response_status == AWS_S3_RESPONSE_STATUS_PRECONDITION_FAILED) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Request %p did not match the ETag of the object, which has changed since the download started.",
+            (void *)meta_request,
+            (void *)request);
+
+        /* Whatever the block cache has of the object is out of date too. */
+        if (auto_ranged_get->cache_object_id.len > 0) {
+            aws_s3_block_cache_invalidate_object(
+                meta_request->client->block_cache, aws_byte_cursor_from_buf(&auto_ranged_get->cache_object_id));
+        }
+    }
+
     if (request->discovers_object_size) {
 
         /* Try to discover the object-range and content length.*/
@@ -542,18 +1713,36 @@ static void s_s3_auto_ranged_get_request_finished(
         error_code = AWS_ERROR_SUCCESS;
         found_object_size = true;
 
+        /* No part has been written to the file yet, apart from possibly this one, which is done being written. Space
+         * running out is left to surface from the writes themselves. */
+        if (meta_request->recv_file != NULL) {
+            aws_s3_recv_file_set_origin(meta_request->recv_file, object_range_start, total_content_length);
+        }
+
         if (meta_request->headers_callback != NULL) {
             struct aws_http_headers *response_headers = aws_http_headers_new(meta_request->allocator);
 
             copy_http_headers(request->send_data.response_headers, response_headers);
 
-            /* If this request is a part, then the content range isn't applicable. */
+            /* If this request is a part, then its content range isn't the one of the meta request. */
             if (request->request_tag == AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART) {
-                /* For now, we can assume that discovery of size via the first part of the object does not apply to
-                 * breaking up a ranged request. If it ever does, then we will need to repopulate this header. */
-                AWS_ASSERT(!auto_ranged_get->initial_message_has_range_header);
-
-                aws_http_headers_erase(response_headers, g_content_range_header_name);
+                if (auto_ranged_get->initial_message_has_range_header) {
+                    /* ((2^64)-1 = 20 characters;  3*20 + length-of("bytes -/") < 128) */
+                    char content_range_buffer[128] = "";
+                    snprintf(
+                        content_range_buffer,
+                        sizeof(content_range_buffer),
+                        "bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64,
+                        object_range_start,
+                        object_range_end,
+                        total_object_size);
+                    aws_http_headers_set(
+                        response_headers,
+                        g_content_range_header_name,
+                        aws_byte_cursor_from_c_str(content_range_buffer));
+                } else {
+                    aws_http_headers_erase(response_headers, g_content_range_header_name);
+                }
             }
 
             char content_length_buffer[64] = "";
@@ -586,8 +1775,82 @@ update_synced_data:
         auto_ranged_get->synced_data.object_range_known = true;
         auto_ranged_get->synced_data.object_range_start = object_range_start;
         auto_ranged_get->synced_data.object_range_end = object_range_end;
+        auto_ranged_get->synced_data.object_size = total_object_size;
+
+        if (auto_ranged_get->enable_variable_part_size) {
+            s_s3_auto_ranged_get_plan_part_sizes_synced(auto_ranged_get, object_range_start, object_range_end);
+        }
+
         auto_ranged_get->synced_data.total_num_parts =
-            aws_s3_get_num_parts(meta_request->part_size, object_range_start, object_range_end);
+            s_s3_auto_ranged_get_num_parts_synced(auto_ranged_get, object_range_start, object_range_end);
+
+        /* Every part after this one is pinned to the ETag of the object it came from. */
+        struct aws_byte_cursor etag;
+
+        if (auto_ranged_get->synced_data.etag == NULL && request->send_data.response_headers != NULL &&
+            !aws_http_headers_get(request->send_data.response_headers, g_etag_header_name, &etag)) {
+            auto_ranged_get->synced_data.etag = aws_string_new_from_cursor(meta_request->allocator, &etag);
+        }
+
+        /* Speculative parts that finished before this one came from the version of the object they saw. */
+        if (auto_ranged_get->synced_data.speculative_etag != NULL &&
+            (auto_ranged_get->synced_data.etag == NULL ||
+             !aws_string_eq(auto_ranged_get->synced_data.speculative_etag, auto_ranged_get->synced_data.etag))) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p Speculative parts did not match the ETag of the object, which has changed since the download "
+                "started.",
+                (void *)meta_request);
+
+            error_code = AWS_ERROR_S3_OBJECT_MODIFIED;
+        }
+
+        /* Parts covered by the checkpoint are left out. The first part was requested regardless. */
+        if (!auto_ranged_get->initial_range_is_suffix &&
+            aws_array_list_length(&auto_ranged_get->completed_ranges) > 0) {
+            for (uint32_t part_number = 2; part_number <= auto_ranged_get->synced_data.total_num_parts; ++part_number) {
+                uint64_t part_range_start = 0;
+                uint64_t part_range_end = 0;
+
+                s_s3_auto_ranged_get_part_range_synced(
+                    auto_ranged_get,
+                    object_range_start,
+                    object_range_end,
+                    part_number,
+                    &part_range_start,
+                    &part_range_end);
+
+                if (aws_s3_byte_ranges_cover(&auto_ranged_get->completed_ranges, part_range_start, part_range_end)) {
+                    ++auto_ranged_get->synced_data.num_parts_covered;
+                }
+            }
+
+            auto_ranged_get->synced_data.total_num_parts -= auto_ranged_get->synced_data.num_parts_covered;
+
+            AWS_LOGF_DEBUG(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p Skipping %" PRIu32 " parts already covered by the checkpoint.",
+                (void *)meta_request,
+                auto_ranged_get->synced_data.num_parts_covered);
+        }
+
+        if (request->request_tag == AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART) {
+            /* The first part may have been cut short by the end of the object, or, for a suffix range, covered all of
+             * it. */
+            if (auto_ranged_get->initial_range_is_suffix) {
+                auto_ranged_get->synced_data.total_num_parts = 1;
+                request->part_range_start = object_range_start;
+                request->part_range_end = object_range_end;
+            } else {
+                s_s3_auto_ranged_get_part_range_synced(
+                    auto_ranged_get,
+                    object_range_start,
+                    object_range_end,
+                    1,
+                    &request->part_range_start,
+                    &request->part_range_end);
+            }
+        }
     }
 
     switch (request->request_tag) {
@@ -595,24 +1858,61 @@ update_synced_data:
             auto_ranged_get->synced_data.head_object_completed = true;
             AWS_LOGF_DEBUG(AWS_LS_S3_META_REQUEST, "id=%p Head object completed.", (void *)meta_request);
             break;
-        case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART:
-            ++auto_ranged_get->synced_data.num_parts_completed;
+        case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_PART: {
+            if (request->speculative) {
+                if (s_s3_auto_ranged_get_check_speculative_part_synced(auto_ranged_get, request, &error_code)) {
+                    ++auto_ranged_get->synced_data.num_parts_completed;
+                    break;
+                }
+
+                request_failed = error_code != AWS_ERROR_SUCCESS;
+            }
+
+            bool part_completed = true;
+            bool part_successful = !request_failed;
 
-            if (!request_failed) {
-                ++auto_ranged_get->synced_data.num_parts_successful;
+            const bool deliver = s_s3_auto_ranged_get_part_request_finished_synced(
+                auto_ranged_get, request, request_failed, &part_completed, &part_successful);
+
+            /* When a part is hedged, a failure of one of its requests only matters if the other one doesn't deliver the
+             * part either. */
+            if (request_failed && (!part_completed || part_successful)) {
+                error_code = AWS_ERROR_SUCCESS;
+            }
+
+            if (deliver) {
+                /* The body has to be put in the block cache before it is handed over to be streamed. */
+                if (auto_ranged_get->cache_object_id.len > 0 && !request->send_data.served_from_cache &&
+                    auto_ranged_get->synced_data.etag != NULL) {
+                    s_s3_auto_ranged_get_put_part_in_cache_synced(auto_ranged_get, request);
+                }
 
                 aws_s3_meta_request_stream_response_body_synced(meta_request, request);
+            }
 
-                AWS_LOGF_DEBUG(
-                    AWS_LS_S3_META_REQUEST,
-                    "id=%p: %d out of %d parts have completed.",
-                    (void *)meta_request,
-                    (auto_ranged_get->synced_data.num_parts_successful + auto_ranged_get->synced_data.num_parts_failed),
-                    auto_ranged_get->synced_data.total_num_parts);
-            } else {
-                ++auto_ranged_get->synced_data.num_parts_failed;
+            if (part_completed) {
+                ++auto_ranged_get->synced_data.num_parts_completed;
+
+                if (part_successful) {
+                    ++auto_ranged_get->synced_data.num_parts_successful;
+
+                    AWS_LOGF_DEBUG(
+                        AWS_LS_S3_META_REQUEST,
+                        "id=%p: %d out of %d parts have completed.",
+                        (void *)meta_request,
+                        (auto_ranged_get->synced_data.num_parts_successful +
+                         auto_ranged_get->synced_data.num_parts_failed),
+                        auto_ranged_get->synced_data.total_num_parts);
+                } else {
+                    ++auto_ranged_get->synced_data.num_parts_failed;
+                }
+            }
+
+            if (auto_ranged_get->enable_part_hedging) {
+                s_s3_auto_ranged_get_update_head_of_line_synced(meta_request);
             }
             break;
+        }
         case AWS_S3_AUTO_RANGE_GET_REQUEST_TYPE_INITIAL_MESSAGE:
             AWS_LOGF_DEBUG(
                 AWS_LS_S3_META_REQUEST, "id=%p Get of file using initial message completed.", (void *)meta_request);
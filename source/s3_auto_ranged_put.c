@@ -4,22 +4,39 @@
  */
 
 #include "aws/s3/private/s3_auto_ranged_put.h"
+#include "aws/s3/private/s3_checksums.h"
+#include "aws/s3/private/s3_chunk_stream.h"
 #include "aws/s3/private/s3_request_messages.h"
 #include "aws/s3/private/s3_util.h"
 #include <aws/common/string.h>
+#include <aws/io/event_loop.h>
 #include <aws/io/stream.h>
+#include <inttypes.h>
 
 static const size_t s_etags_initial_capacity = 16;
 static const struct aws_byte_cursor s_upload_id = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("UploadId");
 static const size_t s_complete_multipart_upload_init_body_size_bytes = 512;
 static const size_t s_abort_multipart_upload_init_body_size_bytes = 512;
 
+/* Enough for the base64 encoding of the largest checksum (SHA256). */
+static const size_t s_encoded_checksum_init_size_bytes = 64;
+
 static const struct aws_byte_cursor s_create_multipart_upload_copy_headers[] = {
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-server-side-encryption-customer-algorithm"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-server-side-encryption-customer-key-MD5"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-server-side-encryption-context"),
 };
 
+/* A part handed out while the create-multipart-upload request is in flight, along with what to call once it has been
+ * prepared. */
+struct aws_s3_auto_ranged_put_early_part {
+    struct aws_linked_list_node node;
+    struct aws_task task;
+    struct aws_s3_request *request;
+    aws_s3_meta_request_prepare_request_callback_fn *callback;
+    void *user_data;
+};
+
 static void s_s3_meta_request_auto_ranged_put_destroy(struct aws_s3_meta_request *meta_request);
 
 static bool s_s3_auto_ranged_put_update(
@@ -27,6 +44,12 @@ static bool s_s3_auto_ranged_put_update(
     uint32_t flags,
     struct aws_s3_request **out_request);
 
+static void s_s3_auto_ranged_put_schedule_prepare_request(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    aws_s3_meta_request_prepare_request_callback_fn *callback,
+    void *user_data);
+
 static int s_s3_auto_ranged_put_prepare_request(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request);
@@ -36,17 +59,291 @@ static void s_s3_auto_ranged_put_request_finished(
     struct aws_s3_request *request,
     int error_code);
 
+static int s_s3_auto_ranged_put_pause(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *out_resume_token);
+
 static struct aws_s3_meta_request_vtable s_s3_auto_ranged_put_vtable = {
     .update = s_s3_auto_ranged_put_update,
     .send_request_finish = aws_s3_meta_request_send_request_finish_default,
+    .schedule_prepare_request = s_s3_auto_ranged_put_schedule_prepare_request,
     .prepare_request = s_s3_auto_ranged_put_prepare_request,
     .init_signing_date_time = aws_s3_meta_request_init_signing_date_time_default,
     .sign_request = aws_s3_meta_request_sign_request_default,
     .finished_request = s_s3_auto_ranged_put_request_finished,
     .destroy = s_s3_meta_request_auto_ranged_put_destroy,
     .finish = aws_s3_meta_request_finish_default,
+    .pause = s_s3_auto_ranged_put_pause,
 };
 
+/* Resume tokens are made of lines of a key and a value separated by a space, starting with the version of the format.
+ * Each uploaded part has a line of its own, with the part number and the ETag as value, and another one with its
+ * checksum if the upload has a checksum algorithm. */
+static const struct aws_byte_cursor s_resume_token_version_key = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("version");
+static const struct aws_byte_cursor s_resume_token_upload_id_key = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("upload_id");
+static const struct aws_byte_cursor s_resume_token_part_size_key = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("part_size");
+static const struct aws_byte_cursor s_resume_token_total_num_parts_key =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("total_num_parts");
+static const struct aws_byte_cursor s_resume_token_part_key = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("part");
+static const struct aws_byte_cursor s_resume_token_checksum_algorithm_key =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("checksum_algorithm");
+static const struct aws_byte_cursor s_resume_token_part_checksum_key =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("part_checksum");
+static const uint64_t s_resume_token_version = 1;
+
+/* Parse a decimal number, failing on anything but digits. */
+static int s_s3_resume_token_parse_u64(struct aws_byte_cursor cursor, uint64_t *out_value) {
+    if (cursor.len == 0) {
+        return aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+    }
+
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < cursor.len; ++i) {
+        uint8_t c = cursor.ptr[i];
+
+        if (c < '0' || c > '9' || value > (UINT64_MAX - (c - '0')) / 10) {
+            return aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+        }
+
+        value = value * 10 + (c - '0');
+    }
+
+    *out_value = value;
+    return AWS_OP_SUCCESS;
+}
+
+/* Split "key value" at the first space. */
+static int s_s3_resume_token_split_line(
+    struct aws_byte_cursor line,
+    struct aws_byte_cursor *out_key,
+    struct aws_byte_cursor *out_value) {
+
+    for (size_t i = 0; i < line.len; ++i) {
+        if (line.ptr[i] == ' ') {
+            *out_key = aws_byte_cursor_from_array(line.ptr, i);
+            *out_value = aws_byte_cursor_from_array(line.ptr + i + 1, line.len - i - 1);
+            return AWS_OP_SUCCESS;
+        }
+    }
+
+    return aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+}
+
+/* Replace the string at the index of a part in a list of strings indexed by part number, padding the list with NULL
+ * strings as needed. */
+static int s_s3_part_string_list_set(struct aws_array_list *list, uint32_t part_number, struct aws_string *value) {
+    AWS_PRECONDITION(part_number > 0);
+
+    struct aws_string *null_string = NULL;
+
+    while (aws_array_list_length(list) < part_number) {
+        if (aws_array_list_push_back(list, &null_string)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    struct aws_string *old_value = NULL;
+    aws_array_list_get_at(list, &old_value, part_number - 1);
+    aws_string_destroy(old_value);
+
+    aws_array_list_set_at(list, &value, part_number - 1);
+    return AWS_OP_SUCCESS;
+}
+
+static void s_s3_part_string_list_clean_up(struct aws_array_list *list) {
+    for (size_t index = 0; index < aws_array_list_length(list); ++index) {
+        struct aws_string *value = NULL;
+
+        aws_array_list_get_at(list, &value, index);
+        aws_string_destroy(value);
+    }
+
+    aws_array_list_clean_up(list);
+}
+
+/* Parse the value of a "part" or "part_checksum" line, made of the part number and a string. */
+static int s_s3_resume_token_parse_part_value(
+    struct aws_byte_cursor value,
+    uint32_t *out_part_number,
+    struct aws_byte_cursor *out_part_value) {
+
+    struct aws_byte_cursor part_number_cursor;
+    uint64_t part_number = 0;
+
+    if (s_s3_resume_token_split_line(value, &part_number_cursor, out_part_value) ||
+        s_s3_resume_token_parse_u64(part_number_cursor, &part_number)) {
+        return AWS_OP_ERR;
+    }
+
+    if (part_number == 0 || part_number > g_s3_max_num_upload_parts || out_part_value->len == 0) {
+        return aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+    }
+
+    *out_part_number = (uint32_t)part_number;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_s3_auto_ranged_put_resume_token_parse(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor resume_token,
+    struct aws_s3_auto_ranged_put_resume_token *out_resume_token) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(out_resume_token);
+
+    AWS_ZERO_STRUCT(*out_resume_token);
+
+    if (aws_array_list_init_dynamic(
+            &out_resume_token->etag_list, allocator, s_etags_initial_capacity, sizeof(struct aws_string *))) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_array_list_init_dynamic(
+            &out_resume_token->checksum_list, allocator, s_etags_initial_capacity, sizeof(struct aws_string *))) {
+        aws_array_list_clean_up(&out_resume_token->etag_list);
+        return AWS_OP_ERR;
+    }
+
+    bool version_found = false;
+    uint64_t part_size = 0;
+    uint64_t total_num_parts = 0;
+
+    struct aws_byte_cursor line;
+    AWS_ZERO_STRUCT(line);
+
+    while (aws_byte_cursor_next_split(&resume_token, '\n', &line)) {
+        if (line.len == 0) {
+            continue;
+        }
+
+        struct aws_byte_cursor key;
+        struct aws_byte_cursor value;
+
+        if (s_s3_resume_token_split_line(line, &key, &value)) {
+            goto error_clean_up;
+        }
+
+        /* The version has to come first, so that nothing is read from tokens of another format. */
+        if (!version_found) {
+            uint64_t version = 0;
+
+            if (!aws_byte_cursor_eq(&key, &s_resume_token_version_key) ||
+                s_s3_resume_token_parse_u64(value, &version) || version != s_resume_token_version) {
+                aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+                goto error_clean_up;
+            }
+
+            version_found = true;
+        } else if (aws_byte_cursor_eq(&key, &s_resume_token_upload_id_key)) {
+            if (value.len == 0 || out_resume_token->upload_id != NULL) {
+                aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+                goto error_clean_up;
+            }
+
+            out_resume_token->upload_id = aws_string_new_from_cursor(allocator, &value);
+        } else if (aws_byte_cursor_eq(&key, &s_resume_token_part_size_key)) {
+            if (s_s3_resume_token_parse_u64(value, &part_size)) {
+                goto error_clean_up;
+            }
+        } else if (aws_byte_cursor_eq(&key, &s_resume_token_total_num_parts_key)) {
+            if (s_s3_resume_token_parse_u64(value, &total_num_parts)) {
+                goto error_clean_up;
+            }
+        } else if (
+            aws_byte_cursor_eq(&key, &s_resume_token_part_key) ||
+            aws_byte_cursor_eq(&key, &s_resume_token_part_checksum_key)) {
+            uint32_t part_number = 0;
+            struct aws_byte_cursor part_value;
+
+            if (s_s3_resume_token_parse_part_value(value, &part_number, &part_value)) {
+                goto error_clean_up;
+            }
+
+            struct aws_array_list *list = aws_byte_cursor_eq(&key, &s_resume_token_part_key)
+                                              ? &out_resume_token->etag_list
+                                              : &out_resume_token->checksum_list;
+            struct aws_string *part_string = aws_string_new_from_cursor(allocator, &part_value);
+
+            if (s_s3_part_string_list_set(list, part_number, part_string)) {
+                aws_string_destroy(part_string);
+                goto error_clean_up;
+            }
+        } else if (aws_byte_cursor_eq(&key, &s_resume_token_checksum_algorithm_key)) {
+            out_resume_token->checksum_algorithm = AWS_SCA_NONE;
+
+            for (int algorithm = AWS_SCA_NONE + 1; algorithm <= AWS_SCA_SHA256; ++algorithm) {
+                struct aws_byte_cursor algorithm_name =
+                    aws_s3_checksum_get_algorithm_name((enum aws_s3_checksum_algorithm)algorithm);
+
+                if (aws_byte_cursor_eq(&value, &algorithm_name)) {
+                    out_resume_token->checksum_algorithm = (enum aws_s3_checksum_algorithm)algorithm;
+                }
+            }
+
+            if (out_resume_token->checksum_algorithm == AWS_SCA_NONE) {
+                aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+                goto error_clean_up;
+            }
+        }
+
+        /* Unknown keys are skipped, so that later versions of the format can add to it. */
+    }
+
+    if (!version_found || out_resume_token->upload_id == NULL || part_size == 0 || part_size > SIZE_MAX ||
+        total_num_parts == 0 || total_num_parts > g_s3_max_num_upload_parts ||
+        aws_array_list_length(&out_resume_token->etag_list) > total_num_parts ||
+        aws_array_list_length(&out_resume_token->checksum_list) > total_num_parts) {
+        aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+        goto error_clean_up;
+    }
+
+    out_resume_token->part_size = (size_t)part_size;
+    out_resume_token->total_num_parts = (uint32_t)total_num_parts;
+
+    return AWS_OP_SUCCESS;
+
+error_clean_up:
+
+    aws_s3_auto_ranged_put_resume_token_clean_up(out_resume_token);
+    return AWS_OP_ERR;
+}
+
+void aws_s3_auto_ranged_put_resume_token_clean_up(struct aws_s3_auto_ranged_put_resume_token *resume_token) {
+    AWS_PRECONDITION(resume_token);
+
+    s_s3_part_string_list_clean_up(&resume_token->etag_list);
+    s_s3_part_string_list_clean_up(&resume_token->checksum_list);
+    aws_string_destroy(resume_token->upload_id);
+
+    AWS_ZERO_STRUCT(*resume_token);
+}
+
+/* Append a "key value" line to a resume token. */
+static int s_s3_resume_token_append_line(
+    struct aws_byte_buf *resume_token,
+    struct aws_byte_cursor key,
+    struct aws_byte_cursor value) {
+
+    struct aws_byte_cursor space = aws_byte_cursor_from_c_str(" ");
+    struct aws_byte_cursor new_line = aws_byte_cursor_from_c_str("\n");
+
+    if (aws_byte_buf_append_dynamic(resume_token, &key) || aws_byte_buf_append_dynamic(resume_token, &space) ||
+        aws_byte_buf_append_dynamic(resume_token, &value) || aws_byte_buf_append_dynamic(resume_token, &new_line)) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_resume_token_append_u64_line(
+    struct aws_byte_buf *resume_token,
+    struct aws_byte_cursor key,
+    uint64_t value) {
+
+    char value_buffer[32] = "";
+    snprintf(value_buffer, sizeof(value_buffer), "%" PRIu64, value);
+
+    return s_s3_resume_token_append_line(resume_token, key, aws_byte_cursor_from_c_str(value_buffer));
+}
+
 /* Allocate a new auto-ranged put meta request */
 struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_put_new(
     struct aws_allocator *allocator,
@@ -61,7 +358,9 @@ struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_put_new(
     AWS_PRECONDITION(client);
     AWS_PRECONDITION(options);
     AWS_PRECONDITION(options->message);
-    AWS_PRECONDITION(aws_http_message_get_body_stream(options->message));
+    AWS_PRECONDITION(
+        aws_http_message_get_body_stream(options->message) || options->send_filepath.len > 0 ||
+        options->read_body_at_callback || options->num_send_buffers > 0);
 
     struct aws_s3_auto_ranged_put *auto_ranged_put =
         aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_auto_ranged_put));
@@ -87,15 +386,77 @@ struct aws_s3_meta_request *aws_s3_meta_request_auto_ranged_put_new(
         goto error_clean_up;
     }
 
+    if (aws_array_list_init_dynamic(
+            &auto_ranged_put->synced_data.checksum_list,
+            allocator,
+            s_etags_initial_capacity,
+            sizeof(struct aws_string *))) {
+        aws_array_list_clean_up(&auto_ranged_put->synced_data.etag_list);
+        goto error_clean_up;
+    }
+
+    aws_linked_list_init(&auto_ranged_put->synced_data.early_parts);
+
     auto_ranged_put->content_length = content_length;
+    auto_ranged_put->content_length_known = content_length != AWS_S3_AUTO_RANGED_PUT_UNKNOWN_CONTENT_LENGTH;
     auto_ranged_put->synced_data.total_num_parts = num_parts;
     auto_ranged_put->threaded_update_data.next_part_number = 1;
 
+    auto_ranged_put->part_message_template = aws_s3_upload_part_message_template_new(allocator, options->message);
+
+    if (auto_ranged_put->part_message_template == NULL) {
+        goto release_clean_up;
+    }
+
+    if (options->resume_token.len > 0) {
+        struct aws_s3_auto_ranged_put_resume_token resume_token;
+
+        if (aws_s3_auto_ranged_put_resume_token_parse(allocator, options->resume_token, &resume_token)) {
+            goto release_clean_up;
+        }
+
+        if (!auto_ranged_put->content_length_known || resume_token.part_size != part_size ||
+            resume_token.total_num_parts != num_parts ||
+            resume_token.checksum_algorithm != auto_ranged_put->base.checksum_algorithm) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p Resume token does not match the body of the meta request.",
+                (void *)&auto_ranged_put->base);
+            aws_s3_auto_ranged_put_resume_token_clean_up(&resume_token);
+            aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+            goto release_clean_up;
+        }
+
+        /* Take over the multipart upload, and the parts already uploaded for it. */
+        aws_array_list_clean_up(&auto_ranged_put->synced_data.etag_list);
+        auto_ranged_put->synced_data.etag_list = resume_token.etag_list;
+        aws_array_list_clean_up(&auto_ranged_put->synced_data.checksum_list);
+        auto_ranged_put->synced_data.checksum_list = resume_token.checksum_list;
+        auto_ranged_put->upload_id = resume_token.upload_id;
+
+        auto_ranged_put->synced_data.create_multipart_upload_sent = true;
+        auto_ranged_put->synced_data.create_multipart_upload_completed = true;
+        auto_ranged_put->synced_data.needed_response_headers = aws_http_headers_new(allocator);
+        auto_ranged_put->resumed = true;
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Resuming multipart upload %s.",
+            (void *)&auto_ranged_put->base,
+            aws_string_c_str(auto_ranged_put->upload_id));
+    }
+
     AWS_LOGF_DEBUG(
         AWS_LS_S3_META_REQUEST, "id=%p Created new Auto-Ranged Put Meta Request.", (void *)&auto_ranged_put->base);
 
     return &auto_ranged_put->base;
 
+release_clean_up:
+
+    /* The base is fully set up by now, and is cleaned up along with everything else by releasing it. */
+    aws_s3_meta_request_release(&auto_ranged_put->base);
+    return NULL;
+
 error_clean_up:
 
     aws_mem_release(allocator, auto_ranged_put);
@@ -109,18 +470,17 @@ static void s_s3_meta_request_auto_ranged_put_destroy(struct aws_s3_meta_request
 
     struct aws_s3_auto_ranged_put *auto_ranged_put = meta_request->impl;
 
+    /* Every part holds on to the meta request, so none can still be waiting for the upload id. */
+    AWS_ASSERT(aws_linked_list_empty(&auto_ranged_put->synced_data.early_parts));
+
     aws_string_destroy(auto_ranged_put->upload_id);
     auto_ranged_put->upload_id = NULL;
 
-    for (size_t etag_index = 0; etag_index < aws_array_list_length(&auto_ranged_put->synced_data.etag_list);
-         ++etag_index) {
-        struct aws_string *etag = NULL;
-
-        aws_array_list_get_at(&auto_ranged_put->synced_data.etag_list, &etag, etag_index);
-        aws_string_destroy(etag);
-    }
+    aws_http_message_release(auto_ranged_put->part_message_template);
+    auto_ranged_put->part_message_template = NULL;
 
-    aws_array_list_clean_up(&auto_ranged_put->synced_data.etag_list);
+    s_s3_part_string_list_clean_up(&auto_ranged_put->synced_data.etag_list);
+    s_s3_part_string_list_clean_up(&auto_ranged_put->synced_data.checksum_list);
     aws_http_headers_release(auto_ranged_put->synced_data.needed_response_headers);
     aws_mem_release(meta_request->allocator, auto_ranged_put);
 }
@@ -154,14 +514,43 @@ static bool s_s3_auto_ranged_put_update(
             goto has_work_remaining;
         }
 
-        /* If the create-multipart-upload message hasn't been completed, then there is still additional work to do, but
-         * it can't be done yet. */
-        if (!auto_ranged_put->synced_data.create_multipart_upload_completed) {
-            goto has_work_remaining;
+        /* Parts are handed out without waiting for the create-multipart-upload request to complete. Their bodies are
+         * read while it is in flight, and only their messages wait for the upload id (see
+         * s_s3_auto_ranged_put_schedule_prepare_request). */
+
+        /* Parts uploaded before the meta request was resumed are skipped, as if they had been sent already. */
+        if (auto_ranged_put->content_length_known && auto_ranged_put->resumed) {
+            while (auto_ranged_put->threaded_update_data.next_part_number <=
+                   auto_ranged_put->synced_data.total_num_parts) {
+                struct aws_string *etag = NULL;
+                size_t part_index = auto_ranged_put->threaded_update_data.next_part_number - 1;
+
+                if (part_index < aws_array_list_length(&auto_ranged_put->synced_data.etag_list)) {
+                    aws_array_list_get_at(&auto_ranged_put->synced_data.etag_list, &etag, part_index);
+                }
+
+                if (etag == NULL) {
+                    break;
+                }
+
+                ++auto_ranged_put->threaded_update_data.next_part_number;
+                ++auto_ranged_put->synced_data.num_parts_sent;
+                ++auto_ranged_put->synced_data.num_parts_completed;
+                ++auto_ranged_put->synced_data.num_parts_successful;
+            }
         }
 
         /* If we haven't sent all of the parts yet, then set up to send a new part now. */
-        if (auto_ranged_put->synced_data.num_parts_sent < auto_ranged_put->synced_data.total_num_parts) {
+        if (auto_ranged_put->content_length_known
+                ? auto_ranged_put->synced_data.num_parts_sent < auto_ranged_put->synced_data.total_num_parts
+                : !auto_ranged_put->synced_data.last_part_read) {
+
+            /* Without a content length, whether there is another part is only known once the part before it has been
+             * read. Parts are still read one after the other from the stream anyway, and sent in parallel. */
+            if (!auto_ranged_put->content_length_known &&
+                auto_ranged_put->synced_data.num_parts_sent > auto_ranged_put->synced_data.num_parts_read) {
+                goto has_work_remaining;
+            }
 
             if ((flags & AWS_S3_META_REQUEST_UPDATE_FLAG_CONSERVATIVE) != 0) {
                 uint32_t num_parts_in_flight =
@@ -174,9 +563,15 @@ static bool s_s3_auto_ranged_put_update(
                 }
             }
 
-            /* Allocate a request for another part. */
+            /* Allocate a request for another part. Parts of a body of send buffers are sent from the buffers, and
+             * don't need a part buffer. */
             request = aws_s3_request_new(
-                meta_request, AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_PART, 0, AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS);
+                meta_request,
+                AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_PART,
+                0,
+                AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS |
+                    (aws_s3_meta_request_has_send_buffers(meta_request) ? 0
+                                                                        : AWS_S3_REQUEST_FLAG_PART_SIZE_REQUEST_BODY));
 
             request->part_number = auto_ranged_put->threaded_update_data.next_part_number;
 
@@ -236,6 +631,11 @@ static bool s_s3_auto_ranged_put_update(
             goto has_work_remaining;
         }
 
+        /* A paused multipart upload is left as is, for a later meta request to resume. */
+        if (auto_ranged_put->synced_data.paused) {
+            goto no_work_remaining;
+        }
+
         /* If the complete-multipart-upload is already in flight, then we can't necessarily send an abort. */
         if (auto_ranged_put->synced_data.complete_multipart_upload_sent &&
             !auto_ranged_put->synced_data.complete_multipart_upload_completed) {
@@ -296,6 +696,432 @@ no_work_remaining:
     return work_remaining;
 }
 
+/* Read the next part of a body whose length isn't known, up to the part size or the end of the body stream. A byte is
+ * read past the end of each full part, so that the last part is known to be the last one as soon as it has been read,
+ * and doesn't have to be followed by an empty one. */
+static int s_s3_auto_ranged_put_read_unknown_length_part(
+    struct aws_s3_auto_ranged_put *auto_ranged_put,
+    struct aws_s3_request *request,
+    bool *out_last_part) {
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_put->base;
+    struct aws_byte_buf *part_body = &request->request_body;
+    struct aws_input_stream *body_stream = aws_http_message_get_body_stream(meta_request->initial_request_message);
+    uint64_t part_offset = (uint64_t)(request->part_number - 1) * (uint64_t)meta_request->part_size;
+
+    if (auto_ranged_put->threaded_prepare_data.has_next_byte) {
+        aws_byte_buf_write_u8(part_body, auto_ranged_put->threaded_prepare_data.next_byte);
+        auto_ranged_put->threaded_prepare_data.has_next_byte = false;
+    }
+
+    while (true) {
+        if (part_body->len < part_body->capacity) {
+            if (aws_s3_meta_request_read_body(meta_request, part_offset + part_body->len, part_body)) {
+                return AWS_OP_ERR;
+            }
+        } else {
+            struct aws_byte_buf next_byte_buf =
+                aws_byte_buf_from_empty_array(&auto_ranged_put->threaded_prepare_data.next_byte, 1);
+
+            if (aws_s3_meta_request_read_body(meta_request, part_offset + part_body->len, &next_byte_buf)) {
+                return AWS_OP_ERR;
+            }
+
+            if (next_byte_buf.len > 0) {
+                auto_ranged_put->threaded_prepare_data.has_next_byte = true;
+                *out_last_part = false;
+                return AWS_OP_SUCCESS;
+            }
+        }
+
+        struct aws_stream_status status;
+        AWS_ZERO_STRUCT(status);
+
+        if (aws_input_stream_get_status(body_stream, &status)) {
+            return AWS_OP_ERR;
+        }
+
+        if (status.is_end_of_stream) {
+            *out_last_part = true;
+            return AWS_OP_SUCCESS;
+        }
+    }
+}
+
+/* Take a part of a body of send buffers straight from the buffers. A part that lies in one buffer is borrowed from it
+ * as the request body. One that spans several is gathered from them every time it is sent, unless its checksum goes in
+ * a trailer: aws-chunked bodies are encoded from one piece of memory, so that part is copied into a part buffer. */
+static int s_s3_auto_ranged_put_take_part_from_send_buffers(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    uint64_t part_offset,
+    size_t part_size) {
+
+    struct aws_array_list segments;
+
+    if (aws_array_list_init_dynamic(&segments, meta_request->allocator, 4, sizeof(struct aws_byte_cursor))) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+
+    if (aws_s3_meta_request_get_send_buffer_segments(meta_request, part_offset, part_size, &segments)) {
+        goto clean_up;
+    }
+
+    if (aws_array_list_length(&segments) == 1) {
+        struct aws_byte_cursor segment;
+        aws_array_list_get_at(&segments, &segment, 0);
+
+        /* The request body of a part is only ever read once it has been filled in, so the caller's memory can stand in
+         * for it. Without an allocator, it is left alone when the request lets go of it. */
+        request->request_body = aws_byte_buf_from_array(segment.ptr, segment.len);
+    } else if (meta_request->payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER) {
+        if (aws_s3_meta_request_init_part_buffer(meta_request, part_size, &request->request_body) ||
+            aws_s3_meta_request_read_body(meta_request, part_offset, &request->request_body)) {
+            goto clean_up;
+        }
+    } else {
+        request->num_gathered_request_body_bytes = part_size;
+    }
+
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+
+    aws_array_list_clean_up(&segments);
+    return result;
+}
+
+/* Create the message of a part gathered from several send buffers. */
+static struct aws_http_message *s_s3_auto_ranged_put_gathered_part_message_new(
+    struct aws_s3_auto_ranged_put *auto_ranged_put,
+    struct aws_s3_request *request) {
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_put->base;
+    uint64_t part_offset = (uint64_t)(request->part_number - 1) * (uint64_t)meta_request->part_size;
+    struct aws_http_message *message = NULL;
+    struct aws_array_list segments;
+
+    if (aws_array_list_init_dynamic(&segments, meta_request->allocator, 4, sizeof(struct aws_byte_cursor))) {
+        return NULL;
+    }
+
+    if (aws_s3_meta_request_get_send_buffer_segments(
+            meta_request, part_offset, request->num_gathered_request_body_bytes, &segments) == AWS_OP_SUCCESS) {
+        message = aws_s3_upload_part_message_new_gathered(
+            meta_request->allocator,
+            auto_ranged_put->part_message_template,
+            segments.data,
+            aws_array_list_length(&segments),
+            request->part_number,
+            auto_ranged_put->upload_id,
+            meta_request->should_compute_content_md5,
+            AWS_SCA_NONE,
+            NULL);
+    }
+
+    aws_array_list_clean_up(&segments);
+    return message;
+}
+
+/* Compute the checksum of the body of a part, which goes in the message of the part and in the
+ * complete-multipart-upload request. The body of a part doesn't change when it is retried, so this is only done once.
+ */
+static int s_s3_auto_ranged_put_compute_part_checksum(
+    struct aws_s3_auto_ranged_put *auto_ranged_put,
+    struct aws_s3_request *request) {
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_put->base;
+    struct aws_array_list segments;
+
+    if (aws_array_list_init_dynamic(&segments, meta_request->allocator, 4, sizeof(struct aws_byte_cursor))) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+    struct aws_byte_buf encoded_checksum;
+    AWS_ZERO_STRUCT(encoded_checksum);
+
+    if (aws_byte_buf_init(&encoded_checksum, meta_request->allocator, s_encoded_checksum_init_size_bytes)) {
+        goto clean_up;
+    }
+
+    if (request->num_gathered_request_body_bytes > 0) {
+        uint64_t part_offset = (uint64_t)(request->part_number - 1) * (uint64_t)meta_request->part_size;
+
+        if (aws_s3_meta_request_get_send_buffer_segments(
+                meta_request, part_offset, request->num_gathered_request_body_bytes, &segments)) {
+            goto clean_up;
+        }
+    } else {
+        struct aws_byte_cursor body = aws_byte_cursor_from_buf(&request->request_body);
+
+        if (aws_array_list_push_back(&segments, &body)) {
+            goto clean_up;
+        }
+    }
+
+    if (aws_s3_checksum_compute_base64_gathered(
+            meta_request->allocator,
+            meta_request->checksum_algorithm,
+            segments.data,
+            aws_array_list_length(&segments),
+            &encoded_checksum)) {
+        goto clean_up;
+    }
+
+    struct aws_byte_cursor encoded_checksum_cursor = aws_byte_cursor_from_buf(&encoded_checksum);
+    struct aws_string *checksum = aws_string_new_from_cursor(meta_request->allocator, &encoded_checksum_cursor);
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    int set_result =
+        s_s3_part_string_list_set(&auto_ranged_put->synced_data.checksum_list, request->part_number, checksum);
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    if (set_result) {
+        aws_string_destroy(checksum);
+        goto clean_up;
+    }
+
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+
+    aws_byte_buf_clean_up(&encoded_checksum);
+    aws_array_list_clean_up(&segments);
+    return result;
+}
+
+/* Add the checksum computed when the body of a part was read to the message of the part. */
+static int s_s3_auto_ranged_put_add_part_checksum_header(
+    struct aws_s3_auto_ranged_put *auto_ranged_put,
+    struct aws_s3_request *request,
+    struct aws_http_message *message) {
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_put->base;
+    struct aws_string *checksum = NULL;
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    if (request->part_number <= aws_array_list_length(&auto_ranged_put->synced_data.checksum_list)) {
+        aws_array_list_get_at(&auto_ranged_put->synced_data.checksum_list, &checksum, request->part_number - 1);
+    }
+
+    int result = checksum != NULL ? aws_http_headers_set(
+                                        aws_http_message_get_headers(message),
+                                        aws_s3_checksum_get_header_name(meta_request->checksum_algorithm),
+                                        aws_byte_cursor_from_string(checksum))
+                                  : aws_raise_error(AWS_ERROR_INVALID_STATE);
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+    return result;
+}
+
+/* Read the body of a part, and compute its checksum unless that goes in a trailer. Neither needs the upload id, so this
+ * is done as soon as the part is handed out, even while the create-multipart-upload request is in flight. The checksum
+ * is computed here, which for positional bodies is on the body streaming threads, in parallel with the other parts. */
+static int s_s3_auto_ranged_put_prepare_part_body(
+    struct aws_s3_auto_ranged_put *auto_ranged_put,
+    struct aws_s3_request *request) {
+
+    struct aws_s3_meta_request *meta_request = &auto_ranged_put->base;
+    size_t request_body_size = meta_request->part_size;
+
+    /* Last part--adjust size to match remaining content length. */
+    if (auto_ranged_put->content_length_known && request->part_number == auto_ranged_put->synced_data.total_num_parts) {
+        size_t content_remainder = (size_t)(auto_ranged_put->content_length % (uint64_t)meta_request->part_size);
+
+        if (content_remainder > 0) {
+            request_body_size = content_remainder;
+        }
+    }
+
+    if (aws_s3_meta_request_has_send_buffers(meta_request)) {
+        if (s_s3_auto_ranged_put_take_part_from_send_buffers(
+                meta_request,
+                request,
+                (uint64_t)(request->part_number - 1) * (uint64_t)meta_request->part_size,
+                request_body_size)) {
+            return AWS_OP_ERR;
+        }
+    } else {
+        if (aws_s3_meta_request_init_part_buffer(meta_request, request_body_size, &request->request_body)) {
+            return AWS_OP_ERR;
+        }
+
+        if (auto_ranged_put->content_length_known) {
+            uint64_t part_offset = (uint64_t)(request->part_number - 1) * (uint64_t)meta_request->part_size;
+
+            /* Parts are read one after the other from a body stream, but after a resume some of them are skipped, so
+             * the stream is moved to where the part starts. */
+            if (auto_ranged_put->resumed && !aws_s3_meta_request_has_positional_body(meta_request)) {
+                struct aws_input_stream *body_stream =
+                    aws_http_message_get_body_stream(meta_request->initial_request_message);
+
+                if (aws_input_stream_seek(body_stream, (int64_t)part_offset, AWS_SSB_BEGIN)) {
+                    return AWS_OP_ERR;
+                }
+            }
+
+            if (aws_s3_meta_request_read_body(meta_request, part_offset, &request->request_body)) {
+                return AWS_OP_ERR;
+            }
+        } else {
+            bool last_part = false;
+
+            if (s_s3_auto_ranged_put_read_unknown_length_part(auto_ranged_put, request, &last_part)) {
+                return AWS_OP_ERR;
+            }
+
+            if (!last_part && request->part_number >= g_s3_max_num_upload_parts) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_S3_META_REQUEST,
+                    "id=%p Body does not fit in %" PRIu32 " parts of %" PRIu64 " bytes.",
+                    (void *)meta_request,
+                    g_s3_max_num_upload_parts,
+                    (uint64_t)meta_request->part_size);
+                return aws_raise_error(AWS_ERROR_S3_MAX_NUM_PARTS_EXCEEDED);
+            }
+
+            aws_s3_meta_request_lock_synced_data(meta_request);
+
+            ++auto_ranged_put->synced_data.num_parts_read;
+
+            if (last_part) {
+                auto_ranged_put->synced_data.last_part_read = true;
+                auto_ranged_put->synced_data.total_num_parts = request->part_number;
+            }
+
+            aws_s3_meta_request_unlock_synced_data(meta_request);
+        }
+    }
+
+    /* Parts sent aws-chunked get their checksum in a trailer, computed as the part goes out. */
+    if (meta_request->checksum_algorithm != AWS_SCA_NONE &&
+        meta_request->payload_signing_mode != AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER &&
+        s_s3_auto_ranged_put_compute_part_checksum(auto_ranged_put, request)) {
+        return AWS_OP_ERR;
+    }
+
+    request->request_body_prepared = true;
+    return AWS_OP_SUCCESS;
+}
+
+/* Hand a part on to be prepared the usual way, which leaves creating its message and signing it, if its body was
+ * already read. */
+static void s_s3_auto_ranged_put_finish_preparing_early_part(struct aws_s3_auto_ranged_put_early_part *early_part) {
+    struct aws_s3_request *request = early_part->request;
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+
+    aws_s3_meta_request_schedule_prepare_request_default(
+        meta_request, request, early_part->callback, early_part->user_data);
+
+    aws_mem_release(meta_request->allocator, early_part);
+}
+
+static void s_s3_auto_ranged_put_read_early_part_task(
+    struct aws_task *task,
+    void *arg,
+    enum aws_task_status task_status) {
+    (void)task;
+
+    struct aws_s3_auto_ranged_put_early_part *early_part = arg;
+    AWS_PRECONDITION(early_part);
+
+    struct aws_s3_request *request = early_part->request;
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+    struct aws_s3_auto_ranged_put *auto_ranged_put = meta_request->impl;
+
+    /* Without a positional body, this runs on the meta request's io_event_loop, which comes from the client
+     * bootstrap's event loop group. The caller owns that group, and can shut it down with the task still scheduled. */
+    if (task_status != AWS_TASK_STATUS_RUN_READY) {
+        aws_s3_meta_request_lock_synced_data(meta_request);
+        aws_s3_meta_request_set_fail_synced(meta_request, request, AWS_ERROR_S3_CANCELED);
+        aws_s3_meta_request_unlock_synced_data(meta_request);
+
+        if (early_part->callback != NULL) {
+            early_part->callback(meta_request, request, AWS_ERROR_S3_CANCELED, early_part->user_data);
+        }
+
+        aws_mem_release(meta_request->allocator, early_part);
+        return;
+    }
+
+    /* A part that can't be read fails the meta request. It is still handed on, to be finished as canceled. */
+    if (!aws_s3_meta_request_has_finish_result(meta_request) &&
+        s_s3_auto_ranged_put_prepare_part_body(auto_ranged_put, request)) {
+        int error_code = aws_last_error_or_unknown();
+
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Could not read the body of part %" PRIu32 " due to error %d (%s).",
+            (void *)meta_request,
+            request->part_number,
+            error_code,
+            aws_error_str(error_code));
+
+        aws_s3_meta_request_lock_synced_data(meta_request);
+        aws_s3_meta_request_set_fail_synced(meta_request, request, error_code);
+        aws_s3_meta_request_unlock_synced_data(meta_request);
+    }
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    const bool wait_for_upload_id = !auto_ranged_put->synced_data.create_multipart_upload_completed;
+
+    if (wait_for_upload_id) {
+        aws_linked_list_push_back(&auto_ranged_put->synced_data.early_parts, &early_part->node);
+    }
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    if (!wait_for_upload_id) {
+        s_s3_auto_ranged_put_finish_preparing_early_part(early_part);
+    }
+}
+
+/* Parts handed out while the create-multipart-upload request is in flight have their body read right away, and then
+ * wait for the upload id to have their message created and signed. This hides the latency of the create request,
+ * which for uploads of a few parts is a good share of the time they take. */
+static void s_s3_auto_ranged_put_schedule_prepare_request(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    aws_s3_meta_request_prepare_request_callback_fn *callback,
+    void *user_data) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_auto_ranged_put *auto_ranged_put = meta_request->impl;
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    const bool read_part_early = request->request_tag == AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_PART &&
+                                 !auto_ranged_put->synced_data.create_multipart_upload_completed;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    if (!read_part_early) {
+        aws_s3_meta_request_schedule_prepare_request_default(meta_request, request, callback, user_data);
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_META_REQUEST,
+        "id=%p: Reading part %" PRIu32 " while the multipart upload is being created",
+        (void *)meta_request,
+        request->part_number);
+
+    struct aws_s3_auto_ranged_put_early_part *early_part =
+        aws_mem_calloc(meta_request->allocator, 1, sizeof(struct aws_s3_auto_ranged_put_early_part));
+
+    early_part->request = request;
+    early_part->callback = callback;
+    early_part->user_data = user_data;
+
+    aws_task_init(
+        &early_part->task, s_s3_auto_ranged_put_read_early_part_task, early_part, "s3_auto_ranged_put_read_early_part");
+    aws_event_loop_schedule_task_now(aws_s3_meta_request_get_prepare_event_loop(meta_request), &early_part->task);
+}
+
 /* Given a request, prepare it for sending based on its description. */
 static int s_s3_auto_ranged_put_prepare_request(
     struct aws_s3_meta_request *meta_request,
@@ -312,40 +1138,71 @@ static int s_s3_auto_ranged_put_prepare_request(
 
             /* Create the message to create a new multipart upload. */
             message = aws_s3_create_multipart_upload_message_new(
-                meta_request->allocator, meta_request->initial_request_message);
+                meta_request->allocator, meta_request->initial_request_message, meta_request->checksum_algorithm);
 
             break;
         }
         case AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_PART: {
 
-            size_t request_body_size = meta_request->part_size;
+            if (!request->request_body_prepared && s_s3_auto_ranged_put_prepare_part_body(auto_ranged_put, request)) {
+                goto message_create_failed;
+            }
 
-            /* Last part--adjust size to match remaining content length. */
-            if (request->part_number == auto_ranged_put->synced_data.total_num_parts) {
-                size_t content_remainder =
-                    (size_t)(auto_ranged_put->content_length % (uint64_t)meta_request->part_size);
+            /* Parts read while the create-multipart-upload request was in flight are only prepared from here on once
+             * it has completed. */
+            AWS_FATAL_ASSERT(auto_ranged_put->upload_id);
 
-                if (content_remainder > 0) {
-                    request_body_size = content_remainder;
+            /* Parts sent aws-chunked get their checksum in a trailer, computed as the part goes out. */
+            if (meta_request->payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER) {
+                message = aws_s3_upload_part_message_new(
+                    meta_request->allocator,
+                    auto_ranged_put->part_message_template,
+                    NULL,
+                    request->part_number,
+                    auto_ranged_put->upload_id,
+                    false,
+                    AWS_SCA_NONE,
+                    NULL);
+
+                if (message == NULL) {
+                    break;
                 }
+
+                if (aws_s3_message_util_assign_chunked_body(
+                        meta_request->allocator, &request->request_body, meta_request->checksum_algorithm, message) ==
+                        NULL ||
+                    (meta_request->should_compute_content_md5 &&
+                     aws_s3_message_util_add_content_md5_header(
+                         meta_request->allocator, &request->request_body, message))) {
+                    aws_input_stream_destroy(aws_http_message_get_body_stream(message));
+                    aws_http_message_release(message);
+                    message = NULL;
+                }
+
+                break;
             }
 
-            if (request->num_times_prepared == 0) {
-                aws_byte_buf_init(&request->request_body, meta_request->allocator, request_body_size);
+            /* Create a new put-object message to upload a part, with the checksum computed when its body was read. */
+            if (request->num_gathered_request_body_bytes > 0) {
+                message = s_s3_auto_ranged_put_gathered_part_message_new(auto_ranged_put, request);
+            } else {
+                message = aws_s3_upload_part_message_new(
+                    meta_request->allocator,
+                    auto_ranged_put->part_message_template,
+                    &request->request_body,
+                    request->part_number,
+                    auto_ranged_put->upload_id,
+                    meta_request->should_compute_content_md5,
+                    AWS_SCA_NONE,
+                    NULL);
+            }
 
-                if (aws_s3_meta_request_read_body(meta_request, &request->request_body)) {
-                    goto message_create_failed;
-                }
+            if (message != NULL && meta_request->checksum_algorithm != AWS_SCA_NONE &&
+                s_s3_auto_ranged_put_add_part_checksum_header(auto_ranged_put, request, message)) {
+                aws_http_message_release(message);
+                message = NULL;
             }
 
-            /* Create a new put-object message to upload a part. */
-            message = aws_s3_upload_part_message_new(
-                meta_request->allocator,
-                meta_request->initial_request_message,
-                &request->request_body,
-                request->part_number,
-                auto_ranged_put->upload_id,
-                meta_request->should_compute_content_md5);
             break;
         }
         case AWS_S3_AUTO_RANGED_PUT_REQUEST_TAG_COMPLETE_MULTIPART_UPLOAD: {
@@ -370,7 +1227,9 @@ static int s_s3_auto_ranged_put_prepare_request(
                 meta_request->initial_request_message,
                 &request->request_body,
                 auto_ranged_put->upload_id,
-                &auto_ranged_put->synced_data.etag_list);
+                &auto_ranged_put->synced_data.etag_list,
+                meta_request->checksum_algorithm != AWS_SCA_NONE ? &auto_ranged_put->synced_data.checksum_list : NULL,
+                meta_request->checksum_algorithm);
 
             aws_s3_meta_request_unlock_synced_data(meta_request);
 
@@ -478,6 +1337,9 @@ static void s_s3_auto_ranged_put_request_finished(
                 }
             }
 
+            struct aws_linked_list early_parts;
+            aws_linked_list_init(&early_parts);
+
             aws_s3_meta_request_lock_synced_data(meta_request);
 
             AWS_ASSERT(auto_ranged_put->synced_data.needed_response_headers == NULL)
@@ -490,7 +1352,18 @@ static void s_s3_auto_ranged_put_request_finished(
                 aws_s3_meta_request_set_fail_synced(meta_request, request, error_code);
             }
 
+            aws_linked_list_swap_contents(&early_parts, &auto_ranged_put->synced_data.early_parts);
+
             aws_s3_meta_request_unlock_synced_data(meta_request);
+
+            /* The parts read while waiting for the upload id can be finished now. If there is no upload id, they are
+             * finished as canceled. */
+            while (!aws_linked_list_empty(&early_parts)) {
+                struct aws_linked_list_node *node = aws_linked_list_pop_front(&early_parts);
+                s_s3_auto_ranged_put_finish_preparing_early_part(
+                    AWS_CONTAINER_OF(node, struct aws_s3_auto_ranged_put_early_part, node));
+            }
+
             break;
         }
 
@@ -529,6 +1402,31 @@ static void s_s3_auto_ranged_put_request_finished(
                 }
             }
 
+            /* Parts sent aws-chunked only know their checksum once their body has gone out in full. */
+            struct aws_string *trailer_checksum = NULL;
+
+            if (error_code == AWS_ERROR_SUCCESS &&
+                meta_request->payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER) {
+                struct aws_byte_buf encoded_checksum;
+
+                if (aws_byte_buf_init(&encoded_checksum, meta_request->allocator, s_encoded_checksum_init_size_bytes) ||
+                    aws_s3_chunk_stream_get_checksum(
+                        aws_http_message_get_body_stream(request->send_data.message), &encoded_checksum)) {
+                    AWS_LOGF_ERROR(
+                        AWS_LS_S3_META_REQUEST,
+                        "id=%p Could not get the trailing checksum of request %p",
+                        (void *)meta_request,
+                        (void *)request);
+
+                    error_code = aws_last_error_or_unknown();
+                } else {
+                    struct aws_byte_cursor encoded_checksum_cursor = aws_byte_cursor_from_buf(&encoded_checksum);
+                    trailer_checksum = aws_string_new_from_cursor(meta_request->allocator, &encoded_checksum_cursor);
+                }
+
+                aws_byte_buf_clean_up(&encoded_checksum);
+            }
+
             aws_s3_meta_request_lock_synced_data(meta_request);
 
             ++auto_ranged_put->synced_data.num_parts_completed;
@@ -557,7 +1455,14 @@ static void s_s3_auto_ranged_put_request_finished(
                 }
 
                 aws_array_list_set_at(&auto_ranged_put->synced_data.etag_list, &etag, part_index);
+
+                if (trailer_checksum != NULL) {
+                    int set_result = s_s3_part_string_list_set(
+                        &auto_ranged_put->synced_data.checksum_list, request->part_number, trailer_checksum);
+                    AWS_FATAL_ASSERT(set_result == AWS_OP_SUCCESS);
+                }
             } else {
+                aws_string_destroy(etag);
                 ++auto_ranged_put->synced_data.num_parts_failed;
                 aws_s3_meta_request_set_fail_synced(meta_request, request, error_code);
             }
@@ -637,3 +1542,114 @@ static void s_s3_auto_ranged_put_request_finished(
         }
     }
 }
+
+static int s_s3_auto_ranged_put_pause(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *out_resume_token) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(out_resume_token);
+
+    struct aws_s3_auto_ranged_put *auto_ranged_put = meta_request->impl;
+    AWS_PRECONDITION(auto_ranged_put);
+
+    int result = AWS_OP_ERR;
+
+    /* Without a content length, the body can't be matched up with the parts of the token when it is resumed. */
+    if (!auto_ranged_put->content_length_known) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST, "id=%p Uploads of unknown length cannot be paused.", (void *)meta_request);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    /* There is only something to resume once the multipart upload exists, and as long as it hasn't been completed. */
+    if (aws_s3_meta_request_has_finish_result_synced(meta_request) ||
+        !auto_ranged_put->synced_data.create_multipart_upload_completed || auto_ranged_put->upload_id == NULL ||
+        auto_ranged_put->synced_data.complete_multipart_upload_sent) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Meta request cannot be paused before its multipart upload is created or after it is finished.",
+            (void *)meta_request);
+        aws_raise_error(AWS_ERROR_INVALID_STATE);
+        goto unlock;
+    }
+
+    if (s_s3_resume_token_append_u64_line(out_resume_token, s_resume_token_version_key, s_resume_token_version) ||
+        s_s3_resume_token_append_line(
+            out_resume_token, s_resume_token_upload_id_key, aws_byte_cursor_from_string(auto_ranged_put->upload_id)) ||
+        s_s3_resume_token_append_u64_line(
+            out_resume_token, s_resume_token_part_size_key, (uint64_t)meta_request->part_size) ||
+        s_s3_resume_token_append_u64_line(
+            out_resume_token, s_resume_token_total_num_parts_key, auto_ranged_put->synced_data.total_num_parts)) {
+        goto unlock;
+    }
+
+    if (meta_request->checksum_algorithm != AWS_SCA_NONE &&
+        s_s3_resume_token_append_line(
+            out_resume_token,
+            s_resume_token_checksum_algorithm_key,
+            aws_s3_checksum_get_algorithm_name(meta_request->checksum_algorithm))) {
+        goto unlock;
+    }
+
+    for (size_t etag_index = 0; etag_index < aws_array_list_length(&auto_ranged_put->synced_data.etag_list);
+         ++etag_index) {
+        struct aws_string *etag = NULL;
+        aws_array_list_get_at(&auto_ranged_put->synced_data.etag_list, &etag, etag_index);
+
+        if (etag == NULL) {
+            continue;
+        }
+
+        /* The key of a part line is "part <part number>", followed by the ETag as value. */
+        char part_key[32] = "";
+        snprintf(
+            part_key,
+            sizeof(part_key),
+            PRInSTR " %" PRIu64,
+            AWS_BYTE_CURSOR_PRI(s_resume_token_part_key),
+            (uint64_t)etag_index + 1);
+
+        if (s_s3_resume_token_append_line(
+                out_resume_token, aws_byte_cursor_from_c_str(part_key), aws_byte_cursor_from_string(etag))) {
+            goto unlock;
+        }
+
+        struct aws_string *checksum = NULL;
+
+        if (etag_index < aws_array_list_length(&auto_ranged_put->synced_data.checksum_list)) {
+            aws_array_list_get_at(&auto_ranged_put->synced_data.checksum_list, &checksum, etag_index);
+        }
+
+        if (checksum == NULL) {
+            continue;
+        }
+
+        snprintf(
+            part_key,
+            sizeof(part_key),
+            PRInSTR " %" PRIu64,
+            AWS_BYTE_CURSOR_PRI(s_resume_token_part_checksum_key),
+            (uint64_t)etag_index + 1);
+
+        if (s_s3_resume_token_append_line(
+                out_resume_token, aws_byte_cursor_from_c_str(part_key), aws_byte_cursor_from_string(checksum))) {
+            goto unlock;
+        }
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_META_REQUEST,
+        "id=%p Pausing multipart upload %s.",
+        (void *)meta_request,
+        aws_string_c_str(auto_ranged_put->upload_id));
+
+    auto_ranged_put->synced_data.paused = true;
+    aws_s3_meta_request_set_fail_synced(meta_request, NULL, AWS_ERROR_S3_PAUSED);
+
+    result = AWS_OP_SUCCESS;
+
+unlock:
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    return result;
+}
@@ -0,0 +1,408 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_block_cache.h"
+
+#include <aws/common/math.h>
+#include <aws/common/string.h>
+
+struct aws_s3_block_cache_object {
+    /* Id of the object, pointing into id_buf. Also the key of the object in the objects table. */
+    struct aws_byte_cursor id;
+    struct aws_byte_buf id_buf;
+
+    struct aws_string *etag;
+    uint64_t size;
+
+    /* Blocks of the object that are in the cache, in no particular order. */
+    struct aws_linked_list blocks;
+};
+
+struct aws_s3_block_cache_block_key {
+    const struct aws_s3_block_cache_object *object;
+    uint64_t block_index;
+};
+
+struct aws_s3_block_cache_block {
+    struct aws_s3_block_cache_block_key key;
+    struct aws_byte_buf data;
+
+    /* Node in the cache's lru_blocks list. */
+    struct aws_linked_list_node lru_node;
+
+    /* Node in the blocks list of the object. */
+    struct aws_linked_list_node object_node;
+};
+
+static uint64_t s_block_key_hash(const void *item) {
+    const struct aws_s3_block_cache_block_key *key = item;
+    return aws_hash_ptr(key->object) ^ (key->block_index * 0x9E3779B97F4A7C15ULL);
+}
+
+static bool s_block_key_eq(const void *a, const void *b) {
+    const struct aws_s3_block_cache_block_key *key_a = a;
+    const struct aws_s3_block_cache_block_key *key_b = b;
+    return key_a->object == key_b->object && key_a->block_index == key_b->block_index;
+}
+
+struct aws_s3_block_cache *aws_s3_block_cache_new(
+    struct aws_allocator *allocator,
+    uint64_t block_size,
+    uint64_t max_bytes) {
+    AWS_PRECONDITION(allocator);
+
+    if (block_size == 0 || max_bytes == 0) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_s3_block_cache *block_cache = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_block_cache));
+
+    block_cache->allocator = allocator;
+    *((uint64_t *)&block_cache->block_size) = block_size;
+    *((uint64_t *)&block_cache->max_bytes) = max_bytes;
+
+    if (aws_mutex_init(&block_cache->synced_data.lock)) {
+        goto error_clean_up;
+    }
+
+    if (aws_hash_table_init(
+            &block_cache->synced_data.objects,
+            allocator,
+            16,
+            aws_hash_byte_cursor_ptr,
+            (bool (*)(const void *, const void *))aws_byte_cursor_eq,
+            NULL,
+            NULL)) {
+        goto error_clean_up_lock;
+    }
+
+    if (aws_hash_table_init(
+            &block_cache->synced_data.blocks, allocator, 64, s_block_key_hash, s_block_key_eq, NULL, NULL)) {
+        goto error_clean_up_objects;
+    }
+
+    aws_linked_list_init(&block_cache->synced_data.lru_blocks);
+
+    return block_cache;
+
+error_clean_up_objects:
+
+    aws_hash_table_clean_up(&block_cache->synced_data.objects);
+
+error_clean_up_lock:
+
+    aws_mutex_clean_up(&block_cache->synced_data.lock);
+
+error_clean_up:
+
+    aws_mem_release(allocator, block_cache);
+    return NULL;
+}
+
+static void s_s3_block_cache_object_destroy(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_s3_block_cache_object *object) {
+    aws_string_destroy(object->etag);
+    aws_byte_buf_clean_up(&object->id_buf);
+    aws_mem_release(block_cache->allocator, object);
+}
+
+/* Take a block out of the cache and free it. When the object is left without blocks, it is forgotten as well, unless
+ * keep_object is set. */
+static void s_s3_block_cache_remove_block_synced(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_s3_block_cache_block *block,
+    bool keep_object) {
+    struct aws_s3_block_cache_object *object = (struct aws_s3_block_cache_object *)block->key.object;
+
+    aws_hash_table_remove(&block_cache->synced_data.blocks, &block->key, NULL, NULL);
+    aws_linked_list_remove(&block->lru_node);
+    aws_linked_list_remove(&block->object_node);
+
+    block_cache->synced_data.num_bytes -= block->data.len;
+
+    aws_byte_buf_clean_up(&block->data);
+    aws_mem_release(block_cache->allocator, block);
+
+    if (!keep_object && aws_linked_list_empty(&object->blocks)) {
+        aws_hash_table_remove(&block_cache->synced_data.objects, &object->id, NULL, NULL);
+        s_s3_block_cache_object_destroy(block_cache, object);
+    }
+}
+
+static void s_s3_block_cache_remove_object_blocks_synced(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_s3_block_cache_object *object) {
+    while (!aws_linked_list_empty(&object->blocks)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&object->blocks);
+        struct aws_s3_block_cache_block *block = AWS_CONTAINER_OF(node, struct aws_s3_block_cache_block, object_node);
+        s_s3_block_cache_remove_block_synced(block_cache, block, true);
+    }
+}
+
+void aws_s3_block_cache_destroy(struct aws_s3_block_cache *block_cache) {
+    if (block_cache == NULL) {
+        return;
+    }
+
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&block_cache->synced_data.objects); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        struct aws_s3_block_cache_object *object = iter.element.value;
+        s_s3_block_cache_remove_object_blocks_synced(block_cache, object);
+        s_s3_block_cache_object_destroy(block_cache, object);
+    }
+
+    AWS_ASSERT(aws_linked_list_empty(&block_cache->synced_data.lru_blocks));
+
+    aws_hash_table_clean_up(&block_cache->synced_data.blocks);
+    aws_hash_table_clean_up(&block_cache->synced_data.objects);
+    aws_mutex_clean_up(&block_cache->synced_data.lock);
+    aws_mem_release(block_cache->allocator, block_cache);
+}
+
+uint64_t aws_s3_block_cache_num_blocks(const struct aws_s3_block_cache *block_cache, uint64_t object_size) {
+    AWS_PRECONDITION(block_cache);
+
+    return object_size / block_cache->block_size + (object_size % block_cache->block_size != 0 ? 1 : 0);
+}
+
+static struct aws_s3_block_cache_object *s_s3_block_cache_find_object_synced(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id) {
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&block_cache->synced_data.objects, &object_id, &element);
+    return element != NULL ? element->value : NULL;
+}
+
+/* Finds a block of an object that is recorded with the given ETag. */
+static struct aws_s3_block_cache_block *s_s3_block_cache_find_block_synced(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t block_index) {
+    struct aws_s3_block_cache_object *object = s_s3_block_cache_find_object_synced(block_cache, object_id);
+
+    if (object == NULL || !aws_string_eq_byte_cursor(object->etag, &etag)) {
+        return NULL;
+    }
+
+    struct aws_s3_block_cache_block_key key = {
+        .object = object,
+        .block_index = block_index,
+    };
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&block_cache->synced_data.blocks, &key, &element);
+    return element != NULL ? element->value : NULL;
+}
+
+/* Finds the object, recorded with the given ETag and size, recording it if it isn't already. Returns NULL if out of
+ * memory. */
+static struct aws_s3_block_cache_object *s_s3_block_cache_record_object_synced(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t object_size) {
+    struct aws_s3_block_cache_object *object = s_s3_block_cache_find_object_synced(block_cache, object_id);
+
+    if (object != NULL) {
+        /* The blocks of another version of the object are of no use anymore. */
+        if (!aws_string_eq_byte_cursor(object->etag, &etag)) {
+            s_s3_block_cache_remove_object_blocks_synced(block_cache, object);
+
+            aws_string_destroy(object->etag);
+            object->etag = aws_string_new_from_cursor(block_cache->allocator, &etag);
+        }
+
+        object->size = object_size;
+        return object;
+    }
+
+    object = aws_mem_calloc(block_cache->allocator, 1, sizeof(struct aws_s3_block_cache_object));
+    aws_byte_buf_init_copy_from_cursor(&object->id_buf, block_cache->allocator, object_id);
+    object->id = aws_byte_cursor_from_buf(&object->id_buf);
+    object->etag = aws_string_new_from_cursor(block_cache->allocator, &etag);
+    object->size = object_size;
+    aws_linked_list_init(&object->blocks);
+
+    if (aws_hash_table_put(&block_cache->synced_data.objects, &object->id, object, NULL)) {
+        s_s3_block_cache_object_destroy(block_cache, object);
+        return NULL;
+    }
+
+    return object;
+}
+
+bool aws_s3_block_cache_get_object(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_buf *out_etag,
+    uint64_t *out_object_size) {
+    AWS_PRECONDITION(block_cache);
+    AWS_PRECONDITION(out_etag);
+    AWS_PRECONDITION(out_object_size);
+
+    bool found = false;
+
+    aws_mutex_lock(&block_cache->synced_data.lock);
+
+    struct aws_s3_block_cache_object *object = s_s3_block_cache_find_object_synced(block_cache, object_id);
+
+    if (object != NULL) {
+        struct aws_byte_cursor etag = aws_byte_cursor_from_string(object->etag);
+        found = aws_byte_buf_append_dynamic(out_etag, &etag) == AWS_OP_SUCCESS;
+        *out_object_size = object->size;
+    }
+
+    aws_mutex_unlock(&block_cache->synced_data.lock);
+
+    return found;
+}
+
+void aws_s3_block_cache_invalidate_object(struct aws_s3_block_cache *block_cache, struct aws_byte_cursor object_id) {
+    AWS_PRECONDITION(block_cache);
+
+    aws_mutex_lock(&block_cache->synced_data.lock);
+
+    struct aws_s3_block_cache_object *object = s_s3_block_cache_find_object_synced(block_cache, object_id);
+
+    if (object != NULL) {
+        s_s3_block_cache_remove_object_blocks_synced(block_cache, object);
+        aws_hash_table_remove(&block_cache->synced_data.objects, &object->id, NULL, NULL);
+        s_s3_block_cache_object_destroy(block_cache, object);
+    }
+
+    aws_mutex_unlock(&block_cache->synced_data.lock);
+}
+
+int aws_s3_block_cache_put_block(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t object_size,
+    uint64_t block_index,
+    struct aws_byte_cursor block_bytes) {
+    AWS_PRECONDITION(block_cache);
+
+    if (block_index >= aws_s3_block_cache_num_blocks(block_cache, object_size)) {
+        return AWS_OP_SUCCESS;
+    }
+
+    const uint64_t block_start = block_index * block_cache->block_size;
+    const uint64_t expected_block_size = aws_min_u64(block_cache->block_size, object_size - block_start);
+
+    if ((uint64_t)block_bytes.len != expected_block_size || expected_block_size > block_cache->max_bytes) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int result = AWS_OP_SUCCESS;
+
+    aws_mutex_lock(&block_cache->synced_data.lock);
+
+    struct aws_s3_block_cache_object *object =
+        s_s3_block_cache_record_object_synced(block_cache, object_id, etag, object_size);
+
+    if (object == NULL) {
+        result = AWS_OP_ERR;
+        goto unlock;
+    }
+
+    struct aws_s3_block_cache_block_key key = {
+        .object = object,
+        .block_index = block_index,
+    };
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&block_cache->synced_data.blocks, &key, &element);
+
+    if (element != NULL) {
+        struct aws_s3_block_cache_block *block = element->value;
+        aws_linked_list_remove(&block->lru_node);
+        aws_linked_list_push_front(&block_cache->synced_data.lru_blocks, &block->lru_node);
+        goto unlock;
+    }
+
+    struct aws_s3_block_cache_block *block =
+        aws_mem_calloc(block_cache->allocator, 1, sizeof(struct aws_s3_block_cache_block));
+    block->key = key;
+
+    if (aws_byte_buf_init_copy_from_cursor(&block->data, block_cache->allocator, block_bytes) ||
+        aws_hash_table_put(&block_cache->synced_data.blocks, &block->key, block, NULL)) {
+        aws_byte_buf_clean_up(&block->data);
+        aws_mem_release(block_cache->allocator, block);
+
+        /* Don't keep an object around that has no blocks. */
+        if (aws_linked_list_empty(&object->blocks)) {
+            aws_hash_table_remove(&block_cache->synced_data.objects, &object->id, NULL, NULL);
+            s_s3_block_cache_object_destroy(block_cache, object);
+        }
+
+        result = AWS_OP_ERR;
+        goto unlock;
+    }
+
+    aws_linked_list_push_front(&block_cache->synced_data.lru_blocks, &block->lru_node);
+    aws_linked_list_push_back(&object->blocks, &block->object_node);
+    block_cache->synced_data.num_bytes += block->data.len;
+
+    /* Make room by evicting the least recently used blocks, which is never the one that was just put in. */
+    while (block_cache->synced_data.num_bytes > block_cache->max_bytes) {
+        struct aws_linked_list_node *node = aws_linked_list_back(&block_cache->synced_data.lru_blocks);
+        struct aws_s3_block_cache_block *lru_block = AWS_CONTAINER_OF(node, struct aws_s3_block_cache_block, lru_node);
+
+        AWS_ASSERT(lru_block != block);
+        s_s3_block_cache_remove_block_synced(block_cache, lru_block, false);
+    }
+
+unlock:
+
+    aws_mutex_unlock(&block_cache->synced_data.lock);
+
+    return result;
+}
+
+bool aws_s3_block_cache_read_block(
+    struct aws_s3_block_cache *block_cache,
+    struct aws_byte_cursor object_id,
+    struct aws_byte_cursor etag,
+    uint64_t block_index,
+    uint64_t offset,
+    uint64_t len,
+    struct aws_byte_buf *dest) {
+    AWS_PRECONDITION(block_cache);
+    AWS_PRECONDITION(dest);
+
+    bool found = false;
+
+    aws_mutex_lock(&block_cache->synced_data.lock);
+
+    struct aws_s3_block_cache_block *block =
+        s_s3_block_cache_find_block_synced(block_cache, object_id, etag, block_index);
+
+    if (block == NULL || offset > block->data.len || len > block->data.len - offset) {
+        goto unlock;
+    }
+
+    struct aws_byte_cursor slice = {
+        .ptr = block->data.buffer + offset,
+        .len = (size_t)len,
+    };
+
+    if (aws_byte_buf_append_dynamic(dest, &slice)) {
+        goto unlock;
+    }
+
+    aws_linked_list_remove(&block->lru_node);
+    aws_linked_list_push_front(&block_cache->synced_data.lru_blocks, &block->lru_node);
+
+    found = true;
+
+unlock:
+
+    aws_mutex_unlock(&block_cache->synced_data.lock);
+
+    return found;
+}
@@ -0,0 +1,247 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_buffer_pool.h"
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/ref_count.h>
+
+/* Allocator that the pool's buffers come from. It wraps the pool's allocator, over-allocating so that buffers are
+ * aligned. Buffers can outlive the pool (a request can still hold one after its client is gone), and can be grown
+ * through it after that (by aws_byte_buf_append_dynamic), so it is kept alive by every allocation made through it. */
+struct s3_aligned_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *allocator;
+    struct aws_ref_count ref_count;
+};
+
+/* Every allocation records the allocator it came from, and where it starts, right before its aligned memory. */
+struct s3_aligned_allocation_header {
+    struct s3_aligned_allocator *aligned_allocator;
+    void *allocation;
+};
+
+static void *s_s3_aligned_acquire(struct aws_allocator *allocator, size_t size) {
+    struct s3_aligned_allocator *aligned_allocator = allocator->impl;
+    const size_t padding = sizeof(struct s3_aligned_allocation_header) + AWS_S3_BUFFER_POOL_ALIGNMENT - 1;
+
+    if (size > SIZE_MAX - padding) {
+        aws_raise_error(AWS_ERROR_OOM);
+        return NULL;
+    }
+
+    uint8_t *allocation = aws_mem_acquire(aligned_allocator->allocator, size + padding);
+
+    if (allocation == NULL) {
+        return NULL;
+    }
+
+    uintptr_t aligned = ((uintptr_t)allocation + sizeof(struct s3_aligned_allocation_header) +
+                         AWS_S3_BUFFER_POOL_ALIGNMENT - 1) &
+                        ~((uintptr_t)AWS_S3_BUFFER_POOL_ALIGNMENT - 1);
+
+    struct s3_aligned_allocation_header *header = (struct s3_aligned_allocation_header *)aligned - 1;
+    header->aligned_allocator = aligned_allocator;
+    header->allocation = allocation;
+
+    aws_ref_count_acquire(&aligned_allocator->ref_count);
+
+    return (void *)aligned;
+}
+
+static void s_s3_aligned_release(struct aws_allocator *allocator, void *ptr) {
+    (void)allocator;
+
+    struct s3_aligned_allocation_header *header = (struct s3_aligned_allocation_header *)ptr - 1;
+    struct s3_aligned_allocator *aligned_allocator = header->aligned_allocator;
+
+    aws_mem_release(aligned_allocator->allocator, header->allocation);
+    aws_ref_count_release(&aligned_allocator->ref_count);
+}
+
+static void s_s3_aligned_allocator_destroy(void *user_data) {
+    struct s3_aligned_allocator *aligned_allocator = user_data;
+    aws_mem_release(aligned_allocator->allocator, aligned_allocator);
+}
+
+static struct aws_allocator *s_s3_aligned_allocator_new(struct aws_allocator *allocator) {
+    struct s3_aligned_allocator *aligned_allocator = aws_mem_calloc(allocator, 1, sizeof(struct s3_aligned_allocator));
+
+    aligned_allocator->base.mem_acquire = s_s3_aligned_acquire;
+    aligned_allocator->base.mem_release = s_s3_aligned_release;
+    aligned_allocator->base.impl = aligned_allocator;
+    aligned_allocator->allocator = allocator;
+    aws_ref_count_init(&aligned_allocator->ref_count, aligned_allocator, s_s3_aligned_allocator_destroy);
+
+    return &aligned_allocator->base;
+}
+
+/* Drops the pool's reference. Buffers still out keep the allocator alive until they are released. */
+static void s_s3_aligned_allocator_release(struct aws_allocator *allocator) {
+    struct s3_aligned_allocator *aligned_allocator = allocator->impl;
+    aws_ref_count_release(&aligned_allocator->ref_count);
+}
+
+struct aws_s3_buffer_pool *aws_s3_buffer_pool_new(
+    struct aws_allocator *allocator,
+    size_t slab_size,
+    uint64_t memory_limit,
+    size_t max_free_slabs) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_s3_buffer_pool *buffer_pool = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_buffer_pool));
+
+    buffer_pool->allocator = allocator;
+    buffer_pool->aligned_allocator = s_s3_aligned_allocator_new(allocator);
+    *((size_t *)&buffer_pool->slab_size) = slab_size;
+    *((uint64_t *)&buffer_pool->memory_limit) = memory_limit;
+    *((size_t *)&buffer_pool->max_free_slabs) = max_free_slabs;
+
+    if (aws_mutex_init(&buffer_pool->synced_data.lock)) {
+        goto error_clean_up;
+    }
+
+    if (aws_array_list_init_dynamic(&buffer_pool->synced_data.free_slabs, allocator, 16, sizeof(uint8_t *))) {
+        aws_mutex_clean_up(&buffer_pool->synced_data.lock);
+        goto error_clean_up;
+    }
+
+    return buffer_pool;
+
+error_clean_up:
+
+    s_s3_aligned_allocator_release(buffer_pool->aligned_allocator);
+    aws_mem_release(allocator, buffer_pool);
+    return NULL;
+}
+
+void aws_s3_buffer_pool_destroy(struct aws_s3_buffer_pool *buffer_pool) {
+    if (buffer_pool == NULL) {
+        return;
+    }
+
+    AWS_ASSERT(buffer_pool->synced_data.reserved == 0);
+
+    for (size_t slab_index = 0; slab_index < aws_array_list_length(&buffer_pool->synced_data.free_slabs);
+         ++slab_index) {
+        uint8_t *slab = NULL;
+        aws_array_list_get_at(&buffer_pool->synced_data.free_slabs, &slab, slab_index);
+        aws_mem_release(buffer_pool->aligned_allocator, slab);
+    }
+
+    aws_array_list_clean_up(&buffer_pool->synced_data.free_slabs);
+    aws_mutex_clean_up(&buffer_pool->synced_data.lock);
+    s_s3_aligned_allocator_release(buffer_pool->aligned_allocator);
+    aws_mem_release(buffer_pool->allocator, buffer_pool);
+}
+
+bool aws_s3_buffer_pool_try_reserve(struct aws_s3_buffer_pool *buffer_pool, size_t size) {
+    AWS_PRECONDITION(buffer_pool);
+
+    aws_mutex_lock(&buffer_pool->synced_data.lock);
+
+    bool reserved = buffer_pool->memory_limit == 0 || buffer_pool->synced_data.reserved == 0 ||
+                    (buffer_pool->synced_data.reserved + (uint64_t)size) <= buffer_pool->memory_limit;
+
+    if (reserved) {
+        buffer_pool->synced_data.reserved += (uint64_t)size;
+    }
+
+    aws_mutex_unlock(&buffer_pool->synced_data.lock);
+
+    return reserved;
+}
+
+void aws_s3_buffer_pool_release_reservation(struct aws_s3_buffer_pool *buffer_pool, size_t size) {
+    AWS_PRECONDITION(buffer_pool);
+
+    aws_mutex_lock(&buffer_pool->synced_data.lock);
+    AWS_ASSERT(buffer_pool->synced_data.reserved >= (uint64_t)size);
+    buffer_pool->synced_data.reserved -= (uint64_t)size;
+    aws_mutex_unlock(&buffer_pool->synced_data.lock);
+}
+
+uint64_t aws_s3_buffer_pool_get_reserved(struct aws_s3_buffer_pool *buffer_pool) {
+    AWS_PRECONDITION(buffer_pool);
+
+    aws_mutex_lock(&buffer_pool->synced_data.lock);
+    uint64_t reserved = buffer_pool->synced_data.reserved;
+    aws_mutex_unlock(&buffer_pool->synced_data.lock);
+
+    return reserved;
+}
+
+int aws_s3_buffer_pool_acquire_buffer(
+    struct aws_s3_buffer_pool *buffer_pool,
+    size_t capacity,
+    struct aws_byte_buf *out_buf) {
+    AWS_PRECONDITION(buffer_pool);
+    AWS_PRECONDITION(out_buf);
+
+    uint8_t *slab = NULL;
+
+    if (capacity == buffer_pool->slab_size && capacity > 0) {
+        aws_mutex_lock(&buffer_pool->synced_data.lock);
+
+        if (aws_array_list_length(&buffer_pool->synced_data.free_slabs) > 0) {
+            aws_array_list_back(&buffer_pool->synced_data.free_slabs, &slab);
+            aws_array_list_pop_back(&buffer_pool->synced_data.free_slabs);
+        }
+
+        aws_mutex_unlock(&buffer_pool->synced_data.lock);
+    }
+
+    if (slab == NULL && capacity == 0) {
+        return aws_byte_buf_init(out_buf, buffer_pool->allocator, 0);
+    }
+
+    if (slab == NULL) {
+        slab = s_s3_aligned_acquire(buffer_pool->aligned_allocator, capacity);
+
+        if (slab == NULL) {
+            AWS_ZERO_STRUCT(*out_buf);
+            return AWS_OP_ERR;
+        }
+    }
+
+    AWS_ZERO_STRUCT(*out_buf);
+    out_buf->allocator = buffer_pool->aligned_allocator;
+    out_buf->buffer = slab;
+    out_buf->capacity = capacity;
+    out_buf->len = 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_s3_buffer_pool_release_buffer(struct aws_s3_buffer_pool *buffer_pool, struct aws_byte_buf *buf) {
+    AWS_PRECONDITION(buffer_pool);
+    AWS_PRECONDITION(buf);
+
+    if (buf->buffer == NULL) {
+        AWS_ZERO_STRUCT(*buf);
+        return;
+    }
+
+    /* Only recycle buffers that are still exactly a slab, and that were allocated by this pool's aligned allocator. (A
+     * buffer that was grown by aws_byte_buf_append_dynamic will have a different capacity.) */
+    if (buf->capacity == buffer_pool->slab_size && buf->allocator == buffer_pool->aligned_allocator) {
+        bool recycled = false;
+
+        aws_mutex_lock(&buffer_pool->synced_data.lock);
+
+        if (aws_array_list_length(&buffer_pool->synced_data.free_slabs) < buffer_pool->max_free_slabs) {
+            recycled = aws_array_list_push_back(&buffer_pool->synced_data.free_slabs, &buf->buffer) == AWS_OP_SUCCESS;
+        }
+
+        aws_mutex_unlock(&buffer_pool->synced_data.lock);
+
+        if (recycled) {
+            AWS_ZERO_STRUCT(*buf);
+            return;
+        }
+    }
+
+    aws_byte_buf_clean_up(buf);
+}
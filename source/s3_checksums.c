@@ -0,0 +1,313 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_checksums.h"
+
+#include <aws/cal/hash.h>
+#include <aws/checksums/crc.h>
+#include <aws/common/encoding.h>
+
+#include <limits.h>
+
+#define AWS_S3_CRC_LEN 4
+
+static const struct aws_byte_cursor s_crc32c_algorithm_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("CRC32C");
+static const struct aws_byte_cursor s_crc32_algorithm_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("CRC32");
+static const struct aws_byte_cursor s_sha1_algorithm_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("SHA1");
+static const struct aws_byte_cursor s_sha256_algorithm_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("SHA256");
+
+static const struct aws_byte_cursor s_crc32c_header_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32c");
+static const struct aws_byte_cursor s_crc32_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32");
+static const struct aws_byte_cursor s_sha1_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha1");
+static const struct aws_byte_cursor s_sha256_header_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha256");
+
+static const struct aws_byte_cursor s_crc32c_xml_element_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ChecksumCRC32C");
+static const struct aws_byte_cursor s_crc32_xml_element_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ChecksumCRC32");
+static const struct aws_byte_cursor s_sha1_xml_element_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ChecksumSHA1");
+static const struct aws_byte_cursor s_sha256_xml_element_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ChecksumSHA256");
+
+size_t aws_s3_checksum_get_digest_size(enum aws_s3_checksum_algorithm algorithm) {
+    switch (algorithm) {
+        case AWS_SCA_CRC32C:
+        case AWS_SCA_CRC32:
+            return AWS_S3_CRC_LEN;
+        case AWS_SCA_SHA1:
+            return AWS_SHA1_LEN;
+        case AWS_SCA_SHA256:
+            return AWS_SHA256_LEN;
+        default:
+            return 0;
+    }
+}
+
+struct aws_byte_cursor aws_s3_checksum_get_algorithm_name(enum aws_s3_checksum_algorithm algorithm) {
+    switch (algorithm) {
+        case AWS_SCA_CRC32C:
+            return s_crc32c_algorithm_name;
+        case AWS_SCA_CRC32:
+            return s_crc32_algorithm_name;
+        case AWS_SCA_SHA1:
+            return s_sha1_algorithm_name;
+        case AWS_SCA_SHA256:
+            return s_sha256_algorithm_name;
+        default: {
+            struct aws_byte_cursor empty;
+            AWS_ZERO_STRUCT(empty);
+            return empty;
+        }
+    }
+}
+
+struct aws_byte_cursor aws_s3_checksum_get_header_name(enum aws_s3_checksum_algorithm algorithm) {
+    switch (algorithm) {
+        case AWS_SCA_CRC32C:
+            return s_crc32c_header_name;
+        case AWS_SCA_CRC32:
+            return s_crc32_header_name;
+        case AWS_SCA_SHA1:
+            return s_sha1_header_name;
+        case AWS_SCA_SHA256:
+            return s_sha256_header_name;
+        default: {
+            struct aws_byte_cursor empty;
+            AWS_ZERO_STRUCT(empty);
+            return empty;
+        }
+    }
+}
+
+struct aws_byte_cursor aws_s3_checksum_get_xml_element_name(enum aws_s3_checksum_algorithm algorithm) {
+    switch (algorithm) {
+        case AWS_SCA_CRC32C:
+            return s_crc32c_xml_element_name;
+        case AWS_SCA_CRC32:
+            return s_crc32_xml_element_name;
+        case AWS_SCA_SHA1:
+            return s_sha1_xml_element_name;
+        case AWS_SCA_SHA256:
+            return s_sha256_xml_element_name;
+        default: {
+            struct aws_byte_cursor empty;
+            AWS_ZERO_STRUCT(empty);
+            return empty;
+        }
+    }
+}
+
+/* CRCs are kept in the impl pointer itself. */
+static void s_crc_destroy(struct aws_s3_checksum *checksum) {
+    aws_mem_release(checksum->allocator, checksum);
+}
+
+static int s_crc_update(struct aws_s3_checksum *checksum, const struct aws_byte_cursor *input) {
+    uint32_t crc = (uint32_t)(uintptr_t)checksum->impl;
+    struct aws_byte_cursor remaining = *input;
+
+    /* The CRC functions take an int length, so big buffers go through in pieces. */
+    while (remaining.len > 0) {
+        int length = remaining.len > INT_MAX ? INT_MAX : (int)remaining.len;
+
+        if (checksum->algorithm == AWS_SCA_CRC32C) {
+            crc = aws_checksums_crc32c(remaining.ptr, length, crc);
+        } else {
+            crc = aws_checksums_crc32(remaining.ptr, length, crc);
+        }
+
+        aws_byte_cursor_advance(&remaining, (size_t)length);
+    }
+
+    checksum->impl = (void *)(uintptr_t)crc;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_crc_finalize(struct aws_s3_checksum *checksum, struct aws_byte_buf *output) {
+    if (!aws_byte_buf_write_be32(output, (uint32_t)(uintptr_t)checksum->impl)) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_s3_checksum_vtable s_crc_vtable = {
+    .destroy = s_crc_destroy,
+    .update = s_crc_update,
+    .finalize = s_crc_finalize,
+};
+
+/* SHAs wrap a hash of aws-c-cal. */
+static void s_hash_destroy(struct aws_s3_checksum *checksum) {
+    aws_hash_destroy(checksum->impl);
+    aws_mem_release(checksum->allocator, checksum);
+}
+
+static int s_hash_update(struct aws_s3_checksum *checksum, const struct aws_byte_cursor *input) {
+    return aws_hash_update(checksum->impl, input);
+}
+
+static int s_hash_finalize(struct aws_s3_checksum *checksum, struct aws_byte_buf *output) {
+    return aws_hash_finalize(checksum->impl, output, 0);
+}
+
+static struct aws_s3_checksum_vtable s_hash_vtable = {
+    .destroy = s_hash_destroy,
+    .update = s_hash_update,
+    .finalize = s_hash_finalize,
+};
+
+struct aws_s3_checksum *aws_s3_checksum_new(struct aws_allocator *allocator, enum aws_s3_checksum_algorithm algorithm) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_s3_checksum_vtable *vtable = NULL;
+    struct aws_hash *hash = NULL;
+
+    switch (algorithm) {
+        case AWS_SCA_CRC32C:
+        case AWS_SCA_CRC32:
+            vtable = &s_crc_vtable;
+            break;
+        case AWS_SCA_SHA1:
+            hash = aws_sha1_new(allocator);
+            vtable = &s_hash_vtable;
+            break;
+        case AWS_SCA_SHA256:
+            hash = aws_sha256_new(allocator);
+            vtable = &s_hash_vtable;
+            break;
+        default:
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            return NULL;
+    }
+
+    if (vtable == &s_hash_vtable && hash == NULL) {
+        return NULL;
+    }
+
+    struct aws_s3_checksum *checksum = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_checksum));
+    checksum->allocator = allocator;
+    checksum->vtable = vtable;
+    checksum->impl = hash;
+    checksum->algorithm = algorithm;
+    checksum->digest_size = aws_s3_checksum_get_digest_size(algorithm);
+    checksum->good = true;
+
+    return checksum;
+}
+
+void aws_s3_checksum_destroy(struct aws_s3_checksum *checksum) {
+    if (checksum == NULL) {
+        return;
+    }
+
+    checksum->vtable->destroy(checksum);
+}
+
+int aws_s3_checksum_update(struct aws_s3_checksum *checksum, const struct aws_byte_cursor *input) {
+    AWS_PRECONDITION(checksum);
+    AWS_PRECONDITION(input);
+
+    if (!checksum->good) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    return checksum->vtable->update(checksum, input);
+}
+
+int aws_s3_checksum_finalize(struct aws_s3_checksum *checksum, struct aws_byte_buf *output) {
+    AWS_PRECONDITION(checksum);
+    AWS_PRECONDITION(output);
+
+    if (!checksum->good) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    if (output->capacity - output->len < checksum->digest_size) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    checksum->good = false;
+    return checksum->vtable->finalize(checksum, output);
+}
+
+static int s_s3_checksum_compute_gathered(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_byte_buf *output) {
+
+    struct aws_s3_checksum *checksum = aws_s3_checksum_new(allocator, algorithm);
+
+    if (checksum == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+
+    for (size_t segment_index = 0; segment_index < num_segments; ++segment_index) {
+        if (aws_s3_checksum_update(checksum, &segments[segment_index])) {
+            goto clean_up;
+        }
+    }
+
+    if (aws_s3_checksum_finalize(checksum, output) == AWS_OP_SUCCESS) {
+        result = AWS_OP_SUCCESS;
+    }
+
+clean_up:
+
+    aws_s3_checksum_destroy(checksum);
+    return result;
+}
+
+int aws_s3_checksum_compute(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *input,
+    struct aws_byte_buf *output) {
+    AWS_PRECONDITION(input);
+    AWS_PRECONDITION(output);
+
+    return s_s3_checksum_compute_gathered(allocator, algorithm, input, 1, output);
+}
+
+int aws_s3_checksum_compute_base64(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *input,
+    struct aws_byte_buf *output) {
+    AWS_PRECONDITION(input);
+    AWS_PRECONDITION(output);
+
+    return aws_s3_checksum_compute_base64_gathered(allocator, algorithm, input, 1, output);
+}
+
+int aws_s3_checksum_compute_base64_gathered(
+    struct aws_allocator *allocator,
+    enum aws_s3_checksum_algorithm algorithm,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_byte_buf *output) {
+    AWS_PRECONDITION(segments || num_segments == 0);
+    AWS_PRECONDITION(output);
+
+    uint8_t digest[AWS_SHA256_LEN];
+    struct aws_byte_buf digest_buf = aws_byte_buf_from_empty_array(digest, sizeof(digest));
+
+    if (s_s3_checksum_compute_gathered(allocator, algorithm, segments, num_segments, &digest_buf)) {
+        return AWS_OP_ERR;
+    }
+
+    size_t encoded_len = 0;
+
+    if (aws_base64_compute_encoded_len(digest_buf.len, &encoded_len) ||
+        aws_byte_buf_reserve_relative(output, encoded_len)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor digest_cursor = aws_byte_cursor_from_buf(&digest_buf);
+    return aws_base64_encode(&digest_cursor, output);
+}
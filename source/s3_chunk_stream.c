@@ -0,0 +1,278 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_chunk_stream.h"
+#include "aws/s3/private/s3_checksums.h"
+
+#include <aws/common/encoding.h>
+#include <aws/io/stream.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+/*
+ * The encoded stream is made of three segments:
+ *     "<body length in hex>\r\n"                         (prefix, left out for an empty body)
+ *     <body>
+ *     "\r\n0\r\n<checksum header>:<checksum>\r\n\r\n"    (trailer, without the leading "\r\n" for an empty body)
+ */
+static const struct aws_byte_cursor s_chunk_separator = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("\r\n");
+static const struct aws_byte_cursor s_final_chunk = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("0\r\n");
+static const struct aws_byte_cursor s_trailer_separator = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL(":");
+
+struct aws_s3_chunk_stream_impl {
+    struct aws_byte_cursor body;
+    enum aws_s3_checksum_algorithm checksum_algorithm;
+
+    /* Running checksum of the body read so far. NULL once the trailer has been built. */
+    struct aws_s3_checksum *checksum;
+
+    /* Base64 encoded checksum of the body, once all of it has been read. */
+    struct aws_byte_buf encoded_checksum;
+
+    struct aws_byte_buf prefix;
+
+    /* Built once all of the body has been read. */
+    struct aws_byte_buf trailer;
+    size_t trailer_length;
+
+    uint64_t position;
+    uint64_t length;
+};
+
+static size_t s_s3_chunk_stream_encoded_checksum_length(enum aws_s3_checksum_algorithm checksum_algorithm) {
+    return 4 * ((aws_s3_checksum_get_digest_size(checksum_algorithm) + 2) / 3);
+}
+
+static size_t s_s3_chunk_stream_trailer_length(size_t body_length, enum aws_s3_checksum_algorithm checksum_algorithm) {
+    return (body_length > 0 ? s_chunk_separator.len : 0) + s_final_chunk.len +
+           aws_s3_checksum_get_header_name(checksum_algorithm).len + s_trailer_separator.len +
+           s_s3_chunk_stream_encoded_checksum_length(checksum_algorithm) + s_chunk_separator.len * 2;
+}
+
+uint64_t aws_s3_chunk_stream_compute_length(size_t body_length, enum aws_s3_checksum_algorithm checksum_algorithm) {
+    uint64_t length = (uint64_t)s_s3_chunk_stream_trailer_length(body_length, checksum_algorithm);
+
+    if (body_length > 0) {
+        char prefix[32] = "";
+        int prefix_length = snprintf(prefix, sizeof(prefix), "%" PRIx64 "\r\n", (uint64_t)body_length);
+        length += (uint64_t)prefix_length + (uint64_t)body_length;
+    }
+
+    return length;
+}
+
+/* Finish the checksum and build the trailer, once the body has been read. */
+static int s_s3_chunk_stream_build_trailer(struct aws_s3_chunk_stream_impl *impl) {
+    uint8_t digest[AWS_SHA256_LEN];
+    struct aws_byte_buf digest_buf = aws_byte_buf_from_empty_array(digest, sizeof(digest));
+
+    if (aws_s3_checksum_finalize(impl->checksum, &digest_buf)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_s3_checksum_destroy(impl->checksum);
+    impl->checksum = NULL;
+
+    struct aws_byte_cursor digest_cursor = aws_byte_cursor_from_buf(&digest_buf);
+    aws_byte_buf_reset(&impl->encoded_checksum, false);
+
+    if (aws_base64_encode(&digest_cursor, &impl->encoded_checksum)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor header_name = aws_s3_checksum_get_header_name(impl->checksum_algorithm);
+    struct aws_byte_cursor encoded_checksum = aws_byte_cursor_from_buf(&impl->encoded_checksum);
+
+    aws_byte_buf_reset(&impl->trailer, false);
+
+    if ((impl->body.len > 0 && aws_byte_buf_append_dynamic(&impl->trailer, &s_chunk_separator)) ||
+        aws_byte_buf_append_dynamic(&impl->trailer, &s_final_chunk) ||
+        aws_byte_buf_append_dynamic(&impl->trailer, &header_name) ||
+        aws_byte_buf_append_dynamic(&impl->trailer, &s_trailer_separator) ||
+        aws_byte_buf_append_dynamic(&impl->trailer, &encoded_checksum) ||
+        aws_byte_buf_append_dynamic(&impl->trailer, &s_chunk_separator) ||
+        aws_byte_buf_append_dynamic(&impl->trailer, &s_chunk_separator)) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_FATAL_ASSERT(impl->trailer.len == impl->trailer_length);
+    return AWS_OP_SUCCESS;
+}
+
+/* Copy as much of segment as fits into dest, starting at offset into the segment. Returns the number of bytes
+ * copied. */
+static size_t s_s3_chunk_stream_copy_segment(
+    struct aws_byte_cursor segment,
+    uint64_t offset,
+    struct aws_byte_buf *dest) {
+
+    aws_byte_cursor_advance(&segment, (size_t)offset);
+
+    size_t num_bytes = aws_min_size(segment.len, dest->capacity - dest->len);
+    segment.len = num_bytes;
+    aws_byte_buf_write_from_whole_cursor(dest, segment);
+
+    return num_bytes;
+}
+
+static int s_s3_chunk_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct aws_s3_chunk_stream_impl *impl = stream->impl;
+
+    const uint64_t prefix_end = impl->prefix.len;
+    const uint64_t body_end = prefix_end + impl->body.len;
+
+    while (dest->len < dest->capacity && impl->position < impl->length) {
+        if (impl->position < prefix_end) {
+            impl->position +=
+                s_s3_chunk_stream_copy_segment(aws_byte_cursor_from_buf(&impl->prefix), impl->position, dest);
+        } else if (impl->position < body_end) {
+            size_t start = dest->len;
+            impl->position += s_s3_chunk_stream_copy_segment(impl->body, impl->position - prefix_end, dest);
+
+            struct aws_byte_cursor body_read = {
+                .ptr = dest->buffer + start,
+                .len = dest->len - start,
+            };
+
+            if (aws_s3_checksum_update(impl->checksum, &body_read)) {
+                return AWS_OP_ERR;
+            }
+        } else {
+            if (impl->checksum != NULL && s_s3_chunk_stream_build_trailer(impl)) {
+                return AWS_OP_ERR;
+            }
+
+            impl->position += s_s3_chunk_stream_copy_segment(
+                aws_byte_cursor_from_buf(&impl->trailer), impl->position - body_end, dest);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_chunk_stream_seek(struct aws_input_stream *stream, int64_t offset, enum aws_stream_seek_basis basis) {
+    struct aws_s3_chunk_stream_impl *impl = stream->impl;
+
+    /* The checksum can't be rewound, so it has to start over along with the stream. */
+    if (offset != 0 || basis != AWS_SSB_BEGIN) {
+        return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+    }
+
+    struct aws_s3_checksum *checksum = aws_s3_checksum_new(stream->allocator, impl->checksum_algorithm);
+
+    if (checksum == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    aws_s3_checksum_destroy(impl->checksum);
+    impl->checksum = checksum;
+    impl->position = 0;
+    aws_byte_buf_reset(&impl->trailer, false);
+    aws_byte_buf_reset(&impl->encoded_checksum, false);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_chunk_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct aws_s3_chunk_stream_impl *impl = stream->impl;
+
+    status->is_end_of_stream = impl->position == impl->length;
+    status->is_valid = true;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_chunk_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct aws_s3_chunk_stream_impl *impl = stream->impl;
+
+    *out_length = (int64_t)impl->length;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_s3_chunk_stream_destroy(struct aws_input_stream *stream) {
+    struct aws_s3_chunk_stream_impl *impl = stream->impl;
+
+    aws_s3_checksum_destroy(impl->checksum);
+    aws_byte_buf_clean_up(&impl->encoded_checksum);
+    aws_byte_buf_clean_up(&impl->prefix);
+    aws_byte_buf_clean_up(&impl->trailer);
+
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_input_stream_vtable s_s3_chunk_stream_vtable = {
+    .seek = s_s3_chunk_stream_seek,
+    .read = s_s3_chunk_stream_read,
+    .get_status = s_s3_chunk_stream_get_status,
+    .get_length = s_s3_chunk_stream_get_length,
+    .destroy = s_s3_chunk_stream_destroy,
+};
+
+struct aws_input_stream *aws_s3_chunk_stream_new(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor body,
+    enum aws_s3_checksum_algorithm checksum_algorithm) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_input_stream *stream = NULL;
+    struct aws_s3_chunk_stream_impl *impl = NULL;
+
+    aws_mem_acquire_many(
+        allocator, 2, &stream, sizeof(struct aws_input_stream), &impl, sizeof(struct aws_s3_chunk_stream_impl));
+    AWS_ZERO_STRUCT(*stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    stream->allocator = allocator;
+    stream->vtable = &s_s3_chunk_stream_vtable;
+    stream->impl = impl;
+
+    impl->body = body;
+    impl->checksum_algorithm = checksum_algorithm;
+    impl->trailer_length = s_s3_chunk_stream_trailer_length(body.len, checksum_algorithm);
+    impl->length = aws_s3_chunk_stream_compute_length(body.len, checksum_algorithm);
+
+    impl->checksum = aws_s3_checksum_new(allocator, checksum_algorithm);
+
+    if (impl->checksum == NULL) {
+        goto error_clean_up;
+    }
+
+    if (aws_byte_buf_init(&impl->encoded_checksum, allocator, 64) ||
+        aws_byte_buf_init(&impl->trailer, allocator, impl->trailer_length) ||
+        aws_byte_buf_init(&impl->prefix, allocator, 32)) {
+        goto error_clean_up;
+    }
+
+    if (body.len > 0) {
+        impl->prefix.len = (size_t)snprintf(
+            (char *)impl->prefix.buffer, impl->prefix.capacity, "%" PRIx64 "\r\n", (uint64_t)body.len);
+    }
+
+    return stream;
+
+error_clean_up:
+
+    s_s3_chunk_stream_destroy(stream);
+    return NULL;
+}
+
+int aws_s3_chunk_stream_get_checksum(struct aws_input_stream *stream, struct aws_byte_buf *out_encoded_checksum) {
+    AWS_PRECONDITION(stream);
+    AWS_PRECONDITION(out_encoded_checksum);
+
+    if (stream->vtable != &s_s3_chunk_stream_vtable) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct aws_s3_chunk_stream_impl *impl = stream->impl;
+
+    if (impl->checksum != NULL) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    struct aws_byte_cursor encoded_checksum = aws_byte_cursor_from_buf(&impl->encoded_checksum);
+    return aws_byte_buf_append_dynamic(out_encoded_checksum, &encoded_checksum);
+}
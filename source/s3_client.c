@@ -5,9 +5,14 @@
 
 #include "aws/s3/private/s3_auto_ranged_get.h"
 #include "aws/s3/private/s3_auto_ranged_put.h"
+#include "aws/s3/private/s3_block_cache.h"
+#include "aws/s3/private/s3_buffer_pool.h"
+#include "aws/s3/private/s3_client_context.h"
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_default_meta_request.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_request_pool.h"
+#include "aws/s3/private/s3_slow_down_throttle.h"
 #include "aws/s3/private/s3_util.h"
 
 #include <aws/auth/credentials.h>
@@ -49,7 +54,7 @@ static const enum aws_log_level s_log_level_client_stats = AWS_LL_INFO;
 static const uint32_t s_max_requests_multiplier = 4;
 
 /* TODO Provide analysis on origins of this value. */
-static const double s_throughput_per_vip_gbps = 4.0;
+const double g_throughput_per_vip_gbps = 4.0;
 
 /* Preferred amount of active connections per meta request type. */
 const uint32_t g_num_conns_per_vip_meta_request_look_up[AWS_S3_META_REQUEST_TYPE_MAX] = {
@@ -62,6 +67,21 @@ const uint32_t g_num_conns_per_vip_meta_request_look_up[AWS_S3_META_REQUEST_TYPE
 /* Should be max of s_num_conns_per_vip_meta_request_look_up */
 const uint32_t g_max_num_connections_per_vip = 10;
 
+/* How often the adaptive connection controller re-evaluates the connection limit. */
+static const uint64_t s_connection_controller_sample_interval_ns = 1000000000ULL;
+
+/* Number of connections added per interval while more connections are still paying off. */
+static const uint32_t s_connection_controller_additive_increase = 2;
+
+/* Factor to scale the connection limit by when SlowDown responses were received during an interval. */
+static const double s_connection_controller_multiplicative_decrease = 0.75;
+
+/* Allowed drop in per-connection throughput after growing the limit that still counts as growth paying off. */
+static const double s_connection_controller_throughput_tolerance = 0.1;
+
+/* Unless configured otherwise, how many times the static connection limit the controller can grow to. */
+static const uint32_t s_connection_controller_max_growth = 4;
+
 /**
  * Default part size is 8 MB to reach the best performance from the experiments we had.
  * Default max part size is SIZE_MAX at 32bit build, which is around 4GB, which is 5GB at 64bit build.
@@ -74,6 +94,7 @@ static const size_t s_default_part_size = 8 * 1024 * 1024;
 static const uint64_t s_default_max_part_size = SIZE_MAX < 5000000000000ULL ? SIZE_MAX : 5000000000000ULL;
 static const double s_default_throughput_target_gbps = 10.0;
 static const uint32_t s_default_max_retries = 5;
+static const size_t s_default_block_cache_block_size = 1024 * 1024;
 static size_t s_dns_host_address_ttl_seconds = 5 * 60;
 
 /* Called when ref count is 0. */
@@ -85,6 +106,9 @@ static void s_s3_client_finish_destroy_default(struct aws_s3_client *client);
 /* Called when the body streaming elg shutdown has completed. */
 static void s_s3_client_body_streaming_elg_shutdown(void *user_data);
 
+/* Called when the shutdown of one of the CPU group event loop groups has completed. */
+static void s_s3_client_cpu_group_elg_shutdown(void *user_data);
+
 static void s_s3_client_create_connection_for_request(struct aws_s3_client *client, struct aws_s3_request *request);
 
 /* Callback which handles the HTTP connection retrieved by acquire_http_connection. */
@@ -94,19 +118,45 @@ static void s_s3_client_on_acquire_http_connection(
     void *user_data);
 
 static void s_s3_client_push_meta_request_synced(
-    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard,
     struct aws_s3_meta_request *meta_request);
 
-/* Schedule task for processing work. (Calls the corresponding vtable function.) */
+/* Schedule task for processing client wide work on work shard 0. Requires the client lock to be held. */
 static void s_s3_client_schedule_process_work_synced(struct aws_s3_client *client);
 
+/* Schedule task for processing work on the given work shard. (Calls the corresponding vtable function.) Requires the
+ * work shard's lock to be held. */
+static void s_s3_client_work_shard_schedule_process_work_synced(struct aws_s3_client_work_shard *work_shard);
+
+/* Schedule task for processing work on the given work shard, taking the work shard's lock. */
+static void s_s3_client_work_shard_schedule_process_work(struct aws_s3_client_work_shard *work_shard);
+
+/* Schedule the given work shard, along with any other work shards that are waiting for client wide capacity. Called
+ * whenever a request gives back capacity (a connection, a request slot, memory). */
+static void s_s3_client_schedule_process_work_capacity_released(
+    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard);
+
+static void s_s3_client_work_shard_wait_for_capacity(
+    struct aws_s3_client_work_shard *work_shard,
+    size_t capacity_release_count);
+
+/* Start the adaptive connection controller's periodic task, if it isn't running already. */
+static void s_s3_client_schedule_connection_controller(struct aws_s3_client *client);
+
+/* Schedule work processing on the given work shard again after delay_ns, for requests held back by a SlowDown
+ * throttle. */
+static void s_s3_client_work_shard_wait_for_throttle_threaded(
+    struct aws_s3_client_work_shard *work_shard,
+    uint64_t delay_ns);
+
 /* Default implementation for scheduling processing of work. */
-static void s_s3_client_schedule_process_work_synced_default(struct aws_s3_client *client);
+static void s_s3_client_schedule_process_work_synced_default(struct aws_s3_client_work_shard *work_shard);
 
 /* Actual task function that processes work. */
 static void s_s3_client_process_work_task(struct aws_task *task, void *arg, enum aws_task_status task_status);
 
-static void s_s3_client_process_work_default(struct aws_s3_client *client);
+static void s_s3_client_process_work_default(struct aws_s3_client_work_shard *work_shard);
 
 static bool s_s3_client_endpoint_ref_count_zero(struct aws_s3_endpoint *endpoint);
 
@@ -132,6 +182,42 @@ void aws_s3_set_dns_ttl(size_t ttl) {
     s_dns_host_address_ttl_seconds = ttl;
 }
 
+/* Returns the statically determined connection limit: what the throughput target allows, capped by the override and
+ * the whole budget of the client's client context. */
+static uint32_t s_s3_client_get_static_max_connections(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+
+    uint32_t num_vips = client->ideal_vip_count > 0 ? client->ideal_vip_count : 1;
+    uint32_t max_connections = num_vips * g_max_num_connections_per_vip;
+
+    if (client->max_active_connections_override > 0 && client->max_active_connections_override < max_connections) {
+        max_connections = client->max_active_connections_override;
+    }
+
+    if (client->client_context != NULL && client->client_context->max_active_connections > 0 &&
+        client->client_context->max_active_connections < max_connections) {
+        max_connections = client->client_context->max_active_connections;
+    }
+
+    return max_connections;
+}
+
+/* Returns the most connections the client can ever have active at once: the static limit, or the adaptive controller's
+ * ceiling when that is higher. Unlike aws_s3_client_get_max_active_connections, this doesn't depend on how many other
+ * clients of the context are busy, or on where the adaptive controller currently is, so it is what anything sized once
+ * for the client's lifetime (connection managers, free buffers, recycled requests) is sized with. */
+uint32_t aws_s3_client_get_max_connections_budget(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+
+    uint32_t max_connections = s_s3_client_get_static_max_connections(client);
+
+    if (client->enable_adaptive_connections && client->max_adaptive_connections > max_connections) {
+        max_connections = client->max_adaptive_connections;
+    }
+
+    return max_connections;
+}
+
 /* Returns the max number of connections allowed.
  *
  * When meta request is NULL, this will return the overall allowed number of connections.
@@ -170,11 +256,33 @@ uint32_t aws_s3_client_get_max_active_connections(
 
     uint32_t max_active_connections = num_vips * num_connections_per_vip;
 
+    /* Scale the limit by how far the adaptive controller has moved the client's overall limit away from the limit the
+     * throughput target gives. */
+    if (client->enable_adaptive_connections) {
+        uint32_t max_allowed_connections = (uint32_t)aws_atomic_load_int(&client->max_allowed_connections);
+        uint32_t ideal_vip_count = client->ideal_vip_count > 0 ? client->ideal_vip_count : 1;
+
+        if (max_allowed_connections > 0) {
+            uint64_t scaled_max_active_connections = (uint64_t)max_active_connections * max_allowed_connections /
+                                                     ((uint64_t)ideal_vip_count * g_max_num_connections_per_vip);
+            max_active_connections =
+                scaled_max_active_connections > 0 ? (uint32_t)scaled_max_active_connections : 1;
+        }
+    }
+
     if (client->max_active_connections_override > 0 &&
         client->max_active_connections_override < max_active_connections) {
         max_active_connections = client->max_active_connections_override;
     }
 
+    if (client->client_context != NULL) {
+        uint32_t connection_share = aws_s3_client_context_get_connection_share(client->client_context, client);
+
+        if (connection_share < max_active_connections) {
+            max_active_connections = connection_share;
+        }
+    }
+
     return max_active_connections;
 }
 
@@ -209,6 +317,57 @@ static uint32_t s_s3_client_get_num_requests_network_io(
     return num_requests_network_io;
 }
 
+static int s_s3_client_work_shard_init(
+    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard,
+    uint32_t index,
+    struct aws_event_loop *event_loop) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(work_shard);
+    AWS_PRECONDITION(event_loop);
+
+    if (aws_mutex_init(&work_shard->synced_data.lock)) {
+        return AWS_OP_ERR;
+    }
+
+    work_shard->client = client;
+    work_shard->event_loop = event_loop;
+    *((uint32_t *)&work_shard->index) = index;
+    aws_atomic_init_int(&work_shard->waiting_for_capacity, 0);
+
+    aws_linked_list_init(&work_shard->synced_data.pending_meta_request_work);
+    aws_linked_list_init(&work_shard->synced_data.prepared_requests);
+
+    aws_linked_list_init(&work_shard->threaded_data.meta_requests);
+
+    for (uint32_t priority = 0; priority < AWS_S3_META_REQUEST_PRIORITY_MAX; ++priority) {
+        aws_linked_list_init(&work_shard->threaded_data.request_queues[priority]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_s3_client_clean_up_work_shards(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+
+    if (client->work_shards == NULL) {
+        return;
+    }
+
+    for (uint32_t shard_index = 0; shard_index < client->num_work_shards; ++shard_index) {
+        struct aws_s3_client_work_shard *work_shard = &client->work_shards[shard_index];
+
+        AWS_ASSERT(aws_linked_list_empty(&work_shard->synced_data.pending_meta_request_work));
+        AWS_ASSERT(aws_linked_list_empty(&work_shard->threaded_data.meta_requests));
+
+        aws_mutex_clean_up(&work_shard->synced_data.lock);
+    }
+
+    aws_mem_release(client->allocator, client->work_shards);
+    client->work_shards = NULL;
+    *((uint32_t *)&client->num_work_shards) = 0;
+}
+
 void aws_s3_client_lock_synced_data(struct aws_s3_client *client) {
     aws_mutex_lock(&client->synced_data.lock);
 }
@@ -217,6 +376,250 @@ void aws_s3_client_unlock_synced_data(struct aws_s3_client *client) {
     aws_mutex_unlock(&client->synced_data.lock);
 }
 
+void aws_s3_client_work_shard_lock_synced_data(struct aws_s3_client_work_shard *work_shard) {
+    aws_mutex_lock(&work_shard->synced_data.lock);
+}
+
+void aws_s3_client_work_shard_unlock_synced_data(struct aws_s3_client_work_shard *work_shard) {
+    aws_mutex_unlock(&work_shard->synced_data.lock);
+}
+
+/* Looks up the platform info of the instance type given in the client config, or, if there is none, of the detected
+ * one when detection is enabled. */
+static const struct aws_s3_compute_platform_info *s_s3_client_get_platform_info(
+    struct aws_s3_client *client,
+    const struct aws_s3_client_config *client_config) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(client_config);
+
+    if (client_config->instance_type.len > 0) {
+        return aws_s3_get_compute_platform_info_for_instance_type(client_config->instance_type);
+    }
+
+    if (!client_config->enable_instance_type_detection) {
+        return NULL;
+    }
+
+    struct aws_string *instance_type = aws_s3_detect_instance_type(client->allocator);
+
+    if (instance_type == NULL) {
+        AWS_LOGF_INFO(
+            AWS_LS_S3_CLIENT,
+            "id=%p Could not detect instance type, using defaults. (error %d: %s)",
+            (void *)client,
+            aws_last_error(),
+            aws_error_str(aws_last_error()));
+        return NULL;
+    }
+
+    const struct aws_s3_compute_platform_info *platform_info =
+        aws_s3_get_compute_platform_info_for_instance_type(aws_byte_cursor_from_string(instance_type));
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_CLIENT,
+        "id=%p Client running on detected instance type %s, which is %s.",
+        (void *)client,
+        aws_string_c_str(instance_type),
+        platform_info != NULL ? "known" : "unknown, using defaults");
+
+    aws_string_destroy(instance_type);
+    return platform_info;
+}
+
+/* Picks the CPU groups to pin work to, and creates an event loop group, bootstrap and body streaming event loop group
+ * for each of them. Does nothing unless enable_cpu_group_affinity is set and there is more than one CPU group. */
+static int s_s3_client_init_cpu_groups(struct aws_s3_client *client, const struct aws_s3_client_config *client_config) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(client_config);
+
+    uint16_t num_system_cpu_groups = aws_get_cpu_group_count();
+
+    if (!client_config->enable_cpu_group_affinity || num_system_cpu_groups < 2) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int result = AWS_OP_ERR;
+    uint16_t *cpu_group_ids = aws_mem_calloc(client->allocator, num_system_cpu_groups, sizeof(uint16_t));
+    uint32_t num_cpu_groups = 0;
+
+    /* If we know the platform, keep network I/O on the CPU groups that have a NIC attached. */
+    const struct aws_s3_compute_platform_info *platform_info = client->platform_info;
+
+    if (platform_info != NULL) {
+        for (size_t i = 0; i < platform_info->cpu_group_info_array_length; ++i) {
+            const struct aws_s3_cpu_group_info *cpu_group_info = &platform_info->cpu_group_info_array[i];
+
+            if (cpu_group_info->nic_name_array_length > 0 && cpu_group_info->cpu_group < num_system_cpu_groups &&
+                num_cpu_groups < num_system_cpu_groups) {
+                cpu_group_ids[num_cpu_groups++] = cpu_group_info->cpu_group;
+            }
+        }
+    }
+
+    if (num_cpu_groups == 0) {
+        for (uint16_t cpu_group = 0; cpu_group < num_system_cpu_groups; ++cpu_group) {
+            cpu_group_ids[num_cpu_groups++] = cpu_group;
+        }
+    }
+
+    /* Spread the same number of threads that the client bootstrap's ELG has over the CPU groups picked above, so that
+     * only using the NIC attached groups doesn't leave the client with fewer threads. */
+    size_t num_event_loops = aws_array_list_length(&client->client_bootstrap->event_loop_group->event_loops);
+    uint16_t num_threads_per_group = (uint16_t)((num_event_loops + num_cpu_groups - 1) / num_cpu_groups);
+
+    if (num_threads_per_group < 1) {
+        num_threads_per_group = 1;
+    }
+
+    struct aws_shutdown_callback_options elg_shutdown_options = {
+        .shutdown_callback_fn = s_s3_client_cpu_group_elg_shutdown,
+        .shutdown_callback_user_data = client,
+    };
+
+    client->cpu_groups = aws_mem_calloc(client->allocator, num_cpu_groups, sizeof(struct aws_s3_client_cpu_group));
+
+    for (uint32_t group_index = 0; group_index < num_cpu_groups; ++group_index) {
+        struct aws_s3_client_cpu_group *cpu_group = &client->cpu_groups[group_index];
+        *((uint32_t *)&cpu_group->index) = group_index;
+        *((uint16_t *)&cpu_group->cpu_group) = cpu_group_ids[group_index];
+
+        /* Count the group first, so that a failure part way through releases whatever it did create. */
+        ++(*((uint32_t *)&client->num_cpu_groups));
+
+        cpu_group->event_loop_group = aws_event_loop_group_new_default_pinned_to_cpu_group(
+            client->allocator, num_threads_per_group, cpu_group->cpu_group, &elg_shutdown_options);
+
+        if (cpu_group->event_loop_group == NULL) {
+            goto clean_up;
+        }
+
+        ++client->synced_data.num_cpu_group_elgs_allocated;
+
+        cpu_group->body_streaming_elg = aws_event_loop_group_new_default_pinned_to_cpu_group(
+            client->allocator, num_threads_per_group, cpu_group->cpu_group, &elg_shutdown_options);
+
+        if (cpu_group->body_streaming_elg == NULL) {
+            goto clean_up;
+        }
+
+        ++client->synced_data.num_cpu_group_elgs_allocated;
+
+        struct aws_client_bootstrap_options bootstrap_options = {
+            .event_loop_group = cpu_group->event_loop_group,
+            .host_resolver = client->client_bootstrap->host_resolver,
+        };
+
+        cpu_group->client_bootstrap = aws_client_bootstrap_new(client->allocator, &bootstrap_options);
+
+        if (cpu_group->client_bootstrap == NULL) {
+            goto clean_up;
+        }
+
+        AWS_LOGF_INFO(
+            AWS_LS_S3_CLIENT,
+            "id=%p Client pinning work to CPU group %d with %d threads.",
+            (void *)client,
+            (int)cpu_group->cpu_group,
+            (int)num_threads_per_group);
+    }
+
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+
+    aws_mem_release(client->allocator, cpu_group_ids);
+    return result;
+}
+
+/* Releases the client's references to the event loop groups and bootstraps of its CPU groups. They finish shutting
+ * down once the connection managers using them are gone, which is tracked by num_cpu_group_elgs_allocated. */
+static void s_s3_client_release_cpu_groups(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+
+    for (uint32_t group_index = 0; group_index < client->num_cpu_groups; ++group_index) {
+        struct aws_s3_client_cpu_group *cpu_group = &client->cpu_groups[group_index];
+
+        aws_client_bootstrap_release(cpu_group->client_bootstrap);
+        cpu_group->client_bootstrap = NULL;
+
+        aws_event_loop_group_release(cpu_group->event_loop_group);
+        cpu_group->event_loop_group = NULL;
+
+        aws_event_loop_group_release(cpu_group->body_streaming_elg);
+        cpu_group->body_streaming_elg = NULL;
+    }
+}
+
+static void s_s3_client_clean_up_cpu_groups(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+
+    if (client->cpu_groups == NULL) {
+        return;
+    }
+
+    s_s3_client_release_cpu_groups(client);
+
+    for (uint32_t group_index = 0; group_index < client->num_cpu_groups; ++group_index) {
+        aws_s3_buffer_pool_destroy(client->cpu_groups[group_index].buffer_pool);
+        client->cpu_groups[group_index].buffer_pool = NULL;
+    }
+
+    aws_mem_release(client->allocator, client->cpu_groups);
+    client->cpu_groups = NULL;
+    *((uint32_t *)&client->num_cpu_groups) = 0;
+}
+
+/* Returns the work shard that schedules the given meta request. Meta requests that were not made through
+ * aws_s3_client_make_meta_request (such as in tests) belong to the first work shard. */
+static struct aws_s3_client_work_shard *s_s3_client_get_work_shard(
+    struct aws_s3_client *client,
+    struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(client->work_shards);
+
+    if (meta_request != NULL && meta_request->work_shard != NULL) {
+        return meta_request->work_shard;
+    }
+
+    return &client->work_shards[0];
+}
+
+void aws_s3_client_get_metrics(struct aws_s3_client *client, struct aws_s3_client_metrics *out_metrics) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(out_metrics);
+
+    AWS_ZERO_STRUCT(*out_metrics);
+
+    out_metrics->num_requests_in_flight = (uint32_t)aws_atomic_load_int(&client->stats.num_requests_in_flight);
+
+    for (uint32_t i = 0; i < (uint32_t)AWS_S3_META_REQUEST_TYPE_MAX; ++i) {
+        out_metrics->num_requests_network_io[i] =
+            s_s3_client_get_num_requests_network_io(client, (enum aws_s3_meta_request_type)i);
+        out_metrics->num_active_connections += out_metrics->num_requests_network_io[i];
+    }
+
+    /* Without a meta request, this only reads atomics and fixed values, including the client's share of its client
+     * context's budget, so it doesn't contend with scheduling. */
+    out_metrics->max_active_connections = aws_s3_client_get_max_active_connections(client, NULL);
+    out_metrics->num_requests_stream_queued_waiting =
+        (uint32_t)aws_atomic_load_int(&client->stats.num_requests_stream_queued_waiting);
+    out_metrics->num_requests_streaming = (uint32_t)aws_atomic_load_int(&client->stats.num_requests_streaming);
+    out_metrics->num_bytes_transferred = (uint64_t)aws_atomic_load_int(&client->stats.num_bytes_transferred);
+    out_metrics->num_slow_down_errors = (uint64_t)aws_atomic_load_int(&client->stats.num_slow_down_errors);
+}
+
+struct aws_s3_buffer_pool *aws_s3_client_get_part_buffer_pool(
+    struct aws_s3_client *client,
+    struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(client);
+
+    if (meta_request != NULL && meta_request->cpu_group != NULL && meta_request->cpu_group->buffer_pool != NULL) {
+        return meta_request->cpu_group->buffer_pool;
+    }
+
+    return client->buffer_pool;
+}
+
 struct aws_s3_client *aws_s3_client_new(
     struct aws_allocator *allocator,
     const struct aws_s3_client_config *client_config) {
@@ -263,12 +666,9 @@ struct aws_s3_client *aws_s3_client_new(
         goto lock_init_fail;
     }
 
-    aws_linked_list_init(&client->synced_data.pending_meta_request_work);
-    aws_linked_list_init(&client->synced_data.prepared_requests);
-
-    aws_linked_list_init(&client->threaded_data.meta_requests);
-    aws_linked_list_init(&client->threaded_data.request_queue);
-
+    aws_atomic_init_int(&client->next_work_shard_index, 0);
+    aws_atomic_init_int(&client->next_cpu_group_index, 0);
+    aws_atomic_init_int(&client->capacity_release_count, 0);
     aws_atomic_init_int(&client->stats.num_requests_in_flight, 0);
 
     for (uint32_t i = 0; i < (uint32_t)AWS_S3_META_REQUEST_TYPE_MAX; ++i) {
@@ -277,19 +677,73 @@ struct aws_s3_client *aws_s3_client_new(
 
     aws_atomic_init_int(&client->stats.num_requests_stream_queued_waiting, 0);
     aws_atomic_init_int(&client->stats.num_requests_streaming, 0);
+    aws_atomic_init_int(&client->stats.num_bytes_transferred, 0);
+    aws_atomic_init_int(&client->stats.num_slow_down_errors, 0);
 
     *((uint32_t *)&client->max_active_connections_override) = client_config->max_active_connections_override;
+    *((bool *)&client->enable_adaptive_connections) = client_config->enable_adaptive_connections;
+    *((bool *)&client->enable_read_backpressure) = client_config->enable_read_backpressure;
+    *((size_t *)&client->initial_read_window) = client_config->initial_read_window;
+
+    client->platform_info = s_s3_client_get_platform_info(client, client_config);
 
     /* Store our client bootstrap. */
     client->client_bootstrap = aws_client_bootstrap_acquire(client_config->client_bootstrap);
 
+    aws_atomic_init_int(&client->is_busy_in_client_context, 0);
+
+    if (client_config->client_context != NULL) {
+        aws_s3_client_context_acquire(client_config->client_context);
+        client->client_context = client_config->client_context;
+    }
+
     struct aws_event_loop_group *event_loop_group = client_config->client_bootstrap->event_loop_group;
     aws_event_loop_group_acquire(event_loop_group);
 
-    client->process_work_event_loop = aws_event_loop_group_get_next_loop(event_loop_group);
+    /* Set up work shards */
+    {
+        uint32_t num_event_loops = (uint32_t)aws_array_list_length(&event_loop_group->event_loops);
+        uint32_t num_work_shards = client_config->num_work_event_loops;
+
+        if (num_work_shards > num_event_loops) {
+            num_work_shards = num_event_loops;
+        }
+
+        if (num_work_shards < 1) {
+            num_work_shards = 1;
+        }
+
+        client->work_shards = aws_mem_calloc(allocator, num_work_shards, sizeof(struct aws_s3_client_work_shard));
+
+        for (uint32_t shard_index = 0; shard_index < num_work_shards; ++shard_index) {
+            /* With a single work shard, let the ELG pick its least loaded loop. Otherwise make sure every shard gets
+             * a loop of its own. */
+            struct aws_event_loop *event_loop = num_work_shards == 1
+                                                    ? aws_event_loop_group_get_next_loop(event_loop_group)
+                                                    : aws_event_loop_group_get_loop_at(event_loop_group, shard_index);
+
+            if (s_s3_client_work_shard_init(client, &client->work_shards[shard_index], shard_index, event_loop)) {
+                goto elg_create_fail;
+            }
+
+            /* Only count initialized shards, so that a failure part way through cleans up the right ones. */
+            ++(*((uint32_t *)&client->num_work_shards));
+        }
+    }
+
+    if (s_s3_client_init_cpu_groups(client, client_config)) {
+        goto elg_create_fail;
+    }
 
     /* Set up body streaming ELG */
-    {
+    if (client->num_cpu_groups > 0) {
+        /* Meta requests stream from the body streaming ELG of their own CPU group. Keep the first one around for meta
+         * requests that never get assigned a CPU group. Its shutdown is tracked with the other CPU group ELGs. */
+        client->body_streaming_elg = aws_event_loop_group_acquire(client->cpu_groups[0].body_streaming_elg);
+    } else if (client->client_context != NULL) {
+        /* The context's ELG outlives the client, so there is no shutdown of it to wait for. */
+        client->body_streaming_elg = aws_event_loop_group_acquire(client->client_context->body_streaming_elg);
+    } else {
         uint16_t num_event_loops =
             (uint16_t)aws_array_list_length(&client->client_bootstrap->event_loop_group->event_loops);
         uint16_t num_streaming_threads = num_event_loops;
@@ -367,19 +821,129 @@ struct aws_s3_client *aws_s3_client_new(
 
     if (client_config->throughput_target_gbps != 0.0) {
         *((double *)&client->throughput_target_gbps) = client_config->throughput_target_gbps;
+    } else if (client->client_context != NULL && client->client_context->throughput_target_gbps != 0.0) {
+        *((double *)&client->throughput_target_gbps) = client->client_context->throughput_target_gbps;
+    } else if (client->platform_info != NULL) {
+        /* Size the client for what the instance's network can do. */
+        *((double *)&client->throughput_target_gbps) = (double)client->platform_info->max_throughput_gbps;
     } else {
         *((double *)&client->throughput_target_gbps) = s_default_throughput_target_gbps;
     }
 
     *((enum aws_s3_meta_request_compute_content_md5 *)&client->compute_content_md5) =
         client_config->compute_content_md5;
+    *((enum aws_s3_checksum_algorithm *)&client->checksum_algorithm) = client_config->checksum_algorithm;
+    *((enum aws_s3_payload_signing_mode *)&client->payload_signing_mode) = client_config->payload_signing_mode;
 
     /* Determine how many vips are ideal by dividing target-throughput by throughput-per-vip. */
     {
-        double ideal_vip_count_double = client->throughput_target_gbps / s_throughput_per_vip_gbps;
+        double ideal_vip_count_double = client->throughput_target_gbps / g_throughput_per_vip_gbps;
         *((uint32_t *)&client->ideal_vip_count) = (uint32_t)ceil(ideal_vip_count_double);
     }
 
+    /* The adaptive connection controller starts from the statically determined connection limit, and can grow up to
+     * the configured maximum, or a multiple of the static limit. Either way, it doesn't grow past the override, the
+     * client context's budget, or the number of part buffers that fit in the memory limit. */
+    {
+        uint32_t static_max_connections = s_s3_client_get_static_max_connections(client);
+        uint32_t num_vips = client->ideal_vip_count > 0 ? client->ideal_vip_count : 1;
+        uint32_t max_adaptive_connections = client_config->max_adaptive_connections;
+
+        if (max_adaptive_connections == 0) {
+            max_adaptive_connections = num_vips * g_max_num_connections_per_vip * s_connection_controller_max_growth;
+
+            if (client_config->memory_limit_in_bytes > 0) {
+                uint64_t num_buffers_in_limit = client_config->memory_limit_in_bytes / (uint64_t)client->part_size;
+
+                if (num_buffers_in_limit < (uint64_t)static_max_connections) {
+                    num_buffers_in_limit = (uint64_t)static_max_connections;
+                }
+
+                if (num_buffers_in_limit < (uint64_t)max_adaptive_connections) {
+                    max_adaptive_connections = (uint32_t)num_buffers_in_limit;
+                }
+            }
+        }
+
+        if (client->max_active_connections_override > 0 &&
+            client->max_active_connections_override < max_adaptive_connections) {
+            max_adaptive_connections = client->max_active_connections_override;
+        }
+
+        if (client->client_context != NULL && client->client_context->max_active_connections > 0 &&
+            client->client_context->max_active_connections < max_adaptive_connections) {
+            max_adaptive_connections = client->client_context->max_active_connections;
+        }
+
+        *((uint32_t *)&client->max_adaptive_connections) = max_adaptive_connections;
+
+        aws_atomic_init_int(&client->max_allowed_connections, 0);
+        aws_atomic_store_int(
+            &client->max_allowed_connections,
+            (size_t)(static_max_connections < max_adaptive_connections ? static_max_connections
+                                                                       : max_adaptive_connections));
+        aws_atomic_init_int(&client->connection_controller_task_scheduled, 0);
+    }
+
+    /* Request structures are recycled too, keeping enough around for as many requests as the client can ever let be in
+     * flight at once. */
+    client->request_pool = aws_s3_request_pool_new(
+        allocator, (size_t)aws_s3_client_get_max_connections_budget(client) * s_max_requests_multiplier);
+
+    if (client->request_pool == NULL) {
+        goto on_error;
+    }
+
+    if (client_config->block_cache_size_in_bytes > 0) {
+        size_t block_size = client_config->block_cache_block_size > 0 ? client_config->block_cache_block_size
+                                                                       : s_default_block_cache_block_size;
+
+        client->block_cache =
+            aws_s3_block_cache_new(allocator, (uint64_t)block_size, client_config->block_cache_size_in_bytes);
+
+        if (client->block_cache == NULL) {
+            goto on_error;
+        }
+    }
+
+    /* Part buffers are recycled through the buffer pool, which also enforces the memory limit if one was given. Keep
+     * enough free buffers around to cover either the memory limit or one buffer per connection. */
+    {
+        size_t max_free_buffers = (size_t)aws_s3_client_get_max_connections_budget(client);
+
+        if (client_config->memory_limit_in_bytes > 0) {
+            uint64_t num_buffers_in_limit = client_config->memory_limit_in_bytes / (uint64_t)client->part_size;
+            max_free_buffers = num_buffers_in_limit < (uint64_t)max_free_buffers ? (size_t)num_buffers_in_limit
+                                                                                  : max_free_buffers;
+        }
+
+        client->buffer_pool = aws_s3_buffer_pool_new(
+            allocator, client->part_size, client_config->memory_limit_in_bytes, max_free_buffers);
+
+        if (client->buffer_pool == NULL) {
+            goto on_error;
+        }
+
+        /* CPU groups recycle their own buffers, splitting the free buffers between them. The memory limit is still
+         * enforced client wide through the reservations on the client's pool. */
+        if (client->num_cpu_groups > 0) {
+            size_t max_free_buffers_per_group = max_free_buffers / client->num_cpu_groups;
+
+            if (max_free_buffers_per_group < 1) {
+                max_free_buffers_per_group = 1;
+            }
+
+            for (uint32_t group_index = 0; group_index < client->num_cpu_groups; ++group_index) {
+                client->cpu_groups[group_index].buffer_pool =
+                    aws_s3_buffer_pool_new(allocator, client->part_size, 0, max_free_buffers_per_group);
+
+                if (client->cpu_groups[group_index].buffer_pool == NULL) {
+                    goto on_error;
+                }
+            }
+        }
+    }
+
     if (client_config->signing_config) {
         client->cached_signing_config = aws_cached_signing_config_new(client->allocator, client_config->signing_config);
     }
@@ -411,6 +975,9 @@ struct aws_s3_client *aws_s3_client_new(
         aws_hash_callback_string_destroy,
         NULL);
 
+    aws_array_list_init_dynamic(
+        &client->synced_data.prewarmed_endpoints, client->allocator, 0, sizeof(struct aws_s3_endpoint *));
+
     /* Initialize shutdown options and tracking. */
     client->shutdown_callback = client_config->shutdown_callback;
     client->shutdown_callback_user_data = client_config->shutdown_callback_user_data;
@@ -418,6 +985,12 @@ struct aws_s3_client *aws_s3_client_new(
     return client;
 
 on_error:
+    aws_s3_buffer_pool_destroy(client->buffer_pool);
+    client->buffer_pool = NULL;
+    aws_s3_request_pool_destroy(client->request_pool);
+    client->request_pool = NULL;
+    aws_s3_block_cache_destroy(client->block_cache);
+    client->block_cache = NULL;
     aws_event_loop_group_release(client->body_streaming_elg);
     client->body_streaming_elg = NULL;
     if (client->tls_connection_options) {
@@ -426,8 +999,11 @@ on_error:
         client->tls_connection_options = NULL;
     }
 elg_create_fail:
+    s_s3_client_clean_up_cpu_groups(client);
+    s_s3_client_clean_up_work_shards(client);
     aws_event_loop_group_release(client->client_bootstrap->event_loop_group);
     aws_client_bootstrap_release(client->client_bootstrap);
+    aws_s3_client_context_release(client->client_context);
     aws_mutex_clean_up(&client->synced_data.lock);
 lock_init_fail:
     aws_mem_release(client->allocator, client);
@@ -464,11 +1040,25 @@ static void s_s3_client_start_destroy(void *user_data) {
     /* Prevent the client from cleaning up inbetween the mutex unlock/re-lock below.*/
     client->synced_data.start_destroy_executing = true;
 
+    /* Take the prewarmed endpoints out of the client, as releasing them has to happen outside of the lock. */
+    struct aws_array_list prewarmed_endpoints = client->synced_data.prewarmed_endpoints;
+    AWS_ZERO_STRUCT(client->synced_data.prewarmed_endpoints);
+
     aws_s3_client_unlock_synced_data(client);
 
+    for (size_t i = 0; i < aws_array_list_length(&prewarmed_endpoints); ++i) {
+        struct aws_s3_endpoint *endpoint = NULL;
+        aws_array_list_get_at(&prewarmed_endpoints, &endpoint, i);
+        aws_s3_endpoint_release(endpoint);
+    }
+
+    aws_array_list_clean_up(&prewarmed_endpoints);
+
     aws_event_loop_group_release(client->body_streaming_elg);
     client->body_streaming_elg = NULL;
 
+    s_s3_client_release_cpu_groups(client);
+
     aws_s3_client_lock_synced_data(client);
     client->synced_data.start_destroy_executing = false;
 
@@ -494,9 +1084,9 @@ static void s_s3_client_finish_destroy_default(struct aws_s3_client *client) {
 
     aws_mutex_clean_up(&client->synced_data.lock);
 
-    AWS_ASSERT(aws_linked_list_empty(&client->synced_data.pending_meta_request_work));
-    AWS_ASSERT(aws_linked_list_empty(&client->threaded_data.meta_requests));
+    s_s3_client_clean_up_work_shards(client);
     aws_hash_table_clean_up(&client->synced_data.endpoints);
+    aws_array_list_clean_up(&client->synced_data.prewarmed_endpoints);
 
     aws_retry_strategy_release(client->retry_strategy);
 
@@ -504,6 +1094,18 @@ static void s_s3_client_finish_destroy_default(struct aws_s3_client *client) {
 
     aws_client_bootstrap_release(client->client_bootstrap);
     aws_cached_signing_config_destroy(client->cached_signing_config);
+    aws_s3_client_context_release(client->client_context);
+
+    s_s3_client_clean_up_cpu_groups(client);
+
+    aws_s3_buffer_pool_destroy(client->buffer_pool);
+    client->buffer_pool = NULL;
+
+    aws_s3_request_pool_destroy(client->request_pool);
+    client->request_pool = NULL;
+
+    aws_s3_block_cache_destroy(client->block_cache);
+    client->block_cache = NULL;
 
     aws_s3_client_shutdown_complete_callback_fn *shutdown_callback = client->shutdown_callback;
     void *shutdown_user_data = client->shutdown_callback_user_data;
@@ -528,46 +1130,167 @@ static void s_s3_client_body_streaming_elg_shutdown(void *user_data) {
     aws_s3_client_unlock_synced_data(client);
 }
 
-uint32_t aws_s3_client_queue_requests_threaded(
-    struct aws_s3_client *client,
-    struct aws_linked_list *request_list,
-    bool queue_front) {
+static void s_s3_client_cpu_group_elg_shutdown(void *user_data) {
+    struct aws_s3_client *client = user_data;
     AWS_PRECONDITION(client);
+
+    AWS_LOGF_DEBUG(AWS_LS_S3_CLIENT, "id=%p Client CPU group ELG shutdown.", (void *)client);
+
+    aws_s3_client_lock_synced_data(client);
+    AWS_ASSERT(client->synced_data.num_cpu_group_elgs_allocated > 0);
+    --client->synced_data.num_cpu_group_elgs_allocated;
+    s_s3_client_schedule_process_work_synced(client);
+    aws_s3_client_unlock_synced_data(client);
+}
+
+uint32_t aws_s3_client_queue_requests_threaded(
+    struct aws_s3_client_work_shard *work_shard,
+    struct aws_linked_list *request_list,
+    bool queue_front) {
+    AWS_PRECONDITION(work_shard);
     AWS_PRECONDITION(request_list);
 
     uint32_t request_list_size = 0;
 
-    for (struct aws_linked_list_node *node = aws_linked_list_begin(request_list);
-         node != aws_linked_list_end(request_list);
-         node = aws_linked_list_next(node)) {
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    /* Sort the requests out by priority first, keeping their order, so that each priority's queue gets its requests
+     * in one move. */
+    struct aws_linked_list request_lists_by_priority[AWS_S3_META_REQUEST_PRIORITY_MAX];
+
+    for (uint32_t priority = 0; priority < AWS_S3_META_REQUEST_PRIORITY_MAX; ++priority) {
+        aws_linked_list_init(&request_lists_by_priority[priority]);
+    }
+
+    while (!aws_linked_list_empty(request_list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(request_list);
+        struct aws_s3_request *request = AWS_CONTAINER_OF(node, struct aws_s3_request, node);
+        const uint32_t priority = (uint32_t)request->meta_request->priority;
+
+        aws_linked_list_push_back(&request_lists_by_priority[priority], node);
+        ++work_shard->threaded_data.request_queue_size_by_priority[priority];
         ++request_list_size;
+
+        /* Requests put back at the front of the queue keep the time they were first queued. */
+        if (request->metrics.queue_start_timestamp_ns == 0) {
+            request->metrics.queue_start_timestamp_ns = now_ns;
+        }
     }
 
-    if (queue_front) {
-        aws_linked_list_move_all_front(&client->threaded_data.request_queue, request_list);
-    } else {
-        aws_linked_list_move_all_back(&client->threaded_data.request_queue, request_list);
+    for (uint32_t priority = 0; priority < AWS_S3_META_REQUEST_PRIORITY_MAX; ++priority) {
+        if (queue_front) {
+            aws_linked_list_move_all_front(
+                &work_shard->threaded_data.request_queues[priority], &request_lists_by_priority[priority]);
+        } else {
+            aws_linked_list_move_all_back(
+                &work_shard->threaded_data.request_queues[priority], &request_lists_by_priority[priority]);
+        }
     }
 
-    client->threaded_data.request_queue_size += request_list_size;
+    work_shard->threaded_data.request_queue_size += request_list_size;
     return request_list_size;
 }
 
-struct aws_s3_request *aws_s3_client_dequeue_request_threaded(struct aws_s3_client *client) {
-    AWS_PRECONDITION(client);
+struct aws_s3_request *aws_s3_client_dequeue_request_threaded(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
 
-    if (aws_linked_list_empty(&client->threaded_data.request_queue)) {
+    if (work_shard->threaded_data.request_queue_size == 0) {
         return NULL;
     }
 
-    struct aws_linked_list_node *request_node = aws_linked_list_pop_front(&client->threaded_data.request_queue);
+    /* Find the highest priority that currently has requests queued. Its queue is in FIFO order, so the request at its
+     * front is the one to hand out. */
+    uint32_t highest_priority = AWS_S3_META_REQUEST_PRIORITY_MAX - 1;
+
+    while (highest_priority > 0 && aws_linked_list_empty(&work_shard->threaded_data.request_queues[highest_priority])) {
+        --highest_priority;
+    }
+
+    AWS_ASSERT(!aws_linked_list_empty(&work_shard->threaded_data.request_queues[highest_priority]));
+
+    struct aws_linked_list_node *request_node =
+        aws_linked_list_pop_front(&work_shard->threaded_data.request_queues[highest_priority]);
     struct aws_s3_request *request = AWS_CONTAINER_OF(request_node, struct aws_s3_request, node);
 
-    --client->threaded_data.request_queue_size;
+    --work_shard->threaded_data.request_queue_size;
+    --work_shard->threaded_data.request_queue_size_by_priority[highest_priority];
+
+    aws_high_res_clock_get_ticks(&request->metrics.queue_end_timestamp_ns);
 
     return request;
 }
 
+/* Returns a reference to the endpoint for the given host name, creating the endpoint if the client doesn't have one
+ * yet. Returns NULL and raises an error on failure. */
+static struct aws_s3_endpoint *s_s3_client_acquire_endpoint(
+    struct aws_s3_client *client,
+    struct aws_byte_cursor host_name,
+    bool use_tls,
+    int port) {
+    AWS_PRECONDITION(client);
+
+    bool error_occurred = false;
+
+    aws_s3_client_lock_synced_data(client);
+
+    struct aws_string *endpoint_host_name = aws_string_new_from_cursor(client->allocator, &host_name);
+
+    struct aws_s3_endpoint *endpoint = NULL;
+    struct aws_hash_element *endpoint_hash_element = NULL;
+
+    int was_created = 0;
+
+    if (aws_hash_table_create(
+            &client->synced_data.endpoints, endpoint_host_name, &endpoint_hash_element, &was_created)) {
+        error_occurred = true;
+        goto unlock;
+    }
+
+    if (was_created) {
+        struct aws_s3_endpoint_options endpoint_options = {
+            .host_name = endpoint_host_name,
+            .ref_count_zero_callback = client->vtable->endpoint_ref_count_zero,
+            .shutdown_callback = client->vtable->endpoint_shutdown_callback,
+            .client_bootstrap = client->client_bootstrap,
+            .cpu_groups = client->cpu_groups,
+            .num_cpu_groups = client->num_cpu_groups,
+            .tls_connection_options = use_tls ? client->tls_connection_options : NULL,
+            .dns_host_address_ttl_seconds = s_dns_host_address_ttl_seconds,
+            .user_data = client,
+            /* The connection managers live as long as the endpoint, so they are sized for the whole budget. How
+             * many of those connections the client actually uses is limited per request, by its current share. */
+            .max_connections = aws_s3_client_get_max_connections_budget(client),
+            .port = port,
+        };
+
+        endpoint = aws_s3_endpoint_new(client->allocator, &endpoint_options);
+
+        if (endpoint == NULL) {
+            aws_hash_table_remove(&client->synced_data.endpoints, endpoint_host_name, NULL, NULL);
+            error_occurred = true;
+            goto unlock;
+        }
+
+        endpoint_hash_element->value = endpoint;
+        ++client->synced_data.num_endpoints_allocated;
+    } else {
+        endpoint = aws_s3_endpoint_acquire(endpoint_hash_element->value);
+
+        aws_string_destroy(endpoint_host_name);
+        endpoint_host_name = NULL;
+    }
+
+unlock:
+    aws_s3_client_unlock_synced_data(client);
+
+    if (error_occurred) {
+        return NULL;
+    }
+
+    return endpoint;
+}
+
 /* Public facing make-meta-request function. */
 struct aws_s3_meta_request *aws_s3_client_make_meta_request(
     struct aws_s3_client *client,
@@ -628,76 +1351,106 @@ struct aws_s3_meta_request *aws_s3_client_make_meta_request(
         return NULL;
     }
 
-    bool error_occurred = false;
+    struct aws_s3_endpoint *endpoint =
+        s_s3_client_acquire_endpoint(client, host_header_value, options->use_tls, options->port);
 
-    aws_s3_client_lock_synced_data(client);
-
-    struct aws_string *endpoint_host_name = aws_string_new_from_cursor(client->allocator, &host_header_value);
+    if (endpoint == NULL) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_CLIENT,
+            "id=%p Could not create meta request due to error %d (%s)",
+            (void *)client,
+            aws_last_error(),
+            aws_error_str(aws_last_error()));
 
-    struct aws_s3_endpoint *endpoint = NULL;
-    struct aws_hash_element *endpoint_hash_element = NULL;
+        aws_s3_meta_request_release(meta_request);
+        meta_request = NULL;
+    } else {
+        /* Spread meta requests over the work shards round robin. */
+        uint32_t shard_index =
+            (uint32_t)(aws_atomic_fetch_add(&client->next_work_shard_index, 1) % (size_t)client->num_work_shards);
+        struct aws_s3_client_work_shard *work_shard = &client->work_shards[shard_index];
+
+        meta_request->work_shard = work_shard;
+
+        /* Pin the meta request to a CPU group as well. This is done independently of the work shard, since work shards
+         * process work on the client bootstrap's (unpinned) event loops, and there can be fewer of them than there are
+         * CPU groups. Nothing has been streamed yet, so the body streaming event loop can still be switched. */
+        if (client->num_cpu_groups > 0) {
+            uint32_t cpu_group_index =
+                (uint32_t)(aws_atomic_fetch_add(&client->next_cpu_group_index, 1) % (size_t)client->num_cpu_groups);
+            meta_request->cpu_group = &client->cpu_groups[cpu_group_index];
+            meta_request->io_event_loop =
+                aws_event_loop_group_get_next_loop(meta_request->cpu_group->body_streaming_elg);
+        }
 
-    int was_created = 0;
+        aws_s3_client_work_shard_lock_synced_data(work_shard);
+        s_s3_client_push_meta_request_synced(work_shard, meta_request);
+        s_s3_client_work_shard_schedule_process_work_synced(work_shard);
+        aws_s3_client_work_shard_unlock_synced_data(work_shard);
 
-    if (aws_hash_table_create(
-            &client->synced_data.endpoints, endpoint_host_name, &endpoint_hash_element, &was_created)) {
-        error_occurred = true;
-        goto unlock;
+        AWS_LOGF_INFO(
+            AWS_LS_S3_CLIENT,
+            "id=%p: Created meta request %p on work shard %d",
+            (void *)client,
+            (void *)meta_request,
+            (int)shard_index);
     }
 
-    if (was_created) {
-        struct aws_s3_endpoint_options endpoint_options = {
-            .host_name = endpoint_host_name,
-            .ref_count_zero_callback = client->vtable->endpoint_ref_count_zero,
-            .shutdown_callback = client->vtable->endpoint_shutdown_callback,
-            .client_bootstrap = client->client_bootstrap,
-            .tls_connection_options = options->use_tls ? client->tls_connection_options : NULL,
-            .dns_host_address_ttl_seconds = s_dns_host_address_ttl_seconds,
-            .user_data = client,
-            .max_connections = aws_s3_client_get_max_active_connections(client, NULL),
-            .port = options->port,
-        };
-
-        endpoint = aws_s3_endpoint_new(client->allocator, &endpoint_options);
-
-        if (endpoint == NULL) {
-            aws_hash_table_remove(&client->synced_data.endpoints, endpoint_host_name, NULL, NULL);
-            error_occurred = true;
-            goto unlock;
-        }
+    return meta_request;
+}
 
-        endpoint_hash_element->value = endpoint;
-        ++client->synced_data.num_endpoints_allocated;
-    } else {
-        endpoint = aws_s3_endpoint_acquire(endpoint_hash_element->value);
+int aws_s3_client_prewarm_endpoint(
+    struct aws_s3_client *client,
+    const struct aws_s3_client_prewarm_endpoint_options *options) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(options);
 
-        aws_string_destroy(endpoint_host_name);
-        endpoint_host_name = NULL;
+    if (options->host_name.len == 0) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_CLIENT, "id=%p Cannot prewarm endpoint; no host name was specified.", (void *)client);
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
     }
 
-    meta_request->endpoint = endpoint;
+    struct aws_s3_endpoint *endpoint =
+        s_s3_client_acquire_endpoint(client, options->host_name, options->use_tls, options->port);
 
-    s_s3_client_push_meta_request_synced(client, meta_request);
-    s_s3_client_schedule_process_work_synced(client);
-
-unlock:
-    aws_s3_client_unlock_synced_data(client);
-
-    if (error_occurred) {
+    if (endpoint == NULL) {
         AWS_LOGF_ERROR(
             AWS_LS_S3_CLIENT,
-            "id=%p Could not create meta request due to error %d (%s)",
+            "id=%p Could not prewarm endpoint due to error %d (%s)",
             (void *)client,
             aws_last_error(),
             aws_error_str(aws_last_error()));
+        return AWS_OP_ERR;
+    }
 
-        aws_s3_meta_request_release(meta_request);
-        meta_request = NULL;
-    } else {
-        AWS_LOGF_INFO(AWS_LS_S3_CLIENT, "id=%p: Created meta request %p", (void *)client, (void *)meta_request);
+    /* The endpoint is kept alive until the client shuts down, so that the connections opened here stay pooled until
+     * the first meta request for this host shows up. */
+    aws_s3_client_lock_synced_data(client);
+    int push_result = aws_array_list_push_back(&client->synced_data.prewarmed_endpoints, &endpoint);
+    aws_s3_client_unlock_synced_data(client);
+
+    if (push_result) {
+        aws_s3_endpoint_release(endpoint);
+        return AWS_OP_ERR;
     }
 
-    return meta_request;
+    /* Connections beyond what the client will ever use at once would just be closed again. */
+    uint32_t num_connections = options->num_connections;
+    uint32_t max_active_connections = aws_s3_client_get_max_connections_budget(client);
+
+    if (num_connections > max_active_connections) {
+        num_connections = max_active_connections;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_CLIENT,
+        "id=%p: Prewarming endpoint %p with %d connections.",
+        (void *)client,
+        (void *)endpoint,
+        (int)num_connections);
+
+    return aws_s3_endpoint_prewarm(endpoint, num_connections, options->callback, options->user_data);
 }
 
 static bool s_s3_client_endpoint_ref_count_zero(struct aws_s3_endpoint *endpoint) {
@@ -767,26 +1520,46 @@ static struct aws_s3_meta_request *s_s3_client_meta_request_factory_default(
             return aws_s3_meta_request_default_new(client->allocator, client, content_length, false, options);
         }
 
+        /* A small object is fetched with one plain GET, which saves the size discovery and part bookkeeping that would
+         * cost as much as the transfer itself. */
+        if (options->small_object_hint && options->get_checkpoint == NULL) {
+            return aws_s3_meta_request_default_new(client->allocator, client, 0, false, options);
+        }
+
         return aws_s3_meta_request_auto_ranged_get_new(client->allocator, client, client->part_size, options);
     } else if (options->type == AWS_S3_META_REQUEST_TYPE_PUT_OBJECT) {
 
-        if (!content_length_header_found) {
-            AWS_LOGF_ERROR(
-                AWS_LS_S3_META_REQUEST,
-                "Could not create auto-ranged-put meta request; there is no Content-Length header present.");
-            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
-            return NULL;
-        }
-
         struct aws_input_stream *input_stream = aws_http_message_get_body_stream(options->message);
 
-        if (input_stream == NULL) {
+        bool has_send_buffers = options->send_filepath.len == 0 && options->read_body_at_callback == NULL &&
+                                options->num_send_buffers > 0;
+
+        if (input_stream == NULL && options->send_filepath.len == 0 && options->read_body_at_callback == NULL &&
+            !has_send_buffers) {
             AWS_LOGF_ERROR(
                 AWS_LS_S3_META_REQUEST, "Could not create auto-ranged-put meta request; body stream is NULL.");
             aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
             return NULL;
         }
 
+        if (has_send_buffers) {
+            uint64_t send_buffers_size = 0;
+
+            for (size_t buffer_index = 0; buffer_index < options->num_send_buffers; ++buffer_index) {
+                send_buffers_size += options->send_buffers[buffer_index].len;
+            }
+
+            if (!content_length_header_found || send_buffers_size != content_length) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_S3_META_REQUEST,
+                    "Could not create auto-ranged-put meta request; the send buffers hold %" PRIu64
+                    " bytes, which does not match the Content-Length header.",
+                    send_buffers_size);
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return NULL;
+            }
+        }
+
         size_t client_part_size = client->part_size;
         size_t client_max_part_size = client->max_part_size;
 
@@ -812,6 +1585,54 @@ static struct aws_s3_meta_request *s_s3_client_meta_request_factory_default(
             client_max_part_size = g_s3_min_upload_part_size;
         }
 
+        /* Without a Content-Length header, the body is uploaded in parts of the client's part size until its stream
+         * ends. A body that is read at offsets has to say how long it is. */
+        if (!content_length_header_found) {
+            if (input_stream == NULL || options->send_filepath.len > 0 || options->read_body_at_callback != NULL ||
+                options->resume_token.len > 0) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_S3_META_REQUEST,
+                    "Could not create auto-ranged-put meta request; there is no Content-Length header present, which "
+                    "is only supported for bodies read from the body stream, and not when resuming.");
+                aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+                return NULL;
+            }
+
+            return aws_s3_meta_request_auto_ranged_put_new(
+                client->allocator, client, client_part_size, AWS_S3_AUTO_RANGED_PUT_UNKNOWN_CONTENT_LENGTH, 0, options);
+        }
+
+        /* A resumed upload has to be split into the same parts as the one that was paused. */
+        if (options->resume_token.len > 0) {
+            struct aws_s3_auto_ranged_put_resume_token resume_token;
+
+            if (aws_s3_auto_ranged_put_resume_token_parse(client->allocator, options->resume_token, &resume_token)) {
+                return NULL;
+            }
+
+            size_t resume_part_size = resume_token.part_size;
+            aws_s3_auto_ranged_put_resume_token_clean_up(&resume_token);
+
+            uint64_t resume_num_parts = content_length / resume_part_size;
+
+            if ((content_length % resume_part_size) > 0) {
+                ++resume_num_parts;
+            }
+
+            if (resume_num_parts == 0 || resume_num_parts > g_s3_max_num_upload_parts) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_S3_META_REQUEST,
+                    "Could not create auto-ranged-put meta request; content length of %" PRIu64
+                    " does not match the parts of the resume token.",
+                    content_length);
+                aws_raise_error(AWS_ERROR_S3_INVALID_RESUME_TOKEN);
+                return NULL;
+            }
+
+            return aws_s3_meta_request_auto_ranged_put_new(
+                client->allocator, client, resume_part_size, content_length, (uint32_t)resume_num_parts, options);
+        }
+
         if (content_length < client_part_size) {
             return aws_s3_meta_request_default_new(
                 client->allocator,
@@ -848,83 +1669,329 @@ static struct aws_s3_meta_request *s_s3_client_meta_request_factory_default(
             return NULL;
         }
 
-        if (part_size < client_part_size) {
-            part_size = client_part_size;
-        }
+        if (part_size < client_part_size) {
+            part_size = client_part_size;
+        }
+
+        uint32_t num_parts = (uint32_t)(content_length / part_size);
+
+        if ((content_length % part_size) > 0) {
+            ++num_parts;
+        }
+
+        return aws_s3_meta_request_auto_ranged_put_new(
+            client->allocator, client, part_size, content_length, num_parts, options);
+    } else if (options->type == AWS_S3_META_REQUEST_TYPE_COPY_OBJECT) {
+        return aws_s3_meta_request_copy_object_new(client->allocator, client, options);
+    } else if (options->type == AWS_S3_META_REQUEST_TYPE_DEFAULT) {
+        return aws_s3_meta_request_default_new(client->allocator, client, content_length, false, options);
+    } else {
+        AWS_FATAL_ASSERT(false);
+    }
+
+    return NULL;
+}
+
+static void s_s3_client_push_meta_request_synced(
+    struct aws_s3_client_work_shard *work_shard,
+    struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(work_shard);
+    AWS_PRECONDITION(meta_request);
+    ASSERT_SYNCED_DATA_LOCK_HELD(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
+
+    struct aws_s3_meta_request_work *meta_request_work =
+        aws_mem_calloc(client->allocator, 1, sizeof(struct aws_s3_meta_request_work));
+
+    aws_s3_meta_request_acquire(meta_request);
+    meta_request_work->meta_request = meta_request;
+    aws_linked_list_push_back(&work_shard->synced_data.pending_meta_request_work, &meta_request_work->node);
+}
+
+static void s_s3_client_schedule_process_work_synced(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+    ASSERT_SYNCED_DATA_LOCK_HELD(client);
+
+    s_s3_client_work_shard_schedule_process_work(&client->work_shards[0]);
+}
+
+static void s_s3_client_work_shard_schedule_process_work_synced(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
+    AWS_PRECONDITION(work_shard->client);
+    AWS_PRECONDITION(work_shard->client->vtable);
+    AWS_PRECONDITION(work_shard->client->vtable->schedule_process_work_synced);
+
+    ASSERT_SYNCED_DATA_LOCK_HELD(work_shard);
+
+    work_shard->client->vtable->schedule_process_work_synced(work_shard);
+}
+
+static void s_s3_client_work_shard_schedule_process_work(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
+
+    aws_s3_client_work_shard_lock_synced_data(work_shard);
+    s_s3_client_work_shard_schedule_process_work_synced(work_shard);
+    aws_s3_client_work_shard_unlock_synced_data(work_shard);
+}
+
+static void s_s3_client_schedule_process_work_capacity_released(
+    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(work_shard);
+
+    aws_atomic_fetch_add(&client->capacity_release_count, 1);
+
+    s_s3_client_work_shard_schedule_process_work(work_shard);
+
+    for (uint32_t shard_index = 0; shard_index < client->num_work_shards; ++shard_index) {
+        struct aws_s3_client_work_shard *waiting_work_shard = &client->work_shards[shard_index];
+
+        if (waiting_work_shard != work_shard &&
+            aws_atomic_exchange_int(&waiting_work_shard->waiting_for_capacity, 0)) {
+            s_s3_client_work_shard_schedule_process_work(waiting_work_shard);
+        }
+    }
+}
+
+/* Flag the work shard as waiting for client wide capacity. capacity_release_count is the client's count of capacity
+ * releases from before the shard last checked the client wide limits. If capacity was released since then, the wake up
+ * for it may have come before the flag was set, so the shard schedules itself instead. */
+static void s_s3_client_work_shard_wait_for_capacity(
+    struct aws_s3_client_work_shard *work_shard,
+    size_t capacity_release_count) {
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
+    AWS_PRECONDITION(client);
+
+    /* With a single shard, every release already schedules the one shard there is. */
+    if (client->num_work_shards < 2) {
+        return;
+    }
+
+    aws_atomic_store_int(&work_shard->waiting_for_capacity, 1);
+
+    if (aws_atomic_load_int(&client->capacity_release_count) != capacity_release_count &&
+        aws_atomic_exchange_int(&work_shard->waiting_for_capacity, 0)) {
+        s_s3_client_work_shard_schedule_process_work(work_shard);
+    }
+}
+
+static void s_s3_client_work_shard_throttle_task(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+    (void)task;
+    (void)task_status;
+
+    struct aws_s3_client_work_shard *work_shard = arg;
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
+    AWS_PRECONDITION(client);
+
+    work_shard->threaded_data.throttle_task_scheduled = false;
+    s_s3_client_work_shard_schedule_process_work(work_shard);
+
+    /* Release the reference that kept the client (and so this work shard) alive while the task was scheduled. */
+    aws_s3_client_release(client);
+}
+
+static void s_s3_client_work_shard_wait_for_throttle_threaded(
+    struct aws_s3_client_work_shard *work_shard,
+    uint64_t delay_ns) {
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
+    AWS_PRECONDITION(client);
+
+    /* An earlier task will run work processing, which will schedule another task if requests are still held back. */
+    if (work_shard->threaded_data.throttle_task_scheduled) {
+        return;
+    }
+
+    uint64_t now_ns = 0;
+
+    if (aws_event_loop_current_clock_time(work_shard->event_loop, &now_ns)) {
+        s_s3_client_work_shard_schedule_process_work(work_shard);
+        return;
+    }
+
+    aws_s3_client_acquire(client);
+
+    aws_task_init(
+        &work_shard->threaded_data.throttle_task,
+        s_s3_client_work_shard_throttle_task,
+        work_shard,
+        "s3_client_work_shard_throttle_task");
+
+    aws_event_loop_schedule_task_future(
+        work_shard->event_loop, &work_shard->threaded_data.throttle_task, now_ns + delay_ns);
+
+    work_shard->threaded_data.throttle_task_scheduled = true;
+}
+
+static void s_s3_client_connection_controller_task(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+    (void)task;
+
+    struct aws_s3_client *client = arg;
+    AWS_PRECONDITION(client);
+
+    struct aws_event_loop *event_loop = client->work_shards[0].event_loop;
+    uint64_t now_ns = 0;
 
-        uint32_t num_parts = (uint32_t)(content_length / part_size);
+    if (task_status == AWS_TASK_STATUS_RUN_READY && !aws_event_loop_current_clock_time(event_loop, &now_ns)) {
+        uint32_t max_allowed_connections = (uint32_t)aws_atomic_load_int(&client->max_allowed_connections);
 
-        if ((content_length % part_size) > 0) {
-            ++num_parts;
+        aws_s3_client_update_max_allowed_connections_threaded(client, now_ns);
+
+        /* Shards may be holding requests back for lack of connections, so let them know there are more now. */
+        if ((uint32_t)aws_atomic_load_int(&client->max_allowed_connections) > max_allowed_connections) {
+            s_s3_client_schedule_process_work_capacity_released(client, &client->work_shards[0]);
         }
 
-        return aws_s3_meta_request_auto_ranged_put_new(
-            client->allocator, client, part_size, content_length, num_parts, options);
-    } else if (options->type == AWS_S3_META_REQUEST_TYPE_COPY_OBJECT) {
-        return aws_s3_meta_request_copy_object_new(client->allocator, client, options);
-    } else if (options->type == AWS_S3_META_REQUEST_TYPE_DEFAULT) {
-        return aws_s3_meta_request_default_new(client->allocator, client, content_length, false, options);
-    } else {
-        AWS_FATAL_ASSERT(false);
+        /* Keep sampling for as long as there is traffic to measure, keeping the reference to the client. */
+        if (aws_atomic_load_int(&client->stats.num_requests_in_flight) > 0) {
+            aws_event_loop_schedule_task_future(
+                event_loop,
+                &client->threaded_data.connection_controller.task,
+                now_ns + s_connection_controller_sample_interval_ns);
+            return;
+        }
     }
 
-    return NULL;
+    /* Measure from a new baseline the next time the task starts, rather than across the idle time. */
+    client->threaded_data.connection_controller.last_sample_timestamp_ns = 0;
+    aws_atomic_store_int(&client->connection_controller_task_scheduled, 0);
+
+    /* Release the reference that kept the client alive while the task was scheduled. */
+    aws_s3_client_release(client);
 }
 
-static void s_s3_client_push_meta_request_synced(
-    struct aws_s3_client *client,
-    struct aws_s3_meta_request *meta_request) {
+/* Start the adaptive connection controller's task on work shard 0's event loop, if it isn't running already. The
+ * controller works on client wide numbers, so a single task runs it, independent of which shards have work. Can be
+ * called from any shard. */
+static void s_s3_client_schedule_connection_controller(struct aws_s3_client *client) {
     AWS_PRECONDITION(client);
-    AWS_PRECONDITION(meta_request);
-    ASSERT_SYNCED_DATA_LOCK_HELD(client);
 
-    struct aws_s3_meta_request_work *meta_request_work =
-        aws_mem_calloc(client->allocator, 1, sizeof(struct aws_s3_meta_request_work));
+    /* Requests in flight keep their meta requests, and so the client, alive, which makes taking a reference safe. */
+    if (!client->enable_adaptive_connections || aws_atomic_load_int(&client->stats.num_requests_in_flight) == 0) {
+        return;
+    }
 
-    aws_s3_meta_request_acquire(meta_request);
-    meta_request_work->meta_request = meta_request;
-    aws_linked_list_push_back(&client->synced_data.pending_meta_request_work, &meta_request_work->node);
-}
+    size_t expected = 0;
 
-static void s_s3_client_schedule_process_work_synced(struct aws_s3_client *client) {
-    AWS_PRECONDITION(client);
-    AWS_PRECONDITION(client->vtable);
-    AWS_PRECONDITION(client->vtable->schedule_process_work_synced);
+    if (!aws_atomic_compare_exchange_int(&client->connection_controller_task_scheduled, &expected, 1)) {
+        return;
+    }
 
-    ASSERT_SYNCED_DATA_LOCK_HELD(client);
+    aws_s3_client_acquire(client);
+
+    aws_task_init(
+        &client->threaded_data.connection_controller.task,
+        s_s3_client_connection_controller_task,
+        client,
+        "s3_client_connection_controller_task");
 
-    client->vtable->schedule_process_work_synced(client);
+    aws_event_loop_schedule_task_now(
+        client->work_shards[0].event_loop, &client->threaded_data.connection_controller.task);
 }
 
-static void s_s3_client_schedule_process_work_synced_default(struct aws_s3_client *client) {
-    ASSERT_SYNCED_DATA_LOCK_HELD(client);
+static void s_s3_client_schedule_process_work_synced_default(struct aws_s3_client_work_shard *work_shard) {
+    ASSERT_SYNCED_DATA_LOCK_HELD(work_shard);
 
-    if (client->synced_data.process_work_task_scheduled) {
+    if (work_shard->synced_data.process_work_task_scheduled) {
         return;
     }
 
     aws_task_init(
-        &client->synced_data.process_work_task, s_s3_client_process_work_task, client, "s3_client_process_work_task");
+        &work_shard->synced_data.process_work_task,
+        s_s3_client_process_work_task,
+        work_shard,
+        "s3_client_process_work_task");
 
-    aws_event_loop_schedule_task_now(client->process_work_event_loop, &client->synced_data.process_work_task);
+    aws_event_loop_schedule_task_now(work_shard->event_loop, &work_shard->synced_data.process_work_task);
 
-    client->synced_data.process_work_task_scheduled = true;
+    work_shard->synced_data.process_work_task_scheduled = true;
 }
 
 void aws_s3_client_schedule_process_work(struct aws_s3_client *client) {
     AWS_PRECONDITION(client);
 
-    aws_s3_client_lock_synced_data(client);
-    s_s3_client_schedule_process_work_synced(client);
-    aws_s3_client_unlock_synced_data(client);
+    for (uint32_t shard_index = 0; shard_index < client->num_work_shards; ++shard_index) {
+        s_s3_client_work_shard_schedule_process_work(&client->work_shards[shard_index]);
+    }
+}
+
+void aws_s3_client_schedule_meta_request_work(struct aws_s3_client *client, struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(meta_request);
+
+    s_s3_client_work_shard_schedule_process_work(s_s3_client_get_work_shard(client, meta_request));
+}
+
+/* Insert a meta request into the work shard's meta request list, which is kept ordered from highest to lowest
+ * priority. If front_of_priority is true, the meta request is placed ahead of the other meta requests of the same
+ * priority, otherwise it is placed behind them. */
+static void s_s3_client_insert_meta_request_threaded(
+    struct aws_s3_client_work_shard *work_shard,
+    struct aws_s3_meta_request *meta_request,
+    bool front_of_priority) {
+    AWS_PRECONDITION(work_shard);
+    AWS_PRECONDITION(meta_request);
+
+    struct aws_linked_list_node *insert_before_node = aws_linked_list_begin(&work_shard->threaded_data.meta_requests);
+
+    while (insert_before_node != aws_linked_list_end(&work_shard->threaded_data.meta_requests)) {
+        struct aws_s3_meta_request *current_meta_request =
+            AWS_CONTAINER_OF(insert_before_node, struct aws_s3_meta_request, client_process_work_threaded_data);
+
+        if (current_meta_request->priority < meta_request->priority ||
+            (front_of_priority && current_meta_request->priority == meta_request->priority)) {
+            break;
+        }
+
+        insert_before_node = aws_linked_list_next(insert_before_node);
+    }
+
+    aws_linked_list_insert_before(insert_before_node, &meta_request->client_process_work_threaded_data.node);
+}
+
+/* Move a meta request that has used up its deficit behind the other meta requests of the same priority that follow it,
+ * giving each of them a turn before it is visited again. */
+static void s_s3_client_rotate_meta_request_threaded(
+    struct aws_s3_client_work_shard *work_shard,
+    struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(work_shard);
+    AWS_PRECONDITION(meta_request);
+
+    struct aws_linked_list_node *meta_request_node = &meta_request->client_process_work_threaded_data.node;
+    struct aws_linked_list_node *insert_before_node = aws_linked_list_next(meta_request_node);
+
+    while (insert_before_node != aws_linked_list_end(&work_shard->threaded_data.meta_requests)) {
+        struct aws_s3_meta_request *current_meta_request =
+            AWS_CONTAINER_OF(insert_before_node, struct aws_s3_meta_request, client_process_work_threaded_data);
+
+        if (current_meta_request->priority != meta_request->priority) {
+            break;
+        }
+
+        insert_before_node = aws_linked_list_next(insert_before_node);
+    }
+
+    if (insert_before_node == aws_linked_list_next(meta_request_node)) {
+        return;
+    }
+
+    aws_linked_list_remove(meta_request_node);
+    aws_linked_list_insert_before(insert_before_node, meta_request_node);
 }
 
 static void s_s3_client_remove_meta_request_threaded(
-    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard,
     struct aws_s3_meta_request *meta_request) {
-    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(work_shard);
     AWS_PRECONDITION(meta_request);
-    (void)client;
+    (void)work_shard;
 
     aws_linked_list_remove(&meta_request->client_process_work_threaded_data.node);
     meta_request->client_process_work_threaded_data.scheduled = false;
@@ -940,15 +2007,40 @@ static void s_s3_client_process_work_task(struct aws_task *task, void *arg, enum
     /* Client keeps a reference to the event loop group; a 'canceled' status should not happen.*/
     AWS_ASSERT(task_status == AWS_TASK_STATUS_RUN_READY);
 
-    struct aws_s3_client *client = arg;
+    struct aws_s3_client_work_shard *work_shard = arg;
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
     AWS_PRECONDITION(client);
     AWS_PRECONDITION(client->vtable);
     AWS_PRECONDITION(client->vtable->process_work);
 
-    client->vtable->process_work(client);
+    client->vtable->process_work(work_shard);
+}
+
+/* Returns true if no work shard has work processing scheduled or in progress. */
+static bool s_s3_client_work_shards_idle_synced(struct aws_s3_client *client) {
+    AWS_PRECONDITION(client);
+    ASSERT_SYNCED_DATA_LOCK_HELD(client);
+
+    bool idle = true;
+
+    for (uint32_t shard_index = 0; shard_index < client->num_work_shards && idle; ++shard_index) {
+        struct aws_s3_client_work_shard *work_shard = &client->work_shards[shard_index];
+
+        aws_s3_client_work_shard_lock_synced_data(work_shard);
+        idle = work_shard->synced_data.process_work_task_scheduled == false &&
+               work_shard->synced_data.process_work_task_in_progress == false;
+        aws_s3_client_work_shard_unlock_synced_data(work_shard);
+    }
+
+    return idle;
 }
 
-static void s_s3_client_process_work_default(struct aws_s3_client *client) {
+static void s_s3_client_process_work_default(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
     AWS_PRECONDITION(client);
     AWS_PRECONDITION(client->vtable);
     AWS_PRECONDITION(client->vtable->finish_destroy);
@@ -961,24 +2053,25 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
     /*******************/
     AWS_LOGF_DEBUG(
         AWS_LS_S3_CLIENT,
-        "id=%p s_s3_client_process_work_default - Moving relevant synced_data into threaded_data.",
-        (void *)client);
-    aws_s3_client_lock_synced_data(client);
+        "id=%p s_s3_client_process_work_default - Moving relevant synced_data into threaded_data for work shard %d.",
+        (void *)client,
+        (int)work_shard->index);
+    aws_s3_client_work_shard_lock_synced_data(work_shard);
 
     /* Once we exit this mutex, someone can reschedule this task. */
-    client->synced_data.process_work_task_scheduled = false;
-    client->synced_data.process_work_task_in_progress = true;
+    work_shard->synced_data.process_work_task_scheduled = false;
+    work_shard->synced_data.process_work_task_in_progress = true;
 
-    aws_linked_list_swap_contents(&meta_request_work_list, &client->synced_data.pending_meta_request_work);
+    aws_linked_list_swap_contents(&meta_request_work_list, &work_shard->synced_data.pending_meta_request_work);
 
     uint32_t num_requests_queued =
-        aws_s3_client_queue_requests_threaded(client, &client->synced_data.prepared_requests, false);
+        aws_s3_client_queue_requests_threaded(work_shard, &work_shard->synced_data.prepared_requests, false);
 
     {
         int sub_result = aws_sub_u32_checked(
-            client->threaded_data.num_requests_being_prepared,
+            work_shard->threaded_data.num_requests_being_prepared,
             num_requests_queued,
-            &client->threaded_data.num_requests_being_prepared);
+            &work_shard->threaded_data.num_requests_being_prepared);
 
         AWS_ASSERT(sub_result == AWS_OP_SUCCESS);
         (void)sub_result;
@@ -986,20 +2079,17 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
 
     {
         int sub_result = aws_sub_u32_checked(
-            client->threaded_data.num_requests_being_prepared,
-            client->synced_data.num_failed_prepare_requests,
-            &client->threaded_data.num_requests_being_prepared);
+            work_shard->threaded_data.num_requests_being_prepared,
+            work_shard->synced_data.num_unsent_prepare_requests,
+            &work_shard->threaded_data.num_requests_being_prepared);
 
-        client->synced_data.num_failed_prepare_requests = 0;
+        work_shard->synced_data.num_unsent_prepare_requests = 0;
 
         AWS_ASSERT(sub_result == AWS_OP_SUCCESS);
         (void)sub_result;
     }
 
-    uint32_t num_endpoints_in_table = (uint32_t)aws_hash_table_get_entry_count(&client->synced_data.endpoints);
-    uint32_t num_endpoints_allocated = client->synced_data.num_endpoints_allocated;
-
-    aws_s3_client_unlock_synced_data(client);
+    aws_s3_client_work_shard_unlock_synced_data(work_shard);
 
     /*******************/
     /* Step 2: Push meta requests into the thread local list if they haven't already been scheduled. */
@@ -1018,10 +2108,10 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
         struct aws_s3_meta_request *meta_request = meta_request_work->meta_request;
 
         if (!meta_request->client_process_work_threaded_data.scheduled) {
-            aws_linked_list_push_back(
-                &client->threaded_data.meta_requests, &meta_request->client_process_work_threaded_data.node);
+            s_s3_client_insert_meta_request_threaded(work_shard, meta_request, false);
 
             meta_request->client_process_work_threaded_data.scheduled = true;
+            meta_request->client_process_work_threaded_data.deficit = meta_request->weight;
         } else {
             aws_s3_meta_request_release(meta_request);
             meta_request = NULL;
@@ -1035,17 +2125,33 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
     /*******************/
     {
         AWS_LOGF_DEBUG(AWS_LS_S3_CLIENT, "id=%p Updating meta requests.", (void *)client);
-        aws_s3_client_update_meta_requests_threaded(client);
+        aws_s3_client_update_meta_requests_threaded(work_shard);
+
+        s_s3_client_schedule_connection_controller(client);
 
         AWS_LOGF_DEBUG(
             AWS_LS_S3_CLIENT, "id=%p Updating connections, assigning requests where possible.", (void *)client);
-        aws_s3_client_update_connections_threaded(client);
+        aws_s3_client_update_connections_threaded(work_shard);
     }
 
     /*******************/
     /* Step 4: Log client stats. */
     /*******************/
-    {
+    if (work_shard->index != 0) {
+        AWS_LOGF(
+            s_log_level_client_stats,
+            AWS_LS_S3_CLIENT_STATS,
+            "id=%p Work-shard:%d  Requests-preparing:%d  Requests-queued:%d",
+            (void *)client,
+            (int)work_shard->index,
+            work_shard->threaded_data.num_requests_being_prepared,
+            work_shard->threaded_data.request_queue_size);
+    } else {
+        aws_s3_client_lock_synced_data(client);
+        uint32_t num_endpoints_in_table = (uint32_t)aws_hash_table_get_entry_count(&client->synced_data.endpoints);
+        uint32_t num_endpoints_allocated = client->synced_data.num_endpoints_allocated;
+        aws_s3_client_unlock_synced_data(client);
+
         uint32_t num_requests_tracked_requests = (uint32_t)aws_atomic_load_int(&client->stats.num_requests_in_flight);
 
         uint32_t num_auto_ranged_get_network_io =
@@ -1062,20 +2168,26 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
             (uint32_t)aws_atomic_load_int(&client->stats.num_requests_stream_queued_waiting);
         uint32_t num_requests_streaming = (uint32_t)aws_atomic_load_int(&client->stats.num_requests_streaming);
 
+        /* Preparing and queued requests are only known for this shard; other shards log their own. */
         uint32_t total_approx_requests = num_requests_network_io + num_requests_stream_queued_waiting +
-                                         num_requests_streaming + client->threaded_data.num_requests_being_prepared +
-                                         client->threaded_data.request_queue_size;
+                                         num_requests_streaming +
+                                         work_shard->threaded_data.num_requests_being_prepared +
+                                         work_shard->threaded_data.request_queue_size;
+
+        uint32_t max_active_connections = aws_s3_client_get_max_active_connections(client, NULL);
+
         AWS_LOGF(
             s_log_level_client_stats,
             AWS_LS_S3_CLIENT_STATS,
             "id=%p Requests-in-flight(approx/exact):%d/%d  Requests-preparing:%d  Requests-queued:%d  "
             "Requests-network(get/put/default/total):%d/%d/%d/%d  Requests-streaming-waiting:%d  Requests-streaming:%d "
-            " Endpoints(in-table/allocated):%d/%d",
+            " Endpoints(in-table/allocated):%d/%d  Connections-allowed:%d  Throughput-bytes-per-sec:%.0f  "
+            "Memory-reserved:%" PRIu64 "  Work-shards:%d",
             (void *)client,
             total_approx_requests,
             num_requests_tracked_requests,
-            client->threaded_data.num_requests_being_prepared,
-            client->threaded_data.request_queue_size,
+            work_shard->threaded_data.num_requests_being_prepared,
+            work_shard->threaded_data.request_queue_size,
             num_auto_ranged_get_network_io,
             num_auto_ranged_put_network_io,
             num_auto_default_network_io,
@@ -1083,25 +2195,50 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
             num_requests_stream_queued_waiting,
             num_requests_streaming,
             num_endpoints_in_table,
-            num_endpoints_allocated);
+            num_endpoints_allocated,
+            max_active_connections,
+            client->threaded_data.connection_controller.last_throughput_bytes_per_sec,
+            client->buffer_pool != NULL ? aws_s3_buffer_pool_get_reserved(client->buffer_pool) : 0,
+            (int)client->num_work_shards);
     }
 
     /*******************/
     /* Step 5: Check for client shutdown. */
     /*******************/
     {
+        /* The client lock is held while this shard is flagged as no longer in progress, so that work shard 0 cannot
+         * decide to finish destroying the client before this shard is done touching it. */
         aws_s3_client_lock_synced_data(client);
-        client->synced_data.process_work_task_in_progress = false;
+
+        aws_s3_client_work_shard_lock_synced_data(work_shard);
+        work_shard->synced_data.process_work_task_in_progress = false;
+        aws_s3_client_work_shard_unlock_synced_data(work_shard);
+
+        /* Only work shard 0 decides when the client can finish destroying itself. Any other shard going idle during
+         * shutdown gives work shard 0 a chance to re-check. */
+        if (work_shard->index != 0) {
+            if (!client->synced_data.active) {
+                s_s3_client_schedule_process_work_synced(client);
+            }
+
+            aws_s3_client_unlock_synced_data(client);
+            return;
+        }
 
         /* This flag should never be set twice. If it was, that means a double-free could occur.*/
         AWS_ASSERT(!client->synced_data.finish_destroy);
 
+        bool work_shards_idle = false;
+
+        if (client->synced_data.active == false) {
+            work_shards_idle = s_s3_client_work_shards_idle_synced(client);
+        }
+
         bool finish_destroy = client->synced_data.active == false &&
                               client->synced_data.start_destroy_executing == false &&
-                              client->synced_data.body_streaming_elg_allocated == false &&
-                              client->synced_data.process_work_task_scheduled == false &&
-                              client->synced_data.process_work_task_in_progress == false &&
-                              client->synced_data.num_endpoints_allocated == 0;
+                              client->synced_data.body_streaming_elg_allocated == false && work_shards_idle &&
+                              client->synced_data.num_endpoints_allocated == 0 &&
+                              client->synced_data.num_cpu_group_elgs_allocated == 0;
 
         client->synced_data.finish_destroy = finish_destroy;
 
@@ -1109,14 +2246,13 @@ static void s_s3_client_process_work_default(struct aws_s3_client *client) {
             AWS_LOGF_DEBUG(
                 AWS_LS_S3_CLIENT,
                 "id=%p Client shutdown progress: starting_destroy_executing=%d  body_streaming_elg_allocated=%d  "
-                "process_work_task_scheduled=%d  process_work_task_in_progress=%d  num_endpoints_allocated=%d "
-                "finish_destroy=%d",
+                "work_shards_idle=%d  num_endpoints_allocated=%d  num_cpu_group_elgs_allocated=%d  finish_destroy=%d",
                 (void *)client,
                 (int)client->synced_data.start_destroy_executing,
                 (int)client->synced_data.body_streaming_elg_allocated,
-                (int)client->synced_data.process_work_task_scheduled,
-                (int)client->synced_data.process_work_task_in_progress,
+                (int)work_shards_idle,
                 (int)client->synced_data.num_endpoints_allocated,
+                (int)client->synced_data.num_cpu_group_elgs_allocated,
                 (int)client->synced_data.finish_destroy);
         }
 
@@ -1134,11 +2270,26 @@ static void s_s3_client_prepare_callback_queue_request(
     int error_code,
     void *user_data);
 
-void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client *client) {
+void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
     AWS_PRECONDITION(client);
 
     const uint32_t max_requests_in_flight = aws_s3_client_get_max_requests_in_flight(client);
-    const uint32_t max_requests_prepare = aws_s3_client_get_max_requests_prepare(client);
+    uint32_t max_requests_prepare = aws_s3_client_get_max_requests_prepare(client);
+
+    /* Every shard's request queue feeds the same connections, so the preparation budget is split between them. */
+    if (client->num_work_shards > 1) {
+        max_requests_prepare /= client->num_work_shards;
+
+        if (max_requests_prepare < 1) {
+            max_requests_prepare = 1;
+        }
+    }
+
+    const size_t capacity_release_count = aws_atomic_load_int(&client->capacity_release_count);
+    bool waiting_for_capacity = false;
 
     struct aws_linked_list meta_requests_work_remaining;
     aws_linked_list_init(&meta_requests_work_remaining);
@@ -1163,13 +2314,13 @@ void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client *client) {
          * Then update meta requests to get new requests that can then be prepared (reading from any streams, signing,
          * etc.) for sending.
          */
-        while ((client->threaded_data.num_requests_being_prepared + client->threaded_data.request_queue_size) <
+        while ((work_shard->threaded_data.num_requests_being_prepared + work_shard->threaded_data.request_queue_size) <
                    max_requests_prepare &&
                num_requests_in_flight < max_requests_in_flight &&
-               !aws_linked_list_empty(&client->threaded_data.meta_requests)) {
+               !aws_linked_list_empty(&work_shard->threaded_data.meta_requests)) {
 
             struct aws_linked_list_node *meta_request_node =
-                aws_linked_list_begin(&client->threaded_data.meta_requests);
+                aws_linked_list_begin(&work_shard->threaded_data.meta_requests);
             struct aws_s3_meta_request *meta_request =
                 AWS_CONTAINER_OF(meta_request_node, struct aws_s3_meta_request, client_process_work_threaded_data);
 
@@ -1183,18 +2334,45 @@ void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client *client) {
             /* If this particular endpoint doesn't have any known addresses yet, then we don't want to go full speed in
              * ramping up requests just yet. If there is already enough in the queue for one address (even if those
              * aren't for this particular endpoint) we skip over this meta request for now. */
-            if (num_known_vips == 0 && (client->threaded_data.num_requests_being_prepared +
-                                        client->threaded_data.request_queue_size) >= g_max_num_connections_per_vip) {
+            if (num_known_vips == 0 && (work_shard->threaded_data.num_requests_being_prepared +
+                                        work_shard->threaded_data.request_queue_size) >=
+                                           g_max_num_connections_per_vip) {
                 aws_linked_list_remove(&meta_request->client_process_work_threaded_data.node);
                 aws_linked_list_push_back(
                     &meta_requests_work_remaining, &meta_request->client_process_work_threaded_data.node);
                 continue;
             }
 
-            struct aws_s3_request *request = NULL;
+            /* A request that didn't fit under the memory limit last time is tried again before the meta request is
+             * asked for a new one. */
+            struct aws_s3_request *request = meta_request->client_process_work_threaded_data.pending_request;
+            bool work_remaining = true;
+
+            if (request != NULL) {
+                meta_request->client_process_work_threaded_data.pending_request = NULL;
+            } else {
+                /* Try to grab the next request from the meta request. */
+                work_remaining = aws_s3_meta_request_update(meta_request, pass_flags[pass_index], &request);
+            }
+
+            /* Reserve the request's part buffer, at the size it will actually be. If that would put the client over
+             * its memory limit, hold on to the request and skip over the meta request until part buffers are
+             * released. */
+            if (request != NULL && client->buffer_pool != NULL &&
+                (request->part_size_response_body || request->part_size_request_body)) {
+                const size_t part_buffer_size = aws_s3_request_get_part_buffer_size(request);
+
+                if (!aws_s3_buffer_pool_try_reserve(client->buffer_pool, part_buffer_size)) {
+                    meta_request->client_process_work_threaded_data.pending_request = request;
+                    aws_linked_list_remove(&meta_request->client_process_work_threaded_data.node);
+                    aws_linked_list_push_back(
+                        &meta_requests_work_remaining, &meta_request->client_process_work_threaded_data.node);
+                    waiting_for_capacity = true;
+                    continue;
+                }
 
-            /* Try to grab the next request from the meta request. */
-            bool work_remaining = aws_s3_meta_request_update(meta_request, pass_flags[pass_index], &request);
+                request->buffer_pool_reservation = part_buffer_size;
+            }
 
             if (work_remaining) {
                 /* If there is work remaining, but we didn't get a request back, take the meta request out of the
@@ -1207,20 +2385,52 @@ void aws_s3_client_update_meta_requests_threaded(struct aws_s3_client *client) {
                 } else {
                     request->tracked_by_client = true;
 
-                    ++client->threaded_data.num_requests_being_prepared;
+                    ++work_shard->threaded_data.num_requests_being_prepared;
 
                     num_requests_in_flight =
                         (uint32_t)aws_atomic_fetch_add(&client->stats.num_requests_in_flight, 1) + 1;
+                    aws_atomic_fetch_add(&meta_request->stats.num_requests_in_flight, 1);
+
+                    if (num_requests_in_flight == 1 && client->client_context != NULL) {
+                        aws_s3_client_context_update_busy_client(client->client_context, client);
+                    }
+
+                    /* Deficit round robin: once the meta request has had its weight worth of requests prepared, let
+                     * the other meta requests of the same priority have a turn. */
+                    if (meta_request->client_process_work_threaded_data.deficit > 1) {
+                        --meta_request->client_process_work_threaded_data.deficit;
+                    } else {
+                        meta_request->client_process_work_threaded_data.deficit = meta_request->weight;
+                        s_s3_client_rotate_meta_request_threaded(work_shard, meta_request);
+                    }
 
                     aws_s3_meta_request_prepare_request(
-                        meta_request, request, s_s3_client_prepare_callback_queue_request, client);
+                        meta_request, request, s_s3_client_prepare_callback_queue_request, work_shard);
                 }
             } else {
-                s_s3_client_remove_meta_request_threaded(client, meta_request);
+                s_s3_client_remove_meta_request_threaded(work_shard, meta_request);
             }
         }
 
-        aws_linked_list_move_all_front(&client->threaded_data.meta_requests, &meta_requests_work_remaining);
+        /* Put the meta requests that were set aside back at the front of their priority, preserving their order. */
+        while (!aws_linked_list_empty(&meta_requests_work_remaining)) {
+            struct aws_linked_list_node *meta_request_node = aws_linked_list_pop_back(&meta_requests_work_remaining);
+            struct aws_s3_meta_request *meta_request =
+                AWS_CONTAINER_OF(meta_request_node, struct aws_s3_meta_request, client_process_work_threaded_data);
+
+            s_s3_client_insert_meta_request_threaded(work_shard, meta_request, true);
+        }
+    }
+
+    /* The number of requests in flight is shared with the other shards, so if that is what stopped this shard, it has
+     * to be woken up when another shard's request is destroyed. */
+    if (num_requests_in_flight >= max_requests_in_flight &&
+        !aws_linked_list_empty(&work_shard->threaded_data.meta_requests)) {
+        waiting_for_capacity = true;
+    }
+
+    if (waiting_for_capacity) {
+        s_s3_client_work_shard_wait_for_capacity(work_shard, capacity_release_count);
     }
 }
 
@@ -1232,59 +2442,213 @@ static void s_s3_client_prepare_callback_queue_request(
     AWS_PRECONDITION(meta_request);
     AWS_PRECONDITION(request);
 
-    struct aws_s3_client *client = user_data;
-    AWS_PRECONDITION(client);
+    struct aws_s3_client_work_shard *work_shard = user_data;
+    AWS_PRECONDITION(work_shard);
 
-    if (error_code != AWS_ERROR_SUCCESS) {
+    /* A request that failed to be prepared, or whose response was read from the block cache, is done without being
+     * sent. */
+    const bool send_request = error_code == AWS_ERROR_SUCCESS && !request->send_data.served_from_cache;
+
+    if (!send_request) {
         aws_s3_meta_request_finished_request(meta_request, request, error_code);
 
         aws_s3_request_release(request);
         request = NULL;
     }
 
-    aws_s3_client_lock_synced_data(client);
+    aws_s3_client_work_shard_lock_synced_data(work_shard);
 
-    if (error_code == AWS_ERROR_SUCCESS) {
-        aws_linked_list_push_back(&client->synced_data.prepared_requests, &request->node);
+    if (send_request) {
+        aws_linked_list_push_back(&work_shard->synced_data.prepared_requests, &request->node);
     } else {
-        ++client->synced_data.num_failed_prepare_requests;
+        ++work_shard->synced_data.num_unsent_prepare_requests;
     }
 
-    s_s3_client_schedule_process_work_synced(client);
-    aws_s3_client_unlock_synced_data(client);
+    s_s3_client_work_shard_schedule_process_work_synced(work_shard);
+    aws_s3_client_work_shard_unlock_synced_data(work_shard);
+}
+
+void aws_s3_client_update_max_allowed_connections_threaded(struct aws_s3_client *client, uint64_t now_ns) {
+    AWS_PRECONDITION(client);
+
+    if (!client->enable_adaptive_connections) {
+        return;
+    }
+
+    size_t num_bytes_transferred = aws_atomic_load_int(&client->stats.num_bytes_transferred);
+    size_t num_slow_down_errors = aws_atomic_load_int(&client->stats.num_slow_down_errors);
+
+    /* The first call only establishes a baseline to measure against. */
+    if (client->threaded_data.connection_controller.last_sample_timestamp_ns == 0) {
+        goto record_sample;
+    }
+
+    uint64_t elapsed_ns = now_ns - client->threaded_data.connection_controller.last_sample_timestamp_ns;
+
+    if (now_ns < client->threaded_data.connection_controller.last_sample_timestamp_ns ||
+        elapsed_ns < s_connection_controller_sample_interval_ns) {
+        return;
+    }
+
+    /* Never go above the controller's ceiling (which can be above what the throughput target alone allows), and never
+     * below one VIP worth of connections. */
+    uint32_t ceiling = client->max_adaptive_connections > 0 ? client->max_adaptive_connections
+                                                             : s_s3_client_get_static_max_connections(client);
+
+    uint32_t floor = g_max_num_connections_per_vip < ceiling ? g_max_num_connections_per_vip : ceiling;
+
+    uint32_t max_allowed_connections = (uint32_t)aws_atomic_load_int(&client->max_allowed_connections);
+    uint32_t new_max_allowed_connections = max_allowed_connections;
+    uint32_t num_requests_network_io = s_s3_client_get_num_requests_network_io(client, AWS_S3_META_REQUEST_TYPE_MAX);
+
+    double elapsed_secs = (double)elapsed_ns / (double)s_connection_controller_sample_interval_ns;
+    double throughput = (double)(num_bytes_transferred -
+                                 client->threaded_data.connection_controller.last_num_bytes_transferred) /
+                        elapsed_secs;
+    double throughput_per_connection =
+        num_requests_network_io > 0 ? throughput / (double)num_requests_network_io : 0.0;
+
+    bool throttled =
+        (num_slow_down_errors - client->threaded_data.connection_controller.last_num_slow_down_errors) > 0;
+
+    if (throttled) {
+        /* Multiplicative decrease: S3 is asking us to back off. */
+        new_max_allowed_connections =
+            (uint32_t)((double)max_allowed_connections * s_connection_controller_multiplicative_decrease);
+    } else if (num_requests_network_io >= max_allowed_connections) {
+        /* Additive increase: we are using every connection we are allowed, so try more as long as the last increase
+         * didn't noticeably hurt per-connection throughput. */
+        double last_throughput_per_connection =
+            client->threaded_data.connection_controller.last_throughput_bytes_per_sec_per_connection;
+
+        if (last_throughput_per_connection == 0.0 ||
+            throughput_per_connection >=
+                last_throughput_per_connection * (1.0 - s_connection_controller_throughput_tolerance)) {
+            new_max_allowed_connections = max_allowed_connections + s_connection_controller_additive_increase;
+        }
+    }
+
+    if (new_max_allowed_connections < floor) {
+        new_max_allowed_connections = floor;
+    } else if (new_max_allowed_connections > ceiling) {
+        new_max_allowed_connections = ceiling;
+    }
+
+    if (new_max_allowed_connections != max_allowed_connections) {
+        AWS_LOGF_INFO(
+            AWS_LS_S3_CLIENT_STATS,
+            "id=%p Adaptive connection limit changed from %d to %d (throughput-bytes-per-sec:%.0f  "
+            "per-connection:%.0f  throttled:%d)",
+            (void *)client,
+            max_allowed_connections,
+            new_max_allowed_connections,
+            throughput,
+            throughput_per_connection,
+            (int)throttled);
+
+        aws_atomic_store_int(&client->max_allowed_connections, (size_t)new_max_allowed_connections);
+    }
+
+    client->threaded_data.connection_controller.last_throughput_bytes_per_sec = throughput;
+
+    if (num_requests_network_io > 0) {
+        client->threaded_data.connection_controller.last_throughput_bytes_per_sec_per_connection =
+            throughput_per_connection;
+    }
+
+record_sample:
+
+    client->threaded_data.connection_controller.last_sample_timestamp_ns = now_ns;
+    client->threaded_data.connection_controller.last_num_bytes_transferred = num_bytes_transferred;
+    client->threaded_data.connection_controller.last_num_slow_down_errors = num_slow_down_errors;
+}
+
+/* Ask the SlowDown throttle of the request's endpoint whether the request can be sent now. If not, lowers
+ * *in_out_throttle_delay_ns to the time until the throttle admits another request, when that is sooner. */
+static bool s_s3_client_admit_request(
+    struct aws_s3_request *request,
+    uint64_t now_ns,
+    uint64_t *in_out_throttle_delay_ns) {
+    AWS_PRECONDITION(request);
+    AWS_PRECONDITION(request->meta_request);
+    AWS_PRECONDITION(in_out_throttle_delay_ns);
+
+    struct aws_s3_endpoint *endpoint = request->meta_request->endpoint;
+
+    if (endpoint == NULL || endpoint->slow_down_throttle == NULL) {
+        return true;
+    }
+
+    uint64_t retry_after_ns = 0;
+
+    if (aws_s3_slow_down_throttle_try_admit(endpoint->slow_down_throttle, now_ns, &retry_after_ns)) {
+        return true;
+    }
+
+    if (*in_out_throttle_delay_ns == 0 || retry_after_ns < *in_out_throttle_delay_ns) {
+        *in_out_throttle_delay_ns = retry_after_ns;
+    }
+
+    return false;
 }
 
-void aws_s3_client_update_connections_threaded(struct aws_s3_client *client) {
+void aws_s3_client_update_connections_threaded(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
+
+    struct aws_s3_client *client = work_shard->client;
     AWS_PRECONDITION(client);
     AWS_PRECONDITION(client->vtable);
 
+    const size_t capacity_release_count = aws_atomic_load_int(&client->capacity_release_count);
+
     struct aws_linked_list left_over_requests;
     aws_linked_list_init(&left_over_requests);
 
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    /* Shortest time until a SlowDown throttle that held back a request admits another one. 0 if none held any back. */
+    uint64_t throttle_delay_ns = 0;
+
+    /* The network IO counts are shared by all work shards. Shards checking them at the same time can each start a
+     * request against the last free slot, so the total can briefly go over by up to the number of shards; the
+     * endpoint's connection manager still caps the actual number of connections. */
     while (s_s3_client_get_num_requests_network_io(client, AWS_S3_META_REQUEST_TYPE_MAX) <
                aws_s3_client_get_max_active_connections(client, NULL) &&
-           !aws_linked_list_empty(&client->threaded_data.request_queue)) {
+           work_shard->threaded_data.request_queue_size > 0) {
 
-        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(client);
+        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(work_shard);
         const uint32_t max_active_connections = aws_s3_client_get_max_active_connections(client, request->meta_request);
 
         /* Unless the request is marked "always send", if this meta request has a finish result, then finish the request
-         * now and release it. */
-        if (!request->always_send && aws_s3_meta_request_has_finish_result(request->meta_request)) {
+         * now and release it. Same for a request that is no longer needed. */
+        if ((!request->always_send && aws_s3_meta_request_has_finish_result(request->meta_request)) ||
+            aws_s3_request_is_cancelled(request)) {
             aws_s3_meta_request_finished_request(request->meta_request, request, AWS_ERROR_S3_CANCELED);
 
             aws_s3_request_release(request);
             request = NULL;
         } else if (
-            s_s3_client_get_num_requests_network_io(client, request->meta_request->type) < max_active_connections) {
-            s_s3_client_create_connection_for_request(client, request);
-        } else {
+            s_s3_client_get_num_requests_network_io(client, request->meta_request->type) >= max_active_connections) {
             /* Push the request into the left-over list to be used in a future call of this function. */
             aws_linked_list_push_back(&left_over_requests, &request->node);
+        } else if (!s_s3_client_admit_request(request, now_ns, &throttle_delay_ns)) {
+            /* The endpoint is being throttled, retry once it admits requests again. */
+            aws_linked_list_push_back(&left_over_requests, &request->node);
+        } else {
+            s_s3_client_create_connection_for_request(client, request);
         }
     }
 
-    aws_s3_client_queue_requests_threaded(client, &left_over_requests, true);
+    aws_s3_client_queue_requests_threaded(work_shard, &left_over_requests, true);
+
+    if (throttle_delay_ns > 0) {
+        s_s3_client_work_shard_wait_for_throttle_threaded(work_shard, throttle_delay_ns);
+    }
+
+    if (work_shard->threaded_data.request_queue_size > 0) {
+        s_s3_client_work_shard_wait_for_capacity(work_shard, capacity_release_count);
+    }
 }
 
 static void s_s3_client_acquired_retry_token(
@@ -1321,6 +2685,11 @@ static void s_s3_client_create_connection_for_request_default(
     AWS_PRECONDITION(meta_request);
 
     aws_atomic_fetch_add(&client->stats.num_requests_network_io[meta_request->type], 1);
+    aws_atomic_fetch_add(&meta_request->stats.num_requests_network_io, 1);
+
+    if (request->network_io_start_timestamp_ns == 0) {
+        aws_high_res_clock_get_ticks(&request->network_io_start_timestamp_ns);
+    }
 
     struct aws_s3_connection *connection = aws_mem_calloc(client->allocator, 1, sizeof(struct aws_s3_connection));
 
@@ -1406,8 +2775,15 @@ static void s_s3_client_acquired_retry_token(
     /* TODO: not a blocker, consider managing the life time of aws_s3_client from aws_s3_endpoint to simplify usage */
     aws_s3_client_acquire(client);
 
+    aws_high_res_clock_get_ticks(&request->metrics.connection_acquire_start_timestamp_ns);
+
+    /* Every attempt picks its VIP again, so that retries move away from a VIP that is failing. */
+    AWS_ASSERT(connection->vip == NULL);
+    connection->http_connection_manager =
+        aws_s3_endpoint_acquire_vip_connection_manager(endpoint, meta_request->cpu_group, &connection->vip);
+
     client->vtable->acquire_http_connection(
-        endpoint->http_connection_manager, s_s3_client_on_acquire_http_connection, connection);
+        connection->http_connection_manager, s_s3_client_on_acquire_http_connection, connection);
 
     return;
 
@@ -1436,6 +2812,8 @@ static void s_s3_client_on_acquire_http_connection(
     struct aws_s3_client *client = endpoint->user_data;
     AWS_ASSERT(client != NULL);
 
+    aws_high_res_clock_get_ticks(&request->metrics.connection_acquire_end_timestamp_ns);
+
     if (error_code != AWS_ERROR_SUCCESS) {
         AWS_LOGF_ERROR(
             AWS_LS_S3_ENDPOINT,
@@ -1468,6 +2846,50 @@ error_fail:
     aws_s3_client_release(client); /* kept since this callback was registered */
 }
 
+/* Called once an attempt at sending the connection's request is over. Records how the attempt went with the VIP it was
+ * sent to, and gives the HTTP connection back to the connection manager it came from. */
+static void s_s3_client_connection_release_attempt(
+    struct aws_s3_connection *connection,
+    int error_code,
+    enum aws_s3_connection_finish_code finish_code) {
+    AWS_PRECONDITION(connection);
+    AWS_PRECONDITION(connection->endpoint);
+
+    struct aws_s3_request *request = connection->request;
+    AWS_PRECONDITION(request);
+
+    if (connection->vip != NULL) {
+        /* Only count failures that say something about the VIP: not getting a connection at all, getting no response,
+         * or getting a 500. SlowDowns are about the bucket, not the VIP, and are dealt with by the throttle. */
+        bool vip_failed = finish_code != AWS_S3_CONNECTION_FINISH_CODE_SUCCESS && error_code != AWS_ERROR_S3_CANCELED &&
+                          (connection->http_connection == NULL || request->send_data.response_status == 0 ||
+                           error_code == AWS_ERROR_S3_INTERNAL_ERROR);
+
+        uint64_t num_bytes = aws_s3_request_get_body_size(request) + request->send_data.num_response_body_bytes;
+        uint64_t duration_ns = 0;
+        uint64_t now_ns = 0;
+
+        if (request->metrics.send_start_timestamp_ns > 0 && !aws_high_res_clock_get_ticks(&now_ns) &&
+            now_ns > request->metrics.send_start_timestamp_ns) {
+            duration_ns = now_ns - request->metrics.send_start_timestamp_ns;
+        }
+
+        aws_s3_endpoint_release_vip(connection->endpoint, connection->vip, vip_failed, num_bytes, duration_ns);
+        connection->vip = NULL;
+    }
+
+    if (connection->http_connection != NULL) {
+        AWS_ASSERT(connection->http_connection_manager);
+
+        aws_http_connection_manager_release_connection(
+            connection->http_connection_manager, connection->http_connection);
+
+        connection->http_connection = NULL;
+    }
+
+    connection->http_connection_manager = NULL;
+}
+
 /* Called by aws_s3_meta_request when it has finished using this connection for a single request. */
 void aws_s3_client_notify_connection_finished(
     struct aws_s3_client *client,
@@ -1488,6 +2910,9 @@ void aws_s3_client_notify_connection_finished(
     struct aws_s3_endpoint *endpoint = meta_request->endpoint;
     AWS_PRECONDITION(endpoint);
 
+    /* Grab the work shard now; the meta request can go away once the request is released below. */
+    struct aws_s3_client_work_shard *work_shard = s_s3_client_get_work_shard(client, meta_request);
+
     /* If we're trying to setup a retry... */
     if (finish_code == AWS_S3_CONNECTION_FINISH_CODE_RETRY) {
 
@@ -1530,20 +2955,23 @@ void aws_s3_client_notify_connection_finished(
                 error_type = AWS_RETRY_ERROR_TYPE_SERVER_ERROR;
                 break;
 
-            case AWS_ERROR_S3_SLOW_DOWN:
+            case AWS_ERROR_S3_SLOW_DOWN: {
                 error_type = AWS_RETRY_ERROR_TYPE_THROTTLING;
-                break;
-        }
-
-        if (connection->http_connection != NULL) {
-            AWS_ASSERT(endpoint->http_connection_manager);
+                aws_atomic_fetch_add(&client->stats.num_slow_down_errors, 1);
 
-            aws_http_connection_manager_release_connection(
-                endpoint->http_connection_manager, connection->http_connection);
+                /* Slow down every request to this endpoint, not just the retry of this one. */
+                uint64_t now_ns = 0;
 
-            connection->http_connection = NULL;
+                if (endpoint != NULL && endpoint->slow_down_throttle != NULL &&
+                    !aws_high_res_clock_get_ticks(&now_ns)) {
+                    aws_s3_slow_down_throttle_on_slow_down(endpoint->slow_down_throttle, now_ns);
+                }
+                break;
+            }
         }
 
+        s_s3_client_connection_release_attempt(connection, error_code, finish_code);
+
         /* Ask the retry strategy to schedule a retry of the request. */
         if (aws_retry_strategy_schedule_retry(
                 connection->retry_token, error_type, s_s3_client_retry_ready, connection)) {
@@ -1562,6 +2990,9 @@ void aws_s3_client_notify_connection_finished(
             goto reset_connection;
         }
 
+        aws_atomic_fetch_add(&meta_request->stats.num_retries, 1);
+        ++request->metrics.num_retries;
+
         return;
     }
 
@@ -1586,16 +3017,30 @@ reset_connection:
     }
 
     aws_atomic_fetch_sub(&client->stats.num_requests_network_io[meta_request->type], 1);
+    aws_atomic_fetch_sub(&meta_request->stats.num_requests_network_io, 1);
+
+    if (finish_code == AWS_S3_CONNECTION_FINISH_CODE_SUCCESS) {
+        size_t num_bytes_transferred =
+            aws_s3_request_get_body_size(request) + (size_t)request->send_data.num_response_body_bytes;
+        aws_atomic_fetch_add(&client->stats.num_bytes_transferred, num_bytes_transferred);
+        aws_atomic_fetch_add(&meta_request->stats.num_bytes_transferred, num_bytes_transferred);
+        aws_atomic_fetch_add(&meta_request->stats.num_requests_succeeded, 1);
+
+        uint64_t now_ns = 0;
+
+        if (request->network_io_start_timestamp_ns > 0 && !aws_high_res_clock_get_ticks(&now_ns) &&
+            now_ns > request->network_io_start_timestamp_ns) {
+            aws_atomic_fetch_add(
+                &meta_request->stats.total_request_latency_ns,
+                (size_t)(now_ns - request->network_io_start_timestamp_ns));
+        }
+    } else {
+        aws_atomic_fetch_add(&meta_request->stats.num_requests_failed, 1);
+    }
 
     aws_s3_meta_request_finished_request(meta_request, request, error_code);
 
-    if (connection->http_connection != NULL) {
-        AWS_ASSERT(endpoint->http_connection_manager);
-
-        aws_http_connection_manager_release_connection(endpoint->http_connection_manager, connection->http_connection);
-
-        connection->http_connection = NULL;
-    }
+    s_s3_client_connection_release_attempt(connection, error_code, finish_code);
 
     if (connection->request != NULL) {
         aws_s3_request_release(connection->request);
@@ -1611,9 +3056,7 @@ reset_connection:
     aws_mem_release(client->allocator, connection);
     connection = NULL;
 
-    aws_s3_client_lock_synced_data(client);
-    s_s3_client_schedule_process_work_synced(client);
-    aws_s3_client_unlock_synced_data(client);
+    s_s3_client_schedule_process_work_capacity_released(client, work_shard);
 }
 
 static void s_s3_client_prepare_request_callback_retry_request(
@@ -1711,9 +3154,19 @@ void aws_s3_client_notify_request_destroyed(struct aws_s3_client *client, struct
     AWS_PRECONDITION(request);
 
     if (request->tracked_by_client) {
-        aws_s3_client_lock_synced_data(client);
-        aws_atomic_fetch_sub(&client->stats.num_requests_in_flight, 1);
-        s_s3_client_schedule_process_work_synced(client);
-        aws_s3_client_unlock_synced_data(client);
+        if (request->buffer_pool_reservation > 0) {
+            aws_s3_buffer_pool_release_reservation(client->buffer_pool, request->buffer_pool_reservation);
+            request->buffer_pool_reservation = 0;
+        }
+
+        size_t num_requests_in_flight = aws_atomic_fetch_sub(&client->stats.num_requests_in_flight, 1);
+        aws_atomic_fetch_sub(&request->meta_request->stats.num_requests_in_flight, 1);
+
+        if (num_requests_in_flight == 1 && client->client_context != NULL) {
+            aws_s3_client_context_update_busy_client(client->client_context, client);
+        }
+
+        s_s3_client_schedule_process_work_capacity_released(
+            client, s_s3_client_get_work_shard(client, request->meta_request));
     }
 }
@@ -0,0 +1,136 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_client_context.h"
+#include "aws/s3/private/s3_client_impl.h"
+#include <aws/io/event_loop.h>
+#include <inttypes.h>
+#include <math.h>
+
+static void s_s3_client_context_destroy(void *user_data) {
+    struct aws_s3_client_context *context = user_data;
+
+    AWS_LOGF_DEBUG(AWS_LS_S3_CLIENT, "id=%p Destroying client context.", (void *)context);
+
+    AWS_ASSERT(aws_atomic_load_int(&context->num_busy_clients) == 0);
+
+    aws_event_loop_group_release(context->body_streaming_elg);
+    aws_mutex_clean_up(&context->synced_data.lock);
+    aws_mem_release(context->allocator, context);
+}
+
+struct aws_s3_client_context *aws_s3_client_context_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_client_context_options *options) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(options);
+
+    if (options->throughput_target_gbps < 0.0) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_CLIENT, "Cannot create client context; throughput_target_gbps cannot be less than 0.");
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_s3_client_context *context = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_client_context));
+    context->allocator = allocator;
+    aws_atomic_init_int(&context->num_busy_clients, 0);
+
+    if (aws_mutex_init(&context->synced_data.lock)) {
+        aws_mem_release(allocator, context);
+        return NULL;
+    }
+
+    context->body_streaming_elg =
+        aws_event_loop_group_new_default(allocator, options->num_body_streaming_threads, NULL);
+
+    if (context->body_streaming_elg == NULL) {
+        aws_mutex_clean_up(&context->synced_data.lock);
+        aws_mem_release(allocator, context);
+        return NULL;
+    }
+
+    uint32_t max_active_connections = options->max_active_connections;
+
+    /* Same as a client's own limit: enough VIPs for the throughput target, at the most connections per VIP. */
+    if (max_active_connections == 0 && options->throughput_target_gbps > 0.0) {
+        uint32_t num_vips = (uint32_t)ceil(options->throughput_target_gbps / g_throughput_per_vip_gbps);
+        max_active_connections = num_vips * g_max_num_connections_per_vip;
+    }
+
+    *((uint32_t *)&context->max_active_connections) = max_active_connections;
+    *((double *)&context->throughput_target_gbps) = options->throughput_target_gbps;
+
+    aws_ref_count_init(&context->ref_count, context, s_s3_client_context_destroy);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_CLIENT,
+        "id=%p Created client context with a budget of %" PRIu32 " active connections.",
+        (void *)context,
+        max_active_connections);
+
+    return context;
+}
+
+void aws_s3_client_context_acquire(struct aws_s3_client_context *context) {
+    AWS_FATAL_PRECONDITION(context);
+    aws_ref_count_acquire(&context->ref_count);
+}
+
+void aws_s3_client_context_release(struct aws_s3_client_context *context) {
+    if (context) {
+        aws_ref_count_release(&context->ref_count);
+    }
+}
+
+void aws_s3_client_context_update_busy_client(struct aws_s3_client_context *context, struct aws_s3_client *client) {
+    AWS_PRECONDITION(context);
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(client->client_context == context);
+
+    aws_mutex_lock(&context->synced_data.lock);
+
+    const bool is_busy = aws_atomic_load_int(&client->stats.num_requests_in_flight) > 0;
+    const bool was_busy = aws_atomic_load_int(&client->is_busy_in_client_context) != 0;
+
+    /* The client's flag is set before it is counted in, and cleared after it is counted out, so that a lock-free
+     * reader seeing the flag set never counts the client twice, just once too few for a moment at most. */
+    if (is_busy && !was_busy) {
+        aws_atomic_store_int(&client->is_busy_in_client_context, 1);
+        aws_atomic_fetch_add(&context->num_busy_clients, 1);
+    } else if (!is_busy && was_busy) {
+        AWS_ASSERT(aws_atomic_load_int(&context->num_busy_clients) > 0);
+        aws_atomic_fetch_sub(&context->num_busy_clients, 1);
+        aws_atomic_store_int(&client->is_busy_in_client_context, 0);
+    }
+
+    aws_mutex_unlock(&context->synced_data.lock);
+}
+
+uint32_t aws_s3_client_context_get_connection_share(
+    struct aws_s3_client_context *context,
+    struct aws_s3_client *client) {
+    AWS_PRECONDITION(context);
+    AWS_PRECONDITION(client);
+
+    if (context->max_active_connections == 0) {
+        return UINT32_MAX;
+    }
+
+    uint32_t num_busy_clients = (uint32_t)aws_atomic_load_int(&context->num_busy_clients);
+
+    if (!aws_atomic_load_int(&client->is_busy_in_client_context)) {
+        ++num_busy_clients;
+    }
+
+    /* A client being counted in concurrently can leave the count at 0 for a moment. */
+    if (num_busy_clients == 0) {
+        num_busy_clients = 1;
+    }
+
+    uint32_t share = context->max_active_connections / num_busy_clients;
+
+    return share > 0 ? share : 1;
+}
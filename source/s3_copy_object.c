@@ -12,6 +12,9 @@
 /* Objects with size smaller than the constant below are bypassed as S3 CopyObject instead of multipart copy */
 static const size_t s_multipart_copy_minimum_object_size = 1L * 1024L * 1024L * 1024L;
 
+/* Parts of a multipart copy are never smaller than this. */
+static const uint64_t s_multipart_copy_minimum_part_size = 64ULL * 1024ULL * 1024ULL;
+
 static const size_t s_etags_initial_capacity = 16;
 static const struct aws_byte_cursor s_upload_id = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("UploadId");
 static const size_t s_complete_multipart_upload_init_body_size_bytes = 512;
@@ -103,6 +106,14 @@ struct aws_s3_meta_request *aws_s3_meta_request_copy_object_new(
     copy_object->synced_data.total_num_parts = UNKNOWN_NUM_PARTS;
     copy_object->threaded_update_data.next_part_number = 1;
 
+    copy_object->part_message_template = aws_s3_upload_part_message_template_new(allocator, options->message);
+
+    if (copy_object->part_message_template == NULL) {
+        /* The base is fully set up by now, and is cleaned up along with everything else by releasing it. */
+        aws_s3_meta_request_release(&copy_object->base);
+        return NULL;
+    }
+
     AWS_LOGF_DEBUG(AWS_LS_S3_META_REQUEST, "id=%p Created new CopyObject Meta Request.", (void *)&copy_object->base);
 
     return &copy_object->base;
@@ -122,6 +133,9 @@ static void s_s3_meta_request_copy_object_destroy(struct aws_s3_meta_request *me
     aws_string_destroy(copy_object->upload_id);
     copy_object->upload_id = NULL;
 
+    aws_http_message_release(copy_object->part_message_template);
+    copy_object->part_message_template = NULL;
+
     for (size_t etag_index = 0; etag_index < aws_array_list_length(&copy_object->synced_data.etag_list); ++etag_index) {
         struct aws_string *etag = NULL;
 
@@ -387,7 +401,12 @@ static int s_s3_copy_object_prepare_request(struct aws_s3_meta_request *meta_req
 
         /* Prepares the CreateMultipartUpload sub-request. */
         case AWS_S3_COPY_OBJECT_REQUEST_TAG_CREATE_MULTIPART_UPLOAD: {
-            uint64_t part_size_uint64 = copy_object->synced_data.content_length / (uint64_t)g_s3_max_num_upload_parts;
+            /* Parts are sized for the copy to be done in about as many parts as there can be requests in flight for
+             * this meta request, not by the client's part size, which is meant for moving bytes through the client. */
+            uint64_t part_size_uint64 = aws_s3_calculate_copy_part_size(
+                copy_object->synced_data.content_length,
+                s_multipart_copy_minimum_part_size,
+                aws_s3_client_get_max_active_connections(meta_request->client, meta_request));
 
             if (part_size_uint64 > SIZE_MAX) {
                 AWS_LOGF_ERROR(
@@ -402,11 +421,6 @@ static int s_s3_copy_object_prepare_request(struct aws_s3_meta_request *meta_req
 
             size_t part_size = (size_t)part_size_uint64;
 
-            const size_t MIN_PART_SIZE = 64L * 1024L * 1024L; /* minimum partition size */
-            if (part_size < MIN_PART_SIZE) {
-                part_size = MIN_PART_SIZE;
-            }
-
             uint32_t num_parts = (uint32_t)(copy_object->synced_data.content_length / part_size);
 
             if ((copy_object->synced_data.content_length % part_size) > 0) {
@@ -424,7 +438,7 @@ static int s_s3_copy_object_prepare_request(struct aws_s3_meta_request *meta_req
 
             /* Create the message to create a new multipart upload. */
             message = aws_s3_create_multipart_upload_message_new(
-                meta_request->allocator, meta_request->initial_request_message);
+                meta_request->allocator, meta_request->initial_request_message, AWS_SCA_NONE);
 
             break;
         }
@@ -451,7 +465,7 @@ static int s_s3_copy_object_prepare_request(struct aws_s3_meta_request *meta_req
 
             message = aws_s3_upload_part_copy_message_new(
                 meta_request->allocator,
-                meta_request->initial_request_message,
+                copy_object->part_message_template,
                 &request->request_body,
                 request->part_number,
                 range_start,
@@ -482,7 +496,9 @@ static int s_s3_copy_object_prepare_request(struct aws_s3_meta_request *meta_req
                 meta_request->initial_request_message,
                 &request->request_body,
                 copy_object->upload_id,
-                &copy_object->synced_data.etag_list);
+                &copy_object->synced_data.etag_list,
+                NULL,
+                AWS_SCA_NONE);
 
             break;
         }
@@ -1,4 +1,5 @@
 #include "aws/s3/private/s3_default_meta_request.h"
+#include "aws/s3/private/s3_checksums.h"
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
 #include "aws/s3/private/s3_request_messages.h"
@@ -92,6 +93,9 @@ struct aws_s3_meta_request *aws_s3_meta_request_default_new(
     }
 
     meta_request_default->content_length = (size_t)content_length;
+    meta_request_default->deliver_body_inline = options->small_object_hint;
+    meta_request_default->stream_body_directly =
+        options->enable_direct_body_streaming && options->headers_callback == NULL;
 
     AWS_LOGF_DEBUG(AWS_LS_S3_META_REQUEST, "id=%p Created new Default Meta Request.", (void *)meta_request_default);
 
@@ -137,7 +141,13 @@ static bool s_s3_meta_request_default_update(
                 goto has_work_remaining;
             }
 
-            request = aws_s3_request_new(meta_request, 0, 1, AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS);
+            uint32_t request_flags = AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS;
+
+            if (meta_request_default->stream_body_directly) {
+                request_flags |= AWS_S3_REQUEST_FLAG_STREAM_RESPONSE_BODY_DIRECTLY;
+            }
+
+            request = aws_s3_request_new(meta_request, 0, 1, request_flags);
 
             AWS_LOGF_DEBUG(
                 AWS_LS_S3_META_REQUEST,
@@ -207,6 +217,20 @@ no_work_remaining:
     return work_remaining;
 }
 
+/* Returns true if the message already carries a checksum of any algorithm, which is then left as it is. */
+static bool s_s3_meta_request_default_has_checksum_header(struct aws_http_message *message) {
+    struct aws_http_headers *headers = aws_http_message_get_headers(message);
+
+    for (int algorithm = AWS_SCA_NONE + 1; algorithm <= AWS_SCA_SHA256; ++algorithm) {
+        if (aws_http_headers_has(
+                headers, aws_s3_checksum_get_header_name((enum aws_s3_checksum_algorithm)algorithm))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /* Given a request, prepare it for sending based on its description. */
 static int s_s3_meta_request_default_prepare_request(
     struct aws_s3_meta_request *meta_request,
@@ -217,10 +241,19 @@ static int s_s3_meta_request_default_prepare_request(
     AWS_PRECONDITION(meta_request_default);
 
     if (meta_request_default->content_length > 0 && request->num_times_prepared == 0) {
-        aws_byte_buf_init(&request->request_body, meta_request->allocator, meta_request_default->content_length);
-
-        if (aws_s3_meta_request_read_body(meta_request, &request->request_body)) {
-            return AWS_OP_ERR;
+        if (aws_s3_meta_request_has_send_buffers(meta_request) &&
+            aws_array_list_length(&meta_request->send_buffers) == 1) {
+            struct aws_s3_send_buffer *send_buffer = NULL;
+            aws_array_list_get_at_ptr(&meta_request->send_buffers, (void **)&send_buffer, 0);
+
+            /* A body that is one send buffer is sent from it as it is. */
+            request->request_body = aws_byte_buf_from_array(send_buffer->data.ptr, send_buffer->data.len);
+        } else {
+            aws_byte_buf_init(&request->request_body, meta_request->allocator, meta_request_default->content_length);
+
+            if (aws_s3_meta_request_read_body(meta_request, 0, &request->request_body)) {
+                return AWS_OP_ERR;
+            }
         }
     }
 
@@ -231,7 +264,26 @@ static int s_s3_meta_request_default_prepare_request(
         aws_s3_message_util_add_content_md5_header(meta_request->allocator, &request->request_body, message);
     }
 
-    aws_s3_message_util_assign_body(meta_request->allocator, &request->request_body, message);
+    bool has_checksum_header = s_s3_meta_request_default_has_checksum_header(message);
+
+    if (meta_request->payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER &&
+        meta_request->checksum_algorithm != AWS_SCA_NONE && !has_checksum_header) {
+        if (aws_s3_message_util_assign_chunked_body(
+                meta_request->allocator, &request->request_body, meta_request->checksum_algorithm, message) == NULL) {
+            aws_http_message_release(message);
+            return AWS_OP_ERR;
+        }
+    } else {
+        if (meta_request->checksum_algorithm != AWS_SCA_NONE && !has_checksum_header) {
+            if (aws_s3_message_util_add_checksum_header(
+                    meta_request->allocator, &request->request_body, meta_request->checksum_algorithm, message, NULL)) {
+                aws_http_message_release(message);
+                return AWS_OP_ERR;
+            }
+        }
+
+        aws_s3_message_util_assign_body(meta_request->allocator, &request->request_body, message);
+    }
 
     aws_s3_request_setup_send_data(request, message);
 
@@ -268,15 +320,45 @@ static void s_s3_meta_request_default_request_finished(
         meta_request->headers_callback = NULL;
     }
 
+    /* There is only ever one part, so there is nothing to order, and the body can go out right here instead of being
+     * handed to a body streaming task. */
+    bool delivered_inline = false;
+
+    if (error_code == AWS_ERROR_SUCCESS && meta_request_default->deliver_body_inline &&
+        !aws_s3_meta_request_has_finish_result(meta_request)) {
+        struct aws_byte_cursor body_cursor = aws_byte_cursor_from_buf(&request->send_data.response_body);
+
+        if (meta_request->body_callback != NULL && body_cursor.len > 0 &&
+            meta_request->body_callback(meta_request, &body_cursor, 0, meta_request->user_data)) {
+            error_code = aws_last_error_or_unknown();
+        }
+
+        delivered_inline = true;
+    }
+
     aws_s3_meta_request_lock_synced_data(meta_request);
     meta_request_default->synced_data.cached_response_status = request->send_data.response_status;
     meta_request_default->synced_data.request_completed = true;
     meta_request_default->synced_data.request_error_code = error_code;
 
+    if (delivered_inline) {
+        ++meta_request->synced_data.num_parts_delivery_sent;
+        ++meta_request->synced_data.num_parts_delivery_completed;
+
+        if (error_code == AWS_ERROR_SUCCESS) {
+            ++meta_request->synced_data.num_parts_delivery_succeeded;
+        } else {
+            ++meta_request->synced_data.num_parts_delivery_failed;
+        }
+    }
+
     if (error_code == AWS_ERROR_SUCCESS) {
-        aws_s3_meta_request_stream_response_body_synced(meta_request, request);
+        if (!delivered_inline) {
+            aws_s3_meta_request_stream_response_body_synced(meta_request, request);
+        }
     } else {
-        aws_s3_meta_request_set_fail_synced(meta_request, request, error_code);
+        /* A failure of the body callback is not the request's, and has no error response to go with it. */
+        aws_s3_meta_request_set_fail_synced(meta_request, delivered_inline ? NULL : request, error_code);
     }
 
     aws_s3_meta_request_unlock_synced_data(meta_request);
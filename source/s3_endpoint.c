@@ -8,7 +8,9 @@
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_default_meta_request.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_slow_down_throttle.h"
 #include "aws/s3/private/s3_util.h"
+#include "aws/s3/private/s3_vip_balancer.h"
 
 #include <aws/auth/credentials.h>
 #include <aws/common/assert.h>
@@ -38,6 +40,9 @@ static const uint32_t s_connection_timeout_ms = 3000;
 static const uint16_t s_http_port = 80;
 static const uint16_t s_https_port = 443;
 
+/* How often the host resolver is asked for the endpoint's addresses, to pick up VIPs it has discovered since. */
+static const uint64_t s_vip_refresh_interval_secs = 1;
+
 static void s_s3_endpoint_on_host_resolver_address_resolved(
     struct aws_host_resolver *resolver,
     const struct aws_string *host_name,
@@ -47,16 +52,56 @@ static void s_s3_endpoint_on_host_resolver_address_resolved(
 
 static struct aws_http_connection_manager *s_s3_endpoint_create_http_connection_manager(
     struct aws_s3_endpoint *endpoint,
-    const struct aws_string *host_name,
-    struct aws_client_bootstrap *client_bootstrap,
-    const struct aws_tls_connection_options *tls_connection_options,
-    uint32_t max_connections,
-    int port);
+    struct aws_byte_cursor host,
+    struct aws_client_bootstrap *client_bootstrap);
 
 static void s_s3_endpoint_http_connection_manager_shutdown_callback(void *user_data);
 
 static void s_s3_endpoint_ref_count_zero(void *user_data);
 
+static void s_s3_endpoint_resolve_host(struct aws_s3_endpoint *endpoint);
+
+/* Clean up everything but the connection managers, which shut down asynchronously, and the host name, which is owned
+ * by whoever created the endpoint once the endpoint was successfully created. */
+static void s_s3_endpoint_clean_up(struct aws_s3_endpoint *endpoint) {
+    AWS_PRECONDITION(endpoint);
+
+    aws_mem_release(endpoint->allocator, endpoint->cpu_group_http_connection_managers);
+    endpoint->cpu_group_http_connection_managers = NULL;
+
+    aws_s3_slow_down_throttle_destroy(endpoint->slow_down_throttle);
+    endpoint->slow_down_throttle = NULL;
+
+    aws_s3_vip_balancer_destroy(endpoint->vip_balancer);
+    endpoint->vip_balancer = NULL;
+
+    for (size_t vip_index = 0; vip_index < aws_array_list_length(&endpoint->synced_data.vips); ++vip_index) {
+        struct aws_s3_endpoint_vip *vip = NULL;
+        aws_array_list_get_at(&endpoint->synced_data.vips, &vip, vip_index);
+
+        aws_mem_release(endpoint->allocator, vip->http_connection_managers);
+        aws_mem_release(endpoint->allocator, vip);
+    }
+
+    aws_array_list_clean_up(&endpoint->synced_data.vips);
+
+    for (uint32_t bootstrap_index = 0; bootstrap_index < endpoint->num_client_bootstraps; ++bootstrap_index) {
+        aws_client_bootstrap_release(endpoint->client_bootstraps[bootstrap_index]);
+    }
+
+    aws_mem_release(endpoint->allocator, endpoint->client_bootstraps);
+    endpoint->client_bootstraps = NULL;
+    endpoint->num_client_bootstraps = 0;
+
+    if (endpoint->tls_connection_options != NULL) {
+        aws_tls_connection_options_clean_up(endpoint->tls_connection_options);
+        aws_mem_release(endpoint->allocator, endpoint->tls_connection_options);
+        endpoint->tls_connection_options = NULL;
+    }
+
+    aws_mutex_clean_up(&endpoint->synced_data.lock);
+}
+
 struct aws_s3_endpoint *aws_s3_endpoint_new(
     struct aws_allocator *allocator,
     const struct aws_s3_endpoint_options *options) {
@@ -69,49 +114,133 @@ struct aws_s3_endpoint *aws_s3_endpoint_new(
 
     endpoint->allocator = allocator;
     endpoint->host_name = options->host_name;
+    aws_atomic_init_int(&endpoint->num_http_connection_managers_allocated, 0);
 
-    struct aws_host_resolution_config host_resolver_config;
-    AWS_ZERO_STRUCT(host_resolver_config);
-    host_resolver_config.impl = aws_default_dns_resolve;
-    host_resolver_config.max_ttl = options->dns_host_address_ttl_seconds;
-    host_resolver_config.impl_data = NULL;
+    *((uint32_t *)&endpoint->max_connections) = options->max_connections;
+    *((int *)&endpoint->port) = options->port;
+    *((size_t *)&endpoint->dns_host_address_ttl_seconds) = options->dns_host_address_ttl_seconds;
 
-    if (aws_host_resolver_resolve_host(
-            options->client_bootstrap->host_resolver,
-            endpoint->host_name,
-            s_s3_endpoint_on_host_resolver_address_resolved,
-            &host_resolver_config,
-            NULL)) {
+    if (aws_mutex_init(&endpoint->synced_data.lock)) {
+        aws_string_destroy(options->host_name);
+        aws_mem_release(allocator, endpoint);
+        return NULL;
+    }
+
+    if (aws_array_list_init_dynamic(&endpoint->synced_data.vips, allocator, 8, sizeof(struct aws_s3_endpoint_vip *))) {
+        goto error_cleanup;
+    }
+
+    endpoint->slow_down_throttle = aws_s3_slow_down_throttle_new(allocator);
 
+    if (endpoint->slow_down_throttle == NULL) {
         AWS_LOGF_ERROR(
-            AWS_LS_S3_ENDPOINT,
-            "id=%p: Error trying to resolve host for endpoint %s",
-            (void *)endpoint,
-            (const char *)endpoint->host_name->bytes);
+            AWS_LS_S3_ENDPOINT, "id=%p: Could not create SlowDown throttle for endpoint", (void *)endpoint);
 
         goto error_cleanup;
     }
 
-    endpoint->http_connection_manager = s_s3_endpoint_create_http_connection_manager(
-        endpoint,
-        options->host_name,
-        options->client_bootstrap,
-        options->tls_connection_options,
-        options->max_connections,
-        options->port);
+    endpoint->vip_balancer = aws_s3_vip_balancer_new(allocator);
+
+    if (endpoint->vip_balancer == NULL) {
+        AWS_LOGF_ERROR(AWS_LS_S3_ENDPOINT, "id=%p: Could not create VIP balancer for endpoint", (void *)endpoint);
 
-    if (endpoint->http_connection_manager == NULL) {
         goto error_cleanup;
     }
 
+    endpoint->num_client_bootstraps = options->num_cpu_groups > 0 ? options->num_cpu_groups : 1;
+    endpoint->client_bootstraps =
+        aws_mem_calloc(allocator, endpoint->num_client_bootstraps, sizeof(struct aws_client_bootstrap *));
+
+    for (uint32_t bootstrap_index = 0; bootstrap_index < endpoint->num_client_bootstraps; ++bootstrap_index) {
+        struct aws_client_bootstrap *client_bootstrap = options->num_cpu_groups > 0
+                                                            ? options->cpu_groups[bootstrap_index].client_bootstrap
+                                                            : options->client_bootstrap;
+
+        endpoint->client_bootstraps[bootstrap_index] = aws_client_bootstrap_acquire(client_bootstrap);
+    }
+
+    if (options->tls_connection_options != NULL) {
+        endpoint->tls_connection_options =
+            aws_mem_calloc(allocator, 1, sizeof(struct aws_tls_connection_options));
+
+        if (aws_tls_connection_options_copy(endpoint->tls_connection_options, options->tls_connection_options)) {
+            aws_mem_release(allocator, endpoint->tls_connection_options);
+            endpoint->tls_connection_options = NULL;
+            goto error_cleanup;
+        }
+
+        /* Connections to VIPs are made by IP address, so the server name always has to be set to the host name. */
+        /* TODO fix this in the actual aws_tls_connection_options_set_server_name function. */
+        if (endpoint->tls_connection_options->server_name != NULL) {
+            aws_string_destroy(endpoint->tls_connection_options->server_name);
+            endpoint->tls_connection_options->server_name = NULL;
+        }
+
+        struct aws_byte_cursor host_name_cursor = aws_byte_cursor_from_string(endpoint->host_name);
+        aws_tls_connection_options_set_server_name(endpoint->tls_connection_options, allocator, &host_name_cursor);
+    }
+
+    struct aws_byte_cursor host_name_cursor = aws_byte_cursor_from_string(options->host_name);
+
+    if (options->num_cpu_groups > 0) {
+        AWS_ASSERT(options->cpu_groups);
+
+        endpoint->cpu_group_http_connection_managers = aws_mem_calloc(
+            allocator, options->num_cpu_groups, sizeof(struct aws_http_connection_manager *));
+
+        /* Each CPU group gets the full connection limit, since the client decides how many connections are actually
+         * active across all of them. */
+        for (uint32_t group_index = 0; group_index < options->num_cpu_groups; ++group_index) {
+            struct aws_http_connection_manager *http_connection_manager = s_s3_endpoint_create_http_connection_manager(
+                endpoint, host_name_cursor, endpoint->client_bootstraps[group_index]);
+
+            if (http_connection_manager == NULL) {
+                goto error_cleanup;
+            }
+
+            endpoint->cpu_group_http_connection_managers[group_index] = http_connection_manager;
+            ++endpoint->num_cpu_group_http_connection_managers;
+            aws_atomic_fetch_add(&endpoint->num_http_connection_managers_allocated, 1);
+        }
+
+        endpoint->http_connection_manager = endpoint->cpu_group_http_connection_managers[0];
+
+    } else {
+        endpoint->http_connection_manager =
+            s_s3_endpoint_create_http_connection_manager(endpoint, host_name_cursor, endpoint->client_bootstraps[0]);
+
+        if (endpoint->http_connection_manager == NULL) {
+            goto error_cleanup;
+        }
+
+        aws_atomic_fetch_add(&endpoint->num_http_connection_managers_allocated, 1);
+    }
+
     endpoint->ref_count_zero_callback = options->ref_count_zero_callback;
     endpoint->shutdown_callback = options->shutdown_callback;
     endpoint->user_data = options->user_data;
 
+    /* Start resolving right away, so that VIPs are (hopefully) known by the time the first connection is needed. Until
+     * then, connections go through the connection managers for the host name. */
+    s_s3_endpoint_resolve_host(endpoint);
+
     return endpoint;
 
 error_cleanup:
 
+    if (endpoint->num_cpu_group_http_connection_managers > 0) {
+        /* Connection managers that were already created shut down asynchronously, and free the endpoint once the last
+         * of them is done. No shutdown callback has been set yet, so nobody else is notified. */
+        for (uint32_t group_index = 0; group_index < endpoint->num_cpu_group_http_connection_managers; ++group_index) {
+            aws_http_connection_manager_release(endpoint->cpu_group_http_connection_managers[group_index]);
+        }
+
+        aws_string_destroy(options->host_name);
+        return NULL;
+    }
+
+    s_s3_endpoint_clean_up(endpoint);
+
     aws_string_destroy(options->host_name);
 
     aws_mem_release(allocator, endpoint);
@@ -121,16 +250,10 @@ error_cleanup:
 
 static struct aws_http_connection_manager *s_s3_endpoint_create_http_connection_manager(
     struct aws_s3_endpoint *endpoint,
-    const struct aws_string *host_name,
-    struct aws_client_bootstrap *client_bootstrap,
-    const struct aws_tls_connection_options *tls_connection_options,
-    uint32_t max_connections,
-    int port) {
+    struct aws_byte_cursor host,
+    struct aws_client_bootstrap *client_bootstrap) {
     AWS_PRECONDITION(endpoint);
     AWS_PRECONDITION(client_bootstrap);
-    AWS_PRECONDITION(host_name);
-
-    struct aws_byte_cursor host_name_cursor = aws_byte_cursor_from_string(host_name);
 
     /* Try to set up an HTTP connection manager. */
     struct aws_socket_options socket_options;
@@ -148,41 +271,22 @@ static struct aws_http_connection_manager *s_s3_endpoint_create_http_connection_
     manager_options.bootstrap = client_bootstrap;
     manager_options.initial_window_size = SIZE_MAX;
     manager_options.socket_options = &socket_options;
-    manager_options.host = host_name_cursor;
-    manager_options.max_connections = max_connections;
+    manager_options.host = host;
+    manager_options.max_connections = endpoint->max_connections;
     manager_options.shutdown_complete_callback = s_s3_endpoint_http_connection_manager_shutdown_callback;
     manager_options.shutdown_complete_user_data = endpoint;
     manager_options.proxy_ev_settings = &proxy_ev_settings;
 
-    struct aws_tls_connection_options *manager_tls_options = NULL;
-
-    if (tls_connection_options != NULL) {
-        manager_tls_options = aws_mem_calloc(endpoint->allocator, 1, sizeof(struct aws_tls_connection_options));
-        aws_tls_connection_options_copy(manager_tls_options, tls_connection_options);
-
-        /* TODO fix this in the actual aws_tls_connection_options_set_server_name function. */
-        if (manager_tls_options->server_name != NULL) {
-            aws_string_destroy(manager_tls_options->server_name);
-            manager_tls_options->server_name = NULL;
-        }
-
-        aws_tls_connection_options_set_server_name(manager_tls_options, endpoint->allocator, &host_name_cursor);
-
-        manager_options.tls_connection_options = manager_tls_options;
-        manager_options.port = port == -1 ? s_https_port : port;
+    if (endpoint->tls_connection_options != NULL) {
+        manager_options.tls_connection_options = endpoint->tls_connection_options;
+        manager_options.port = endpoint->port == -1 ? s_https_port : (uint16_t)endpoint->port;
     } else {
-        manager_options.port = port == -1 ? s_http_port : port;
+        manager_options.port = endpoint->port == -1 ? s_http_port : (uint16_t)endpoint->port;
     }
 
     struct aws_http_connection_manager *http_connection_manager =
         aws_http_connection_manager_new(endpoint->allocator, &manager_options);
 
-    if (manager_tls_options != NULL) {
-        aws_tls_connection_options_clean_up(manager_tls_options);
-        aws_mem_release(endpoint->allocator, manager_tls_options);
-        manager_tls_options = NULL;
-    }
-
     if (http_connection_manager == NULL) {
         AWS_LOGF_ERROR(AWS_LS_S3_ENDPOINT, "id=%p: Could not create http connection manager.", (void *)endpoint);
         return NULL;
@@ -190,13 +294,231 @@ static struct aws_http_connection_manager *s_s3_endpoint_create_http_connection_
 
     AWS_LOGF_DEBUG(
         AWS_LS_S3_ENDPOINT,
-        "id=%p: Created connection manager %p for endpoint",
+        "id=%p: Created connection manager %p for endpoint, connecting to " PRInSTR,
         (void *)endpoint,
-        (void *)endpoint->http_connection_manager);
+        (void *)http_connection_manager,
+        AWS_BYTE_CURSOR_PRI(host));
 
     return http_connection_manager;
 }
 
+struct aws_http_connection_manager *aws_s3_endpoint_get_http_connection_manager(
+    struct aws_s3_endpoint *endpoint,
+    const struct aws_s3_client_cpu_group *cpu_group) {
+    AWS_PRECONDITION(endpoint);
+
+    if (cpu_group != NULL && cpu_group->index < endpoint->num_cpu_group_http_connection_managers) {
+        return endpoint->cpu_group_http_connection_managers[cpu_group->index];
+    }
+
+    return endpoint->http_connection_manager;
+}
+
+/* Ask the host resolver for the endpoint's addresses, unless that is already in progress. The resolve is counted like a
+ * connection manager that hasn't shut down yet, so that the endpoint isn't freed before the resolver calls back. (A
+ * reference to the endpoint isn't held for this, as that would keep the endpoint from being cleaned up when its last
+ * user releases it.) */
+static void s_s3_endpoint_resolve_host(struct aws_s3_endpoint *endpoint) {
+    AWS_PRECONDITION(endpoint);
+
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    aws_mutex_lock(&endpoint->synced_data.lock);
+
+    bool resolve = !endpoint->synced_data.resolve_in_progress && !endpoint->synced_data.shutting_down;
+
+    if (resolve) {
+        endpoint->synced_data.resolve_in_progress = true;
+        endpoint->synced_data.last_resolve_timestamp_ns = now_ns;
+        aws_atomic_fetch_add(&endpoint->num_http_connection_managers_allocated, 1);
+    }
+
+    aws_mutex_unlock(&endpoint->synced_data.lock);
+
+    if (!resolve) {
+        return;
+    }
+
+    struct aws_host_resolution_config host_resolver_config;
+    AWS_ZERO_STRUCT(host_resolver_config);
+    host_resolver_config.impl = aws_default_dns_resolve;
+    host_resolver_config.max_ttl = endpoint->dns_host_address_ttl_seconds;
+    host_resolver_config.impl_data = NULL;
+
+    if (aws_host_resolver_resolve_host(
+            endpoint->client_bootstraps[0]->host_resolver,
+            endpoint->host_name,
+            s_s3_endpoint_on_host_resolver_address_resolved,
+            &host_resolver_config,
+            endpoint)) {
+
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_ENDPOINT,
+            "id=%p: Error trying to resolve host for endpoint %s",
+            (void *)endpoint,
+            (const char *)endpoint->host_name->bytes);
+
+        aws_mutex_lock(&endpoint->synced_data.lock);
+        endpoint->synced_data.resolve_in_progress = false;
+        aws_mutex_unlock(&endpoint->synced_data.lock);
+
+        /* Whoever called this is still using the endpoint, so this never frees it. */
+        s_s3_endpoint_http_connection_manager_shutdown_callback(endpoint);
+    }
+}
+
+/* Set up connection managers for a newly resolved address, and hand it to the VIP balancer. */
+static void s_s3_endpoint_add_vip(struct aws_s3_endpoint *endpoint, const struct aws_string *address) {
+    AWS_PRECONDITION(endpoint);
+    AWS_PRECONDITION(address);
+
+    struct aws_byte_cursor address_cursor = aws_byte_cursor_from_string(address);
+
+    /* Resolves never overlap, so nothing else can be adding this same address right now. */
+    if (aws_s3_vip_balancer_has_vip(endpoint->vip_balancer, address_cursor)) {
+        return;
+    }
+
+    /* The lock is held until the VIP is in the list, so that shutting down either happens before any connection
+     * manager is created for it, or takes care of releasing them. */
+    aws_mutex_lock(&endpoint->synced_data.lock);
+
+    if (endpoint->synced_data.shutting_down) {
+        aws_mutex_unlock(&endpoint->synced_data.lock);
+        return;
+    }
+
+    struct aws_s3_endpoint_vip *vip = aws_mem_calloc(endpoint->allocator, 1, sizeof(struct aws_s3_endpoint_vip));
+    vip->http_connection_managers = aws_mem_calloc(
+        endpoint->allocator, endpoint->num_client_bootstraps, sizeof(struct aws_http_connection_manager *));
+
+    for (uint32_t bootstrap_index = 0; bootstrap_index < endpoint->num_client_bootstraps; ++bootstrap_index) {
+        struct aws_http_connection_manager *http_connection_manager = s_s3_endpoint_create_http_connection_manager(
+            endpoint, address_cursor, endpoint->client_bootstraps[bootstrap_index]);
+
+        if (http_connection_manager == NULL) {
+            goto error_clean_up;
+        }
+
+        vip->http_connection_managers[vip->num_http_connection_managers++] = http_connection_manager;
+        aws_atomic_fetch_add(&endpoint->num_http_connection_managers_allocated, 1);
+    }
+
+    if (aws_array_list_push_back(&endpoint->synced_data.vips, &vip)) {
+        goto error_clean_up;
+    }
+
+    aws_mutex_unlock(&endpoint->synced_data.lock);
+
+    if (aws_s3_vip_balancer_add_vip(endpoint->vip_balancer, address_cursor, vip)) {
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_ENDPOINT,
+        "id=%p: Added VIP %s for endpoint %s",
+        (void *)endpoint,
+        (const char *)address->bytes,
+        (const char *)endpoint->host_name->bytes);
+
+    return;
+
+error_clean_up:
+
+    aws_mutex_unlock(&endpoint->synced_data.lock);
+
+    AWS_LOGF_WARN(
+        AWS_LS_S3_ENDPOINT,
+        "id=%p: Could not set up VIP %s, error %d (%s)",
+        (void *)endpoint,
+        (const char *)address->bytes,
+        aws_last_error_or_unknown(),
+        aws_error_str(aws_last_error_or_unknown()));
+
+    /* These shut down asynchronously, which is fine, as each of them is counted until it has. */
+    for (uint32_t manager_index = 0; manager_index < vip->num_http_connection_managers; ++manager_index) {
+        aws_http_connection_manager_release(vip->http_connection_managers[manager_index]);
+    }
+
+    aws_mem_release(endpoint->allocator, vip->http_connection_managers);
+    aws_mem_release(endpoint->allocator, vip);
+}
+
+/* group_index picks among the per CPU group connection managers of whatever VIP is picked, or of the host name if no
+ * VIP is usable. */
+static struct aws_http_connection_manager *s_s3_endpoint_acquire_vip_connection_manager(
+    struct aws_s3_endpoint *endpoint,
+    uint32_t group_index,
+    struct aws_s3_balanced_vip **out_vip) {
+    AWS_PRECONDITION(endpoint);
+    AWS_PRECONDITION(out_vip);
+
+    *out_vip = NULL;
+
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    const uint64_t refresh_interval_ns =
+        aws_timestamp_convert(s_vip_refresh_interval_secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+    aws_mutex_lock(&endpoint->synced_data.lock);
+    bool refresh_vips = !endpoint->synced_data.resolve_in_progress &&
+                        now_ns - endpoint->synced_data.last_resolve_timestamp_ns >= refresh_interval_ns;
+    aws_mutex_unlock(&endpoint->synced_data.lock);
+
+    if (refresh_vips) {
+        s_s3_endpoint_resolve_host(endpoint);
+    }
+
+    struct aws_s3_balanced_vip *balanced_vip = aws_s3_vip_balancer_acquire_vip(endpoint->vip_balancer, now_ns);
+
+    if (balanced_vip == NULL) {
+        if (group_index < endpoint->num_cpu_group_http_connection_managers) {
+            return endpoint->cpu_group_http_connection_managers[group_index];
+        }
+
+        return endpoint->http_connection_manager;
+    }
+
+    struct aws_s3_endpoint_vip *vip = balanced_vip->user_data;
+    AWS_ASSERT(vip->num_http_connection_managers > 0);
+
+    *out_vip = balanced_vip;
+
+    if (group_index < vip->num_http_connection_managers) {
+        return vip->http_connection_managers[group_index];
+    }
+
+    return vip->http_connection_managers[0];
+}
+
+struct aws_http_connection_manager *aws_s3_endpoint_acquire_vip_connection_manager(
+    struct aws_s3_endpoint *endpoint,
+    const struct aws_s3_client_cpu_group *cpu_group,
+    struct aws_s3_balanced_vip **out_vip) {
+
+    return s_s3_endpoint_acquire_vip_connection_manager(endpoint, cpu_group != NULL ? cpu_group->index : 0, out_vip);
+}
+
+void aws_s3_endpoint_release_vip(
+    struct aws_s3_endpoint *endpoint,
+    struct aws_s3_balanced_vip *vip,
+    bool failed,
+    uint64_t num_bytes,
+    uint64_t duration_ns) {
+    AWS_PRECONDITION(endpoint);
+
+    if (vip == NULL) {
+        return;
+    }
+
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+
+    aws_s3_vip_balancer_release_vip(endpoint->vip_balancer, vip, failed, num_bytes, duration_ns, now_ns);
+}
+
 struct aws_s3_endpoint *aws_s3_endpoint_acquire(struct aws_s3_endpoint *endpoint) {
     AWS_PRECONDITION(endpoint);
 
@@ -221,19 +543,51 @@ static void s_s3_endpoint_ref_count_zero(void *user_data) {
         return;
     }
 
-    if (endpoint->http_connection_manager != NULL) {
+    /* The last connection manager to shut down frees the endpoint. Hold an extra count while releasing them, so that
+     * the endpoint can't go away before every one of them has been released. */
+    aws_atomic_fetch_add(&endpoint->num_http_connection_managers_allocated, 1);
+
+    /* Once shutting_down is set, a resolve still in progress won't add any more VIPs, so the list can be read without
+     * the lock afterwards. */
+    aws_mutex_lock(&endpoint->synced_data.lock);
+    endpoint->synced_data.shutting_down = true;
+    aws_mutex_unlock(&endpoint->synced_data.lock);
+
+    for (size_t vip_index = 0; vip_index < aws_array_list_length(&endpoint->synced_data.vips); ++vip_index) {
+        struct aws_s3_endpoint_vip *vip = NULL;
+        aws_array_list_get_at(&endpoint->synced_data.vips, &vip, vip_index);
+
+        for (uint32_t manager_index = 0; manager_index < vip->num_http_connection_managers; ++manager_index) {
+            aws_http_connection_manager_release(vip->http_connection_managers[manager_index]);
+            vip->http_connection_managers[manager_index] = NULL;
+        }
+    }
+
+    if (endpoint->num_cpu_group_http_connection_managers > 0) {
+        endpoint->http_connection_manager = NULL;
+
+        for (uint32_t group_index = 0; group_index < endpoint->num_cpu_group_http_connection_managers; ++group_index) {
+            aws_http_connection_manager_release(endpoint->cpu_group_http_connection_managers[group_index]);
+        }
+    } else if (endpoint->http_connection_manager != NULL) {
         struct aws_http_connection_manager *http_connection_manager = endpoint->http_connection_manager;
         endpoint->http_connection_manager = NULL;
         aws_http_connection_manager_release(http_connection_manager);
-    } else {
-        s_s3_endpoint_http_connection_manager_shutdown_callback(endpoint->user_data);
     }
+
+    s_s3_endpoint_http_connection_manager_shutdown_callback(endpoint);
 }
 
 static void s_s3_endpoint_http_connection_manager_shutdown_callback(void *user_data) {
     struct aws_s3_endpoint *endpoint = user_data;
     AWS_ASSERT(endpoint);
 
+    if (aws_atomic_fetch_sub(&endpoint->num_http_connection_managers_allocated, 1) > 1) {
+        return;
+    }
+
+    s_s3_endpoint_clean_up(endpoint);
+
     aws_s3_endpoint_shutdown_fn *shutdown_callback = endpoint->shutdown_callback;
     void *endpoint_user_data = endpoint->user_data;
 
@@ -252,7 +606,203 @@ static void s_s3_endpoint_on_host_resolver_address_resolved(
     void *user_data) {
     (void)resolver;
     (void)host_name;
-    (void)err_code;
-    (void)host_addresses;
-    (void)user_data;
+
+    struct aws_s3_endpoint *endpoint = user_data;
+    AWS_PRECONDITION(endpoint);
+
+    if (err_code != AWS_ERROR_SUCCESS) {
+        AWS_LOGF_WARN(
+            AWS_LS_S3_ENDPOINT,
+            "id=%p: Could not resolve host for endpoint, error %d (%s)",
+            (void *)endpoint,
+            err_code,
+            aws_error_str(err_code));
+    } else if (host_addresses != NULL) {
+        for (size_t address_index = 0; address_index < aws_array_list_length(host_addresses); ++address_index) {
+            struct aws_host_address *host_address = NULL;
+            aws_array_list_get_at_ptr(host_addresses, (void **)&host_address, address_index);
+
+            /* Connections are only made over IPv4. */
+            if (host_address->record_type == AWS_ADDRESS_RECORD_TYPE_A) {
+                s_s3_endpoint_add_vip(endpoint, host_address->address);
+            }
+        }
+    }
+
+    aws_mutex_lock(&endpoint->synced_data.lock);
+    endpoint->synced_data.resolve_in_progress = false;
+    aws_mutex_unlock(&endpoint->synced_data.lock);
+
+    /* Done with the endpoint, which may free it if it was shut down in the meantime. */
+    s_s3_endpoint_http_connection_manager_shutdown_callback(endpoint);
+}
+
+/* State of one aws_s3_endpoint_prewarm call. */
+struct aws_s3_endpoint_prewarm {
+    struct aws_allocator *allocator;
+
+    /* Kept alive until every connection has been released back to its connection manager. */
+    struct aws_s3_endpoint *endpoint;
+
+    aws_s3_client_prewarm_endpoint_callback_fn *callback;
+    void *user_data;
+
+    struct aws_s3_endpoint_prewarm_connection *connections;
+    uint32_t num_connections;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Number of connection acquisitions that have not completed yet. */
+        uint32_t num_pending;
+
+        /* Number of connections that were successfully opened. */
+        uint32_t num_opened;
+
+        /* Error of the first connection that could not be opened. */
+        int error_code;
+    } synced_data;
+};
+
+/* One connection being opened by a prewarm. */
+struct aws_s3_endpoint_prewarm_connection {
+    struct aws_s3_endpoint_prewarm *prewarm;
+    struct aws_http_connection_manager *http_connection_manager;
+    struct aws_s3_balanced_vip *vip;
+    struct aws_http_connection *http_connection;
+};
+
+static void s_s3_endpoint_prewarm_destroy(struct aws_s3_endpoint_prewarm *prewarm) {
+    AWS_PRECONDITION(prewarm);
+
+    aws_mutex_clean_up(&prewarm->synced_data.lock);
+    aws_mem_release(prewarm->allocator, prewarm->connections);
+    aws_mem_release(prewarm->allocator, prewarm);
+}
+
+static void s_s3_endpoint_prewarm_on_connection_acquired(
+    struct aws_http_connection *http_connection,
+    int error_code,
+    void *user_data) {
+
+    struct aws_s3_endpoint_prewarm_connection *prewarm_connection = user_data;
+    AWS_PRECONDITION(prewarm_connection);
+
+    struct aws_s3_endpoint_prewarm *prewarm = prewarm_connection->prewarm;
+    AWS_PRECONDITION(prewarm);
+
+    if (error_code != AWS_ERROR_SUCCESS) {
+        AWS_LOGF_WARN(
+            AWS_LS_S3_ENDPOINT,
+            "id=%p: Could not open connection while prewarming endpoint, error %d (%s)",
+            (void *)prewarm->endpoint,
+            error_code,
+            aws_error_str(error_code));
+    }
+
+    prewarm_connection->http_connection = http_connection;
+
+    aws_mutex_lock(&prewarm->synced_data.lock);
+
+    if (error_code != AWS_ERROR_SUCCESS) {
+        if (prewarm->synced_data.error_code == AWS_ERROR_SUCCESS) {
+            prewarm->synced_data.error_code = error_code;
+        }
+    } else {
+        ++prewarm->synced_data.num_opened;
+    }
+
+    AWS_ASSERT(prewarm->synced_data.num_pending > 0);
+    bool prewarm_finished = --prewarm->synced_data.num_pending == 0;
+
+    aws_mutex_unlock(&prewarm->synced_data.lock);
+
+    if (!prewarm_finished) {
+        return;
+    }
+
+    /* With every connection open at the same time, the connection manager now has as many idle connections to hand
+     * out as were asked for. */
+    for (uint32_t i = 0; i < prewarm->num_connections; ++i) {
+        struct aws_s3_endpoint_prewarm_connection *connection = &prewarm->connections[i];
+
+        aws_s3_endpoint_release_vip(prewarm->endpoint, connection->vip, connection->http_connection == NULL, 0, 0);
+        connection->vip = NULL;
+
+        if (connection->http_connection != NULL) {
+            aws_http_connection_manager_release_connection(
+                connection->http_connection_manager, connection->http_connection);
+            connection->http_connection = NULL;
+        }
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_ENDPOINT,
+        "id=%p: Prewarmed endpoint with %d out of %d connections.",
+        (void *)prewarm->endpoint,
+        (int)prewarm->synced_data.num_opened,
+        (int)prewarm->num_connections);
+
+    if (prewarm->callback != NULL) {
+        prewarm->callback(prewarm->synced_data.error_code, prewarm->synced_data.num_opened, prewarm->user_data);
+    }
+
+    aws_s3_endpoint_release(prewarm->endpoint);
+    s_s3_endpoint_prewarm_destroy(prewarm);
+}
+
+int aws_s3_endpoint_prewarm(
+    struct aws_s3_endpoint *endpoint,
+    uint32_t num_connections,
+    aws_s3_client_prewarm_endpoint_callback_fn *callback,
+    void *user_data) {
+    AWS_PRECONDITION(endpoint);
+
+    if (num_connections == 0) {
+        if (callback != NULL) {
+            callback(AWS_ERROR_SUCCESS, 0, user_data);
+        }
+
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_s3_endpoint_prewarm *prewarm =
+        aws_mem_calloc(endpoint->allocator, 1, sizeof(struct aws_s3_endpoint_prewarm));
+
+    prewarm->allocator = endpoint->allocator;
+    prewarm->callback = callback;
+    prewarm->user_data = user_data;
+    prewarm->num_connections = num_connections;
+    prewarm->connections =
+        aws_mem_calloc(endpoint->allocator, num_connections, sizeof(struct aws_s3_endpoint_prewarm_connection));
+
+    if (aws_mutex_init(&prewarm->synced_data.lock)) {
+        aws_mem_release(prewarm->allocator, prewarm->connections);
+        aws_mem_release(prewarm->allocator, prewarm);
+        return AWS_OP_ERR;
+    }
+
+    prewarm->endpoint = aws_s3_endpoint_acquire(endpoint);
+    prewarm->synced_data.num_pending = num_connections;
+
+    /* Assign every connection its connection manager before acquiring any, as acquisitions can complete right away.
+     * The VIPs are only given back once all connections are done, so that they get spread over VIPs like connections
+     * of meta requests are. */
+    for (uint32_t i = 0; i < num_connections; ++i) {
+        prewarm->connections[i].prewarm = prewarm;
+        prewarm->connections[i].http_connection_manager = s_s3_endpoint_acquire_vip_connection_manager(
+            endpoint, i % endpoint->num_client_bootstraps, &prewarm->connections[i].vip);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_ENDPOINT, "id=%p: Prewarming endpoint with %d connections.", (void *)endpoint, (int)num_connections);
+
+    for (uint32_t i = 0; i < num_connections; ++i) {
+        aws_http_connection_manager_acquire_connection(
+            prewarm->connections[i].http_connection_manager,
+            s_s3_endpoint_prewarm_on_connection_acquired,
+            &prewarm->connections[i]);
+    }
+
+    return AWS_OP_SUCCESS;
 }
@@ -0,0 +1,138 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_gather_stream.h"
+
+#include <aws/io/stream.h>
+
+struct aws_s3_gather_stream_impl {
+    struct aws_byte_cursor *segments;
+    size_t num_segments;
+
+    /* Segment the stream is in, and how far into it. */
+    size_t segment_index;
+    size_t segment_offset;
+
+    uint64_t position;
+    uint64_t length;
+};
+
+static int s_s3_gather_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct aws_s3_gather_stream_impl *impl = stream->impl;
+
+    while (dest->len < dest->capacity && impl->segment_index < impl->num_segments) {
+        struct aws_byte_cursor segment = impl->segments[impl->segment_index];
+        aws_byte_cursor_advance(&segment, impl->segment_offset);
+
+        size_t copy_len = aws_min_size(segment.len, dest->capacity - dest->len);
+        struct aws_byte_cursor copy = aws_byte_cursor_advance(&segment, copy_len);
+        aws_byte_buf_write_from_whole_cursor(dest, copy);
+
+        impl->position += copy_len;
+        impl->segment_offset += copy_len;
+
+        if (segment.len == 0) {
+            ++impl->segment_index;
+            impl->segment_offset = 0;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_gather_stream_seek(struct aws_input_stream *stream, int64_t offset, enum aws_stream_seek_basis basis) {
+    struct aws_s3_gather_stream_impl *impl = stream->impl;
+
+    int64_t base = basis == AWS_SSB_BEGIN ? 0 : (int64_t)impl->length;
+
+    if ((offset < 0 && -offset > base) || (offset > 0 && (uint64_t)offset > impl->length - (uint64_t)base)) {
+        return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+    }
+
+    uint64_t position = (uint64_t)(base + offset);
+
+    impl->position = position;
+    impl->segment_index = 0;
+    impl->segment_offset = 0;
+
+    while (impl->segment_index < impl->num_segments && position >= impl->segments[impl->segment_index].len) {
+        position -= impl->segments[impl->segment_index].len;
+        ++impl->segment_index;
+    }
+
+    impl->segment_offset = (size_t)position;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_gather_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct aws_s3_gather_stream_impl *impl = stream->impl;
+
+    status->is_end_of_stream = impl->position == impl->length;
+    status->is_valid = true;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_gather_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct aws_s3_gather_stream_impl *impl = stream->impl;
+
+    *out_length = (int64_t)impl->length;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_s3_gather_stream_destroy(struct aws_input_stream *stream) {
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_input_stream_vtable s_s3_gather_stream_vtable = {
+    .seek = s_s3_gather_stream_seek,
+    .read = s_s3_gather_stream_read,
+    .get_status = s_s3_gather_stream_get_status,
+    .get_length = s_s3_gather_stream_get_length,
+    .destroy = s_s3_gather_stream_destroy,
+};
+
+struct aws_input_stream *aws_s3_gather_stream_new(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(segments || num_segments == 0);
+
+    struct aws_input_stream *stream = NULL;
+    struct aws_s3_gather_stream_impl *impl = NULL;
+    struct aws_byte_cursor *segments_copy = NULL;
+
+    /* Ask for at least one segment, as aws_mem_acquire_many doesn't take empty allocations. */
+    aws_mem_acquire_many(
+        allocator,
+        3,
+        &stream,
+        sizeof(struct aws_input_stream),
+        &impl,
+        sizeof(struct aws_s3_gather_stream_impl),
+        &segments_copy,
+        sizeof(struct aws_byte_cursor) * aws_max_size(num_segments, 1));
+    AWS_ZERO_STRUCT(*stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    stream->allocator = allocator;
+    stream->vtable = &s_s3_gather_stream_vtable;
+    stream->impl = impl;
+
+    impl->segments = segments_copy;
+    impl->num_segments = num_segments;
+
+    for (size_t segment_index = 0; segment_index < num_segments; ++segment_index) {
+        impl->segments[segment_index] = segments[segment_index];
+        impl->length += segments[segment_index].len;
+    }
+
+    /* Skip any empty segments at the start. */
+    s_s3_gather_stream_seek(stream, 0, AWS_SSB_BEGIN);
+
+    return stream;
+}
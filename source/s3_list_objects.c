@@ -34,9 +34,11 @@ struct aws_s3_paginator {
     struct aws_string *bucket_name;
     struct aws_string *prefix;
     struct aws_string *delimiter;
+    struct aws_string *start_after;
     struct aws_string *endpoint;
     aws_s3_on_object_fn *on_object;
     aws_s3_on_object_list_finished *on_list_finished;
+    aws_s3_on_continuation_token_fn *on_continuation_token;
     void *user_data;
 
     struct aws_ref_count ref_count;
@@ -47,6 +49,8 @@ struct aws_s3_paginator {
         bool has_more_results;
     } shared_mt_state;
 
+    /* Start of the element of the current page that hasn't arrived in full yet. Everything before it was parsed
+     * already. */
     struct aws_byte_buf result_body;
 };
 
@@ -74,10 +78,18 @@ static void s_ref_count_zero_callback(void *arg) {
         aws_string_destroy(paginator->prefix);
     }
 
+    if (paginator->start_after) {
+        aws_string_destroy(paginator->start_after);
+    }
+
     if (paginator->endpoint) {
         aws_string_destroy(paginator->endpoint);
     }
 
+    if (paginator->shared_mt_state.continuation_token) {
+        aws_string_destroy(paginator->shared_mt_state.continuation_token);
+    }
+
     aws_byte_buf_clean_up(&paginator->result_body);
 
     aws_mem_release(paginator->allocator, paginator);
@@ -99,8 +111,11 @@ struct aws_s3_paginator *aws_s3_initiate_list_objects(
     paginator->endpoint = aws_string_new_from_cursor(allocator, &params->endpoint);
     paginator->delimiter = params->delimiter.len > 0 ? aws_string_new_from_cursor(allocator, &params->delimiter) : NULL;
     paginator->prefix = params->prefix.len > 0 ? aws_string_new_from_cursor(allocator, &params->prefix) : NULL;
+    paginator->start_after =
+        params->start_after.len > 0 ? aws_string_new_from_cursor(allocator, &params->start_after) : NULL;
     paginator->on_object = params->on_object;
     paginator->on_list_finished = params->on_list_finished;
+    paginator->on_continuation_token = params->on_continuation_token;
     paginator->user_data = params->user_data;
     aws_byte_buf_init(&paginator->result_body, allocator, s_dynamic_body_initial_buf_size);
     aws_ref_count_init(&paginator->ref_count, paginator, s_ref_count_zero_callback);
@@ -108,6 +123,11 @@ struct aws_s3_paginator *aws_s3_initiate_list_objects(
     aws_atomic_init_ptr(&paginator->current_request, NULL);
     paginator->shared_mt_state.operation_state = OS_NOT_STARTED;
 
+    if (params->continuation_token.len > 0) {
+        paginator->shared_mt_state.continuation_token =
+            aws_string_new_from_cursor(allocator, &params->continuation_token);
+    }
+
     return paginator;
 }
 
@@ -265,6 +285,10 @@ static bool s_on_list_bucket_result_node_encountered(
             paginator->shared_mt_state.continuation_token =
                 aws_string_new_from_cursor(paginator->allocator, &continuation_token_cur);
             aws_mutex_unlock(&paginator->shared_mt_state.lock);
+
+            if (paginator->on_continuation_token) {
+                paginator->on_continuation_token(paginator, continuation_token_cur, paginator->user_data);
+            }
         }
 
         return ret_val;
@@ -288,21 +312,152 @@ static bool s_on_list_bucket_result_node_encountered(
     return true;
 }
 
-static bool s_on_root_node_encountered(struct aws_xml_parser *parser, struct aws_xml_node *node, void *user_data) {
-    struct aws_s3_paginator *paginator = user_data;
+/* Find the end of the element whose start tag named name ends at the start of data: the end of its matching end tag.
+ * Children of the elements of a ListBucketResult never share their parent's name, so the first end tag with that name
+ * is the one. Returns false if the end tag hasn't arrived yet. */
+static bool s_find_element_end(struct aws_byte_cursor data, struct aws_byte_cursor name, size_t *out_end) {
+    const struct aws_byte_cursor end_tag_start = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("</");
 
-    struct aws_byte_cursor node_name;
-    aws_xml_node_get_name(node, &node_name);
-    if (aws_byte_cursor_eq_c_str_ignore_case(&node_name, "ListBucketResult")) {
-        return aws_xml_node_traverse(parser, node, s_on_list_bucket_result_node_encountered, paginator);
+    struct aws_byte_cursor remaining = data;
+    struct aws_byte_cursor found;
+
+    while (aws_byte_cursor_find_exact(&remaining, &end_tag_start, &found) == AWS_OP_SUCCESS) {
+        struct aws_byte_cursor end_tag = found;
+        aws_byte_cursor_advance(&end_tag, end_tag_start.len);
+
+        if (end_tag.len < name.len + 1) {
+            return false;
+        }
+
+        if (memcmp(end_tag.ptr, name.ptr, name.len) == 0 && end_tag.ptr[name.len] == '>') {
+            *out_end = (size_t)(end_tag.ptr - data.ptr) + name.len + 1;
+            return true;
+        }
+
+        remaining = found;
+        aws_byte_cursor_advance(&remaining, end_tag_start.len);
     }
 
     return false;
 }
 
+/* Parse every child element of the ListBucketResult that is complete in data, each one as a document of its own.
+ * On return, out_bytes_used is how much of data was dealt with; what is left is the start of an element (or tag) that
+ * hasn't arrived in full yet. */
+static int s_parse_list_bucket_result_elements(
+    struct aws_s3_paginator *paginator,
+    struct aws_byte_cursor data,
+    size_t *out_bytes_used) {
+
+    struct aws_byte_cursor remaining = data;
+    int result = AWS_OP_SUCCESS;
+
+    while (remaining.len > 0) {
+        uint8_t *tag_start = memchr(remaining.ptr, '<', remaining.len);
+
+        /* Nothing but whitespace between elements. */
+        if (tag_start == NULL) {
+            aws_byte_cursor_advance(&remaining, remaining.len);
+            break;
+        }
+
+        aws_byte_cursor_advance(&remaining, (size_t)(tag_start - remaining.ptr));
+
+        uint8_t *tag_end = memchr(remaining.ptr, '>', remaining.len);
+
+        if (tag_end == NULL) {
+            break;
+        }
+
+        size_t tag_len = (size_t)(tag_end - remaining.ptr) + 1;
+
+        /* The XML declaration, and the start and end tags of the ListBucketResult itself, are skipped. */
+        struct aws_byte_cursor tag_name = {.ptr = remaining.ptr + 1, .len = tag_len - 2};
+        bool is_empty_element = tag_name.len > 0 && tag_name.ptr[tag_name.len - 1] == '/';
+
+        for (size_t i = 0; i < tag_name.len; ++i) {
+            uint8_t c = tag_name.ptr[i];
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '/') {
+                tag_name.len = i;
+                break;
+            }
+        }
+
+        if (tag_name.len == 0 || tag_name.ptr[0] == '?' || tag_name.ptr[0] == '!' ||
+            (aws_byte_cursor_eq_c_str_ignore_case(&tag_name, "ListBucketResult") && !is_empty_element)) {
+            aws_byte_cursor_advance(&remaining, tag_len);
+            continue;
+        }
+
+        size_t element_len = tag_len;
+
+        if (!is_empty_element) {
+            struct aws_byte_cursor content = remaining;
+            aws_byte_cursor_advance(&content, tag_len);
+
+            size_t content_len = 0;
+            if (!s_find_element_end(content, tag_name, &content_len)) {
+                break;
+            }
+
+            element_len += content_len;
+        }
+
+        struct aws_xml_parser_options parser_options = {
+            .doc = aws_byte_cursor_advance(&remaining, element_len),
+            .max_depth = 16U,
+        };
+
+        struct aws_xml_parser *parser = aws_xml_parser_new(paginator->allocator, &parser_options);
+        result = aws_xml_parser_parse(parser, s_on_list_bucket_result_node_encountered, paginator);
+        aws_xml_parser_destroy(parser);
+
+        if (result != AWS_OP_SUCCESS) {
+            break;
+        }
+    }
+
+    *out_bytes_used = data.len - remaining.len;
+    return result;
+}
+
+int aws_s3_paginator_parse_page_body(struct aws_s3_paginator *paginator, struct aws_byte_cursor body) {
+    AWS_PRECONDITION(paginator);
+
+    size_t bytes_used = 0;
+
+    /* Elements that arrived in one piece are parsed straight out of the body, and only the rest is copied. */
+    if (paginator->result_body.len == 0) {
+        int result = s_parse_list_bucket_result_elements(paginator, body, &bytes_used);
+        aws_byte_cursor_advance(&body, bytes_used);
+
+        if (result == AWS_OP_SUCCESS && body.len > 0) {
+            result = aws_byte_buf_append_dynamic(&paginator->result_body, &body);
+        }
+
+        return result;
+    }
+
+    if (aws_byte_buf_append_dynamic(&paginator->result_body, &body)) {
+        return AWS_OP_ERR;
+    }
+
+    int result =
+        s_parse_list_bucket_result_elements(paginator, aws_byte_cursor_from_buf(&paginator->result_body), &bytes_used);
+
+    if (bytes_used > 0) {
+        memmove(
+            paginator->result_body.buffer,
+            paginator->result_body.buffer + bytes_used,
+            paginator->result_body.len - bytes_used);
+        paginator->result_body.len -= bytes_used;
+    }
+
+    return result;
+}
+
 /**
- * On a successful operation, this is an xml document. Just copy the buffers over until we're ready to parse (upon
- * completion) of the response body.
+ * On a successful operation, this is an xml document, which is parsed as it arrives.
  */
 static int s_list_bucket_receive_body_callback(
     struct aws_s3_meta_request *meta_request,
@@ -314,10 +469,11 @@ static int s_list_bucket_receive_body_callback(
 
     struct aws_s3_paginator *paginator = user_data;
 
-    if (body && body->len) {
-        aws_byte_buf_append_dynamic(&paginator->result_body, body);
+    if (body == NULL || body->len == 0) {
+        return AWS_OP_SUCCESS;
     }
-    return AWS_OP_SUCCESS;
+
+    return aws_s3_paginator_parse_page_body(paginator, *body);
 }
 
 static void s_list_bucket_request_finished(
@@ -327,28 +483,9 @@ static void s_list_bucket_request_finished(
     (void)meta_request;
     struct aws_s3_paginator *paginator = user_data;
 
-    if (meta_request_result->response_status == 200) {
-
-        struct aws_xml_parser_options parser_options = {
-            .doc = aws_byte_cursor_from_buf(&paginator->result_body),
-            .max_depth = 16U,
-        };
-
-        /* clears previous continuation token */
-        aws_mutex_lock(&paginator->shared_mt_state.lock);
-        if (paginator->shared_mt_state.continuation_token) {
-            aws_string_destroy(paginator->shared_mt_state.continuation_token);
-            paginator->shared_mt_state.continuation_token = NULL;
-            paginator->shared_mt_state.has_more_results = false;
-        }
-        aws_mutex_unlock(&paginator->shared_mt_state.lock);
-
-        /* we've got a full xml document now and the request succeeded, parse the document and fire all the callbacks
-         * for each object and prefix. All of that happens in these three lines. */
-        struct aws_xml_parser *parser = aws_xml_parser_new(paginator->allocator, &parser_options);
-        aws_xml_parser_parse(parser, s_on_root_node_encountered, paginator);
-        aws_xml_parser_destroy(parser);
+    if (meta_request_result->error_code == AWS_ERROR_SUCCESS && meta_request_result->response_status == 200) {
 
+        /* Every object and prefix of the page was passed on while the body arrived. */
         bool has_more_results = false;
         aws_mutex_lock(&paginator->shared_mt_state.lock);
         has_more_results = paginator->shared_mt_state.has_more_results;
@@ -398,6 +535,13 @@ int aws_s3_paginator_continue(struct aws_s3_paginator *paginator, const struct a
         aws_byte_buf_append_dynamic(&request_path, &s_delimiter_val);
     }
 
+    if (paginator->start_after) {
+        struct aws_byte_cursor s_start_after = aws_byte_cursor_from_c_str("&start-after=");
+        aws_byte_buf_append_dynamic(&request_path, &s_start_after);
+        struct aws_byte_cursor s_start_after_val = aws_byte_cursor_from_string(paginator->start_after);
+        aws_byte_buf_append_encoding_uri_param(&request_path, &s_start_after_val);
+    }
+
     aws_mutex_lock(&paginator->shared_mt_state.lock);
     if (paginator->shared_mt_state.continuation_token) {
         struct aws_byte_cursor s_continuation = aws_byte_cursor_from_c_str("&continuation-token=");
@@ -405,7 +549,12 @@ int aws_s3_paginator_continue(struct aws_s3_paginator *paginator, const struct a
         struct aws_byte_cursor s_continuation_val =
             aws_byte_cursor_from_string(paginator->shared_mt_state.continuation_token);
         aws_byte_buf_append_encoding_uri_param(&request_path, &s_continuation_val);
+
+        /* The page being requested says whether there is another one after it. */
+        aws_string_destroy(paginator->shared_mt_state.continuation_token);
+        paginator->shared_mt_state.continuation_token = NULL;
     }
+    paginator->shared_mt_state.has_more_results = false;
     aws_mutex_unlock(&paginator->shared_mt_state.lock);
 
     struct aws_http_message *list_objects_v2_request = aws_http_message_new_request(paginator->allocator);
@@ -445,6 +594,7 @@ int aws_s3_paginator_continue(struct aws_s3_paginator *paginator, const struct a
         .body_callback = s_list_bucket_receive_body_callback,
         .finish_callback = s_list_bucket_request_finished,
         .message = list_objects_v2_request,
+        .enable_direct_body_streaming = true,
     };
 
     /* re-use the current buffer. */
@@ -3,13 +3,18 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
+#include "aws/s3/private/s3_buffer_pool.h"
+#include "aws/s3/private/s3_checksums.h"
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_recv_file.h"
 #include "aws/s3/private/s3_util.h"
 #include <aws/auth/signable.h>
 #include <aws/auth/signing.h>
 #include <aws/auth/signing_config.h>
 #include <aws/auth/signing_result.h>
+#include <aws/common/clock.h>
+#include <aws/common/encoding.h>
 #include <aws/common/string.h>
 #include <aws/common/system_info.h>
 #include <aws/io/event_loop.h>
@@ -18,9 +23,8 @@
 #include <inttypes.h>
 
 static const size_t s_dynamic_body_initial_buf_size = KB_TO_BYTES(1);
-static const size_t s_default_body_streaming_priority_queue_size = 16;
+static const uint32_t s_default_body_streaming_window_size = 16;
 
-static int s_s3_request_priority_queue_pred(const void *a, const void *b);
 static void s_s3_meta_request_destroy(void *user_data);
 
 static void s_s3_meta_request_init_signing_date_time(
@@ -57,6 +61,12 @@ static void s_s3_meta_request_send_request_finish(
     struct aws_http_stream *stream,
     int error_code);
 
+static int s_s3_meta_request_recv_file_body_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_byte_cursor *body,
+    uint64_t range_start,
+    void *user_data);
+
 void aws_s3_meta_request_lock_synced_data(struct aws_s3_meta_request *meta_request) {
     AWS_PRECONDITION(meta_request);
 
@@ -106,6 +116,52 @@ int aws_s3_meta_request_init_base(
     *((size_t *)&meta_request->part_size) = part_size;
     *((bool *)&meta_request->should_compute_content_md5) = should_compute_content_md5;
 
+    enum aws_s3_meta_request_priority priority = options->priority;
+
+    if (priority == AWS_S3_META_REQUEST_PRIORITY_DEFAULT || priority >= AWS_S3_META_REQUEST_PRIORITY_MAX) {
+        priority = AWS_S3_META_REQUEST_PRIORITY_NORMAL;
+    }
+
+    *((enum aws_s3_meta_request_priority *)&meta_request->priority) = priority;
+    *((uint32_t *)&meta_request->weight) = options->weight > 0 ? options->weight : 1;
+    *((enum aws_s3_meta_request_delivery *)&meta_request->delivery) =
+        options->delivery == AWS_S3_META_REQUEST_DELIVERY_UNORDERED ? AWS_S3_META_REQUEST_DELIVERY_UNORDERED
+                                                                     : AWS_S3_META_REQUEST_DELIVERY_ORDERED;
+
+    enum aws_s3_payload_signing_mode payload_signing_mode = options->payload_signing_mode;
+
+    if (payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_DEFAULT && client != NULL) {
+        payload_signing_mode = client->payload_signing_mode;
+    }
+
+    /* Only uploads have a body that can be sent aws-chunked. */
+    if (payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER &&
+        options->type != AWS_S3_META_REQUEST_TYPE_PUT_OBJECT) {
+        payload_signing_mode = AWS_S3_PAYLOAD_SIGNING_MODE_UNSIGNED;
+    }
+
+    *((enum aws_s3_payload_signing_mode *)&meta_request->payload_signing_mode) = payload_signing_mode;
+
+    if (options->type == AWS_S3_META_REQUEST_TYPE_PUT_OBJECT) {
+        enum aws_s3_checksum_algorithm checksum_algorithm = options->checksum_algorithm;
+
+        if (checksum_algorithm == AWS_SCA_NONE && client != NULL) {
+            checksum_algorithm = client->checksum_algorithm;
+        }
+
+        /* The trailer of aws-chunked bodies always carries a checksum. */
+        if (checksum_algorithm == AWS_SCA_NONE &&
+            payload_signing_mode == AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER) {
+            checksum_algorithm = AWS_SCA_CRC32C;
+        }
+
+        *((enum aws_s3_checksum_algorithm *)&meta_request->checksum_algorithm) = checksum_algorithm;
+    }
+
+    if (options->type == AWS_S3_META_REQUEST_TYPE_GET_OBJECT) {
+        *((bool *)&meta_request->validate_response_checksum) = options->validate_response_checksum;
+    }
+
     if (options->signing_config) {
         meta_request->cached_signing_config = aws_cached_signing_config_new(allocator, options->signing_config);
     }
@@ -120,18 +176,24 @@ int aws_s3_meta_request_init_base(
         return AWS_OP_ERR;
     }
 
-    aws_priority_queue_init_dynamic(
-        &meta_request->synced_data.pending_body_streaming_requests,
-        meta_request->allocator,
-        s_default_body_streaming_priority_queue_size,
-        sizeof(struct aws_s3_request *),
-        s_s3_request_priority_queue_pred);
+    meta_request->synced_data.pending_body_streaming_requests.requests = aws_mem_calloc(
+        meta_request->allocator, s_default_body_streaming_window_size, sizeof(struct aws_s3_request *));
+    meta_request->synced_data.pending_body_streaming_requests.capacity = s_default_body_streaming_window_size;
+
+    aws_atomic_init_int(&meta_request->stats.num_requests_in_flight, 0);
+    aws_atomic_init_int(&meta_request->stats.num_requests_network_io, 0);
+    aws_atomic_init_int(&meta_request->stats.num_bytes_transferred, 0);
+    aws_atomic_init_int(&meta_request->stats.num_requests_succeeded, 0);
+    aws_atomic_init_int(&meta_request->stats.num_requests_failed, 0);
+    aws_atomic_init_int(&meta_request->stats.num_retries, 0);
+    aws_atomic_init_int(&meta_request->stats.total_request_latency_ns, 0);
 
     /* Client is currently optional to allow spinning up a meta_request without a client in a test. */
     if (client != NULL) {
         aws_s3_client_acquire(client);
         meta_request->client = client;
         meta_request->io_event_loop = aws_event_loop_group_get_next_loop(client->body_streaming_elg);
+        meta_request->synced_data.read_window_running_total = client->initial_read_window;
     }
 
     meta_request->synced_data.next_streaming_part = 1;
@@ -142,16 +204,157 @@ int aws_s3_meta_request_init_base(
     meta_request->finish_callback = options->finish_callback;
     meta_request->shutdown_callback = options->shutdown_callback;
     meta_request->progress_callback = options->progress_callback;
+    meta_request->telemetry_callback = options->telemetry_callback;
+
+    if (options->type == AWS_S3_META_REQUEST_TYPE_PUT_OBJECT) {
+        if (options->send_filepath.len > 0) {
+            meta_request->send_filepath = aws_string_new_from_cursor(allocator, &options->send_filepath);
+        } else if (options->read_body_at_callback != NULL) {
+            meta_request->read_body_at_callback = options->read_body_at_callback;
+        } else if (options->num_send_buffers > 0) {
+            if (aws_array_list_init_dynamic(
+                    &meta_request->send_buffers,
+                    allocator,
+                    options->num_send_buffers,
+                    sizeof(struct aws_s3_send_buffer))) {
+                return AWS_OP_ERR;
+            }
+
+            uint64_t offset = 0;
+
+            for (size_t buffer_index = 0; buffer_index < options->num_send_buffers; ++buffer_index) {
+                struct aws_s3_send_buffer send_buffer = {
+                    .data = options->send_buffers[buffer_index],
+                    .offset = offset,
+                };
+
+                /* Empty buffers are left out, so that every offset of the body is in exactly one buffer. */
+                if (send_buffer.data.len > 0) {
+                    aws_array_list_push_back(&meta_request->send_buffers, &send_buffer);
+                    offset += send_buffer.data.len;
+                }
+            }
+
+            meta_request->send_buffers_release_callback = options->send_buffers_release_callback;
+        }
+    }
+
+    if (options->type == AWS_S3_META_REQUEST_TYPE_GET_OBJECT && options->recv_filepath.len > 0) {
+        meta_request->recv_file = aws_s3_recv_file_open(
+            allocator, options->recv_filepath, options->recv_file_preallocate, options->recv_file_direct_io);
+
+        if (meta_request->recv_file == NULL) {
+            AWS_LOGF_ERROR(AWS_LS_S3_META_REQUEST, "id=%p Could not open file to receive into.", (void *)meta_request);
+            return AWS_OP_ERR;
+        }
+
+        /* Every part goes straight to its own offset of the file, so there is nothing to hold parts back for. */
+        *((enum aws_s3_meta_request_delivery *)&meta_request->delivery) = AWS_S3_META_REQUEST_DELIVERY_UNORDERED;
+        meta_request->recv_file_body_callback = options->body_callback;
+        meta_request->body_callback = s_s3_meta_request_recv_file_body_callback;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_meta_request_recv_file_body_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_byte_cursor *body,
+    uint64_t range_start,
+    void *user_data) {
+
+    if (aws_s3_recv_file_write(meta_request->recv_file, range_start, *body)) {
+        return AWS_OP_ERR;
+    }
+
+    if (meta_request->recv_file_body_callback != NULL) {
+        return meta_request->recv_file_body_callback(meta_request, body, range_start, user_data);
+    }
 
     return AWS_OP_SUCCESS;
 }
 
+void aws_s3_meta_request_get_metrics(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_meta_request_metrics *out_metrics) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(out_metrics);
+
+    AWS_ZERO_STRUCT(*out_metrics);
+
+    out_metrics->num_bytes_transferred = (uint64_t)aws_atomic_load_int(&meta_request->stats.num_bytes_transferred);
+    out_metrics->num_requests_in_flight = (uint32_t)aws_atomic_load_int(&meta_request->stats.num_requests_in_flight);
+    out_metrics->num_active_connections = (uint32_t)aws_atomic_load_int(&meta_request->stats.num_requests_network_io);
+    out_metrics->num_requests_succeeded = (uint64_t)aws_atomic_load_int(&meta_request->stats.num_requests_succeeded);
+    out_metrics->num_requests_failed = (uint64_t)aws_atomic_load_int(&meta_request->stats.num_requests_failed);
+    out_metrics->num_retries = (uint64_t)aws_atomic_load_int(&meta_request->stats.num_retries);
+
+    uint64_t total_request_latency_ns = (uint64_t)aws_atomic_load_int(&meta_request->stats.total_request_latency_ns);
+
+    if (out_metrics->num_requests_succeeded > 0) {
+        out_metrics->average_request_latency_ns = total_request_latency_ns / out_metrics->num_requests_succeeded;
+    }
+}
+
 void aws_s3_meta_request_cancel(struct aws_s3_meta_request *meta_request) {
     aws_s3_meta_request_lock_synced_data(meta_request);
     aws_s3_meta_request_set_fail_synced(meta_request, NULL, AWS_ERROR_S3_CANCELED);
     aws_s3_meta_request_unlock_synced_data(meta_request);
 }
 
+int aws_s3_meta_request_pause(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *out_resume_token) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(meta_request->vtable);
+    AWS_PRECONDITION(out_resume_token);
+
+    if (meta_request->vtable->pause == NULL) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Meta request of type %d cannot be paused.",
+            (void *)meta_request,
+            (int)meta_request->type);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    return meta_request->vtable->pause(meta_request, out_resume_token);
+}
+
+void aws_s3_meta_request_increment_read_window(struct aws_s3_meta_request *meta_request, uint64_t bytes) {
+    AWS_PRECONDITION(meta_request);
+
+    struct aws_s3_client *client = NULL;
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    if (meta_request->synced_data.read_window_running_total > UINT64_MAX - bytes) {
+        meta_request->synced_data.read_window_running_total = UINT64_MAX;
+    } else {
+        meta_request->synced_data.read_window_running_total += bytes;
+    }
+
+    /* The client is only released once the meta request is finished, so it is safe to use until then. */
+    if (meta_request->synced_data.state == AWS_S3_META_REQUEST_STATE_ACTIVE && meta_request->client != NULL) {
+        client = meta_request->client;
+        aws_s3_client_acquire(client);
+    }
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    if (client == NULL) {
+        return;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_S3_META_REQUEST,
+        "id=%p Read window incremented by %" PRIu64 " bytes.",
+        (void *)meta_request,
+        bytes);
+
+    /* Parts that were being held back may be able to go out now. */
+    aws_s3_client_schedule_meta_request_work(client, meta_request);
+    aws_s3_client_release(client);
+}
+
 void aws_s3_meta_request_set_fail_synced(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *failed_request,
@@ -262,12 +465,15 @@ static void s_s3_meta_request_destroy(void *user_data) {
     aws_s3_meta_request_shutdown_fn *shutdown_callback = meta_request->shutdown_callback;
 
     aws_cached_signing_config_destroy(meta_request->cached_signing_config);
+    aws_string_destroy(meta_request->send_filepath);
+    aws_array_list_clean_up(&meta_request->send_buffers);
+    aws_s3_recv_file_close(meta_request->recv_file);
     aws_mutex_clean_up(&meta_request->synced_data.lock);
     aws_s3_endpoint_release(meta_request->endpoint);
     aws_s3_client_release(meta_request->client);
 
-    AWS_ASSERT(aws_priority_queue_size(&meta_request->synced_data.pending_body_streaming_requests) == 0);
-    aws_priority_queue_clean_up(&meta_request->synced_data.pending_body_streaming_requests);
+    AWS_ASSERT(meta_request->synced_data.pending_body_streaming_requests.size == 0);
+    aws_mem_release(meta_request->allocator, meta_request->synced_data.pending_body_streaming_requests.requests);
     aws_s3_meta_request_result_clean_up(meta_request, &meta_request->synced_data.finish_result);
 
     AWS_LOGF_DEBUG(
@@ -285,18 +491,6 @@ static void s_s3_meta_request_destroy(void *user_data) {
     AWS_LOGF_DEBUG(AWS_LS_S3_META_REQUEST, "id=%p Meta request clean up finished.", (void *)meta_request);
 }
 
-static int s_s3_request_priority_queue_pred(const void *a, const void *b) {
-    const struct aws_s3_request **request_a = (const struct aws_s3_request **)a;
-    AWS_PRECONDITION(request_a);
-    AWS_PRECONDITION(*request_a);
-
-    const struct aws_s3_request **request_b = (const struct aws_s3_request **)b;
-    AWS_PRECONDITION(request_b);
-    AWS_PRECONDITION(*request_b);
-
-    return (*request_a)->part_number > (*request_b)->part_number;
-}
-
 bool aws_s3_meta_request_update(
     struct aws_s3_meta_request *meta_request,
     uint32_t flags,
@@ -329,6 +523,7 @@ bool aws_s3_meta_request_is_finished(struct aws_s3_meta_request *meta_request) {
 }
 
 static void s_s3_meta_request_prepare_request_task(struct aws_task *task, void *arg, enum aws_task_status task_status);
+static void s_s3_meta_request_sign_request_task(struct aws_task *task, void *arg, enum aws_task_status task_status);
 
 static void s_s3_prepare_request_payload_callback_and_destroy(
     struct aws_s3_prepare_request_payload *payload,
@@ -355,12 +550,6 @@ static void s_s3_prepare_request_payload_callback_and_destroy(
     aws_s3_client_release(client);
 }
 
-static void s_s3_meta_request_schedule_prepare_request_default(
-    struct aws_s3_meta_request *meta_request,
-    struct aws_s3_request *request,
-    aws_s3_meta_request_prepare_request_callback_fn *callback,
-    void *user_data);
-
 void aws_s3_meta_request_prepare_request(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request,
@@ -369,14 +558,31 @@ void aws_s3_meta_request_prepare_request(
     AWS_PRECONDITION(meta_request);
     AWS_PRECONDITION(meta_request->vtable);
 
+    aws_high_res_clock_get_ticks(&request->metrics.prepare_start_timestamp_ns);
+
     if (meta_request->vtable->schedule_prepare_request) {
         meta_request->vtable->schedule_prepare_request(meta_request, request, callback, user_data);
     } else {
-        s_s3_meta_request_schedule_prepare_request_default(meta_request, request, callback, user_data);
+        aws_s3_meta_request_schedule_prepare_request_default(meta_request, request, callback, user_data);
+    }
+}
+
+struct aws_event_loop *aws_s3_meta_request_get_prepare_event_loop(struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(meta_request);
+
+    /* A body that can be read at any offset doesn't have to be read in order, so requests are spread over all of the
+     * event loops to be prepared concurrently, rather than one after the other on the meta request's own. */
+    if (aws_s3_meta_request_has_positional_body(meta_request)) {
+        struct aws_s3_client *client = meta_request->client;
+
+        return aws_event_loop_group_get_next_loop(
+            meta_request->cpu_group != NULL ? meta_request->cpu_group->body_streaming_elg : client->body_streaming_elg);
     }
+
+    return meta_request->io_event_loop;
 }
 
-static void s_s3_meta_request_schedule_prepare_request_default(
+void aws_s3_meta_request_schedule_prepare_request_default(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request,
     aws_s3_meta_request_prepare_request_callback_fn *callback,
@@ -399,12 +605,11 @@ static void s_s3_meta_request_schedule_prepare_request_default(
 
     aws_task_init(
         &payload->task, s_s3_meta_request_prepare_request_task, payload, "s3_meta_request_prepare_request_task");
-    aws_event_loop_schedule_task_now(meta_request->io_event_loop, &payload->task);
+    aws_event_loop_schedule_task_now(aws_s3_meta_request_get_prepare_event_loop(meta_request), &payload->task);
 }
 
 static void s_s3_meta_request_prepare_request_task(struct aws_task *task, void *arg, enum aws_task_status task_status) {
     (void)task;
-    (void)task_status;
 
     struct aws_s3_prepare_request_payload *payload = arg;
     AWS_PRECONDITION(payload);
@@ -418,12 +623,18 @@ static void s_s3_meta_request_prepare_request_task(struct aws_task *task, void *
     struct aws_s3_meta_request_vtable *vtable = meta_request->vtable;
     AWS_PRECONDITION(vtable);
 
-    /* Client owns this event loop group. A cancel should not be possible. */
-    AWS_ASSERT(task_status == AWS_TASK_STATUS_RUN_READY);
+    /* Without a positional body, this runs on the meta request's io_event_loop, which comes from the client
+     * bootstrap's event loop group. The caller owns that group, and can shut it down while requests are still being
+     * prepared. */
+    if (task_status != AWS_TASK_STATUS_RUN_READY) {
+        s_s3_prepare_request_payload_callback_and_destroy(payload, AWS_ERROR_S3_CANCELED);
+        return;
+    }
 
     int error_code = AWS_ERROR_SUCCESS;
 
-    if (!request->always_send && aws_s3_meta_request_has_finish_result(meta_request)) {
+    if ((!request->always_send && aws_s3_meta_request_has_finish_result(meta_request)) ||
+        aws_s3_request_is_cancelled(request)) {
         aws_raise_error(AWS_ERROR_S3_CANCELED);
         goto dont_send_clean_up;
     }
@@ -435,8 +646,39 @@ static void s_s3_meta_request_prepare_request_task(struct aws_task *task, void *
 
     ++request->num_times_prepared;
 
+    /* There is nothing to send for a request whose response was read from the block cache. */
+    if (request->send_data.served_from_cache) {
+        s_s3_prepare_request_payload_callback_and_destroy(payload, AWS_ERROR_SUCCESS);
+        return;
+    }
+
     aws_s3_add_user_agent_header(meta_request->allocator, request->send_data.message);
 
+    /* Requests of meta requests without a positional body are all prepared on the meta request's own event loop, which
+     * for many small requests (ranged GETs in particular) leaves signing them, the most expensive part of preparing
+     * them, to a single thread. Signing doesn't depend on the order requests are prepared in, so it is spread over the
+     * client's connection I/O event loops instead. Not over the body streaming event loops: those run the callers' body
+     * callbacks, which can block, and can be shared with other clients through a client context. */
+    if (!aws_s3_meta_request_has_positional_body(meta_request)) {
+        struct aws_s3_client *client = meta_request->client;
+        struct aws_event_loop_group *event_loop_group = meta_request->cpu_group != NULL
+                                                            ? meta_request->cpu_group->event_loop_group
+                                                            : client->client_bootstrap->event_loop_group;
+
+        /* With a single-loop group, or when the next loop is the one the request was prepared on, there is nowhere
+         * else to sign it, so it is signed in place. */
+        struct aws_event_loop *sign_event_loop = aws_event_loop_group_get_loop_count(event_loop_group) > 1
+                                                     ? aws_event_loop_group_get_next_loop(event_loop_group)
+                                                     : NULL;
+
+        if (sign_event_loop != NULL && sign_event_loop != meta_request->io_event_loop) {
+            aws_task_init(
+                &payload->task, s_s3_meta_request_sign_request_task, payload, "s3_meta_request_sign_request_task");
+            aws_event_loop_schedule_task_now(sign_event_loop, &payload->task);
+            return;
+        }
+    }
+
     /* Sign the newly created message. */
     s_s3_meta_request_sign_request(meta_request, request, s_s3_meta_request_request_on_signed, payload);
 
@@ -461,6 +703,25 @@ dont_send_clean_up:
     s_s3_prepare_request_payload_callback_and_destroy(payload, error_code);
 }
 
+static void s_s3_meta_request_sign_request_task(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+    (void)task;
+
+    struct aws_s3_prepare_request_payload *payload = arg;
+    AWS_PRECONDITION(payload);
+
+    struct aws_s3_request *request = payload->request;
+    AWS_PRECONDITION(request);
+
+    /* Unless the meta request is pinned to a CPU group, this runs on client->client_bootstrap->event_loop_group. The
+     * caller owns that group, and can shut it down while requests are still being signed. */
+    if (task_status != AWS_TASK_STATUS_RUN_READY) {
+        s_s3_prepare_request_payload_callback_and_destroy(payload, AWS_ERROR_S3_CANCELED);
+        return;
+    }
+
+    s_s3_meta_request_sign_request(request->meta_request, request, s_s3_meta_request_request_on_signed, payload);
+}
+
 static void s_s3_meta_request_init_signing_date_time(
     struct aws_s3_meta_request *meta_request,
     struct aws_date_time *date_time) {
@@ -490,6 +751,8 @@ static void s_s3_meta_request_sign_request(
     AWS_PRECONDITION(meta_request->vtable);
     AWS_PRECONDITION(meta_request->vtable->send_request_finish);
 
+    aws_high_res_clock_get_ticks(&request->metrics.sign_start_timestamp_ns);
+
     meta_request->vtable->sign_request(meta_request, request, on_signing_complete, user_data);
 }
 
@@ -525,6 +788,26 @@ void aws_s3_meta_request_sign_request_default(
 
     s_s3_meta_request_init_signing_date_time(meta_request, &signing_config.date);
 
+    /* Hashing the payload for the signature means going over all of it before it can be sent. Over TLS that buys
+     * nothing, and aws-chunked bodies are covered by the checksum in their trailer instead. */
+    switch (meta_request->payload_signing_mode) {
+        case AWS_S3_PAYLOAD_SIGNING_MODE_DEFAULT:
+            break;
+        case AWS_S3_PAYLOAD_SIGNING_MODE_UNSIGNED:
+            signing_config.signed_body_header = AWS_SBHT_X_AMZ_CONTENT_SHA256;
+            signing_config.signed_body_value = g_aws_signed_body_value_unsigned_payload;
+            break;
+        case AWS_S3_PAYLOAD_SIGNING_MODE_STREAMING_UNSIGNED_TRAILER: {
+            struct aws_http_headers *headers = aws_http_message_get_headers(request->send_data.message);
+
+            signing_config.signed_body_header = AWS_SBHT_X_AMZ_CONTENT_SHA256;
+            signing_config.signed_body_value = aws_http_headers_has(headers, g_trailer_header_name)
+                                                   ? g_s3_signed_body_value_streaming_unsigned_payload_trailer
+                                                   : g_aws_signed_body_value_unsigned_payload;
+            break;
+        }
+    }
+
     request->send_data.signable = aws_signable_new_http_request(meta_request->allocator, request->send_data.message);
 
     AWS_LOGF_DEBUG(
@@ -576,6 +859,8 @@ static void s_s3_meta_request_request_on_signed(
     struct aws_s3_meta_request *meta_request = request->meta_request;
     AWS_PRECONDITION(meta_request);
 
+    aws_high_res_clock_get_ticks(&request->metrics.sign_end_timestamp_ns);
+
     if (error_code != AWS_ERROR_SUCCESS) {
         goto finish;
     }
@@ -600,13 +885,24 @@ finish:
             aws_error_str(error_code));
 
         aws_s3_meta_request_lock_synced_data(meta_request);
-        aws_s3_meta_request_set_fail_synced(meta_request, request, error_code);
+        aws_s3_meta_request_set_fail_synced(meta_request, NULL, error_code);
         aws_s3_meta_request_unlock_synced_data(meta_request);
     }
 
     s_s3_prepare_request_payload_callback_and_destroy(payload, error_code);
 }
 
+void aws_s3_meta_request_on_request_sent(struct aws_s3_meta_request *meta_request, struct aws_s3_request *request) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(request);
+
+    if (request->num_times_sent == 0 && meta_request->vtable->request_sent != NULL) {
+        meta_request->vtable->request_sent(meta_request, request);
+    }
+
+    ++request->num_times_sent;
+}
+
 void aws_s3_meta_request_send_request(struct aws_s3_meta_request *meta_request, struct aws_s3_connection *connection) {
     AWS_PRECONDITION(meta_request);
     AWS_PRECONDITION(connection);
@@ -615,6 +911,11 @@ void aws_s3_meta_request_send_request(struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request = connection->request;
     AWS_PRECONDITION(request);
 
+    aws_high_res_clock_get_ticks(&request->metrics.send_start_timestamp_ns);
+    request->metrics.first_byte_timestamp_ns = 0;
+
+    aws_s3_meta_request_on_request_sent(meta_request, request);
+
     /* Now that we have a signed request and a connection, go ahead and issue the request. */
     struct aws_http_make_request_options options;
     AWS_ZERO_STRUCT(options);
@@ -678,6 +979,93 @@ static int s_s3_meta_request_error_code_from_response_status(int response_status
     return error_code;
 }
 
+/* Start checking the response body of the request against the checksum S3 sent with it, if there is one. Composite
+ * checksums (those of multipart uploads, made of the checksums of the parts) can't be checked against a body, and are
+ * skipped. So is the body of a request that has already passed some of it to the body callback. */
+static int s_s3_meta_request_init_response_checksum(
+    struct aws_s3_request *request,
+    const struct aws_http_header *headers,
+    size_t headers_count) {
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+
+    if (request->send_data.response_checksum != NULL || request->streaming_response_body_directly) {
+        return AWS_OP_SUCCESS;
+    }
+
+    for (size_t i = 0; i < headers_count; ++i) {
+        for (int algorithm = AWS_SCA_NONE + 1; algorithm <= AWS_SCA_SHA256; ++algorithm) {
+            struct aws_byte_cursor checksum_header_name =
+                aws_s3_checksum_get_header_name((enum aws_s3_checksum_algorithm)algorithm);
+
+            if (!aws_byte_cursor_eq_ignore_case(&headers[i].name, &checksum_header_name)) {
+                continue;
+            }
+
+            struct aws_byte_cursor composite_separator = aws_byte_cursor_from_c_str("-");
+            struct aws_byte_cursor found;
+
+            if (aws_byte_cursor_find_exact(&headers[i].value, &composite_separator, &found) == AWS_OP_SUCCESS) {
+                return AWS_OP_SUCCESS;
+            }
+
+            request->send_data.response_checksum =
+                aws_s3_checksum_new(meta_request->allocator, (enum aws_s3_checksum_algorithm)algorithm);
+
+            if (request->send_data.response_checksum == NULL) {
+                return AWS_OP_ERR;
+            }
+
+            request->send_data.expected_response_checksum =
+                aws_string_new_from_cursor(meta_request->allocator, &headers[i].value);
+
+            return AWS_OP_SUCCESS;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Returns AWS_ERROR_S3_RESPONSE_CHECKSUM_MISMATCH if the response body doesn't match the checksum S3 sent with it. */
+static int s_s3_meta_request_check_response_checksum(struct aws_s3_request *request) {
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+
+    uint8_t digest[AWS_SHA256_LEN];
+    struct aws_byte_buf digest_buf = aws_byte_buf_from_empty_array(digest, sizeof(digest));
+
+    if (aws_s3_checksum_finalize(request->send_data.response_checksum, &digest_buf)) {
+        return aws_last_error_or_unknown();
+    }
+
+    /* Base64 of a SHA256 is 44 characters long, the longest of all. */
+    uint8_t encoded_digest[64];
+    struct aws_byte_buf encoded_digest_buf = aws_byte_buf_from_empty_array(encoded_digest, sizeof(encoded_digest));
+    struct aws_byte_cursor digest_cursor = aws_byte_cursor_from_buf(&digest_buf);
+
+    if (aws_base64_encode(&digest_cursor, &encoded_digest_buf)) {
+        return aws_last_error_or_unknown();
+    }
+
+    struct aws_byte_cursor actual_checksum = aws_byte_cursor_from_buf(&encoded_digest_buf);
+
+    if (!aws_string_eq_byte_cursor(request->send_data.expected_response_checksum, &actual_checksum)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Response body of request %p does not match its checksum (expected %s, got " PRInSTR ").",
+            (void *)meta_request,
+            (void *)request,
+            aws_string_c_str(request->send_data.expected_response_checksum),
+            AWS_BYTE_CURSOR_PRI(actual_checksum));
+
+        return AWS_ERROR_S3_RESPONSE_CHECKSUM_MISMATCH;
+    }
+
+    return AWS_ERROR_SUCCESS;
+}
+
 static int s_s3_meta_request_incoming_headers(
     struct aws_http_stream *stream,
     enum aws_http_header_block header_block,
@@ -685,8 +1073,6 @@ static int s_s3_meta_request_incoming_headers(
     size_t headers_count,
     void *user_data) {
 
-    (void)header_block;
-
     AWS_PRECONDITION(stream);
 
     struct aws_s3_connection *connection = user_data;
@@ -695,6 +1081,30 @@ static int s_s3_meta_request_incoming_headers(
     struct aws_s3_request *request = connection->request;
     AWS_PRECONDITION(request);
 
+    int response_status = request->send_data.response_status;
+
+    if (aws_http_stream_get_incoming_response_status(stream, &response_status)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Could not get incoming response status for request %p",
+            (void *)request->meta_request,
+            (void *)request);
+    }
+
+    return aws_s3_meta_request_on_response_headers(connection, response_status, header_block, headers, headers_count);
+}
+
+int aws_s3_meta_request_on_response_headers(
+    struct aws_s3_connection *connection,
+    int response_status,
+    enum aws_http_header_block header_block,
+    const struct aws_http_header *headers,
+    size_t headers_count) {
+    AWS_PRECONDITION(connection);
+
+    struct aws_s3_request *request = connection->request;
+    AWS_PRECONDITION(request);
+
     struct aws_s3_meta_request *meta_request = request->meta_request;
     AWS_PRECONDITION(meta_request);
 
@@ -705,14 +1115,12 @@ static int s_s3_meta_request_incoming_headers(
         (void *)request,
         (void *)connection);
 
-    if (aws_http_stream_get_incoming_response_status(stream, &request->send_data.response_status)) {
-        AWS_LOGF_ERROR(
-            AWS_LS_S3_META_REQUEST,
-            "id=%p Could not get incoming response status for request %p",
-            (void *)meta_request,
-            (void *)request);
+    if (request->metrics.first_byte_timestamp_ns == 0) {
+        aws_high_res_clock_get_ticks(&request->metrics.first_byte_timestamp_ns);
     }
 
+    request->send_data.response_status = response_status;
+
     bool successful_response =
         s_s3_meta_request_error_code_from_response_status(request->send_data.response_status) == AWS_ERROR_SUCCESS;
 
@@ -732,16 +1140,143 @@ static int s_s3_meta_request_incoming_headers(
         }
     }
 
+    if (meta_request->validate_response_checksum && successful_response &&
+        header_block == AWS_HTTP_HEADER_BLOCK_MAIN) {
+        return s_s3_meta_request_init_response_checksum(request, headers, headers_count);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Returns true if the response body of the request can be passed to the body callback as it arrives: unless delivery is
+ * unordered, the request has to be for the next part in line to be delivered, with nothing else still being delivered
+ * ahead of it, and the response has to be a successful one. Once a request starts streaming its body this way, it
+ * keeps doing so. */
+static bool s_s3_meta_request_can_stream_response_body_directly(struct aws_s3_request *request) {
+    AWS_PRECONDITION(request);
+
+    if (request->streaming_response_body_directly) {
+        return true;
+    }
+
+    /* A body that is being checked has to arrive in full before any of it can be trusted. */
+    if (request->send_data.response_checksum != NULL) {
+        return false;
+    }
+
+    if (request->send_data.response_status != AWS_S3_RESPONSE_STATUS_SUCCESS &&
+        request->send_data.response_status != AWS_S3_RESPONSE_STATUS_RANGE_SUCCESS) {
+        return false;
+    }
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    /* Parts before this one are delivered by the body streaming task, which has to be done with them first. Without
+     * ordering, there is nothing to wait for. */
+    if (meta_request->delivery == AWS_S3_META_REQUEST_DELIVERY_UNORDERED) {
+        request->streaming_response_body_directly = !aws_s3_meta_request_has_finish_result_synced(meta_request);
+    } else {
+        request->streaming_response_body_directly =
+            request->part_number == meta_request->synced_data.next_streaming_part &&
+            meta_request->synced_data.num_parts_delivery_completed ==
+                meta_request->synced_data.num_parts_delivery_sent &&
+            !aws_s3_meta_request_has_finish_result_synced(meta_request);
+    }
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    if (request->streaming_response_body_directly) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Request %p is next in line, streaming its response body directly to the caller.",
+            (void *)meta_request,
+            (void *)request);
+    }
+
+    return request->streaming_response_body_directly;
+}
+
+/* Pass the part of the data that starts at body_offset in this attempt's response body to the body callback, skipping
+ * whatever a previous attempt already delivered. */
+static int s_s3_meta_request_deliver_response_body_directly(
+    struct aws_s3_request *request,
+    struct aws_byte_cursor data,
+    uint64_t body_offset) {
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+
+    if (body_offset + data.len <= request->num_response_body_bytes_streamed) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (body_offset < request->num_response_body_bytes_streamed) {
+        aws_byte_cursor_advance(&data, (size_t)(request->num_response_body_bytes_streamed - body_offset));
+    }
+
+    if (data.len == 0 || meta_request->body_callback == NULL) {
+        request->num_response_body_bytes_streamed += data.len;
+        return AWS_OP_SUCCESS;
+    }
+
+    if (meta_request->body_callback(
+            meta_request,
+            &data,
+            request->part_range_start + request->num_response_body_bytes_streamed,
+            meta_request->user_data)) {
+        int error_code = aws_last_error_or_unknown();
+
+        aws_s3_meta_request_lock_synced_data(meta_request);
+        aws_s3_meta_request_set_fail_synced(meta_request, NULL, error_code);
+        aws_s3_meta_request_unlock_synced_data(meta_request);
+
+        return aws_raise_error(error_code);
+    }
+
+    request->num_response_body_bytes_streamed += data.len;
+
     return AWS_OP_SUCCESS;
 }
 
+static int s_s3_meta_request_stream_response_body_directly(
+    struct aws_s3_request *request,
+    const struct aws_byte_cursor *data,
+    uint64_t body_offset) {
+    AWS_PRECONDITION(request);
+    AWS_PRECONDITION(data);
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+
+    if (aws_s3_meta_request_has_finish_result(meta_request)) {
+        return aws_raise_error(AWS_ERROR_S3_CANCELED);
+    }
+
+    /* Anything recorded before this request got its turn goes out first. */
+    if (request->send_data.response_body.len > 0) {
+        struct aws_byte_cursor recorded_body = aws_byte_cursor_from_buf(&request->send_data.response_body);
+
+        if (s_s3_meta_request_deliver_response_body_directly(request, recorded_body, 0)) {
+            return AWS_OP_ERR;
+        }
+
+        request->send_data.response_body.len = 0;
+    }
+
+    return s_s3_meta_request_deliver_response_body_directly(request, *data, body_offset);
+}
+
 static int s_s3_meta_request_incoming_body(
     struct aws_http_stream *stream,
     const struct aws_byte_cursor *data,
     void *user_data) {
     (void)stream;
 
-    struct aws_s3_connection *connection = user_data;
+    return aws_s3_meta_request_on_response_body(user_data, data);
+}
+
+int aws_s3_meta_request_on_response_body(struct aws_s3_connection *connection, const struct aws_byte_cursor *data) {
     AWS_PRECONDITION(connection);
 
     struct aws_s3_request *request = connection->request;
@@ -760,14 +1295,53 @@ static int s_s3_meta_request_incoming_body(
         (uint64_t)data->len,
         (void *)connection);
 
+    /* Stop receiving the body of a request that is no longer needed. This fails the stream, which closes the
+     * connection. */
+    if (aws_s3_request_is_cancelled(request)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p: Request %p was cancelled, no longer receiving its response body.",
+            (void *)meta_request,
+            (void *)request);
+
+        return aws_raise_error(AWS_ERROR_S3_CANCELED);
+    }
+
+    const uint64_t body_offset = request->send_data.num_response_body_bytes;
+    request->send_data.num_response_body_bytes += data->len;
+
+    /* The checksum is kept up to date as the body arrives, so that checking it takes no second pass over the body. */
+    if (request->send_data.response_checksum != NULL &&
+        aws_s3_checksum_update(request->send_data.response_checksum, data)) {
+        return AWS_OP_ERR;
+    }
+
+    if (request->stream_response_body_directly && s_s3_meta_request_can_stream_response_body_directly(request)) {
+        return s_s3_meta_request_stream_response_body_directly(request, data, body_offset);
+    }
+
     if (request->send_data.response_body.capacity == 0) {
-        size_t buffer_size = s_dynamic_body_initial_buf_size;
+        int init_result = AWS_OP_SUCCESS;
 
         if (request->part_size_response_body) {
-            buffer_size = meta_request->part_size;
+            init_result = aws_s3_meta_request_init_part_buffer(
+                meta_request, aws_s3_request_get_part_buffer_size(request), &request->send_data.response_body);
+        } else {
+            init_result = aws_byte_buf_init(
+                &request->send_data.response_body, meta_request->allocator, s_dynamic_body_initial_buf_size);
         }
 
-        aws_byte_buf_init(&request->send_data.response_body, meta_request->allocator, buffer_size);
+        if (init_result != AWS_OP_SUCCESS) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p: Request %p could not allocate its response body due to error %d (%s)",
+                (void *)meta_request,
+                (void *)request,
+                aws_last_error_or_unknown(),
+                aws_error_str(aws_last_error_or_unknown()));
+
+            return AWS_OP_ERR;
+        }
     }
 
     if (aws_byte_buf_append_dynamic(&request->send_data.response_body, data)) {
@@ -795,6 +1369,12 @@ static void s_s3_meta_request_stream_complete(struct aws_http_stream *stream, in
     s_s3_meta_request_send_request_finish(connection, stream, error_code);
 }
 
+void aws_s3_meta_request_on_response_complete(struct aws_s3_connection *connection, int error_code) {
+    AWS_PRECONDITION(connection);
+
+    s_s3_meta_request_send_request_finish(connection, NULL, error_code);
+}
+
 static void s_s3_meta_request_send_request_finish(
     struct aws_s3_connection *connection,
     struct aws_http_stream *stream,
@@ -836,6 +1416,16 @@ void aws_s3_meta_request_send_request_finish_default(
         /* Check if the response code indicates an error occurred. */
         error_code = s_s3_meta_request_error_code_from_response_status(response_status);
 
+        /* A 304 to a request revalidating what the block cache has of its response means that is still good. */
+        if (response_status == AWS_S3_RESPONSE_STATUS_NOT_MODIFIED && request->send_data.revalidating_cache) {
+            error_code = AWS_ERROR_SUCCESS;
+        }
+
+        /* A body that doesn't match its checksum is retried like any other failed request. */
+        if (error_code == AWS_ERROR_SUCCESS && request->send_data.response_checksum != NULL) {
+            error_code = s_s3_meta_request_check_response_checksum(request);
+        }
+
         if (error_code != AWS_ERROR_SUCCESS) {
             aws_raise_error(error_code);
         }
@@ -860,9 +1450,15 @@ void aws_s3_meta_request_send_request_finish_default(
         bool meta_request_finishing = aws_s3_meta_request_has_finish_result_synced(meta_request);
         aws_s3_meta_request_unlock_synced_data(meta_request);
 
-        /* If the request failed due to an invalid (ie: unrecoverable) response status, or the meta request already has
-         * a result, then make sure that this request isn't retried. */
-        if (error_code == AWS_ERROR_S3_INVALID_RESPONSE_STATUS || meta_request_finishing) {
+        bool request_cancelled = aws_s3_request_is_cancelled(request);
+
+        if (request_cancelled) {
+            error_code = AWS_ERROR_S3_CANCELED;
+        }
+
+        /* If the request failed due to an invalid (ie: unrecoverable) response status, the meta request already has a
+         * result, or the request is no longer needed, then make sure that this request isn't retried. */
+        if (error_code == AWS_ERROR_S3_INVALID_RESPONSE_STATUS || meta_request_finishing || request_cancelled) {
             finish_code = AWS_S3_CONNECTION_FINISH_CODE_FAILED;
 
             AWS_LOGF_ERROR(
@@ -905,6 +1501,16 @@ void aws_s3_meta_request_finished_request(
     AWS_PRECONDITION(meta_request);
     AWS_PRECONDITION(meta_request->vtable);
     AWS_PRECONDITION(meta_request->vtable->finished_request);
+    AWS_PRECONDITION(request);
+
+    aws_high_res_clock_get_ticks(&request->metrics.finish_timestamp_ns);
+    request->metrics.part_number = request->part_number;
+    request->metrics.response_status = request->send_data.response_status;
+    request->metrics.error_code = error_code;
+
+    if (meta_request->telemetry_callback != NULL) {
+        meta_request->telemetry_callback(meta_request, &request->metrics, meta_request->user_data);
+    }
 
     meta_request->vtable->finished_request(meta_request, request, error_code);
 }
@@ -915,20 +1521,52 @@ struct s3_stream_response_body_payload {
     struct aws_task task;
 };
 
-/* Pushes a request into the body streaming priority queue. Derived meta request types should not call this--they should
- * instead call aws_s3_meta_request_stream_response_body_synced.*/
-static void s_s3_meta_request_body_streaming_push_synced(
+/* Pushes a request into the body streaming window. Raises AWS_ERROR_INVALID_STATE, leaving the window the same, if a
+ * request for the same part is already in it, or if that part has already been streamed. Derived meta request types
+ * should not call this--they should instead call aws_s3_meta_request_stream_response_body_synced.*/
+static int s_s3_meta_request_body_streaming_push_synced(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request);
 
-/* Pops the next available request from the body streaming priority queue. If the parts previous the next request in the
- * priority queue have not been placed in the priority queue yet, the priority queue will remain the same, and NULL will
- * be returned. (Should not be needed to be called by derived types.) */
+/* Pops the next available request from the body streaming window. If the part at next_streaming_part has not been
+ * placed in the window yet, the window will remain the same, and NULL will be returned. (Should not be needed to be
+ * called by derived types.) */
 static struct aws_s3_request *s_s3_meta_request_body_streaming_pop_next_synced(
     struct aws_s3_meta_request *meta_request);
 
 static void s_s3_meta_request_body_streaming_task(struct aws_task *task, void *arg, enum aws_task_status task_status);
 
+/* Schedule a task on the event loop that delivers the bodies of the requests in the list to the caller. */
+static void s_s3_meta_request_schedule_body_streaming_synced(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_linked_list *streaming_requests,
+    uint32_t num_streaming_requests,
+    struct aws_event_loop *event_loop) {
+    ASSERT_SYNCED_DATA_LOCK_HELD(meta_request);
+    AWS_PRECONDITION(streaming_requests);
+    AWS_PRECONDITION(event_loop);
+
+    struct aws_s3_client *client = meta_request->client;
+    AWS_PRECONDITION(client);
+
+    aws_atomic_fetch_add(&client->stats.num_requests_streaming, num_streaming_requests);
+
+    meta_request->synced_data.num_parts_delivery_sent += num_streaming_requests;
+
+    struct s3_stream_response_body_payload *payload =
+        aws_mem_calloc(client->allocator, 1, sizeof(struct s3_stream_response_body_payload));
+
+    aws_s3_meta_request_acquire(meta_request);
+    payload->meta_request = meta_request;
+
+    aws_linked_list_init(&payload->requests);
+    aws_linked_list_swap_contents(&payload->requests, streaming_requests);
+
+    aws_task_init(
+        &payload->task, s_s3_meta_request_body_streaming_task, payload, "s_s3_meta_request_body_streaming_task");
+    aws_event_loop_schedule_task_now(event_loop, &payload->task);
+}
+
 void aws_s3_meta_request_stream_response_body_synced(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request) {
@@ -940,11 +1578,30 @@ void aws_s3_meta_request_stream_response_body_synced(
     struct aws_linked_list streaming_requests;
     aws_linked_list_init(&streaming_requests);
 
-    /* Push it into the priority queue. */
-    s_s3_meta_request_body_streaming_push_synced(meta_request, request);
-
     struct aws_s3_client *client = meta_request->client;
     AWS_PRECONDITION(client);
+
+    /* Without ordering, each part goes out on its own as soon as it arrives, spread over the body streaming event
+     * loops so that parts are delivered in parallel. */
+    if (meta_request->delivery == AWS_S3_META_REQUEST_DELIVERY_UNORDERED) {
+        struct aws_event_loop_group *body_streaming_elg = meta_request->cpu_group != NULL
+                                                              ? meta_request->cpu_group->body_streaming_elg
+                                                              : client->body_streaming_elg;
+
+        aws_s3_request_acquire(request);
+        aws_linked_list_push_back(&streaming_requests, &request->node);
+
+        s_s3_meta_request_schedule_body_streaming_synced(
+            meta_request, &streaming_requests, 1, aws_event_loop_group_get_next_loop(body_streaming_elg));
+        return;
+    }
+
+    /* Hold onto it until the parts before it have been streamed. */
+    if (s_s3_meta_request_body_streaming_push_synced(meta_request, request)) {
+        aws_s3_meta_request_set_fail_synced(meta_request, request, aws_last_error_or_unknown());
+        return;
+    }
+
     aws_atomic_fetch_add(&client->stats.num_requests_stream_queued_waiting, 1);
 
     /* Grab the next request that can be streamed back to the caller. */
@@ -964,22 +1621,8 @@ void aws_s3_meta_request_stream_response_body_synced(
         return;
     }
 
-    aws_atomic_fetch_add(&client->stats.num_requests_streaming, num_streaming_requests);
-
-    meta_request->synced_data.num_parts_delivery_sent += num_streaming_requests;
-
-    struct s3_stream_response_body_payload *payload =
-        aws_mem_calloc(client->allocator, 1, sizeof(struct s3_stream_response_body_payload));
-
-    aws_s3_meta_request_acquire(meta_request);
-    payload->meta_request = meta_request;
-
-    aws_linked_list_init(&payload->requests);
-    aws_linked_list_swap_contents(&payload->requests, &streaming_requests);
-
-    aws_task_init(
-        &payload->task, s_s3_meta_request_body_streaming_task, payload, "s_s3_meta_request_body_streaming_task");
-    aws_event_loop_schedule_task_now(meta_request->io_event_loop, &payload->task);
+    s_s3_meta_request_schedule_body_streaming_synced(
+        meta_request, &streaming_requests, num_streaming_requests, meta_request->io_event_loop);
 }
 
 static void s_s3_meta_request_body_streaming_task(struct aws_task *task, void *arg, enum aws_task_status task_status) {
@@ -1015,10 +1658,13 @@ static void s_s3_meta_request_body_streaming_task(struct aws_task *task, void *a
 
         AWS_ASSERT(request->part_number >= 1);
 
+        /* A body that was streamed directly to the caller already went out as it arrived. */
+        const bool already_delivered = request->streaming_response_body_directly && body_buffer_byte_cursor.len == 0;
+
         if (aws_s3_meta_request_has_finish_result(meta_request)) {
             ++num_failed;
         } else {
-            if (error_code == AWS_ERROR_SUCCESS && meta_request->body_callback &&
+            if (error_code == AWS_ERROR_SUCCESS && !already_delivered && meta_request->body_callback &&
                 meta_request->body_callback(
                     meta_request, &body_buffer_byte_cursor, request->part_range_start, meta_request->user_data)) {
                 error_code = aws_last_error_or_unknown();
@@ -1048,11 +1694,43 @@ static void s_s3_meta_request_body_streaming_task(struct aws_task *task, void *a
     aws_mem_release(client->allocator, payload);
     payload = NULL;
 
-    aws_s3_client_schedule_process_work(client);
+    aws_s3_client_schedule_meta_request_work(client, meta_request);
     aws_s3_meta_request_release(meta_request);
 }
 
-static void s_s3_meta_request_body_streaming_push_synced(
+/* Grow the window of pending body streaming requests to at least min_capacity slots, laying the requests back out from
+ * the first slot. */
+static void s_s3_meta_request_body_streaming_grow_synced(
+    struct aws_s3_meta_request *meta_request,
+    uint32_t min_capacity) {
+    ASSERT_SYNCED_DATA_LOCK_HELD(meta_request);
+
+    uint32_t old_capacity = meta_request->synced_data.pending_body_streaming_requests.capacity;
+    uint32_t new_capacity = old_capacity;
+
+    while (new_capacity < min_capacity) {
+        AWS_FATAL_ASSERT(new_capacity <= UINT32_MAX / 2);
+        new_capacity *= 2;
+    }
+
+    struct aws_s3_request **old_requests = meta_request->synced_data.pending_body_streaming_requests.requests;
+    struct aws_s3_request **new_requests =
+        aws_mem_calloc(meta_request->allocator, new_capacity, sizeof(struct aws_s3_request *));
+
+    uint32_t start = meta_request->synced_data.pending_body_streaming_requests.start;
+
+    for (uint32_t i = 0; i < old_capacity; ++i) {
+        new_requests[i] = old_requests[(start + i) & (old_capacity - 1)];
+    }
+
+    aws_mem_release(meta_request->allocator, old_requests);
+
+    meta_request->synced_data.pending_body_streaming_requests.requests = new_requests;
+    meta_request->synced_data.pending_body_streaming_requests.capacity = new_capacity;
+    meta_request->synced_data.pending_body_streaming_requests.start = 0;
+}
+
+static int s_s3_meta_request_body_streaming_push_synced(
     struct aws_s3_meta_request *meta_request,
     struct aws_s3_request *request) {
     ASSERT_SYNCED_DATA_LOCK_HELD(meta_request);
@@ -1061,9 +1739,41 @@ static void s_s3_meta_request_body_streaming_push_synced(
 
     AWS_ASSERT(request->meta_request == meta_request);
 
+    /* Only one request per part should ever get here, but a part that is requested more than once (a retry, or a
+     * hedge) must not take the process down if that ever slips. */
+    if (request->part_number < meta_request->synced_data.next_streaming_part) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Part %d was queued for streaming after it was already streamed.",
+            (void *)meta_request,
+            request->part_number);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    uint32_t offset = request->part_number - meta_request->synced_data.next_streaming_part;
+
+    if (offset >= meta_request->synced_data.pending_body_streaming_requests.capacity) {
+        s_s3_meta_request_body_streaming_grow_synced(meta_request, offset + 1);
+    }
+
+    struct aws_s3_request **slot = &meta_request->synced_data.pending_body_streaming_requests.requests
+                                        [(meta_request->synced_data.pending_body_streaming_requests.start + offset) &
+                                         (meta_request->synced_data.pending_body_streaming_requests.capacity - 1)];
+
+    if (*slot != NULL) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Part %d was queued for streaming while it already was.",
+            (void *)meta_request,
+            request->part_number);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
     aws_s3_request_acquire(request);
+    *slot = request;
+    ++meta_request->synced_data.pending_body_streaming_requests.size;
 
-    aws_priority_queue_push(&meta_request->synced_data.pending_body_streaming_requests, &request);
+    return AWS_OP_SUCCESS;
 }
 
 static struct aws_s3_request *s_s3_meta_request_body_streaming_pop_next_synced(
@@ -1071,22 +1781,23 @@ static struct aws_s3_request *s_s3_meta_request_body_streaming_pop_next_synced(
     AWS_PRECONDITION(meta_request);
     ASSERT_SYNCED_DATA_LOCK_HELD(meta_request);
 
-    struct aws_s3_request **top_request = NULL;
+    struct aws_s3_request **slot = &meta_request->synced_data.pending_body_streaming_requests
+                                        .requests[meta_request->synced_data.pending_body_streaming_requests.start];
 
-    aws_priority_queue_top(&meta_request->synced_data.pending_body_streaming_requests, (void **)&top_request);
+    struct aws_s3_request *request = *slot;
 
-    if (top_request == NULL) {
+    if (request == NULL) {
         return NULL;
     }
 
-    AWS_FATAL_ASSERT(*top_request);
+    /* Pushing checks that each slot holds the part it is for. */
+    AWS_ASSERT(request->part_number == meta_request->synced_data.next_streaming_part);
 
-    if ((*top_request)->part_number != meta_request->synced_data.next_streaming_part) {
-        return NULL;
-    }
-
-    struct aws_s3_request *request = NULL;
-    aws_priority_queue_pop(&meta_request->synced_data.pending_body_streaming_requests, (void **)&request);
+    *slot = NULL;
+    meta_request->synced_data.pending_body_streaming_requests.start =
+        (meta_request->synced_data.pending_body_streaming_requests.start + 1) &
+        (meta_request->synced_data.pending_body_streaming_requests.capacity - 1);
+    --meta_request->synced_data.pending_body_streaming_requests.size;
 
     ++meta_request->synced_data.next_streaming_part;
 
@@ -1120,15 +1831,18 @@ void aws_s3_meta_request_finish_default(struct aws_s3_meta_request *meta_request
 
     meta_request->synced_data.state = AWS_S3_META_REQUEST_STATE_FINISHED;
 
-    /* Clean out the pending-stream-to-caller priority queue*/
-    while (aws_priority_queue_size(&meta_request->synced_data.pending_body_streaming_requests) > 0) {
-        struct aws_s3_request *request = NULL;
-        aws_priority_queue_pop(&meta_request->synced_data.pending_body_streaming_requests, (void **)&request);
-        AWS_FATAL_ASSERT(request != NULL);
+    /* Clean out the requests pending streaming to the caller. */
+    for (uint32_t i = 0; i < meta_request->synced_data.pending_body_streaming_requests.capacity; ++i) {
+        struct aws_s3_request *request = meta_request->synced_data.pending_body_streaming_requests.requests[i];
 
-        aws_linked_list_push_back(&release_request_list, &request->node);
+        if (request != NULL) {
+            meta_request->synced_data.pending_body_streaming_requests.requests[i] = NULL;
+            aws_linked_list_push_back(&release_request_list, &request->node);
+        }
     }
 
+    meta_request->synced_data.pending_body_streaming_requests.size = 0;
+
     finish_result = meta_request->synced_data.finish_result;
     AWS_ZERO_STRUCT(meta_request->synced_data.finish_result);
 
@@ -1164,6 +1878,21 @@ unlock:
         finish_result.error_code,
         aws_error_str(finish_result.error_code));
 
+    /* Every request is done by now, so nothing reads the send buffers any longer. */
+    if (meta_request->send_buffers_release_callback != NULL) {
+        meta_request->send_buffers_release_callback(meta_request, meta_request->user_data);
+        meta_request->send_buffers_release_callback = NULL;
+    }
+
+    /* Every part has been written by now, so the file is complete unless the meta request failed. */
+    if (meta_request->recv_file != NULL) {
+        if (aws_s3_recv_file_close(meta_request->recv_file) && finish_result.error_code == AWS_ERROR_SUCCESS) {
+            finish_result.error_code = aws_last_error_or_unknown();
+        }
+
+        meta_request->recv_file = NULL;
+    }
+
     if (meta_request->finish_callback != NULL) {
         meta_request->finish_callback(meta_request, &finish_result, meta_request->user_data);
     }
@@ -1179,10 +1908,204 @@ unlock:
     meta_request->io_event_loop = NULL;
 }
 
-int aws_s3_meta_request_read_body(struct aws_s3_meta_request *meta_request, struct aws_byte_buf *buffer) {
+int aws_s3_meta_request_init_part_buffer(
+    struct aws_s3_meta_request *meta_request,
+    size_t capacity,
+    struct aws_byte_buf *out_buf) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(out_buf);
+
+    struct aws_s3_client *client = meta_request->client;
+    struct aws_s3_buffer_pool *buffer_pool =
+        client != NULL ? aws_s3_client_get_part_buffer_pool(client, meta_request) : NULL;
+
+    if (buffer_pool != NULL) {
+        return aws_s3_buffer_pool_acquire_buffer(buffer_pool, capacity, out_buf);
+    }
+
+    return aws_byte_buf_init(out_buf, meta_request->allocator, capacity);
+}
+
+bool aws_s3_meta_request_has_positional_body(const struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(meta_request);
+
+    return meta_request->send_filepath != NULL || meta_request->read_body_at_callback != NULL ||
+           aws_s3_meta_request_has_send_buffers(meta_request);
+}
+
+bool aws_s3_meta_request_has_send_buffers(const struct aws_s3_meta_request *meta_request) {
+    AWS_PRECONDITION(meta_request);
+
+    return aws_array_list_length(&meta_request->send_buffers) > 0;
+}
+
+int aws_s3_meta_request_get_send_buffer_segments(
+    const struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    uint64_t len,
+    struct aws_array_list *segments) {
+    AWS_PRECONDITION(meta_request);
+    AWS_PRECONDITION(segments);
+
+    const size_t num_buffers = aws_array_list_length(&meta_request->send_buffers);
+
+    /* Find the last buffer that starts at or before offset. */
+    size_t low = 0;
+    size_t high = num_buffers;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        struct aws_s3_send_buffer *send_buffer = NULL;
+        aws_array_list_get_at_ptr(&meta_request->send_buffers, (void **)&send_buffer, mid);
+
+        if (send_buffer->offset <= offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (size_t buffer_index = low > 0 ? low - 1 : 0; buffer_index < num_buffers && len > 0; ++buffer_index) {
+        struct aws_s3_send_buffer *send_buffer = NULL;
+        aws_array_list_get_at_ptr(&meta_request->send_buffers, (void **)&send_buffer, buffer_index);
+
+        uint64_t buffer_end = send_buffer->offset + send_buffer->data.len;
+
+        if (offset >= buffer_end) {
+            continue;
+        }
+
+        struct aws_byte_cursor segment = send_buffer->data;
+        aws_byte_cursor_advance(&segment, (size_t)(offset - send_buffer->offset));
+        segment.len = (size_t)aws_min_u64(segment.len, len);
+
+        if (aws_array_list_push_back(segments, &segment)) {
+            return AWS_OP_ERR;
+        }
+
+        offset += segment.len;
+        len -= segment.len;
+    }
+
+    if (len > 0) {
+        return aws_raise_error(AWS_ERROR_S3_INCORRECT_CONTENT_LENGTH);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Copy the send buffers at offset into buffer, up to its capacity. */
+static int s_s3_meta_request_read_send_buffers_at(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *buffer) {
+
+    struct aws_array_list segments;
+
+    if (aws_array_list_init_dynamic(&segments, meta_request->allocator, 4, sizeof(struct aws_byte_cursor))) {
+        return AWS_OP_ERR;
+    }
+
+    int result = aws_s3_meta_request_get_send_buffer_segments(
+        meta_request, offset, (uint64_t)(buffer->capacity - buffer->len), &segments);
+
+    for (size_t segment_index = 0; result == AWS_OP_SUCCESS && segment_index < aws_array_list_length(&segments);
+         ++segment_index) {
+        struct aws_byte_cursor segment;
+        aws_array_list_get_at(&segments, &segment, segment_index);
+        aws_byte_buf_write_from_whole_cursor(buffer, segment);
+    }
+
+    aws_array_list_clean_up(&segments);
+    return result;
+}
+
+/* Read the file being uploaded at offset, through a stream of its own, so that reads of different parts don't get in
+ * each other's way. */
+static int s_s3_meta_request_read_file_at(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *buffer) {
+
+    struct aws_input_stream *file_stream =
+        aws_input_stream_new_from_file(meta_request->allocator, aws_string_c_str(meta_request->send_filepath));
+
+    if (file_stream == NULL) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_META_REQUEST,
+            "id=%p Could not open file %s.",
+            (void *)meta_request,
+            aws_string_c_str(meta_request->send_filepath));
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+
+    if (offset > INT64_MAX || aws_input_stream_seek(file_stream, (int64_t)offset, AWS_SSB_BEGIN)) {
+        goto clean_up;
+    }
+
+    while (buffer->len < buffer->capacity) {
+        size_t prev_len = buffer->len;
+
+        if (aws_input_stream_read(file_stream, buffer)) {
+            goto clean_up;
+        }
+
+        if (buffer->len == prev_len) {
+            struct aws_stream_status status;
+            AWS_ZERO_STRUCT(status);
+
+            if (aws_input_stream_get_status(file_stream, &status)) {
+                goto clean_up;
+            }
+
+            if (status.is_end_of_stream) {
+                aws_raise_error(AWS_ERROR_S3_INCORRECT_CONTENT_LENGTH);
+                goto clean_up;
+            }
+        }
+    }
+
+    result = AWS_OP_SUCCESS;
+
+clean_up:
+
+    aws_input_stream_destroy(file_stream);
+    return result;
+}
+
+int aws_s3_meta_request_read_body(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *buffer) {
     AWS_PRECONDITION(meta_request);
     AWS_PRECONDITION(buffer);
 
+    if (aws_s3_meta_request_has_positional_body(meta_request)) {
+        int result = 0;
+
+        if (meta_request->send_filepath != NULL) {
+            result = s_s3_meta_request_read_file_at(meta_request, offset, buffer);
+        } else if (meta_request->read_body_at_callback != NULL) {
+            result = meta_request->read_body_at_callback(meta_request, offset, buffer, meta_request->user_data);
+        } else {
+            result = s_s3_meta_request_read_send_buffers_at(meta_request, offset, buffer);
+        }
+
+        if (result) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_META_REQUEST,
+                "id=%p Could not read body at offset %" PRIu64 " due to error %d (%s).",
+                (void *)meta_request,
+                offset,
+                aws_last_error_or_unknown(),
+                aws_error_str(aws_last_error_or_unknown()));
+        }
+
+        return result;
+    }
+
     struct aws_input_stream *initial_body_stream =
         aws_http_message_get_body_stream(meta_request->initial_request_message);
     AWS_FATAL_ASSERT(initial_body_stream);
@@ -0,0 +1,644 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_mock_transport.h"
+#include "aws/s3/private/s3_client_impl.h"
+#include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_request.h"
+#include "aws/s3/private/s3_util.h"
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/stream.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+/* Response bodies are passed on in chunks of about what a TLS record of a real connection carries. */
+static const size_t s_body_chunk_size = 16 * 1024;
+
+/* Request bodies are read, and dropped, this many bytes at a time. */
+#define S3_MOCK_TRANSPORT_READ_BUFFER_SIZE (16 * 1024)
+
+static const int s_range_not_satisfiable_status = 416;
+
+static const struct aws_byte_cursor s_mock_etag = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("\"mock-etag\"");
+static const struct aws_byte_cursor s_copy_source_header_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-copy-source");
+
+#define S3_MOCK_XML_DECLARATION "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+
+static const char *s_create_multipart_upload_result = S3_MOCK_XML_DECLARATION
+    "<InitiateMultipartUploadResult><Bucket>mock</Bucket><Key>mock</Key><UploadId>mock-upload-id</UploadId>"
+    "</InitiateMultipartUploadResult>";
+static const char *s_complete_multipart_upload_result = S3_MOCK_XML_DECLARATION
+    "<CompleteMultipartUploadResult><ETag>\"mock-etag\"</ETag></CompleteMultipartUploadResult>";
+static const char *s_copy_object_result = S3_MOCK_XML_DECLARATION
+    "<CopyObjectResult><ETag>\"mock-etag\"</ETag></CopyObjectResult>";
+static const char *s_copy_part_result = S3_MOCK_XML_DECLARATION
+    "<CopyPartResult><ETag>\"mock-etag\"</ETag></CopyPartResult>";
+static const char *s_list_objects_result = S3_MOCK_XML_DECLARATION
+    "<ListBucketResult><Name>mock</Name><IsTruncated>false</IsTruncated></ListBucketResult>";
+static const char *s_slow_down_error = S3_MOCK_XML_DECLARATION
+    "<Error><Code>SlowDown</Code><Message>Please reduce your request rate.</Message></Error>";
+static const char *s_internal_error = S3_MOCK_XML_DECLARATION
+    "<Error><Code>InternalError</Code><Message>We encountered an internal error. Please try again.</Message></Error>";
+static const char *s_invalid_range_error = S3_MOCK_XML_DECLARATION
+    "<Error><Code>InvalidRange</Code><Message>The requested range is not satisfiable</Message></Error>";
+static const char *s_method_not_allowed_error = S3_MOCK_XML_DECLARATION
+    "<Error><Code>MethodNotAllowed</Code><Message>The specified method is not allowed.</Message></Error>";
+
+/* get_host_address_count is only given the host resolver and the host name, so the count it reports can't be looked up
+ * from the transport. */
+static struct aws_atomic_var s_num_host_addresses = AWS_ATOMIC_INIT_INT(0);
+
+struct aws_s3_mock_transport {
+    struct aws_allocator *allocator;
+
+    /* Copy of the vtable of the client the transport is installed on, with the functions that the transport replaces.
+     * The transport is found from the client through it. */
+    struct aws_s3_client_vtable client_vtable;
+
+    const uint64_t latency_ns;
+    const uint64_t bytes_per_second;
+    const double slow_down_rate;
+    const double internal_error_rate;
+    const double truncation_rate;
+    const uint64_t object_size;
+    const uint32_t num_host_addresses;
+
+    /* Passed on, chunk after chunk, as the body of GETs. */
+    struct aws_byte_buf body_chunk;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* State of the xorshift generator that picks the requests that fail. */
+        uint64_t random_state;
+
+        /* Time at which the link is done with the bodies of the requests sent so far. */
+        uint64_t link_free_timestamp_ns;
+    } synced_data;
+
+    struct aws_atomic_var num_requests;
+    struct aws_atomic_var num_slow_downs;
+    struct aws_atomic_var num_internal_errors;
+    struct aws_atomic_var num_truncated_responses;
+    struct aws_atomic_var num_request_body_bytes;
+    struct aws_atomic_var num_response_body_bytes;
+};
+
+/* Response to the request of a connection, served by a task once the latency and the link allow. */
+struct s3_mock_response {
+    struct aws_task task;
+    struct aws_s3_mock_transport *transport;
+    struct aws_s3_connection *connection;
+
+    int response_status;
+
+    /* Body of an XML response, if any. */
+    const char *xml_body;
+
+    /* Bytes of the object returned by a GET or a HEAD. range_end is inclusive. */
+    uint64_t range_start;
+    uint64_t range_end;
+    uint64_t num_object_bytes;
+    bool is_get;
+    bool is_head;
+    bool is_ranged;
+    bool is_put;
+
+    /* The connection drops half way through the body. */
+    bool is_truncated;
+};
+
+struct aws_s3_mock_transport *aws_s3_mock_transport_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_mock_transport_options *options) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(options);
+
+    if (options->slow_down_rate < 0.0 || options->internal_error_rate < 0.0 ||
+        options->slow_down_rate + options->internal_error_rate > 1.0 || options->truncation_rate < 0.0 ||
+        options->truncation_rate > 1.0) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_CLIENT,
+            "Could not create mock transport; error rates have to add up to at most 1, and the truncation rate can't "
+            "be more than 1.");
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_s3_mock_transport *transport = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_mock_transport));
+    transport->allocator = allocator;
+
+    *((uint64_t *)&transport->latency_ns) = options->latency_ns;
+    *((uint64_t *)&transport->bytes_per_second) = options->bytes_per_second;
+    *((double *)&transport->slow_down_rate) = options->slow_down_rate;
+    *((double *)&transport->internal_error_rate) = options->internal_error_rate;
+    *((double *)&transport->truncation_rate) = options->truncation_rate;
+    *((uint64_t *)&transport->object_size) = options->object_size;
+    *((uint32_t *)&transport->num_host_addresses) = options->num_host_addresses;
+
+    aws_byte_buf_init(&transport->body_chunk, allocator, s_body_chunk_size);
+    memset(transport->body_chunk.buffer, 'm', s_body_chunk_size);
+    transport->body_chunk.len = s_body_chunk_size;
+
+    aws_mutex_init(&transport->synced_data.lock);
+
+    /* xorshift never leaves 0. */
+    transport->synced_data.random_state = options->seed != 0 ? options->seed : 0x9E3779B97F4A7C15ULL;
+
+    aws_atomic_init_int(&transport->num_requests, 0);
+    aws_atomic_init_int(&transport->num_slow_downs, 0);
+    aws_atomic_init_int(&transport->num_internal_errors, 0);
+    aws_atomic_init_int(&transport->num_truncated_responses, 0);
+    aws_atomic_init_int(&transport->num_request_body_bytes, 0);
+    aws_atomic_init_int(&transport->num_response_body_bytes, 0);
+
+    return transport;
+}
+
+void aws_s3_mock_transport_destroy(struct aws_s3_mock_transport *transport) {
+    if (transport == NULL) {
+        return;
+    }
+
+    aws_mutex_clean_up(&transport->synced_data.lock);
+    aws_byte_buf_clean_up(&transport->body_chunk);
+    aws_mem_release(transport->allocator, transport);
+}
+
+void aws_s3_mock_transport_get_stats(
+    struct aws_s3_mock_transport *transport,
+    struct aws_s3_mock_transport_stats *out_stats) {
+    AWS_PRECONDITION(transport);
+    AWS_PRECONDITION(out_stats);
+
+    out_stats->num_requests = aws_atomic_load_int(&transport->num_requests);
+    out_stats->num_slow_downs = aws_atomic_load_int(&transport->num_slow_downs);
+    out_stats->num_internal_errors = aws_atomic_load_int(&transport->num_internal_errors);
+    out_stats->num_truncated_responses = aws_atomic_load_int(&transport->num_truncated_responses);
+    out_stats->num_request_body_bytes = aws_atomic_load_int(&transport->num_request_body_bytes);
+    out_stats->num_response_body_bytes = aws_atomic_load_int(&transport->num_response_body_bytes);
+}
+
+/* Returns a number between 0 (included) and 1 (excluded). */
+static double s_s3_mock_transport_random_synced(struct aws_s3_mock_transport *transport) {
+    uint64_t x = transport->synced_data.random_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    transport->synced_data.random_state = x;
+
+    return (double)(x >> 11) / (double)(1ULL << 53);
+}
+
+/* Returns true if the query string has the given parameter, with or without a value. */
+static bool s_s3_mock_query_has_param(struct aws_byte_cursor query, const char *name) {
+    struct aws_byte_cursor param;
+    AWS_ZERO_STRUCT(param);
+
+    while (aws_byte_cursor_next_split(&query, '&', &param)) {
+        struct aws_byte_cursor param_name = param;
+
+        for (size_t i = 0; i < param.len; ++i) {
+            if (param.ptr[i] == '=') {
+                param_name.len = i;
+                break;
+            }
+        }
+
+        if (aws_byte_cursor_eq_c_str(&param_name, name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Parse a Range header against the size of the object. Returns false if the range can't be satisfied. A header that
+ * can't be parsed is ignored, as S3 does, leaving out_is_ranged false. */
+static bool s_s3_mock_parse_range(
+    struct aws_byte_cursor range,
+    uint64_t object_size,
+    bool *out_is_ranged,
+    uint64_t *out_range_start,
+    uint64_t *out_range_end) {
+
+    struct aws_byte_cursor prefix = aws_byte_cursor_from_c_str("bytes=");
+    *out_is_ranged = false;
+
+    if (!aws_byte_cursor_starts_with(&range, &prefix)) {
+        return true;
+    }
+
+    aws_byte_cursor_advance(&range, prefix.len);
+
+    struct aws_byte_cursor first = range;
+    struct aws_byte_cursor last;
+    AWS_ZERO_STRUCT(last);
+
+    size_t separator = 0;
+    while (separator < range.len && range.ptr[separator] != '-') {
+        ++separator;
+    }
+
+    if (separator == range.len) {
+        return true;
+    }
+
+    first.len = separator;
+    last = range;
+    aws_byte_cursor_advance(&last, separator + 1);
+
+    uint64_t first_value = 0;
+    uint64_t last_value = 0;
+
+    if ((first.len > 0 && aws_byte_cursor_utf8_parse_u64(first, &first_value)) ||
+        (last.len > 0 && aws_byte_cursor_utf8_parse_u64(last, &last_value)) || (first.len == 0 && last.len == 0)) {
+        return true;
+    }
+
+    *out_is_ranged = true;
+
+    if (first.len == 0) {
+        /* Suffix range, of the last bytes of the object. */
+        if (last_value == 0 || object_size == 0) {
+            return false;
+        }
+
+        *out_range_start = object_size > last_value ? object_size - last_value : 0;
+        *out_range_end = object_size - 1;
+        return true;
+    }
+
+    if (first_value >= object_size || (last.len > 0 && last_value < first_value)) {
+        return false;
+    }
+
+    *out_range_start = first_value;
+    *out_range_end = last.len > 0 ? aws_min_u64(last_value, object_size - 1) : object_size - 1;
+    return true;
+}
+
+/* Work out what S3 would answer to the request, from its method, its query and its headers. */
+static void s_s3_mock_response_init(struct s3_mock_response *response, struct aws_http_message *message) {
+    struct aws_s3_mock_transport *transport = response->transport;
+
+    struct aws_byte_cursor method;
+    struct aws_byte_cursor path;
+    AWS_ZERO_STRUCT(method);
+    AWS_ZERO_STRUCT(path);
+    aws_http_message_get_request_method(message, &method);
+    aws_http_message_get_request_path(message, &path);
+
+    struct aws_byte_cursor query;
+    AWS_ZERO_STRUCT(query);
+
+    for (size_t i = 0; i < path.len; ++i) {
+        if (path.ptr[i] == '?') {
+            query = path;
+            aws_byte_cursor_advance(&query, i + 1);
+            break;
+        }
+    }
+
+    struct aws_http_headers *headers = aws_http_message_get_headers(message);
+    const bool has_copy_source = aws_http_headers_has(headers, s_copy_source_header_name);
+
+    response->response_status = AWS_S3_RESPONSE_STATUS_SUCCESS;
+
+    if (aws_byte_cursor_eq(&method, &g_head_method)) {
+        response->is_head = true;
+        response->num_object_bytes = transport->object_size;
+
+    } else if (aws_byte_cursor_eq(&method, &aws_http_method_get)) {
+        if (s_s3_mock_query_has_param(query, "list-type")) {
+            response->xml_body = s_list_objects_result;
+            return;
+        }
+
+        response->is_get = true;
+
+        struct aws_byte_cursor range;
+        AWS_ZERO_STRUCT(range);
+
+        if (aws_http_headers_get(headers, g_range_header_name, &range) == AWS_OP_SUCCESS &&
+            !s_s3_mock_parse_range(
+                range,
+                transport->object_size,
+                &response->is_ranged,
+                &response->range_start,
+                &response->range_end)) {
+            response->is_get = false;
+            response->response_status = s_range_not_satisfiable_status;
+            response->xml_body = s_invalid_range_error;
+            return;
+        }
+
+        if (response->is_ranged) {
+            response->response_status = AWS_S3_RESPONSE_STATUS_RANGE_SUCCESS;
+            response->num_object_bytes = response->range_end - response->range_start + 1;
+        } else {
+            response->num_object_bytes = transport->object_size;
+        }
+
+    } else if (aws_byte_cursor_eq(&method, &g_post_method)) {
+        if (s_s3_mock_query_has_param(query, "uploads")) {
+            response->xml_body = s_create_multipart_upload_result;
+        } else {
+            response->xml_body = s_complete_multipart_upload_result;
+        }
+
+    } else if (aws_byte_cursor_eq(&method, &aws_http_method_put)) {
+        if (has_copy_source) {
+            response->xml_body = s_s3_mock_query_has_param(query, "partNumber") ? s_copy_part_result
+                                                                                 : s_copy_object_result;
+        } else {
+            response->is_put = true;
+        }
+
+    } else if (aws_byte_cursor_eq(&method, &g_delete_method)) {
+        response->response_status = AWS_S3_RESPONSE_STATUS_NO_CONTENT_SUCCESS;
+
+    } else {
+        response->response_status = 405;
+        response->xml_body = s_method_not_allowed_error;
+    }
+}
+
+/* Read the whole body of the request, as an HTTP connection would to send it, and drop it. */
+static int s_s3_mock_read_request_body(struct aws_http_message *message, uint64_t *out_num_bytes) {
+    *out_num_bytes = 0;
+
+    struct aws_input_stream *body_stream = aws_http_message_get_body_stream(message);
+
+    if (body_stream == NULL) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint8_t read_buffer[S3_MOCK_TRANSPORT_READ_BUFFER_SIZE];
+
+    while (true) {
+        struct aws_stream_status status;
+        AWS_ZERO_STRUCT(status);
+
+        if (aws_input_stream_get_status(body_stream, &status)) {
+            return AWS_OP_ERR;
+        }
+
+        if (status.is_end_of_stream) {
+            return AWS_OP_SUCCESS;
+        }
+
+        struct aws_byte_buf dest = aws_byte_buf_from_empty_array(read_buffer, sizeof(read_buffer));
+
+        if (aws_input_stream_read(body_stream, &dest)) {
+            return AWS_OP_ERR;
+        }
+
+        *out_num_bytes += dest.len;
+    }
+}
+
+static void s_s3_mock_response_task(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+    (void)task;
+
+    struct s3_mock_response *response = arg;
+    struct aws_s3_mock_transport *transport = response->transport;
+    struct aws_s3_connection *connection = response->connection;
+    struct aws_s3_request *request = connection->request;
+    struct aws_s3_client *client = request->meta_request->client;
+
+    int error_code = AWS_ERROR_SUCCESS;
+    uint64_t num_response_body_bytes = 0;
+
+    if (task_status != AWS_TASK_STATUS_RUN_READY) {
+        error_code = AWS_ERROR_S3_CANCELED;
+        goto finish;
+    }
+
+    uint64_t num_request_body_bytes = 0;
+
+    if (s_s3_mock_read_request_body(request->send_data.message, &num_request_body_bytes)) {
+        error_code = aws_last_error_or_unknown();
+        goto finish;
+    }
+
+    aws_atomic_fetch_add(&transport->num_request_body_bytes, (size_t)num_request_body_bytes);
+
+    char content_length[32];
+    char content_range[96];
+    struct aws_http_header headers[4];
+    size_t num_headers = 0;
+
+    uint64_t body_size = response->xml_body != NULL ? strlen(response->xml_body) : 0;
+
+    if (response->is_get || response->is_head) {
+        body_size = response->num_object_bytes;
+    }
+
+    snprintf(content_length, sizeof(content_length), "%" PRIu64, body_size);
+    headers[num_headers++] = (struct aws_http_header){
+        .name = g_content_length_header_name,
+        .value = aws_byte_cursor_from_c_str(content_length),
+    };
+
+    if (response->is_get || response->is_head || response->is_put) {
+        headers[num_headers++] = (struct aws_http_header){
+            .name = g_etag_header_name,
+            .value = s_mock_etag,
+        };
+    }
+
+    if (response->is_ranged) {
+        snprintf(
+            content_range,
+            sizeof(content_range),
+            "bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64,
+            response->range_start,
+            response->range_end,
+            transport->object_size);
+
+        headers[num_headers++] = (struct aws_http_header){
+            .name = g_content_range_header_name,
+            .value = aws_byte_cursor_from_c_str(content_range),
+        };
+    }
+
+    if (aws_s3_meta_request_on_response_headers(
+            connection, response->response_status, AWS_HTTP_HEADER_BLOCK_MAIN, headers, num_headers)) {
+        error_code = aws_last_error_or_unknown();
+        goto finish;
+    }
+
+    if (response->is_get) {
+        uint64_t num_bytes_left = response->num_object_bytes;
+
+        if (response->is_truncated) {
+            num_bytes_left /= 2;
+        }
+
+        while (num_bytes_left > 0) {
+            struct aws_byte_cursor chunk = aws_byte_cursor_from_buf(&transport->body_chunk);
+            chunk.len = (size_t)aws_min_u64(chunk.len, num_bytes_left);
+
+            if (aws_s3_meta_request_on_response_body(connection, &chunk)) {
+                error_code = aws_last_error_or_unknown();
+                goto finish;
+            }
+
+            num_bytes_left -= chunk.len;
+            num_response_body_bytes += chunk.len;
+        }
+
+        if (response->is_truncated) {
+            error_code = AWS_ERROR_HTTP_CONNECTION_CLOSED;
+            goto finish;
+        }
+    } else if (response->xml_body != NULL) {
+        struct aws_byte_cursor body = aws_byte_cursor_from_c_str(response->xml_body);
+
+        if (aws_s3_meta_request_on_response_body(connection, &body)) {
+            error_code = aws_last_error_or_unknown();
+            goto finish;
+        }
+
+        num_response_body_bytes += body.len;
+    }
+
+finish:
+
+    aws_atomic_fetch_add(&transport->num_response_body_bytes, (size_t)num_response_body_bytes);
+    aws_mem_release(transport->allocator, response);
+
+    aws_s3_meta_request_on_response_complete(connection, error_code);
+    aws_s3_client_release(client); /* kept since the HTTP connection was asked for */
+}
+
+/* Stands in for aws_http_connection_manager_acquire_connection. Instead of handing a connection back, the request of
+ * the connection (the user data, as passed by the client) gets its response once the latency and the link allow. */
+static void s_s3_mock_transport_acquire_http_connection(
+    struct aws_http_connection_manager *conn_manager,
+    aws_http_connection_manager_on_connection_setup_fn *on_connection_acquired_callback,
+    void *user_data) {
+    (void)conn_manager;
+    (void)on_connection_acquired_callback;
+
+    struct aws_s3_connection *connection = user_data;
+    AWS_PRECONDITION(connection);
+
+    struct aws_s3_request *request = connection->request;
+    AWS_PRECONDITION(request);
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+    struct aws_s3_client *client = meta_request->client;
+    struct aws_s3_mock_transport *transport =
+        AWS_CONTAINER_OF(client->vtable, struct aws_s3_mock_transport, client_vtable);
+
+    struct s3_mock_response *response = aws_mem_calloc(transport->allocator, 1, sizeof(struct s3_mock_response));
+    response->transport = transport;
+    response->connection = connection;
+
+    aws_atomic_fetch_add(&transport->num_requests, 1);
+
+    aws_high_res_clock_get_ticks(&request->metrics.connection_acquire_end_timestamp_ns);
+    request->metrics.send_start_timestamp_ns = request->metrics.connection_acquire_end_timestamp_ns;
+    request->metrics.first_byte_timestamp_ns = 0;
+    aws_s3_meta_request_on_request_sent(meta_request, request);
+
+    struct aws_event_loop_group *event_loop_group = meta_request->cpu_group != NULL
+                                                        ? meta_request->cpu_group->event_loop_group
+                                                        : client->client_bootstrap->event_loop_group;
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_next_loop(event_loop_group);
+
+    uint64_t now_ns = 0;
+    aws_event_loop_current_clock_time(event_loop, &now_ns);
+
+    aws_mutex_lock(&transport->synced_data.lock);
+
+    const double random_value = s_s3_mock_transport_random_synced(transport);
+
+    if (random_value < transport->slow_down_rate) {
+        response->response_status = AWS_S3_RESPONSE_STATUS_SLOW_DOWN;
+        response->xml_body = s_slow_down_error;
+    } else if (random_value < transport->slow_down_rate + transport->internal_error_rate) {
+        response->response_status = AWS_S3_RESPONSE_STATUS_INTERNAL_ERROR;
+        response->xml_body = s_internal_error;
+    } else {
+        s_s3_mock_response_init(response, request->send_data.message);
+
+        response->is_truncated = response->is_get && response->num_object_bytes > 1 &&
+                                 s_s3_mock_transport_random_synced(transport) < transport->truncation_rate;
+    }
+
+    /* The bodies of a request go over the link one after the other, once the latency has passed. */
+    uint64_t run_at_ns = now_ns + transport->latency_ns;
+
+    if (transport->bytes_per_second > 0) {
+        uint64_t num_bytes = aws_s3_request_get_body_size(request) + response->num_object_bytes;
+        uint64_t transfer_ns = aws_mul_u64_saturating(num_bytes, AWS_TIMESTAMP_NANOS) / transport->bytes_per_second;
+
+        run_at_ns = aws_max_u64(run_at_ns, transport->synced_data.link_free_timestamp_ns);
+        run_at_ns = aws_add_u64_saturating(run_at_ns, transfer_ns);
+        transport->synced_data.link_free_timestamp_ns = run_at_ns;
+    }
+
+    aws_mutex_unlock(&transport->synced_data.lock);
+
+    if (response->response_status == AWS_S3_RESPONSE_STATUS_SLOW_DOWN) {
+        aws_atomic_fetch_add(&transport->num_slow_downs, 1);
+    } else if (response->response_status == AWS_S3_RESPONSE_STATUS_INTERNAL_ERROR) {
+        aws_atomic_fetch_add(&transport->num_internal_errors, 1);
+    } else if (response->is_truncated) {
+        aws_atomic_fetch_add(&transport->num_truncated_responses, 1);
+    }
+
+    aws_task_init(&response->task, s_s3_mock_response_task, response, "s3_mock_transport_response");
+
+    if (run_at_ns > now_ns) {
+        aws_event_loop_schedule_task_future(event_loop, &response->task, run_at_ns);
+    } else {
+        aws_event_loop_schedule_task_now(event_loop, &response->task);
+    }
+}
+
+static size_t s_s3_mock_transport_get_host_address_count(
+    struct aws_host_resolver *host_resolver,
+    const struct aws_string *host_name,
+    uint32_t flags) {
+    (void)host_resolver;
+    (void)host_name;
+    (void)flags;
+
+    return aws_atomic_load_int(&s_num_host_addresses);
+}
+
+void aws_s3_mock_transport_install(struct aws_s3_mock_transport *transport, struct aws_s3_client *client) {
+    AWS_PRECONDITION(transport);
+    AWS_PRECONDITION(client);
+    AWS_PRECONDITION(client->vtable);
+
+    transport->client_vtable = *client->vtable;
+    transport->client_vtable.acquire_http_connection = s_s3_mock_transport_acquire_http_connection;
+    transport->client_vtable.get_host_address_count = s_s3_mock_transport_get_host_address_count;
+    client->vtable = &transport->client_vtable;
+
+    aws_atomic_store_int(&s_num_host_addresses, transport->num_host_addresses);
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_CLIENT,
+        "id=%p Client requests are served by mock transport %p, with %" PRIu64 "ns of latency and %" PRIu64
+        " bytes per second of bandwidth.",
+        (void *)client,
+        (void *)transport,
+        transport->latency_ns,
+        transport->bytes_per_second);
+}
@@ -0,0 +1,374 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/private/s3_parallel_list_objects.h>
+#include <aws/s3/private/s3_util.h>
+
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
+#include <aws/common/ref_count.h>
+
+static const uint32_t s_default_max_concurrent_listings = 16;
+
+struct aws_s3_parallel_list_objects {
+    struct aws_allocator *allocator;
+    struct aws_s3_client *client;
+    struct aws_string *bucket_name;
+    struct aws_string *endpoint;
+    struct aws_string *prefix;
+    struct aws_string *delimiter;
+    struct aws_cached_signing_config_aws *cached_signing_config;
+    uint32_t max_concurrent_listings;
+    aws_s3_on_object_fn *on_object;
+    aws_s3_on_parallel_list_finished_fn *on_list_finished;
+    void *user_data;
+
+    struct aws_ref_count ref_count;
+
+    /* Held while on_object runs, so that invocations never overlap. */
+    struct aws_mutex callback_lock;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Ranges (struct s3_list_range) waiting for a listing slot. */
+        struct aws_linked_list pending_ranges;
+
+        /* Number of ranges being listed. */
+        uint32_t num_active_ranges;
+
+        /* First error any range ran into. No new range is started after it. */
+        int error_code;
+
+        /* on_object returned false. */
+        bool stopped;
+
+        bool finished;
+    } synced_data;
+};
+
+/* A part of the key space, listed by a paginator of its own. */
+struct s3_list_range {
+    struct aws_linked_list_node node;
+    struct aws_s3_parallel_list_objects *list;
+    struct aws_s3_paginator *paginator;
+
+    /* NULL for the prefix of the whole listing. */
+    struct aws_string *prefix;
+
+    /* NULL to start with the first key. */
+    struct aws_string *start_after;
+
+    /* Last key of the range. NULL for a range that goes to the end. */
+    struct aws_string *end_key;
+
+    /* The range is listed with the delimiter, and every common prefix found in it becomes a range of its own. */
+    bool discover_prefixes;
+
+    /* A key after end_key has been listed, meaning the rest of the range's pages belong to the next range. Only used
+     * from the callbacks of the range's paginator, which never overlap. */
+    bool past_end_key;
+};
+
+static void s_s3_parallel_list_start_ranges(struct aws_s3_parallel_list_objects *list);
+
+static struct aws_string *s_string_new_or_null(struct aws_allocator *allocator, const struct aws_byte_cursor *cursor) {
+    return (cursor != NULL && cursor->len > 0) ? aws_string_new_from_cursor(allocator, cursor) : NULL;
+}
+
+static struct s3_list_range *s_s3_list_range_new(
+    struct aws_s3_parallel_list_objects *list,
+    const struct aws_byte_cursor *prefix,
+    const struct aws_byte_cursor *start_after,
+    const struct aws_byte_cursor *end_key,
+    bool discover_prefixes) {
+
+    struct s3_list_range *range = aws_mem_calloc(list->allocator, 1, sizeof(struct s3_list_range));
+    range->list = list;
+    range->prefix = s_string_new_or_null(list->allocator, prefix);
+    range->start_after = s_string_new_or_null(list->allocator, start_after);
+    range->end_key = s_string_new_or_null(list->allocator, end_key);
+    range->discover_prefixes = discover_prefixes;
+
+    return range;
+}
+
+static void s_s3_list_range_destroy(struct s3_list_range *range) {
+    if (range == NULL) {
+        return;
+    }
+
+    aws_s3_paginator_release(range->paginator);
+    aws_string_destroy(range->prefix);
+    aws_string_destroy(range->start_after);
+    aws_string_destroy(range->end_key);
+    aws_mem_release(range->list->allocator, range);
+}
+
+static void s_s3_parallel_list_ref_count_zero_callback(void *arg) {
+    struct aws_s3_parallel_list_objects *list = arg;
+
+    while (!aws_linked_list_empty(&list->synced_data.pending_ranges)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&list->synced_data.pending_ranges);
+        s_s3_list_range_destroy(AWS_CONTAINER_OF(node, struct s3_list_range, node));
+    }
+
+    aws_cached_signing_config_destroy(list->cached_signing_config);
+    aws_string_destroy(list->bucket_name);
+    aws_string_destroy(list->endpoint);
+    aws_string_destroy(list->prefix);
+    aws_string_destroy(list->delimiter);
+    aws_mutex_clean_up(&list->callback_lock);
+    aws_mutex_clean_up(&list->synced_data.lock);
+    aws_s3_client_release(list->client);
+    aws_mem_release(list->allocator, list);
+}
+
+void aws_s3_parallel_list_objects_acquire(struct aws_s3_parallel_list_objects *list) {
+    AWS_FATAL_PRECONDITION(list);
+    aws_ref_count_acquire(&list->ref_count);
+}
+
+void aws_s3_parallel_list_objects_release(struct aws_s3_parallel_list_objects *list) {
+    if (list) {
+        aws_ref_count_release(&list->ref_count);
+    }
+}
+
+static bool s_s3_parallel_list_is_stopped(struct aws_s3_parallel_list_objects *list) {
+    aws_mutex_lock(&list->synced_data.lock);
+    bool stopped = list->synced_data.stopped || list->synced_data.error_code != AWS_ERROR_SUCCESS;
+    aws_mutex_unlock(&list->synced_data.lock);
+
+    return stopped;
+}
+
+static bool s_s3_list_range_on_object(const struct aws_s3_object_info *info, void *user_data) {
+    struct s3_list_range *range = user_data;
+    struct aws_s3_parallel_list_objects *list = range->list;
+
+    /* A common prefix found while discovering is listed in full as a range of its own. */
+    if (range->discover_prefixes && info->key.len == 0) {
+        if (info->prefix.len > 0) {
+            struct s3_list_range *prefix_range = s_s3_list_range_new(list, &info->prefix, NULL, NULL, false);
+
+            aws_mutex_lock(&list->synced_data.lock);
+            aws_linked_list_push_back(&list->synced_data.pending_ranges, &prefix_range->node);
+            aws_mutex_unlock(&list->synced_data.lock);
+
+            s_s3_parallel_list_start_ranges(list);
+        }
+
+        return true;
+    }
+
+    if (range->end_key != NULL) {
+        struct aws_byte_cursor end_key = aws_byte_cursor_from_string(range->end_key);
+
+        if (range->past_end_key || aws_byte_cursor_compare_lexical(&info->key, &end_key) > 0) {
+            range->past_end_key = true;
+            return true;
+        }
+    }
+
+    bool keep_going = true;
+
+    aws_mutex_lock(&list->callback_lock);
+
+    if (!s_s3_parallel_list_is_stopped(list) && list->on_object != NULL) {
+        keep_going = list->on_object(info, list->user_data);
+    }
+
+    aws_mutex_unlock(&list->callback_lock);
+
+    if (!keep_going) {
+        aws_mutex_lock(&list->synced_data.lock);
+        list->synced_data.stopped = true;
+        aws_mutex_unlock(&list->synced_data.lock);
+    }
+
+    return keep_going;
+}
+
+static void s_s3_list_range_finished(struct s3_list_range *range, int error_code) {
+    struct aws_s3_parallel_list_objects *list = range->list;
+
+    aws_mutex_lock(&list->synced_data.lock);
+
+    if (list->synced_data.error_code == AWS_ERROR_SUCCESS) {
+        list->synced_data.error_code = error_code;
+    }
+
+    AWS_ASSERT(list->synced_data.num_active_ranges > 0);
+    --list->synced_data.num_active_ranges;
+    aws_mutex_unlock(&list->synced_data.lock);
+
+    s_s3_list_range_destroy(range);
+    s_s3_parallel_list_start_ranges(list);
+}
+
+static void s_s3_list_range_on_page_finished(struct aws_s3_paginator *paginator, int error_code, void *user_data) {
+    struct s3_list_range *range = user_data;
+    struct aws_s3_parallel_list_objects *list = range->list;
+
+    if (error_code == AWS_ERROR_SUCCESS && aws_s3_paginator_has_more_results(paginator) && !range->past_end_key &&
+        !s_s3_parallel_list_is_stopped(list)) {
+
+        if (aws_s3_paginator_continue(paginator, &list->cached_signing_config->config) == AWS_OP_SUCCESS) {
+            return;
+        }
+
+        error_code = aws_last_error_or_unknown();
+    }
+
+    s_s3_list_range_finished(range, error_code);
+}
+
+static int s_s3_list_range_start(struct s3_list_range *range) {
+    struct aws_s3_parallel_list_objects *list = range->list;
+
+    struct aws_s3_list_objects_params params = {
+        .client = list->client,
+        .bucket_name = aws_byte_cursor_from_string(list->bucket_name),
+        .endpoint = aws_byte_cursor_from_string(list->endpoint),
+        .on_object = s_s3_list_range_on_object,
+        .on_list_finished = s_s3_list_range_on_page_finished,
+        .user_data = range,
+    };
+
+    if (range->prefix != NULL) {
+        params.prefix = aws_byte_cursor_from_string(range->prefix);
+    } else if (list->prefix != NULL) {
+        params.prefix = aws_byte_cursor_from_string(list->prefix);
+    }
+
+    if (range->start_after != NULL) {
+        params.start_after = aws_byte_cursor_from_string(range->start_after);
+    }
+
+    if (range->discover_prefixes) {
+        params.delimiter = aws_byte_cursor_from_string(list->delimiter);
+    }
+
+    range->paginator = aws_s3_initiate_list_objects(list->allocator, &params);
+
+    return aws_s3_paginator_continue(range->paginator, &list->cached_signing_config->config);
+}
+
+/* Start pending ranges until there are as many running as allowed, and finish the listing once nothing is running and
+ * nothing more will be started. */
+static void s_s3_parallel_list_start_ranges(struct aws_s3_parallel_list_objects *list) {
+    while (true) {
+        struct s3_list_range *range = NULL;
+        bool finish = false;
+        int error_code = AWS_ERROR_SUCCESS;
+
+        aws_mutex_lock(&list->synced_data.lock);
+
+        bool can_start = !list->synced_data.stopped && list->synced_data.error_code == AWS_ERROR_SUCCESS &&
+                         list->synced_data.num_active_ranges < list->max_concurrent_listings;
+
+        if (can_start && !aws_linked_list_empty(&list->synced_data.pending_ranges)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&list->synced_data.pending_ranges);
+            range = AWS_CONTAINER_OF(node, struct s3_list_range, node);
+            ++list->synced_data.num_active_ranges;
+        } else if (list->synced_data.num_active_ranges == 0 && !list->synced_data.finished) {
+            list->synced_data.finished = true;
+            finish = true;
+            error_code = list->synced_data.error_code;
+        }
+
+        aws_mutex_unlock(&list->synced_data.lock);
+
+        if (range != NULL) {
+            if (s_s3_list_range_start(range)) {
+                error_code = aws_last_error_or_unknown();
+
+                aws_mutex_lock(&list->synced_data.lock);
+                if (list->synced_data.error_code == AWS_ERROR_SUCCESS) {
+                    list->synced_data.error_code = error_code;
+                }
+                --list->synced_data.num_active_ranges;
+                aws_mutex_unlock(&list->synced_data.lock);
+
+                s_s3_list_range_destroy(range);
+            }
+
+            continue;
+        }
+
+        if (finish) {
+            if (list->on_list_finished) {
+                list->on_list_finished(list, error_code, list->user_data);
+            }
+
+            /* Release the reference that kept the listing alive while it was running. */
+            aws_s3_parallel_list_objects_release(list);
+        }
+
+        return;
+    }
+}
+
+struct aws_s3_parallel_list_objects *aws_s3_initiate_parallel_list_objects(
+    struct aws_allocator *allocator,
+    const struct aws_s3_parallel_list_objects_params *params) {
+    AWS_FATAL_PRECONDITION(params);
+    AWS_FATAL_PRECONDITION(params->client);
+    AWS_FATAL_PRECONDITION(params->bucket_name.len);
+    AWS_FATAL_PRECONDITION(params->endpoint.len);
+    AWS_FATAL_PRECONDITION(params->signing_config);
+
+    for (size_t i = 1; i < params->num_split_points; ++i) {
+        if (aws_byte_cursor_compare_lexical(&params->split_points[i - 1], &params->split_points[i]) >= 0) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_GENERAL,
+                "Could not start parallel listing; split points have to be in ascending order without duplicates.");
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            return NULL;
+        }
+    }
+
+    struct aws_s3_parallel_list_objects *list =
+        aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_parallel_list_objects));
+    list->allocator = allocator;
+    list->client = params->client;
+    aws_s3_client_acquire(params->client);
+    list->bucket_name = aws_string_new_from_cursor(allocator, &params->bucket_name);
+    list->endpoint = aws_string_new_from_cursor(allocator, &params->endpoint);
+    list->prefix = s_string_new_or_null(allocator, &params->prefix);
+    list->delimiter = s_string_new_or_null(allocator, &params->delimiter);
+    list->cached_signing_config = aws_cached_signing_config_new(allocator, params->signing_config);
+    list->max_concurrent_listings =
+        params->max_concurrent_listings > 0 ? params->max_concurrent_listings : s_default_max_concurrent_listings;
+    list->on_object = params->on_object;
+    list->on_list_finished = params->on_list_finished;
+    list->user_data = params->user_data;
+
+    /* One reference for the caller, and one for the listing while it runs. */
+    aws_ref_count_init(&list->ref_count, list, s_s3_parallel_list_ref_count_zero_callback);
+    aws_ref_count_acquire(&list->ref_count);
+
+    aws_mutex_init(&list->callback_lock);
+    aws_mutex_init(&list->synced_data.lock);
+    aws_linked_list_init(&list->synced_data.pending_ranges);
+
+    if (params->num_split_points > 0) {
+        for (size_t i = 0; i <= params->num_split_points; ++i) {
+            const struct aws_byte_cursor *start_after = i > 0 ? &params->split_points[i - 1] : NULL;
+            const struct aws_byte_cursor *end_key = i < params->num_split_points ? &params->split_points[i] : NULL;
+
+            struct s3_list_range *range = s_s3_list_range_new(list, NULL, start_after, end_key, false);
+            aws_linked_list_push_back(&list->synced_data.pending_ranges, &range->node);
+        }
+    } else {
+        struct s3_list_range *range = s_s3_list_range_new(list, NULL, NULL, NULL, list->delimiter != NULL);
+        aws_linked_list_push_back(&list->synced_data.pending_ranges, &range->node);
+    }
+
+    s_s3_parallel_list_start_ranges(list);
+
+    return list;
+}
@@ -0,0 +1,403 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+/* For O_DIRECT. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include "aws/s3/private/s3_buffer_pool.h"
+#include "aws/s3/private/s3_recv_file.h"
+
+#include <aws/common/logging.h>
+#include <aws/common/string.h>
+
+#include <inttypes.h>
+
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+struct aws_s3_recv_file {
+    struct aws_allocator *allocator;
+    struct aws_string *path;
+
+    const bool preallocate;
+
+#ifdef _WIN32
+    HANDLE handle;
+
+    /* Opened without buffering, or INVALID_HANDLE_VALUE if direct I/O isn't used. */
+    HANDLE direct_handle;
+#else
+    int fd;
+
+    /* Opened for direct I/O, or -1 if direct I/O isn't used. */
+    int direct_fd;
+#endif
+
+    uint64_t origin;
+};
+
+static bool s_s3_recv_file_is_aligned(uint64_t value) {
+    return (value % AWS_S3_BUFFER_POOL_ALIGNMENT) == 0;
+}
+
+/* Largest write handed to the platform at once. Aligned, so that every piece of an aligned write is too. */
+static const size_t s_max_write_size = 1024 * 1024 * 1024;
+
+#ifdef _WIN32
+
+static int s_s3_recv_file_platform_open(struct aws_s3_recv_file *recv_file, bool direct_io) {
+    const char *path = aws_string_c_str(recv_file->path);
+
+    recv_file->direct_handle = INVALID_HANDLE_VALUE;
+    recv_file->handle = CreateFileA(
+        path,
+        GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+
+    if (recv_file->handle == INVALID_HANDLE_VALUE) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_GENERAL,
+            "Could not open file %s to receive into, error %lu.",
+            path,
+            (unsigned long)GetLastError());
+        return aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+    }
+
+    if (direct_io) {
+        recv_file->direct_handle = CreateFileA(
+            path,
+            GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH,
+            NULL);
+
+        if (recv_file->direct_handle == INVALID_HANDLE_VALUE) {
+            AWS_LOGF_WARN(
+                AWS_LS_S3_GENERAL,
+                "id=%p: Could not open file %s for direct I/O, error %lu; writing through the page cache instead.",
+                (void *)recv_file,
+                path,
+                (unsigned long)GetLastError());
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_recv_file_platform_preallocate(struct aws_s3_recv_file *recv_file, uint64_t size) {
+    FILE_ALLOCATION_INFO allocation_info;
+    allocation_info.AllocationSize.QuadPart = (LONGLONG)size;
+
+    if (!SetFileInformationByHandle(recv_file->handle, FileAllocationInfo, &allocation_info, sizeof(allocation_info))) {
+        AWS_LOGF_WARN(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Could not allocate %" PRIu64 " bytes for file %s, error %lu.",
+            (void *)recv_file,
+            size,
+            aws_string_c_str(recv_file->path),
+            (unsigned long)GetLastError());
+        return aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_recv_file_platform_write(
+    struct aws_s3_recv_file *recv_file,
+    bool direct,
+    uint64_t file_offset,
+    struct aws_byte_cursor data) {
+
+    HANDLE handle = direct ? recv_file->direct_handle : recv_file->handle;
+
+    while (data.len > 0) {
+        DWORD write_size = (DWORD)aws_min_size(data.len, s_max_write_size);
+
+        OVERLAPPED overlapped;
+        AWS_ZERO_STRUCT(overlapped);
+        overlapped.Offset = (DWORD)(file_offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(file_offset >> 32);
+
+        DWORD num_written = 0;
+
+        if (!WriteFile(handle, data.ptr, write_size, &num_written, &overlapped) || num_written == 0) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_GENERAL,
+                "id=%p: Could not write %zu bytes at offset %" PRIu64 " of file %s, error %lu.",
+                (void *)recv_file,
+                data.len,
+                file_offset,
+                aws_string_c_str(recv_file->path),
+                (unsigned long)GetLastError());
+            return aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+        }
+
+        aws_byte_cursor_advance(&data, num_written);
+        file_offset += num_written;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_recv_file_platform_close(struct aws_s3_recv_file *recv_file) {
+    int result = AWS_OP_SUCCESS;
+
+    if (recv_file->direct_handle != INVALID_HANDLE_VALUE && !CloseHandle(recv_file->direct_handle)) {
+        result = AWS_OP_ERR;
+    }
+
+    if (!CloseHandle(recv_file->handle)) {
+        result = AWS_OP_ERR;
+    }
+
+    if (result != AWS_OP_SUCCESS) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Could not close file %s, error %lu.",
+            (void *)recv_file,
+            aws_string_c_str(recv_file->path),
+            (unsigned long)GetLastError());
+        aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+    }
+
+    return result;
+}
+
+#else
+
+static int s_s3_recv_file_platform_open(struct aws_s3_recv_file *recv_file, bool direct_io) {
+    const char *path = aws_string_c_str(recv_file->path);
+
+    recv_file->direct_fd = -1;
+    recv_file->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (recv_file->fd == -1) {
+        AWS_LOGF_ERROR(AWS_LS_S3_GENERAL, "Could not open file %s to receive into, errno %d.", path, errno);
+        return aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+    }
+
+    if (!direct_io) {
+        return AWS_OP_SUCCESS;
+    }
+
+#    if defined(O_DIRECT)
+    recv_file->direct_fd = open(path, O_WRONLY | O_CLOEXEC | O_DIRECT);
+#    elif defined(F_NOCACHE)
+    recv_file->direct_fd = open(path, O_WRONLY | O_CLOEXEC);
+
+    if (recv_file->direct_fd != -1 && fcntl(recv_file->direct_fd, F_NOCACHE, 1) == -1) {
+        close(recv_file->direct_fd);
+        recv_file->direct_fd = -1;
+    }
+#    else
+    errno = ENOTSUP;
+#    endif
+
+    if (recv_file->direct_fd == -1) {
+        AWS_LOGF_WARN(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Could not open file %s for direct I/O, errno %d; writing through the page cache instead.",
+            (void *)recv_file,
+            path,
+            errno);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_recv_file_platform_preallocate(struct aws_s3_recv_file *recv_file, uint64_t size) {
+#    if defined(__linux__)
+    /* Reserves the blocks, unlike ftruncate, so that the file doesn't fragment as parts land in any order. */
+    int error = posix_fallocate(recv_file->fd, 0, (off_t)size);
+#    else
+    int error = ftruncate(recv_file->fd, (off_t)size) == -1 ? errno : 0;
+#    endif
+
+    if (error != 0) {
+        AWS_LOGF_WARN(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Could not allocate %" PRIu64 " bytes for file %s, errno %d.",
+            (void *)recv_file,
+            size,
+            aws_string_c_str(recv_file->path),
+            error);
+        return aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_recv_file_platform_write(
+    struct aws_s3_recv_file *recv_file,
+    bool direct,
+    uint64_t file_offset,
+    struct aws_byte_cursor data) {
+
+    int fd = direct ? recv_file->direct_fd : recv_file->fd;
+
+    while (data.len > 0) {
+        ssize_t num_written = pwrite(fd, data.ptr, aws_min_size(data.len, s_max_write_size), (off_t)file_offset);
+
+        if (num_written == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (num_written <= 0) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_GENERAL,
+                "id=%p: Could not write %zu bytes at offset %" PRIu64 " of file %s, errno %d.",
+                (void *)recv_file,
+                data.len,
+                file_offset,
+                aws_string_c_str(recv_file->path),
+                num_written == -1 ? errno : 0);
+            return aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+        }
+
+        /* A short direct write leaves the rest unaligned, so it goes through the page cache. */
+        aws_byte_cursor_advance(&data, (size_t)num_written);
+        file_offset += (uint64_t)num_written;
+
+        if (direct && !s_s3_recv_file_is_aligned((uint64_t)num_written)) {
+            fd = recv_file->fd;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s3_recv_file_platform_close(struct aws_s3_recv_file *recv_file) {
+    int result = AWS_OP_SUCCESS;
+
+    if (recv_file->direct_fd != -1 && close(recv_file->direct_fd) == -1) {
+        result = AWS_OP_ERR;
+    }
+
+    if (close(recv_file->fd) == -1) {
+        result = AWS_OP_ERR;
+    }
+
+    if (result != AWS_OP_SUCCESS) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Could not close file %s, errno %d.",
+            (void *)recv_file,
+            aws_string_c_str(recv_file->path),
+            errno);
+        aws_raise_error(AWS_ERROR_S3_RECV_FILE_FAILED);
+    }
+
+    return result;
+}
+
+#endif /* _WIN32 */
+
+static bool s_s3_recv_file_has_direct_io(const struct aws_s3_recv_file *recv_file) {
+#ifdef _WIN32
+    return recv_file->direct_handle != INVALID_HANDLE_VALUE;
+#else
+    return recv_file->direct_fd != -1;
+#endif
+}
+
+struct aws_s3_recv_file *aws_s3_recv_file_open(
+    struct aws_allocator *allocator,
+    struct aws_byte_cursor path,
+    bool preallocate,
+    bool direct_io) {
+    AWS_PRECONDITION(allocator);
+
+    if (path.len == 0) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_s3_recv_file *recv_file = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_recv_file));
+    recv_file->allocator = allocator;
+    recv_file->path = aws_string_new_from_cursor(allocator, &path);
+    *((bool *)&recv_file->preallocate) = preallocate;
+
+    if (s_s3_recv_file_platform_open(recv_file, direct_io)) {
+        goto error_clean_up;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_GENERAL,
+        "id=%p: Opened file %s to receive into (preallocate %d, direct I/O %d).",
+        (void *)recv_file,
+        aws_string_c_str(recv_file->path),
+        (int)preallocate,
+        (int)s_s3_recv_file_has_direct_io(recv_file));
+
+    return recv_file;
+
+error_clean_up:
+
+    aws_string_destroy(recv_file->path);
+    aws_mem_release(allocator, recv_file);
+    return NULL;
+}
+
+int aws_s3_recv_file_set_origin(struct aws_s3_recv_file *recv_file, uint64_t origin, uint64_t size) {
+    AWS_PRECONDITION(recv_file);
+
+    recv_file->origin = origin;
+
+    if (!recv_file->preallocate || size == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_s3_recv_file_platform_preallocate(recv_file, size);
+}
+
+int aws_s3_recv_file_write(struct aws_s3_recv_file *recv_file, uint64_t object_offset, struct aws_byte_cursor data) {
+    AWS_PRECONDITION(recv_file);
+
+    if (object_offset < recv_file->origin) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Offset %" PRIu64 " is before the start of file %s, at offset %" PRIu64 ".",
+            (void *)recv_file,
+            object_offset,
+            aws_string_c_str(recv_file->path),
+            recv_file->origin);
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    const uint64_t file_offset = object_offset - recv_file->origin;
+
+    const bool direct = s_s3_recv_file_has_direct_io(recv_file) && s_s3_recv_file_is_aligned(file_offset) &&
+                        s_s3_recv_file_is_aligned((uint64_t)(uintptr_t)data.ptr) &&
+                        s_s3_recv_file_is_aligned((uint64_t)data.len);
+
+    return s_s3_recv_file_platform_write(recv_file, direct, file_offset, data);
+}
+
+int aws_s3_recv_file_close(struct aws_s3_recv_file *recv_file) {
+    if (recv_file == NULL) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int result = s_s3_recv_file_platform_close(recv_file);
+
+    aws_string_destroy(recv_file->path);
+    aws_mem_release(recv_file->allocator, recv_file);
+
+    return result;
+}
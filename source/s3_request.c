@@ -1,10 +1,34 @@
 #include "aws/s3/private/s3_request.h"
+#include "aws/s3/private/s3_buffer_pool.h"
+#include "aws/s3/private/s3_checksums.h"
+#include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_request_pool.h"
 #include <aws/auth/signable.h>
+#include <aws/common/string.h>
 #include <aws/io/stream.h>
 
 static void s_s3_request_destroy(void *user_data);
 
+/* Hand a buffer back to the client's buffer pool if there is one, otherwise just clean it up. */
+static void s_s3_request_release_buffer(struct aws_s3_request *request, struct aws_byte_buf *buf) {
+    AWS_PRECONDITION(request);
+    AWS_PRECONDITION(buf);
+
+    struct aws_s3_meta_request *meta_request = request->meta_request;
+    struct aws_s3_buffer_pool *buffer_pool = NULL;
+
+    if (meta_request != NULL && meta_request->client != NULL) {
+        buffer_pool = aws_s3_client_get_part_buffer_pool(meta_request->client, meta_request);
+    }
+
+    if (buffer_pool != NULL) {
+        aws_s3_buffer_pool_release_buffer(buffer_pool, buf);
+    } else {
+        aws_byte_buf_clean_up(buf);
+    }
+}
+
 struct aws_s3_request *aws_s3_request_new(
     struct aws_s3_meta_request *meta_request,
     int request_tag,
@@ -13,11 +37,19 @@ struct aws_s3_request *aws_s3_request_new(
     AWS_PRECONDITION(meta_request);
     AWS_PRECONDITION(meta_request->allocator);
 
-    struct aws_s3_request *request = aws_mem_calloc(meta_request->allocator, 1, sizeof(struct aws_s3_request));
+    struct aws_s3_client *client = meta_request->client;
+    struct aws_s3_request *request = NULL;
+
+    if (client != NULL && client->request_pool != NULL) {
+        request = aws_s3_request_pool_acquire(client->request_pool);
+        request->allocator = client->request_pool->allocator;
+    } else {
+        request = aws_mem_calloc(meta_request->allocator, 1, sizeof(struct aws_s3_request));
+        request->allocator = meta_request->allocator;
+    }
 
     aws_ref_count_init(&request->ref_count, request, (aws_simple_completion_callback *)s_s3_request_destroy);
 
-    request->allocator = meta_request->allocator;
     request->meta_request = meta_request;
     aws_s3_meta_request_acquire(meta_request);
 
@@ -26,10 +58,49 @@ struct aws_s3_request *aws_s3_request_new(
     request->record_response_headers = (flags & AWS_S3_REQUEST_FLAG_RECORD_RESPONSE_HEADERS) != 0;
     request->part_size_response_body = (flags & AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY) != 0;
     request->always_send = (flags & AWS_S3_REQUEST_FLAG_ALWAYS_SEND) != 0;
+    request->part_size_request_body = (flags & AWS_S3_REQUEST_FLAG_PART_SIZE_REQUEST_BODY) != 0;
+    request->stream_response_body_directly = (flags & AWS_S3_REQUEST_FLAG_STREAM_RESPONSE_BODY_DIRECTLY) != 0;
+
+    aws_atomic_init_int(&request->cancelled, 0);
 
     return request;
 }
 
+void aws_s3_request_cancel(struct aws_s3_request *request) {
+    AWS_PRECONDITION(request);
+
+    aws_atomic_store_int(&request->cancelled, 1);
+}
+
+bool aws_s3_request_is_cancelled(struct aws_s3_request *request) {
+    AWS_PRECONDITION(request);
+
+    return aws_atomic_load_int(&request->cancelled) != 0;
+}
+
+size_t aws_s3_request_get_part_buffer_size(const struct aws_s3_request *request) {
+    AWS_PRECONDITION(request);
+    AWS_PRECONDITION(request->meta_request);
+
+    size_t part_buffer_size = request->meta_request->part_size;
+
+    if (request->part_range_end > request->part_range_start) {
+        uint64_t part_range_size = request->part_range_end - request->part_range_start + 1;
+
+        if (part_range_size > (uint64_t)part_buffer_size && part_range_size <= SIZE_MAX) {
+            part_buffer_size = (size_t)part_range_size;
+        }
+    }
+
+    return part_buffer_size;
+}
+
+size_t aws_s3_request_get_body_size(const struct aws_s3_request *request) {
+    AWS_PRECONDITION(request);
+
+    return request->request_body.len + request->num_gathered_request_body_bytes;
+}
+
 void aws_s3_request_setup_send_data(struct aws_s3_request *request, struct aws_http_message *message) {
     AWS_PRECONDITION(request);
     AWS_PRECONDITION(message);
@@ -70,7 +141,11 @@ void aws_s3_request_clean_up_send_data(struct aws_s3_request *request) {
     aws_http_headers_release(request->send_data.response_headers);
     request->send_data.response_headers = NULL;
 
-    aws_byte_buf_clean_up(&request->send_data.response_body);
+    s_s3_request_release_buffer(request, &request->send_data.response_body);
+    s_s3_request_release_buffer(request, &request->send_data.cached_response_body);
+
+    aws_s3_checksum_destroy(request->send_data.response_checksum);
+    aws_string_destroy(request->send_data.expected_response_checksum);
 
     AWS_ZERO_STRUCT(request->send_data);
 }
@@ -97,17 +172,26 @@ static void s_s3_request_destroy(void *user_data) {
     }
 
     struct aws_s3_meta_request *meta_request = request->meta_request;
+    struct aws_s3_request_pool *request_pool = NULL;
 
     if (meta_request != NULL) {
         struct aws_s3_client *client = meta_request->client;
 
         if (client != NULL) {
             aws_s3_client_notify_request_destroyed(client, request);
+            request_pool = client->request_pool;
         }
     }
 
     aws_s3_request_clean_up_send_data(request);
-    aws_byte_buf_clean_up(&request->request_body);
-    aws_mem_release(request->allocator, request);
+    s_s3_request_release_buffer(request, &request->request_body);
+
+    /* Requests destroyed after their meta request let go of the client are freed like any other allocation. */
+    if (request_pool != NULL && request->allocator == request_pool->allocator) {
+        aws_s3_request_pool_release(request_pool, request);
+    } else {
+        aws_mem_release(request->allocator, request);
+    }
+
     aws_s3_meta_request_release(meta_request);
 }
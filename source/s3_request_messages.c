@@ -4,7 +4,10 @@
  */
 
 #include "aws/s3/private/s3_request_messages.h"
+#include "aws/s3/private/s3_checksums.h"
+#include "aws/s3/private/s3_chunk_stream.h"
 #include "aws/s3/private/s3_client_impl.h"
+#include "aws/s3/private/s3_gather_stream.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
 #include "aws/s3/private/s3_util.h"
 #include <aws/cal/hash.h>
@@ -22,6 +25,10 @@ const struct aws_byte_cursor g_s3_create_multipart_upload_excluded_headers[] = {
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Content-MD5"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-copy-source"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-copy-source-range"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32c"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha1"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha256"),
 };
 
 const size_t g_s3_create_multipart_upload_excluded_headers_count =
@@ -51,6 +58,10 @@ const struct aws_byte_cursor g_s3_upload_part_excluded_headers[] = {
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-object-lock-mode"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-object-lock-retain-until-date"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-object-lock-legal-hold"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32c"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha1"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha256"),
 };
 
 const size_t g_s3_upload_part_excluded_headers_count = AWS_ARRAY_SIZE(g_s3_upload_part_excluded_headers);
@@ -84,6 +95,10 @@ const struct aws_byte_cursor g_s3_complete_multipart_upload_excluded_headers[] =
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-object-lock-legal-hold"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-copy-source"),
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-copy-source-range"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32c"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-crc32"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha1"),
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-sha256"),
 };
 
 const size_t g_s3_complete_multipart_upload_excluded_headers_count =
@@ -163,7 +178,8 @@ error_clean_up:
 /* Creates a create-multipart-upload request from a given put objet request. */
 struct aws_http_message *aws_s3_create_multipart_upload_message_new(
     struct aws_allocator *allocator,
-    struct aws_http_message *base_message) {
+    struct aws_http_message *base_message,
+    enum aws_s3_checksum_algorithm checksum_algorithm) {
     AWS_PRECONDITION(allocator);
 
     /* For multipart upload, sse related headers should only be shown in create-multipart request */
@@ -193,6 +209,12 @@ struct aws_http_message *aws_s3_create_multipart_upload_message_new(
         }
     }
 
+    if (checksum_algorithm != AWS_SCA_NONE &&
+        aws_http_headers_set(
+            headers, g_checksum_algorithm_header_name, aws_s3_checksum_get_algorithm_name(checksum_algorithm))) {
+        goto error_clean_up;
+    }
+
     aws_http_message_set_request_method(message, g_post_method);
     aws_http_message_set_body_stream(message, NULL);
 
@@ -208,21 +230,66 @@ error_clean_up:
     return NULL;
 }
 
-/* Create a new put object request from an existing put object request.  Currently just optionally adds part information
- * for a multipart upload. */
+struct aws_http_message *aws_s3_upload_part_message_template_new(
+    struct aws_allocator *allocator,
+    struct aws_http_message *base_message) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(base_message);
+
+    return aws_s3_message_util_copy_http_message(
+        allocator, base_message, g_s3_upload_part_excluded_headers, AWS_ARRAY_SIZE(g_s3_upload_part_excluded_headers));
+}
+
+/* Create a new put object request from the part message template of a put object request.  Currently just optionally
+ * adds part information for a multipart upload. */
 struct aws_http_message *aws_s3_upload_part_message_new(
     struct aws_allocator *allocator,
-    struct aws_http_message *base_message,
+    struct aws_http_message *part_message_template,
     struct aws_byte_buf *buffer,
     uint32_t part_number,
     const struct aws_string *upload_id,
-    bool should_compute_content_md5) {
+    bool should_compute_content_md5,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_byte_buf *out_encoded_checksum) {
     AWS_PRECONDITION(allocator);
-    AWS_PRECONDITION(base_message);
+    AWS_PRECONDITION(part_message_template);
     AWS_PRECONDITION(part_number > 0);
 
-    struct aws_http_message *message = aws_s3_message_util_copy_http_message(
-        allocator, base_message, g_s3_upload_part_excluded_headers, AWS_ARRAY_SIZE(g_s3_upload_part_excluded_headers));
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_buf(buffer);
+
+    return aws_s3_upload_part_message_new_gathered(
+        allocator,
+        part_message_template,
+        &body,
+        1,
+        part_number,
+        upload_id,
+        should_compute_content_md5,
+        checksum_algorithm,
+        out_encoded_checksum);
+}
+
+struct aws_http_message *aws_s3_upload_part_message_new_gathered(
+    struct aws_allocator *allocator,
+    struct aws_http_message *part_message_template,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    uint32_t part_number,
+    const struct aws_string *upload_id,
+    bool should_compute_content_md5,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_byte_buf *out_encoded_checksum) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(part_message_template);
+    AWS_PRECONDITION(segments || num_segments == 0);
+    AWS_PRECONDITION(part_number > 0);
+
+    /* The headers of the template are already filtered, and are copied as they are. */
+    struct aws_http_message *message = aws_s3_message_util_copy_http_message(allocator, part_message_template, NULL, 0);
 
     if (message == NULL) {
         goto error_clean_up;
@@ -232,18 +299,21 @@ struct aws_http_message *aws_s3_upload_part_message_new(
         goto error_clean_up;
     }
 
-    if (buffer != NULL) {
-        if (aws_s3_message_util_assign_body(allocator, buffer, message) == NULL) {
+    if (aws_s3_message_util_assign_gathered_body(allocator, segments, num_segments, message) == NULL) {
+        goto error_clean_up;
+    }
+
+    if (should_compute_content_md5) {
+        if (aws_s3_message_util_add_gathered_content_md5_header(allocator, segments, num_segments, message)) {
             goto error_clean_up;
         }
+    }
 
-        if (should_compute_content_md5) {
-            if (aws_s3_message_util_add_content_md5_header(allocator, buffer, message)) {
-                goto error_clean_up;
-            }
+    if (checksum_algorithm != AWS_SCA_NONE) {
+        if (aws_s3_message_util_add_gathered_checksum_header(
+                allocator, segments, num_segments, checksum_algorithm, message, out_encoded_checksum)) {
+            goto error_clean_up;
         }
-    } else {
-        goto error_clean_up;
     }
 
     return message;
@@ -260,7 +330,7 @@ error_clean_up:
 
 struct aws_http_message *aws_s3_upload_part_copy_message_new(
     struct aws_allocator *allocator,
-    struct aws_http_message *base_message,
+    struct aws_http_message *part_message_template,
     struct aws_byte_buf *buffer,
     uint32_t part_number,
     uint64_t range_start,
@@ -268,11 +338,10 @@ struct aws_http_message *aws_s3_upload_part_copy_message_new(
     const struct aws_string *upload_id,
     bool should_compute_content_md5) {
     AWS_PRECONDITION(allocator);
-    AWS_PRECONDITION(base_message);
+    AWS_PRECONDITION(part_message_template);
     AWS_PRECONDITION(part_number > 0);
 
-    struct aws_http_message *message = aws_s3_message_util_copy_http_message(
-        allocator, base_message, g_s3_upload_part_excluded_headers, AWS_ARRAY_SIZE(g_s3_upload_part_excluded_headers));
+    struct aws_http_message *message = aws_s3_message_util_copy_http_message(allocator, part_message_template, NULL, 0);
 
     if (message == NULL) {
         goto error_clean_up;
@@ -447,8 +516,30 @@ static const struct aws_byte_cursor s_part_section_string_1 =
     AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("</ETag>\n"
                                           "         <PartNumber>");
 
-static const struct aws_byte_cursor s_part_section_string_2 = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("</PartNumber>\n"
-                                                                                                    "    </Part>\n");
+static const struct aws_byte_cursor s_part_section_string_2 = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("</PartNumber>\n");
+
+static const struct aws_byte_cursor s_part_section_string_3 = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("    </Part>\n");
+
+/* Append "<name>value</name>" (with the indentation of the elements of a part) to buffer. */
+static int s_s3_append_part_xml_element(
+    struct aws_byte_buf *buffer,
+    struct aws_byte_cursor name,
+    struct aws_byte_cursor value) {
+
+    struct aws_byte_cursor indent = aws_byte_cursor_from_c_str("         <");
+    struct aws_byte_cursor open_end = aws_byte_cursor_from_c_str(">");
+    struct aws_byte_cursor close_begin = aws_byte_cursor_from_c_str("</");
+    struct aws_byte_cursor close_end = aws_byte_cursor_from_c_str(">\n");
+
+    if (aws_byte_buf_append_dynamic(buffer, &indent) || aws_byte_buf_append_dynamic(buffer, &name) ||
+        aws_byte_buf_append_dynamic(buffer, &open_end) || aws_byte_buf_append_dynamic(buffer, &value) ||
+        aws_byte_buf_append_dynamic(buffer, &close_begin) || aws_byte_buf_append_dynamic(buffer, &name) ||
+        aws_byte_buf_append_dynamic(buffer, &close_end)) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
 
 /* Create a complete-multipart message, which includes an XML payload of all completed parts. */
 struct aws_http_message *aws_s3_complete_multipart_message_new(
@@ -456,7 +547,9 @@ struct aws_http_message *aws_s3_complete_multipart_message_new(
     struct aws_http_message *base_message,
     struct aws_byte_buf *body_buffer,
     const struct aws_string *upload_id,
-    const struct aws_array_list *etags) {
+    const struct aws_array_list *etags,
+    const struct aws_array_list *checksums,
+    enum aws_s3_checksum_algorithm checksum_algorithm) {
     AWS_PRECONDITION(allocator);
     AWS_PRECONDITION(base_message);
     AWS_PRECONDITION(body_buffer);
@@ -529,6 +622,22 @@ struct aws_http_message *aws_s3_complete_multipart_message_new(
             if (aws_byte_buf_append_dynamic(body_buffer, &s_part_section_string_2)) {
                 goto error_clean_up;
             }
+
+            if (checksums != NULL && etag_index < aws_array_list_length(checksums)) {
+                struct aws_string *checksum = NULL;
+                aws_array_list_get_at(checksums, &checksum, etag_index);
+
+                if (checksum != NULL && s_s3_append_part_xml_element(
+                                            body_buffer,
+                                            aws_s3_checksum_get_xml_element_name(checksum_algorithm),
+                                            aws_byte_cursor_from_string(checksum))) {
+                    goto error_clean_up;
+                }
+            }
+
+            if (aws_byte_buf_append_dynamic(body_buffer, &s_part_section_string_3)) {
+                goto error_clean_up;
+            }
         }
 
         if (aws_byte_buf_append_dynamic(body_buffer, &s_complete_payload_end)) {
@@ -592,34 +701,128 @@ struct aws_input_stream *aws_s3_message_util_assign_body(
     AWS_PRECONDITION(byte_buf);
 
     struct aws_byte_cursor buffer_byte_cursor = aws_byte_cursor_from_buf(byte_buf);
+    return aws_s3_message_util_assign_gathered_body(allocator, &buffer_byte_cursor, 1, out_message);
+}
+
+struct aws_input_stream *aws_s3_message_util_assign_gathered_body(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_http_message *out_message) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(out_message);
+    AWS_PRECONDITION(segments || num_segments == 0);
+
     struct aws_http_headers *headers = aws_http_message_get_headers(out_message);
 
     if (headers == NULL) {
         return NULL;
     }
 
-    struct aws_input_stream *input_stream = aws_input_stream_new_from_cursor(allocator, &buffer_byte_cursor);
+    struct aws_input_stream *input_stream = num_segments == 1
+                                                ? aws_input_stream_new_from_cursor(allocator, &segments[0])
+                                                : aws_s3_gather_stream_new(allocator, segments, num_segments);
 
     if (input_stream == NULL) {
-        goto error_clean_up;
+        return NULL;
+    }
+
+    uint64_t content_length = 0;
+
+    for (size_t segment_index = 0; segment_index < num_segments; ++segment_index) {
+        content_length += segments[segment_index].len;
     }
 
     char content_length_buffer[64] = "";
-    snprintf(content_length_buffer, sizeof(content_length_buffer), "%" PRIu64, (uint64_t)buffer_byte_cursor.len);
+    snprintf(content_length_buffer, sizeof(content_length_buffer), "%" PRIu64, content_length);
     struct aws_byte_cursor content_length_cursor =
         aws_byte_cursor_from_array(content_length_buffer, strlen(content_length_buffer));
 
     if (aws_http_headers_set(headers, g_content_length_header_name, content_length_cursor)) {
         aws_input_stream_destroy(input_stream);
+        return NULL;
+    }
+
+    aws_http_message_set_body_stream(out_message, input_stream);
+
+    return input_stream;
+}
+
+struct aws_input_stream *aws_s3_message_util_assign_chunked_body(
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *byte_buf,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_http_message *out_message) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(out_message);
+    AWS_PRECONDITION(byte_buf);
+    AWS_PRECONDITION(checksum_algorithm != AWS_SCA_NONE);
+
+    struct aws_byte_cursor buffer_byte_cursor = aws_byte_cursor_from_buf(byte_buf);
+    struct aws_http_headers *headers = aws_http_message_get_headers(out_message);
+    struct aws_byte_buf content_encoding;
+    AWS_ZERO_STRUCT(content_encoding);
+
+    if (headers == NULL) {
+        return NULL;
+    }
+
+    struct aws_input_stream *input_stream = aws_s3_chunk_stream_new(allocator, buffer_byte_cursor, checksum_algorithm);
+
+    if (input_stream == NULL) {
         goto error_clean_up;
     }
 
+    char content_length_buffer[64] = "";
+    snprintf(
+        content_length_buffer,
+        sizeof(content_length_buffer),
+        "%" PRIu64,
+        aws_s3_chunk_stream_compute_length(buffer_byte_cursor.len, checksum_algorithm));
+
+    char decoded_content_length_buffer[64] = "";
+    snprintf(
+        decoded_content_length_buffer,
+        sizeof(decoded_content_length_buffer),
+        "%" PRIu64,
+        (uint64_t)buffer_byte_cursor.len);
+
+    if (aws_byte_buf_init_copy_from_cursor(&content_encoding, allocator, g_aws_chunked_content_encoding)) {
+        goto error_clean_up;
+    }
+
+    struct aws_byte_cursor existing_content_encoding;
+
+    if (aws_http_headers_get(headers, g_content_encoding_header_name, &existing_content_encoding) == AWS_OP_SUCCESS &&
+        existing_content_encoding.len > 0) {
+        struct aws_byte_cursor separator = aws_byte_cursor_from_c_str(",");
+
+        if (aws_byte_buf_append_dynamic(&content_encoding, &separator) ||
+            aws_byte_buf_append_dynamic(&content_encoding, &existing_content_encoding)) {
+            goto error_clean_up;
+        }
+    }
+
+    if (aws_http_headers_set(
+            headers, g_content_length_header_name, aws_byte_cursor_from_c_str(content_length_buffer)) ||
+        aws_http_headers_set(
+            headers,
+            g_decoded_content_length_header_name,
+            aws_byte_cursor_from_c_str(decoded_content_length_buffer)) ||
+        aws_http_headers_set(headers, g_content_encoding_header_name, aws_byte_cursor_from_buf(&content_encoding)) ||
+        aws_http_headers_set(headers, g_trailer_header_name, aws_s3_checksum_get_header_name(checksum_algorithm))) {
+        goto error_clean_up;
+    }
+
+    aws_byte_buf_clean_up(&content_encoding);
+
     aws_http_message_set_body_stream(out_message, input_stream);
 
     return input_stream;
 
 error_clean_up:
 
+    aws_byte_buf_clean_up(&content_encoding);
     aws_input_stream_destroy(input_stream);
     return NULL;
 }
@@ -632,11 +835,35 @@ int aws_s3_message_util_add_content_md5_header(
 
     AWS_PRECONDITION(out_message);
 
-    /* Compute MD5 */
     struct aws_byte_cursor md5_input = aws_byte_cursor_from_buf(input_buf);
+    return aws_s3_message_util_add_gathered_content_md5_header(allocator, &md5_input, 1, out_message);
+}
+
+int aws_s3_message_util_add_gathered_content_md5_header(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    struct aws_http_message *out_message) {
+
+    AWS_PRECONDITION(segments || num_segments == 0);
+    AWS_PRECONDITION(out_message);
+
+    /* Compute MD5 */
     uint8_t md5_output[AWS_MD5_LEN];
     struct aws_byte_buf md5_output_buf = aws_byte_buf_from_empty_array(md5_output, sizeof(md5_output));
-    if (aws_md5_compute(allocator, &md5_input, &md5_output_buf, 0)) {
+    struct aws_hash *md5 = aws_md5_new(allocator);
+    if (md5 == NULL) {
+        return AWS_OP_ERR;
+    }
+    for (size_t segment_index = 0; segment_index < num_segments; ++segment_index) {
+        if (aws_hash_update(md5, &segments[segment_index])) {
+            aws_hash_destroy(md5);
+            return AWS_OP_ERR;
+        }
+    }
+    int md5_result = aws_hash_finalize(md5, &md5_output_buf, 0);
+    aws_hash_destroy(md5);
+    if (md5_result) {
         return AWS_OP_ERR;
     }
 
@@ -668,6 +895,64 @@ error_clean_up:
     return AWS_OP_ERR;
 }
 
+/* Add a flexible checksum header. */
+int aws_s3_message_util_add_checksum_header(
+    struct aws_allocator *allocator,
+    struct aws_byte_buf *input_buf,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_http_message *out_message,
+    struct aws_byte_buf *out_encoded_checksum) {
+
+    AWS_PRECONDITION(input_buf);
+    AWS_PRECONDITION(out_message);
+
+    struct aws_byte_cursor checksum_input = aws_byte_cursor_from_buf(input_buf);
+    return aws_s3_message_util_add_gathered_checksum_header(
+        allocator, &checksum_input, 1, checksum_algorithm, out_message, out_encoded_checksum);
+}
+
+int aws_s3_message_util_add_gathered_checksum_header(
+    struct aws_allocator *allocator,
+    const struct aws_byte_cursor *segments,
+    size_t num_segments,
+    enum aws_s3_checksum_algorithm checksum_algorithm,
+    struct aws_http_message *out_message,
+    struct aws_byte_buf *out_encoded_checksum) {
+
+    AWS_PRECONDITION(segments || num_segments == 0);
+    AWS_PRECONDITION(out_message);
+
+    struct aws_byte_buf encoded_checksum_buf;
+
+    if (aws_byte_buf_init(&encoded_checksum_buf, allocator, 0)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_s3_checksum_compute_base64_gathered(
+            allocator, checksum_algorithm, segments, num_segments, &encoded_checksum_buf)) {
+        goto error_clean_up;
+    }
+
+    struct aws_byte_cursor encoded_checksum = aws_byte_cursor_from_buf(&encoded_checksum_buf);
+    struct aws_http_headers *headers = aws_http_message_get_headers(out_message);
+
+    if (aws_http_headers_set(headers, aws_s3_checksum_get_header_name(checksum_algorithm), encoded_checksum)) {
+        goto error_clean_up;
+    }
+
+    if (out_encoded_checksum != NULL && aws_byte_buf_append_dynamic(out_encoded_checksum, &encoded_checksum)) {
+        goto error_clean_up;
+    }
+
+    aws_byte_buf_clean_up(&encoded_checksum_buf);
+    return AWS_OP_SUCCESS;
+
+error_clean_up:
+
+    aws_byte_buf_clean_up(&encoded_checksum_buf);
+    return AWS_OP_ERR;
+}
+
 /* Copy an existing HTTP message's headers and body. */
 struct aws_http_message *aws_s3_message_util_copy_http_message(
     struct aws_allocator *allocator,
@@ -795,7 +1080,22 @@ int aws_s3_message_util_set_multipart_request_path(
         return AWS_OP_ERR;
     }
 
-    if (aws_byte_buf_init(&request_path_buf, allocator, request_path.len)) {
+    /* Size the buffer for all of the query parameters up front, so that it is only allocated once. */
+    size_t request_path_size = request_path.len;
+
+    if (part_number > 0) {
+        request_path_size += ampersand.len + part_number_arg.len + 10;
+    }
+
+    if (upload_id != NULL) {
+        request_path_size += ampersand.len + upload_id_arg.len + upload_id->len;
+    }
+
+    if (append_uploads_suffix) {
+        request_path_size += ampersand.len + uploads_suffix.len;
+    }
+
+    if (aws_byte_buf_init(&request_path_buf, allocator, request_path_size)) {
         return AWS_OP_ERR;
     }
 
@@ -0,0 +1,94 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_request_pool.h"
+#include "aws/s3/private/s3_request.h"
+
+struct aws_s3_request_pool *aws_s3_request_pool_new(struct aws_allocator *allocator, size_t max_free_requests) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_s3_request_pool *request_pool = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_request_pool));
+
+    request_pool->allocator = allocator;
+    *((size_t *)&request_pool->max_free_requests) = max_free_requests;
+
+    if (aws_mutex_init(&request_pool->synced_data.lock)) {
+        goto error_clean_up;
+    }
+
+    if (aws_array_list_init_dynamic(
+            &request_pool->synced_data.free_requests, allocator, 16, sizeof(struct aws_s3_request *))) {
+        aws_mutex_clean_up(&request_pool->synced_data.lock);
+        goto error_clean_up;
+    }
+
+    return request_pool;
+
+error_clean_up:
+
+    aws_mem_release(allocator, request_pool);
+    return NULL;
+}
+
+void aws_s3_request_pool_destroy(struct aws_s3_request_pool *request_pool) {
+    if (request_pool == NULL) {
+        return;
+    }
+
+    for (size_t request_index = 0; request_index < aws_array_list_length(&request_pool->synced_data.free_requests);
+         ++request_index) {
+        struct aws_s3_request *request = NULL;
+        aws_array_list_get_at(&request_pool->synced_data.free_requests, &request, request_index);
+        aws_mem_release(request_pool->allocator, request);
+    }
+
+    aws_array_list_clean_up(&request_pool->synced_data.free_requests);
+    aws_mutex_clean_up(&request_pool->synced_data.lock);
+    aws_mem_release(request_pool->allocator, request_pool);
+}
+
+struct aws_s3_request *aws_s3_request_pool_acquire(struct aws_s3_request_pool *request_pool) {
+    AWS_PRECONDITION(request_pool);
+
+    struct aws_s3_request *request = NULL;
+
+    aws_mutex_lock(&request_pool->synced_data.lock);
+
+    if (aws_array_list_length(&request_pool->synced_data.free_requests) > 0) {
+        aws_array_list_back(&request_pool->synced_data.free_requests, &request);
+        aws_array_list_pop_back(&request_pool->synced_data.free_requests);
+    }
+
+    aws_mutex_unlock(&request_pool->synced_data.lock);
+
+    if (request == NULL) {
+        return aws_mem_calloc(request_pool->allocator, 1, sizeof(struct aws_s3_request));
+    }
+
+    AWS_ZERO_STRUCT(*request);
+    return request;
+}
+
+void aws_s3_request_pool_release(struct aws_s3_request_pool *request_pool, struct aws_s3_request *request) {
+    AWS_PRECONDITION(request_pool);
+
+    if (request == NULL) {
+        return;
+    }
+
+    bool recycled = false;
+
+    aws_mutex_lock(&request_pool->synced_data.lock);
+
+    if (aws_array_list_length(&request_pool->synced_data.free_requests) < request_pool->max_free_requests) {
+        recycled = aws_array_list_push_back(&request_pool->synced_data.free_requests, &request) == AWS_OP_SUCCESS;
+    }
+
+    aws_mutex_unlock(&request_pool->synced_data.lock);
+
+    if (!recycled) {
+        aws_mem_release(request_pool->allocator, request);
+    }
+}
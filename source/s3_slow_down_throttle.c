@@ -0,0 +1,232 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_slow_down_throttle.h"
+
+#include <aws/common/clock.h>
+#include <aws/common/logging.h>
+
+/* Length of the window the admission rate is measured over while not throttled. A partial window is only taken into
+ * account once it is at least a tenth of this long. */
+static const uint64_t s_rate_window_ns = 1000000000ULL;
+
+/* The admission rate never goes below this many requests per second. */
+static const double s_min_rate = 10.0;
+
+/* On SlowDown, the admission rate is multiplied by this. */
+static const double s_rate_decrease_factor = 0.5;
+
+/* SlowDowns arriving within this long of the last decrease were for requests sent at the old rate, and don't decrease
+ * the rate any further. */
+static const uint64_t s_min_decrease_interval_ns = 100000000ULL;
+
+/* Every time this long passes without a SlowDown, the admission rate is multiplied by this. */
+static const uint64_t s_recovery_interval_ns = 1000000000ULL;
+static const double s_rate_increase_factor = 1.5;
+
+/* Number of seconds worth of requests that can be admitted in a burst. */
+static const double s_burst_secs = 0.1;
+
+struct aws_s3_slow_down_throttle *aws_s3_slow_down_throttle_new(struct aws_allocator *allocator) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_s3_slow_down_throttle *throttle = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_slow_down_throttle));
+    throttle->allocator = allocator;
+
+    if (aws_mutex_init(&throttle->synced_data.lock)) {
+        aws_mem_release(allocator, throttle);
+        return NULL;
+    }
+
+    return throttle;
+}
+
+void aws_s3_slow_down_throttle_destroy(struct aws_s3_slow_down_throttle *throttle) {
+    if (throttle == NULL) {
+        return;
+    }
+
+    aws_mutex_clean_up(&throttle->synced_data.lock);
+    aws_mem_release(throttle->allocator, throttle);
+}
+
+/* Admission rate measured so far, taking the current (partial) window into account. */
+static double s_s3_slow_down_throttle_measured_rate_synced(
+    struct aws_s3_slow_down_throttle *throttle,
+    uint64_t now_ns) {
+    double measured_rate = throttle->synced_data.last_window_rate;
+
+    if (now_ns >= throttle->synced_data.window_start_timestamp_ns + s_rate_window_ns / 10) {
+        double window_secs =
+            (double)(now_ns - throttle->synced_data.window_start_timestamp_ns) / (double)AWS_TIMESTAMP_NANOS;
+        double window_rate = (double)throttle->synced_data.num_window_admissions / window_secs;
+
+        if (window_rate > measured_rate) {
+            measured_rate = window_rate;
+        }
+    }
+
+    return measured_rate;
+}
+
+static void s_s3_slow_down_throttle_record_admission_synced(
+    struct aws_s3_slow_down_throttle *throttle,
+    uint64_t now_ns) {
+    if (throttle->synced_data.window_start_timestamp_ns == 0 ||
+        now_ns < throttle->synced_data.window_start_timestamp_ns) {
+        throttle->synced_data.window_start_timestamp_ns = now_ns;
+    } else if (now_ns - throttle->synced_data.window_start_timestamp_ns >= s_rate_window_ns) {
+        throttle->synced_data.last_window_rate = s_s3_slow_down_throttle_measured_rate_synced(throttle, now_ns);
+        throttle->synced_data.window_start_timestamp_ns = now_ns;
+        throttle->synced_data.num_window_admissions = 0;
+    }
+
+    ++throttle->synced_data.num_window_admissions;
+}
+
+/* Ramp the admission rate back up if there hasn't been a SlowDown in a while. */
+static void s_s3_slow_down_throttle_recover_synced(struct aws_s3_slow_down_throttle *throttle, uint64_t now_ns) {
+    if (now_ns < throttle->synced_data.last_slow_down_timestamp_ns + s_recovery_interval_ns ||
+        now_ns < throttle->synced_data.last_rate_change_timestamp_ns + s_recovery_interval_ns) {
+        return;
+    }
+
+    double rate = throttle->synced_data.rate * s_rate_increase_factor;
+
+    if (rate >= throttle->synced_data.unthrottled_rate) {
+        AWS_LOGF_INFO(AWS_LS_S3_ENDPOINT, "id=%p SlowDown throttle no longer limiting requests.", (void *)throttle);
+
+        /* Start measuring afresh, so that the next throttling starts from the rate at that time. */
+        rate = 0.0;
+        throttle->synced_data.last_window_rate = 0.0;
+        throttle->synced_data.window_start_timestamp_ns = now_ns;
+        throttle->synced_data.num_window_admissions = 0;
+    } else {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_ENDPOINT,
+            "id=%p SlowDown throttle increasing rate from %.1f to %.1f requests per second.",
+            (void *)throttle,
+            throttle->synced_data.rate,
+            rate);
+    }
+
+    throttle->synced_data.rate = rate;
+    throttle->synced_data.last_rate_change_timestamp_ns = now_ns;
+}
+
+bool aws_s3_slow_down_throttle_try_admit(
+    struct aws_s3_slow_down_throttle *throttle,
+    uint64_t now_ns,
+    uint64_t *out_retry_after_ns) {
+    AWS_PRECONDITION(throttle);
+
+    bool admitted = false;
+    uint64_t retry_after_ns = 0;
+
+    aws_mutex_lock(&throttle->synced_data.lock);
+
+    if (throttle->synced_data.rate > 0.0) {
+        s_s3_slow_down_throttle_recover_synced(throttle, now_ns);
+    }
+
+    if (throttle->synced_data.rate == 0.0) {
+        admitted = true;
+        goto done;
+    }
+
+    const double rate = throttle->synced_data.rate;
+
+    if (now_ns > throttle->synced_data.last_refill_timestamp_ns) {
+        const double max_tokens = rate * s_burst_secs > 1.0 ? rate * s_burst_secs : 1.0;
+        const double elapsed_secs =
+            (double)(now_ns - throttle->synced_data.last_refill_timestamp_ns) / (double)AWS_TIMESTAMP_NANOS;
+
+        throttle->synced_data.tokens += elapsed_secs * rate;
+
+        if (throttle->synced_data.tokens > max_tokens) {
+            throttle->synced_data.tokens = max_tokens;
+        }
+
+        throttle->synced_data.last_refill_timestamp_ns = now_ns;
+    }
+
+    if (throttle->synced_data.tokens >= 1.0) {
+        throttle->synced_data.tokens -= 1.0;
+        admitted = true;
+    } else {
+        retry_after_ns = (uint64_t)(((1.0 - throttle->synced_data.tokens) / rate) * (double)AWS_TIMESTAMP_NANOS) + 1;
+    }
+
+done:
+
+    if (admitted) {
+        s_s3_slow_down_throttle_record_admission_synced(throttle, now_ns);
+    }
+
+    aws_mutex_unlock(&throttle->synced_data.lock);
+
+    if (out_retry_after_ns != NULL) {
+        *out_retry_after_ns = retry_after_ns;
+    }
+
+    return admitted;
+}
+
+void aws_s3_slow_down_throttle_on_slow_down(struct aws_s3_slow_down_throttle *throttle, uint64_t now_ns) {
+    AWS_PRECONDITION(throttle);
+
+    aws_mutex_lock(&throttle->synced_data.lock);
+
+    throttle->synced_data.last_slow_down_timestamp_ns = now_ns;
+
+    double rate = throttle->synced_data.rate;
+
+    if (rate == 0.0) {
+        double unthrottled_rate = s_s3_slow_down_throttle_measured_rate_synced(throttle, now_ns);
+
+        if (unthrottled_rate < s_min_rate) {
+            unthrottled_rate = s_min_rate;
+        }
+
+        throttle->synced_data.unthrottled_rate = unthrottled_rate;
+        throttle->synced_data.tokens = 0.0;
+        throttle->synced_data.last_refill_timestamp_ns = now_ns;
+
+        rate = unthrottled_rate * s_rate_decrease_factor;
+    } else if (now_ns >= throttle->synced_data.last_rate_change_timestamp_ns + s_min_decrease_interval_ns) {
+        rate *= s_rate_decrease_factor;
+    } else {
+        goto unlock;
+    }
+
+    if (rate < s_min_rate) {
+        rate = s_min_rate;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_ENDPOINT,
+        "id=%p SlowDown received, limiting requests to %.1f per second (was %.1f, unthrottled %.1f).",
+        (void *)throttle,
+        rate,
+        throttle->synced_data.rate,
+        throttle->synced_data.unthrottled_rate);
+
+    throttle->synced_data.rate = rate;
+    throttle->synced_data.last_rate_change_timestamp_ns = now_ns;
+
+unlock:
+
+    aws_mutex_unlock(&throttle->synced_data.lock);
+}
+
+double aws_s3_slow_down_throttle_get_rate(struct aws_s3_slow_down_throttle *throttle) {
+    AWS_PRECONDITION(throttle);
+
+    aws_mutex_lock(&throttle->synced_data.lock);
+    double rate = throttle->synced_data.rate;
+    aws_mutex_unlock(&throttle->synced_data.lock);
+
+    return rate;
+}
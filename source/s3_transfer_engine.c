@@ -0,0 +1,526 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/private/s3_client_impl.h>
+#include <aws/s3/private/s3_transfer_engine.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
+#include <aws/common/ref_count.h>
+#include <aws/common/string.h>
+#include <aws/http/request_response.h>
+
+#include <inttypes.h>
+
+/* Number of transfers that can wait for their turn per transfer that can run, by default. */
+static const size_t s_default_num_queued_per_active_transfer = 4;
+
+struct s3_transfer {
+    struct aws_linked_list_node node;
+    struct aws_s3_transfer_engine *engine;
+
+    enum aws_s3_meta_request_type type;
+    struct aws_http_message *message;
+    struct aws_string *filepath;
+    uint64_t size;
+    void *user_data;
+
+    /* Protected by the lock of the engine. Set once the meta request has been made, and finished once it is done.
+     * Whichever of the two happens last destroys the transfer. */
+    struct aws_s3_meta_request *meta_request;
+    bool finished;
+};
+
+struct aws_s3_transfer_engine {
+    struct aws_allocator *allocator;
+    struct aws_s3_client *client;
+    struct aws_signing_config_aws *signing_config;
+
+    const uint32_t max_active_transfers;
+    const size_t max_queued_transfers;
+
+    aws_s3_transfer_engine_transfer_finish_fn *transfer_finish_callback;
+    aws_s3_transfer_engine_finish_fn *finish_callback;
+    void *user_data;
+
+    uint64_t start_timestamp_ns;
+
+    struct aws_ref_count ref_count;
+
+    struct {
+        struct aws_mutex lock;
+
+        /* Signaled once there is room to queue transfers. */
+        struct aws_condition_variable room_signal;
+
+        /* Transfers waiting for their turn, and transfers whose meta request is running (struct s3_transfer). */
+        struct aws_linked_list queued_transfers;
+        size_t num_transfers_queued;
+        struct aws_linked_list active_transfers;
+        size_t num_transfers_active;
+
+        uint64_t num_transfers_succeeded;
+        uint64_t num_transfers_failed;
+
+        /* Bytes transferred by the meta requests that are done. */
+        uint64_t num_bytes_transferred;
+
+        /* Error of the first transfer that failed. */
+        int error_code;
+
+        aws_s3_transfer_engine_room_fn *room_callback;
+        void *room_user_data;
+
+        uint32_t input_ended : 1;
+        uint32_t finished : 1;
+    } synced_data;
+};
+
+static void s_s3_transfer_engine_update(struct aws_s3_transfer_engine *engine);
+
+static void s_s3_transfer_destroy(struct s3_transfer *transfer) {
+    struct aws_allocator *allocator = transfer->engine->allocator;
+
+    aws_http_message_release(transfer->message);
+    aws_string_destroy(transfer->filepath);
+    aws_mem_release(allocator, transfer);
+}
+
+static void s_s3_transfer_engine_ref_count_zero_callback(void *arg) {
+    struct aws_s3_transfer_engine *engine = arg;
+
+    AWS_ASSERT(aws_linked_list_empty(&engine->synced_data.active_transfers));
+
+    while (!aws_linked_list_empty(&engine->synced_data.queued_transfers)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&engine->synced_data.queued_transfers);
+        s_s3_transfer_destroy(AWS_CONTAINER_OF(node, struct s3_transfer, node));
+    }
+
+    aws_condition_variable_clean_up(&engine->synced_data.room_signal);
+    aws_mutex_clean_up(&engine->synced_data.lock);
+    aws_s3_client_release(engine->client);
+    aws_mem_release(engine->allocator, engine);
+}
+
+void aws_s3_transfer_engine_acquire(struct aws_s3_transfer_engine *engine) {
+    AWS_FATAL_PRECONDITION(engine);
+    aws_ref_count_acquire(&engine->ref_count);
+}
+
+void aws_s3_transfer_engine_release(struct aws_s3_transfer_engine *engine) {
+    if (engine) {
+        aws_ref_count_release(&engine->ref_count);
+    }
+}
+
+struct aws_s3_transfer_engine *aws_s3_transfer_engine_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_transfer_engine_options *options) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(options);
+    AWS_PRECONDITION(options->client);
+
+    struct aws_s3_transfer_engine *engine = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_transfer_engine));
+    engine->allocator = allocator;
+    engine->client = options->client;
+    aws_s3_client_acquire(options->client);
+    engine->signing_config = options->signing_config;
+    engine->transfer_finish_callback = options->transfer_finish_callback;
+    engine->finish_callback = options->finish_callback;
+    engine->user_data = options->user_data;
+
+    uint32_t max_active_transfers = options->max_active_transfers;
+
+    if (max_active_transfers == 0) {
+        max_active_transfers = aws_s3_client_get_max_active_connections(options->client, NULL);
+    }
+
+    size_t max_queued_transfers = options->max_queued_transfers;
+
+    if (max_queued_transfers == 0) {
+        max_queued_transfers = (size_t)max_active_transfers * s_default_num_queued_per_active_transfer;
+    }
+
+    *((uint32_t *)&engine->max_active_transfers) = max_active_transfers;
+    *((size_t *)&engine->max_queued_transfers) = max_queued_transfers;
+
+    aws_high_res_clock_get_ticks(&engine->start_timestamp_ns);
+
+    aws_ref_count_init(&engine->ref_count, engine, s_s3_transfer_engine_ref_count_zero_callback);
+    aws_mutex_init(&engine->synced_data.lock);
+    aws_condition_variable_init(&engine->synced_data.room_signal);
+    aws_linked_list_init(&engine->synced_data.queued_transfers);
+    aws_linked_list_init(&engine->synced_data.active_transfers);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_GENERAL,
+        "id=%p: Created transfer engine running up to %" PRIu32 " transfers at once, with up to %zu queued.",
+        (void *)engine,
+        max_active_transfers,
+        max_queued_transfers);
+
+    /* One reference for the caller, and one held until finish_callback is invoked. */
+    aws_ref_count_acquire(&engine->ref_count);
+
+    return engine;
+}
+
+int aws_s3_transfer_engine_add(struct aws_s3_transfer_engine *engine, const struct aws_s3_transfer_options *transfer) {
+    AWS_PRECONDITION(engine);
+    AWS_PRECONDITION(transfer);
+    AWS_PRECONDITION(transfer->message);
+
+    if (transfer->type != AWS_S3_META_REQUEST_TYPE_GET_OBJECT &&
+        transfer->type != AWS_S3_META_REQUEST_TYPE_PUT_OBJECT &&
+        transfer->type != AWS_S3_META_REQUEST_TYPE_COPY_OBJECT) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Could not add transfer; meta requests of type %d are not supported.",
+            (void *)engine,
+            (int)transfer->type);
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct s3_transfer *queued_transfer = aws_mem_calloc(engine->allocator, 1, sizeof(struct s3_transfer));
+    queued_transfer->engine = engine;
+    queued_transfer->type = transfer->type;
+    queued_transfer->message = transfer->message;
+    aws_http_message_acquire(transfer->message);
+    queued_transfer->size = transfer->size;
+    queued_transfer->user_data = transfer->user_data;
+
+    if (transfer->filepath.len > 0) {
+        queued_transfer->filepath = aws_string_new_from_cursor(engine->allocator, &transfer->filepath);
+    }
+
+    aws_mutex_lock(&engine->synced_data.lock);
+
+    bool input_ended = engine->synced_data.input_ended;
+
+    if (!input_ended) {
+        aws_linked_list_push_back(&engine->synced_data.queued_transfers, &queued_transfer->node);
+        ++engine->synced_data.num_transfers_queued;
+    }
+
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    if (input_ended) {
+        AWS_LOGF_ERROR(AWS_LS_S3_GENERAL, "id=%p: Could not add transfer; input has ended.", (void *)engine);
+        s_s3_transfer_destroy(queued_transfer);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    s_s3_transfer_engine_update(engine);
+    return AWS_OP_SUCCESS;
+}
+
+static bool s_s3_transfer_engine_has_room_synced(struct aws_s3_transfer_engine *engine) {
+    return engine->synced_data.num_transfers_queued < engine->max_queued_transfers;
+}
+
+static bool s_s3_transfer_engine_has_room_or_finished(void *arg) {
+    struct aws_s3_transfer_engine *engine = arg;
+    return s_s3_transfer_engine_has_room_synced(engine) || engine->synced_data.finished;
+}
+
+void aws_s3_transfer_engine_wait_for_room(struct aws_s3_transfer_engine *engine) {
+    AWS_PRECONDITION(engine);
+
+    aws_mutex_lock(&engine->synced_data.lock);
+    aws_condition_variable_wait_pred(
+        &engine->synced_data.room_signal, &engine->synced_data.lock, s_s3_transfer_engine_has_room_or_finished, engine);
+    aws_mutex_unlock(&engine->synced_data.lock);
+}
+
+int aws_s3_transfer_engine_on_room(
+    struct aws_s3_transfer_engine *engine,
+    aws_s3_transfer_engine_room_fn *room_callback,
+    void *user_data) {
+    AWS_PRECONDITION(engine);
+    AWS_PRECONDITION(room_callback);
+
+    aws_mutex_lock(&engine->synced_data.lock);
+
+    const bool already_waiting = engine->synced_data.room_callback != NULL;
+    const bool has_room = s_s3_transfer_engine_has_room_synced(engine);
+
+    if (!already_waiting && !has_room) {
+        engine->synced_data.room_callback = room_callback;
+        engine->synced_data.room_user_data = user_data;
+    }
+
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    if (already_waiting) {
+        AWS_LOGF_ERROR(
+            AWS_LS_S3_GENERAL, "id=%p: Could not wait for room; a callback is already waiting.", (void *)engine);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    if (has_room) {
+        room_callback(engine, user_data);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_s3_transfer_engine_end_input(struct aws_s3_transfer_engine *engine) {
+    AWS_PRECONDITION(engine);
+
+    aws_mutex_lock(&engine->synced_data.lock);
+    engine->synced_data.input_ended = true;
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    s_s3_transfer_engine_update(engine);
+}
+
+static uint64_t s_s3_meta_request_num_bytes_transferred(struct aws_s3_meta_request *meta_request) {
+    struct aws_s3_meta_request_metrics metrics;
+    aws_s3_meta_request_get_metrics(meta_request, &metrics);
+    return metrics.num_bytes_transferred;
+}
+
+void aws_s3_transfer_engine_get_stats(
+    struct aws_s3_transfer_engine *engine,
+    struct aws_s3_transfer_engine_stats *out_stats) {
+    AWS_PRECONDITION(engine);
+    AWS_PRECONDITION(out_stats);
+
+    AWS_ZERO_STRUCT(*out_stats);
+
+    aws_mutex_lock(&engine->synced_data.lock);
+
+    out_stats->num_transfers_queued = engine->synced_data.num_transfers_queued;
+    out_stats->num_transfers_active = engine->synced_data.num_transfers_active;
+    out_stats->num_transfers_succeeded = engine->synced_data.num_transfers_succeeded;
+    out_stats->num_transfers_failed = engine->synced_data.num_transfers_failed;
+    out_stats->num_bytes_transferred = engine->synced_data.num_bytes_transferred;
+
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&engine->synced_data.active_transfers);
+         node != aws_linked_list_end(&engine->synced_data.active_transfers);
+         node = aws_linked_list_next(node)) {
+        struct s3_transfer *transfer = AWS_CONTAINER_OF(node, struct s3_transfer, node);
+
+        if (transfer->meta_request != NULL) {
+            out_stats->num_bytes_transferred += s_s3_meta_request_num_bytes_transferred(transfer->meta_request);
+        }
+    }
+
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+    out_stats->elapsed_ns = now_ns - engine->start_timestamp_ns;
+
+    uint64_t elapsed_ms = aws_timestamp_convert(out_stats->elapsed_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+
+    if (elapsed_ms > 0) {
+        out_stats->bytes_per_second = aws_mul_u64_saturating(out_stats->num_bytes_transferred, 1000) / elapsed_ms;
+    }
+}
+
+/* Record that a transfer is done, and pass it on. Its meta request, if it got one, has finished. */
+static void s_s3_transfer_finished(
+    struct s3_transfer *transfer,
+    const struct aws_s3_meta_request_result *result,
+    uint64_t num_bytes_transferred) {
+
+    struct aws_s3_transfer_engine *engine = transfer->engine;
+
+    aws_mutex_lock(&engine->synced_data.lock);
+
+    aws_linked_list_remove(&transfer->node);
+    --engine->synced_data.num_transfers_active;
+    engine->synced_data.num_bytes_transferred += num_bytes_transferred;
+
+    if (result->error_code == AWS_ERROR_SUCCESS) {
+        ++engine->synced_data.num_transfers_succeeded;
+    } else {
+        ++engine->synced_data.num_transfers_failed;
+
+        if (engine->synced_data.error_code == AWS_ERROR_SUCCESS) {
+            engine->synced_data.error_code = result->error_code;
+        }
+    }
+
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    if (result->error_code != AWS_ERROR_SUCCESS) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_S3_GENERAL,
+            "id=%p: Transfer failed with error %d (%s), response status %d.",
+            (void *)engine,
+            result->error_code,
+            aws_error_str(result->error_code),
+            result->response_status);
+    }
+
+    if (engine->transfer_finish_callback != NULL) {
+        engine->transfer_finish_callback(engine, transfer->user_data, result, engine->user_data);
+    }
+}
+
+static void s_s3_transfer_meta_request_finish_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_meta_request_result *meta_request_result,
+    void *user_data) {
+
+    struct s3_transfer *transfer = user_data;
+    struct aws_s3_transfer_engine *engine = transfer->engine;
+
+    /* The engine can otherwise finish, and go away, as soon as this transfer stops being active. */
+    aws_s3_transfer_engine_acquire(engine);
+
+    s_s3_transfer_finished(transfer, meta_request_result, s_s3_meta_request_num_bytes_transferred(meta_request));
+
+    aws_mutex_lock(&engine->synced_data.lock);
+    transfer->finished = true;
+    const bool destroy = transfer->meta_request != NULL;
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    /* Otherwise the meta request is still being made, and the transfer is destroyed once it has been. */
+    if (destroy) {
+        s_s3_transfer_destroy(transfer);
+    }
+
+    /* The reference returned by aws_s3_client_make_meta_request. */
+    aws_s3_meta_request_release(meta_request);
+
+    s_s3_transfer_engine_update(engine);
+    aws_s3_transfer_engine_release(engine);
+}
+
+/* Make the meta request of a transfer that got its turn. A transfer whose meta request can't be made fails right
+ * away. */
+static void s_s3_transfer_start(struct s3_transfer *transfer) {
+    struct aws_s3_transfer_engine *engine = transfer->engine;
+
+    const bool is_small_object = transfer->size > 0 && transfer->size <= engine->client->part_size;
+
+    struct aws_s3_meta_request_options meta_request_options = {
+        .type = transfer->type,
+        .signing_config = engine->signing_config,
+        .message = transfer->message,
+        .user_data = transfer,
+        .finish_callback = s_s3_transfer_meta_request_finish_callback,
+        .small_object_hint = is_small_object,
+    };
+
+    if (transfer->filepath != NULL) {
+        struct aws_byte_cursor filepath = aws_byte_cursor_from_string(transfer->filepath);
+
+        if (transfer->type == AWS_S3_META_REQUEST_TYPE_PUT_OBJECT) {
+            meta_request_options.send_filepath = filepath;
+        } else if (transfer->type == AWS_S3_META_REQUEST_TYPE_GET_OBJECT) {
+            meta_request_options.recv_filepath = filepath;
+            meta_request_options.recv_file_preallocate = !is_small_object;
+        }
+    }
+
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_client_make_meta_request(engine->client, &meta_request_options);
+
+    if (meta_request == NULL) {
+        struct aws_s3_meta_request_result result = {.error_code = aws_last_error_or_unknown()};
+        s_s3_transfer_finished(transfer, &result, 0);
+        s_s3_transfer_destroy(transfer);
+        return;
+    }
+
+    aws_mutex_lock(&engine->synced_data.lock);
+    const bool destroy = transfer->finished;
+
+    if (!destroy) {
+        transfer->meta_request = meta_request;
+    }
+
+    aws_mutex_unlock(&engine->synced_data.lock);
+
+    if (destroy) {
+        s_s3_transfer_destroy(transfer);
+    }
+}
+
+/* Start the transfers that get their turn, one at a time, make room for producers, and finish once everything is
+ * done. */
+static void s_s3_transfer_engine_update(struct aws_s3_transfer_engine *engine) {
+    aws_s3_transfer_engine_acquire(engine);
+
+    while (true) {
+        struct s3_transfer *transfer = NULL;
+        aws_s3_transfer_engine_room_fn *room_callback = NULL;
+        void *room_user_data = NULL;
+
+        aws_mutex_lock(&engine->synced_data.lock);
+
+        if (engine->synced_data.num_transfers_active < engine->max_active_transfers &&
+            !aws_linked_list_empty(&engine->synced_data.queued_transfers)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&engine->synced_data.queued_transfers);
+            --engine->synced_data.num_transfers_queued;
+
+            /* Transfers are active until they are done, including while their meta request is being made. */
+            aws_linked_list_push_back(&engine->synced_data.active_transfers, node);
+            ++engine->synced_data.num_transfers_active;
+
+            transfer = AWS_CONTAINER_OF(node, struct s3_transfer, node);
+        }
+
+        const bool has_room = s_s3_transfer_engine_has_room_synced(engine);
+
+        if (has_room && engine->synced_data.room_callback != NULL) {
+            room_callback = engine->synced_data.room_callback;
+            room_user_data = engine->synced_data.room_user_data;
+            engine->synced_data.room_callback = NULL;
+            engine->synced_data.room_user_data = NULL;
+        }
+
+        const bool finish = engine->synced_data.input_ended && !engine->synced_data.finished &&
+                            engine->synced_data.num_transfers_queued == 0 &&
+                            engine->synced_data.num_transfers_active == 0;
+
+        if (finish) {
+            engine->synced_data.finished = true;
+        }
+
+        const int error_code = engine->synced_data.error_code;
+
+        aws_mutex_unlock(&engine->synced_data.lock);
+
+        if (has_room || finish) {
+            aws_condition_variable_notify_all(&engine->synced_data.room_signal);
+        }
+
+        if (room_callback != NULL) {
+            room_callback(engine, room_user_data);
+        }
+
+        if (finish) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_S3_GENERAL,
+                "id=%p: Transfer engine finished with error code %d (%s).",
+                (void *)engine,
+                error_code,
+                aws_error_str(error_code));
+
+            if (engine->finish_callback != NULL) {
+                engine->finish_callback(engine, error_code, engine->user_data);
+            }
+
+            /* Release the reference that kept the engine alive while transfers ran. */
+            aws_s3_transfer_engine_release(engine);
+            break;
+        }
+
+        if (transfer == NULL) {
+            break;
+        }
+
+        s_s3_transfer_start(transfer);
+    }
+
+    aws_s3_transfer_engine_release(engine);
+}
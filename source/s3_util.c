@@ -6,6 +6,8 @@
 #include "aws/s3/private/s3_util.h"
 #include "aws/s3/private/s3_client_impl.h"
 #include <aws/auth/credentials.h>
+#include <aws/common/array_list.h>
+#include <aws/common/math.h>
 #include <aws/common/string.h>
 #include <aws/common/xml_parser.h>
 #include <aws/http/request_response.h>
@@ -22,11 +24,23 @@ const struct aws_byte_cursor g_s3_client_version = AWS_BYTE_CUR_INIT_FROM_STRING
 const struct aws_byte_cursor g_s3_service_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("s3");
 const struct aws_byte_cursor g_host_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Host");
 const struct aws_byte_cursor g_range_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Range");
+const struct aws_byte_cursor g_if_match_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("If-Match");
+const struct aws_byte_cursor g_if_none_match_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("If-None-Match");
+const struct aws_byte_cursor g_checksum_algorithm_header_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-algorithm");
+const struct aws_byte_cursor g_checksum_mode_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-checksum-mode");
 const struct aws_byte_cursor g_etag_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("ETag");
 const struct aws_byte_cursor g_content_range_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Content-Range");
 const struct aws_byte_cursor g_content_type_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Content-Type");
 const struct aws_byte_cursor g_content_length_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Content-Length");
 const struct aws_byte_cursor g_content_md5_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Content-MD5");
+const struct aws_byte_cursor g_content_encoding_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Content-Encoding");
+const struct aws_byte_cursor g_decoded_content_length_header_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-decoded-content-length");
+const struct aws_byte_cursor g_trailer_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-trailer");
+const struct aws_byte_cursor g_aws_chunked_content_encoding = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("aws-chunked");
+const struct aws_byte_cursor g_s3_signed_body_value_streaming_unsigned_payload_trailer =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("STREAMING-UNSIGNED-PAYLOAD-TRAILER");
 const struct aws_byte_cursor g_accept_ranges_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("accept-ranges");
 const struct aws_byte_cursor g_acl_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("x-amz-acl");
 const struct aws_byte_cursor g_post_method = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("POST");
@@ -39,6 +53,7 @@ const struct aws_byte_cursor g_user_agent_header_product_name =
 
 const uint32_t g_s3_max_num_upload_parts = 10000;
 const size_t g_s3_min_upload_part_size = MB_TO_BYTES(5);
+const uint64_t g_s3_max_upload_part_size = 5ULL * 1024 * 1024 * 1024;
 
 void copy_http_headers(const struct aws_http_headers *src, struct aws_http_headers *dest) {
     AWS_PRECONDITION(src);
@@ -168,7 +183,7 @@ struct aws_cached_signing_config_aws *aws_cached_signing_config_new(
 
     AWS_ASSERT(aws_byte_cursor_is_valid(&signing_config->signed_body_value));
 
-    if (signing_config->service.len > 0) {
+    if (signing_config->signed_body_value.len > 0) {
         cached_signing_config->signed_body_value =
             aws_string_new_from_cursor(allocator, &signing_config->signed_body_value);
 
@@ -405,6 +420,100 @@ int aws_s3_parse_content_length_response_header(
     return result;
 }
 
+static bool s_is_range_header_whitespace(uint8_t value) {
+    return value == ' ' || value == '\t';
+}
+
+/* Parse the decimal number at the front of the cursor, if there is one, advancing the cursor past it. Fails if the
+ * number doesn't fit in 64 bits. */
+static int s_parse_range_header_number(struct aws_byte_cursor *cursor, bool *out_has_number, uint64_t *out_number) {
+    uint64_t number = 0;
+    size_t num_digits = 0;
+
+    while (num_digits < cursor->len && cursor->ptr[num_digits] >= '0' && cursor->ptr[num_digits] <= '9') {
+        uint64_t digit = (uint64_t)(cursor->ptr[num_digits] - '0');
+
+        if (number > (UINT64_MAX - digit) / 10) {
+            return aws_raise_error(AWS_ERROR_S3_INVALID_RANGE_HEADER);
+        }
+
+        number = number * 10 + digit;
+        ++num_digits;
+    }
+
+    aws_byte_cursor_advance(cursor, num_digits);
+
+    *out_has_number = num_digits > 0;
+    *out_number = number;
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_s3_parse_request_range_header(
+    struct aws_http_headers *request_headers,
+    bool *out_has_start_range,
+    bool *out_has_end_range,
+    uint64_t *out_start_range,
+    uint64_t *out_end_range) {
+    AWS_PRECONDITION(request_headers);
+    AWS_PRECONDITION(out_has_start_range);
+    AWS_PRECONDITION(out_has_end_range);
+    AWS_PRECONDITION(out_start_range);
+    AWS_PRECONDITION(out_end_range);
+
+    struct aws_byte_cursor range_header_value;
+
+    if (aws_http_headers_get(request_headers, g_range_header_name, &range_header_value)) {
+        return aws_raise_error(AWS_ERROR_S3_INVALID_RANGE_HEADER);
+    }
+
+    range_header_value = aws_byte_cursor_trim_pred(&range_header_value, s_is_range_header_whitespace);
+
+    /* Expected format of the header is "bytes=StartByte-EndByte", where either side (but not both) can be left out. */
+    const struct aws_byte_cursor bytes_prefix = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("bytes=");
+
+    if (!aws_byte_cursor_starts_with_ignore_case(&range_header_value, &bytes_prefix)) {
+        return aws_raise_error(AWS_ERROR_S3_INVALID_RANGE_HEADER);
+    }
+
+    aws_byte_cursor_advance(&range_header_value, bytes_prefix.len);
+
+    if (memchr(range_header_value.ptr, ',', range_header_value.len) != NULL) {
+        return aws_raise_error(AWS_ERROR_S3_MULTIRANGE_HEADER_UNSUPPORTED);
+    }
+
+    bool has_start_range = false;
+    bool has_end_range = false;
+    uint64_t start_range = 0;
+    uint64_t end_range = 0;
+
+    if (s_parse_range_header_number(&range_header_value, &has_start_range, &start_range)) {
+        return AWS_OP_ERR;
+    }
+
+    if (range_header_value.len == 0 || *range_header_value.ptr != '-') {
+        return aws_raise_error(AWS_ERROR_S3_INVALID_RANGE_HEADER);
+    }
+
+    aws_byte_cursor_advance(&range_header_value, 1);
+
+    if (s_parse_range_header_number(&range_header_value, &has_end_range, &end_range)) {
+        return AWS_OP_ERR;
+    }
+
+    if (range_header_value.len > 0 || (!has_start_range && !has_end_range) ||
+        (has_start_range && has_end_range && start_range > end_range) || (!has_start_range && end_range == 0)) {
+        return aws_raise_error(AWS_ERROR_S3_INVALID_RANGE_HEADER);
+    }
+
+    *out_has_start_range = has_start_range;
+    *out_has_end_range = has_end_range;
+    *out_start_range = start_range;
+    *out_end_range = end_range;
+
+    return AWS_OP_SUCCESS;
+}
+
 uint32_t aws_s3_get_num_parts(size_t part_size, uint64_t object_range_start, uint64_t object_range_end) {
     if ((object_range_start - object_range_end) == 0ULL) {
         return 0;
@@ -477,3 +586,181 @@ void aws_s3_get_part_range(
         *out_part_range_end = object_range_end;
     }
 }
+
+uint32_t aws_s3_get_num_parts_for_schedule(
+    const struct aws_s3_part_size_schedule *schedule,
+    uint64_t object_range_start,
+    uint64_t object_range_end) {
+    AWS_PRECONDITION(schedule);
+    AWS_PRECONDITION(schedule->first_part_size > 0);
+    AWS_PRECONDITION(schedule->part_size > 0);
+    AWS_PRECONDITION(schedule->num_parts_per_step > 0);
+
+    AWS_ASSERT(object_range_start <= object_range_end);
+
+    uint64_t range_size = object_range_end - object_range_start + 1;
+
+    if (range_size <= schedule->first_part_size) {
+        return 1;
+    }
+
+    uint64_t remaining_size = range_size - schedule->first_part_size;
+    uint64_t num_parts = 1;
+    uint64_t part_size = aws_min_u64(schedule->part_size, schedule->max_part_size);
+
+    /* Walk the steps where parts are still growing. There are only ever a few dozen of them. */
+    while (part_size < schedule->max_part_size) {
+        uint64_t step_size = part_size * schedule->num_parts_per_step;
+
+        if (remaining_size <= step_size) {
+            break;
+        }
+
+        remaining_size -= step_size;
+        num_parts += schedule->num_parts_per_step;
+        part_size = aws_min_u64(part_size * 2, schedule->max_part_size);
+    }
+
+    num_parts += remaining_size / part_size;
+
+    if ((remaining_size % part_size) > 0) {
+        ++num_parts;
+    }
+
+    AWS_ASSERT(num_parts <= UINT32_MAX);
+    return (uint32_t)num_parts;
+}
+
+void aws_s3_get_part_range_for_schedule(
+    const struct aws_s3_part_size_schedule *schedule,
+    uint64_t object_range_start,
+    uint64_t object_range_end,
+    uint32_t part_number,
+    uint64_t *out_part_range_start,
+    uint64_t *out_part_range_end) {
+    AWS_PRECONDITION(schedule);
+    AWS_PRECONDITION(out_part_range_start);
+    AWS_PRECONDITION(out_part_range_end);
+
+    AWS_ASSERT(part_number > 0);
+
+    if (part_number == 1) {
+        *out_part_range_start = object_range_start;
+        *out_part_range_end = object_range_start + schedule->first_part_size - 1;
+    } else {
+        uint64_t part_start = object_range_start + schedule->first_part_size;
+        uint64_t part_index = part_number - 2;
+        uint64_t part_size = aws_min_u64(schedule->part_size, schedule->max_part_size);
+
+        /* Skip over the steps that come entirely before this part. */
+        while (part_size < schedule->max_part_size && part_index >= schedule->num_parts_per_step) {
+            part_start += part_size * schedule->num_parts_per_step;
+            part_index -= schedule->num_parts_per_step;
+            part_size = aws_min_u64(part_size * 2, schedule->max_part_size);
+        }
+
+        *out_part_range_start = part_start + part_index * part_size;
+        *out_part_range_end = *out_part_range_start + part_size - 1;
+    }
+
+    /* Cap the part's range end using the object's range end. An open ended range may not fit in 64 bits. */
+    if (*out_part_range_end > object_range_end || *out_part_range_end < *out_part_range_start) {
+        *out_part_range_end = object_range_end;
+    }
+}
+
+static int s_compare_byte_range_starts(const void *a, const void *b) {
+    const struct aws_s3_byte_range *range_a = a;
+    const struct aws_s3_byte_range *range_b = b;
+
+    if (range_a->start < range_b->start) {
+        return -1;
+    }
+
+    return range_a->start > range_b->start ? 1 : 0;
+}
+
+static uint64_t s_div_round_up_u64(uint64_t numerator, uint64_t denominator) {
+    return numerator / denominator + ((numerator % denominator) > 0 ? 1 : 0);
+}
+
+uint64_t aws_s3_calculate_copy_part_size(uint64_t object_size, uint64_t min_part_size, uint32_t target_num_parts) {
+    const uint64_t one_mb = MB_TO_BYTES(1);
+
+    uint64_t part_size = min_part_size;
+
+    if (target_num_parts > 0) {
+        part_size = aws_max_u64(part_size, s_div_round_up_u64(object_size, target_num_parts));
+    }
+
+    part_size = aws_max_u64(part_size, s_div_round_up_u64(object_size, g_s3_max_num_upload_parts));
+    part_size = aws_max_u64(s_div_round_up_u64(part_size, one_mb) * one_mb, one_mb);
+
+    return aws_min_u64(part_size, g_s3_max_upload_part_size);
+}
+
+void aws_s3_merge_byte_ranges(struct aws_array_list *byte_ranges) {
+    aws_s3_coalesce_byte_ranges(byte_ranges, 0);
+}
+
+void aws_s3_coalesce_byte_ranges(struct aws_array_list *byte_ranges, uint64_t max_gap) {
+    AWS_PRECONDITION(byte_ranges);
+
+    aws_array_list_sort(byte_ranges, s_compare_byte_range_starts);
+
+    size_t num_merged_ranges = 0;
+
+    for (size_t i = 0; i < aws_array_list_length(byte_ranges); ++i) {
+        struct aws_s3_byte_range range;
+        aws_array_list_get_at(byte_ranges, &range, i);
+
+        if (num_merged_ranges > 0) {
+            struct aws_s3_byte_range *last_range = NULL;
+            aws_array_list_get_at_ptr(byte_ranges, (void **)&last_range, num_merged_ranges - 1);
+
+            if (last_range->end == UINT64_MAX || range.start <= last_range->end + 1 ||
+                range.start - last_range->end - 1 <= max_gap) {
+                last_range->end = aws_max_u64(last_range->end, range.end);
+                continue;
+            }
+        }
+
+        aws_array_list_set_at(byte_ranges, &range, num_merged_ranges);
+        ++num_merged_ranges;
+    }
+
+    while (aws_array_list_length(byte_ranges) > num_merged_ranges) {
+        aws_array_list_pop_back(byte_ranges);
+    }
+}
+
+bool aws_s3_byte_ranges_cover(const struct aws_array_list *byte_ranges, uint64_t range_start, uint64_t range_end) {
+    AWS_PRECONDITION(byte_ranges);
+
+    /* Find the last range starting at or before the range. As merged ranges don't touch, the range is only covered if
+     * that one reaches its end. */
+    size_t low = 0;
+    size_t high = aws_array_list_length(byte_ranges);
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+
+        struct aws_s3_byte_range byte_range;
+        aws_array_list_get_at(byte_ranges, &byte_range, mid);
+
+        if (byte_range.start <= range_start) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == 0) {
+        return false;
+    }
+
+    struct aws_s3_byte_range byte_range;
+    aws_array_list_get_at(byte_ranges, &byte_range, low - 1);
+
+    return byte_range.end >= range_end;
+}
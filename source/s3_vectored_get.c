@@ -0,0 +1,300 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/s3/private/s3_request_messages.h>
+#include <aws/s3/private/s3_util.h>
+#include <aws/s3/private/s3_vectored_get.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/mutex.h>
+#include <aws/common/ref_count.h>
+#include <aws/http/request_response.h>
+
+#include <inttypes.h>
+
+/* A run of coalesced ranges, fetched by one meta request. */
+struct s3_vectored_get_span {
+    struct aws_s3_vectored_get *vectored_get;
+    struct aws_s3_byte_range range;
+    struct aws_s3_meta_request *meta_request;
+};
+
+struct aws_s3_vectored_get {
+    struct aws_allocator *allocator;
+    struct aws_s3_client *client;
+
+    /* The ranges asked for (struct aws_s3_byte_range), in the order they were passed in. */
+    struct aws_array_list ranges;
+
+    /* Spans (struct s3_vectored_get_span), in ascending order. Set up before any meta request is made, and not changed
+     * after, apart from the meta request of each span, which is protected by the lock. */
+    struct aws_array_list spans;
+
+    aws_s3_vectored_get_range_body_fn *range_body_callback;
+    aws_s3_vectored_get_finish_fn *finish_callback;
+    void *user_data;
+
+    struct aws_ref_count ref_count;
+
+    struct {
+        struct aws_mutex lock;
+
+        size_t num_spans_finished;
+
+        /* Error and response status of the first span that failed. */
+        int error_code;
+        int response_status;
+    } synced_data;
+};
+
+static void s_s3_vectored_get_ref_count_zero_callback(void *arg) {
+    struct aws_s3_vectored_get *vectored_get = arg;
+
+    for (size_t span_index = 0; span_index < aws_array_list_length(&vectored_get->spans); ++span_index) {
+        struct s3_vectored_get_span *span = NULL;
+        aws_array_list_get_at_ptr(&vectored_get->spans, (void **)&span, span_index);
+
+        aws_s3_meta_request_release(span->meta_request);
+    }
+
+    aws_array_list_clean_up(&vectored_get->spans);
+    aws_array_list_clean_up(&vectored_get->ranges);
+    aws_mutex_clean_up(&vectored_get->synced_data.lock);
+    aws_s3_client_release(vectored_get->client);
+    aws_mem_release(vectored_get->allocator, vectored_get);
+}
+
+void aws_s3_vectored_get_acquire(struct aws_s3_vectored_get *vectored_get) {
+    AWS_FATAL_PRECONDITION(vectored_get);
+    aws_ref_count_acquire(&vectored_get->ref_count);
+}
+
+void aws_s3_vectored_get_release(struct aws_s3_vectored_get *vectored_get) {
+    if (vectored_get) {
+        aws_ref_count_release(&vectored_get->ref_count);
+    }
+}
+
+void aws_s3_vectored_get_cancel(struct aws_s3_vectored_get *vectored_get) {
+    AWS_PRECONDITION(vectored_get);
+
+    aws_mutex_lock(&vectored_get->synced_data.lock);
+
+    for (size_t span_index = 0; span_index < aws_array_list_length(&vectored_get->spans); ++span_index) {
+        struct s3_vectored_get_span *span = NULL;
+        aws_array_list_get_at_ptr(&vectored_get->spans, (void **)&span, span_index);
+
+        if (span->meta_request != NULL) {
+            aws_s3_meta_request_cancel(span->meta_request);
+        }
+    }
+
+    aws_mutex_unlock(&vectored_get->synced_data.lock);
+}
+
+/* Hand the bytes of a span that arrived over to every range they are part of. The bytes between ranges are dropped. */
+static int s_s3_vectored_get_span_body_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_byte_cursor *body,
+    uint64_t range_start,
+    void *user_data) {
+    (void)meta_request;
+
+    struct s3_vectored_get_span *span = user_data;
+    struct aws_s3_vectored_get *vectored_get = span->vectored_get;
+
+    if (vectored_get->range_body_callback == NULL || body->len == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    const uint64_t body_end = range_start + body->len - 1;
+
+    for (size_t range_index = 0; range_index < aws_array_list_length(&vectored_get->ranges); ++range_index) {
+        struct aws_s3_byte_range range;
+        aws_array_list_get_at(&vectored_get->ranges, &range, range_index);
+
+        if (range.end < range_start || range.start > body_end) {
+            continue;
+        }
+
+        uint64_t slice_start = aws_max_u64(range.start, range_start);
+        uint64_t slice_end = aws_min_u64(range.end, body_end);
+
+        struct aws_byte_cursor slice = {
+            .ptr = body->ptr + (slice_start - range_start),
+            .len = (size_t)(slice_end - slice_start + 1),
+        };
+
+        if (vectored_get->range_body_callback(
+                vectored_get, range_index, &slice, slice_start, vectored_get->user_data)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Record that n spans are done, and finish the vectored get once they all are. */
+static void s_s3_vectored_get_spans_finished(
+    struct aws_s3_vectored_get *vectored_get,
+    size_t n,
+    int error_code,
+    int response_status) {
+    bool cancel_others = false;
+    bool finished = false;
+
+    aws_mutex_lock(&vectored_get->synced_data.lock);
+
+    if (error_code != AWS_ERROR_SUCCESS && vectored_get->synced_data.error_code == AWS_ERROR_SUCCESS) {
+        vectored_get->synced_data.error_code = error_code;
+        vectored_get->synced_data.response_status = response_status;
+        cancel_others = true;
+    }
+
+    vectored_get->synced_data.num_spans_finished += n;
+    finished = vectored_get->synced_data.num_spans_finished == aws_array_list_length(&vectored_get->spans);
+
+    int final_error_code = vectored_get->synced_data.error_code;
+    int final_response_status = vectored_get->synced_data.response_status;
+
+    aws_mutex_unlock(&vectored_get->synced_data.lock);
+
+    /* There is no point in fetching the other spans once any of them failed. */
+    if (cancel_others && !finished) {
+        aws_s3_vectored_get_cancel(vectored_get);
+    }
+
+    if (finished) {
+        if (vectored_get->finish_callback != NULL) {
+            vectored_get->finish_callback(
+                vectored_get, final_error_code, final_response_status, vectored_get->user_data);
+        }
+
+        /* Release the reference that kept the vectored get alive while its meta requests ran. */
+        aws_s3_vectored_get_release(vectored_get);
+    }
+}
+
+static void s_s3_vectored_get_span_finish_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_meta_request_result *meta_request_result,
+    void *user_data) {
+    (void)meta_request;
+
+    struct s3_vectored_get_span *span = user_data;
+
+    s_s3_vectored_get_spans_finished(
+        span->vectored_get, 1, meta_request_result->error_code, meta_request_result->response_status);
+}
+
+struct aws_s3_vectored_get *aws_s3_vectored_get_new(
+    struct aws_allocator *allocator,
+    const struct aws_s3_vectored_get_options *options) {
+    AWS_PRECONDITION(allocator);
+    AWS_PRECONDITION(options);
+    AWS_PRECONDITION(options->client);
+    AWS_PRECONDITION(options->message);
+
+    if (options->num_ranges == 0 || options->ranges == NULL) {
+        AWS_LOGF_ERROR(AWS_LS_S3_GENERAL, "Could not create vectored get; no ranges were given.");
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    for (size_t range_index = 0; range_index < options->num_ranges; ++range_index) {
+        if (options->ranges[range_index].start > options->ranges[range_index].end) {
+            AWS_LOGF_ERROR(
+                AWS_LS_S3_GENERAL,
+                "Could not create vectored get; range %zu ends (%" PRIu64 ") before it starts (%" PRIu64 ").",
+                range_index,
+                options->ranges[range_index].end,
+                options->ranges[range_index].start);
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            return NULL;
+        }
+    }
+
+    struct aws_s3_vectored_get *vectored_get = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_vectored_get));
+    vectored_get->allocator = allocator;
+    vectored_get->client = options->client;
+    aws_s3_client_acquire(options->client);
+    vectored_get->range_body_callback = options->range_body_callback;
+    vectored_get->finish_callback = options->finish_callback;
+    vectored_get->user_data = options->user_data;
+
+    aws_ref_count_init(&vectored_get->ref_count, vectored_get, s_s3_vectored_get_ref_count_zero_callback);
+    aws_mutex_init(&vectored_get->synced_data.lock);
+
+    aws_array_list_init_dynamic(
+        &vectored_get->ranges, allocator, options->num_ranges, sizeof(struct aws_s3_byte_range));
+    aws_array_list_init_dynamic(&vectored_get->spans, allocator, 0, sizeof(struct s3_vectored_get_span));
+
+    struct aws_array_list span_ranges;
+    aws_array_list_init_dynamic(&span_ranges, allocator, options->num_ranges, sizeof(struct aws_s3_byte_range));
+
+    for (size_t range_index = 0; range_index < options->num_ranges; ++range_index) {
+        aws_array_list_push_back(&vectored_get->ranges, &options->ranges[range_index]);
+        aws_array_list_push_back(&span_ranges, &options->ranges[range_index]);
+    }
+
+    aws_s3_coalesce_byte_ranges(&span_ranges, options->max_coalesce_gap);
+
+    for (size_t span_index = 0; span_index < aws_array_list_length(&span_ranges); ++span_index) {
+        struct s3_vectored_get_span span = {.vectored_get = vectored_get};
+        aws_array_list_get_at(&span_ranges, &span.range, span_index);
+        aws_array_list_push_back(&vectored_get->spans, &span);
+    }
+
+    aws_array_list_clean_up(&span_ranges);
+
+    const size_t num_spans = aws_array_list_length(&vectored_get->spans);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_S3_GENERAL,
+        "id=%p: Vectored get of %zu ranges coalesced into %zu spans.",
+        (void *)vectored_get,
+        options->num_ranges,
+        num_spans);
+
+    /* One reference for the caller, and one for the meta requests while they run. */
+    aws_ref_count_acquire(&vectored_get->ref_count);
+
+    for (size_t span_index = 0; span_index < num_spans; ++span_index) {
+        struct s3_vectored_get_span *span = NULL;
+        aws_array_list_get_at_ptr(&vectored_get->spans, (void **)&span, span_index);
+
+        struct aws_http_message *message =
+            aws_s3_ranged_get_object_message_new(allocator, options->message, span->range.start, span->range.end);
+
+        struct aws_s3_meta_request *meta_request = NULL;
+
+        if (message != NULL) {
+            struct aws_s3_meta_request_options meta_request_options = {
+                .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+                .signing_config = options->signing_config,
+                .message = message,
+                .user_data = span,
+                .body_callback = s_s3_vectored_get_span_body_callback,
+                .finish_callback = s_s3_vectored_get_span_finish_callback,
+            };
+
+            meta_request = aws_s3_client_make_meta_request(options->client, &meta_request_options);
+            aws_http_message_release(message);
+        }
+
+        /* The spans that didn't get a meta request are done right away, failing the vectored get, and the ones that
+         * did are canceled. */
+        if (meta_request == NULL) {
+            s_s3_vectored_get_spans_finished(vectored_get, num_spans - span_index, aws_last_error_or_unknown(), 0);
+            break;
+        }
+
+        aws_mutex_lock(&vectored_get->synced_data.lock);
+        span->meta_request = meta_request;
+        aws_mutex_unlock(&vectored_get->synced_data.lock);
+    }
+
+    return vectored_get;
+}
@@ -0,0 +1,316 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_vip_balancer.h"
+
+#include <aws/common/clock.h>
+#include <aws/common/string.h>
+
+/* Requests smaller than this are dominated by latency rather than bandwidth, and are not used to measure throughput. */
+static const uint64_t s_min_throughput_sample_bytes = 1024 * 1024;
+
+/* Weight of the latest sample in the moving averages. */
+static const double s_moving_average_weight = 0.2;
+
+/* A VIP is only judged once this many requests have been sampled for it, so that a few unlucky requests don't get it
+ * evicted. */
+static const uint32_t s_min_samples_for_eviction = 8;
+
+/* A VIP is slow if its throughput is below this fraction of the median throughput of its peers. */
+static const double s_slow_throughput_ratio = 0.5;
+
+/* A VIP is failing if more than this fraction of its requests fail. */
+static const double s_max_error_rate = 0.5;
+
+/* How long an evicted VIP stays out of rotation before it gets another chance. */
+static const uint64_t s_eviction_duration_secs = 30;
+
+/* Max number of peers looked at to compute the median throughput. */
+#define AWS_S3_VIP_BALANCER_MAX_MEDIAN_SAMPLES 64
+
+struct aws_s3_vip_balancer *aws_s3_vip_balancer_new(struct aws_allocator *allocator) {
+    AWS_PRECONDITION(allocator);
+
+    struct aws_s3_vip_balancer *balancer = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_vip_balancer));
+    balancer->allocator = allocator;
+
+    if (aws_mutex_init(&balancer->synced_data.lock)) {
+        goto error_clean_up;
+    }
+
+    if (aws_array_list_init_dynamic(
+            &balancer->synced_data.vips, allocator, 8, sizeof(struct aws_s3_balanced_vip *))) {
+        aws_mutex_clean_up(&balancer->synced_data.lock);
+        goto error_clean_up;
+    }
+
+    return balancer;
+
+error_clean_up:
+
+    aws_mem_release(allocator, balancer);
+    return NULL;
+}
+
+void aws_s3_vip_balancer_destroy(struct aws_s3_vip_balancer *balancer) {
+    if (balancer == NULL) {
+        return;
+    }
+
+    for (size_t vip_index = 0; vip_index < aws_array_list_length(&balancer->synced_data.vips); ++vip_index) {
+        struct aws_s3_balanced_vip *vip = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &vip, vip_index);
+
+        aws_string_destroy(vip->address);
+        aws_mem_release(balancer->allocator, vip);
+    }
+
+    aws_array_list_clean_up(&balancer->synced_data.vips);
+    aws_mutex_clean_up(&balancer->synced_data.lock);
+    aws_mem_release(balancer->allocator, balancer);
+}
+
+static struct aws_s3_balanced_vip *s_s3_vip_balancer_find_vip_synced(
+    struct aws_s3_vip_balancer *balancer,
+    struct aws_byte_cursor address) {
+
+    for (size_t vip_index = 0; vip_index < aws_array_list_length(&balancer->synced_data.vips); ++vip_index) {
+        struct aws_s3_balanced_vip *vip = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &vip, vip_index);
+
+        if (aws_string_eq_byte_cursor(vip->address, &address)) {
+            return vip;
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns true if connections can be handed out for the VIP, re-admitting it with a clean slate if its eviction is
+ * over. */
+static bool s_s3_vip_balancer_is_vip_usable_synced(struct aws_s3_balanced_vip *vip, uint64_t now_ns) {
+    if (vip->evicted_until_ns == 0) {
+        return true;
+    }
+
+    if (now_ns < vip->evicted_until_ns) {
+        return false;
+    }
+
+    vip->evicted_until_ns = 0;
+    vip->num_samples = 0;
+    vip->num_throughput_samples = 0;
+    vip->throughput = 0.0;
+    vip->error_rate = 0.0;
+
+    return true;
+}
+
+bool aws_s3_vip_balancer_has_vip(struct aws_s3_vip_balancer *balancer, struct aws_byte_cursor address) {
+    AWS_PRECONDITION(balancer);
+
+    aws_mutex_lock(&balancer->synced_data.lock);
+    bool has_vip = s_s3_vip_balancer_find_vip_synced(balancer, address) != NULL;
+    aws_mutex_unlock(&balancer->synced_data.lock);
+
+    return has_vip;
+}
+
+int aws_s3_vip_balancer_add_vip(struct aws_s3_vip_balancer *balancer, struct aws_byte_cursor address, void *user_data) {
+    AWS_PRECONDITION(balancer);
+
+    int result = AWS_OP_SUCCESS;
+
+    aws_mutex_lock(&balancer->synced_data.lock);
+
+    if (s_s3_vip_balancer_find_vip_synced(balancer, address) == NULL) {
+        struct aws_s3_balanced_vip *vip = aws_mem_calloc(balancer->allocator, 1, sizeof(struct aws_s3_balanced_vip));
+        vip->address = aws_string_new_from_cursor(balancer->allocator, &address);
+        vip->user_data = user_data;
+
+        if (aws_array_list_push_back(&balancer->synced_data.vips, &vip)) {
+            aws_string_destroy(vip->address);
+            aws_mem_release(balancer->allocator, vip);
+            result = AWS_OP_ERR;
+        }
+    }
+
+    aws_mutex_unlock(&balancer->synced_data.lock);
+
+    return result;
+}
+
+size_t aws_s3_vip_balancer_get_num_usable_vips(struct aws_s3_vip_balancer *balancer, uint64_t now_ns) {
+    AWS_PRECONDITION(balancer);
+
+    size_t num_usable_vips = 0;
+
+    aws_mutex_lock(&balancer->synced_data.lock);
+
+    for (size_t vip_index = 0; vip_index < aws_array_list_length(&balancer->synced_data.vips); ++vip_index) {
+        struct aws_s3_balanced_vip *vip = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &vip, vip_index);
+
+        if (s_s3_vip_balancer_is_vip_usable_synced(vip, now_ns)) {
+            ++num_usable_vips;
+        }
+    }
+
+    aws_mutex_unlock(&balancer->synced_data.lock);
+
+    return num_usable_vips;
+}
+
+struct aws_s3_balanced_vip *aws_s3_vip_balancer_acquire_vip(struct aws_s3_vip_balancer *balancer, uint64_t now_ns) {
+    AWS_PRECONDITION(balancer);
+
+    struct aws_s3_balanced_vip *selected_vip = NULL;
+
+    aws_mutex_lock(&balancer->synced_data.lock);
+
+    size_t num_vips = aws_array_list_length(&balancer->synced_data.vips);
+
+    for (size_t i = 0; i < num_vips; ++i) {
+        size_t vip_index = (balancer->synced_data.next_vip_index + i) % num_vips;
+
+        struct aws_s3_balanced_vip *vip = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &vip, vip_index);
+
+        if (!s_s3_vip_balancer_is_vip_usable_synced(vip, now_ns)) {
+            continue;
+        }
+
+        if (selected_vip == NULL || vip->num_active_connections < selected_vip->num_active_connections) {
+            selected_vip = vip;
+        }
+    }
+
+    if (selected_vip != NULL) {
+        ++selected_vip->num_active_connections;
+        balancer->synced_data.next_vip_index = (balancer->synced_data.next_vip_index + 1) % num_vips;
+    }
+
+    aws_mutex_unlock(&balancer->synced_data.lock);
+
+    return selected_vip;
+}
+
+/* Returns true if the VIP's throughput is well below the median throughput of its peers. */
+static bool s_s3_vip_balancer_is_vip_slow_synced(
+    struct aws_s3_vip_balancer *balancer,
+    struct aws_s3_balanced_vip *vip) {
+    if (vip->num_throughput_samples < s_min_samples_for_eviction) {
+        return false;
+    }
+
+    double peer_throughputs[AWS_S3_VIP_BALANCER_MAX_MEDIAN_SAMPLES];
+    size_t num_peers = 0;
+
+    for (size_t vip_index = 0; vip_index < aws_array_list_length(&balancer->synced_data.vips) &&
+                               num_peers < AWS_S3_VIP_BALANCER_MAX_MEDIAN_SAMPLES;
+         ++vip_index) {
+        struct aws_s3_balanced_vip *peer = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &peer, vip_index);
+
+        if (peer == vip || peer->evicted_until_ns != 0 || peer->num_throughput_samples < s_min_samples_for_eviction) {
+            continue;
+        }
+
+        /* Insertion sort, there are only ever a handful of peers. */
+        size_t insert_index = num_peers++;
+
+        while (insert_index > 0 && peer_throughputs[insert_index - 1] > peer->throughput) {
+            peer_throughputs[insert_index] = peer_throughputs[insert_index - 1];
+            --insert_index;
+        }
+
+        peer_throughputs[insert_index] = peer->throughput;
+    }
+
+    if (num_peers == 0) {
+        return false;
+    }
+
+    double median_throughput = peer_throughputs[num_peers / 2];
+
+    return vip->throughput < median_throughput * s_slow_throughput_ratio;
+}
+
+void aws_s3_vip_balancer_release_vip(
+    struct aws_s3_vip_balancer *balancer,
+    struct aws_s3_balanced_vip *vip,
+    bool failed,
+    uint64_t num_bytes,
+    uint64_t duration_ns,
+    uint64_t now_ns) {
+    AWS_PRECONDITION(balancer);
+    AWS_PRECONDITION(vip);
+
+    aws_mutex_lock(&balancer->synced_data.lock);
+
+    AWS_ASSERT(vip->num_active_connections > 0);
+    --vip->num_active_connections;
+
+    /* Samples from requests that started before an eviction say nothing about the VIP after it is re-admitted. */
+    if (vip->evicted_until_ns != 0) {
+        goto unlock;
+    }
+
+    double error_sample = failed ? 1.0 : 0.0;
+    vip->error_rate = vip->num_samples == 0
+                          ? error_sample
+                          : vip->error_rate + s_moving_average_weight * (error_sample - vip->error_rate);
+    ++vip->num_samples;
+
+    if (!failed && num_bytes >= s_min_throughput_sample_bytes && duration_ns > 0) {
+        double duration_secs = (double)duration_ns / (double)AWS_TIMESTAMP_NANOS;
+        double throughput_sample = (double)num_bytes / duration_secs;
+
+        vip->throughput = vip->num_throughput_samples == 0
+                              ? throughput_sample
+                              : vip->throughput + s_moving_average_weight * (throughput_sample - vip->throughput);
+        ++vip->num_throughput_samples;
+    }
+
+    bool failing = vip->num_samples >= s_min_samples_for_eviction && vip->error_rate > s_max_error_rate;
+
+    if (!failing && !s_s3_vip_balancer_is_vip_slow_synced(balancer, vip)) {
+        goto unlock;
+    }
+
+    /* Never evict so many VIPs that most of the endpoint's capacity is gone; if that many are bad, the problem is more
+     * likely on our side than on theirs. */
+    size_t num_vips = aws_array_list_length(&balancer->synced_data.vips);
+    size_t num_evicted_vips = 0;
+
+    for (size_t vip_index = 0; vip_index < num_vips; ++vip_index) {
+        struct aws_s3_balanced_vip *peer = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &peer, vip_index);
+
+        if (!s_s3_vip_balancer_is_vip_usable_synced(peer, now_ns)) {
+            ++num_evicted_vips;
+        }
+    }
+
+    if ((num_evicted_vips + 1) * 2 > num_vips) {
+        goto unlock;
+    }
+
+    vip->evicted_until_ns =
+        now_ns + aws_timestamp_convert(s_eviction_duration_secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+    AWS_LOGF_INFO(
+        AWS_LS_S3_ENDPOINT,
+        "id=%p: Evicting VIP %s for %d seconds for being %s (throughput %f bytes/s, error rate %f).",
+        (void *)balancer,
+        (const char *)vip->address->bytes,
+        (int)s_eviction_duration_secs,
+        failing ? "unreliable" : "slow",
+        vip->throughput,
+        vip->error_rate);
+
+unlock:
+    aws_mutex_unlock(&balancer->synced_data.lock);
+}
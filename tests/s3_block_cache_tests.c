@@ -0,0 +1,123 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_block_cache.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+/* Test that blocks are read back per ETag, that only whole blocks are kept, and that putting a block of another ETag
+ * drops the blocks of the old one. */
+AWS_TEST_CASE(test_s3_block_cache_read_write, s_test_s3_block_cache_read_write)
+static int s_test_s3_block_cache_read_write(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_block_cache *block_cache = aws_s3_block_cache_new(allocator, 4, 64);
+    ASSERT_NOT_NULL(block_cache);
+
+    struct aws_byte_cursor object_id = aws_byte_cursor_from_c_str("bucket.s3.amazonaws.com/key");
+    struct aws_byte_cursor etag = aws_byte_cursor_from_c_str("\"etag1\"");
+    struct aws_byte_cursor new_etag = aws_byte_cursor_from_c_str("\"etag2\"");
+
+    /* A 10 byte object is cut into blocks of 4, 4 and 2 bytes. */
+    ASSERT_UINT_EQUALS(3, aws_s3_block_cache_num_blocks(block_cache, 10));
+
+    ASSERT_SUCCESS(
+        aws_s3_block_cache_put_block(block_cache, object_id, etag, 10, 0, aws_byte_cursor_from_c_str("abcd")));
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id, etag, 10, 2, aws_byte_cursor_from_c_str("ij")));
+
+    /* Blocks that aren't the size the object says they are, or that are past its end, are left out. */
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id, etag, 10, 1, aws_byte_cursor_from_c_str("ef")));
+    ASSERT_SUCCESS(
+        aws_s3_block_cache_put_block(block_cache, object_id, etag, 10, 3, aws_byte_cursor_from_c_str("klmn")));
+    ASSERT_UINT_EQUALS(6, block_cache->synced_data.num_bytes);
+
+    struct aws_byte_buf etag_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&etag_buf, allocator, 0));
+    uint64_t object_size = 0;
+    ASSERT_TRUE(aws_s3_block_cache_get_object(block_cache, object_id, &etag_buf, &object_size));
+    ASSERT_BIN_ARRAYS_EQUALS(etag.ptr, etag.len, etag_buf.buffer, etag_buf.len);
+    ASSERT_UINT_EQUALS(10, object_size);
+
+    struct aws_byte_buf dest;
+    ASSERT_SUCCESS(aws_byte_buf_init(&dest, allocator, 0));
+
+    ASSERT_TRUE(aws_s3_block_cache_read_block(block_cache, object_id, etag, 0, 1, 3, &dest));
+    ASSERT_TRUE(aws_s3_block_cache_read_block(block_cache, object_id, etag, 2, 0, 2, &dest));
+    ASSERT_BIN_ARRAYS_EQUALS("bcdij", 5, dest.buffer, dest.len);
+
+    /* Missing blocks, bytes past the end of a block, and blocks of another ETag can't be read. */
+    ASSERT_FALSE(aws_s3_block_cache_read_block(block_cache, object_id, etag, 1, 0, 4, &dest));
+    ASSERT_FALSE(aws_s3_block_cache_read_block(block_cache, object_id, etag, 2, 1, 2, &dest));
+    ASSERT_FALSE(aws_s3_block_cache_read_block(block_cache, object_id, new_etag, 0, 0, 4, &dest));
+    ASSERT_UINT_EQUALS(5, dest.len);
+
+    /* The object changed. */
+    ASSERT_SUCCESS(
+        aws_s3_block_cache_put_block(block_cache, object_id, new_etag, 8, 1, aws_byte_cursor_from_c_str("5678")));
+    ASSERT_FALSE(aws_s3_block_cache_read_block(block_cache, object_id, etag, 0, 0, 4, &dest));
+    ASSERT_UINT_EQUALS(4, block_cache->synced_data.num_bytes);
+
+    aws_byte_buf_reset(&etag_buf, false);
+    ASSERT_TRUE(aws_s3_block_cache_get_object(block_cache, object_id, &etag_buf, &object_size));
+    ASSERT_BIN_ARRAYS_EQUALS(new_etag.ptr, new_etag.len, etag_buf.buffer, etag_buf.len);
+    ASSERT_UINT_EQUALS(8, object_size);
+
+    aws_s3_block_cache_invalidate_object(block_cache, object_id);
+    ASSERT_FALSE(aws_s3_block_cache_get_object(block_cache, object_id, &etag_buf, &object_size));
+    ASSERT_UINT_EQUALS(0, block_cache->synced_data.num_bytes);
+
+    aws_byte_buf_clean_up(&dest);
+    aws_byte_buf_clean_up(&etag_buf);
+    aws_s3_block_cache_destroy(block_cache);
+
+    return 0;
+}
+
+/* Test that the least recently used blocks are evicted once the blocks take up more than the byte budget, and that an
+ * object is forgotten once all of its blocks are. */
+AWS_TEST_CASE(test_s3_block_cache_eviction, s_test_s3_block_cache_eviction)
+static int s_test_s3_block_cache_eviction(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_block_cache *block_cache = aws_s3_block_cache_new(allocator, 4, 12);
+    ASSERT_NOT_NULL(block_cache);
+
+    struct aws_byte_cursor object_id_a = aws_byte_cursor_from_c_str("host/a");
+    struct aws_byte_cursor object_id_b = aws_byte_cursor_from_c_str("host/b");
+    struct aws_byte_cursor etag = aws_byte_cursor_from_c_str("\"etag\"");
+    struct aws_byte_cursor block = aws_byte_cursor_from_c_str("0123");
+
+    struct aws_byte_buf dest;
+    ASSERT_SUCCESS(aws_byte_buf_init(&dest, allocator, 0));
+
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id_a, etag, 16, 0, block));
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id_a, etag, 16, 1, block));
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id_b, etag, 4, 0, block));
+    ASSERT_UINT_EQUALS(12, block_cache->synced_data.num_bytes);
+
+    /* Reading block 0 of a makes block 1 of a the least recently used. */
+    ASSERT_TRUE(aws_s3_block_cache_read_block(block_cache, object_id_a, etag, 0, 0, 4, &dest));
+
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id_a, etag, 16, 2, block));
+    ASSERT_UINT_EQUALS(12, block_cache->synced_data.num_bytes);
+    ASSERT_FALSE(aws_s3_block_cache_read_block(block_cache, object_id_a, etag, 1, 0, 4, &dest));
+    ASSERT_TRUE(aws_s3_block_cache_read_block(block_cache, object_id_a, etag, 2, 0, 4, &dest));
+
+    /* Then b is the least recently used, and goes away altogether. */
+    ASSERT_SUCCESS(aws_s3_block_cache_put_block(block_cache, object_id_a, etag, 16, 3, block));
+    ASSERT_FALSE(aws_s3_block_cache_read_block(block_cache, object_id_b, etag, 0, 0, 4, &dest));
+
+    struct aws_byte_buf etag_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&etag_buf, allocator, 0));
+    uint64_t object_size = 0;
+    ASSERT_FALSE(aws_s3_block_cache_get_object(block_cache, object_id_b, &etag_buf, &object_size));
+    ASSERT_TRUE(aws_s3_block_cache_get_object(block_cache, object_id_a, &etag_buf, &object_size));
+
+    aws_byte_buf_clean_up(&etag_buf);
+    aws_byte_buf_clean_up(&dest);
+    aws_s3_block_cache_destroy(block_cache);
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_buffer_pool.h"
+
+#include <aws/common/byte_buf.h>
+#include <aws/testing/aws_test_harness.h>
+
+/* Test that slab sized buffers are recycled, and that other sizes are not. */
+AWS_TEST_CASE(test_s3_buffer_pool_recycle, s_test_s3_buffer_pool_recycle)
+static int s_test_s3_buffer_pool_recycle(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const size_t slab_size = 1024;
+    const size_t max_free_slabs = 1;
+
+    struct aws_s3_buffer_pool *buffer_pool = aws_s3_buffer_pool_new(allocator, slab_size, 0, max_free_slabs);
+    ASSERT_NOT_NULL(buffer_pool);
+
+    struct aws_byte_buf buf0;
+    ASSERT_SUCCESS(aws_s3_buffer_pool_acquire_buffer(buffer_pool, slab_size, &buf0));
+    ASSERT_TRUE(buf0.capacity == slab_size);
+    ASSERT_TRUE(buf0.len == 0);
+
+    struct aws_byte_buf buf1;
+    ASSERT_SUCCESS(aws_s3_buffer_pool_acquire_buffer(buffer_pool, slab_size, &buf1));
+
+    uint8_t *buf0_memory = buf0.buffer;
+
+    aws_s3_buffer_pool_release_buffer(buffer_pool, &buf0);
+    ASSERT_NULL(buf0.buffer);
+    ASSERT_TRUE(aws_array_list_length(&buffer_pool->synced_data.free_slabs) == 1);
+
+    /* Free list is full, so this buffer is freed. */
+    aws_s3_buffer_pool_release_buffer(buffer_pool, &buf1);
+    ASSERT_NULL(buf1.buffer);
+    ASSERT_TRUE(aws_array_list_length(&buffer_pool->synced_data.free_slabs) == max_free_slabs);
+
+    /* The next slab sized buffer re-uses the recycled memory. */
+    ASSERT_SUCCESS(aws_s3_buffer_pool_acquire_buffer(buffer_pool, slab_size, &buf0));
+    ASSERT_TRUE(buf0.buffer == buf0_memory);
+    ASSERT_UINT_EQUALS(0, (uintptr_t)buf0.buffer % AWS_S3_BUFFER_POOL_ALIGNMENT);
+    ASSERT_TRUE(aws_array_list_length(&buffer_pool->synced_data.free_slabs) == 0);
+
+    /* A grown buffer is no longer a slab, and is cleaned up instead of recycled. */
+    struct aws_byte_cursor data = aws_byte_cursor_from_c_str("data");
+
+    for (size_t i = 0; i < (slab_size / data.len) + 1; ++i) {
+        ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&buf0, &data));
+    }
+
+    ASSERT_TRUE(buf0.capacity > slab_size);
+    aws_s3_buffer_pool_release_buffer(buffer_pool, &buf0);
+    ASSERT_TRUE(aws_array_list_length(&buffer_pool->synced_data.free_slabs) == 0);
+
+    /* Buffers of other sizes are never recycled. */
+    struct aws_byte_buf small_buf;
+    ASSERT_SUCCESS(aws_s3_buffer_pool_acquire_buffer(buffer_pool, slab_size / 2, &small_buf));
+    ASSERT_TRUE(small_buf.capacity == slab_size / 2);
+    ASSERT_UINT_EQUALS(0, (uintptr_t)small_buf.buffer % AWS_S3_BUFFER_POOL_ALIGNMENT);
+    aws_s3_buffer_pool_release_buffer(buffer_pool, &small_buf);
+    ASSERT_TRUE(aws_array_list_length(&buffer_pool->synced_data.free_slabs) == 0);
+
+    aws_s3_buffer_pool_destroy(buffer_pool);
+
+    return 0;
+}
+
+/* Test that reservations are bounded by the memory limit, but that a first reservation is always allowed. */
+AWS_TEST_CASE(test_s3_buffer_pool_memory_limit, s_test_s3_buffer_pool_memory_limit)
+static int s_test_s3_buffer_pool_memory_limit(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const size_t slab_size = 1024;
+
+    struct aws_s3_buffer_pool *buffer_pool = aws_s3_buffer_pool_new(allocator, slab_size, slab_size * 2, 2);
+    ASSERT_NOT_NULL(buffer_pool);
+
+    ASSERT_TRUE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size));
+    ASSERT_TRUE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size));
+    ASSERT_TRUE(aws_s3_buffer_pool_get_reserved(buffer_pool) == slab_size * 2);
+
+    /* A failed reservation reserves nothing. */
+    ASSERT_FALSE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size));
+    ASSERT_TRUE(aws_s3_buffer_pool_get_reserved(buffer_pool) == slab_size * 2);
+
+    aws_s3_buffer_pool_release_reservation(buffer_pool, slab_size);
+
+    /* Only what fits under the limit can be reserved, so a buffer bigger than a slab may not fit where a slab does. */
+    ASSERT_FALSE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size + 1));
+    ASSERT_TRUE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size));
+
+    aws_s3_buffer_pool_release_reservation(buffer_pool, slab_size * 2);
+    ASSERT_TRUE(aws_s3_buffer_pool_get_reserved(buffer_pool) == 0);
+
+    /* With nothing reserved, even a reservation bigger than the limit is allowed through. */
+    ASSERT_TRUE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size * 4));
+    aws_s3_buffer_pool_release_reservation(buffer_pool, slab_size * 4);
+
+    aws_s3_buffer_pool_destroy(buffer_pool);
+
+    /* A limit of 0 means there is no limit. */
+    buffer_pool = aws_s3_buffer_pool_new(allocator, slab_size, 0, 0);
+    ASSERT_NOT_NULL(buffer_pool);
+
+    ASSERT_TRUE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size * 1024));
+    ASSERT_TRUE(aws_s3_buffer_pool_try_reserve(buffer_pool, slab_size * 1024));
+    aws_s3_buffer_pool_release_reservation(buffer_pool, slab_size * 2048);
+
+    aws_s3_buffer_pool_destroy(buffer_pool);
+
+    return 0;
+}
+
+/* Test that buffers, what they grow into, and the pool's own aligned allocator all come from the pool's allocator, and
+ * that a buffer released after the pool is destroyed is still returned to it. */
+AWS_TEST_CASE(test_s3_buffer_pool_uses_allocator, s_test_s3_buffer_pool_uses_allocator)
+static int s_test_s3_buffer_pool_uses_allocator(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const size_t slab_size = 1024;
+
+    struct aws_allocator *tracer = aws_mem_tracer_new(allocator, NULL, AWS_MEMTRACE_BYTES, 0);
+    ASSERT_NOT_NULL(tracer);
+
+    struct aws_s3_buffer_pool *buffer_pool = aws_s3_buffer_pool_new(tracer, slab_size, 0, 1);
+    ASSERT_NOT_NULL(buffer_pool);
+
+    size_t pool_bytes = aws_mem_tracer_bytes(tracer);
+
+    struct aws_byte_buf buf;
+    ASSERT_SUCCESS(aws_s3_buffer_pool_acquire_buffer(buffer_pool, slab_size, &buf));
+    ASSERT_TRUE(aws_mem_tracer_bytes(tracer) >= pool_bytes + slab_size);
+
+    /* Growing the buffer allocates from the same allocator. */
+    struct aws_byte_cursor data = aws_byte_cursor_from_c_str("data");
+
+    for (size_t i = 0; i < (slab_size / data.len) + 1; ++i) {
+        ASSERT_SUCCESS(aws_byte_buf_append_dynamic(&buf, &data));
+    }
+
+    ASSERT_UINT_EQUALS(0, (uintptr_t)buf.buffer % AWS_S3_BUFFER_POOL_ALIGNMENT);
+    ASSERT_TRUE(aws_mem_tracer_bytes(tracer) >= pool_bytes + buf.capacity);
+
+    /* The buffer outlives the pool, and can still be grown and released. */
+    aws_s3_buffer_pool_destroy(buffer_pool);
+
+    size_t capacity = buf.capacity;
+    ASSERT_SUCCESS(aws_byte_buf_reserve(&buf, capacity * 2));
+    ASSERT_TRUE(aws_mem_tracer_bytes(tracer) >= capacity * 2);
+
+    aws_byte_buf_clean_up(&buf);
+    ASSERT_UINT_EQUALS(0, aws_mem_tracer_bytes(tracer));
+
+    aws_mem_tracer_destroy(tracer);
+
+    return 0;
+}
@@ -0,0 +1,454 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_auto_ranged_put.h"
+#include "aws/s3/private/s3_checksums.h"
+#include "aws/s3/private/s3_chunk_stream.h"
+#include "aws/s3/private/s3_gather_stream.h"
+#include "aws/s3/private/s3_request_messages.h"
+#include "aws/s3/private/s3_util.h"
+#include <aws/common/byte_buf.h>
+#include <aws/common/string.h>
+#include <aws/http/request_response.h>
+#include <aws/io/stream.h>
+#include <aws/testing/aws_test_harness.h>
+
+static const char *s_checksum_test_input = "123456789";
+
+struct checksum_test_vector {
+    enum aws_s3_checksum_algorithm algorithm;
+    const char *expected_base64;
+};
+
+/* Checksums of "123456789", the usual check value of CRCs. */
+static const struct checksum_test_vector s_checksum_test_vectors[] = {
+    {AWS_SCA_CRC32C, "4waSgw=="},
+    {AWS_SCA_CRC32, "y/Q5Jg=="},
+    {AWS_SCA_SHA1, "98O8HYCOBHMq32eZZczDTKeuNEE="},
+    {AWS_SCA_SHA256, "FeKw08M4keuw8e9gnsQZQgwg4yDOlMZfvIwzEkSOsiU="},
+};
+
+/* Test that each algorithm computes the checksum S3 expects, and that feeding the input in pieces gives the same
+ * result. */
+AWS_TEST_CASE(test_s3_checksum_compute, s_test_s3_checksum_compute)
+static int s_test_s3_checksum_compute(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    struct aws_byte_cursor input = aws_byte_cursor_from_c_str(s_checksum_test_input);
+
+    const uint8_t crc32c_bytes[] = {0xE3, 0x06, 0x92, 0x83};
+    uint8_t digest[AWS_SHA256_LEN];
+    struct aws_byte_buf digest_buf = aws_byte_buf_from_empty_array(digest, sizeof(digest));
+    ASSERT_SUCCESS(aws_s3_checksum_compute(allocator, AWS_SCA_CRC32C, &input, &digest_buf));
+    ASSERT_BIN_ARRAYS_EQUALS(crc32c_bytes, sizeof(crc32c_bytes), digest_buf.buffer, digest_buf.len);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_checksum_test_vectors); ++i) {
+        const struct checksum_test_vector *vector = &s_checksum_test_vectors[i];
+
+        struct aws_byte_buf encoded;
+        ASSERT_SUCCESS(aws_byte_buf_init(&encoded, allocator, 0));
+        ASSERT_SUCCESS(aws_s3_checksum_compute_base64(allocator, vector->algorithm, &input, &encoded));
+        ASSERT_CURSOR_VALUE_CSTRING_EQUALS(aws_byte_cursor_from_buf(&encoded), vector->expected_base64);
+        aws_byte_buf_clean_up(&encoded);
+
+        struct aws_s3_checksum *checksum = aws_s3_checksum_new(allocator, vector->algorithm);
+        ASSERT_NOT_NULL(checksum);
+        ASSERT_UINT_EQUALS(aws_s3_checksum_get_digest_size(vector->algorithm), checksum->digest_size);
+
+        struct aws_byte_cursor remaining = input;
+
+        while (remaining.len > 0) {
+            struct aws_byte_cursor piece = aws_byte_cursor_advance(&remaining, remaining.len > 4 ? 4 : remaining.len);
+            ASSERT_SUCCESS(aws_s3_checksum_update(checksum, &piece));
+        }
+
+        uint8_t streamed_digest[AWS_SHA256_LEN];
+        struct aws_byte_buf streamed_digest_buf =
+            aws_byte_buf_from_empty_array(streamed_digest, sizeof(streamed_digest));
+        ASSERT_SUCCESS(aws_s3_checksum_finalize(checksum, &streamed_digest_buf));
+        ASSERT_UINT_EQUALS(checksum->digest_size, streamed_digest_buf.len);
+
+        digest_buf.len = 0;
+        ASSERT_SUCCESS(aws_s3_checksum_compute(allocator, vector->algorithm, &input, &digest_buf));
+        ASSERT_BIN_ARRAYS_EQUALS(digest_buf.buffer, digest_buf.len, streamed_digest, streamed_digest_buf.len);
+
+        /* A finalized checksum can't be used anymore. */
+        ASSERT_FAILS(aws_s3_checksum_update(checksum, &input));
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+        aws_s3_checksum_destroy(checksum);
+    }
+
+    ASSERT_NULL(aws_s3_checksum_new(allocator, AWS_SCA_NONE));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    aws_s3_library_clean_up();
+
+    return 0;
+}
+
+static struct aws_http_message *s_checksum_test_put_message_new(struct aws_allocator *allocator) {
+    struct aws_http_message *message = aws_http_message_new_request(allocator);
+
+    if (message == NULL) {
+        return NULL;
+    }
+
+    struct aws_http_header host_header = {
+        .name = g_host_header_name,
+        .value = aws_byte_cursor_from_c_str("dummy_host"),
+    };
+
+    /* A checksum of the whole object doesn't apply to its parts. */
+    struct aws_http_header checksum_header = {
+        .name = aws_byte_cursor_from_c_str("x-amz-checksum-crc32c"),
+        .value = aws_byte_cursor_from_c_str("AAAAAA=="),
+    };
+
+    if (aws_http_message_set_request_method(message, aws_http_method_put) ||
+        aws_http_message_set_request_path(message, aws_byte_cursor_from_c_str("/dummy_key")) ||
+        aws_http_message_add_header(message, host_header) || aws_http_message_add_header(message, checksum_header)) {
+        aws_http_message_release(message);
+        return NULL;
+    }
+
+    return message;
+}
+
+/* Test that the requests of a multipart upload carry the checksums of the parts. */
+AWS_TEST_CASE(test_s3_checksum_multipart_messages, s_test_s3_checksum_multipart_messages)
+static int s_test_s3_checksum_multipart_messages(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    struct aws_http_message *base_message = s_checksum_test_put_message_new(allocator);
+    ASSERT_NOT_NULL(base_message);
+
+    struct aws_string *upload_id = aws_string_new_from_c_str(allocator, "dummy_upload_id");
+    struct aws_byte_cursor header_value;
+
+    /* The upload is created for the algorithm. */
+    struct aws_http_message *create_message =
+        aws_s3_create_multipart_upload_message_new(allocator, base_message, AWS_SCA_CRC32C);
+    ASSERT_NOT_NULL(create_message);
+    struct aws_http_headers *headers = aws_http_message_get_headers(create_message);
+    ASSERT_SUCCESS(aws_http_headers_get(headers, g_checksum_algorithm_header_name, &header_value));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(header_value, "CRC32C");
+    aws_http_message_release(create_message);
+
+    /* Each part gets a header with its own checksum, which is also handed back for the complete request. */
+    struct aws_byte_buf part_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init_copy_from_cursor(
+        &part_buffer, allocator, aws_byte_cursor_from_c_str(s_checksum_test_input)));
+
+    struct aws_byte_buf encoded_checksum;
+    ASSERT_SUCCESS(aws_byte_buf_init(&encoded_checksum, allocator, 0));
+
+    struct aws_http_message *part_message_template = aws_s3_upload_part_message_template_new(allocator, base_message);
+    ASSERT_NOT_NULL(part_message_template);
+
+    struct aws_http_message *part_message = aws_s3_upload_part_message_new(
+        allocator, part_message_template, &part_buffer, 1, upload_id, false, AWS_SCA_CRC32C, &encoded_checksum);
+    ASSERT_NOT_NULL(part_message);
+    aws_http_message_release(part_message_template);
+    headers = aws_http_message_get_headers(part_message);
+    ASSERT_SUCCESS(aws_http_headers_get(headers, aws_byte_cursor_from_c_str("x-amz-checksum-crc32c"), &header_value));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(header_value, "4waSgw==");
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(aws_byte_cursor_from_buf(&encoded_checksum), "4waSgw==");
+
+    aws_input_stream_destroy(aws_http_message_get_body_stream(part_message));
+    aws_http_message_release(part_message);
+
+    /* The complete request lists the checksum of every part. */
+    struct aws_array_list etags;
+    struct aws_array_list checksums;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&etags, allocator, 1, sizeof(struct aws_string *)));
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&checksums, allocator, 1, sizeof(struct aws_string *)));
+
+    struct aws_string *etag = aws_string_new_from_c_str(allocator, "etag1");
+    struct aws_string *checksum = aws_string_new_from_buf(allocator, &encoded_checksum);
+    ASSERT_SUCCESS(aws_array_list_push_back(&etags, &etag));
+    ASSERT_SUCCESS(aws_array_list_push_back(&checksums, &checksum));
+
+    struct aws_byte_buf body_buffer;
+    ASSERT_SUCCESS(aws_byte_buf_init(&body_buffer, allocator, 64));
+
+    struct aws_http_message *complete_message = aws_s3_complete_multipart_message_new(
+        allocator, base_message, &body_buffer, upload_id, &etags, &checksums, AWS_SCA_CRC32C);
+    ASSERT_NOT_NULL(complete_message);
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_buf(&body_buffer);
+    struct aws_byte_cursor expected_element = aws_byte_cursor_from_c_str("<ChecksumCRC32C>4waSgw==</ChecksumCRC32C>");
+    struct aws_byte_cursor found;
+    ASSERT_SUCCESS(aws_byte_cursor_find_exact(&body, &expected_element, &found));
+
+    aws_input_stream_destroy(aws_http_message_get_body_stream(complete_message));
+    aws_http_message_release(complete_message);
+
+    aws_byte_buf_clean_up(&body_buffer);
+    aws_string_destroy(etag);
+    aws_string_destroy(checksum);
+    aws_array_list_clean_up(&etags);
+    aws_array_list_clean_up(&checksums);
+    aws_byte_buf_clean_up(&encoded_checksum);
+    aws_byte_buf_clean_up(&part_buffer);
+    aws_string_destroy(upload_id);
+    aws_http_message_release(base_message);
+
+    aws_s3_library_clean_up();
+
+    return 0;
+}
+
+/* Test that resume tokens carry the checksum algorithm and the checksums of the uploaded parts. */
+AWS_TEST_CASE(test_s3_checksum_resume_token, s_test_s3_checksum_resume_token)
+static int s_test_s3_checksum_resume_token(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_auto_ranged_put_resume_token resume_token;
+    ASSERT_SUCCESS(aws_s3_auto_ranged_put_resume_token_parse(
+        allocator,
+        aws_byte_cursor_from_c_str("version 1\nupload_id dummy_upload_id\npart_size 8\ntotal_num_parts 3\n"
+                                   "checksum_algorithm CRC32\npart 2 etag2\npart_checksum 2 y/Q5Jg==\n"),
+        &resume_token));
+
+    ASSERT_INT_EQUALS(AWS_SCA_CRC32, resume_token.checksum_algorithm);
+    ASSERT_UINT_EQUALS(2, aws_array_list_length(&resume_token.checksum_list));
+
+    struct aws_string *checksum = NULL;
+    aws_array_list_get_at(&resume_token.checksum_list, &checksum, 0);
+    ASSERT_NULL(checksum);
+    aws_array_list_get_at(&resume_token.checksum_list, &checksum, 1);
+    ASSERT_TRUE(aws_string_eq_c_str(checksum, "y/Q5Jg=="));
+
+    aws_s3_auto_ranged_put_resume_token_clean_up(&resume_token);
+
+    ASSERT_FAILS(aws_s3_auto_ranged_put_resume_token_parse(
+        allocator,
+        aws_byte_cursor_from_c_str("version 1\nupload_id dummy_upload_id\npart_size 8\ntotal_num_parts 3\n"
+                                   "checksum_algorithm MD4\n"),
+        &resume_token));
+    ASSERT_INT_EQUALS(AWS_ERROR_S3_INVALID_RESUME_TOKEN, aws_last_error());
+
+    return 0;
+}
+
+static int s_read_whole_stream(struct aws_input_stream *stream, size_t read_size, struct aws_byte_buf *out_buf) {
+    uint8_t read_bytes[64];
+    ASSERT_TRUE(read_size <= sizeof(read_bytes));
+
+    struct aws_stream_status status;
+    AWS_ZERO_STRUCT(status);
+
+    while (!status.is_end_of_stream) {
+        struct aws_byte_buf read_buf = aws_byte_buf_from_empty_array(read_bytes, read_size);
+        ASSERT_SUCCESS(aws_input_stream_read(stream, &read_buf));
+
+        struct aws_byte_cursor read_cursor = aws_byte_cursor_from_buf(&read_buf);
+        ASSERT_SUCCESS(aws_byte_buf_append_dynamic(out_buf, &read_cursor));
+        ASSERT_SUCCESS(aws_input_stream_get_status(stream, &status));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that chunk streams encode their body as one aws-chunked chunk followed by a trailer with its checksum, however
+ * they are read, and that their length is known up front. */
+AWS_TEST_CASE(test_s3_chunk_stream, s_test_s3_chunk_stream)
+static int s_test_s3_chunk_stream(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    const char *expected_encoding = "9\r\n123456789\r\n0\r\nx-amz-checksum-crc32c:4waSgw==\r\n\r\n";
+
+    struct aws_input_stream *stream =
+        aws_s3_chunk_stream_new(allocator, aws_byte_cursor_from_c_str(s_checksum_test_input), AWS_SCA_CRC32C);
+    ASSERT_NOT_NULL(stream);
+
+    int64_t length = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_length(stream, &length));
+    ASSERT_INT_EQUALS(strlen(expected_encoding), length);
+    ASSERT_UINT_EQUALS(length, aws_s3_chunk_stream_compute_length(strlen(s_checksum_test_input), AWS_SCA_CRC32C));
+
+    struct aws_byte_buf encoded_checksum;
+    ASSERT_SUCCESS(aws_byte_buf_init(&encoded_checksum, allocator, 0));
+
+    /* The checksum isn't known until the body has been read. */
+    ASSERT_FAILS(aws_s3_chunk_stream_get_checksum(stream, &encoded_checksum));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+    struct aws_byte_buf encoded;
+    ASSERT_SUCCESS(aws_byte_buf_init(&encoded, allocator, 0));
+
+    const size_t read_sizes[] = {1, 5, 64};
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(read_sizes); ++i) {
+        aws_byte_buf_reset(&encoded, false);
+        ASSERT_SUCCESS(aws_input_stream_seek(stream, 0, AWS_SSB_BEGIN));
+        ASSERT_SUCCESS(s_read_whole_stream(stream, read_sizes[i], &encoded));
+        ASSERT_CURSOR_VALUE_CSTRING_EQUALS(aws_byte_cursor_from_buf(&encoded), expected_encoding);
+    }
+
+    ASSERT_SUCCESS(aws_s3_chunk_stream_get_checksum(stream, &encoded_checksum));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(aws_byte_cursor_from_buf(&encoded_checksum), "4waSgw==");
+
+    /* The checksum can't be rewound, so the stream can only start over from the beginning. */
+    ASSERT_FAILS(aws_input_stream_seek(stream, 1, AWS_SSB_BEGIN));
+    aws_input_stream_destroy(stream);
+
+    /* An empty body is only made of the final chunk and the trailer. */
+    stream = aws_s3_chunk_stream_new(allocator, aws_byte_cursor_from_c_str(""), AWS_SCA_SHA256);
+    ASSERT_NOT_NULL(stream);
+
+    aws_byte_buf_reset(&encoded, false);
+    ASSERT_SUCCESS(s_read_whole_stream(stream, 64, &encoded));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(
+        aws_byte_cursor_from_buf(&encoded),
+        "0\r\nx-amz-checksum-sha256:47DEQpj8HBSa+/TImW+5JCeuQeRkm5NMpJWZG3hSuFU=\r\n\r\n");
+    ASSERT_UINT_EQUALS(encoded.len, aws_s3_chunk_stream_compute_length(0, AWS_SCA_SHA256));
+
+    aws_input_stream_destroy(stream);
+    aws_byte_buf_clean_up(&encoded);
+    aws_byte_buf_clean_up(&encoded_checksum);
+
+    aws_s3_library_clean_up();
+
+    return 0;
+}
+
+/* Test that gather streams read their buffers one after the other however they are read or seeked, and that a part
+ * message gathered from them carries the same checksum as one made from a single buffer. */
+AWS_TEST_CASE(test_s3_gather_stream, s_test_s3_gather_stream)
+static int s_test_s3_gather_stream(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    const struct aws_byte_cursor segments[] = {
+        aws_byte_cursor_from_c_str("123"),
+        aws_byte_cursor_from_c_str(""),
+        aws_byte_cursor_from_c_str("4"),
+        aws_byte_cursor_from_c_str("56789"),
+    };
+
+    struct aws_input_stream *stream = aws_s3_gather_stream_new(allocator, segments, AWS_ARRAY_SIZE(segments));
+    ASSERT_NOT_NULL(stream);
+
+    int64_t length = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_length(stream, &length));
+    ASSERT_INT_EQUALS(strlen(s_checksum_test_input), length);
+
+    struct aws_byte_buf gathered;
+    ASSERT_SUCCESS(aws_byte_buf_init(&gathered, allocator, 0));
+
+    const size_t read_sizes[] = {1, 2, 64};
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(read_sizes); ++i) {
+        aws_byte_buf_reset(&gathered, false);
+        ASSERT_SUCCESS(aws_input_stream_seek(stream, 0, AWS_SSB_BEGIN));
+        ASSERT_SUCCESS(s_read_whole_stream(stream, read_sizes[i], &gathered));
+        ASSERT_CURSOR_VALUE_CSTRING_EQUALS(aws_byte_cursor_from_buf(&gathered), s_checksum_test_input);
+    }
+
+    /* Seeking lands in the middle of a buffer. */
+    aws_byte_buf_reset(&gathered, false);
+    ASSERT_SUCCESS(aws_input_stream_seek(stream, -3, AWS_SSB_END));
+    ASSERT_SUCCESS(s_read_whole_stream(stream, 64, &gathered));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(aws_byte_cursor_from_buf(&gathered), "789");
+
+    ASSERT_FAILS(aws_input_stream_seek(stream, 10, AWS_SSB_BEGIN));
+    aws_input_stream_destroy(stream);
+
+    /* The checksum and MD5 of the gathered part are those of the whole body. */
+    struct aws_http_message *part_message_template = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(part_message_template);
+    ASSERT_SUCCESS(aws_http_message_set_request_path(part_message_template, aws_byte_cursor_from_c_str("/key")));
+
+    struct aws_byte_buf body = aws_byte_buf_from_c_str(s_checksum_test_input);
+    struct aws_http_message *messages[2] = {
+        aws_s3_upload_part_message_new(allocator, part_message_template, &body, 1, NULL, true, AWS_SCA_CRC32C, NULL),
+        aws_s3_upload_part_message_new_gathered(
+            allocator, part_message_template, segments, AWS_ARRAY_SIZE(segments), 1, NULL, true, AWS_SCA_CRC32C, NULL),
+    };
+
+    const struct aws_byte_cursor header_names[] = {
+        g_content_md5_header_name,
+        aws_s3_checksum_get_header_name(AWS_SCA_CRC32C),
+        g_content_length_header_name,
+    };
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(header_names); ++i) {
+        struct aws_byte_cursor values[2];
+
+        for (size_t message_index = 0; message_index < AWS_ARRAY_SIZE(messages); ++message_index) {
+            ASSERT_NOT_NULL(messages[message_index]);
+            ASSERT_SUCCESS(aws_http_headers_get(
+                aws_http_message_get_headers(messages[message_index]), header_names[i], &values[message_index]));
+        }
+
+        ASSERT_BIN_ARRAYS_EQUALS(values[0].ptr, values[0].len, values[1].ptr, values[1].len);
+    }
+
+    for (size_t message_index = 0; message_index < AWS_ARRAY_SIZE(messages); ++message_index) {
+        aws_input_stream_destroy(aws_http_message_get_body_stream(messages[message_index]));
+        aws_http_message_release(messages[message_index]);
+    }
+
+    aws_http_message_release(part_message_template);
+    aws_byte_buf_clean_up(&gathered);
+
+    aws_s3_library_clean_up();
+
+    return 0;
+}
+
+/* Test that messages with an aws-chunked body get the headers that describe it. */
+AWS_TEST_CASE(test_s3_chunked_body_message, s_test_s3_chunked_body_message)
+static int s_test_s3_chunked_body_message(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    struct aws_http_message *message = s_checksum_test_put_message_new(allocator);
+    ASSERT_NOT_NULL(message);
+
+    struct aws_http_header content_encoding_header = {
+        .name = g_content_encoding_header_name,
+        .value = aws_byte_cursor_from_c_str("gzip"),
+    };
+    ASSERT_SUCCESS(aws_http_message_add_header(message, content_encoding_header));
+
+    struct aws_byte_buf body;
+    ASSERT_SUCCESS(
+        aws_byte_buf_init_copy_from_cursor(&body, allocator, aws_byte_cursor_from_c_str(s_checksum_test_input)));
+
+    struct aws_input_stream *stream = aws_s3_message_util_assign_chunked_body(allocator, &body, AWS_SCA_CRC32, message);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_PTR_EQUALS(stream, aws_http_message_get_body_stream(message));
+
+    struct aws_http_headers *headers = aws_http_message_get_headers(message);
+    struct aws_byte_cursor header_value;
+
+    ASSERT_SUCCESS(aws_http_headers_get(headers, g_content_length_header_name, &header_value));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(header_value, "50");
+    ASSERT_SUCCESS(aws_http_headers_get(headers, g_decoded_content_length_header_name, &header_value));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(header_value, "9");
+    ASSERT_SUCCESS(aws_http_headers_get(headers, g_content_encoding_header_name, &header_value));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(header_value, "aws-chunked,gzip");
+    ASSERT_SUCCESS(aws_http_headers_get(headers, g_trailer_header_name, &header_value));
+    ASSERT_CURSOR_VALUE_CSTRING_EQUALS(header_value, "x-amz-checksum-crc32");
+
+    aws_input_stream_destroy(stream);
+    aws_http_message_release(message);
+    aws_byte_buf_clean_up(&body);
+
+    aws_s3_library_clean_up();
+
+    return 0;
+}
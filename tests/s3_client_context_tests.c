@@ -0,0 +1,489 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_client_context.h"
+#include "aws/s3/private/s3_client_impl.h"
+#include "aws/s3/private/s3_meta_request_impl.h"
+#include "aws/s3/private/s3_mock_transport.h"
+#include "s3_tester.h"
+
+#include <aws/common/thread.h>
+#include <aws/testing/aws_test_harness.h>
+
+static const size_t s_mock_part_size = 5 * 1024 * 1024;
+static const uint64_t s_mock_object_size = 4 * 5 * 1024 * 1024 + 1024;
+static const struct aws_byte_cursor s_mock_host_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("mock-bucket.s3.us-west-2.amazonaws.com");
+
+/* Stand-in for a client attached to context, of which only the requests in flight are looked at. */
+static void s_fake_client_init(struct aws_s3_client *client, struct aws_s3_client_context *context) {
+    AWS_ZERO_STRUCT(*client);
+    client->client_context = context;
+    aws_atomic_init_int(&client->stats.num_requests_in_flight, 0);
+    aws_atomic_init_int(&client->is_busy_in_client_context, 0);
+}
+
+/* Test that the connection budget is split evenly between the busy clients, counting a client that is about to become
+ * busy in, and that a client ends up counted right whichever order its transitions are reported in. */
+AWS_TEST_CASE(test_s3_client_context_connection_share, s_test_s3_client_context_connection_share)
+static int s_test_s3_client_context_connection_share(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    struct aws_s3_client_context_options options = {
+        .max_active_connections = 12,
+    };
+
+    struct aws_s3_client_context *context = aws_s3_client_context_new(allocator, &options);
+    ASSERT_NOT_NULL(context);
+
+    struct aws_s3_client clients[3];
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(clients); ++i) {
+        s_fake_client_init(&clients[i], context);
+    }
+
+    ASSERT_UINT_EQUALS(12, aws_s3_client_context_get_connection_share(context, &clients[0]));
+
+    aws_atomic_store_int(&clients[0].stats.num_requests_in_flight, 1);
+    aws_s3_client_context_update_busy_client(context, &clients[0]);
+    ASSERT_UINT_EQUALS(12, aws_s3_client_context_get_connection_share(context, &clients[0]));
+    ASSERT_UINT_EQUALS(6, aws_s3_client_context_get_connection_share(context, &clients[1]));
+
+    for (size_t i = 1; i < AWS_ARRAY_SIZE(clients); ++i) {
+        aws_atomic_store_int(&clients[i].stats.num_requests_in_flight, 1);
+        aws_s3_client_context_update_busy_client(context, &clients[i]);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(clients); ++i) {
+        ASSERT_UINT_EQUALS(4, aws_s3_client_context_get_connection_share(context, &clients[i]));
+    }
+
+    /* Reporting the same transition twice changes nothing. */
+    aws_s3_client_context_update_busy_client(context, &clients[2]);
+    ASSERT_UINT_EQUALS(3, aws_atomic_load_int(&context->num_busy_clients));
+
+    /* Client 1 goes idle (1 to 0) and busy again (0 to 1), and the reports come in the other order: the first one to
+     * come in already sees it busy again, and so does the second. */
+    aws_atomic_store_int(&clients[1].stats.num_requests_in_flight, 0);
+    aws_atomic_store_int(&clients[1].stats.num_requests_in_flight, 1);
+    aws_s3_client_context_update_busy_client(context, &clients[1]);
+    aws_s3_client_context_update_busy_client(context, &clients[1]);
+    ASSERT_UINT_EQUALS(3, aws_atomic_load_int(&context->num_busy_clients));
+    ASSERT_TRUE(aws_atomic_load_int(&clients[1].is_busy_in_client_context));
+
+    /* Client 2 goes idle and its report comes before that of it having gone busy: it ends up idle either way. */
+    aws_atomic_store_int(&clients[2].stats.num_requests_in_flight, 0);
+    aws_s3_client_context_update_busy_client(context, &clients[2]);
+    aws_s3_client_context_update_busy_client(context, &clients[2]);
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&context->num_busy_clients));
+    ASSERT_FALSE(aws_atomic_load_int(&clients[2].is_busy_in_client_context));
+    ASSERT_UINT_EQUALS(6, aws_s3_client_context_get_connection_share(context, &clients[0]));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(clients); ++i) {
+        aws_atomic_store_int(&clients[i].stats.num_requests_in_flight, 0);
+        aws_s3_client_context_update_busy_client(context, &clients[i]);
+    }
+
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&context->num_busy_clients));
+    ASSERT_UINT_EQUALS(12, aws_s3_client_context_get_connection_share(context, &clients[0]));
+
+    aws_s3_client_context_release(context);
+
+    /* Without a connection limit, the budget is derived from the throughput target, and without either there is no
+     * budget. */
+    struct aws_s3_client_context_options throughput_options = {
+        .throughput_target_gbps = 8.0,
+    };
+
+    context = aws_s3_client_context_new(allocator, &throughput_options);
+    ASSERT_NOT_NULL(context);
+    s_fake_client_init(&clients[0], context);
+    ASSERT_UINT_EQUALS(
+        2 * g_max_num_connections_per_vip, aws_s3_client_context_get_connection_share(context, &clients[0]));
+    aws_s3_client_context_release(context);
+
+    struct aws_s3_client_context_options no_budget_options;
+    AWS_ZERO_STRUCT(no_budget_options);
+
+    context = aws_s3_client_context_new(allocator, &no_budget_options);
+    ASSERT_NOT_NULL(context);
+    s_fake_client_init(&clients[0], context);
+    ASSERT_UINT_EQUALS(UINT32_MAX, aws_s3_client_context_get_connection_share(context, &clients[0]));
+    aws_s3_client_context_release(context);
+
+    aws_s3_library_clean_up();
+
+    return 0;
+}
+
+/* Test that a client attached to a context streams bodies on the context's threads and stays within the context's
+ * budget. */
+AWS_TEST_CASE(test_s3_client_context_mock_get, s_test_s3_client_context_mock_get)
+static int s_test_s3_client_context_mock_get(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_context_options context_options = {
+        .max_active_connections = 4,
+    };
+
+    struct aws_s3_client_context *context = aws_s3_client_context_new(allocator, &context_options);
+    ASSERT_NOT_NULL(context);
+
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.part_size = s_mock_part_size;
+    client_config.tls_mode = AWS_MR_TLS_DISABLED;
+    client_config.client_context = context;
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(&tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+    aws_s3_mock_transport_install(transport, client);
+
+    ASSERT_PTR_EQUALS(context->body_streaming_elg, client->body_streaming_elg);
+    ASSERT_TRUE(aws_s3_client_get_max_active_connections(client, NULL) <= context_options.max_active_connections);
+
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+    options.message = message;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+    ASSERT_UINT_EQUALS(s_mock_object_size, meta_request_test_results.received_body_size);
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_s3_client_release(client);
+
+    /* The client holds onto the context until it has shut down, and the context checks that no client is still busy
+     * when it goes away. */
+    aws_s3_client_context_release(context);
+    aws_s3_tester_clean_up(&tester);
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+/* Result of a GET made by the attach/detach test. counter1 of the tester counts the GETs that are done, and counter2
+ * the clients that have shut down (other than the one bound to the tester). */
+struct s3_client_context_test_get {
+    struct aws_s3_tester *tester;
+    int error_code;
+    bool finished;
+};
+
+static void s_test_get_finish(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_meta_request_result *result,
+    void *user_data) {
+    (void)meta_request;
+
+    struct s3_client_context_test_get *get = user_data;
+
+    aws_s3_tester_lock_synced_data(get->tester);
+    get->error_code = result->error_code;
+    get->finished = true;
+    aws_s3_tester_unlock_synced_data(get->tester);
+
+    aws_s3_tester_inc_counter1(get->tester);
+}
+
+static void s_test_client_shutdown(void *user_data) {
+    aws_s3_tester_inc_counter2(user_data);
+}
+
+static struct aws_s3_meta_request *s_test_get_new(
+    struct aws_allocator *allocator,
+    struct aws_s3_client *client,
+    struct s3_client_context_test_get *get) {
+
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = message,
+        .finish_callback = s_test_get_finish,
+        .user_data = get,
+    };
+
+    struct aws_s3_meta_request *meta_request = aws_s3_client_make_meta_request(client, &options);
+    aws_http_message_release(message);
+
+    return meta_request;
+}
+
+static uint32_t s_num_busy_clients(struct aws_s3_client_context *context) {
+    return (uint32_t)aws_atomic_load_int(&context->num_busy_clients);
+}
+
+static bool s_is_busy_client(struct aws_s3_client *client) {
+    return aws_atomic_load_int(&client->is_busy_in_client_context) != 0;
+}
+
+/* Wait (for up to 10 seconds) for the number of busy clients of context to be num_busy_clients. */
+static int s_wait_for_num_busy_clients(struct aws_s3_client_context *context, uint32_t num_busy_clients) {
+    for (int i = 0; i < 10000 && s_num_busy_clients(context) != num_busy_clients; ++i) {
+        aws_thread_current_sleep(AWS_TIMESTAMP_NANOS / 1000);
+    }
+
+    ASSERT_UINT_EQUALS(num_busy_clients, s_num_busy_clients(context));
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that a client attaching to a context while another client's transfer is running gets its share of the budget
+ * right away and completes a transfer of its own, and that once it detaches (shuts down) mid-transfer, the other client
+ * finishes its transfer with the whole budget to itself again. */
+AWS_TEST_CASE(test_s3_client_context_attach_detach_mid_transfer, s_test_s3_client_context_attach_detach_mid_transfer)
+static int s_test_s3_client_context_attach_detach_mid_transfer(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_context_options context_options = {
+        .max_active_connections = 8,
+    };
+
+    struct aws_s3_client_context *context = aws_s3_client_context_new(allocator, &context_options);
+    ASSERT_NOT_NULL(context);
+
+    /* The first client's object takes seconds to download, so that it is still busy while the second client comes and
+     * goes. */
+    struct aws_s3_mock_transport_options slow_transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .bytes_per_second = 5 * 1024 * 1024,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *slow_transport = aws_s3_mock_transport_new(allocator, &slow_transport_options);
+    ASSERT_NOT_NULL(slow_transport);
+
+    struct aws_s3_mock_transport_options fast_transport_options = {
+        .object_size = 1024,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *fast_transport = aws_s3_mock_transport_new(allocator, &fast_transport_options);
+    ASSERT_NOT_NULL(fast_transport);
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.part_size = s_mock_part_size;
+    client_config.tls_mode = AWS_MR_TLS_DISABLED;
+    client_config.client_context = context;
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(&tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION));
+
+    struct aws_s3_client *slow_client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(slow_client);
+    aws_s3_mock_transport_install(slow_transport, slow_client);
+
+    struct s3_client_context_test_get slow_get = {.tester = &tester};
+    struct aws_s3_meta_request *slow_meta_request = s_test_get_new(allocator, slow_client, &slow_get);
+    ASSERT_NOT_NULL(slow_meta_request);
+
+    ASSERT_SUCCESS(s_wait_for_num_busy_clients(context, 1));
+
+    /* Attach a second client mid-transfer, which is counted in ahead of becoming busy. */
+    client_config.shutdown_callback = s_test_client_shutdown;
+    client_config.shutdown_callback_user_data = &tester;
+
+    struct aws_s3_client *fast_client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(fast_client);
+    aws_s3_mock_transport_install(fast_transport, fast_client);
+
+    /* The first client can briefly have nothing in flight in between its requests, so only look at the share of the
+     * second one while the first one is seen busy both before and after. */
+    uint32_t fast_client_share = 0;
+
+    for (int i = 0; i < 1000; ++i) {
+        const uint32_t num_busy_before = s_num_busy_clients(context);
+        fast_client_share = aws_s3_client_get_max_active_connections(fast_client, NULL);
+
+        if (num_busy_before == 1 && s_num_busy_clients(context) == 1) {
+            break;
+        }
+    }
+
+    ASSERT_UINT_EQUALS(4, fast_client_share);
+
+    struct s3_client_context_test_get fast_get = {.tester = &tester};
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+    struct aws_s3_meta_request *fast_meta_request = s_test_get_new(allocator, fast_client, &fast_get);
+    ASSERT_NOT_NULL(fast_meta_request);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    ASSERT_TRUE(fast_get.finished);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, fast_get.error_code);
+    ASSERT_FALSE(slow_get.finished);
+
+    /* Detach the second client while the first one is still downloading. */
+    aws_s3_meta_request_release(fast_meta_request);
+    aws_s3_tester_set_counter2_desired(&tester, 1);
+    aws_s3_client_release(fast_client);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    ASSERT_SUCCESS(s_wait_for_num_busy_clients(context, 1));
+    ASSERT_UINT_EQUALS(8, aws_s3_client_get_max_active_connections(slow_client, NULL));
+
+    aws_s3_tester_set_counter1_desired(&tester, 2);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, slow_get.error_code);
+
+    aws_s3_meta_request_release(slow_meta_request);
+    ASSERT_SUCCESS(s_wait_for_num_busy_clients(context, 0));
+
+    aws_s3_client_release(slow_client);
+    aws_s3_client_context_release(context);
+    aws_s3_tester_clean_up(&tester);
+
+    aws_s3_mock_transport_destroy(fast_transport);
+    aws_s3_mock_transport_destroy(slow_transport);
+
+    return 0;
+}
+
+/* Test that a client whose endpoint is created while another client is busy still sizes the endpoint for the whole
+ * budget, and gets all of it once the other client goes idle, rather than keeping the share it had when the endpoint was
+ * created. */
+AWS_TEST_CASE(test_s3_client_context_endpoint_budget, s_test_s3_client_context_endpoint_budget)
+static int s_test_s3_client_context_endpoint_budget(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_context_options context_options = {
+        .max_active_connections = 8,
+    };
+
+    struct aws_s3_client_context *context = aws_s3_client_context_new(allocator, &context_options);
+    ASSERT_NOT_NULL(context);
+
+    /* Both objects take seconds to download, so that both clients stay busy until their GETs are cancelled. */
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .bytes_per_second = 5 * 1024 * 1024,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *busy_transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(busy_transport);
+
+    struct aws_s3_mock_transport *late_transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(late_transport);
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.part_size = s_mock_part_size;
+    client_config.tls_mode = AWS_MR_TLS_DISABLED;
+    client_config.client_context = context;
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(&tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION));
+
+    struct aws_s3_client *busy_client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(busy_client);
+    aws_s3_mock_transport_install(busy_transport, busy_client);
+
+    struct s3_client_context_test_get busy_get = {.tester = &tester};
+    struct aws_s3_meta_request *busy_meta_request = s_test_get_new(allocator, busy_client, &busy_get);
+    ASSERT_NOT_NULL(busy_meta_request);
+
+    ASSERT_SUCCESS(s_wait_for_num_busy_clients(context, 1));
+
+    /* The second client's endpoint is created while the first client is busy, and only has half of the budget. */
+    client_config.shutdown_callback = s_test_client_shutdown;
+    client_config.shutdown_callback_user_data = &tester;
+
+    struct aws_s3_client *late_client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(late_client);
+    aws_s3_mock_transport_install(late_transport, late_client);
+
+    struct s3_client_context_test_get late_get = {.tester = &tester};
+    struct aws_s3_meta_request *late_meta_request = s_test_get_new(allocator, late_client, &late_get);
+    ASSERT_NOT_NULL(late_meta_request);
+
+    /* The first client can briefly have nothing in flight in between its requests, so only look at the share of the
+     * second one while the first one is seen busy both before and after. */
+    uint32_t late_client_share = 0;
+
+    for (int i = 0; i < 1000; ++i) {
+        const bool busy_before = s_is_busy_client(busy_client);
+        late_client_share = aws_s3_client_get_max_active_connections(late_client, NULL);
+
+        if (busy_before && s_is_busy_client(busy_client)) {
+            break;
+        }
+    }
+
+    ASSERT_UINT_EQUALS(4, late_client_share);
+    ASSERT_UINT_EQUALS(8, late_meta_request->endpoint->max_connections);
+
+    /* Once the first client is done, the second one has the whole budget, on the endpoint it already has. */
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+    aws_s3_meta_request_cancel(busy_meta_request);
+    aws_s3_tester_wait_for_counters(&tester);
+    ASSERT_TRUE(busy_get.finished);
+    ASSERT_FALSE(late_get.finished);
+
+    ASSERT_SUCCESS(s_wait_for_num_busy_clients(context, 1));
+    ASSERT_UINT_EQUALS(8, aws_s3_client_get_max_active_connections(late_client, NULL));
+    ASSERT_UINT_EQUALS(8, late_meta_request->endpoint->max_connections);
+
+    aws_s3_tester_set_counter1_desired(&tester, 2);
+    aws_s3_meta_request_cancel(late_meta_request);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    aws_s3_meta_request_release(late_meta_request);
+    aws_s3_meta_request_release(busy_meta_request);
+    ASSERT_SUCCESS(s_wait_for_num_busy_clients(context, 0));
+
+    aws_s3_tester_set_counter2_desired(&tester, 1);
+    aws_s3_client_release(late_client);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    aws_s3_client_release(busy_client);
+    aws_s3_client_context_release(context);
+    aws_s3_tester_clean_up(&tester);
+
+    aws_s3_mock_transport_destroy(late_transport);
+    aws_s3_mock_transport_destroy(busy_transport);
+
+    return 0;
+}
@@ -5,6 +5,7 @@
 
 #include <aws/s3/s3.h>
 
+#include <aws/common/string.h>
 #include <aws/testing/aws_test_harness.h>
 
 static int s_test_get_existing_compute_platform_info(struct aws_allocator *allocator, void *ctx) {
@@ -58,3 +59,53 @@ static int s_test_get_nonexistent_compute_platform_info(struct aws_allocator *al
 }
 
 AWS_TEST_CASE(test_get_nonexistent_compute_platform_info, s_test_get_nonexistent_compute_platform_info)
+
+static int s_test_get_compute_platform_info_nic_per_cpu_group(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    /* Lookups ignore case. */
+    struct aws_s3_compute_platform_info *platform_info =
+        aws_s3_get_compute_platform_info_for_instance_type(aws_byte_cursor_from_c_str("P4D.24XLARGE"));
+    ASSERT_NOT_NULL(platform_info);
+    ASSERT_UINT_EQUALS(400, platform_info->max_throughput_gbps);
+    ASSERT_UINT_EQUALS(2, platform_info->cpu_group_info_array_length);
+
+    for (size_t i = 0; i < platform_info->cpu_group_info_array_length; ++i) {
+        ASSERT_UINT_EQUALS(i, platform_info->cpu_group_info_array[i].cpu_group);
+        ASSERT_UINT_EQUALS(1, platform_info->cpu_group_info_array[i].nic_name_array_length);
+    }
+
+    platform_info = aws_s3_get_compute_platform_info_for_instance_type(aws_byte_cursor_from_c_str("c7gn.16xlarge"));
+    ASSERT_NOT_NULL(platform_info);
+    ASSERT_UINT_EQUALS(200, platform_info->max_throughput_gbps);
+    ASSERT_UINT_EQUALS(1, platform_info->cpu_group_info_array_length);
+
+    aws_s3_library_clean_up();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_get_compute_platform_info_nic_per_cpu_group, s_test_get_compute_platform_info_nic_per_cpu_group)
+
+/* Whether or not the machine running the test is an EC2 instance, detection either fails cleanly or returns a
+ * non-empty instance type. */
+static int s_test_detect_instance_type(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_s3_library_init(allocator);
+
+    struct aws_string *instance_type = aws_s3_detect_instance_type(allocator);
+
+    if (instance_type == NULL) {
+        ASSERT_INT_EQUALS(AWS_ERROR_PLATFORM_NOT_SUPPORTED, aws_last_error());
+    } else {
+        ASSERT_TRUE(instance_type->len > 0);
+        aws_string_destroy(instance_type);
+    }
+
+    aws_s3_library_clean_up();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_detect_instance_type, s_test_detect_instance_type)
@@ -3,15 +3,20 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
+#include "aws/s3/private/s3_auto_ranged_get.h"
+#include "aws/s3/private/s3_auto_ranged_put.h"
+#include "aws/s3/private/s3_buffer_pool.h"
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_meta_request_impl.h"
 #include "aws/s3/private/s3_util.h"
+#include "aws/s3/private/s3_vectored_get.h"
 #include "s3_tester.h"
 #include <aws/common/byte_buf.h>
 #include <aws/common/clock.h>
 #include <aws/common/common.h>
 #include <aws/common/environment.h>
 #include <aws/common/ref_count.h>
+#include <aws/common/thread.h>
 #include <aws/http/request_response.h>
 #include <aws/http/status_code.h>
 #include <aws/io/channel_bootstrap.h>
@@ -49,6 +54,87 @@ static int s_test_s3_client_create_destroy(struct aws_allocator *allocator, void
     return 0;
 }
 
+struct s3_test_prewarm_endpoint_result {
+    struct aws_s3_tester *tester;
+    int error_code;
+    uint32_t num_connections;
+};
+
+static void s_s3_test_prewarm_endpoint_callback(int error_code, uint32_t num_connections, void *user_data) {
+    struct s3_test_prewarm_endpoint_result *result = user_data;
+
+    result->error_code = error_code;
+    result->num_connections = num_connections;
+
+    aws_s3_tester_inc_counter1(result->tester);
+}
+
+/* Test that prewarming an endpoint opens the requested number of connections, and that the prewarmed endpoint is the
+ * one that meta requests to the same host end up using. */
+AWS_TEST_CASE(test_s3_client_prewarm_endpoint, s_test_s3_client_prewarm_endpoint)
+static int s_test_s3_client_prewarm_endpoint(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_TRUE(client != NULL);
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+
+    struct s3_test_prewarm_endpoint_result result = {
+        .tester = &tester,
+        .error_code = AWS_ERROR_UNKNOWN,
+    };
+
+    struct aws_s3_client_prewarm_endpoint_options prewarm_options = {
+        .host_name = aws_byte_cursor_from_string(host_name),
+        .num_connections = 4,
+        .use_tls = false,
+        .port = -1,
+        .callback = s_s3_test_prewarm_endpoint_callback,
+        .user_data = &result,
+    };
+
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+    ASSERT_SUCCESS(aws_s3_client_prewarm_endpoint(client, &prewarm_options));
+    aws_s3_tester_wait_for_counters(&tester);
+
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, result.error_code);
+    ASSERT_UINT_EQUALS(4, result.num_connections);
+
+    /* The client holds on to the endpoint, so looking it up again finds the prewarmed one. */
+    aws_s3_client_lock_synced_data(client);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&client->synced_data.prewarmed_endpoints));
+    struct aws_hash_element *endpoint_hash_element = NULL;
+    ASSERT_SUCCESS(aws_hash_table_find(&client->synced_data.endpoints, host_name, &endpoint_hash_element));
+    ASSERT_NOT_NULL(endpoint_hash_element);
+    aws_s3_client_unlock_synced_data(client);
+
+    /* A missing host name is rejected. */
+    AWS_ZERO_STRUCT(prewarm_options.host_name);
+    ASSERT_FAILS(aws_s3_client_prewarm_endpoint(client, &prewarm_options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    aws_string_destroy(host_name);
+
+    aws_s3_client_release(client);
+    client = NULL;
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 AWS_TEST_CASE(test_s3_client_max_active_connections_override, s_test_s3_client_max_active_connections_override)
 static int s_test_s3_client_max_active_connections_override(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -73,6 +159,52 @@ static int s_test_s3_client_max_active_connections_override(struct aws_allocator
     return 0;
 }
 
+/* Test that the throughput target, and so the number of connections, defaults to what the instance type can do, and
+ * that a throughput target passed in still wins. */
+AWS_TEST_CASE(test_s3_client_instance_type_throughput_target, s_test_s3_client_instance_type_throughput_target)
+static int s_test_s3_client_instance_type_throughput_target(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config = {
+        .instance_type = aws_byte_cursor_from_c_str("p4d.24xlarge"),
+    };
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(&tester, &client_config, 0));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+    ASSERT_NOT_NULL(client->platform_info);
+    ASSERT_TRUE(client->throughput_target_gbps == 400.0);
+    ASSERT_TRUE(client->ideal_vip_count > 10);
+
+    uint32_t instance_type_ideal_vip_count = client->ideal_vip_count;
+    aws_s3_client_release(client);
+
+    client_config.throughput_target_gbps = 25.0;
+    client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+    ASSERT_TRUE(client->throughput_target_gbps == 25.0);
+    ASSERT_TRUE(client->ideal_vip_count < instance_type_ideal_vip_count);
+    aws_s3_client_release(client);
+
+    /* An unknown instance type leaves the default in place. */
+    client_config.throughput_target_gbps = 0.0;
+    client_config.instance_type = aws_byte_cursor_from_c_str("non-existent");
+    client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+    ASSERT_NULL(client->platform_info);
+    ASSERT_TRUE(client->throughput_target_gbps == 10.0);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 AWS_TEST_CASE(test_s3_client_byo_crypto_no_options, s_test_s3_client_byo_crypto_no_options)
 static int s_test_s3_client_byo_crypto_no_options(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -255,6 +387,157 @@ static int s_test_s3_client_get_max_active_connections(struct aws_allocator *all
     return 0;
 }
 
+/* Test that the metrics snapshots report the client and meta request counters. */
+AWS_TEST_CASE(test_s3_client_get_metrics, s_test_s3_client_get_metrics)
+static int s_test_s3_client_get_metrics(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+    *((uint32_t *)&mock_client->ideal_vip_count) = 2;
+
+    aws_atomic_fetch_add(&mock_client->stats.num_requests_in_flight, 5);
+    aws_atomic_fetch_add(&mock_client->stats.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_GET_OBJECT], 3);
+    aws_atomic_fetch_add(&mock_client->stats.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_PUT_OBJECT], 1);
+    aws_atomic_fetch_add(&mock_client->stats.num_requests_stream_queued_waiting, 2);
+    aws_atomic_fetch_add(&mock_client->stats.num_requests_streaming, 1);
+    aws_atomic_fetch_add(&mock_client->stats.num_bytes_transferred, 1024);
+    aws_atomic_fetch_add(&mock_client->stats.num_slow_down_errors, 7);
+
+    struct aws_s3_client_metrics client_metrics;
+    aws_s3_client_get_metrics(mock_client, &client_metrics);
+
+    ASSERT_UINT_EQUALS(5, client_metrics.num_requests_in_flight);
+    ASSERT_UINT_EQUALS(3, client_metrics.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_GET_OBJECT]);
+    ASSERT_UINT_EQUALS(1, client_metrics.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_PUT_OBJECT]);
+    ASSERT_UINT_EQUALS(0, client_metrics.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_DEFAULT]);
+    ASSERT_UINT_EQUALS(4, client_metrics.num_active_connections);
+    ASSERT_UINT_EQUALS(
+        aws_s3_client_get_max_active_connections(mock_client, NULL), client_metrics.max_active_connections);
+    ASSERT_UINT_EQUALS(2, client_metrics.num_requests_stream_queued_waiting);
+    ASSERT_UINT_EQUALS(1, client_metrics.num_requests_streaming);
+    ASSERT_UINT_EQUALS(1024, client_metrics.num_bytes_transferred);
+    ASSERT_UINT_EQUALS(7, client_metrics.num_slow_down_errors);
+
+    struct aws_s3_meta_request *mock_meta_request = aws_s3_tester_mock_meta_request_new(&tester);
+
+    struct aws_s3_meta_request_metrics meta_request_metrics;
+    aws_s3_meta_request_get_metrics(mock_meta_request, &meta_request_metrics);
+
+    /* Nothing has succeeded yet, so there is no average latency. */
+    ASSERT_UINT_EQUALS(0, meta_request_metrics.num_requests_succeeded);
+    ASSERT_UINT_EQUALS(0, meta_request_metrics.average_request_latency_ns);
+
+    aws_atomic_fetch_add(&mock_meta_request->stats.num_requests_in_flight, 2);
+    aws_atomic_fetch_add(&mock_meta_request->stats.num_requests_network_io, 1);
+    aws_atomic_fetch_add(&mock_meta_request->stats.num_bytes_transferred, 512);
+    aws_atomic_fetch_add(&mock_meta_request->stats.num_requests_succeeded, 4);
+    aws_atomic_fetch_add(&mock_meta_request->stats.num_requests_failed, 1);
+    aws_atomic_fetch_add(&mock_meta_request->stats.num_retries, 3);
+    aws_atomic_fetch_add(&mock_meta_request->stats.total_request_latency_ns, 4000);
+
+    aws_s3_meta_request_get_metrics(mock_meta_request, &meta_request_metrics);
+
+    ASSERT_UINT_EQUALS(2, meta_request_metrics.num_requests_in_flight);
+    ASSERT_UINT_EQUALS(1, meta_request_metrics.num_active_connections);
+    ASSERT_UINT_EQUALS(512, meta_request_metrics.num_bytes_transferred);
+    ASSERT_UINT_EQUALS(4, meta_request_metrics.num_requests_succeeded);
+    ASSERT_UINT_EQUALS(1, meta_request_metrics.num_requests_failed);
+    ASSERT_UINT_EQUALS(3, meta_request_metrics.num_retries);
+    ASSERT_UINT_EQUALS(1000, meta_request_metrics.average_request_latency_ns);
+
+    aws_s3_meta_request_release(mock_meta_request);
+    aws_s3_client_release(mock_client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that the adaptive connection controller grows the connection limit while connections are saturated and backs
+ * off when SlowDown responses are received, staying between one VIP worth of connections and its ceiling, which is
+ * above the static limit. */
+AWS_TEST_CASE(test_s3_client_adaptive_connections, s_test_s3_client_adaptive_connections)
+static int s_test_s3_client_adaptive_connections(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+    *((uint32_t *)&mock_client->ideal_vip_count) = 10;
+    *((bool *)&mock_client->enable_adaptive_connections) = true;
+
+    const uint32_t static_max_active_connections = mock_client->ideal_vip_count * g_max_num_connections_per_vip;
+    const uint32_t max_adaptive_connections = static_max_active_connections * 2;
+    *((uint32_t *)&mock_client->max_adaptive_connections) = max_adaptive_connections;
+    const uint64_t one_sec_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    const uint32_t start_connections = 40;
+
+    aws_atomic_store_int(&mock_client->max_allowed_connections, start_connections);
+    ASSERT_TRUE(aws_s3_client_get_max_active_connections(mock_client, NULL) == start_connections);
+
+    uint64_t now_ns = one_sec_ns;
+
+    /* First call only records a baseline. */
+    aws_s3_client_update_max_allowed_connections_threaded(mock_client, now_ns);
+    ASSERT_TRUE(aws_atomic_load_int(&mock_client->max_allowed_connections) == start_connections);
+
+    /* Every allowed connection is busy and throughput is flowing, so the limit should grow. */
+    aws_atomic_store_int(&mock_client->stats.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_GET_OBJECT], 40);
+    aws_atomic_fetch_add(&mock_client->stats.num_bytes_transferred, 40 * 1024 * 1024);
+
+    /* Less than a full interval has passed, so nothing should change yet. */
+    aws_s3_client_update_max_allowed_connections_threaded(mock_client, now_ns + one_sec_ns / 2);
+    ASSERT_TRUE(aws_atomic_load_int(&mock_client->max_allowed_connections) == start_connections);
+
+    now_ns += one_sec_ns;
+    aws_s3_client_update_max_allowed_connections_threaded(mock_client, now_ns);
+    uint32_t grown_connections = (uint32_t)aws_atomic_load_int(&mock_client->max_allowed_connections);
+    ASSERT_TRUE(grown_connections > start_connections);
+    ASSERT_TRUE(aws_s3_client_get_max_active_connections(mock_client, NULL) == grown_connections);
+
+    /* A SlowDown response during the interval should shrink the limit. */
+    aws_atomic_fetch_add(&mock_client->stats.num_slow_down_errors, 1);
+    now_ns += one_sec_ns;
+    aws_s3_client_update_max_allowed_connections_threaded(mock_client, now_ns);
+    uint32_t reduced_connections = (uint32_t)aws_atomic_load_int(&mock_client->max_allowed_connections);
+    ASSERT_TRUE(reduced_connections < grown_connections);
+
+    /* Repeated throttling never takes the limit below one VIP worth of connections. */
+    for (uint32_t i = 0; i < 32; ++i) {
+        aws_atomic_fetch_add(&mock_client->stats.num_slow_down_errors, 1);
+        now_ns += one_sec_ns;
+        aws_s3_client_update_max_allowed_connections_threaded(mock_client, now_ns);
+    }
+
+    ASSERT_TRUE(aws_atomic_load_int(&mock_client->max_allowed_connections) == g_max_num_connections_per_vip);
+
+    /* Sustained saturation takes the limit past the static limit, up to the ceiling and no further. */
+    aws_atomic_store_int(
+        &mock_client->stats.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_GET_OBJECT], max_adaptive_connections);
+
+    for (uint32_t i = 0; i < max_adaptive_connections; ++i) {
+        aws_atomic_fetch_add(&mock_client->stats.num_bytes_transferred, 100 * 1024 * 1024);
+        now_ns += one_sec_ns;
+        aws_s3_client_update_max_allowed_connections_threaded(mock_client, now_ns);
+    }
+
+    ASSERT_TRUE(aws_atomic_load_int(&mock_client->max_allowed_connections) == max_adaptive_connections);
+    ASSERT_TRUE(aws_s3_client_get_max_active_connections(mock_client, NULL) == max_adaptive_connections);
+    ASSERT_TRUE(aws_s3_client_get_max_connections_budget(mock_client) == max_adaptive_connections);
+
+    aws_atomic_store_int(&mock_client->stats.num_requests_network_io[AWS_S3_META_REQUEST_TYPE_GET_OBJECT], 0);
+
+    aws_s3_client_release(mock_client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 AWS_TEST_CASE(test_s3_request_create_destroy, s_test_s3_request_create_destroy)
 static int s_test_s3_request_create_destroy(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -398,7 +681,7 @@ static int s_test_s3_meta_request_body_streaming(struct aws_allocator *allocator
             aws_s3_meta_request_lock_synced_data(meta_request);
 
             aws_s3_meta_request_stream_response_body_synced(meta_request, request);
-            ASSERT_TRUE(aws_priority_queue_size(&meta_request->synced_data.pending_body_streaming_requests) == 0);
+            ASSERT_TRUE(meta_request->synced_data.pending_body_streaming_requests.size == 0);
 
             aws_s3_meta_request_unlock_synced_data(meta_request);
 
@@ -438,8 +721,7 @@ static int s_test_s3_meta_request_body_streaming(struct aws_allocator *allocator
         }
 
         aws_s3_meta_request_lock_synced_data(meta_request);
-        ASSERT_TRUE(
-            aws_priority_queue_size(&meta_request->synced_data.pending_body_streaming_requests) == num_parts_queued);
+        ASSERT_TRUE(meta_request->synced_data.pending_body_streaming_requests.size == num_parts_queued);
         aws_s3_meta_request_unlock_synced_data(meta_request);
     }
 
@@ -462,7 +744,7 @@ static int s_test_s3_meta_request_body_streaming(struct aws_allocator *allocator
         aws_s3_meta_request_unlock_synced_data(meta_request);
 
         aws_s3_meta_request_lock_synced_data(meta_request);
-        ASSERT_TRUE(aws_priority_queue_size(&meta_request->synced_data.pending_body_streaming_requests) == 0);
+        ASSERT_TRUE(meta_request->synced_data.pending_body_streaming_requests.size == 0);
         aws_s3_meta_request_unlock_synced_data(meta_request);
 
         aws_s3_request_release(request);
@@ -481,6 +763,140 @@ static int s_test_s3_meta_request_body_streaming(struct aws_allocator *allocator
     return 0;
 }
 
+/* Test that parts arriving further ahead of the next part to stream than the body streaming window holds are kept, and
+ * are all streamed in order once the part holding them up arrives. */
+AWS_TEST_CASE(test_s3_meta_request_body_streaming_window_growth, s_test_s3_meta_request_body_streaming_window_growth)
+static int s_test_s3_meta_request_body_streaming_window_growth(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const uint32_t num_parts = 40;
+    const size_t request_response_body_size = 16;
+    const uint64_t total_object_size = (uint64_t)num_parts * request_response_body_size;
+
+    struct aws_byte_buf response_body_source_buffer;
+    aws_byte_buf_init(&response_body_source_buffer, allocator, request_response_body_size);
+
+    const struct aws_byte_cursor test_byte_cursor = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("0");
+
+    for (size_t i = 0; i < request_response_body_size; ++i) {
+        aws_byte_buf_append(&response_body_source_buffer, &test_byte_cursor);
+    }
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct s3_test_body_streaming_user_data body_streaming_user_data = {
+        .tester = &tester,
+    };
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+
+    struct aws_s3_meta_request *meta_request = aws_s3_tester_mock_meta_request_new(&tester);
+    ASSERT_TRUE(meta_request != NULL);
+
+    struct aws_event_loop_group *event_loop_group = aws_event_loop_group_new_default(allocator, 0, NULL);
+    aws_s3_client_acquire(mock_client);
+    meta_request->client = mock_client;
+    meta_request->user_data = &body_streaming_user_data;
+    *((size_t *)&meta_request->part_size) = request_response_body_size;
+    meta_request->body_callback = s_s3_meta_request_test_body_streaming_callback;
+    meta_request->io_event_loop = aws_event_loop_group_get_next_loop(event_loop_group);
+
+    aws_s3_tester_set_counter1_desired(&tester, num_parts);
+
+    /* Queue every part but the first, last to first, so that the window has to grow to hold them. */
+    for (uint32_t part_number = num_parts + 1; part_number-- > 1;) {
+        struct aws_s3_request *request = aws_s3_request_new(meta_request, 0, part_number, 0);
+
+        aws_s3_get_part_range(
+            0ULL,
+            total_object_size - 1,
+            (uint64_t)request_response_body_size,
+            part_number,
+            &request->part_range_start,
+            &request->part_range_end);
+
+        aws_byte_buf_init_copy(&request->send_data.response_body, allocator, &response_body_source_buffer);
+
+        aws_s3_meta_request_lock_synced_data(meta_request);
+        aws_s3_meta_request_stream_response_body_synced(meta_request, request);
+
+        if (part_number > 1) {
+            ASSERT_TRUE(meta_request->synced_data.pending_body_streaming_requests.size == num_parts - part_number + 1);
+        } else {
+            ASSERT_TRUE(meta_request->synced_data.pending_body_streaming_requests.size == 0);
+        }
+
+        aws_s3_meta_request_unlock_synced_data(meta_request);
+
+        aws_s3_request_release(request);
+    }
+
+    aws_s3_tester_wait_for_counters(&tester);
+
+    ASSERT_TRUE(body_streaming_user_data.received_body_size == total_object_size);
+
+    aws_s3_meta_request_release(meta_request);
+    aws_s3_client_release(mock_client);
+    aws_event_loop_group_release(event_loop_group);
+    aws_byte_buf_clean_up(&response_body_source_buffer);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that a part queued for streaming twice fails the meta request, rather than aborting, and leaves the part that is
+ * already queued where it is. */
+AWS_TEST_CASE(test_s3_meta_request_body_streaming_duplicate_part, s_test_s3_meta_request_body_streaming_duplicate_part)
+static int s_test_s3_meta_request_body_streaming_duplicate_part(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+
+    struct aws_s3_meta_request *meta_request = aws_s3_tester_mock_meta_request_new(&tester);
+    ASSERT_TRUE(meta_request != NULL);
+
+    struct aws_event_loop_group *event_loop_group = aws_event_loop_group_new_default(allocator, 0, NULL);
+    aws_s3_client_acquire(mock_client);
+    meta_request->client = mock_client;
+    meta_request->io_event_loop = aws_event_loop_group_get_next_loop(event_loop_group);
+
+    /* Part 1 never arrives, so part 2 stays queued. */
+    struct aws_s3_request *request = aws_s3_request_new(meta_request, 0, 2, 0);
+    struct aws_s3_request *duplicate_request = aws_s3_request_new(meta_request, 0, 2, 0);
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    aws_s3_meta_request_stream_response_body_synced(meta_request, request);
+    ASSERT_UINT_EQUALS(1, meta_request->synced_data.pending_body_streaming_requests.size);
+    ASSERT_FALSE(meta_request->synced_data.finish_result_set);
+
+    aws_s3_meta_request_stream_response_body_synced(meta_request, duplicate_request);
+    ASSERT_UINT_EQUALS(1, meta_request->synced_data.pending_body_streaming_requests.size);
+    ASSERT_TRUE(meta_request->synced_data.finish_result_set);
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, meta_request->synced_data.finish_result.error_code);
+
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    aws_s3_request_release(duplicate_request);
+    aws_s3_request_release(request);
+
+    /* Finishing releases the part still queued. */
+    aws_s3_meta_request_finish_default(meta_request);
+
+    aws_s3_meta_request_release(meta_request);
+    aws_s3_client_release(mock_client);
+    aws_event_loop_group_release(event_loop_group);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 /* Test aws_s3_client_queue_requests_threaded and aws_s3_client_dequeue_request_threaded */
 AWS_TEST_CASE(test_s3_client_queue_requests, s_test_s3_client_queue_requests)
 static int s_test_s3_client_queue_requests(struct aws_allocator *allocator, void *ctx) {
@@ -490,7 +906,9 @@ static int s_test_s3_client_queue_requests(struct aws_allocator *allocator, void
     aws_s3_tester_init(allocator, &tester);
 
     struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
-    aws_linked_list_init(&mock_client->threaded_data.request_queue);
+    struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[0];
+    struct aws_linked_list *normal_request_queue =
+        &work_shard->threaded_data.request_queues[AWS_S3_META_REQUEST_PRIORITY_NORMAL];
 
     struct aws_s3_meta_request *mock_meta_request = aws_s3_tester_mock_meta_request_new(&tester);
 
@@ -512,80 +930,80 @@ static int s_test_s3_client_queue_requests(struct aws_allocator *allocator, void
 
     {
         aws_linked_list_push_back(&pivot_request_list, &pivot_request->node);
-        aws_s3_client_queue_requests_threaded(mock_client, &pivot_request_list, false);
+        aws_s3_client_queue_requests_threaded(work_shard, &pivot_request_list, false);
 
-        ASSERT_TRUE(mock_client->threaded_data.request_queue_size == 1);
-        ASSERT_TRUE(!aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+        ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 1);
+        ASSERT_TRUE(!aws_linked_list_empty(normal_request_queue));
 
         for (uint32_t i = 0; i < num_requests; ++i) {
             aws_linked_list_push_back(&request_list, &requests[i]->node);
         }
 
         /* Move the requests to the back of the queue. */
-        aws_s3_client_queue_requests_threaded(mock_client, &request_list, false);
+        aws_s3_client_queue_requests_threaded(work_shard, &request_list, false);
     }
 
     ASSERT_TRUE(aws_linked_list_empty(&request_list));
-    ASSERT_TRUE(mock_client->threaded_data.request_queue_size == (num_requests + 1));
-    ASSERT_TRUE(!aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == (num_requests + 1));
+    ASSERT_TRUE(!aws_linked_list_empty(normal_request_queue));
 
     {
         /* The first request should be the pivot request since the other requests were pushed to the back. */
-        struct aws_s3_request *first_request = aws_s3_client_dequeue_request_threaded(mock_client);
+        struct aws_s3_request *first_request = aws_s3_client_dequeue_request_threaded(work_shard);
         ASSERT_TRUE(first_request == pivot_request);
 
-        ASSERT_TRUE(mock_client->threaded_data.request_queue_size == num_requests);
-        ASSERT_TRUE(!aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+        ASSERT_TRUE(work_shard->threaded_data.request_queue_size == num_requests);
+        ASSERT_TRUE(!aws_linked_list_empty(normal_request_queue));
     }
 
     for (uint32_t i = 0; i < num_requests; ++i) {
-        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(mock_client);
+        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(work_shard);
 
         ASSERT_TRUE(request == requests[i]);
 
-        ASSERT_TRUE(mock_client->threaded_data.request_queue_size == (num_requests - (i + 1)));
+        ASSERT_TRUE(work_shard->threaded_data.request_queue_size == (num_requests - (i + 1)));
 
         if (i < num_requests - 1) {
-            ASSERT_TRUE(!aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+            ASSERT_TRUE(!aws_linked_list_empty(normal_request_queue));
         }
     }
 
-    ASSERT_TRUE(mock_client->threaded_data.request_queue_size == 0);
-    ASSERT_TRUE(aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 0);
+    ASSERT_TRUE(aws_linked_list_empty(normal_request_queue));
 
     {
         aws_linked_list_push_back(&pivot_request_list, &pivot_request->node);
-        aws_s3_client_queue_requests_threaded(mock_client, &pivot_request_list, false);
+        aws_s3_client_queue_requests_threaded(work_shard, &pivot_request_list, false);
 
-        ASSERT_TRUE(mock_client->threaded_data.request_queue_size == 1);
-        ASSERT_TRUE(!aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+        ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 1);
+        ASSERT_TRUE(!aws_linked_list_empty(normal_request_queue));
 
         for (uint32_t i = 0; i < num_requests; ++i) {
             aws_linked_list_push_back(&request_list, &requests[i]->node);
         }
 
         /* Move the requests to the front of the queue. */
-        aws_s3_client_queue_requests_threaded(mock_client, &request_list, true);
+        aws_s3_client_queue_requests_threaded(work_shard, &request_list, true);
     }
 
     ASSERT_TRUE(aws_linked_list_empty(&request_list));
-    ASSERT_TRUE(mock_client->threaded_data.request_queue_size == (num_requests + 1));
-    ASSERT_TRUE(!aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == (num_requests + 1));
+    ASSERT_TRUE(!aws_linked_list_empty(normal_request_queue));
 
     for (uint32_t i = 0; i < num_requests; ++i) {
-        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(mock_client);
+        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(work_shard);
 
         ASSERT_TRUE(request == requests[i]);
     }
 
     {
         /* The last request should be the pivot request since the other requests were pushed to the front. */
-        struct aws_s3_request *last_request = aws_s3_client_dequeue_request_threaded(mock_client);
+        struct aws_s3_request *last_request = aws_s3_client_dequeue_request_threaded(work_shard);
         ASSERT_TRUE(last_request == pivot_request);
     }
 
-    ASSERT_TRUE(aws_linked_list_empty(&mock_client->threaded_data.request_queue));
-    ASSERT_TRUE(mock_client->threaded_data.request_queue_size == 0);
+    ASSERT_TRUE(aws_linked_list_empty(normal_request_queue));
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 0);
 
     for (uint32_t i = 0; i < num_requests; ++i) {
         aws_s3_request_release(requests[i]);
@@ -599,6 +1017,91 @@ static int s_test_s3_client_queue_requests(struct aws_allocator *allocator, void
     return 0;
 }
 
+/* Test that aws_s3_client_dequeue_request_threaded hands out requests of higher priority meta requests first, while
+ * keeping requests of the same priority in FIFO order. */
+AWS_TEST_CASE(test_s3_client_queue_requests_priority, s_test_s3_client_queue_requests_priority)
+static int s_test_s3_client_queue_requests_priority(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    aws_s3_tester_init(allocator, &tester);
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+    struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[0];
+    struct aws_linked_list *normal_request_queue =
+        &work_shard->threaded_data.request_queues[AWS_S3_META_REQUEST_PRIORITY_NORMAL];
+
+    struct aws_s3_meta_request *normal_meta_request = aws_s3_tester_mock_meta_request_new(&tester);
+    ASSERT_TRUE(normal_meta_request->priority == AWS_S3_META_REQUEST_PRIORITY_NORMAL);
+    ASSERT_TRUE(normal_meta_request->weight == 1);
+
+    struct aws_s3_meta_request *high_meta_request = aws_s3_tester_mock_meta_request_new(&tester);
+    *((enum aws_s3_meta_request_priority *)&high_meta_request->priority) = AWS_S3_META_REQUEST_PRIORITY_HIGH;
+
+    struct aws_s3_request *normal_requests[] = {
+        aws_s3_request_new(normal_meta_request, 0, 0, 0),
+        aws_s3_request_new(normal_meta_request, 0, 0, 0),
+    };
+
+    struct aws_s3_request *high_requests[] = {
+        aws_s3_request_new(high_meta_request, 0, 0, 0),
+        aws_s3_request_new(high_meta_request, 0, 0, 0),
+    };
+
+    const uint32_t num_requests = AWS_ARRAY_SIZE(normal_requests);
+
+    struct aws_linked_list request_list;
+    aws_linked_list_init(&request_list);
+
+    /* Queue the normal priority requests first, then interleave the high priority requests behind them. */
+    for (uint32_t i = 0; i < num_requests; ++i) {
+        aws_linked_list_push_back(&request_list, &normal_requests[i]->node);
+    }
+
+    aws_s3_client_queue_requests_threaded(work_shard, &request_list, false);
+
+    for (uint32_t i = 0; i < num_requests; ++i) {
+        aws_linked_list_push_back(&request_list, &high_requests[i]->node);
+    }
+
+    aws_s3_client_queue_requests_threaded(work_shard, &request_list, false);
+
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == (num_requests * 2));
+    ASSERT_TRUE(
+        work_shard->threaded_data.request_queue_size_by_priority[AWS_S3_META_REQUEST_PRIORITY_HIGH] == num_requests);
+    ASSERT_TRUE(
+        work_shard->threaded_data.request_queue_size_by_priority[AWS_S3_META_REQUEST_PRIORITY_NORMAL] ==
+        num_requests);
+
+    for (uint32_t i = 0; i < num_requests; ++i) {
+        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(work_shard);
+        ASSERT_TRUE(request == high_requests[i]);
+    }
+
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size_by_priority[AWS_S3_META_REQUEST_PRIORITY_HIGH] == 0);
+
+    for (uint32_t i = 0; i < num_requests; ++i) {
+        struct aws_s3_request *request = aws_s3_client_dequeue_request_threaded(work_shard);
+        ASSERT_TRUE(request == normal_requests[i]);
+    }
+
+    ASSERT_TRUE(aws_linked_list_empty(normal_request_queue));
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 0);
+    ASSERT_TRUE(aws_s3_client_dequeue_request_threaded(work_shard) == NULL);
+
+    for (uint32_t i = 0; i < num_requests; ++i) {
+        aws_s3_request_release(normal_requests[i]);
+        aws_s3_request_release(high_requests[i]);
+    }
+
+    aws_s3_meta_request_release(normal_meta_request);
+    aws_s3_meta_request_release(high_meta_request);
+    aws_s3_client_release(mock_client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 struct test_work_meta_request_update_user_data {
     bool has_work_remaining;
     uint32_t num_prepares;
@@ -652,21 +1155,23 @@ static size_t s_test_s3_update_meta_request_trigger_prepare_get_host_address_cou
 }
 
 static int s_validate_prepared_requests(
-    struct aws_s3_client *client,
+    struct aws_s3_client_work_shard *work_shard,
     size_t expected_num_being_prepared,
     struct aws_s3_meta_request *meta_request_with_work,
     struct aws_s3_meta_request *meta_request_without_work) {
 
-    ASSERT_TRUE(client->threaded_data.request_queue_size == 0);
-    ASSERT_TRUE(aws_linked_list_empty(&client->threaded_data.request_queue));
-    ASSERT_TRUE(client->threaded_data.num_requests_being_prepared == expected_num_being_prepared);
+    struct aws_s3_client *client = work_shard->client;
+
+    ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 0);
+    ASSERT_TRUE(aws_linked_list_empty(normal_request_queue));
+    ASSERT_TRUE(work_shard->threaded_data.num_requests_being_prepared == expected_num_being_prepared);
     ASSERT_TRUE(aws_atomic_load_int(&client->stats.num_requests_in_flight) == expected_num_being_prepared);
 
     uint32_t num_meta_requests_in_list = 0;
     bool meta_request_with_work_found = false;
 
-    for (struct aws_linked_list_node *node = aws_linked_list_begin(&client->threaded_data.meta_requests);
-         node != aws_linked_list_end(&client->threaded_data.meta_requests);
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&work_shard->threaded_data.meta_requests);
+         node != aws_linked_list_end(&work_shard->threaded_data.meta_requests);
          node = aws_linked_list_next(node)) {
 
         struct aws_s3_meta_request *meta_request =
@@ -701,11 +1206,11 @@ static int s_test_s3_update_meta_requests_trigger_prepare(struct aws_allocator *
     const uint32_t ideal_vip_count = 10;
 
     struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+    struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[0];
     mock_client->client_bootstrap = &mock_bootstrap;
     mock_client->vtable->get_host_address_count = s_test_s3_update_meta_request_trigger_prepare_get_host_address_count;
     *((uint32_t *)&mock_client->ideal_vip_count) = ideal_vip_count;
-    aws_linked_list_init(&mock_client->threaded_data.request_queue);
-    aws_linked_list_init(&mock_client->threaded_data.meta_requests);
+    aws_linked_list_init(&work_shard->threaded_data.meta_requests);
 
     struct aws_s3_meta_request *mock_meta_request_without_work = aws_s3_tester_mock_meta_request_new(&tester);
     mock_meta_request_without_work->endpoint = aws_s3_tester_mock_endpoint_new(&tester);
@@ -723,7 +1228,7 @@ static int s_test_s3_update_meta_requests_trigger_prepare(struct aws_allocator *
 
     /* Intentionally push this meta request first to test that it's properly removed from the list. */
     aws_linked_list_push_back(
-        &mock_client->threaded_data.meta_requests,
+        &work_shard->threaded_data.meta_requests,
         &mock_meta_request_without_work->client_process_work_threaded_data.node);
 
     aws_s3_meta_request_acquire(mock_meta_request_without_work);
@@ -742,17 +1247,17 @@ static int s_test_s3_update_meta_requests_trigger_prepare(struct aws_allocator *
     mock_meta_request_with_work_vtable->schedule_prepare_request = s_s3_test_work_meta_request_schedule_prepare_request;
 
     aws_linked_list_push_back(
-        &mock_client->threaded_data.meta_requests,
+        &work_shard->threaded_data.meta_requests,
         &mock_meta_request_with_work->client_process_work_threaded_data.node);
     aws_s3_meta_request_acquire(mock_meta_request_with_work);
 
     /* With no known addresses, the amount of requests that can be prepared should only be enough for one VIP. */
     {
         s_test_s3_update_meta_request_trigger_prepare_host_address_count = 0;
-        aws_s3_client_update_meta_requests_threaded(mock_client);
+        aws_s3_client_update_meta_requests_threaded(work_shard);
 
         ASSERT_SUCCESS(s_validate_prepared_requests(
-            mock_client, g_max_num_connections_per_vip, mock_meta_request_with_work, mock_meta_request_without_work));
+            work_shard, g_max_num_connections_per_vip, mock_meta_request_with_work, mock_meta_request_without_work));
     }
 
     /* When the number of known addresses is greater than or equal to the ideal vip count, the max number of requests
@@ -761,21 +1266,21 @@ static int s_test_s3_update_meta_requests_trigger_prepare(struct aws_allocator *
         const uint32_t max_requests_prepare = aws_s3_client_get_max_requests_prepare(mock_client);
 
         s_test_s3_update_meta_request_trigger_prepare_host_address_count = (size_t)(ideal_vip_count);
-        aws_s3_client_update_meta_requests_threaded(mock_client);
+        aws_s3_client_update_meta_requests_threaded(work_shard);
 
         ASSERT_SUCCESS(s_validate_prepared_requests(
-            mock_client, max_requests_prepare, mock_meta_request_with_work, mock_meta_request_without_work));
+            work_shard, max_requests_prepare, mock_meta_request_with_work, mock_meta_request_without_work));
 
         s_test_s3_update_meta_request_trigger_prepare_host_address_count = (size_t)(ideal_vip_count + 1);
-        aws_s3_client_update_meta_requests_threaded(mock_client);
+        aws_s3_client_update_meta_requests_threaded(work_shard);
 
         ASSERT_SUCCESS(s_validate_prepared_requests(
-            mock_client, max_requests_prepare, mock_meta_request_with_work, mock_meta_request_without_work));
+            work_shard, max_requests_prepare, mock_meta_request_with_work, mock_meta_request_without_work));
     }
 
-    while (!aws_linked_list_empty(&mock_client->threaded_data.meta_requests)) {
+    while (!aws_linked_list_empty(&work_shard->threaded_data.meta_requests)) {
         struct aws_linked_list_node *meta_request_node =
-            aws_linked_list_pop_front(&mock_client->threaded_data.meta_requests);
+            aws_linked_list_pop_front(&work_shard->threaded_data.meta_requests);
 
         struct aws_s3_meta_request *meta_request =
             AWS_CONTAINER_OF(meta_request_node, struct aws_s3_meta_request, client_process_work_threaded_data);
@@ -790,6 +1295,286 @@ static int s_test_s3_update_meta_requests_trigger_prepare(struct aws_allocator *
     return 0;
 }
 
+/* Test that meta requests of the same priority get prepare slots in proportion to their weight, and that a higher
+ * priority meta request with work is always served first. */
+AWS_TEST_CASE(test_s3_update_meta_requests_weighted, s_test_s3_update_meta_requests_weighted)
+static int s_test_s3_update_meta_requests_weighted(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    aws_s3_tester_init(allocator, &tester);
+
+    struct aws_client_bootstrap mock_bootstrap;
+    AWS_ZERO_STRUCT(mock_bootstrap);
+
+    const uint32_t ideal_vip_count = 10;
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+    struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[0];
+    mock_client->client_bootstrap = &mock_bootstrap;
+    mock_client->vtable->get_host_address_count = s_test_s3_update_meta_request_trigger_prepare_get_host_address_count;
+    *((uint32_t *)&mock_client->ideal_vip_count) = ideal_vip_count;
+    aws_linked_list_init(&work_shard->threaded_data.meta_requests);
+
+    s_test_s3_update_meta_request_trigger_prepare_host_address_count = (size_t)ideal_vip_count;
+
+    const uint32_t weights[] = {3, 1};
+    struct aws_s3_meta_request *meta_requests[AWS_ARRAY_SIZE(weights)];
+    struct test_work_meta_request_update_user_data meta_request_data[AWS_ARRAY_SIZE(weights)];
+    AWS_ZERO_ARRAY(meta_request_data);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(weights); ++i) {
+        meta_requests[i] = aws_s3_tester_mock_meta_request_new(&tester);
+        meta_requests[i]->endpoint = aws_s3_tester_mock_endpoint_new(&tester);
+
+        meta_request_data[i].has_work_remaining = true;
+        meta_requests[i]->user_data = &meta_request_data[i];
+        *((uint32_t *)&meta_requests[i]->weight) = weights[i];
+        meta_requests[i]->client_process_work_threaded_data.deficit = weights[i];
+
+        struct aws_s3_meta_request_vtable *vtable =
+            aws_s3_tester_patch_meta_request_vtable(&tester, meta_requests[i], NULL);
+        vtable->update = s_s3_test_work_meta_request_update;
+        vtable->schedule_prepare_request = s_s3_test_work_meta_request_schedule_prepare_request;
+
+        aws_linked_list_push_back(
+            &work_shard->threaded_data.meta_requests, &meta_requests[i]->client_process_work_threaded_data.node);
+        aws_s3_meta_request_acquire(meta_requests[i]);
+    }
+
+    const uint32_t max_requests_prepare = aws_s3_client_get_max_requests_prepare(mock_client);
+    aws_s3_client_update_meta_requests_threaded(work_shard);
+
+    ASSERT_TRUE(work_shard->threaded_data.num_requests_being_prepared == max_requests_prepare);
+
+    /* Deficit round robin hands out requests in a 3:1 pattern. */
+    ASSERT_TRUE(meta_request_data[0].num_prepares + meta_request_data[1].num_prepares == max_requests_prepare);
+    ASSERT_UINT_EQUALS((max_requests_prepare / 4) * 3, meta_request_data[0].num_prepares);
+
+    /* A high priority meta request takes every freed slot ahead of the normal priority ones. */
+    struct aws_s3_meta_request *high_meta_request = aws_s3_tester_mock_meta_request_new(&tester);
+    high_meta_request->endpoint = aws_s3_tester_mock_endpoint_new(&tester);
+    *((enum aws_s3_meta_request_priority *)&high_meta_request->priority) = AWS_S3_META_REQUEST_PRIORITY_HIGH;
+
+    struct test_work_meta_request_update_user_data high_meta_request_data = {
+        .has_work_remaining = true,
+    };
+
+    high_meta_request->user_data = &high_meta_request_data;
+
+    struct aws_s3_meta_request_vtable *high_vtable =
+        aws_s3_tester_patch_meta_request_vtable(&tester, high_meta_request, NULL);
+    high_vtable->update = s_s3_test_work_meta_request_update;
+    high_vtable->schedule_prepare_request = s_s3_test_work_meta_request_schedule_prepare_request;
+
+    /* Higher priority meta requests are kept at the front of the list. */
+    aws_linked_list_push_front(
+        &work_shard->threaded_data.meta_requests, &high_meta_request->client_process_work_threaded_data.node);
+    aws_s3_meta_request_acquire(high_meta_request);
+
+    const uint32_t num_freed_slots = 8;
+    work_shard->threaded_data.num_requests_being_prepared -= num_freed_slots;
+    aws_atomic_fetch_sub(&mock_client->stats.num_requests_in_flight, num_freed_slots);
+
+    aws_s3_client_update_meta_requests_threaded(work_shard);
+
+    ASSERT_TRUE(high_meta_request_data.num_prepares == num_freed_slots);
+    ASSERT_TRUE(meta_request_data[0].num_prepares + meta_request_data[1].num_prepares == max_requests_prepare);
+
+    while (!aws_linked_list_empty(&work_shard->threaded_data.meta_requests)) {
+        struct aws_linked_list_node *meta_request_node =
+            aws_linked_list_pop_front(&work_shard->threaded_data.meta_requests);
+
+        struct aws_s3_meta_request *meta_request =
+            AWS_CONTAINER_OF(meta_request_node, struct aws_s3_meta_request, client_process_work_threaded_data);
+
+        aws_s3_meta_request_release(meta_request);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(weights); ++i) {
+        aws_s3_meta_request_release(meta_requests[i]);
+    }
+
+    aws_s3_meta_request_release(high_meta_request);
+    aws_s3_client_release(mock_client);
+    aws_s3_tester_clean_up(&tester);
+    return 0;
+}
+
+struct test_memory_limit_meta_request_user_data {
+    uint32_t num_parts;
+    uint32_t first_part_number_prepared;
+    uint64_t num_bytes_reserved;
+};
+
+/* Hands out ranged parts that grow from one to four part sizes, like variable part sizing does. */
+static bool s_s3_test_memory_limit_meta_request_update(
+    struct aws_s3_meta_request *meta_request,
+    uint32_t flags,
+    struct aws_s3_request **out_request) {
+    AWS_ASSERT(meta_request);
+    (void)flags;
+
+    struct test_memory_limit_meta_request_user_data *user_data = meta_request->user_data;
+
+    if (out_request) {
+        const uint64_t part_range_size = (uint64_t)meta_request->part_size * (1 + (user_data->num_parts % 4));
+
+        struct aws_s3_request *request = aws_s3_request_new(
+            meta_request, 0, user_data->num_parts + 1, AWS_S3_REQUEST_FLAG_PART_SIZE_RESPONSE_BODY);
+        request->part_range_start = (uint64_t)user_data->num_parts * meta_request->part_size * 4;
+        request->part_range_end = request->part_range_start + part_range_size - 1;
+
+        ++user_data->num_parts;
+        *out_request = request;
+    }
+
+    return true;
+}
+
+static void s_s3_test_memory_limit_meta_request_schedule_prepare_request(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    aws_s3_meta_request_prepare_request_callback_fn *callback,
+    void *user_data) {
+    (void)callback;
+    (void)user_data;
+
+    AWS_ASSERT(meta_request);
+
+    struct test_memory_limit_meta_request_user_data *test_user_data = meta_request->user_data;
+    test_user_data->num_bytes_reserved += request->buffer_pool_reservation;
+
+    if (test_user_data->first_part_number_prepared == 0) {
+        test_user_data->first_part_number_prepared = request->part_number;
+    }
+
+    /* The mock meta request has no client, so releasing the request keeps its reservation held, as if it were still in
+     * flight. */
+    aws_s3_request_release(request);
+}
+
+static void s_s3_test_memory_limit_update_thread(void *arg) {
+    struct aws_s3_client_work_shard *work_shard = arg;
+    aws_s3_client_update_meta_requests_threaded(work_shard);
+}
+
+/* Test that work shards updating at the same time, with parts bigger than the part size, never reserve more than the
+ * memory limit, and that a part that doesn't fit is held on to rather than lost. */
+AWS_TEST_CASE(test_s3_update_meta_requests_memory_limit, s_test_s3_update_meta_requests_memory_limit)
+static int s_test_s3_update_meta_requests_memory_limit(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    aws_s3_tester_init(allocator, &tester);
+
+    struct aws_client_bootstrap mock_bootstrap;
+    AWS_ZERO_STRUCT(mock_bootstrap);
+
+    const uint32_t ideal_vip_count = 10;
+    const uint32_t num_work_shards = 2;
+    const size_t part_size = 1024;
+    const uint64_t memory_limit = part_size * 16;
+
+    struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new_with_shards(&tester, num_work_shards);
+    mock_client->client_bootstrap = &mock_bootstrap;
+    mock_client->vtable->get_host_address_count = s_test_s3_update_meta_request_trigger_prepare_get_host_address_count;
+    *((uint32_t *)&mock_client->ideal_vip_count) = ideal_vip_count;
+    mock_client->buffer_pool = aws_s3_buffer_pool_new(allocator, part_size, memory_limit, 0);
+    ASSERT_NOT_NULL(mock_client->buffer_pool);
+
+    s_test_s3_update_meta_request_trigger_prepare_host_address_count = (size_t)ideal_vip_count;
+
+    struct aws_s3_meta_request *meta_requests[2];
+    struct test_memory_limit_meta_request_user_data meta_request_data[2];
+    AWS_ZERO_ARRAY(meta_request_data);
+
+    for (uint32_t i = 0; i < num_work_shards; ++i) {
+        struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[i];
+
+        meta_requests[i] = aws_s3_tester_mock_meta_request_new(&tester);
+        meta_requests[i]->endpoint = aws_s3_tester_mock_endpoint_new(&tester);
+        meta_requests[i]->user_data = &meta_request_data[i];
+        *((size_t *)&meta_requests[i]->part_size) = part_size;
+
+        struct aws_s3_meta_request_vtable *vtable =
+            aws_s3_tester_patch_meta_request_vtable(&tester, meta_requests[i], NULL);
+        vtable->update = s_s3_test_memory_limit_meta_request_update;
+        vtable->schedule_prepare_request = s_s3_test_memory_limit_meta_request_schedule_prepare_request;
+
+        aws_linked_list_push_back(
+            &work_shard->threaded_data.meta_requests, &meta_requests[i]->client_process_work_threaded_data.node);
+        aws_s3_meta_request_acquire(meta_requests[i]);
+    }
+
+    struct aws_thread threads[2];
+
+    for (uint32_t i = 0; i < num_work_shards; ++i) {
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(
+            aws_thread_launch(&threads[i], s_s3_test_memory_limit_update_thread, &mock_client->work_shards[i], NULL));
+    }
+
+    for (uint32_t i = 0; i < num_work_shards; ++i) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    const uint64_t reserved = aws_s3_buffer_pool_get_reserved(mock_client->buffer_pool);
+    ASSERT_TRUE(reserved <= memory_limit);
+    ASSERT_TRUE(reserved == meta_request_data[0].num_bytes_reserved + meta_request_data[1].num_bytes_reserved);
+
+    /* Both shards ran out of memory before they ran out of preparation slots, and kept the part that didn't fit. */
+    for (uint32_t i = 0; i < num_work_shards; ++i) {
+        struct aws_s3_request *pending_request = meta_requests[i]->client_process_work_threaded_data.pending_request;
+        ASSERT_NOT_NULL(pending_request);
+        ASSERT_TRUE(pending_request->buffer_pool_reservation == 0);
+        ASSERT_TRUE(pending_request->part_number == meta_request_data[i].num_parts);
+    }
+
+    /* Once the memory is released, the part that was held on to is the next one prepared. */
+    const uint32_t pending_part_number =
+        meta_requests[0]->client_process_work_threaded_data.pending_request->part_number;
+
+    aws_s3_buffer_pool_release_reservation(mock_client->buffer_pool, reserved);
+    meta_request_data[0].first_part_number_prepared = 0;
+
+    aws_s3_client_update_meta_requests_threaded(&mock_client->work_shards[0]);
+
+    ASSERT_UINT_EQUALS(pending_part_number, meta_request_data[0].first_part_number_prepared);
+    ASSERT_TRUE(aws_s3_buffer_pool_get_reserved(mock_client->buffer_pool) <= memory_limit);
+
+    for (uint32_t i = 0; i < num_work_shards; ++i) {
+        aws_s3_request_release(meta_requests[i]->client_process_work_threaded_data.pending_request);
+        meta_requests[i]->client_process_work_threaded_data.pending_request = NULL;
+    }
+
+    aws_s3_buffer_pool_release_reservation(
+        mock_client->buffer_pool, aws_s3_buffer_pool_get_reserved(mock_client->buffer_pool));
+
+    for (uint32_t i = 0; i < num_work_shards; ++i) {
+        struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[i];
+
+        while (!aws_linked_list_empty(&work_shard->threaded_data.meta_requests)) {
+            struct aws_linked_list_node *meta_request_node =
+                aws_linked_list_pop_front(&work_shard->threaded_data.meta_requests);
+
+            struct aws_s3_meta_request *meta_request =
+                AWS_CONTAINER_OF(meta_request_node, struct aws_s3_meta_request, client_process_work_threaded_data);
+
+            aws_s3_meta_request_release(meta_request);
+        }
+
+        aws_s3_meta_request_release(meta_requests[i]);
+    }
+
+    aws_s3_buffer_pool_destroy(mock_client->buffer_pool);
+    mock_client->buffer_pool = NULL;
+    aws_s3_client_release(mock_client);
+    aws_s3_tester_clean_up(&tester);
+    return 0;
+}
+
 struct s3_test_update_connections_finish_result_user_data {
     struct aws_s3_request *finished_request;
     struct aws_s3_request *create_connection_request;
@@ -862,6 +1647,9 @@ static int s_test_s3_client_update_connections_finish_result(struct aws_allocato
     AWS_ZERO_STRUCT(mock_client_bootstrap);
 
     struct aws_s3_client *mock_client = aws_s3_tester_mock_client_new(&tester);
+    struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[0];
+    struct aws_linked_list *normal_request_queue =
+        &work_shard->threaded_data.request_queues[AWS_S3_META_REQUEST_PRIORITY_NORMAL];
     mock_client->client_bootstrap = &mock_client_bootstrap;
     mock_client->vtable->get_host_address_count = s_test_update_conns_finish_result_host_address_count;
     mock_client->vtable->create_connection_for_request =
@@ -869,19 +1657,20 @@ static int s_test_s3_client_update_connections_finish_result(struct aws_allocato
 
     *((uint32_t *)&mock_client->ideal_vip_count) = 1;
 
-    aws_linked_list_init(&mock_client->threaded_data.request_queue);
 
     /* Verify that the request does not get sent because the meta request has finish-result. */
     {
         struct aws_s3_request *request = aws_s3_request_new(mock_meta_request, 0, 0, 0);
-        aws_linked_list_push_back(&mock_client->threaded_data.request_queue, &request->node);
-        ++mock_client->threaded_data.request_queue_size;
+        struct aws_linked_list request_list;
+        aws_linked_list_init(&request_list);
+        aws_linked_list_push_back(&request_list, &request->node);
+        aws_s3_client_queue_requests_threaded(work_shard, &request_list, false);
 
-        aws_s3_client_update_connections_threaded(mock_client);
+        aws_s3_client_update_connections_threaded(work_shard);
 
         /* Request should still have been dequeued, but immediately passed to the meta request finish function. */
-        ASSERT_TRUE(mock_client->threaded_data.request_queue_size == 0);
-        ASSERT_TRUE(aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+        ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 0);
+        ASSERT_TRUE(aws_linked_list_empty(normal_request_queue));
 
         ASSERT_TRUE(test_update_connections_finish_result_user_data.finished_request == request);
         ASSERT_TRUE(test_update_connections_finish_result_user_data.finished_request_call_counter == 1);
@@ -895,14 +1684,16 @@ static int s_test_s3_client_update_connections_finish_result(struct aws_allocato
     /* Verify that a request with the 'always send' flag still gets sent when the meta request has a finish-result. */
     {
         struct aws_s3_request *request = aws_s3_request_new(mock_meta_request, 0, 0, AWS_S3_REQUEST_FLAG_ALWAYS_SEND);
-        aws_linked_list_push_back(&mock_client->threaded_data.request_queue, &request->node);
-        ++mock_client->threaded_data.request_queue_size;
+        struct aws_linked_list request_list;
+        aws_linked_list_init(&request_list);
+        aws_linked_list_push_back(&request_list, &request->node);
+        aws_s3_client_queue_requests_threaded(work_shard, &request_list, false);
 
-        aws_s3_client_update_connections_threaded(mock_client);
+        aws_s3_client_update_connections_threaded(work_shard);
 
         /* Request should have been dequeued, and then sent on a connection. */
-        ASSERT_TRUE(mock_client->threaded_data.request_queue_size == 0);
-        ASSERT_TRUE(aws_linked_list_empty(&mock_client->threaded_data.request_queue));
+        ASSERT_TRUE(work_shard->threaded_data.request_queue_size == 0);
+        ASSERT_TRUE(aws_linked_list_empty(normal_request_queue));
 
         ASSERT_TRUE(test_update_connections_finish_result_user_data.finished_request == NULL);
         ASSERT_TRUE(test_update_connections_finish_result_user_data.finished_request_call_counter == 0);
@@ -1059,6 +1850,118 @@ static int s_test_s3_no_signing(struct aws_allocator *allocator, void *ctx) {
     return 0;
 }
 
+#define VECTORED_GET_TEST_NUM_RANGES 4
+
+struct vectored_get_test_data {
+    struct aws_s3_tester *tester;
+    struct aws_s3_byte_range ranges[VECTORED_GET_TEST_NUM_RANGES];
+    uint64_t next_offsets[VECTORED_GET_TEST_NUM_RANGES];
+    bool out_of_order;
+    int error_code;
+};
+
+static int s_vectored_get_test_range_body(
+    struct aws_s3_vectored_get *vectored_get,
+    size_t range_index,
+    const struct aws_byte_cursor *body,
+    uint64_t offset,
+    void *user_data) {
+    (void)vectored_get;
+    struct vectored_get_test_data *test_data = user_data;
+
+    if (range_index >= VECTORED_GET_TEST_NUM_RANGES || offset != test_data->next_offsets[range_index] ||
+        offset + body->len - 1 > test_data->ranges[range_index].end) {
+        test_data->out_of_order = true;
+    } else {
+        test_data->next_offsets[range_index] += body->len;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_vectored_get_test_finish(
+    struct aws_s3_vectored_get *vectored_get,
+    int error_code,
+    int response_status,
+    void *user_data) {
+    (void)vectored_get;
+    (void)response_status;
+    struct vectored_get_test_data *test_data = user_data;
+
+    test_data->error_code = error_code;
+    aws_s3_tester_inc_counter1(test_data->tester);
+}
+
+/* Test that the ranges of a vectored get all come back whole and in order, with nearby ranges coalesced, ranges that
+ * overlap, and a range far enough from the others to be fetched on its own. */
+AWS_TEST_CASE(test_s3_vectored_get, s_test_s3_vectored_get)
+static int s_test_s3_vectored_get(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_tester_client_options client_options = {
+        .part_size = 64 * 1024,
+    };
+
+    struct aws_s3_client *client = NULL;
+    ASSERT_SUCCESS(aws_s3_tester_client_new(&tester, &client_options, &client));
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+    struct aws_http_message *message = aws_s3_test_get_object_request_new(
+        allocator, aws_byte_cursor_from_string(host_name), g_pre_existing_object_1MB);
+
+    struct vectored_get_test_data test_data = {
+        .tester = &tester,
+        .ranges =
+            {
+                {.start = 1000, .end = 1999},
+                {.start = 0, .end = 99},
+                {.start = 50, .end = 499},
+                {.start = 512 * 1024, .end = 700 * 1024},
+            },
+    };
+
+    for (size_t i = 0; i < VECTORED_GET_TEST_NUM_RANGES; ++i) {
+        test_data.next_offsets[i] = test_data.ranges[i].start;
+    }
+
+    struct aws_s3_vectored_get_options options = {
+        .client = client,
+        .message = message,
+        .ranges = test_data.ranges,
+        .num_ranges = VECTORED_GET_TEST_NUM_RANGES,
+        .max_coalesce_gap = 4 * 1024,
+        .range_body_callback = s_vectored_get_test_range_body,
+        .finish_callback = s_vectored_get_test_finish,
+        .user_data = &test_data,
+    };
+
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+
+    struct aws_s3_vectored_get *vectored_get = aws_s3_vectored_get_new(allocator, &options);
+    ASSERT_NOT_NULL(vectored_get);
+
+    aws_s3_tester_wait_for_counters(&tester);
+
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, test_data.error_code);
+    ASSERT_FALSE(test_data.out_of_order);
+
+    for (size_t i = 0; i < VECTORED_GET_TEST_NUM_RANGES; ++i) {
+        ASSERT_UINT_EQUALS(test_data.ranges[i].end + 1, test_data.next_offsets[i]);
+    }
+
+    aws_s3_vectored_get_release(vectored_get);
+    aws_http_message_release(message);
+    aws_string_destroy(host_name);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 AWS_TEST_CASE(test_s3_signing_override, s_test_s3_signing_override)
 static int s_test_s3_signing_override(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -1191,81 +2094,795 @@ static int s_test_s3_put_object_with_part_remainder(struct aws_allocator *alloca
     return 0;
 }
 
-AWS_TEST_CASE(test_s3_get_object_multiple, s_test_s3_get_object_multiple)
-static int s_test_s3_get_object_multiple(struct aws_allocator *allocator, void *ctx) {
+static int s_test_s3_get_object_multiple_helper(struct aws_allocator *allocator, uint32_t num_work_event_loops) {
+    const struct aws_byte_cursor test_object_path = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("/get_object_test_1MB.txt");
+
+    struct aws_s3_meta_request *meta_requests[4];
+    struct aws_s3_meta_request_test_results meta_request_test_results[4];
+    size_t num_meta_requests = sizeof(meta_requests) / sizeof(struct aws_s3_meta_request *);
+
+    ASSERT_TRUE(
+        num_meta_requests == (sizeof(meta_request_test_results) / sizeof(struct aws_s3_meta_request_test_results)));
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config = {
+        .part_size = 64 * 1024,
+        .num_work_event_loops = num_work_event_loops,
+    };
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_TRUE(client != NULL);
+    ASSERT_TRUE(client->num_work_shards >= 1);
+    ASSERT_TRUE(client->num_work_shards <= (num_work_event_loops > 1 ? num_work_event_loops : 1));
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+
+    for (size_t i = 0; i < num_meta_requests; ++i) {
+        /* Put together a simple S3 Get Object request. */
+        struct aws_http_message *message =
+            aws_s3_test_get_object_request_new(allocator, aws_byte_cursor_from_string(host_name), test_object_path);
+
+        AWS_ZERO_STRUCT(meta_request_test_results[i]);
+
+        struct aws_s3_meta_request_options options;
+        AWS_ZERO_STRUCT(options);
+        options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+        options.message = message;
+
+        ASSERT_SUCCESS(aws_s3_tester_bind_meta_request(&tester, &options, &meta_request_test_results[i]));
+
+        /* Trigger accelerating of our Get Object request. */
+        meta_requests[i] = aws_s3_client_make_meta_request(client, &options);
+
+        ASSERT_TRUE(meta_requests[i] != NULL);
+
+        /* Meta requests are handed to the work shards round robin. */
+        ASSERT_TRUE(meta_requests[i]->work_shard == &client->work_shards[i % client->num_work_shards]);
+
+        aws_http_message_release(message);
+    }
+
+    /* Wait for the request to finish. */
+    aws_s3_tester_wait_for_meta_request_finish(&tester);
+
+    aws_s3_tester_lock_synced_data(&tester);
+    ASSERT_TRUE(tester.synced_data.finish_error_code == AWS_ERROR_SUCCESS);
+    aws_s3_tester_unlock_synced_data(&tester);
+
+    struct aws_s3_client_metrics client_metrics;
+    aws_s3_client_get_metrics(client, &client_metrics);
+    ASSERT_TRUE(client_metrics.num_bytes_transferred > 0);
+
+    for (size_t i = 0; i < num_meta_requests; ++i) {
+        struct aws_s3_meta_request_metrics meta_request_metrics;
+        aws_s3_meta_request_get_metrics(meta_requests[i], &meta_request_metrics);
+
+        ASSERT_TRUE(meta_request_metrics.num_bytes_transferred > 0);
+        ASSERT_TRUE(meta_request_metrics.num_requests_succeeded > 0);
+        ASSERT_UINT_EQUALS(0, meta_request_metrics.num_requests_failed);
+        ASSERT_UINT_EQUALS(0, meta_request_metrics.num_active_connections);
+    }
+
+    for (size_t i = 0; i < num_meta_requests; ++i) {
+        aws_s3_meta_request_release(meta_requests[i]);
+        meta_requests[i] = NULL;
+    }
+
+    aws_s3_tester_wait_for_meta_request_shutdown(&tester);
+
+    for (size_t i = 0; i < num_meta_requests; ++i) {
+        aws_s3_tester_validate_get_object_results(&meta_request_test_results[i], 0);
+        aws_s3_meta_request_test_results_clean_up(&meta_request_test_results[i]);
+    }
+
+    aws_string_destroy(host_name);
+    host_name = NULL;
+
+    aws_s3_client_release(client);
+    client = NULL;
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_s3_get_object_multiple, s_test_s3_get_object_multiple)
+static int s_test_s3_get_object_multiple(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    return s_test_s3_get_object_multiple_helper(allocator, 0);
+}
+
+/* Same as test_s3_get_object_multiple, but with the meta requests spread over several work shards. */
+AWS_TEST_CASE(test_s3_get_object_multiple_work_shards, s_test_s3_get_object_multiple_work_shards)
+static int s_test_s3_get_object_multiple_work_shards(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    return s_test_s3_get_object_multiple_helper(allocator, 4);
+}
+
+/* Test that a sent part that holds up delivery for longer than parts take gets hedged, and that a failure of only one of
+ * its two requests doesn't fail the meta request. The meta request is driven directly, so nothing is actually sent. */
+AWS_TEST_CASE(test_s3_get_object_part_hedging, s_test_s3_get_object_part_hedging)
+static int s_test_s3_get_object_part_hedging(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+
+    struct aws_http_message *message = aws_s3_test_get_object_request_new(
+        allocator, aws_byte_cursor_from_string(host_name), g_s3_path_get_object_test_1MB);
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = message,
+        .enable_part_hedging = true,
+    };
+
+    const size_t part_size = 1024;
+    const uint32_t num_parts = 3;
+
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_meta_request_auto_ranged_get_new(allocator, client, part_size, &options);
+    ASSERT_NOT_NULL(meta_request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    /* Skip discovering the object size. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_get->synced_data.object_range_known = true;
+    auto_ranged_get->synced_data.object_range_start = 0;
+    auto_ranged_get->synced_data.object_range_end = part_size * num_parts - 1;
+    auto_ranged_get->synced_data.total_num_parts = num_parts;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    struct aws_s3_request *part_requests[3] = {NULL};
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[i]));
+        ASSERT_NOT_NULL(part_requests[i]);
+        ASSERT_UINT_EQUALS(i + 1, part_requests[i]->part_number);
+    }
+
+    /* Nothing is straggling yet. */
+    struct aws_s3_request *hedge_request = NULL;
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &hedge_request));
+    ASSERT_NULL(hedge_request);
+
+    uint64_t now_ns = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&now_ns));
+
+    /* Pretend that part 1 has been holding up delivery of the other parts for 2 seconds, with parts taking 5 seconds
+     * each. That is how long a part takes on this link, so it isn't hedged. */
+    const uint64_t head_of_line_ns = 2ULL * AWS_TIMESTAMP_NANOS;
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_get->synced_data.head_of_line_part_number = 1;
+    auto_ranged_get->synced_data.head_of_line_timestamp_ns = now_ns - head_of_line_ns;
+
+    for (uint32_t i = 0; i < AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES; ++i) {
+        auto_ranged_get->synced_data.part_latency_samples_ns[i] = 5ULL * AWS_TIMESTAMP_NANOS;
+    }
+
+    auto_ranged_get->synced_data.num_part_latency_samples = AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    meta_request->vtable->request_sent(meta_request, part_requests[0]);
+
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &hedge_request));
+    ASSERT_NULL(hedge_request);
+
+    /* With parts taking half a second, it has been holding up delivery for too long, but it can only be hedged once it
+     * has actually been sent. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+
+    for (uint32_t i = 0; i < AWS_S3_AUTO_RANGED_GET_NUM_PART_LATENCY_SAMPLES; ++i) {
+        auto_ranged_get->synced_data.part_latency_samples_ns[i] = AWS_TIMESTAMP_NANOS / 2;
+    }
+
+    struct aws_s3_auto_ranged_get_part_in_flight *part_in_flight = NULL;
+
+    for (size_t i = 0; i < aws_array_list_length(&auto_ranged_get->synced_data.parts_in_flight); ++i) {
+        aws_array_list_get_at_ptr(&auto_ranged_get->synced_data.parts_in_flight, (void **)&part_in_flight, i);
+
+        if (part_in_flight->part_number == 1) {
+            break;
+        }
+    }
+
+    ASSERT_UINT_EQUALS(1, part_in_flight->part_number);
+    ASSERT_TRUE(part_in_flight->start_timestamp_ns >= now_ns);
+
+    const uint64_t sent_timestamp_ns = part_in_flight->start_timestamp_ns;
+    part_in_flight->start_timestamp_ns = 0;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &hedge_request));
+    ASSERT_NULL(hedge_request);
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    part_in_flight->start_timestamp_ns = sent_timestamp_ns;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &hedge_request));
+    ASSERT_NOT_NULL(hedge_request);
+    ASSERT_UINT_EQUALS(1, hedge_request->part_number);
+    ASSERT_UINT_EQUALS(part_requests[0]->part_range_start, hedge_request->part_range_start);
+    ASSERT_UINT_EQUALS(part_requests[0]->part_range_end, hedge_request->part_range_end);
+
+    /* A part is only hedged once. */
+    struct aws_s3_request *no_request = NULL;
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    /* While the original request is still in flight, a failure of the hedge is not a failure of the part. */
+    aws_s3_meta_request_finished_request(meta_request, hedge_request, AWS_ERROR_S3_INTERNAL_ERROR);
+    ASSERT_FALSE(aws_s3_meta_request_has_finish_result(meta_request));
+    ASSERT_UINT_EQUALS(0, auto_ranged_get->synced_data.num_parts_completed);
+    ASSERT_UINT_EQUALS(0, auto_ranged_get->synced_data.num_hedges_in_flight);
+
+    /* Once the original request fails too, the part has failed. */
+    aws_s3_meta_request_finished_request(meta_request, part_requests[0], AWS_ERROR_S3_INTERNAL_ERROR);
+    ASSERT_TRUE(aws_s3_meta_request_has_finish_result(meta_request));
+    ASSERT_UINT_EQUALS(1, auto_ranged_get->synced_data.num_parts_completed);
+    ASSERT_UINT_EQUALS(1, auto_ranged_get->synced_data.num_parts_failed);
+
+    for (uint32_t i = 1; i < num_parts; ++i) {
+        aws_s3_meta_request_finished_request(meta_request, part_requests[i], AWS_ERROR_S3_CANCELED);
+    }
+
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&auto_ranged_get->synced_data.parts_in_flight));
+
+    aws_s3_request_release(hedge_request);
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        aws_s3_request_release(part_requests[i]);
+    }
+
+    aws_s3_meta_request_release(meta_request);
+    aws_http_message_release(message);
+    aws_string_destroy(host_name);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that part requests of a meta request with direct body streaming enabled are marked for it, and that direct body
+ * streaming can't be combined with part hedging. The meta request is driven directly, so nothing is actually sent. */
+AWS_TEST_CASE(test_s3_get_object_direct_body_streaming, s_test_s3_get_object_direct_body_streaming)
+static int s_test_s3_get_object_direct_body_streaming(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+
+    struct aws_http_message *message = aws_s3_test_get_object_request_new(
+        allocator, aws_byte_cursor_from_string(host_name), g_s3_path_get_object_test_1MB);
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = message,
+        .enable_part_hedging = true,
+        .enable_direct_body_streaming = true,
+    };
+
+    const size_t part_size = 1024;
+    const uint32_t num_parts = 2;
+
+    ASSERT_NULL(aws_s3_meta_request_auto_ranged_get_new(allocator, client, part_size, &options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    options.enable_part_hedging = false;
+
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_meta_request_auto_ranged_get_new(allocator, client, part_size, &options);
+    ASSERT_NOT_NULL(meta_request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    /* Skip discovering the object size. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_get->synced_data.object_range_known = true;
+    auto_ranged_get->synced_data.object_range_start = 0;
+    auto_ranged_get->synced_data.object_range_end = part_size * num_parts - 1;
+    auto_ranged_get->synced_data.total_num_parts = num_parts;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    struct aws_s3_request *part_requests[2] = {NULL};
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[i]));
+        ASSERT_NOT_NULL(part_requests[i]);
+        ASSERT_TRUE(part_requests[i]->stream_response_body_directly);
+        ASSERT_FALSE(part_requests[i]->streaming_response_body_directly);
+    }
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        aws_s3_meta_request_finished_request(meta_request, part_requests[i], AWS_ERROR_S3_CANCELED);
+        aws_s3_request_release(part_requests[i]);
+    }
+
+    aws_s3_meta_request_release(meta_request);
+    aws_http_message_release(message);
+    aws_string_destroy(host_name);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_s3_get_object_unordered_delivery, s_test_s3_get_object_unordered_delivery)
+static int s_test_s3_get_object_unordered_delivery(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_tester_client_options client_options = {
+        .part_size = 64 * 1024,
+    };
+
+    struct aws_s3_client *client = NULL;
+    ASSERT_SUCCESS(aws_s3_tester_client_new(&tester, &client_options, &client));
+
+    struct aws_s3_tester_meta_request_options options = {
+        .allocator = allocator,
+        .client = client,
+        .meta_request_type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .validate_type = AWS_S3_TESTER_VALIDATE_TYPE_EXPECT_SUCCESS,
+        .get_options =
+            {
+                .object_path = g_pre_existing_object_1MB,
+                .delivery = AWS_S3_META_REQUEST_DELIVERY_UNORDERED,
+            },
+    };
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request_with_options(&tester, &options, NULL));
+
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that an object downloaded with a small first part, and parts that grow after it, gets through whole. The part
+ * size is small enough that parts actually get to grow. */
+AWS_TEST_CASE(test_s3_get_object_variable_part_size, s_test_s3_get_object_variable_part_size)
+static int s_test_s3_get_object_variable_part_size(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_tester_client_options client_options = {
+        .part_size = 4 * 1024,
+    };
+
+    struct aws_s3_client *client = NULL;
+    ASSERT_SUCCESS(aws_s3_tester_client_new(&tester, &client_options, &client));
+
+    struct aws_s3_tester_meta_request_options options = {
+        .allocator = allocator,
+        .client = client,
+        .meta_request_type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .validate_type = AWS_S3_TESTER_VALIDATE_TYPE_EXPECT_SUCCESS,
+        .get_options =
+            {
+                .object_path = g_pre_existing_object_1MB,
+                .enable_variable_part_size = true,
+            },
+    };
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request_with_options(&tester, &options, NULL));
+
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+struct small_object_hint_test_data {
+    uint32_t num_body_callbacks;
+    uint32_t num_body_callbacks_off_connection_thread;
+};
+
+/* Returns true if the calling thread is one of the event loop group's. */
+static bool s_is_on_event_loop_group_thread(struct aws_event_loop_group *event_loop_group) {
+    for (size_t i = 0; i < aws_event_loop_group_get_loop_count(event_loop_group); ++i) {
+        if (aws_event_loop_thread_is_callers_thread(aws_event_loop_group_get_loop_at(event_loop_group, i))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int s_small_object_hint_body_callback(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_byte_cursor *body,
+    uint64_t range_start,
+    void *user_data) {
+    (void)body;
+    (void)range_start;
+
+    struct aws_s3_meta_request_test_results *meta_request_test_results = user_data;
+    struct small_object_hint_test_data *test_data = meta_request_test_results->tester->user_data;
+
+    /* Delivered inline, the body comes from the connection I/O event loops, not from the body streaming ones. */
+    struct aws_s3_client *client = meta_request->client;
+
+    ++test_data->num_body_callbacks;
+
+    if (!s_is_on_event_loop_group_thread(client->client_bootstrap->event_loop_group) ||
+        s_is_on_event_loop_group_thread(client->body_streaming_elg)) {
+        ++test_data->num_body_callbacks_off_connection_thread;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that a GET hinted as a small object is fetched with a single request, and that its body is delivered inline,
+ * from the thread of the connection it arrived on. The part size is small enough that without the hint the GET is
+ * split in many parts. */
+AWS_TEST_CASE(test_s3_small_object_hint, s_test_s3_small_object_hint)
+static int s_test_s3_small_object_hint(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct small_object_hint_test_data test_data;
+    AWS_ZERO_STRUCT(test_data);
+    tester.user_data = &test_data;
+
+    struct aws_s3_tester_client_options client_options = {
+        .part_size = 64 * 1024,
+    };
+
+    struct aws_s3_client *client = NULL;
+    ASSERT_SUCCESS(aws_s3_tester_client_new(&tester, &client_options, &client));
+
+    /* Without the hint, the GET is split in parts. */
+    {
+        struct aws_s3_tester_meta_request_options options = {
+            .allocator = allocator,
+            .client = client,
+            .meta_request_type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+            .validate_type = AWS_S3_TESTER_VALIDATE_TYPE_EXPECT_SUCCESS,
+            .get_options =
+                {
+                    .object_path = g_pre_existing_object_1MB,
+                },
+        };
+
+        struct aws_s3_meta_request_test_results meta_request_test_results;
+        AWS_ZERO_STRUCT(meta_request_test_results);
+
+        ASSERT_SUCCESS(aws_s3_tester_send_meta_request_with_options(&tester, &options, &meta_request_test_results));
+        ASSERT_TRUE(meta_request_test_results.num_telemetry_callbacks > 1);
+
+        aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+    }
+
+    /* With it, there is a single request (one telemetry callback per request), whose body is delivered inline. */
+    {
+        struct aws_s3_tester_meta_request_options options = {
+            .allocator = allocator,
+            .client = client,
+            .meta_request_type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+            .validate_type = AWS_S3_TESTER_VALIDATE_TYPE_EXPECT_SUCCESS,
+            .small_object_hint = true,
+            .body_callback = s_small_object_hint_body_callback,
+            .get_options =
+                {
+                    .object_path = g_pre_existing_object_1MB,
+                },
+        };
+
+        struct aws_s3_meta_request_test_results meta_request_test_results;
+        AWS_ZERO_STRUCT(meta_request_test_results);
+
+        ASSERT_SUCCESS(aws_s3_tester_send_meta_request_with_options(&tester, &options, &meta_request_test_results));
+        ASSERT_UINT_EQUALS(1, meta_request_test_results.num_telemetry_callbacks);
+
+        aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+    }
+
+    ASSERT_TRUE(test_data.num_body_callbacks > 0);
+    ASSERT_UINT_EQUALS(0, test_data.num_body_callbacks_off_connection_thread);
+
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that with read backpressure, parts are only requested as far as the read window has been opened. The meta
+ * request is driven directly, so nothing is actually sent. */
+AWS_TEST_CASE(test_s3_get_object_read_backpressure, s_test_s3_get_object_read_backpressure)
+static int s_test_s3_get_object_read_backpressure(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    const size_t part_size = 1024;
+    const uint32_t num_parts = 3;
+
+    struct aws_s3_client_config client_config = {
+        .enable_read_backpressure = true,
+        .initial_read_window = part_size / 2,
+    };
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+
+    struct aws_http_message *message = aws_s3_test_get_object_request_new(
+        allocator, aws_byte_cursor_from_string(host_name), g_s3_path_get_object_test_1MB);
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = message,
+    };
+
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_meta_request_auto_ranged_get_new(allocator, client, part_size, &options);
+    ASSERT_NOT_NULL(meta_request);
+
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    /* Skip discovering the object size. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_get->synced_data.object_range_known = true;
+    auto_ranged_get->synced_data.object_range_start = 0;
+    auto_ranged_get->synced_data.object_range_end = part_size * num_parts - 1;
+    auto_ranged_get->synced_data.total_num_parts = num_parts;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    struct aws_s3_request *part_requests[3] = {NULL};
+    struct aws_s3_request *no_request = NULL;
+
+    /* The initial window only covers the first part. */
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[0]));
+    ASSERT_NOT_NULL(part_requests[0]);
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    /* Opening the window up to the start of the second part is not enough. */
+    aws_s3_meta_request_increment_read_window(meta_request, part_size / 2);
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    /* Once the window reaches into the second part, it goes out, but the third one doesn't. */
+    aws_s3_meta_request_increment_read_window(meta_request, 1);
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[1]));
+    ASSERT_NOT_NULL(part_requests[1]);
+    ASSERT_UINT_EQUALS(2, part_requests[1]->part_number);
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    aws_s3_meta_request_increment_read_window(meta_request, part_size);
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[2]));
+    ASSERT_NOT_NULL(part_requests[2]);
+    ASSERT_UINT_EQUALS(3, part_requests[2]->part_number);
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        aws_s3_meta_request_finished_request(meta_request, part_requests[i], AWS_ERROR_S3_CANCELED);
+        aws_s3_request_release(part_requests[i]);
+    }
+
+    aws_s3_meta_request_release(meta_request);
+    aws_http_message_release(message);
+    aws_string_destroy(host_name);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that with a checkpoint, parts that it covers are not requested, and that every request is pinned to its ETag.
+ * The meta request is driven directly, so nothing is actually sent. */
+AWS_TEST_CASE(test_s3_get_object_checkpoint, s_test_s3_get_object_checkpoint)
+static int s_test_s3_get_object_checkpoint(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
-    const struct aws_byte_cursor test_object_path = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("/get_object_test_1MB.txt");
-
-    struct aws_s3_meta_request *meta_requests[4];
-    struct aws_s3_meta_request_test_results meta_request_test_results[4];
-    size_t num_meta_requests = sizeof(meta_requests) / sizeof(struct aws_s3_meta_request *);
-
-    ASSERT_TRUE(
-        num_meta_requests == (sizeof(meta_request_test_results) / sizeof(struct aws_s3_meta_request_test_results)));
-
     struct aws_s3_tester tester;
     AWS_ZERO_STRUCT(tester);
     ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
 
-    struct aws_s3_client_config client_config = {
-        .part_size = 64 * 1024,
-    };
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
 
     ASSERT_SUCCESS(aws_s3_tester_bind_client(
         &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
 
     struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
 
     struct aws_string *host_name =
         aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
 
-    for (size_t i = 0; i < num_meta_requests; ++i) {
-        /* Put together a simple S3 Get Object request. */
-        struct aws_http_message *message =
-            aws_s3_test_get_object_request_new(allocator, aws_byte_cursor_from_string(host_name), test_object_path);
+    struct aws_http_message *message = aws_s3_test_get_object_request_new(
+        allocator, aws_byte_cursor_from_string(host_name), g_s3_path_get_object_test_1MB);
 
-        AWS_ZERO_STRUCT(meta_request_test_results[i]);
+    /* Parts are 8 bytes of a 40 byte object. The checkpoint covers parts 2, 3 and 5, but only half of part 4. */
+    const size_t part_size = 8;
+    const struct aws_byte_cursor etag = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("\"checkpoint-etag\"");
 
-        struct aws_s3_meta_request_options options;
-        AWS_ZERO_STRUCT(options);
-        options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
-        options.message = message;
+    const struct aws_s3_byte_range completed_ranges[] = {
+        {.start = 16, .end = 23},
+        {.start = 8, .end = 15},
+        {.start = 28, .end = 39},
+    };
 
-        ASSERT_SUCCESS(aws_s3_tester_bind_meta_request(&tester, &options, &meta_request_test_results[i]));
+    struct aws_s3_get_object_checkpoint checkpoint = {
+        .etag = etag,
+        .completed_ranges = completed_ranges,
+        .num_completed_ranges = AWS_ARRAY_SIZE(completed_ranges),
+    };
 
-        /* Trigger accelerating of our Get Object request. */
-        meta_requests[i] = aws_s3_client_make_meta_request(client, &options);
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = message,
+        .get_checkpoint = &checkpoint,
+    };
 
-        ASSERT_TRUE(meta_requests[i] != NULL);
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_meta_request_auto_ranged_get_new(allocator, client, part_size, &options);
+    ASSERT_NOT_NULL(meta_request);
 
-        aws_http_message_release(message);
+    struct aws_s3_auto_ranged_get *auto_ranged_get = meta_request->impl;
+
+    /* Skip discovering the object size, leaving out the parts covered by the checkpoint as that would. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_get->synced_data.object_range_known = true;
+    auto_ranged_get->synced_data.object_range_start = 0;
+    auto_ranged_get->synced_data.object_range_end = 39;
+    auto_ranged_get->synced_data.num_parts_covered = 3;
+    auto_ranged_get->synced_data.total_num_parts = 2;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    struct aws_s3_request *part_requests[2] = {NULL};
+    struct aws_s3_request *no_request = NULL;
+    const uint64_t expected_part_ranges[] = {0, 7, 24, 31};
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[i]));
+        ASSERT_NOT_NULL(part_requests[i]);
+        ASSERT_UINT_EQUALS(i + 1, part_requests[i]->part_number);
+        ASSERT_TRUE(part_requests[i]->part_range_start == expected_part_ranges[i * 2]);
+        ASSERT_TRUE(part_requests[i]->part_range_end == expected_part_ranges[i * 2 + 1]);
+
+        ASSERT_SUCCESS(meta_request->vtable->prepare_request(meta_request, part_requests[i]));
+
+        struct aws_byte_cursor if_match;
+        ASSERT_SUCCESS(aws_http_headers_get(
+            aws_http_message_get_headers(part_requests[i]->send_data.message), g_if_match_header_name, &if_match));
+        ASSERT_TRUE(aws_byte_cursor_eq(&if_match, &etag));
     }
 
-    /* Wait for the request to finish. */
-    aws_s3_tester_wait_for_meta_request_finish(&tester);
-
-    aws_s3_tester_lock_synced_data(&tester);
-    ASSERT_TRUE(tester.synced_data.finish_error_code == AWS_ERROR_SUCCESS);
-    aws_s3_tester_unlock_synced_data(&tester);
+    /* Nothing is left to request. */
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
 
-    for (size_t i = 0; i < num_meta_requests; ++i) {
-        aws_s3_meta_request_release(meta_requests[i]);
-        meta_requests[i] = NULL;
+    for (uint32_t i = 0; i < 2; ++i) {
+        aws_s3_meta_request_finished_request(meta_request, part_requests[i], AWS_ERROR_S3_CANCELED);
+        aws_s3_request_release(part_requests[i]);
     }
 
-    aws_s3_tester_wait_for_meta_request_shutdown(&tester);
+    aws_s3_meta_request_release(meta_request);
+    aws_http_message_release(message);
+    aws_string_destroy(host_name);
+    aws_s3_client_release(client);
 
-    for (size_t i = 0; i < num_meta_requests; ++i) {
-        aws_s3_tester_validate_get_object_results(&meta_request_test_results[i], 0);
-        aws_s3_meta_request_test_results_clean_up(&meta_request_test_results[i]);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that GET meta requests validating checksums ask S3 for them, and that others don't. */
+AWS_TEST_CASE(test_s3_get_object_checksum_mode, s_test_s3_get_object_checksum_mode)
+static int s_test_s3_get_object_checksum_mode(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_bucket_name, &g_test_s3_region);
+
+    struct aws_http_message *message = aws_s3_test_get_object_request_new(
+        allocator, aws_byte_cursor_from_string(host_name), g_s3_path_get_object_test_1MB);
+
+    for (int validate = 0; validate < 2; ++validate) {
+        struct aws_s3_meta_request_options options = {
+            .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+            .message = message,
+            .validate_response_checksum = validate != 0,
+        };
+
+        struct aws_s3_meta_request *meta_request =
+            aws_s3_meta_request_auto_ranged_get_new(allocator, client, 8, &options);
+        ASSERT_NOT_NULL(meta_request);
+        ASSERT_TRUE(meta_request->validate_response_checksum == (validate != 0));
+
+        struct aws_s3_request *request = NULL;
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &request));
+        ASSERT_NOT_NULL(request);
+        ASSERT_SUCCESS(meta_request->vtable->prepare_request(meta_request, request));
+
+        struct aws_byte_cursor checksum_mode;
+        struct aws_http_headers *headers = aws_http_message_get_headers(request->send_data.message);
+
+        if (validate) {
+            ASSERT_SUCCESS(aws_http_headers_get(headers, g_checksum_mode_header_name, &checksum_mode));
+            ASSERT_CURSOR_VALUE_CSTRING_EQUALS(checksum_mode, "ENABLED");
+        } else {
+            ASSERT_FALSE(aws_http_headers_has(headers, g_checksum_mode_header_name));
+        }
+
+        aws_s3_meta_request_finished_request(meta_request, request, AWS_ERROR_S3_CANCELED);
+        aws_s3_request_release(request);
+        aws_s3_meta_request_release(meta_request);
     }
 
+    aws_http_message_release(message);
     aws_string_destroy(host_name);
-    host_name = NULL;
-
     aws_s3_client_release(client);
-    client = NULL;
 
     aws_s3_tester_clean_up(&tester);
 
@@ -1553,6 +3170,361 @@ static int s_test_s3_put_object_empty_object(struct aws_allocator *allocator, vo
     return 0;
 }
 
+/* Fills the buffer with the low byte of each offset, so that where data was read from can be checked. */
+static int s_test_s3_put_object_read_body_at(
+    struct aws_s3_meta_request *meta_request,
+    uint64_t offset,
+    struct aws_byte_buf *dest,
+    void *user_data) {
+    (void)meta_request;
+
+    uint32_t *num_reads = user_data;
+    ++(*num_reads);
+
+    while (dest->len < dest->capacity) {
+        aws_byte_buf_write_u8(dest, (uint8_t)(offset + dest->len));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that with a body that can be read at any offset, each part is read at its own offset rather than from the body
+ * stream. The meta request is driven directly, so nothing is actually sent. */
+AWS_TEST_CASE(test_s3_put_object_read_body_at_offset, s_test_s3_put_object_read_body_at_offset)
+static int s_test_s3_put_object_read_body_at_offset(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    const size_t part_size = 8;
+    const uint64_t content_length = 20;
+
+    /* The body stream is never read from. */
+    struct aws_byte_cursor stream_cursor = aws_byte_cursor_from_c_str("ZZZZZZZZZZZZZZZZZZZZ");
+    struct aws_input_stream *input_stream = aws_input_stream_new_from_cursor(allocator, &stream_cursor);
+
+    struct aws_http_message *message = aws_s3_test_put_object_request_new(
+        allocator,
+        aws_byte_cursor_from_c_str("dummy_host"),
+        aws_byte_cursor_from_c_str("dummy_key"),
+        g_test_body_content_type,
+        input_stream,
+        AWS_S3_TESTER_SSE_NONE);
+    ASSERT_NOT_NULL(message);
+
+    uint32_t num_reads = 0;
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT,
+        .message = message,
+        .user_data = &num_reads,
+        .read_body_at_callback = s_test_s3_put_object_read_body_at,
+    };
+
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_meta_request_auto_ranged_put_new(allocator, client, part_size, content_length, 3, &options);
+    ASSERT_NOT_NULL(meta_request);
+    ASSERT_TRUE(aws_s3_meta_request_has_positional_body(meta_request));
+
+    /* Read the last part before the one in the middle, as happens when parts are prepared concurrently. */
+    struct aws_byte_buf last_part;
+    aws_byte_buf_init(&last_part, allocator, 4);
+    ASSERT_SUCCESS(aws_s3_meta_request_read_body(meta_request, 16, &last_part));
+
+    struct aws_byte_buf middle_part;
+    aws_byte_buf_init(&middle_part, allocator, part_size);
+    ASSERT_SUCCESS(aws_s3_meta_request_read_body(meta_request, 8, &middle_part));
+
+    const uint8_t expected_last_part[] = {16, 17, 18, 19};
+    const uint8_t expected_middle_part[] = {8, 9, 10, 11, 12, 13, 14, 15};
+
+    ASSERT_BIN_ARRAYS_EQUALS(expected_last_part, sizeof(expected_last_part), last_part.buffer, last_part.len);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_middle_part, sizeof(expected_middle_part), middle_part.buffer, middle_part.len);
+    ASSERT_UINT_EQUALS(2, num_reads);
+
+    aws_byte_buf_clean_up(&last_part);
+    aws_byte_buf_clean_up(&middle_part);
+
+    aws_s3_meta_request_release(meta_request);
+    aws_http_message_release(message);
+    aws_input_stream_destroy(input_stream);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Test that a body without a content length is split into parts until its stream ends, with the next part only being
+ * asked for once the one before it has been read. The body is an exact multiple of the part size, so that the end of
+ * the body is only found by reading past the last part. The meta request is driven directly, so nothing is actually
+ * sent. */
+AWS_TEST_CASE(test_s3_put_object_unknown_content_length, s_test_s3_put_object_unknown_content_length)
+static int s_test_s3_put_object_unknown_content_length(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    const size_t part_size = 8;
+    const uint32_t num_parts = 2;
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("0123456789abcdef");
+    struct aws_input_stream *input_stream = aws_input_stream_new_from_cursor(allocator, &body);
+
+    struct aws_http_message *message = aws_s3_test_put_object_request_new(
+        allocator,
+        aws_byte_cursor_from_c_str("dummy_host"),
+        aws_byte_cursor_from_c_str("dummy_key"),
+        g_test_body_content_type,
+        input_stream,
+        AWS_S3_TESTER_SSE_NONE);
+    ASSERT_NOT_NULL(message);
+
+    aws_http_headers_erase(aws_http_message_get_headers(message), g_content_length_header_name);
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT,
+        .message = message,
+    };
+
+    struct aws_s3_meta_request *meta_request = aws_s3_meta_request_auto_ranged_put_new(
+        allocator, client, part_size, AWS_S3_AUTO_RANGED_PUT_UNKNOWN_CONTENT_LENGTH, 0, &options);
+    ASSERT_NOT_NULL(meta_request);
+
+    struct aws_s3_auto_ranged_put *auto_ranged_put = meta_request->impl;
+
+    /* Skip creating the multipart upload. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_put->upload_id = aws_string_new_from_c_str(allocator, "dummy_upload_id");
+    auto_ranged_put->synced_data.create_multipart_upload_sent = true;
+    auto_ranged_put->synced_data.create_multipart_upload_completed = true;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    struct aws_s3_request *part_requests[2] = {NULL};
+    struct aws_s3_request *no_request = NULL;
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[i]));
+        ASSERT_NOT_NULL(part_requests[i]);
+        ASSERT_UINT_EQUALS(i + 1, part_requests[i]->part_number);
+
+        /* Until the part has been read, it isn't known whether there is another one. */
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+        ASSERT_NULL(no_request);
+
+        ASSERT_SUCCESS(meta_request->vtable->prepare_request(meta_request, part_requests[i]));
+
+        struct aws_byte_cursor expected_part_body = {.ptr = body.ptr + i * part_size, .len = part_size};
+        ASSERT_TRUE(aws_byte_cursor_eq_byte_buf(&expected_part_body, &part_requests[i]->request_body));
+    }
+
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    ASSERT_TRUE(auto_ranged_put->synced_data.last_part_read);
+    ASSERT_UINT_EQUALS(num_parts, auto_ranged_put->synced_data.total_num_parts);
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    /* No more parts, and the upload can't be completed before the parts are. */
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        aws_s3_meta_request_finished_request(meta_request, part_requests[i], AWS_ERROR_S3_CANCELED);
+        aws_s3_request_release(part_requests[i]);
+    }
+
+    aws_s3_meta_request_release(meta_request);
+    aws_http_message_release(message);
+    aws_input_stream_destroy(input_stream);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
+/* Finish a part request of a driven meta request as if it had been uploaded, with the given ETag. */
+static void s_test_s3_finish_uploaded_part(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    const char *etag) {
+
+    request->send_data.response_headers = aws_http_headers_new(meta_request->allocator);
+    aws_http_headers_set(request->send_data.response_headers, g_etag_header_name, aws_byte_cursor_from_c_str(etag));
+
+    aws_s3_meta_request_finished_request(meta_request, request, AWS_ERROR_SUCCESS);
+    aws_s3_request_release(request);
+}
+
+/* Test that pausing a multipart upload gives a token with the parts uploaded so far, without aborting the upload, and
+ * that resuming from that token only uploads the parts that are missing, read from where they are in the body. The
+ * meta requests are driven directly, so nothing is actually sent. */
+AWS_TEST_CASE(test_s3_put_object_pause_resume, s_test_s3_put_object_pause_resume)
+static int s_test_s3_put_object_pause_resume(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(
+        &tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION | AWS_S3_TESTER_BIND_CLIENT_SIGNING));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+
+    const size_t part_size = 8;
+    const uint64_t content_length = 20;
+    const uint32_t num_parts = 3;
+
+    struct aws_byte_cursor body = aws_byte_cursor_from_c_str("0123456789abcdefghij");
+    struct aws_input_stream *input_stream = aws_input_stream_new_from_cursor(allocator, &body);
+
+    struct aws_http_message *message = aws_s3_test_put_object_request_new(
+        allocator,
+        aws_byte_cursor_from_c_str("dummy_host"),
+        aws_byte_cursor_from_c_str("dummy_key"),
+        g_test_body_content_type,
+        input_stream,
+        AWS_S3_TESTER_SSE_NONE);
+    ASSERT_NOT_NULL(message);
+
+    struct aws_s3_meta_request_options options = {
+        .type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT,
+        .message = message,
+    };
+
+    struct aws_s3_meta_request *meta_request =
+        aws_s3_meta_request_auto_ranged_put_new(allocator, client, part_size, content_length, num_parts, &options);
+    ASSERT_NOT_NULL(meta_request);
+
+    struct aws_s3_auto_ranged_put *auto_ranged_put = meta_request->impl;
+
+    struct aws_byte_buf resume_token;
+    aws_byte_buf_init(&resume_token, allocator, 0);
+
+    /* There is nothing to resume before the multipart upload is created. */
+    ASSERT_FAILS(aws_s3_meta_request_pause(meta_request, &resume_token));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+    /* Skip creating the multipart upload. */
+    aws_s3_meta_request_lock_synced_data(meta_request);
+    auto_ranged_put->upload_id = aws_string_new_from_c_str(allocator, "dummy_upload_id");
+    auto_ranged_put->synced_data.create_multipart_upload_sent = true;
+    auto_ranged_put->synced_data.create_multipart_upload_completed = true;
+    aws_s3_meta_request_unlock_synced_data(meta_request);
+
+    struct aws_s3_request *part_requests[2] = {NULL};
+    struct aws_s3_request *no_request = NULL;
+
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[0]));
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[1]));
+    ASSERT_NOT_NULL(part_requests[0]);
+    ASSERT_NOT_NULL(part_requests[1]);
+
+    /* Part 1 is uploaded, part 2 is still in flight when the upload is paused. */
+    s_test_s3_finish_uploaded_part(meta_request, part_requests[0], "\"etag1\"");
+
+    ASSERT_SUCCESS(aws_s3_meta_request_pause(meta_request, &resume_token));
+    ASSERT_BIN_ARRAYS_EQUALS(
+        "version 1\nupload_id dummy_upload_id\npart_size 8\ntotal_num_parts 3\npart 1 etag1\n",
+        strlen("version 1\nupload_id dummy_upload_id\npart_size 8\ntotal_num_parts 3\npart 1 etag1\n"),
+        resume_token.buffer,
+        resume_token.len);
+
+    /* The in flight part is waited for, and then the meta request finishes without aborting the upload. */
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    aws_s3_meta_request_finished_request(meta_request, part_requests[1], AWS_ERROR_S3_CANCELED);
+    aws_s3_request_release(part_requests[1]);
+
+    ASSERT_FALSE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    aws_s3_meta_request_release(meta_request);
+
+    /* A token that doesn't match the body is refused. */
+    options.resume_token = aws_byte_cursor_from_buf(&resume_token);
+    ASSERT_NULL(aws_s3_meta_request_auto_ranged_put_new(allocator, client, part_size, 16, 2, &options));
+    ASSERT_INT_EQUALS(AWS_ERROR_S3_INVALID_RESUME_TOKEN, aws_last_error());
+
+    struct aws_s3_auto_ranged_put_resume_token parsed_token;
+    ASSERT_FAILS(aws_s3_auto_ranged_put_resume_token_parse(
+        allocator, aws_byte_cursor_from_c_str("version 2\nupload_id dummy_upload_id\n"), &parsed_token));
+    ASSERT_INT_EQUALS(AWS_ERROR_S3_INVALID_RESUME_TOKEN, aws_last_error());
+
+    /* Resume, from a rewound body stream. */
+    ASSERT_SUCCESS(aws_input_stream_seek(input_stream, 0, AWS_SSB_BEGIN));
+
+    meta_request =
+        aws_s3_meta_request_auto_ranged_put_new(allocator, client, part_size, content_length, num_parts, &options);
+    ASSERT_NOT_NULL(meta_request);
+
+    auto_ranged_put = meta_request->impl;
+    ASSERT_TRUE(auto_ranged_put->resumed);
+    ASSERT_TRUE(aws_string_eq_c_str(auto_ranged_put->upload_id, "dummy_upload_id"));
+
+    /* Only parts 2 and 3 are uploaded, each read from its own offset. */
+    for (uint32_t i = 0; i < 2; ++i) {
+        ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &part_requests[i]));
+        ASSERT_NOT_NULL(part_requests[i]);
+        ASSERT_UINT_EQUALS(i + 2, part_requests[i]->part_number);
+
+        ASSERT_SUCCESS(meta_request->vtable->prepare_request(meta_request, part_requests[i]));
+
+        uint64_t part_offset = (uint64_t)(i + 1) * part_size;
+        struct aws_byte_cursor expected_part_body = {
+            .ptr = body.ptr + part_offset,
+            .len = (size_t)aws_min_u64(part_size, content_length - part_offset),
+        };
+        ASSERT_TRUE(aws_byte_cursor_eq_byte_buf(&expected_part_body, &part_requests[i]->request_body));
+    }
+
+    /* The upload can't be completed before the parts are. */
+    ASSERT_TRUE(aws_s3_meta_request_update(meta_request, 0, &no_request));
+    ASSERT_NULL(no_request);
+
+    for (uint32_t i = 0; i < 2; ++i) {
+        aws_s3_meta_request_finished_request(meta_request, part_requests[i], AWS_ERROR_S3_CANCELED);
+        aws_s3_request_release(part_requests[i]);
+    }
+
+    aws_s3_meta_request_release(meta_request);
+    aws_byte_buf_clean_up(&resume_token);
+    aws_http_message_release(message);
+    aws_input_stream_destroy(input_stream);
+    aws_s3_client_release(client);
+
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 AWS_TEST_CASE(test_s3_put_object_sse_kms, s_test_s3_put_object_sse_kms)
 static int s_test_s3_put_object_sse_kms(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -1895,8 +3867,18 @@ static int s_test_s3_upload_part_message_helper(struct aws_allocator *allocator,
     uint32_t part_number = 1;
     struct aws_string *upload_id = aws_string_new_from_c_str(allocator, "dummy_upload_id");
 
+    struct aws_http_message *part_message_template = aws_s3_upload_part_message_template_new(allocator, base_message);
+
     struct aws_http_message *new_message = aws_s3_upload_part_message_new(
-        allocator, base_message, &test_buffer, part_number, upload_id, should_compute_content_md5);
+        allocator,
+        part_message_template,
+        &test_buffer,
+        part_number,
+        upload_id,
+        should_compute_content_md5,
+        AWS_SCA_NONE,
+        NULL);
+    aws_http_message_release(part_message_template);
 
     struct aws_http_headers *new_headers = aws_http_message_get_headers(new_message);
     if (should_compute_content_md5) {
@@ -1978,7 +3960,8 @@ static int s_test_s3_create_multipart_upload_message_with_content_md5(struct aws
     struct aws_http_headers *base_headers = aws_http_message_get_headers(base_message);
     ASSERT_TRUE(aws_http_headers_has(base_headers, g_content_md5_header_name));
 
-    struct aws_http_message *new_message = aws_s3_create_multipart_upload_message_new(allocator, base_message);
+    struct aws_http_message *new_message =
+        aws_s3_create_multipart_upload_message_new(allocator, base_message, AWS_SCA_NONE);
 
     struct aws_http_headers *new_headers = aws_http_message_get_headers(new_message);
     ASSERT_FALSE(aws_http_headers_has(new_headers, g_content_md5_header_name));
@@ -2034,8 +4017,8 @@ static int s_test_s3_complete_multipart_message_with_content_md5(struct aws_allo
     struct aws_array_list etags;
     ASSERT_SUCCESS(aws_array_list_init_dynamic(&etags, allocator, 0, sizeof(struct aws_string)));
 
-    struct aws_http_message *new_message =
-        aws_s3_complete_multipart_message_new(allocator, base_message, &body_buffer, upload_id, &etags);
+    struct aws_http_message *new_message = aws_s3_complete_multipart_message_new(
+        allocator, base_message, &body_buffer, upload_id, &etags, NULL, AWS_SCA_NONE);
 
     struct aws_http_headers *new_headers = aws_http_message_get_headers(new_message);
     ASSERT_FALSE(aws_http_headers_has(new_headers, g_content_md5_header_name));
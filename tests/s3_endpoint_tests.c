@@ -72,6 +72,65 @@ static int s_test_s3_endpoint_ref(struct aws_allocator *allocator, void *ctx) {
     return 0;
 }
 
+/* Test that an endpoint spawns a connection manager per CPU group, and only shuts down once all of them have. */
+AWS_TEST_CASE(test_s3_endpoint_cpu_group_connection_managers, s_test_s3_endpoint_cpu_group_connection_managers)
+static int s_test_s3_endpoint_cpu_group_connection_managers(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+
+    struct aws_string *host_name =
+        aws_s3_tester_build_endpoint_string(allocator, &g_test_public_bucket_name, &g_test_s3_region);
+
+    /* Both groups use the tester's bootstrap; what matters here is that each gets its own connection manager. */
+    struct aws_s3_client_cpu_group cpu_groups[] = {
+        {
+            .index = 0,
+            .client_bootstrap = tester.client_bootstrap,
+        },
+        {
+            .index = 1,
+            .client_bootstrap = tester.client_bootstrap,
+        },
+    };
+
+    struct aws_s3_endpoint_options endpoint_options = {
+        .host_name = host_name,
+        .shutdown_callback = s_test_s3_endpoint_ref_shutdown,
+        .client_bootstrap = tester.client_bootstrap,
+        .cpu_groups = cpu_groups,
+        .num_cpu_groups = AWS_ARRAY_SIZE(cpu_groups),
+        .tls_connection_options = NULL,
+        .dns_host_address_ttl_seconds = 1,
+        .user_data = &tester,
+        .max_connections = 4,
+    };
+
+    struct aws_s3_endpoint *endpoint = aws_s3_endpoint_new(allocator, &endpoint_options);
+    ASSERT_NOT_NULL(endpoint);
+
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(cpu_groups), endpoint->num_cpu_group_http_connection_managers);
+    ASSERT_TRUE(endpoint->cpu_group_http_connection_managers[0] != endpoint->cpu_group_http_connection_managers[1]);
+    ASSERT_TRUE(endpoint->http_connection_manager == endpoint->cpu_group_http_connection_managers[0]);
+
+    ASSERT_TRUE(
+        aws_s3_endpoint_get_http_connection_manager(endpoint, &cpu_groups[1]) ==
+        endpoint->cpu_group_http_connection_managers[1]);
+    ASSERT_TRUE(aws_s3_endpoint_get_http_connection_manager(endpoint, NULL) == endpoint->http_connection_manager);
+
+    aws_s3_endpoint_release(endpoint);
+
+    /* The shutdown callback is only called once, after the last connection manager has shut down. */
+    aws_s3_tester_wait_for_counters(&tester);
+
+    aws_string_destroy(host_name);
+    aws_s3_tester_clean_up(&tester);
+
+    return 0;
+}
+
 static bool s_test_s3_endpoint_resurrect_endpoint_ref_count_zero(struct aws_s3_endpoint *endpoint) {
     struct aws_s3_client *client = endpoint->user_data;
     struct aws_s3_tester *tester = client->shutdown_callback_user_data;
@@ -5,6 +5,7 @@
 
 #include "aws/s3/private/s3_client_impl.h"
 #include "aws/s3/private/s3_list_objects.h"
+#include "aws/s3/private/s3_parallel_list_objects.h"
 #include "s3_tester.h"
 
 #include <aws/auth/credentials.h>
@@ -197,4 +198,207 @@ static int s_test_s3_list_bucket_valid(struct aws_allocator *allocator, void *ct
     return AWS_OP_SUCCESS;
 }
 
-AWS_TEST_CASE(test_s3_list_bucket_valid, s_test_s3_list_bucket_valid)
\ No newline at end of file
+AWS_TEST_CASE(test_s3_list_bucket_valid, s_test_s3_list_bucket_valid)
+struct list_bucket_parse_test_data {
+    struct aws_allocator *allocator;
+    struct aws_array_list entries_found;
+    struct aws_string *continuation_token;
+    /* Number of entries found by the time the continuation token showed up. */
+    size_t entries_before_continuation_token;
+};
+
+static bool s_on_list_bucket_parse_object_fn(const struct aws_s3_object_info *info, void *user_data) {
+    struct list_bucket_parse_test_data *test_data = user_data;
+
+    const struct aws_byte_cursor *path_cursor = info->key.len ? &info->key : &info->prefix;
+    struct aws_string *path = aws_string_new_from_cursor(test_data->allocator, path_cursor);
+    aws_array_list_push_back(&test_data->entries_found, &path);
+
+    return true;
+}
+
+static void s_on_list_bucket_parse_continuation_token_fn(
+    struct aws_s3_paginator *paginator,
+    struct aws_byte_cursor continuation_token,
+    void *user_data) {
+    (void)paginator;
+    struct list_bucket_parse_test_data *test_data = user_data;
+
+    test_data->continuation_token = aws_string_new_from_cursor(test_data->allocator, &continuation_token);
+    test_data->entries_before_continuation_token = aws_array_list_length(&test_data->entries_found);
+}
+
+/* Feed a page to the paginator a few bytes at a time, and check that every object and prefix comes out, and that the
+ * continuation token is passed on as soon as it has been parsed, before the objects that come after it. */
+static int s_test_s3_list_bucket_parse_incremental(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_tester_client_options client_options;
+    AWS_ZERO_STRUCT(client_options);
+
+    struct aws_s3_client *client = NULL;
+    ASSERT_SUCCESS(aws_s3_tester_client_new(&tester, &client_options, &client));
+
+    struct list_bucket_parse_test_data test_data = {
+        .allocator = allocator,
+    };
+
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&test_data.entries_found, allocator, 4, sizeof(struct aws_string *)));
+
+    struct aws_s3_list_objects_params params = {
+        .client = client,
+        .endpoint = aws_byte_cursor_from_c_str("test-endpoint.com"),
+        .bucket_name = aws_byte_cursor_from_c_str("test-bucket"),
+        .on_object = s_on_list_bucket_parse_object_fn,
+        .on_continuation_token = s_on_list_bucket_parse_continuation_token_fn,
+        .user_data = &test_data,
+    };
+
+    struct aws_s3_paginator *paginator = aws_s3_initiate_list_objects(allocator, &params);
+    ASSERT_NOT_NULL(paginator);
+
+    struct aws_byte_cursor page = aws_byte_cursor_from_c_str(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+        "<Name>test-bucket</Name><Prefix></Prefix><KeyCount>3</KeyCount><MaxKeys>3</MaxKeys>"
+        "<IsTruncated>true</IsTruncated>"
+        "<Contents><Key>a/first.txt</Key><LastModified>2022-01-01T00:00:00.000Z</LastModified>"
+        "<ETag>&quot;0123&quot;</ETag><Size>11</Size><StorageClass>STANDARD</StorageClass></Contents>"
+        "<NextContinuationToken>next-page-token</NextContinuationToken>"
+        "<Contents><Key>b/second.txt</Key><Size>22</Size></Contents>"
+        "<CommonPrefixes><Prefix>c/</Prefix></CommonPrefixes>"
+        "</ListBucketResult>");
+
+    while (page.len > 0) {
+        struct aws_byte_cursor chunk = aws_byte_cursor_advance(&page, page.len < 7 ? page.len : 7);
+        ASSERT_SUCCESS(aws_s3_paginator_parse_page_body(paginator, chunk));
+    }
+
+    const char *expected_entries[] = {"a/first.txt", "b/second.txt", "c/"};
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(expected_entries), aws_array_list_length(&test_data.entries_found));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(expected_entries); ++i) {
+        struct aws_string *path = NULL;
+        aws_array_list_get_at(&test_data.entries_found, &path, i);
+        ASSERT_STR_EQUALS(expected_entries[i], aws_string_c_str(path));
+        aws_string_destroy(path);
+    }
+
+    ASSERT_NOT_NULL(test_data.continuation_token);
+    ASSERT_STR_EQUALS("next-page-token", aws_string_c_str(test_data.continuation_token));
+    ASSERT_UINT_EQUALS(1, test_data.entries_before_continuation_token);
+    ASSERT_TRUE(aws_s3_paginator_has_more_results(paginator));
+
+    aws_string_destroy(test_data.continuation_token);
+    aws_array_list_clean_up(&test_data.entries_found);
+    aws_s3_paginator_release(paginator);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_s3_list_bucket_parse_incremental, s_test_s3_list_bucket_parse_incremental)
+
+static void s_on_parallel_list_finished_fn(struct aws_s3_parallel_list_objects *list, int error_code, void *user_data) {
+    (void)list;
+    struct list_bucket_test_data *test_data = user_data;
+
+    aws_mutex_lock(&test_data->mutex);
+    test_data->error_code = error_code;
+    test_data->done = true;
+    aws_mutex_unlock(&test_data->mutex);
+    aws_condition_variable_notify_one(&test_data->c_var);
+}
+
+/* List the bucket split in ranges, and check that every key comes out once, in its range's order. */
+static int s_test_s3_list_bucket_parallel(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_tester_client_options client_options;
+    AWS_ZERO_STRUCT(client_options);
+    client_options.tls_usage = AWS_S3_TLS_ENABLED;
+
+    struct aws_s3_client *client = NULL;
+    ASSERT_SUCCESS(aws_s3_tester_client_new(&tester, &client_options, &client));
+
+    struct aws_signing_config_aws signing_config;
+    AWS_ZERO_STRUCT(signing_config);
+    aws_s3_init_default_signing_config(&signing_config, g_test_s3_region, tester.credentials_provider);
+
+    struct list_bucket_test_data test_data = {
+        .allocator = allocator,
+        .mutex = AWS_MUTEX_INIT,
+        .c_var = AWS_CONDITION_VARIABLE_INIT,
+        .done = false,
+    };
+
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&test_data.entries_found, allocator, 16, sizeof(struct aws_string *)));
+
+    struct aws_byte_cursor split_points[] = {
+        AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("get_object_test_1MB.txt"),
+        AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("m"),
+    };
+
+    struct aws_s3_parallel_list_objects_params params = {
+        .client = client,
+        .endpoint = aws_byte_cursor_from_c_str("s3.us-west-2.amazonaws.com"),
+        .bucket_name = g_test_bucket_name,
+        .split_points = split_points,
+        .num_split_points = AWS_ARRAY_SIZE(split_points),
+        .max_concurrent_listings = 2,
+        .signing_config = &signing_config,
+        .on_object = s_on_list_bucket_valid_object_fn,
+        .on_list_finished = s_on_parallel_list_finished_fn,
+        .user_data = &test_data,
+    };
+
+    aws_mutex_lock(&test_data.mutex);
+    struct aws_s3_parallel_list_objects *list = aws_s3_initiate_parallel_list_objects(allocator, &params);
+    ASSERT_NOT_NULL(list);
+    aws_condition_variable_wait_pred(&test_data.c_var, &test_data.mutex, s_on_paginator_finished_predicate, &test_data);
+    aws_mutex_unlock(&test_data.mutex);
+
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, test_data.error_code);
+
+    size_t length = aws_array_list_length(&test_data.entries_found);
+    ASSERT_TRUE(length > 0);
+
+    bool found_split_point = false;
+    for (size_t i = 0; i < length; ++i) {
+        struct aws_string *path = NULL;
+        aws_array_list_get_at(&test_data.entries_found, &path, i);
+
+        for (size_t j = i + 1; j < length; ++j) {
+            struct aws_string *other_path = NULL;
+            aws_array_list_get_at(&test_data.entries_found, &other_path, j);
+            ASSERT_FALSE(aws_string_eq(path, other_path));
+        }
+
+        found_split_point |= aws_string_eq_byte_cursor(path, &split_points[0]);
+    }
+
+    /* A split point is the last key of its range, not skipped. */
+    ASSERT_TRUE(found_split_point);
+
+    for (size_t i = 0; i < length; ++i) {
+        struct aws_string *path = NULL;
+        aws_array_list_get_at(&test_data.entries_found, &path, i);
+        aws_string_destroy(path);
+    }
+
+    aws_array_list_clean_up(&test_data.entries_found);
+    aws_s3_parallel_list_objects_release(list);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_s3_list_bucket_parallel, s_test_s3_list_bucket_parallel)
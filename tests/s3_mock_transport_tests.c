@@ -0,0 +1,508 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_mock_transport.h"
+#include "s3_tester.h"
+
+#include <aws/io/event_loop.h>
+#include <aws/io/stream.h>
+#include <aws/testing/aws_test_harness.h>
+
+static const size_t s_mock_part_size = 5 * 1024 * 1024;
+static const uint64_t s_mock_object_size = 4 * 5 * 1024 * 1024 + 1024;
+static const struct aws_byte_cursor s_mock_host_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("mock-bucket.s3.us-west-2.amazonaws.com");
+
+static struct aws_s3_client *s_mock_client_new(
+    struct aws_allocator *allocator,
+    struct aws_s3_tester *tester,
+    struct aws_s3_mock_transport *transport) {
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.part_size = s_mock_part_size;
+    client_config.tls_mode = AWS_MR_TLS_DISABLED;
+
+    if (aws_s3_tester_bind_client(tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION)) {
+        return NULL;
+    }
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+
+    if (client != NULL) {
+        aws_s3_mock_transport_install(transport, client);
+    }
+
+    return client;
+}
+
+/* Test that a multipart GET served by the mock transport gets the whole object, through the SlowDowns it is sent. */
+AWS_TEST_CASE(test_s3_mock_transport_get, s_test_s3_mock_transport_get)
+static int s_test_s3_mock_transport_get(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .slow_down_rate = 0.2,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+    options.message = message;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+    ASSERT_SUCCESS(aws_s3_tester_validate_get_object_results(&meta_request_test_results, 0));
+    ASSERT_UINT_EQUALS(s_mock_object_size, meta_request_test_results.received_body_size);
+
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    struct aws_s3_mock_transport_stats stats;
+    aws_s3_mock_transport_get_stats(transport, &stats);
+
+    /* A request for every part, and retries of the ones that got a SlowDown. */
+    ASSERT_TRUE(stats.num_slow_downs > 0);
+    ASSERT_TRUE(stats.num_requests >= 5 + stats.num_slow_downs);
+    ASSERT_UINT_EQUALS(s_mock_object_size, stats.num_response_body_bytes);
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+/* Download the mock object with parts requested before its size is known, and return the number of requests sent. */
+static int s_mock_get_speculative_parts(
+    struct aws_allocator *allocator,
+    uint32_t num_speculative_parts,
+    uint64_t object_size_hint,
+    uint64_t *out_num_requests) {
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+    options.message = message;
+    options.num_speculative_parts = num_speculative_parts;
+    options.object_size_hint = object_size_hint;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+    ASSERT_SUCCESS(aws_s3_tester_validate_get_object_results(&meta_request_test_results, 0));
+    ASSERT_UINT_EQUALS(s_mock_object_size, meta_request_test_results.received_body_size);
+
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    struct aws_s3_mock_transport_stats stats;
+    aws_s3_mock_transport_get_stats(transport, &stats);
+    ASSERT_UINT_EQUALS(s_mock_object_size, stats.num_response_body_bytes);
+    *out_num_requests = stats.num_requests;
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+/* Test that parts requested before the size of the object is known, past the end of the object, are dropped without
+ * failing the download. */
+AWS_TEST_CASE(test_s3_mock_transport_get_speculative_parts, s_test_s3_mock_transport_get_speculative_parts)
+static int s_test_s3_mock_transport_get_speculative_parts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint64_t num_requests = 0;
+    ASSERT_SUCCESS(s_mock_get_speculative_parts(allocator, 8, 0, &num_requests));
+
+    /* The five parts of the object, and three more past its end. */
+    ASSERT_UINT_EQUALS(8, num_requests);
+
+    return 0;
+}
+
+/* Test that an object size hint keeps parts from being requested past the size it says. */
+AWS_TEST_CASE(test_s3_mock_transport_get_object_size_hint, s_test_s3_mock_transport_get_object_size_hint)
+static int s_test_s3_mock_transport_get_object_size_hint(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint64_t num_requests = 0;
+    ASSERT_SUCCESS(s_mock_get_speculative_parts(allocator, 0, s_mock_object_size, &num_requests));
+    ASSERT_UINT_EQUALS(5, num_requests);
+
+    /* A hint that is too small only holds back the parts after it until the object size is known. */
+    ASSERT_SUCCESS(s_mock_get_speculative_parts(allocator, 0, 2 * s_mock_part_size, &num_requests));
+    ASSERT_UINT_EQUALS(5, num_requests);
+
+    return 0;
+}
+
+/* Test that parts whose response is cut off are resumed where they stopped, rather than downloaded again in full. Only
+ * the first part, which finds out the object size, is downloaded again from its start. */
+AWS_TEST_CASE(test_s3_mock_transport_get_resume_truncated_parts, s_test_s3_mock_transport_get_resume_truncated_parts)
+static int s_test_s3_mock_transport_get_resume_truncated_parts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const size_t part_size = 1024 * 1024;
+    const uint64_t object_size = 32 * 1024 * 1024;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .truncation_rate = 0.2,
+        .object_size = object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.part_size = part_size;
+    client_config.tls_mode = AWS_MR_TLS_DISABLED;
+
+    ASSERT_SUCCESS(aws_s3_tester_bind_client(&tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION));
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+    ASSERT_NOT_NULL(client);
+    aws_s3_mock_transport_install(transport, client);
+
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+    options.message = message;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+    ASSERT_UINT_EQUALS(object_size, meta_request_test_results.received_body_size);
+
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    struct aws_s3_mock_transport_stats stats;
+    aws_s3_mock_transport_get_stats(transport, &stats);
+
+    /* Downloading the parts again in full would waste half a part per truncated response. Resumed parts waste
+     * nothing. */
+    ASSERT_TRUE(stats.num_truncated_responses > 0);
+    ASSERT_TRUE(stats.num_response_body_bytes >= object_size);
+    ASSERT_TRUE(stats.num_response_body_bytes - object_size < stats.num_truncated_responses * (part_size / 2));
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+/* Test that a multipart upload served by the mock transport goes through every step, and sends the whole body. */
+AWS_TEST_CASE(test_s3_mock_transport_put, s_test_s3_mock_transport_put)
+static int s_test_s3_mock_transport_put(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_input_stream *body_stream = aws_s3_test_input_stream_new(allocator, (size_t)s_mock_object_size);
+
+    struct aws_http_message *message = aws_s3_test_put_object_request_new(
+        allocator,
+        s_mock_host_name,
+        g_test_body_content_type,
+        aws_byte_cursor_from_c_str("/mock-object"),
+        body_stream,
+        0);
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT;
+    options.message = message;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_input_stream_release(body_stream);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    struct aws_s3_mock_transport_stats stats;
+    aws_s3_mock_transport_get_stats(transport, &stats);
+
+    /* CreateMultipartUpload, the five parts, and CompleteMultipartUpload. */
+    ASSERT_UINT_EQUALS(7, stats.num_requests);
+    ASSERT_TRUE(stats.num_request_body_bytes >= s_mock_object_size);
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+/* Test that the parts of a multipart upload with a checksum, whose bodies are read and checksummed while the
+ * create-multipart-upload request is in flight, are all sent once the upload id arrives. */
+AWS_TEST_CASE(test_s3_mock_transport_put_early_parts, s_test_s3_mock_transport_put_early_parts)
+static int s_test_s3_mock_transport_put_early_parts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    /* Long enough for every part to be read before the create-multipart-upload request completes. */
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 10,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    struct aws_input_stream *body_stream = aws_s3_test_input_stream_new(allocator, (size_t)s_mock_object_size);
+
+    struct aws_http_message *message = aws_s3_test_put_object_request_new(
+        allocator,
+        s_mock_host_name,
+        g_test_body_content_type,
+        aws_byte_cursor_from_c_str("/mock-object"),
+        body_stream,
+        0);
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_PUT_OBJECT;
+    options.message = message;
+    options.checksum_algorithm = AWS_SCA_CRC32C;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_input_stream_release(body_stream);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    struct aws_s3_mock_transport_stats stats;
+    aws_s3_mock_transport_get_stats(transport, &stats);
+
+    /* CreateMultipartUpload, the five parts, and CompleteMultipartUpload. */
+    ASSERT_UINT_EQUALS(7, stats.num_requests);
+    ASSERT_TRUE(stats.num_request_body_bytes >= s_mock_object_size);
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+struct s3_sign_thread_test_data {
+    struct aws_atomic_var num_signed;
+
+    /* Signed on a body streaming event loop, where the caller's body callbacks run. */
+    struct aws_atomic_var num_signed_on_body_streaming_thread;
+};
+
+/* Returns true if the calling thread is one of the event loop group's. */
+static bool s_is_on_event_loop_group_thread(struct aws_event_loop_group *event_loop_group) {
+    for (size_t i = 0; i < aws_event_loop_group_get_loop_count(event_loop_group); ++i) {
+        if (aws_event_loop_thread_is_callers_thread(aws_event_loop_group_get_loop_at(event_loop_group, i))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void s_s3_meta_request_sign_request_check_thread(
+    struct aws_s3_meta_request *meta_request,
+    struct aws_s3_request *request,
+    aws_signing_complete_fn *on_signing_complete,
+    void *user_data) {
+
+    struct aws_s3_tester *tester = meta_request->client->shutdown_callback_user_data;
+    AWS_ASSERT(tester != NULL);
+
+    struct s3_sign_thread_test_data *test_data = tester->user_data;
+    AWS_ASSERT(test_data != NULL);
+
+    aws_atomic_fetch_add(&test_data->num_signed, 1);
+
+    if (s_is_on_event_loop_group_thread(meta_request->client->body_streaming_elg)) {
+        aws_atomic_fetch_add(&test_data->num_signed_on_body_streaming_thread, 1);
+    }
+
+    struct aws_s3_meta_request_vtable *original_meta_request_vtable =
+        aws_s3_tester_get_meta_request_vtable_patch(tester, 0)->original_vtable;
+
+    original_meta_request_vtable->sign_request(meta_request, request, on_signing_complete, user_data);
+}
+
+static struct aws_s3_meta_request *s_s3_meta_request_factory_check_sign_thread(
+    struct aws_s3_client *client,
+    const struct aws_s3_meta_request_options *options) {
+    AWS_ASSERT(client != NULL);
+
+    struct aws_s3_tester *tester = client->shutdown_callback_user_data;
+    AWS_ASSERT(tester != NULL);
+
+    struct aws_s3_client_vtable *original_client_vtable =
+        aws_s3_tester_get_client_vtable_patch(tester, 0)->original_vtable;
+
+    struct aws_s3_meta_request *meta_request = original_client_vtable->meta_request_factory(client, options);
+
+    struct aws_s3_meta_request_vtable *patched_meta_request_vtable =
+        aws_s3_tester_patch_meta_request_vtable(tester, meta_request, NULL);
+    patched_meta_request_vtable->sign_request = s_s3_meta_request_sign_request_check_thread;
+
+    return meta_request;
+}
+
+/* Test that the requests of a GET are signed on the client's connection I/O event loops, and never on the body streaming
+ * event loops, which run the caller's body callbacks. */
+AWS_TEST_CASE(test_s3_mock_transport_get_sign_off_body_streaming_thread, s_test_s3_mock_transport_get_sign_thread)
+static int s_test_s3_mock_transport_get_sign_thread(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct s3_sign_thread_test_data test_data;
+    AWS_ZERO_STRUCT(test_data);
+    aws_atomic_init_int(&test_data.num_signed, 0);
+    aws_atomic_init_int(&test_data.num_signed_on_body_streaming_thread, 0);
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+    tester.user_data = &test_data;
+
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 1000,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    struct aws_s3_mock_transport *transport = aws_s3_mock_transport_new(allocator, &transport_options);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    /* Patched after the mock transport is installed, so that the patch keeps the transport's vtable. */
+    struct aws_s3_client_vtable *patched_client_vtable = aws_s3_tester_patch_client_vtable(&tester, client, NULL);
+    patched_client_vtable->meta_request_factory = s_s3_meta_request_factory_check_sign_thread;
+
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_meta_request_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT;
+    options.message = message;
+
+    struct aws_s3_meta_request_test_results meta_request_test_results;
+    AWS_ZERO_STRUCT(meta_request_test_results);
+
+    ASSERT_SUCCESS(aws_s3_tester_send_meta_request(
+        &tester, client, &options, &meta_request_test_results, AWS_S3_TESTER_SEND_META_REQUEST_EXPECT_SUCCESS));
+    ASSERT_SUCCESS(aws_s3_tester_validate_get_object_results(&meta_request_test_results, 0));
+    ASSERT_UINT_EQUALS(s_mock_object_size, meta_request_test_results.received_body_size);
+
+    aws_s3_meta_request_test_results_clean_up(&meta_request_test_results);
+
+    aws_http_message_release(message);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    /* At least a request per part was signed, none of them on a body streaming thread. Signing can still land on the
+     * thread a request was prepared on, which is one of the connection I/O event loops too. */
+    ASSERT_TRUE(aws_atomic_load_int(&test_data.num_signed) >= 5);
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&test_data.num_signed_on_body_streaming_thread));
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_buffer_pool.h"
+#include "aws/s3/private/s3_recv_file.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <stdio.h>
+
+/* Test that parts written out of order, some aligned for direct I/O and some not, each land at their offset from the
+ * origin of the file. */
+AWS_TEST_CASE(test_s3_recv_file_write, s_test_s3_recv_file_write)
+static int s_test_s3_recv_file_write(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const char *path = "s3_recv_file_test.bin";
+    const uint64_t origin = 100;
+    const size_t block_size = AWS_S3_BUFFER_POOL_ALIGNMENT;
+
+    struct aws_s3_buffer_pool *buffer_pool = aws_s3_buffer_pool_new(allocator, block_size, 0, 1);
+    ASSERT_NOT_NULL(buffer_pool);
+
+    struct aws_byte_buf block;
+    ASSERT_SUCCESS(aws_s3_buffer_pool_acquire_buffer(buffer_pool, block_size, &block));
+    memset(block.buffer, 'a', block_size);
+    block.len = block_size;
+
+    struct aws_byte_cursor tail = aws_byte_cursor_from_c_str("tail");
+
+    struct aws_s3_recv_file *recv_file = aws_s3_recv_file_open(allocator, aws_byte_cursor_from_c_str(path), true, true);
+    ASSERT_NOT_NULL(recv_file);
+    ASSERT_SUCCESS(aws_s3_recv_file_set_origin(recv_file, origin, block_size + tail.len));
+
+    ASSERT_SUCCESS(aws_s3_recv_file_write(recv_file, origin + block_size, tail));
+    ASSERT_SUCCESS(aws_s3_recv_file_write(recv_file, origin, aws_byte_cursor_from_buf(&block)));
+
+    /* Nothing comes before the origin. */
+    ASSERT_FAILS(aws_s3_recv_file_write(recv_file, origin - 1, tail));
+
+    ASSERT_SUCCESS(aws_s3_recv_file_close(recv_file));
+
+    struct aws_byte_buf contents;
+    ASSERT_SUCCESS(aws_byte_buf_init(&contents, allocator, block_size + tail.len + 1));
+
+    FILE *file = fopen(path, "rb");
+    ASSERT_NOT_NULL(file);
+    contents.len = fread(contents.buffer, 1, contents.capacity, file);
+    fclose(file);
+    remove(path);
+
+    ASSERT_UINT_EQUALS(block_size + tail.len, contents.len);
+    ASSERT_BIN_ARRAYS_EQUALS(block.buffer, block_size, contents.buffer, block_size);
+    ASSERT_BIN_ARRAYS_EQUALS(tail.ptr, tail.len, contents.buffer + block_size, tail.len);
+
+    aws_byte_buf_clean_up(&contents);
+    aws_s3_buffer_pool_release_buffer(buffer_pool, &block);
+    aws_s3_buffer_pool_destroy(buffer_pool);
+
+    return 0;
+}
@@ -655,7 +655,7 @@ static int s_test_s3_create_multipart_upload_message_new(struct aws_allocator *a
     ASSERT_TRUE(original_message != NULL);
 
     struct aws_http_message *create_multipart_upload_message =
-        aws_s3_create_multipart_upload_message_new(allocator, original_message);
+        aws_s3_create_multipart_upload_message_new(allocator, original_message, AWS_SCA_NONE);
     ASSERT_TRUE(create_multipart_upload_message != NULL);
 
     ASSERT_SUCCESS(s_test_http_message_request_method(create_multipart_upload_message, "POST"));
@@ -705,9 +705,14 @@ static int s_test_s3_upload_part_message_new(struct aws_allocator *allocator, vo
 
     struct aws_string *upload_id = aws_string_new_from_c_str(allocator, UPLOAD_ID);
 
-    struct aws_http_message *upload_part_message =
-        aws_s3_upload_part_message_new(allocator, original_message, &part_buffer, PART_NUMBER, upload_id, false);
+    struct aws_http_message *part_message_template =
+        aws_s3_upload_part_message_template_new(allocator, original_message);
+    ASSERT_TRUE(part_message_template != NULL);
+
+    struct aws_http_message *upload_part_message = aws_s3_upload_part_message_new(
+        allocator, part_message_template, &part_buffer, PART_NUMBER, upload_id, false, AWS_SCA_NONE, NULL);
     ASSERT_TRUE(upload_part_message != NULL);
+    aws_http_message_release(part_message_template);
 
     ASSERT_SUCCESS(s_test_http_message_request_method(upload_part_message, "PUT"));
     ASSERT_SUCCESS(s_test_http_message_request_path(upload_part_message, &expected_create_path));
@@ -825,8 +830,8 @@ static int s_test_s3_complete_multipart_message_new(struct aws_allocator *alloca
     struct aws_byte_buf body_buffer;
     aws_byte_buf_init(&body_buffer, allocator, 64);
 
-    struct aws_http_message *complete_multipart_message =
-        aws_s3_complete_multipart_message_new(allocator, original_message, &body_buffer, upload_id, &etags);
+    struct aws_http_message *complete_multipart_message = aws_s3_complete_multipart_message_new(
+        allocator, original_message, &body_buffer, upload_id, &etags, NULL, AWS_SCA_NONE);
 
     ASSERT_SUCCESS(s_test_http_message_request_method(complete_multipart_message, "POST"));
     ASSERT_SUCCESS(s_test_http_message_request_path(complete_multipart_message, &expected_create_path));
@@ -0,0 +1,53 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_request.h"
+#include "aws/s3/private/s3_request_pool.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+/* Test that released requests are handed out again zeroed, and that only up to max_free_requests are kept. */
+AWS_TEST_CASE(test_s3_request_pool_recycle, s_test_s3_request_pool_recycle)
+static int s_test_s3_request_pool_recycle(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const size_t max_free_requests = 1;
+
+    struct aws_s3_request_pool *request_pool = aws_s3_request_pool_new(allocator, max_free_requests);
+    ASSERT_NOT_NULL(request_pool);
+
+    struct aws_s3_request *request0 = aws_s3_request_pool_acquire(request_pool);
+    ASSERT_NOT_NULL(request0);
+    struct aws_s3_request *request1 = aws_s3_request_pool_acquire(request_pool);
+    ASSERT_NOT_NULL(request1);
+    ASSERT_TRUE(request0 != request1);
+
+    request0->part_number = 42;
+    request0->request_tag = 7;
+
+    aws_s3_request_pool_release(request_pool, request0);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&request_pool->synced_data.free_requests));
+
+    /* Free list is full, so this request is freed. */
+    aws_s3_request_pool_release(request_pool, request1);
+    ASSERT_UINT_EQUALS(max_free_requests, aws_array_list_length(&request_pool->synced_data.free_requests));
+
+    /* The next request re-uses the recycled memory, with nothing left of its previous use. */
+    struct aws_s3_request *request2 = aws_s3_request_pool_acquire(request_pool);
+    ASSERT_PTR_EQUALS(request0, request2);
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&request_pool->synced_data.free_requests));
+    ASSERT_UINT_EQUALS(0, request2->part_number);
+    ASSERT_INT_EQUALS(0, request2->request_tag);
+
+    /* A request that didn't come from the pool can still be given to it. */
+    struct aws_s3_request *request3 = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_request));
+    aws_s3_request_pool_release(request_pool, request3);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&request_pool->synced_data.free_requests));
+
+    aws_s3_request_pool_release(request_pool, request2);
+    aws_s3_request_pool_destroy(request_pool);
+
+    return 0;
+}
@@ -163,7 +163,13 @@ static void s_s3_fail_prepare_finish_destroy(struct aws_s3_client *client) {
     struct s3_fail_prepare_test_data *test_data = tester->user_data;
     AWS_ASSERT(test_data != NULL);
 
-    test_data->num_requests_being_prepared_is_correct = client->threaded_data.num_requests_being_prepared == 0;
+    uint32_t num_requests_being_prepared = 0;
+
+    for (uint32_t shard_index = 0; shard_index < client->num_work_shards; ++shard_index) {
+        num_requests_being_prepared += client->work_shards[shard_index].threaded_data.num_requests_being_prepared;
+    }
+
+    test_data->num_requests_being_prepared_is_correct = num_requests_being_prepared == 0;
 
     struct aws_s3_client_vtable *original_client_vtable =
         aws_s3_tester_get_client_vtable_patch(tester, 0)->original_vtable;
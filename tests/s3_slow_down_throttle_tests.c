@@ -0,0 +1,121 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_slow_down_throttle.h"
+
+#include <aws/common/clock.h>
+#include <aws/testing/aws_test_harness.h>
+
+static const uint64_t s_one_sec_ns = AWS_TIMESTAMP_NANOS;
+
+/* Admit 100 requests per second for one second, starting at start_ns. Returns the time after the last admission. */
+static uint64_t s_admit_for_one_sec(struct aws_s3_slow_down_throttle *throttle, uint64_t start_ns) {
+    uint64_t now_ns = start_ns;
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        AWS_FATAL_ASSERT(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL));
+        now_ns += s_one_sec_ns / 100;
+    }
+
+    return now_ns;
+}
+
+/* Test that a SlowDown cuts the admission rate to half of what was measured, and that further SlowDowns keep cutting
+ * it, but not below the minimum and not for every SlowDown of the same burst. */
+AWS_TEST_CASE(test_s3_slow_down_throttle_back_off, s_test_s3_slow_down_throttle_back_off)
+static int s_test_s3_slow_down_throttle_back_off(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_slow_down_throttle *throttle = aws_s3_slow_down_throttle_new(allocator);
+    ASSERT_NOT_NULL(throttle);
+
+    /* Nothing is limited until there is a SlowDown. */
+    ASSERT_TRUE(aws_s3_slow_down_throttle_get_rate(throttle) == 0.0);
+
+    uint64_t now_ns = s_admit_for_one_sec(throttle, s_one_sec_ns);
+    ASSERT_TRUE(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL));
+
+    aws_s3_slow_down_throttle_on_slow_down(throttle, now_ns);
+    ASSERT_TRUE(aws_s3_slow_down_throttle_get_rate(throttle) == 50.0);
+
+    /* No tokens are left right after the SlowDown. */
+    uint64_t retry_after_ns = 0;
+    ASSERT_FALSE(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, &retry_after_ns));
+    ASSERT_TRUE(retry_after_ns > 0);
+    ASSERT_TRUE(retry_after_ns <= s_one_sec_ns / 50 + 1);
+
+    now_ns += retry_after_ns;
+    ASSERT_TRUE(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL));
+    ASSERT_FALSE(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL));
+
+    /* A SlowDown right after the last one is for a request sent at the old rate. */
+    aws_s3_slow_down_throttle_on_slow_down(throttle, now_ns);
+    ASSERT_TRUE(aws_s3_slow_down_throttle_get_rate(throttle) == 50.0);
+
+    now_ns += s_one_sec_ns / 5;
+    aws_s3_slow_down_throttle_on_slow_down(throttle, now_ns);
+    ASSERT_TRUE(aws_s3_slow_down_throttle_get_rate(throttle) == 25.0);
+
+    /* The rate never goes below the minimum. */
+    for (uint32_t i = 0; i < 10; ++i) {
+        now_ns += s_one_sec_ns / 5;
+        aws_s3_slow_down_throttle_on_slow_down(throttle, now_ns);
+    }
+
+    ASSERT_TRUE(aws_s3_slow_down_throttle_get_rate(throttle) == 10.0);
+
+    aws_s3_slow_down_throttle_destroy(throttle);
+
+    return 0;
+}
+
+/* Test that the admission rate ramps back up once SlowDowns stop, until nothing is limited anymore. */
+AWS_TEST_CASE(test_s3_slow_down_throttle_recover, s_test_s3_slow_down_throttle_recover)
+static int s_test_s3_slow_down_throttle_recover(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_slow_down_throttle *throttle = aws_s3_slow_down_throttle_new(allocator);
+    ASSERT_NOT_NULL(throttle);
+
+    uint64_t now_ns = s_admit_for_one_sec(throttle, s_one_sec_ns);
+    ASSERT_TRUE(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL));
+
+    aws_s3_slow_down_throttle_on_slow_down(throttle, now_ns);
+
+    double last_rate = aws_s3_slow_down_throttle_get_rate(throttle);
+    ASSERT_TRUE(last_rate > 0.0);
+
+    /* Not recovering yet, there was a SlowDown too recently. */
+    now_ns += s_one_sec_ns / 2;
+    aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL);
+    ASSERT_TRUE(aws_s3_slow_down_throttle_get_rate(throttle) == last_rate);
+
+    bool recovered = false;
+
+    for (uint32_t i = 0; i < 10 && !recovered; ++i) {
+        now_ns += s_one_sec_ns;
+        aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL);
+
+        double rate = aws_s3_slow_down_throttle_get_rate(throttle);
+
+        if (rate == 0.0) {
+            recovered = true;
+        } else {
+            ASSERT_TRUE(rate > last_rate);
+            last_rate = rate;
+        }
+    }
+
+    ASSERT_TRUE(recovered);
+
+    /* Once recovered, everything is admitted again. */
+    for (uint32_t i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(aws_s3_slow_down_throttle_try_admit(throttle, now_ns, NULL));
+    }
+
+    aws_s3_slow_down_throttle_destroy(throttle);
+
+    return 0;
+}
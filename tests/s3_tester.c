@@ -93,6 +93,20 @@ static int s_s3_test_meta_request_body_callback(
     AWS_PRECONDITION(body);
 
     struct aws_s3_meta_request_test_results *meta_request_test_results = user_data;
+
+    /* Parts can arrive in any order, and from several threads at once. */
+    if (meta_request->delivery == AWS_S3_META_REQUEST_DELIVERY_UNORDERED) {
+        aws_s3_tester_lock_synced_data(meta_request_test_results->tester);
+        meta_request_test_results->received_body_size += body->len;
+        aws_s3_tester_unlock_synced_data(meta_request_test_results->tester);
+
+        if (meta_request_test_results->body_callback != NULL) {
+            return meta_request_test_results->body_callback(meta_request, body, range_start, user_data);
+        }
+
+        return AWS_OP_SUCCESS;
+    }
+
     meta_request_test_results->received_body_size += body->len;
 
     AWS_LOGF_DEBUG(
@@ -157,6 +171,59 @@ static void s_s3_test_meta_request_finish(
     aws_s3_tester_notify_meta_request_finished(tester, result);
 }
 
+static void s_s3_test_meta_request_telemetry(
+    struct aws_s3_meta_request *meta_request,
+    const struct aws_s3_request_metrics *metrics,
+    void *user_data) {
+    (void)meta_request;
+
+    struct aws_s3_meta_request_test_results *meta_request_test_results = user_data;
+    struct aws_s3_tester *tester = meta_request_test_results->tester;
+
+    /* Retried requests are prepared and signed again after they were queued, so only the stages of successful first
+     * attempts are guaranteed to be in order. */
+    bool out_of_order = false;
+
+    if (metrics->error_code == AWS_ERROR_SUCCESS && metrics->num_retries == 0) {
+        const uint64_t stage_timestamps[] = {
+            metrics->prepare_start_timestamp_ns,
+            metrics->sign_start_timestamp_ns,
+            metrics->sign_end_timestamp_ns,
+            metrics->queue_start_timestamp_ns,
+            metrics->queue_end_timestamp_ns,
+            metrics->connection_acquire_start_timestamp_ns,
+            metrics->connection_acquire_end_timestamp_ns,
+            metrics->send_start_timestamp_ns,
+            metrics->first_byte_timestamp_ns,
+            metrics->finish_timestamp_ns,
+        };
+
+        /* Stages that a patched vtable skipped are left at 0, and are ignored. */
+        uint64_t previous_timestamp_ns = 0;
+
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(stage_timestamps); ++i) {
+            if (stage_timestamps[i] == 0) {
+                continue;
+            }
+
+            if (stage_timestamps[i] < previous_timestamp_ns) {
+                out_of_order = true;
+            }
+
+            previous_timestamp_ns = stage_timestamps[i];
+        }
+
+        if (metrics->finish_timestamp_ns == 0) {
+            out_of_order = true;
+        }
+    }
+
+    aws_s3_tester_lock_synced_data(tester);
+    ++meta_request_test_results->num_telemetry_callbacks;
+    meta_request_test_results->telemetry_out_of_order |= out_of_order;
+    aws_s3_tester_unlock_synced_data(tester);
+}
+
 static void s_s3_test_meta_request_shutdown(void *user_data) {
     struct aws_s3_meta_request_test_results *meta_request_test_results = user_data;
     struct aws_s3_tester *tester = meta_request_test_results->tester;
@@ -322,6 +389,9 @@ int aws_s3_tester_bind_meta_request(
     ASSERT_TRUE(options->shutdown_callback == NULL);
     options->shutdown_callback = s_s3_test_meta_request_shutdown;
 
+    ASSERT_TRUE(options->telemetry_callback == NULL);
+    options->telemetry_callback = s_s3_test_meta_request_telemetry;
+
     ASSERT_TRUE(options->user_data == NULL);
     options->user_data = meta_request_test_results;
 
@@ -577,13 +647,13 @@ size_t s_s3_client_get_host_address_count_empty(
     return 0;
 }
 
-static void s_s3_client_schedule_process_work_synced_empty(struct aws_s3_client *client) {
-    (void)client;
+static void s_s3_client_schedule_process_work_synced_empty(struct aws_s3_client_work_shard *work_shard) {
+    (void)work_shard;
 }
 
-static void s_s3_client_process_work_empty(struct aws_s3_client *client) {
-    AWS_PRECONDITION(client);
-    (void)client;
+static void s_s3_client_process_work_empty(struct aws_s3_client_work_shard *work_shard) {
+    AWS_PRECONDITION(work_shard);
+    (void)work_shard;
 }
 
 static bool s_s3_client_endpoint_ref_count_zero_empty(struct aws_s3_endpoint *endpoint) {
@@ -618,10 +688,21 @@ static void s_s3_mock_client_start_destroy(void *user_data) {
     struct aws_s3_client *client = user_data;
     AWS_ASSERT(client);
 
+    for (uint32_t shard_index = 0; shard_index < client->num_work_shards; ++shard_index) {
+        aws_mutex_clean_up(&client->work_shards[shard_index].synced_data.lock);
+    }
+
+    aws_mem_release(client->allocator, client->work_shards);
     aws_mem_release(client->allocator, client);
 }
 
 struct aws_s3_client *aws_s3_tester_mock_client_new(struct aws_s3_tester *tester) {
+    return aws_s3_tester_mock_client_new_with_shards(tester, 1);
+}
+
+struct aws_s3_client *aws_s3_tester_mock_client_new_with_shards(struct aws_s3_tester *tester, uint32_t num_work_shards) {
+    AWS_PRECONDITION(num_work_shards > 0);
+
     struct aws_allocator *allocator = tester->allocator;
     struct aws_s3_client *mock_client = aws_mem_calloc(allocator, 1, sizeof(struct aws_s3_client));
 
@@ -633,6 +714,28 @@ struct aws_s3_client *aws_s3_tester_mock_client_new(struct aws_s3_tester *tester
 
     aws_mutex_init(&mock_client->synced_data.lock);
 
+    /* Work shards that tests can drive directly. */
+    mock_client->work_shards = aws_mem_calloc(allocator, num_work_shards, sizeof(struct aws_s3_client_work_shard));
+    *((uint32_t *)&mock_client->num_work_shards) = num_work_shards;
+
+    for (uint32_t shard_index = 0; shard_index < num_work_shards; ++shard_index) {
+        struct aws_s3_client_work_shard *work_shard = &mock_client->work_shards[shard_index];
+        work_shard->client = mock_client;
+        *((uint32_t *)&work_shard->index) = shard_index;
+        aws_mutex_init(&work_shard->synced_data.lock);
+        aws_atomic_init_int(&work_shard->waiting_for_capacity, 0);
+        aws_linked_list_init(&work_shard->synced_data.pending_meta_request_work);
+        aws_linked_list_init(&work_shard->synced_data.prepared_requests);
+        aws_linked_list_init(&work_shard->threaded_data.meta_requests);
+
+        for (uint32_t priority = 0; priority < AWS_S3_META_REQUEST_PRIORITY_MAX; ++priority) {
+            aws_linked_list_init(&work_shard->threaded_data.request_queues[priority]);
+        }
+    }
+
+    aws_atomic_init_int(&mock_client->next_work_shard_index, 0);
+    aws_atomic_init_int(&mock_client->capacity_release_count, 0);
+
     aws_atomic_init_int(&mock_client->stats.num_requests_in_flight, 0);
 
     for (uint32_t i = 0; i < (uint32_t)AWS_S3_META_REQUEST_TYPE_MAX; ++i) {
@@ -641,6 +744,9 @@ struct aws_s3_client *aws_s3_tester_mock_client_new(struct aws_s3_tester *tester
 
     aws_atomic_init_int(&mock_client->stats.num_requests_stream_queued_waiting, 0);
     aws_atomic_init_int(&mock_client->stats.num_requests_streaming, 0);
+    aws_atomic_init_int(&mock_client->stats.num_bytes_transferred, 0);
+    aws_atomic_init_int(&mock_client->stats.num_slow_down_errors, 0);
+    aws_atomic_init_int(&mock_client->max_allowed_connections, 0);
 
     return mock_client;
 }
@@ -1151,6 +1257,9 @@ int aws_s3_tester_send_meta_request_with_options(
     struct aws_s3_meta_request_options meta_request_options = {
         .type = options->meta_request_type,
         .message = options->message,
+        .delivery = options->get_options.delivery,
+        .enable_variable_part_size = options->get_options.enable_variable_part_size,
+        .small_object_hint = options->small_object_hint,
     };
 
     struct aws_byte_buf input_stream_buffer;
@@ -1318,6 +1427,8 @@ int aws_s3_tester_send_meta_request_with_options(
     switch (options->validate_type) {
         case AWS_S3_TESTER_VALIDATE_TYPE_EXPECT_SUCCESS:
             ASSERT_TRUE(out_results->finished_error_code == AWS_ERROR_SUCCESS);
+            ASSERT_TRUE(out_results->num_telemetry_callbacks > 0);
+            ASSERT_FALSE(out_results->telemetry_out_of_order);
 
             if (meta_request_options.type == AWS_S3_META_REQUEST_TYPE_GET_OBJECT) {
                 ASSERT_SUCCESS(aws_s3_tester_validate_get_object_results(out_results, options->sse_type));
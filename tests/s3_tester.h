@@ -151,6 +151,8 @@ struct aws_s3_tester_meta_request_options {
     struct {
         struct aws_byte_cursor object_path;
         struct aws_byte_cursor object_range;
+        enum aws_s3_meta_request_delivery delivery;
+        bool enable_variable_part_size;
     } get_options;
 
     /* Put Object Meta request specific options. */
@@ -167,6 +169,9 @@ struct aws_s3_tester_meta_request_options {
     enum aws_s3_tester_sse_type sse_type;
     enum aws_s3_tester_validate_type validate_type;
 
+    /* Passed through as small_object_hint of the meta request. */
+    bool small_object_hint;
+
     uint32_t dont_wait_for_shutdown : 1;
 };
 
@@ -187,6 +192,11 @@ struct aws_s3_meta_request_test_results {
     uint64_t received_body_size;
     int finished_response_status;
     int finished_error_code;
+
+    /* Number of telemetry callbacks received, and whether any successful request that was never retried reported its
+     * stages out of order. */
+    uint32_t num_telemetry_callbacks;
+    bool telemetry_out_of_order;
 };
 
 struct aws_s3_client_config;
@@ -240,6 +250,9 @@ struct aws_http_message *aws_s3_tester_dummy_http_request_new(struct aws_s3_test
 
 struct aws_s3_client *aws_s3_tester_mock_client_new(struct aws_s3_tester *tester);
 
+/* Create a mock client with several work shards, each of which tests can drive directly. */
+struct aws_s3_client *aws_s3_tester_mock_client_new_with_shards(struct aws_s3_tester *tester, uint32_t num_work_shards);
+
 struct aws_s3_endpoint *aws_s3_tester_mock_endpoint_new(struct aws_s3_tester *tester);
 
 /* Create a new meta request for testing meta request functionality in isolation. test_results and client are optional.
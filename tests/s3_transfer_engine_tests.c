@@ -0,0 +1,333 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_mock_transport.h"
+#include "aws/s3/private/s3_transfer_engine.h"
+#include "s3_tester.h"
+
+#include <aws/http/request_response.h>
+#include <aws/testing/aws_test_harness.h>
+
+static const size_t s_mock_part_size = 5 * 1024 * 1024;
+static const uint64_t s_mock_object_size = 16 * 1024;
+static const struct aws_byte_cursor s_mock_host_name =
+    AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("mock-bucket.s3.us-west-2.amazonaws.com");
+
+/* What the callbacks of an engine under test saw, protected by the lock of the tester. counter1 of the tester counts
+ * the finish callbacks, and counter2 the room callbacks. */
+struct s3_transfer_engine_test_data {
+    struct aws_s3_tester *tester;
+    uint32_t max_active_transfers;
+
+    size_t num_transfers_finished;
+    size_t num_transfers_failed;
+    int transfer_error_code;
+    int finish_error_code;
+    bool exceeded_max_active_transfers;
+};
+
+static void s_transfer_finish_callback(
+    struct aws_s3_transfer_engine *engine,
+    void *transfer_user_data,
+    const struct aws_s3_meta_request_result *result,
+    void *user_data) {
+    (void)transfer_user_data;
+
+    struct s3_transfer_engine_test_data *test_data = user_data;
+
+    struct aws_s3_transfer_engine_stats stats;
+    aws_s3_transfer_engine_get_stats(engine, &stats);
+
+    aws_s3_tester_lock_synced_data(test_data->tester);
+
+    ++test_data->num_transfers_finished;
+
+    if (result->error_code != AWS_ERROR_SUCCESS) {
+        ++test_data->num_transfers_failed;
+        test_data->transfer_error_code = result->error_code;
+    }
+
+    if (stats.num_transfers_active > test_data->max_active_transfers) {
+        test_data->exceeded_max_active_transfers = true;
+    }
+
+    aws_s3_tester_unlock_synced_data(test_data->tester);
+}
+
+static void s_engine_finish_callback(struct aws_s3_transfer_engine *engine, int error_code, void *user_data) {
+    (void)engine;
+
+    struct s3_transfer_engine_test_data *test_data = user_data;
+
+    aws_s3_tester_lock_synced_data(test_data->tester);
+    test_data->finish_error_code = error_code;
+    aws_s3_tester_unlock_synced_data(test_data->tester);
+
+    aws_s3_tester_inc_counter1(test_data->tester);
+}
+
+static void s_room_callback(struct aws_s3_transfer_engine *engine, void *user_data) {
+    (void)engine;
+
+    struct s3_transfer_engine_test_data *test_data = user_data;
+    aws_s3_tester_inc_counter2(test_data->tester);
+}
+
+static struct aws_s3_client *s_mock_client_new(
+    struct aws_allocator *allocator,
+    struct aws_s3_tester *tester,
+    struct aws_s3_mock_transport *transport) {
+
+    struct aws_s3_client_config client_config;
+    AWS_ZERO_STRUCT(client_config);
+    client_config.part_size = s_mock_part_size;
+    client_config.tls_mode = AWS_MR_TLS_DISABLED;
+
+    if (aws_s3_tester_bind_client(tester, &client_config, AWS_S3_TESTER_BIND_CLIENT_REGION)) {
+        return NULL;
+    }
+
+    struct aws_s3_client *client = aws_s3_client_new(allocator, &client_config);
+
+    if (client != NULL) {
+        aws_s3_mock_transport_install(transport, client);
+    }
+
+    return client;
+}
+
+static struct aws_s3_mock_transport *s_mock_transport_new(struct aws_allocator *allocator) {
+    /* Slow enough that transfers are still running while the test fills the engine up. */
+    struct aws_s3_mock_transport_options transport_options = {
+        .latency_ns = AWS_TIMESTAMP_NANOS / 10,
+        .object_size = s_mock_object_size,
+        .num_host_addresses = 1,
+        .seed = 42,
+    };
+
+    return aws_s3_mock_transport_new(allocator, &transport_options);
+}
+
+static int s_add_get(struct aws_allocator *allocator, struct aws_s3_transfer_engine *engine) {
+    struct aws_http_message *message =
+        aws_s3_test_get_object_request_new(allocator, s_mock_host_name, aws_byte_cursor_from_c_str("/mock-object"));
+
+    struct aws_s3_transfer_options transfer = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = message,
+        .size = s_mock_object_size,
+    };
+
+    int result = aws_s3_transfer_engine_add(engine, &transfer);
+    aws_http_message_release(message);
+
+    return result;
+}
+
+/* Test that a producer waiting for room never has more than max_active_transfers running or max_queued_transfers
+ * waiting, that it blocks once the queue is full and wakes up once a transfer makes room, and that the engine finishes
+ * exactly once after the end of the input. */
+AWS_TEST_CASE(test_s3_transfer_engine_wait_for_room, s_test_s3_transfer_engine_wait_for_room)
+static int s_test_s3_transfer_engine_wait_for_room(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const size_t num_transfers = 10;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_mock_transport *transport = s_mock_transport_new(allocator);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    struct s3_transfer_engine_test_data test_data = {
+        .tester = &tester,
+        .max_active_transfers = 2,
+    };
+
+    struct aws_s3_transfer_engine_options engine_options = {
+        .client = client,
+        .max_active_transfers = test_data.max_active_transfers,
+        .max_queued_transfers = 2,
+        .transfer_finish_callback = s_transfer_finish_callback,
+        .finish_callback = s_engine_finish_callback,
+        .user_data = &test_data,
+    };
+
+    struct aws_s3_transfer_engine *engine = aws_s3_transfer_engine_new(allocator, &engine_options);
+    ASSERT_NOT_NULL(engine);
+
+    size_t num_waits = 0;
+
+    for (size_t i = 0; i < num_transfers; ++i) {
+        struct aws_s3_transfer_engine_stats stats;
+        aws_s3_transfer_engine_get_stats(engine, &stats);
+
+        if (stats.num_transfers_queued == engine_options.max_queued_transfers) {
+            ++num_waits;
+        }
+
+        aws_s3_transfer_engine_wait_for_room(engine);
+
+        aws_s3_transfer_engine_get_stats(engine, &stats);
+        ASSERT_TRUE(stats.num_transfers_queued < engine_options.max_queued_transfers);
+
+        ASSERT_SUCCESS(s_add_get(allocator, engine));
+
+        aws_s3_transfer_engine_get_stats(engine, &stats);
+        ASSERT_TRUE(stats.num_transfers_active <= engine_options.max_active_transfers);
+        ASSERT_TRUE(stats.num_transfers_queued <= engine_options.max_queued_transfers);
+    }
+
+    /* With every transfer taking a while, the queue filled up and the producer had to wait for room. */
+    ASSERT_TRUE(num_waits > 0);
+
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+    aws_s3_transfer_engine_end_input(engine);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    /* No more transfers once the input has ended. */
+    ASSERT_FAILS(s_add_get(allocator, engine));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+    struct aws_s3_transfer_engine_stats stats;
+    aws_s3_transfer_engine_get_stats(engine, &stats);
+    ASSERT_UINT_EQUALS(0, stats.num_transfers_queued);
+    ASSERT_UINT_EQUALS(0, stats.num_transfers_active);
+    ASSERT_UINT_EQUALS(num_transfers, stats.num_transfers_succeeded);
+    ASSERT_UINT_EQUALS(0, stats.num_transfers_failed);
+    ASSERT_TRUE(stats.num_bytes_transferred >= num_transfers * s_mock_object_size);
+
+    aws_s3_transfer_engine_release(engine);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    /* Everything has shut down, so any other finish callback would have come by now. */
+    ASSERT_UINT_EQUALS(1, tester.synced_data.counter1);
+    ASSERT_UINT_EQUALS(num_transfers, test_data.num_transfers_finished);
+    ASSERT_UINT_EQUALS(0, test_data.num_transfers_failed);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, test_data.finish_error_code);
+    ASSERT_FALSE(test_data.exceeded_max_active_transfers);
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
+
+/* Test that a room callback registered while the queue is full fires once a transfer frees a slot (and right away when
+ * there is room), and that a transfer whose meta request can't be made is counted as failed without stopping the
+ * others. */
+AWS_TEST_CASE(test_s3_transfer_engine_on_room, s_test_s3_transfer_engine_on_room)
+static int s_test_s3_transfer_engine_on_room(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_tester tester;
+    AWS_ZERO_STRUCT(tester);
+    ASSERT_SUCCESS(aws_s3_tester_init(allocator, &tester));
+
+    struct aws_s3_mock_transport *transport = s_mock_transport_new(allocator);
+    ASSERT_NOT_NULL(transport);
+
+    struct aws_s3_client *client = s_mock_client_new(allocator, &tester, transport);
+    ASSERT_NOT_NULL(client);
+
+    struct s3_transfer_engine_test_data test_data = {
+        .tester = &tester,
+        .max_active_transfers = 1,
+    };
+
+    struct aws_s3_transfer_engine_options engine_options = {
+        .client = client,
+        .max_active_transfers = test_data.max_active_transfers,
+        .max_queued_transfers = 1,
+        .transfer_finish_callback = s_transfer_finish_callback,
+        .finish_callback = s_engine_finish_callback,
+        .user_data = &test_data,
+    };
+
+    struct aws_s3_transfer_engine *engine = aws_s3_transfer_engine_new(allocator, &engine_options);
+    ASSERT_NOT_NULL(engine);
+
+    /* One transfer running, and one filling up the queue. */
+    ASSERT_SUCCESS(s_add_get(allocator, engine));
+    ASSERT_SUCCESS(s_add_get(allocator, engine));
+
+    struct aws_s3_transfer_engine_stats stats;
+    aws_s3_transfer_engine_get_stats(engine, &stats);
+    ASSERT_UINT_EQUALS(1, stats.num_transfers_active);
+    ASSERT_UINT_EQUALS(1, stats.num_transfers_queued);
+
+    aws_s3_tester_set_counter2_desired(&tester, 1);
+    ASSERT_SUCCESS(aws_s3_transfer_engine_on_room(engine, s_room_callback, &test_data));
+
+    aws_s3_tester_lock_synced_data(&tester);
+    ASSERT_UINT_EQUALS(0, tester.synced_data.counter2);
+    aws_s3_tester_unlock_synced_data(&tester);
+
+    /* Only one callback can be waiting at a time. */
+    ASSERT_FAILS(aws_s3_transfer_engine_on_room(engine, s_room_callback, &test_data));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+
+    /* The first transfer finishing lets the queued one run, which makes room. */
+    aws_s3_tester_wait_for_counters(&tester);
+
+    aws_s3_transfer_engine_get_stats(engine, &stats);
+    ASSERT_TRUE(stats.num_transfers_succeeded >= 1);
+    ASSERT_UINT_EQUALS(0, stats.num_transfers_queued);
+
+    /* There is room now, so the callback is invoked before on_room returns. */
+    ASSERT_SUCCESS(aws_s3_transfer_engine_on_room(engine, s_room_callback, &test_data));
+
+    aws_s3_tester_lock_synced_data(&tester);
+    ASSERT_UINT_EQUALS(2, tester.synced_data.counter2);
+    aws_s3_tester_unlock_synced_data(&tester);
+
+    /* A message without a Host header can't be made into a meta request. */
+    struct aws_http_message *bad_message = aws_http_message_new_request(allocator);
+    ASSERT_NOT_NULL(bad_message);
+    ASSERT_SUCCESS(aws_http_message_set_request_method(bad_message, aws_http_method_get));
+    ASSERT_SUCCESS(aws_http_message_set_request_path(bad_message, aws_byte_cursor_from_c_str("/mock-object")));
+
+    struct aws_s3_transfer_options bad_transfer = {
+        .type = AWS_S3_META_REQUEST_TYPE_GET_OBJECT,
+        .message = bad_message,
+    };
+
+    ASSERT_SUCCESS(aws_s3_transfer_engine_add(engine, &bad_transfer));
+    aws_http_message_release(bad_message);
+
+    ASSERT_SUCCESS(s_add_get(allocator, engine));
+
+    aws_s3_tester_set_counter1_desired(&tester, 1);
+    aws_s3_tester_set_counter2_desired(&tester, 2);
+    aws_s3_transfer_engine_end_input(engine);
+    aws_s3_tester_wait_for_counters(&tester);
+
+    aws_s3_transfer_engine_get_stats(engine, &stats);
+    ASSERT_UINT_EQUALS(0, stats.num_transfers_queued);
+    ASSERT_UINT_EQUALS(0, stats.num_transfers_active);
+    ASSERT_UINT_EQUALS(3, stats.num_transfers_succeeded);
+    ASSERT_UINT_EQUALS(1, stats.num_transfers_failed);
+    ASSERT_TRUE(stats.num_bytes_transferred >= 3 * s_mock_object_size);
+
+    aws_s3_transfer_engine_release(engine);
+    aws_s3_client_release(client);
+    aws_s3_tester_clean_up(&tester);
+
+    /* The engine finishes once, with the error of the transfer that failed. */
+    ASSERT_UINT_EQUALS(1, tester.synced_data.counter1);
+    ASSERT_UINT_EQUALS(4, test_data.num_transfers_finished);
+    ASSERT_UINT_EQUALS(1, test_data.num_transfers_failed);
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, test_data.transfer_error_code);
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, test_data.finish_error_code);
+    ASSERT_FALSE(test_data.exceeded_max_active_transfers);
+
+    aws_s3_mock_transport_destroy(transport);
+
+    return 0;
+}
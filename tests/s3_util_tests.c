@@ -188,6 +188,78 @@ static int s_test_s3_parse_content_length_response_header(struct aws_allocator *
     return 0;
 }
 
+AWS_TEST_CASE(test_s3_parse_request_range_header, s_test_s3_parse_request_range_header)
+static int s_test_s3_parse_request_range_header(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_http_headers *request_headers = aws_http_headers_new(allocator);
+    const struct aws_byte_cursor range_header_name = AWS_BYTE_CUR_INIT_FROM_STRING_LITERAL("Range");
+
+    bool has_start_range = false;
+    bool has_end_range = false;
+    uint64_t start_range = 0ULL;
+    uint64_t end_range = 0ULL;
+
+    /* Try to parse a header that isn't there. */
+    ASSERT_FAILS(aws_s3_parse_request_range_header(
+        request_headers, &has_start_range, &has_end_range, &start_range, &end_range));
+    ASSERT_TRUE(aws_last_error() == AWS_ERROR_S3_INVALID_RANGE_HEADER);
+
+    /* Start and end. */
+    aws_http_headers_set(request_headers, range_header_name, aws_byte_cursor_from_c_str("bytes=10-20"));
+    ASSERT_SUCCESS(aws_s3_parse_request_range_header(
+        request_headers, &has_start_range, &has_end_range, &start_range, &end_range));
+    ASSERT_TRUE(has_start_range);
+    ASSERT_TRUE(has_end_range);
+    ASSERT_TRUE(start_range == 10ULL);
+    ASSERT_TRUE(end_range == 20ULL);
+
+    /* Open ended. */
+    aws_http_headers_set(request_headers, range_header_name, aws_byte_cursor_from_c_str("bytes=12345-"));
+    ASSERT_SUCCESS(aws_s3_parse_request_range_header(
+        request_headers, &has_start_range, &has_end_range, &start_range, &end_range));
+    ASSERT_TRUE(has_start_range);
+    ASSERT_FALSE(has_end_range);
+    ASSERT_TRUE(start_range == 12345ULL);
+
+    /* Suffix. */
+    aws_http_headers_set(request_headers, range_header_name, aws_byte_cursor_from_c_str("bytes=-500"));
+    ASSERT_SUCCESS(aws_s3_parse_request_range_header(
+        request_headers, &has_start_range, &has_end_range, &start_range, &end_range));
+    ASSERT_FALSE(has_start_range);
+    ASSERT_TRUE(has_end_range);
+    ASSERT_TRUE(end_range == 500ULL);
+
+    /* Multiple ranges. */
+    aws_http_headers_set(request_headers, range_header_name, aws_byte_cursor_from_c_str("bytes=0-9,20-29"));
+    ASSERT_FAILS(aws_s3_parse_request_range_header(
+        request_headers, &has_start_range, &has_end_range, &start_range, &end_range));
+    ASSERT_TRUE(aws_last_error() == AWS_ERROR_S3_MULTIRANGE_HEADER_UNSUPPORTED);
+
+    /* Ranges that don't parse, or can never be satisfied. */
+    const char *invalid_ranges[] = {
+        "bytes=",
+        "bytes=-",
+        "bytes=20-10",
+        "bytes=-0",
+        "bytes=1-2-3",
+        "bytes=a-b",
+        "items=0-10",
+        "bytes=99999999999999999999-",
+    };
+
+    for (size_t i = 0; i < sizeof(invalid_ranges) / sizeof(invalid_ranges[0]); ++i) {
+        aws_http_headers_set(request_headers, range_header_name, aws_byte_cursor_from_c_str(invalid_ranges[i]));
+        ASSERT_FAILS(aws_s3_parse_request_range_header(
+            request_headers, &has_start_range, &has_end_range, &start_range, &end_range));
+        ASSERT_TRUE(aws_last_error() == AWS_ERROR_S3_INVALID_RANGE_HEADER);
+    }
+
+    aws_http_headers_release(request_headers);
+
+    return 0;
+}
+
 static int s_validate_part_ranges(
     uint64_t object_range_start,
     uint64_t object_range_end,
@@ -292,3 +364,208 @@ static int s_test_s3_get_num_parts_and_get_part_range(struct aws_allocator *allo
 
     return 0;
 }
+
+static int s_validate_scheduled_part_ranges(
+    const struct aws_s3_part_size_schedule *schedule,
+    uint64_t object_range_start,
+    uint64_t object_range_end,
+    uint32_t num_parts,
+    const uint64_t *part_ranges) {
+    ASSERT_TRUE(part_ranges != NULL);
+
+    for (uint32_t i = 0; i < num_parts; ++i) {
+        uint64_t part_range_start = 0ULL;
+        uint64_t part_range_end = 0ULL;
+
+        aws_s3_get_part_range_for_schedule(
+            schedule, object_range_start, object_range_end, i + 1, &part_range_start, &part_range_end);
+
+        ASSERT_TRUE(part_range_start == part_ranges[i * 2]);
+        ASSERT_TRUE(part_range_end == part_ranges[i * 2 + 1]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(
+    test_s3_get_num_parts_and_get_part_range_for_schedule,
+    s_test_s3_get_num_parts_and_get_part_range_for_schedule)
+static int s_test_s3_get_num_parts_and_get_part_range_for_schedule(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    /* A 1 byte first part, then two parts of each of 2 and 4 bytes, then parts of 8 bytes. */
+    const struct aws_s3_part_size_schedule schedule = {
+        .first_part_size = 1,
+        .part_size = 2,
+        .max_part_size = 8,
+        .num_parts_per_step = 2,
+    };
+
+    const uint64_t object_range_start = 10;
+
+    /* Range that fits in the first part. */
+    {
+        const uint64_t part_ranges[] = {10, 10};
+
+        ASSERT_TRUE(aws_s3_get_num_parts_for_schedule(&schedule, object_range_start, 10) == 1);
+        ASSERT_SUCCESS(s_validate_scheduled_part_ranges(&schedule, object_range_start, 10, 1, part_ranges));
+    }
+
+    /* Range that ends half way through the parts of the first step. */
+    {
+        const uint64_t part_ranges[] = {10, 10, 11, 12, 13, 13};
+
+        ASSERT_TRUE(aws_s3_get_num_parts_for_schedule(&schedule, object_range_start, 13) == 3);
+        ASSERT_SUCCESS(s_validate_scheduled_part_ranges(&schedule, object_range_start, 13, 3, part_ranges));
+    }
+
+    /* Range that goes past the last step, with the last part cut short. */
+    {
+        const uint64_t part_ranges[] = {10, 10, 11, 12, 13, 14, 15, 18, 19, 22, 23, 30, 31, 34};
+
+        ASSERT_TRUE(aws_s3_get_num_parts_for_schedule(&schedule, object_range_start, 34) == 7);
+        ASSERT_SUCCESS(s_validate_scheduled_part_ranges(&schedule, object_range_start, 34, 7, part_ranges));
+    }
+
+    /* Parts never get bigger than the max part size, even if the part size is. */
+    {
+        const struct aws_s3_part_size_schedule capped_schedule = {
+            .first_part_size = 4,
+            .part_size = 16,
+            .max_part_size = 8,
+            .num_parts_per_step = 2,
+        };
+
+        const uint64_t part_ranges[] = {0, 3, 4, 11, 12, 19};
+
+        ASSERT_TRUE(aws_s3_get_num_parts_for_schedule(&capped_schedule, 0, 19) == 3);
+        ASSERT_SUCCESS(s_validate_scheduled_part_ranges(&capped_schedule, 0, 19, 3, part_ranges));
+    }
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_s3_calculate_copy_part_size, s_test_s3_calculate_copy_part_size)
+static int s_test_s3_calculate_copy_part_size(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    const uint64_t one_mb = 1024ULL * 1024ULL;
+    const uint64_t one_gb = 1024ULL * one_mb;
+    const uint64_t min_part_size = 64ULL * one_mb;
+
+    /* Small objects are copied in parts of the minimum size. */
+    ASSERT_UINT_EQUALS(min_part_size, aws_s3_calculate_copy_part_size(one_gb, min_part_size, 100));
+
+    /* Otherwise the object is split in about as many parts as the target, rounded up to whole MBs. */
+    ASSERT_UINT_EQUALS(128ULL * one_mb, aws_s3_calculate_copy_part_size(6400ULL * one_mb, min_part_size, 50));
+    ASSERT_UINT_EQUALS(one_gb, aws_s3_calculate_copy_part_size(100ULL * one_gb, min_part_size, 100));
+    ASSERT_UINT_EQUALS(11ULL * one_mb, aws_s3_calculate_copy_part_size(100ULL * one_mb + 1, 0, 10));
+
+    /* Parts are never larger than S3 allows... */
+    ASSERT_UINT_EQUALS(
+        g_s3_max_upload_part_size, aws_s3_calculate_copy_part_size(1024ULL * one_gb, min_part_size, 100));
+
+    /* ...nor so small that more parts than S3 allows are needed. */
+    const uint64_t object_size = 1024ULL * one_gb + 1;
+    uint64_t part_size = aws_s3_calculate_copy_part_size(object_size, min_part_size, 0);
+    ASSERT_TRUE(part_size % one_mb == 0);
+    ASSERT_TRUE((object_size + part_size - 1) / part_size <= g_s3_max_num_upload_parts);
+    ASSERT_TRUE(part_size - one_mb < object_size / g_s3_max_num_upload_parts);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_s3_merge_byte_ranges, s_test_s3_merge_byte_ranges)
+static int s_test_s3_merge_byte_ranges(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* Out of order, with ranges that overlap, touch, or are contained in others. */
+    const struct aws_s3_byte_range ranges[] = {
+        {.start = 20, .end = 29},
+        {.start = 0, .end = 9},
+        {.start = 10, .end = 12},
+        {.start = 22, .end = 25},
+        {.start = 40, .end = UINT64_MAX},
+        {.start = 50, .end = 60},
+        {.start = 11, .end = 14},
+    };
+
+    struct aws_array_list byte_ranges;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&byte_ranges, allocator, 0, sizeof(struct aws_s3_byte_range)));
+
+    /* Nothing is covered by an empty list. */
+    aws_s3_merge_byte_ranges(&byte_ranges);
+    ASSERT_FALSE(aws_s3_byte_ranges_cover(&byte_ranges, 0, 0));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(ranges); ++i) {
+        ASSERT_SUCCESS(aws_array_list_push_back(&byte_ranges, &ranges[i]));
+    }
+
+    aws_s3_merge_byte_ranges(&byte_ranges);
+
+    const uint64_t merged_ranges[] = {0, 14, 20, 29, 40, UINT64_MAX};
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(merged_ranges) / 2, aws_array_list_length(&byte_ranges));
+
+    for (size_t i = 0; i < aws_array_list_length(&byte_ranges); ++i) {
+        struct aws_s3_byte_range byte_range;
+        aws_array_list_get_at(&byte_ranges, &byte_range, i);
+
+        ASSERT_TRUE(byte_range.start == merged_ranges[i * 2]);
+        ASSERT_TRUE(byte_range.end == merged_ranges[i * 2 + 1]);
+    }
+
+    ASSERT_TRUE(aws_s3_byte_ranges_cover(&byte_ranges, 0, 14));
+    ASSERT_TRUE(aws_s3_byte_ranges_cover(&byte_ranges, 5, 10));
+    ASSERT_TRUE(aws_s3_byte_ranges_cover(&byte_ranges, 20, 20));
+    ASSERT_TRUE(aws_s3_byte_ranges_cover(&byte_ranges, 45, UINT64_MAX));
+    ASSERT_FALSE(aws_s3_byte_ranges_cover(&byte_ranges, 10, 15));
+    ASSERT_FALSE(aws_s3_byte_ranges_cover(&byte_ranges, 15, 19));
+    ASSERT_FALSE(aws_s3_byte_ranges_cover(&byte_ranges, 14, 20));
+    ASSERT_FALSE(aws_s3_byte_ranges_cover(&byte_ranges, 30, 45));
+
+    aws_array_list_clean_up(&byte_ranges);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_s3_coalesce_byte_ranges, s_test_s3_coalesce_byte_ranges)
+static int s_test_s3_coalesce_byte_ranges(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* Out of order, with gaps of 5, 6 and 0 bytes between the ranges once sorted. */
+    const struct aws_s3_byte_range ranges[] = {
+        {.start = 15, .end = 20},
+        {.start = 0, .end = 9},
+        {.start = 27, .end = 30},
+        {.start = 31, .end = 40},
+    };
+
+    struct aws_array_list byte_ranges;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&byte_ranges, allocator, 0, sizeof(struct aws_s3_byte_range)));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(ranges); ++i) {
+        ASSERT_SUCCESS(aws_array_list_push_back(&byte_ranges, &ranges[i]));
+    }
+
+    aws_s3_coalesce_byte_ranges(&byte_ranges, 5);
+
+    const uint64_t coalesced_ranges[] = {0, 20, 27, 40};
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(coalesced_ranges) / 2, aws_array_list_length(&byte_ranges));
+
+    for (size_t i = 0; i < aws_array_list_length(&byte_ranges); ++i) {
+        struct aws_s3_byte_range byte_range;
+        aws_array_list_get_at(&byte_ranges, &byte_range, i);
+
+        ASSERT_TRUE(byte_range.start == coalesced_ranges[i * 2]);
+        ASSERT_TRUE(byte_range.end == coalesced_ranges[i * 2 + 1]);
+    }
+
+    aws_s3_coalesce_byte_ranges(&byte_ranges, 6);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&byte_ranges));
+
+    aws_array_list_clean_up(&byte_ranges);
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "aws/s3/private/s3_vip_balancer.h"
+
+#include <aws/common/clock.h>
+#include <aws/common/string.h>
+#include <aws/testing/aws_test_harness.h>
+
+static const uint64_t s_one_sec_ns = AWS_TIMESTAMP_NANOS;
+static const uint64_t s_part_size = 8 * 1024 * 1024;
+
+static const char *s_vip_addresses[] = {"10.0.0.1", "10.0.0.2", "10.0.0.3", "10.0.0.4"};
+
+static struct aws_s3_vip_balancer *s_vip_balancer_new_with_vips(struct aws_allocator *allocator) {
+    struct aws_s3_vip_balancer *balancer = aws_s3_vip_balancer_new(allocator);
+    AWS_FATAL_ASSERT(balancer != NULL);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_vip_addresses); ++i) {
+        AWS_FATAL_ASSERT(
+            aws_s3_vip_balancer_add_vip(balancer, aws_byte_cursor_from_c_str(s_vip_addresses[i]), NULL) ==
+            AWS_OP_SUCCESS);
+    }
+
+    return balancer;
+}
+
+/* Returns the VIP with the given address. */
+static struct aws_s3_balanced_vip *s_find_vip(struct aws_s3_vip_balancer *balancer, const char *address) {
+    struct aws_s3_balanced_vip *found_vip = NULL;
+
+    aws_mutex_lock(&balancer->synced_data.lock);
+
+    for (size_t i = 0; i < aws_array_list_length(&balancer->synced_data.vips); ++i) {
+        struct aws_s3_balanced_vip *vip = NULL;
+        aws_array_list_get_at(&balancer->synced_data.vips, &vip, i);
+
+        if (aws_string_eq_c_str(vip->address, address)) {
+            found_vip = vip;
+        }
+    }
+
+    aws_mutex_unlock(&balancer->synced_data.lock);
+
+    return found_vip;
+}
+
+/* Test that connections are spread evenly over VIPs, and that adding the same address twice doesn't add a VIP. */
+AWS_TEST_CASE(test_s3_vip_balancer_spread, s_test_s3_vip_balancer_spread)
+static int s_test_s3_vip_balancer_spread(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_vip_balancer *balancer = aws_s3_vip_balancer_new(allocator);
+    ASSERT_NOT_NULL(balancer);
+
+    /* Nothing to hand out until a VIP is known. */
+    ASSERT_NULL(aws_s3_vip_balancer_acquire_vip(balancer, s_one_sec_ns));
+    aws_s3_vip_balancer_destroy(balancer);
+
+    balancer = s_vip_balancer_new_with_vips(allocator);
+
+    ASSERT_SUCCESS(aws_s3_vip_balancer_add_vip(balancer, aws_byte_cursor_from_c_str(s_vip_addresses[0]), NULL));
+    ASSERT_TRUE(aws_s3_vip_balancer_has_vip(balancer, aws_byte_cursor_from_c_str(s_vip_addresses[0])));
+    ASSERT_FALSE(aws_s3_vip_balancer_has_vip(balancer, aws_byte_cursor_from_c_str("10.0.0.5")));
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(s_vip_addresses), aws_s3_vip_balancer_get_num_usable_vips(balancer, 0));
+
+    struct aws_s3_balanced_vip *acquired_vips[AWS_ARRAY_SIZE(s_vip_addresses) * 3];
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(acquired_vips); ++i) {
+        acquired_vips[i] = aws_s3_vip_balancer_acquire_vip(balancer, s_one_sec_ns);
+        ASSERT_NOT_NULL(acquired_vips[i]);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_vip_addresses); ++i) {
+        ASSERT_UINT_EQUALS(3, s_find_vip(balancer, s_vip_addresses[i])->num_active_connections);
+    }
+
+    /* Once a VIP has fewer connections than the others, it is the one that gets the next connection. */
+    struct aws_s3_balanced_vip *vip_1 = s_find_vip(balancer, s_vip_addresses[1]);
+    aws_s3_vip_balancer_release_vip(balancer, vip_1, false, s_part_size, s_one_sec_ns, s_one_sec_ns);
+    ASSERT_PTR_EQUALS(vip_1, aws_s3_vip_balancer_acquire_vip(balancer, s_one_sec_ns));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(acquired_vips); ++i) {
+        aws_s3_vip_balancer_release_vip(balancer, acquired_vips[i], false, s_part_size, s_one_sec_ns, s_one_sec_ns);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_vip_addresses); ++i) {
+        ASSERT_UINT_EQUALS(0, s_find_vip(balancer, s_vip_addresses[i])->num_active_connections);
+    }
+
+    aws_s3_vip_balancer_destroy(balancer);
+
+    return 0;
+}
+
+/* Sample num_samples requests of one part on the vip, each taking duration_ns. */
+static void s_sample_requests(
+    struct aws_s3_vip_balancer *balancer,
+    struct aws_s3_balanced_vip *vip,
+    uint32_t num_samples,
+    bool failed,
+    uint64_t duration_ns,
+    uint64_t now_ns) {
+
+    for (uint32_t i = 0; i < num_samples; ++i) {
+        aws_mutex_lock(&balancer->synced_data.lock);
+        ++vip->num_active_connections;
+        aws_mutex_unlock(&balancer->synced_data.lock);
+
+        aws_s3_vip_balancer_release_vip(balancer, vip, failed, s_part_size, duration_ns, now_ns);
+    }
+}
+
+/* Test that a VIP much slower than its peers, or one that keeps failing, is evicted for a while and then re-admitted,
+ * and that no more than half of the VIPs are ever evicted. */
+AWS_TEST_CASE(test_s3_vip_balancer_evict_slow_vips, s_test_s3_vip_balancer_evict_slow_vips)
+static int s_test_s3_vip_balancer_evict_slow_vips(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_s3_vip_balancer *balancer = s_vip_balancer_new_with_vips(allocator);
+    uint64_t now_ns = s_one_sec_ns;
+
+    struct aws_s3_balanced_vip *vips[AWS_ARRAY_SIZE(s_vip_addresses)];
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_vip_addresses); ++i) {
+        vips[i] = s_find_vip(balancer, s_vip_addresses[i]);
+        ASSERT_NOT_NULL(vips[i]);
+    }
+
+    /* VIPs 1 through 3 move a part in 100ms. */
+    for (size_t i = 1; i < AWS_ARRAY_SIZE(vips); ++i) {
+        s_sample_requests(balancer, vips[i], 10, false, s_one_sec_ns / 10, now_ns);
+    }
+
+    /* Having a few samples only, or the odd slow request, is not enough to get evicted. */
+    s_sample_requests(balancer, vips[0], 7, false, s_one_sec_ns, now_ns);
+    ASSERT_UINT_EQUALS(0, vips[0]->evicted_until_ns);
+
+    s_sample_requests(balancer, vips[3], 1, false, s_one_sec_ns, now_ns);
+    ASSERT_UINT_EQUALS(0, vips[3]->evicted_until_ns);
+
+    /* Consistently taking a second per part is. */
+    s_sample_requests(balancer, vips[0], 8, false, s_one_sec_ns, now_ns);
+    ASSERT_TRUE(vips[0]->evicted_until_ns > now_ns);
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(vips) - 1, aws_s3_vip_balancer_get_num_usable_vips(balancer, now_ns));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(vips) * 2; ++i) {
+        struct aws_s3_balanced_vip *vip = aws_s3_vip_balancer_acquire_vip(balancer, now_ns);
+        ASSERT_TRUE(vip != vips[0]);
+        aws_s3_vip_balancer_release_vip(balancer, vip, false, 0, 0, now_ns);
+    }
+
+    /* A VIP where most requests fail gets evicted as well. */
+    s_sample_requests(balancer, vips[1], 10, true, 0, now_ns);
+    ASSERT_TRUE(vips[1]->evicted_until_ns > now_ns);
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(vips) - 2, aws_s3_vip_balancer_get_num_usable_vips(balancer, now_ns));
+
+    /* With half the VIPs evicted, nothing else is. */
+    s_sample_requests(balancer, vips[2], 10, true, 0, now_ns);
+    ASSERT_UINT_EQUALS(0, vips[2]->evicted_until_ns);
+
+    /* Evicted VIPs come back with a clean slate after a while. */
+    now_ns += 31 * s_one_sec_ns;
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(vips), aws_s3_vip_balancer_get_num_usable_vips(balancer, now_ns));
+    ASSERT_UINT_EQUALS(0, vips[0]->evicted_until_ns);
+    ASSERT_UINT_EQUALS(0, vips[0]->num_samples);
+    ASSERT_UINT_EQUALS(0, vips[1]->evicted_until_ns);
+
+    aws_s3_vip_balancer_destroy(balancer);
+
+    return 0;
+}